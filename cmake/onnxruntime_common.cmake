@@ -38,7 +38,7 @@ source_group(TREE ${REPO_ROOT} FILES ${onnxruntime_common_src})
 add_library(onnxruntime_common ${onnxruntime_common_src})
 
 onnxruntime_add_include_to_target(onnxruntime_common gsl date)
-target_include_directories(onnxruntime_common PRIVATE ${CMAKE_CURRENT_BINARY_DIR} ${ONNXRUNTIME_ROOT}
+target_include_directories(onnxruntime_common PRIVATE ${CMAKE_CURRENT_BINARY_DIR} ${ONNXRUNTIME_ROOT} ${eigen_INCLUDE_DIRS}
         PUBLIC "${CMAKE_CURRENT_SOURCE_DIR}/external/nsync/public")
 if(onnxruntime_USE_NSYNC)
     target_compile_definitions(onnxruntime_common PUBLIC USE_NSYNC)
@@ -10,6 +10,10 @@ set(mlas_common_srcs
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/activate.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/logistic.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/tanh.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/qgemm.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/compute.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/transpose.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/nchwc.cpp
 )
 
 if (MSVC)
@@ -67,6 +71,25 @@ if (MSVC)
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/amd64/TanhKernelFma3.asm
     )
 
+    set(mlas_platform_srcs_avx2
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/qgemm_kernel_avx2.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/compute_kernel_fma3.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/nchwc_kernel_fma3.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/convdepthwise_kernel_fma3.cpp
+    )
+    set_source_files_properties(${mlas_platform_srcs_avx2} PROPERTIES COMPILE_FLAGS "/arch:AVX2")
+
+    set(mlas_platform_srcs_avx512
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/qgemm_kernel_avx512.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/nchwc_kernel_avx512f.cpp
+    )
+    set_source_files_properties(${mlas_platform_srcs_avx512} PROPERTIES COMPILE_FLAGS "/arch:AVX512")
+
+    list(APPEND mlas_platform_srcs
+      ${mlas_platform_srcs_avx2}
+      ${mlas_platform_srcs_avx512}
+    )
+
   endif()
 
 else()
@@ -139,19 +162,40 @@ else()
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/SgemmKernelFma3.S
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/LogisticKernelFma3.S
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/TanhKernelFma3.S
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/qgemm_kernel_avx2.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/compute_kernel_fma3.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/nchwc_kernel_fma3.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/convdepthwise_kernel_fma3.cpp
     )
     set_source_files_properties(${mlas_platform_srcs_avx2} PROPERTIES COMPILE_FLAGS "-mavx2 -mfma")
 
     set(mlas_platform_srcs_avx512f
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/SgemmKernelAvx512F.S
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/nchwc_kernel_avx512f.cpp
     )
     set_source_files_properties(${mlas_platform_srcs_avx512f} PROPERTIES COMPILE_FLAGS "-mavx512f")
 
+    # The AVX512_VNNI kernel falls back to AVX512BW instructions if the
+    # compiler does not support the AVX512_VNNI intrinsics.
+
+    include(CheckCXXCompilerFlag)
+    check_cxx_compiler_flag("-mavx512vnni" HAS_AVX512VNNI)
+
+    set(mlas_platform_srcs_avx512bw
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/qgemm_kernel_avx512.cpp
+    )
+    if (HAS_AVX512VNNI)
+      set_source_files_properties(${mlas_platform_srcs_avx512bw} PROPERTIES COMPILE_FLAGS "-mavx512bw -mavx512vnni")
+    else()
+      set_source_files_properties(${mlas_platform_srcs_avx512bw} PROPERTIES COMPILE_FLAGS "-mavx512bw")
+    endif()
+
     set(mlas_platform_srcs
       ${mlas_platform_srcs_sse2}
       ${mlas_platform_srcs_avx}
       ${mlas_platform_srcs_avx2}
       ${mlas_platform_srcs_avx512f}
+      ${mlas_platform_srcs_avx512bw}
     )
 
   endif()
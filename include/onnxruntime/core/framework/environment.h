@@ -8,7 +8,11 @@
 #include "core/common/common.h"
 #include "core/common/status.h"
 
+struct MLAS_THREADPOOL;
+
 namespace onnxruntime {
+class ThreadPool;
+
 /**
    Provides the runtime environment for onnxruntime.
    Create one instance for the duration of execution.
@@ -17,8 +21,11 @@ class Environment {
  public:
   /**
      Create and initialize the runtime environment.
+     @param intra_op_num_threads Number of threads, including the calling thread, used to parallelize work
+     inside a single kernel (e.g. GEMM and convolution in MLAS). If 0, the number of hardware threads is used.
+     The thread pool is shared by all sessions in the process to avoid oversubscription.
   */
-  static Status Create(std::unique_ptr<Environment>& environment);
+  static Status Create(std::unique_ptr<Environment>& environment, int intra_op_num_threads = 0);
 
   /**
      This function will call ::google::protobuf::ShutdownProtobufLibrary
@@ -30,12 +37,21 @@ class Environment {
   */
   static bool IsInitialized() { return is_initialized_; }
 
+  /**
+     Returns the process-wide intra-op thread pool of the most recently created Environment, or nullptr if
+     intra-op work is run single threaded. Sessions use it unless they are configured with their own pool.
+  */
+  static ThreadPool* GetIntraOpThreadPool();
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Environment);
 
-  Environment() = default;
-  Status Initialize();
+  Environment();
+  Status Initialize(int intra_op_num_threads);
 
   static std::atomic<bool> is_initialized_;
+
+  std::unique_ptr<ThreadPool> intra_op_thread_pool_;
+  std::unique_ptr<MLAS_THREADPOOL> mlas_thread_pool_;
 };
 }  // namespace onnxruntime
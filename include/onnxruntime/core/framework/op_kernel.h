@@ -23,6 +23,7 @@ namespace onnxruntime {
 class IExecutionFrame;
 class OpKernelContext;
 class OpKernelWrapper;
+class ThreadPool;
 
 class OpKernel {
  public:
@@ -145,6 +146,13 @@ class OpKernelContext {
   */
   Fence_t OutputFence(int index) const;
 
+  /**
+  Return the thread pool to use for intra-op parallelism within this kernel.
+  @returns The session's intra-op thread pool, or nullptr if there is none in which case the kernel should run
+  all its work on the calling thread.
+  */
+  virtual ThreadPool* GetOperatorThreadPool() const { return nullptr; }
+
  protected:
   onnxruntime::NodeIndex GetNodeIndex() const;
 
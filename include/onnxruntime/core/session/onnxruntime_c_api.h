@@ -152,6 +152,7 @@ ORT_RUNTIME_CLASS(TensorTypeAndShapeInfo);
 ORT_RUNTIME_CLASS(SessionOptions);
 ORT_RUNTIME_CLASS(Callback);
 ORT_RUNTIME_CLASS(CustomOpDomain);
+ORT_RUNTIME_CLASS(PreparedRun);
 
 // When passing in an allocator to any ORT function, be sure that the allocator object
 // is not destroyed until the last allocated object using it is freed.
@@ -180,6 +181,16 @@ ORT_API_STATUS(OrtCreateEnvWithCustomLogger, OrtLoggingFunction logging_function
                _In_ const char* logid,
                _Out_ OrtEnv** out);
 
+/**
+ * \param intra_op_num_threads Number of threads, including the calling thread, used by the process-wide thread pool
+ *        that parallelizes work inside a single operator (e.g. GEMM and convolution). If 0, the number of hardware
+ *        threads is used. OrtCreateEnv is equivalent to passing 0.
+ * \param out Should be freed by `OrtReleaseEnv` after use
+ */
+ORT_API_STATUS(OrtCreateEnvWithIntraOpThreads, OrtLoggingLevel default_warning_level, _In_ const char* logid,
+               int intra_op_num_threads, _Out_ OrtEnv** out)
+ORT_ALL_ARGS_NONNULL;
+
 // TODO: document the path separator convention? '/' vs '\'
 // TODO: should specify the access characteristics of model_path. Is this read only during the
 // execution of OrtCreateSession, or does the OrtSession retain a handle to the file/directory
@@ -194,6 +205,49 @@ ORT_API_STATUS(OrtRun, _Inout_ OrtSession* sess,
                _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
                _In_ const char* const* output_names, size_t output_names_len, _Out_ OrtValue** output);
 
+/**
+ * Resolve a fixed set of input and output names once so that repeated OrtRunPrepared calls don't need to.
+ * The device copy info is computed by the first OrtRunPrepared call, so the inputs and any pre-allocated outputs
+ * should come from the same device in every call.
+ * \param out Should be freed by OrtReleasePreparedRun after use, and before the session is released.
+ */
+ORT_API_STATUS(OrtCreatePreparedRun, _Inout_ OrtSession* sess,
+               _In_ const char* const* input_names, size_t input_len,
+               _In_ const char* const* output_names, size_t output_names_len, _Out_ OrtPreparedRun** out);
+
+/**
+ * Same as OrtRun, with the inputs and outputs in the order of the names provided to OrtCreatePreparedRun.
+ * It's safe to call this from multiple threads with the same prepared_run. prepared_run must have been created for
+ * sess, otherwise this returns ORT_INVALID_ARGUMENT.
+ */
+ORT_API_STATUS(OrtRunPrepared, _Inout_ OrtSession* sess,
+               _In_ OrtRunOptions* run_options, _Inout_ OrtPreparedRun* prepared_run,
+               _In_ const OrtValue* const* input, size_t input_len,
+               size_t output_len, _Out_ OrtValue** output);
+
+/**
+ * Called once an OrtRunAsync request has completed, failed or was cancelled.
+ * \param outputs null if status isn't null. Otherwise the callee owns the values and should free each of them with
+ *        OrtReleaseValue. The array itself is only valid during the call.
+ * \param status null on success. It is only valid during the call and must not be released by the callee.
+ * \param queue_time_in_us time the request waited for a thread of the inter-op thread pool
+ */
+typedef void(ORT_API_CALL* OrtRunAsyncCallback)(void* user_data, _In_opt_ OrtValue** outputs, size_t num_outputs,
+                                                _In_opt_ OrtStatus* status, int64_t queue_time_in_us);
+
+/**
+ * Queue a run onto the inter-op thread pool of the session and return immediately.
+ * The inputs and names are copied before this returns. callback is called on a pool thread with the outputs.
+ * Setting the terminate flag of run_options cancels the request. If run_options isn't null it must stay alive until
+ * the callback is called. Releasing the session waits for all its queued requests.
+ * If an error is returned the request wasn't queued and callback isn't called.
+ */
+ORT_API_STATUS(OrtRunAsync, _Inout_ OrtSession* sess,
+               _In_opt_ OrtRunOptions* run_options,
+               _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
+               _In_ const char* const* output_names, size_t output_names_len,
+               _In_ OrtRunAsyncCallback callback, _In_opt_ void* user_data);
+
 /**
  * \return A pointer of the newly created object. The pointer should be freed by OrtReleaseSessionOptions after use
  */
@@ -219,6 +273,11 @@ ORT_API(void, OrtDisableMemPattern, _In_ OrtSessionOptions* options);
 ORT_API(void, OrtEnableCpuMemArena, _In_ OrtSessionOptions* options);
 ORT_API(void, OrtDisableCpuMemArena, _In_ OrtSessionOptions* options);
 
+// Serve small allocations of the CPU memory arena from per-thread caches, so concurrent Run calls don't contend
+// on the arena lock. Each thread keeps up to 1MB of free memory cached. Disabled by default.
+ORT_API(void, OrtEnableCpuMemArenaThreadCache, _In_ OrtSessionOptions* options);
+ORT_API(void, OrtDisableCpuMemArenaThreadCache, _In_ OrtSessionOptions* options);
+
 // < logger id to use for session output
 ORT_API(void, OrtSetSessionLogId, _In_ OrtSessionOptions* options, const char* logid);
 
@@ -236,6 +295,31 @@ ORT_API(int, OrtSetSessionGraphOptimizationLevel, _In_ OrtSessionOptions* option
 // How many threads in the session thread pool.
 ORT_API(int, OrtSetSessionThreadPoolSize, _In_ OrtSessionOptions* options, int session_thread_pool_size);
 
+// How many threads run the requests queued by OrtRunAsync. 0 (the default) uses the number of hardware threads.
+// Returns -1 if negative.
+ORT_API(int, OrtSetSessionInterOpNumThreads, _In_ OrtSessionOptions* options, int inter_op_num_threads);
+
+// How many threads, including the calling thread, kernels can use to parallelize their work.
+// 0 (the default) uses the process-wide thread pool created with the environment. Returns -1 if negative.
+ORT_API(int, OrtSetSessionIntraOpNumThreads, _In_ OrtSessionOptions* options, int intra_op_num_threads);
+
+// Pin the threads of the session's intra-op thread pool to the given logical processors. Pool thread i runs on
+// processors[i % processor_count] and the calling thread is not pinned. A processor_count of 0 (the default) pins
+// nothing. Otherwise the session creates its own intra-op thread pool, which has one thread per processor plus
+// the calling thread unless OrtSetSessionIntraOpNumThreads sets its size. Returns -1 if processors is null.
+ORT_API(int, OrtSetSessionIntraOpThreadAffinity, _In_ OrtSessionOptions* options,
+        _In_opt_ const size_t* processors, size_t processor_count);
+
+// Let CPU initializers point into the memory-mapped external data files and the loaded model instead of being
+// copied. Mapped pages are shared between sessions and processes loading the same files.
+ORT_API(void, OrtEnableZeroCopyInitializers, _In_ OrtSessionOptions* options);
+ORT_API(void, OrtDisableZeroCopyInitializers, _In_ OrtSessionOptions* options);
+
+// Share the CPU initializers with other sessions in the process that load the same model file with the same
+// optimization level and execution providers, so the weights are held once.
+ORT_API(void, OrtEnableSharedInitializers, _In_ OrtSessionOptions* options);
+ORT_API(void, OrtDisableSharedInitializers, _In_ OrtSessionOptions* options);
+
 /**
   * To use additional providers, you must build ORT with the extra providers enabled. Then call one of these
   * functions to enable them in the session:
@@ -73,6 +73,13 @@ struct default_delete<OrtSessionOptions> {
     OrtReleaseSessionOptions(ptr);
   }
 };
+
+template <>
+struct default_delete<OrtPreparedRun> {
+  void operator()(OrtPreparedRun* ptr) {
+    OrtReleasePreparedRun(ptr);
+  }
+};
 }  // namespace std
 
 namespace onnxruntime {
@@ -94,6 +101,12 @@ class SessionOptionsWrapper {
   ORT_REDIRECT_SIMPLE_FUNCTION_CALL(DisableMemPattern)
   ORT_REDIRECT_SIMPLE_FUNCTION_CALL(EnableCpuMemArena)
   ORT_REDIRECT_SIMPLE_FUNCTION_CALL(DisableCpuMemArena)
+  ORT_REDIRECT_SIMPLE_FUNCTION_CALL(EnableCpuMemArenaThreadCache)
+  ORT_REDIRECT_SIMPLE_FUNCTION_CALL(DisableCpuMemArenaThreadCache)
+  ORT_REDIRECT_SIMPLE_FUNCTION_CALL(EnableZeroCopyInitializers)
+  ORT_REDIRECT_SIMPLE_FUNCTION_CALL(DisableZeroCopyInitializers)
+  ORT_REDIRECT_SIMPLE_FUNCTION_CALL(EnableSharedInitializers)
+  ORT_REDIRECT_SIMPLE_FUNCTION_CALL(DisableSharedInitializers)
   void EnableProfiling(_In_ const ORTCHAR_T* profile_file_prefix) {
     OrtEnableProfiling(value.get(), profile_file_prefix);
   }
@@ -110,6 +123,15 @@ class SessionOptionsWrapper {
   void SetSessionThreadPoolSize(int session_thread_pool_size) {
     OrtSetSessionThreadPoolSize(value.get(), session_thread_pool_size);
   }
+  int SetSessionInterOpNumThreads(int inter_op_num_threads) {
+    return OrtSetSessionInterOpNumThreads(value.get(), inter_op_num_threads);
+  }
+  int SetSessionIntraOpNumThreads(int intra_op_num_threads) {
+    return OrtSetSessionIntraOpNumThreads(value.get(), intra_op_num_threads);
+  }
+  int SetSessionIntraOpThreadAffinity(const std::vector<size_t>& processors) {
+    return OrtSetSessionIntraOpThreadAffinity(value.get(), processors.data(), processors.size());
+  }
 
   SessionOptionsWrapper clone() const {
     OrtSessionOptions* p = OrtCloneSessionOptions(value.get());
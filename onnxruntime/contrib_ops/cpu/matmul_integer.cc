@@ -8,7 +8,7 @@
 
 #include "contrib_ops/cpu/matmul_integer.h"
 #include "core/providers/cpu/math/matmul_helper.h"
-#include "core/util/gemmlowp_common_wrapper.h"
+#include "core/mlas/inc/mlas.h"
 
 namespace onnxruntime {
 namespace contrib {
@@ -21,28 +21,11 @@ ONNX_OPERATOR_KERNEL_EX(
     kCpuExecutionProvider,
     KernelDefBuilder()
         .TypeConstraint("T1", DataTypeImpl::GetTensorType<uint8_t>())
-        .TypeConstraint("T2", DataTypeImpl::GetTensorType<uint8_t>())
+        .TypeConstraint("T2", {DataTypeImpl::GetTensorType<uint8_t>(), DataTypeImpl::GetTensorType<int8_t>()})
         .TypeConstraint("T3", DataTypeImpl::GetTensorType<int32_t>()),
     MatMulInteger<uint8_t, uint8_t, int32_t>);
 
-Status GemmlowpMultiply(const uint8_t* lhs_data, const uint8_t* rhs_data,
-                        int32_t* result_data, const int lhs_offset, const int rhs_offset,
-                        int m, int n, int k) {
-  const std::tuple<> empty_pipeline = {};
-  // TODO exp ColMajor order for rhs and result. That may be faster
-  const auto matOrder = gemmlowp::MapOrder::RowMajor;
-  gemmlowp::MatrixMap<const std::uint8_t, matOrder> lhs(lhs_data, m, k);
-  gemmlowp::MatrixMap<const std::uint8_t, matOrder> rhs(rhs_data, k, n);
-  gemmlowp::MatrixMap<std::int32_t, matOrder> result(result_data, m, n);
-
-  gemmlowp::GemmContext gemm_context;
-  gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::int32_t,
-                                   gemmlowp::DefaultL8R8BitDepthParams>(
-      &gemm_context, lhs, rhs, &result, -lhs_offset, -rhs_offset, empty_pipeline);
-
-  return Status::OK();
-}
-
+// B may be uint8 or int8. Both are handled by the same kernel as MLAS widens B to 16 bits.
 template<>
 Status MatMulInteger<uint8_t, uint8_t, int32_t>::Compute(OpKernelContext* ctx) const {
   auto a = ctx->Input<Tensor>(0);
@@ -53,36 +36,48 @@ Status MatMulInteger<uint8_t, uint8_t, int32_t>::Compute(OpKernelContext* ctx) c
   ORT_RETURN_IF_ERROR(helper.Compute(a->Shape(), b->Shape()));
   Tensor* y = ctx->Output(0, helper.OutputShape());
 
+  const bool b_is_signed = b->DataType() == DataTypeImpl::GetType<int8_t>();
+
   // validate zero points
-  int32_t a_offset = 0;
-  int32_t b_offset = 0;
+  uint8_t a_offset = 0;
+  uint8_t b_offset = 0;
+  const Tensor* b_zero_point = nullptr;
   if (has_a_zero_point_) {
     auto a_zero_point = ctx->Input<Tensor>(2);
     ORT_ENFORCE(a_zero_point->Shape().NumDimensions() == 0 || 
         (a_zero_point->Shape().NumDimensions() == 1 && a_zero_point->Shape().GetDims().size() == 1), 
         "Currently only scalar zero_point is supported. TODO: add per channel zero point support.");
-    a_offset = static_cast<int32_t>(*a_zero_point->template Data<uint8_t>());
+    a_offset = *a_zero_point->template Data<uint8_t>();
   }
   if (has_b_zero_point_) {
-    auto b_zero_point = ctx->Input<Tensor>(3);
+    b_zero_point = ctx->Input<Tensor>(3);
     ORT_ENFORCE(b_zero_point->Shape().NumDimensions() == 0 || 
         (b_zero_point->Shape().NumDimensions() == 1 && b_zero_point->Shape().GetDims().size() == 1),
         "Currently only scalar zero_point is supported. TODO: add per channel zero point support.");
-    b_offset = static_cast<int32_t>(*b_zero_point->template Data<uint8_t>());
+    b_offset = *static_cast<const uint8_t*>(b_zero_point->DataRaw());
   }
 
-  for (int i = 0; i < helper.OutputOffsets().size(); i++) {
-    GemmlowpMultiply(a->template Data<uint8_t>() + helper.LeftOffsets()[i],
-                     b->template Data<uint8_t>() + helper.RightOffsets()[i],
-                     y->template MutableData<int32_t>() + helper.OutputOffsets()[i],
-                     a_offset,
-                     b_offset,
-                     static_cast<int>(helper.M()),
-                     static_cast<int>(helper.N()),
-                     static_cast<int>(helper.K()));
+  const size_t M = static_cast<size_t>(helper.M());
+  const size_t N = static_cast<size_t>(helper.N());
+  const size_t K = static_cast<size_t>(helper.K());
+  const uint8_t* a_data = a->template Data<uint8_t>();
+  const uint8_t* b_data = static_cast<const uint8_t*>(b->DataRaw());
+  int32_t* y_data = y->template MutableData<int32_t>();
+
+  const void* packed_b = packed_b_.GetPackedData(*b, b_zero_point);
+
+  for (size_t i = 0; i < helper.OutputOffsets().size(); i++) {
+    if (packed_b != nullptr) {
+      MlasQgemmPacked(M, N, K, a_data + helper.LeftOffsets()[i], K, a_offset, packed_b,
+                      y_data + helper.OutputOffsets()[i], N, nullptr);
+    } else {
+      MlasQgemm(M, N, K, a_data + helper.LeftOffsets()[i], K, a_offset,
+                b_data + helper.RightOffsets()[i], N, b_offset, b_is_signed,
+                y_data + helper.OutputOffsets()[i], N, nullptr);
+    }
   }
 
   return Status::OK();
 }
 }  // namespace contrib
-}  // namespace onnxruntime
\ No newline at end of file
+}  // namespace onnxruntime
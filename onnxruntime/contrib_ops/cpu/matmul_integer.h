@@ -5,6 +5,7 @@
 
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/providers/cpu/math/prepacked_gemm_b.h"
 #include "core/util/math_cpuonly.h"
 
 namespace onnxruntime {
@@ -22,6 +23,8 @@ class MatMulInteger final : public OpKernel {
     if (info.GetInputCount() > 3) {
       has_b_zero_point_ = true;
     }
+
+    packed_b_.Pack(info, 1, has_b_zero_point_ ? 3 : -1);
   }
 
   Status Compute(OpKernelContext* context) const override;
@@ -29,6 +32,7 @@ class MatMulInteger final : public OpKernel {
  private:
   bool has_a_zero_point_;
   bool has_b_zero_point_;
+  PrePackedQgemmB packed_b_;
 };
 }  // namespace contrib
 }  // namespace onnxruntime
\ No newline at end of file
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+#include "core/providers/cpu/nn/conv_base.h"
+#include "core/providers/cpu/nn/pool_base.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+class ReorderInput : public OpKernel {
+ public:
+  ReorderInput(const OpKernelInfo& info) : OpKernel(info) {
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+class ReorderOutput : public OpKernel {
+ public:
+  ReorderOutput(const OpKernelInfo& info) : OpKernel(info) {
+    ORT_ENFORCE(info.GetAttr<int64_t>("channels", &channels_).IsOK());
+    ORT_ENFORCE(channels_ > 0, "invalid channel count");
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  int64_t channels_;
+};
+
+class NchwcConv : public OpKernel, public ConvBase {
+ public:
+  NchwcConv(const OpKernelInfo& info) : OpKernel(info), ConvBase(info) {
+    activation_ = info.GetAttrOrDefault<std::string>("activation", "");
+    alpha_ = info.GetAttrOrDefault("alpha", 0.01f);
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+class NchwcPoolBase : public PoolBase {
+ public:
+  NchwcPoolBase(const OpKernelInfo& info) : PoolBase(info) {
+  }
+
+  Status NchwcPool(OpKernelContext* context, MLAS_POOLING_KIND kind) const;
+};
+
+class NchwcMaxPool : public OpKernel, public NchwcPoolBase {
+ public:
+  NchwcMaxPool(const OpKernelInfo& info) : OpKernel(info), NchwcPoolBase(info) {
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+class NchwcAveragePool : public OpKernel, public NchwcPoolBase {
+ public:
+  NchwcAveragePool(const OpKernelInfo& info) : OpKernel(info), NchwcPoolBase(info) {
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
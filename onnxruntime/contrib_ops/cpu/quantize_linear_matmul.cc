@@ -8,7 +8,7 @@
 
 #include "contrib_ops/cpu/quantize_linear_matmul.h"
 #include "core/providers/cpu/math/matmul_helper.h"
-#include "core/util/gemmlowp_common_wrapper.h"
+#include "core/mlas/inc/mlas.h"
 
 namespace onnxruntime {
 namespace contrib {
@@ -21,51 +21,10 @@ ONNX_OPERATOR_KERNEL_EX(
     kCpuExecutionProvider,
     KernelDefBuilder()
         .TypeConstraint("T1", DataTypeImpl::GetTensorType<uint8_t>())
-        .TypeConstraint("T2", DataTypeImpl::GetTensorType<uint8_t>())
+        .TypeConstraint("T2", {DataTypeImpl::GetTensorType<uint8_t>(), DataTypeImpl::GetTensorType<int8_t>()})
         .TypeConstraint("T3", DataTypeImpl::GetTensorType<uint8_t>()),
     QLinearMatMul<uint8_t, uint8_t, uint8_t>);
 
-Status GemmlowpMultiply(const uint8_t* lhs_data, const uint8_t* rhs_data, uint8_t* result_data,
-                        const int lhs_offset, const int rhs_offset, const int result_offset,
-                        int m, int n, int k, int32_t int_multiplier, int32_t right_shift) {
-  gemmlowp::OutputStageQuantizeDownInt32ByFixedPoint quantize_down_stage;
-  quantize_down_stage.result_offset_after_shift = result_offset;
-  quantize_down_stage.result_fixedpoint_multiplier = int_multiplier;
-  quantize_down_stage.result_shift = right_shift;
-  gemmlowp::OutputStageSaturatingCastToUint8 saturating_cast_stage;
-  const auto& output_pipeline = std::make_tuple(quantize_down_stage, saturating_cast_stage);
-
-  // TODO exp ColMajor order for rhs and result. That may be faster
-  const auto matOrder = gemmlowp::MapOrder::RowMajor;
-  gemmlowp::MatrixMap<const std::uint8_t, matOrder> lhs(lhs_data, m, k);
-  gemmlowp::MatrixMap<const std::uint8_t, matOrder> rhs(rhs_data, k, n);
-  gemmlowp::MatrixMap<std::uint8_t, matOrder> result(result_data, m, n);
-
-  gemmlowp::GemmContext gemm_context;
-  gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::uint8_t,
-                                   gemmlowp::DefaultL8R8BitDepthParams>(
-      &gemm_context, lhs, rhs, &result, -lhs_offset, -rhs_offset, output_pipeline);
-
-  return Status::OK();
-}
-
-void QuantizeMultiplier(float fp_multiplier, std::int32_t* integer_multiplier, int* right_shift) {
-  uint32_t* fp_as_bits = reinterpret_cast<uint32_t*>(&fp_multiplier);
-  auto current_exponent = (*fp_as_bits >> 23);
-  // bring multiplier in [.5,1) range and calculate the shift
-  auto bumped_multiplier_as_bits = 
-      (*fp_as_bits & UINT32_C(0x007fffff)) | UINT32_C(0x3f000000);
-  float* bumped_multiplier = 
-      reinterpret_cast<float*>(&bumped_multiplier_as_bits);
-  auto shift = 126 - current_exponent;
-  // convert to fixed point number
-  std::int64_t int_multiplier = 
-      static_cast<std::int64_t>(std::round(*bumped_multiplier * (1ll << 31)));
-
-  *integer_multiplier = static_cast<int32_t>(int_multiplier);
-  *right_shift = shift;
-}
-
 void ScaleAndZeropointPairValidationHelper(const Tensor* scale, const Tensor* zeropoint) {
   ORT_ENFORCE(scale->Shape().NumDimensions() == 0 || 
       (scale->Shape().NumDimensions() == 1 && scale->Shape().GetDims().size() == 1), 
@@ -100,23 +59,41 @@ Status QLinearMatMul<uint8_t, uint8_t, uint8_t>::Compute(OpKernelContext* ctx) c
   auto b_scale_data = *(b_scale->template Data<float>());
   auto y_scale_data = *(y_scale->template Data<float>());
 
-  const float real_multiplier = (a_scale_data * b_scale_data) / y_scale_data;
-  int32_t integer_multiplier;
-  int right_shift;
-  QuantizeMultiplier(real_multiplier, &integer_multiplier, &right_shift);
-
-  for (int i = 0; i < helper.OutputOffsets().size(); i++) {
-    GemmlowpMultiply(a->template Data<uint8_t>() + helper.LeftOffsets()[i],
-                     b->template Data<uint8_t>() + helper.RightOffsets()[i],
-                     y->template MutableData<uint8_t>() + helper.OutputOffsets()[i],
-                     *a_zero_point->template Data<uint8_t>(),
-                     *b_zero_point->template Data<uint8_t>(),
-                     *y_zero_point->template Data<uint8_t>(),
-                     static_cast<int>(helper.M()),
-                     static_cast<int>(helper.N()),
-                     static_cast<int>(helper.K()),
-                     integer_multiplier,
-                     right_shift);
+  const size_t M = static_cast<size_t>(helper.M());
+  const size_t N = static_cast<size_t>(helper.N());
+  const size_t K = static_cast<size_t>(helper.K());
+  const bool b_is_signed = b->DataType() == DataTypeImpl::GetType<int8_t>();
+  const uint8_t* a_data = a->template Data<uint8_t>();
+  const uint8_t* b_data = static_cast<const uint8_t*>(b->DataRaw());
+  uint8_t* y_data = y->template MutableData<uint8_t>();
+
+  // the 32-bit results of each matrix are requantized to the output by MLAS as soon as a block is complete
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(ctx->GetTempSpaceAllocator(&alloc));
+  auto gemm_output_data = alloc->Alloc(sizeof(int32_t) * M * N);
+  BufferUniquePtr gemm_output_buffer(gemm_output_data, BufferDeleter(alloc));
+  auto* gemm_output = static_cast<int32_t*>(gemm_output_buffer.get());
+
+  MLAS_QGEMM_REQUANTIZE_PARAMETERS requantize;
+  requantize.ldo = N;
+  requantize.Bias = nullptr;
+  requantize.Scale = (a_scale_data * b_scale_data) / y_scale_data;
+  requantize.ZeroPoint = *y_zero_point->template Data<uint8_t>();
+
+  const uint8_t a_offset = *a_zero_point->template Data<uint8_t>();
+  const uint8_t b_offset = *static_cast<const uint8_t*>(b_zero_point->DataRaw());
+  const void* packed_b = packed_b_.GetPackedData(*b, b_zero_point);
+
+  for (size_t i = 0; i < helper.OutputOffsets().size(); i++) {
+    requantize.Output = y_data + helper.OutputOffsets()[i];
+    if (packed_b != nullptr) {
+      MlasQgemmPacked(M, N, K, a_data + helper.LeftOffsets()[i], K, a_offset, packed_b,
+                      gemm_output, N, &requantize);
+    } else {
+      MlasQgemm(M, N, K, a_data + helper.LeftOffsets()[i], K, a_offset,
+                b_data + helper.RightOffsets()[i], N, b_offset, b_is_signed,
+                gemm_output, N, &requantize);
+    }
   }
 
   return Status::OK();
@@ -5,6 +5,7 @@
 
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/providers/cpu/math/prepacked_gemm_b.h"
 #include "core/util/math_cpuonly.h"
 
 namespace onnxruntime {
@@ -14,10 +15,13 @@ template <typename T1, typename T2, typename T3>
 class QLinearMatMul final : public OpKernel {
  public:
   QLinearMatMul(const OpKernelInfo& info) : OpKernel(info) {
+    packed_b_.Pack(info, 3, 5);
   }
 
   Status Compute(OpKernelContext* context) const override;
-  
+
+ private:
+  PrePackedQgemmB packed_b_;
 };
 }  // namespace contrib
 }  // namespace onnxruntime
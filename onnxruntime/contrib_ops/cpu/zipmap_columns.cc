@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "contrib_ops/cpu/zipmap_columns.h"
+
+#include <algorithm>
+
+#include "core/providers/cpu/tensor/utils.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+ONNX_OPERATOR_KERNEL_EX(
+    ZipMapColumns,
+    kMSDomain,
+    1,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .Alias(0, 0)
+        .TypeConstraint("T", std::vector<MLDataType>{DataTypeImpl::GetTensorType<std::string>(),
+                                                     DataTypeImpl::GetTensorType<int64_t>()}),
+    ZipMapColumns);
+
+ZipMapColumns::ZipMapColumns(const OpKernelInfo& info)
+    : OpKernel(info),
+      classlabels_int64s_(info.GetAttrsOrDefault<int64_t>("classlabels_int64s")),
+      classlabels_strings_(info.GetAttrsOrDefault<std::string>("classlabels_strings")) {
+  ORT_ENFORCE(classlabels_strings_.empty() ^ classlabels_int64s_.empty(),
+              "Must provide classlabels_strings or classlabels_int64s but not both.");
+  using_strings_ = !classlabels_strings_.empty();
+}
+
+Status ZipMapColumns::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  if (X == nullptr) return Status(common::ONNXRUNTIME, common::FAIL, "input count mismatch");
+  const std::vector<int64_t>& x_dims = X->Shape().GetDims();
+
+  if (x_dims.empty() || x_dims.size() > 2) {
+    return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
+                  "ZipMapColumns only supports 1D or 2D input tensors");
+  }
+
+  const int64_t batch_size = x_dims.size() > 1 ? x_dims[0] : 1;
+  const int64_t features_per_batch = x_dims.back();
+  const int64_t class_count = using_strings_ ? static_cast<int64_t>(classlabels_strings_.size())
+                                             : static_cast<int64_t>(classlabels_int64s_.size());
+
+  if (features_per_batch != class_count) {
+    return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
+                  "Input features_per_batch[" + std::to_string(features_per_batch) +
+                      "] != number of classlabels[" + std::to_string(class_count) + "]");
+  }
+
+  // Y aliases X, so the probabilities are normally passed through without a copy.
+  Tensor* Y = context->Output(0, TensorShape({batch_size, class_count}));
+  CopyCpuTensor(X, Y);
+
+  Tensor* Z = context->Output(1, TensorShape({class_count}));
+  if (using_strings_) {
+    std::copy(classlabels_strings_.begin(), classlabels_strings_.end(), Z->template MutableData<std::string>());
+  } else {
+    std::copy(classlabels_int64s_.begin(), classlabels_int64s_.end(), Z->template MutableData<int64_t>());
+  }
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
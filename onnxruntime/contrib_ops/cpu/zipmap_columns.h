@@ -0,0 +1,29 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+/*
+Columnar variant of ai.onnx.ml.ZipMap. The probabilities are forwarded as a dense [N, C]
+tensor and the class labels are emitted once as a [C] tensor, instead of one std::map per row.
+*/
+class ZipMapColumns final : public OpKernel {
+ public:
+  explicit ZipMapColumns(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  bool using_strings_;
+  std::vector<int64_t> classlabels_int64s_;
+  std::vector<std::string> classlabels_strings_;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
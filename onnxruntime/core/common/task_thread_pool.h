@@ -138,6 +138,11 @@ class TaskThreadPool {
     condition_.notify_one();
   }
 
+  /// @brief Number of worker threads in the pool. Matches Eigen::ThreadPool::NumThreads.
+  int NumThreads() const {
+    return static_cast<int>(total_);
+  }
+
   /// @brief Wait for queue to be empty
   void WaitWorkComplete() {
     std::unique_lock<OrtMutex> lock(mutex_);
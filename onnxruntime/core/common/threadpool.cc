@@ -0,0 +1,175 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "core/platform/env.h"
+#include "core/platform/ort_mutex.h"
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4267)
+#endif
+#include <unsupported/Eigen/CXX11/ThreadPool>
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+namespace onnxruntime {
+
+namespace {
+// Eigen thread pool environment that creates the pool threads via Env so they can be pinned to processors.
+class ThreadPoolEnvironment {
+ public:
+  using EnvThread = Thread;
+  using Task = Env::Task;
+
+  explicit ThreadPoolEnvironment(std::vector<size_t> thread_affinity)
+      : thread_affinity_{std::move(thread_affinity)} {}
+
+  EnvThread* CreateThread(std::function<void()> f) {
+    ThreadOptions thread_options;
+    if (!thread_affinity_.empty()) {
+      // the threads are created in order, so thread i runs on the i-th listed processor
+      thread_options.affinity.push_back(thread_affinity_[num_threads_created_++ % thread_affinity_.size()]);
+    }
+
+    return Env::Default().StartThread(thread_options, "onnxruntime_intra_op", std::move(f));
+  }
+
+  Task CreateTask(std::function<void()> f) { return Task{std::move(f)}; }
+  void ExecuteTask(const Task& t) { t.f(); }
+
+ private:
+  std::vector<size_t> thread_affinity_;
+  size_t num_threads_created_ = 0;
+};
+}  // namespace
+
+class ThreadPool::Impl {
+ public:
+  using EigenThreadPool = Eigen::NonBlockingThreadPoolTempl<ThreadPoolEnvironment>;
+
+  Impl(int num_threads, std::vector<size_t> thread_affinity) {
+    if (num_threads > 0) {
+      eigen_pool_ = std::make_unique<EigenThreadPool>(num_threads,
+                                                      ThreadPoolEnvironment(std::move(thread_affinity)));
+    }
+  }
+
+  // null if the pool has no threads, in which case all work runs on the calling thread
+  std::unique_ptr<EigenThreadPool> eigen_pool_;
+};
+
+ThreadPool::ThreadPool(int degree_of_parallelism, std::vector<size_t> thread_affinity) {
+  if (degree_of_parallelism <= 0) {
+    degree_of_parallelism = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+
+  impl_ = std::make_unique<Impl>(degree_of_parallelism - 1, std::move(thread_affinity));
+}
+
+ThreadPool::~ThreadPool() = default;
+
+void ThreadPool::Schedule(std::function<void()> fn) {
+  if (impl_->eigen_pool_ != nullptr) {
+    impl_->eigen_pool_->Schedule(std::move(fn));
+  } else {
+    fn();
+  }
+}
+
+int ThreadPool::NumThreads() const {
+  return impl_->eigen_pool_ != nullptr ? impl_->eigen_pool_->NumThreads() : 0;
+}
+
+int ThreadPool::CurrentThreadId() const {
+  return impl_->eigen_pool_ != nullptr ? impl_->eigen_pool_->CurrentThreadId() : -1;
+}
+
+void ThreadPool::ParallelFor(int32_t total, const std::function<void(int32_t)>& fn) {
+  if (total <= 0) {
+    return;
+  }
+
+  const int num_threads = NumThreads();
+  if (total == 1 || num_threads == 0) {
+    for (int32_t i = 0; i < total; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  // The state is shared with the scheduled helpers as a helper may only start running after all the iterations
+  // have been claimed and this call has returned. Such a helper fails to claim an iteration and never touches fn.
+  struct ParallelForState {
+    const std::function<void(int32_t)>* fn;
+    int32_t total;
+    std::atomic<int32_t> next{0};
+    std::atomic<int32_t> remaining;
+    OrtMutex mutex;
+    OrtCondVar cv;
+  };
+
+  auto state = std::make_shared<ParallelForState>();
+  state->fn = &fn;
+  state->total = total;
+  state->remaining = total;
+
+  auto run_iterations = [state]() {
+    for (;;) {
+      int32_t i = state->next.fetch_add(1);
+      if (i >= state->total) {
+        break;
+      }
+
+      (*state->fn)(i);
+
+      if (state->remaining.fetch_sub(1) == 1) {
+        std::lock_guard<OrtMutex> lock(state->mutex);
+        state->cv.notify_all();
+      }
+    }
+  };
+
+  const int num_helpers = std::min(num_threads, static_cast<int>(total) - 1);
+  for (int i = 0; i < num_helpers; ++i) {
+    impl_->eigen_pool_->Schedule(run_iterations);
+  }
+
+  // the calling thread claims iterations as well so this makes progress even if all pool threads are busy
+  run_iterations();
+
+  std::unique_lock<OrtMutex> lock(state->mutex);
+  while (state->remaining > 0) {
+    state->cv.wait(lock);
+  }
+}
+
+constexpr int64_t ThreadPool::kMinWorkPerTask;
+
+int64_t ThreadPool::TaskCount(const ThreadPool* tp, int64_t total, int64_t total_work) {
+  if (tp == nullptr) {
+    return 1;
+  }
+  return std::min({static_cast<int64_t>(tp->DegreeOfParallelism()), total, total_work / kMinWorkPerTask});
+}
+
+void ThreadPool::TryParallelFor(ThreadPool* tp, int64_t total, int64_t total_work,
+                                const std::function<void(int64_t, int64_t)>& fn) {
+  const int64_t task_count = TaskCount(tp, total, total_work);
+  if (task_count <= 1) {
+    fn(0, total);
+    return;
+  }
+
+  tp->ParallelFor(static_cast<int32_t>(task_count), [&](int32_t task) {
+    fn(total * task / task_count, total * (task + 1) / task_count);
+  });
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,79 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "core/common/common.h"
+
+namespace onnxruntime {
+
+/**
+  * Thread pool for intra-op parallelism (i.e. work that is split up inside a single kernel).
+  *
+  * The calling thread always takes part in ParallelFor, so the pool is created with one thread fewer than the
+  * requested degree of parallelism and ParallelFor can be safely called from a task that is already running on
+  * the pool.
+  */
+class ThreadPool {
+ public:
+  /**
+     Create a pool that runs work on up to degree_of_parallelism threads, including the calling thread.
+     If degree_of_parallelism is 0 the number of hardware threads is used.
+     If thread_affinity is not empty, pool thread i is restricted to logical processor
+     thread_affinity[i % thread_affinity.size()]. The calling thread is never pinned.
+  */
+  explicit ThreadPool(int degree_of_parallelism = 0, std::vector<size_t> thread_affinity = {});
+  ~ThreadPool();
+
+  /** Schedule fn to be run on one of the pool threads. */
+  void Schedule(std::function<void()> fn);
+
+  /**
+     Run fn(i) for i in [0, total) and wait for all calls to complete.
+     Iterations are claimed dynamically by the calling thread and the pool threads. fn must not throw.
+  */
+  void ParallelFor(int32_t total, const std::function<void(int32_t)>& fn);
+
+  /**
+     Minimum amount of work for each task of TryParallelFor, in units of about one element read or written.
+     Most kernels that split their work this way are limited by memory bandwidth, so smaller pieces of work don't
+     gain enough to pay for handing them to the pool.
+  */
+  static constexpr int64_t kMinWorkPerTask = 32 * 1024;
+
+  /**
+     Number of tasks TryParallelFor splits a loop of total iterations into: no more than total or the degree of
+     parallelism of tp, and few enough that each task gets at least kMinWorkPerTask of total_work.
+     Returns 1 or less if the loop should run on the calling thread, including when tp is null.
+  */
+  static int64_t TaskCount(const ThreadPool* tp, int64_t total, int64_t total_work);
+
+  /**
+     Call fn(begin, end) for contiguous ranges that cover [0, total), splitting the loop into TaskCount ranges run
+     by ParallelFor on tp. If the loop isn't worth splitting fn(0, total) is called on the calling thread.
+     total_work estimates the work of the whole loop, see kMinWorkPerTask. tp may be null. fn must not throw.
+  */
+  static void TryParallelFor(ThreadPool* tp, int64_t total, int64_t total_work,
+                             const std::function<void(int64_t, int64_t)>& fn);
+
+  /** Maximum number of threads that can run ParallelFor iterations concurrently, including the calling thread. */
+  int DegreeOfParallelism() const { return NumThreads() + 1; }
+
+  /** Number of threads owned by the pool. */
+  int NumThreads() const;
+
+  /** Index of the current pool thread in [0, NumThreads()), or -1 if not called from a pool thread. */
+  int CurrentThreadId() const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ThreadPool);
+
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace onnxruntime
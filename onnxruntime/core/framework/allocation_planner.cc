@@ -272,22 +272,48 @@ class PlannerImpl {
     return elt_type->Size();
   }
 
+  bool IsStringTensor(const DataType& tensor_type) {
+    const TypeProto& type_proto = ONNX_NAMESPACE::Utils::DataTypeUtils::ToTypeProto(tensor_type);
+    return type_proto.has_tensor_type() && type_proto.tensor_type().elem_type() == TensorProto_DataType_STRING;
+  }
+
+  // The size of a tensor in bytes is known_bytes times the product of the values of symbolic_dims.
+  // Two buffers with the same symbolic dims can be compared at planning time, as a given dim_param has
+  // the same value everywhere in the graph at execution time.
+  struct SymbolicSize {
+    size_t known_bytes;
+    std::vector<std::string> symbolic_dims;  // sorted
+  };
+
+  // Returns false if some dimension is neither a known value nor a dim_param.
+  bool GetSymbolicSize(const TensorShapeProto& shape, const DataType& tensor_type, SymbolicSize& size) {
+    size.known_bytes = GetElementSize(tensor_type);
+    size.symbolic_dims.clear();
+    for (int i = 0, rank = shape.dim_size(); i < rank; i++) {
+      const auto& dim = shape.dim(i);
+      if (dim.has_dim_value() && dim.dim_value() >= 0) {
+        size.known_bytes *= static_cast<size_t>(dim.dim_value());
+      } else if (dim.has_dim_param() && !dim.dim_param().empty()) {
+        size.symbolic_dims.push_back(dim.dim_param());
+      } else {
+        return false;
+      }
+    }
+    std::sort(size.symbolic_dims.begin(), size.symbolic_dims.end());
+    return true;
+  }
+
   bool SameSize(const TensorShapeProto& shape1, const DataType& ptype1,
                 const TensorShapeProto& shape2, const DataType& ptype2) {
-    return (GetElementSize(ptype1) == GetElementSize(ptype2)) && SameShape(shape1, shape2);
-
-    /* TODO: we can improve this if the concrete shapes are known for both as below.
-       Unclear whether this is worthwhile though.
-    if (KnownSize(p_shape1) && KnownSize(p_shape2)) {
-      // Comparison of statically-known size
-      auto size1 = NumElements(p_shape1) * EltSize(ptype1);
-      auto size2 = NumElements(p_shape2) * EltSize(ptype2);
-      return size1 == size2;
-    } else {
-      // Comparison of statically-unknown size buffers
-      return SameElementSize(ptype1, ptype2) && SameShape(shape1, shape2);
+    // a string tensor holds std::string objects rather than plain data, so only match it with the same shape
+    if (IsStringTensor(ptype1) || IsStringTensor(ptype2)) {
+      return IsStringTensor(ptype1) && IsStringTensor(ptype2) && SameShape(shape1, shape2);
     }
-    */
+
+    // compare the sizes in bytes, so e.g. float[batch, 2, 8] and float[batch, 16] have the same size
+    SymbolicSize size1, size2;
+    return GetSymbolicSize(shape1, ptype1, size1) && GetSymbolicSize(shape2, ptype2, size2) &&
+           size1.known_bytes == size2.known_bytes && size1.symbolic_dims == size2.symbolic_dims;
   }
 
   bool SameSize(const onnxruntime::NodeArg& arg1, const onnxruntime::NodeArg& arg2) {
@@ -299,30 +325,53 @@ class PlannerImpl {
     return SameSize(*p_shape1, arg1.Type(), *p_shape2, arg2.Type());
   }
 
-  // Find if freelist contains a buffer of the same size as output_arg
+  // Find the best fitting buffer in the freelist for output_arg: the one of the same size or, failing that, the one
+  // that is larger by the least number of bytes. Sizes involving dim_params are only compared if the dim_params
+  // are the same. Among buffers of the same size the most recently freed one is used.
   bool FindReusableTensor(const onnxruntime::NodeArg& output_arg, MLValueIndex* reusable_tensor) {
     auto p_required_buffer_shape = context_.GetShape(output_arg);
     if (nullptr == p_required_buffer_shape) return false;
     auto required_buffer_type = output_arg.Type();
     auto& required_allocator_info = AllocPlan(output_arg.Name()).location;
 
+    SymbolicSize required_size;
+    const bool can_use_larger_buffer = !IsStringTensor(required_buffer_type) &&
+                                       GetSymbolicSize(*p_required_buffer_shape, required_buffer_type, required_size);
+
+    auto best_fit = freelist_.end();
+    size_t best_fit_waste = 0;
+    SymbolicSize available_size;
     for (auto it = freelist_.begin(); it != freelist_.end(); ++it) {
       auto reusable = it->ml_value;
       auto p_node_arg = ml_value_info_.at(reusable).p_def_site;
       auto& available_allocator_info = AllocPlan(p_node_arg->Name()).location;
       if (!(available_allocator_info == required_allocator_info)) continue;
       auto p_available_buffer_shape = context_.GetShape(*p_node_arg);
-      if (nullptr != p_available_buffer_shape) {
-        auto available_buffer_type = p_node_arg->Type();
-        if (SameSize(*p_available_buffer_shape, available_buffer_type,
-                     *p_required_buffer_shape, required_buffer_type)) {
-          *reusable_tensor = reusable;
-          freelist_.erase(it);
-          return true;
+      if (nullptr == p_available_buffer_shape) continue;
+      auto available_buffer_type = p_node_arg->Type();
+      if (SameSize(*p_available_buffer_shape, available_buffer_type,
+                   *p_required_buffer_shape, required_buffer_type)) {
+        best_fit = it;
+        break;
+      }
+
+      if (can_use_larger_buffer && !IsStringTensor(available_buffer_type) &&
+          GetSymbolicSize(*p_available_buffer_shape, available_buffer_type, available_size) &&
+          available_size.symbolic_dims == required_size.symbolic_dims &&
+          available_size.known_bytes > required_size.known_bytes) {
+        size_t waste = available_size.known_bytes - required_size.known_bytes;
+        if (best_fit == freelist_.end() || waste < best_fit_waste) {
+          best_fit = it;
+          best_fit_waste = waste;
         }
       }
     }
-    return false;
+
+    if (best_fit == freelist_.end()) return false;
+
+    *reusable_tensor = best_fit->ml_value;
+    freelist_.erase(best_fit);
+    return true;
   }
 
   void Initialize(size_t num_graph_nodes, size_t num_ml_values) {
@@ -647,4 +696,84 @@ Status SequentialPlanner::CreatePlan(const Node* parent_node,
   return planner.CreatePlan();
 }
 
+// Get the size in bytes of a tensor NodeArg. Returns false if the NodeArg isn't a tensor or its size isn't known.
+static bool GetTensorSizeInBytes(const NodeArg& arg, const ISequentialPlannerContext& context,
+                                 const std::unordered_map<std::string, int64_t>& symbolic_dims, size_t& size) {
+  const TypeProto* type_proto = arg.TypeAsProto();
+  const TensorShapeProto* shape = context.GetShape(arg);
+  if (nullptr == type_proto || !type_proto->has_tensor_type() || nullptr == shape) return false;
+
+  const TensorTypeBase* tensor_type = DataTypeImpl::TypeFromProto(*type_proto)->AsTensorType();
+  if (nullptr == tensor_type) return false;
+
+  size = tensor_type->GetElementType()->Size();
+  for (int i = 0, rank = shape->dim_size(); i < rank; i++) {
+    const auto& dim = shape->dim(i);
+    int64_t dim_value = -1;
+    if (dim.has_dim_value()) {
+      dim_value = dim.dim_value();
+    } else if (dim.has_dim_param()) {
+      auto entry = symbolic_dims.find(dim.dim_param());
+      if (entry != symbolic_dims.cend()) dim_value = entry->second;
+    }
+
+    if (dim_value < 0) return false;
+    size *= static_cast<size_t>(dim_value);
+  }
+
+  return true;
+}
+
+Status SequentialPlanner::ComputeMemoryStats(const SequentialExecutionPlan& plan,
+                                             const onnxruntime::GraphViewer& graph,
+                                             const MLValueNameIdxMap& mlvalue_name_idx_map,
+                                             const ISequentialPlannerContext& context,
+                                             const std::unordered_map<std::string, int64_t>& symbolic_dims,
+                                             AllocationPlanMemoryStats& stats) {
+  stats = AllocationPlanMemoryStats{};
+
+  // size of the buffer allocated for each value. 0 if the value doesn't own a buffer or its size is unknown.
+  std::vector<size_t> buffer_sizes(plan.allocation_plan.size(), 0);
+  size_t live_bytes = 0;
+
+  for (const auto& node_plan : plan.execution_plan) {
+    const Node* node = graph.GetNode(node_plan.node_index);
+    ORT_ENFORCE(node, "Node with index ", node_plan.node_index, " was not found in the graph.");
+
+    for (const auto* output : node->OutputDefs()) {
+      if (!output->Exists()) continue;
+
+      int index;
+      ORT_RETURN_IF_ERROR(mlvalue_name_idx_map.GetIdx(output->Name(), index));
+      const AllocKind alloc_kind = plan.allocation_plan.at(index).alloc_kind;
+      if (alloc_kind != AllocKind::kAllocate && alloc_kind != AllocKind::kAllocateOutput &&
+          alloc_kind != AllocKind::kReuse) {
+        continue;
+      }
+
+      size_t size;
+      if (!GetTensorSizeInBytes(*output, context, symbolic_dims, size)) {
+        ++stats.num_unknown_size_values;
+        continue;
+      }
+
+      stats.naive_peak_bytes += size;
+
+      if (alloc_kind != AllocKind::kReuse) {
+        buffer_sizes[index] = size;
+        live_bytes += size;
+      }
+    }
+
+    // the outputs are allocated while the inputs are still alive, so the peak is before the frees of this step
+    stats.planned_peak_bytes = std::max(stats.planned_peak_bytes, live_bytes);
+
+    for (int i = node_plan.free_from_index; i <= node_plan.free_to_index; ++i) {
+      live_bytes -= buffer_sizes[plan.to_be_freed[i]];
+    }
+  }
+
+  return Status::OK();
+}
+
 }  // namespace onnxruntime
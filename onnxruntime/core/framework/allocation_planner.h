@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <string>
+#include <unordered_map>
+
 #include "core/common/status.h"
 #include "core/framework/alloc_kind.h"
 #include "core/framework/allocator.h"
@@ -47,6 +50,17 @@ class SequentialPlannerContext : public ISequentialPlannerContext {
   bool m_enable_parallel_execution;
 };
 
+// Memory used by the tensors that are allocated while executing a plan (intermediate values and graph outputs,
+// but not graph inputs or initializers).
+struct AllocationPlanMemoryStats {
+  // total size if every tensor had a buffer of its own, i.e. if the plan reused no buffers
+  size_t naive_peak_bytes = 0;
+  // peak size of the buffers allocated by the plan, taking reuse and the points the buffers are freed into account
+  size_t planned_peak_bytes = 0;
+  // number of tensors whose size is not known. they're excluded from the byte counts above.
+  size_t num_unknown_size_values = 0;
+};
+
 class SequentialPlanner {
  public:
   // This API allows user to provide a custom planner context.
@@ -72,6 +86,25 @@ class SequentialPlanner {
     return CreatePlan(parent_node, graph, outer_scope_node_args, providers, kernel_registry, mlvalue_name_idx_map,
                       context, plan);
   }
+
+  // Compute the memory statistics of a plan created for graph, using the shapes provided by context.
+  // symbolic_dims provides values for the dim_params in the tensor shapes.
+  static Status ComputeMemoryStats(const SequentialExecutionPlan& plan,
+                                   const onnxruntime::GraphViewer& graph,
+                                   const MLValueNameIdxMap& mlvalue_name_idx_map,
+                                   const ISequentialPlannerContext& context,
+                                   const std::unordered_map<std::string, int64_t>& symbolic_dims,
+                                   AllocationPlanMemoryStats& stats);
+
+  // Compute the memory statistics of a plan created for graph using the inferred shapes.
+  static Status ComputeMemoryStats(const SequentialExecutionPlan& plan,
+                                   const onnxruntime::GraphViewer& graph,
+                                   const MLValueNameIdxMap& mlvalue_name_idx_map,
+                                   const std::unordered_map<std::string, int64_t>& symbolic_dims,
+                                   AllocationPlanMemoryStats& stats) {
+    SequentialPlannerContext context;
+    return ComputeMemoryStats(plan, graph, mlvalue_name_idx_map, context, symbolic_dims, stats);
+  }
 };
 
 }  // namespace onnxruntime
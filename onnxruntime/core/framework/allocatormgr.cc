@@ -16,7 +16,7 @@ AllocatorPtr CreateAllocator(DeviceAllocatorRegistrationInfo info, int device_id
   auto device_allocator = std::unique_ptr<IDeviceAllocator>(info.factory(device_id));
   if (device_allocator->AllowsArena())
     return std::shared_ptr<IArenaAllocator>(
-        std::make_unique<BFCArena>(std::move(device_allocator), info.max_mem));
+        std::make_unique<BFCArena>(std::move(device_allocator), info.max_mem, info.enable_arena_thread_cache));
 
   return device_allocator;
 }
@@ -14,6 +14,8 @@ struct DeviceAllocatorRegistrationInfo {
   OrtMemType mem_type;
   DeviceAllocatorFactory factory;
   size_t max_mem;
+  // serve small allocations from per-thread caches in front of the arena. see BFCArena.
+  bool enable_arena_thread_cache = false;
 };
 
 AllocatorPtr CreateAllocator(DeviceAllocatorRegistrationInfo info, int device_id = 0);
@@ -3,10 +3,62 @@
 
 #include "core/framework/bfc_arena.h"
 
+#include <algorithm>
+
 namespace onnxruntime {
+
+// Free chunks cached by one thread for one arena.
+// Everything except remote_free_chunks is only used by the owning thread.
+class BFCArena::ThreadCache {
+ public:
+  explicit ThreadCache(BFCArena* a) : arena{a} {}
+
+  // the arena, or nullptr once the arena has been destroyed. protected by ThreadCacheMutex().
+  std::atomic<BFCArena*> arena;
+
+  // the free chunks of each size class. the most recently freed chunk is last.
+  std::vector<void*> free_chunks[kNumCacheSizeClasses];
+
+  // the size class of every chunk owned by this cache, whether it's in a free list or has been handed out
+  std::unordered_map<void*, int> owned_chunks;
+
+  // chunks owned by this cache that were freed by other threads. protected by the arena lock_.
+  std::vector<void*> remote_free_chunks;
+
+  // written by the owning thread only, read by GetStats
+  std::atomic<int64_t> num_hits{0};
+  std::atomic<int64_t> num_misses{0};
+};
+
+// Releases the thread caches of a thread when the thread exits.
+class BFCArena::ThreadCacheList {
+ public:
+  ~ThreadCacheList() {
+    for (auto& cache : caches) {
+      BFCArena::ReleaseThreadCache(*cache);
+    }
+  }
+
+  std::vector<std::shared_ptr<ThreadCache>> caches;
+};
+
+// Serializes releasing a thread cache on thread exit with destroying its arena.
+// Never destroyed, as arenas and threads may go away in any order during shutdown.
+static OrtMutex& ThreadCacheMutex() {
+  static OrtMutex* mutex = new OrtMutex();
+  return *mutex;
+}
+
+// single writer, so a relaxed load and store is enough and avoids a locked instruction
+static void IncrementCounter(std::atomic<int64_t>& counter) {
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
 BFCArena::BFCArena(std::unique_ptr<IDeviceAllocator> resource_allocator,
-                   size_t total_memory)
+                   size_t total_memory,
+                   bool enable_thread_cache)
     : device_allocator_(std::move(resource_allocator)),
+      enable_thread_cache_(enable_thread_cache),
       free_chunks_list_(kInvalidChunkHandle),
       next_allocation_id_(1),
       info_(device_allocator_->Info().name, OrtAllocatorType::OrtArenaAllocator, device_allocator_->Info().id, device_allocator_->Info().mem_type) {
@@ -35,6 +87,14 @@ BFCArena::BFCArena(std::unique_ptr<IDeviceAllocator> resource_allocator,
 }
 
 BFCArena::~BFCArena() {
+  {
+    // the threads that have a cache for this arena may exit later, and must not touch it then
+    std::lock_guard<OrtMutex> lock(ThreadCacheMutex());
+    for (auto& cache : thread_caches_) {
+      cache->arena = nullptr;
+    }
+  }
+
   for (const auto& region : region_manager_.regions()) {
     device_allocator_->Free(region.ptr());
   }
@@ -159,15 +219,183 @@ size_t BFCArena::RoundedBytes(size_t bytes) {
   return rounded_bytes;
 }
 
+std::unique_lock<OrtMutex> BFCArena::Lock() {
+  std::unique_lock<OrtMutex> lock(lock_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    ++num_lock_contentions_;
+    lock.lock();
+  }
+  return lock;
+}
+
 void* BFCArena::Alloc(size_t size) {
+  if (enable_thread_cache_ && size != 0) {
+    int size_class = SizeClassForBytes(size);
+    if (size_class < kNumCacheSizeClasses) {
+      return AllocateCached(*GetThreadCache(true), size_class);
+    }
+  }
+
   return AllocateRawInternal(size, false);
 }
 
+int BFCArena::SizeClassForBytes(size_t num_bytes) {
+  size_t num_units = RoundedBytes(num_bytes) >> kMinAllocationBits;
+  // round up to a power of two
+  int size_class = Log2FloorNonZero(num_units);
+  if ((size_t{1} << size_class) != num_units) {
+    ++size_class;
+  }
+  return size_class < kNumCacheSizeClasses ? size_class : kNumCacheSizeClasses;
+}
+
+size_t BFCArena::MaxCachedChunks(int size_class) {
+  size_t chunk_size = kMinAllocationSize << size_class;
+  size_t max_chunks = kMaxCachedBytesPerSizeClass / chunk_size;
+  if (max_chunks > kMaxCachedChunksPerSizeClass) {
+    max_chunks = kMaxCachedChunksPerSizeClass;
+  }
+  return std::max<size_t>(2, max_chunks);
+}
+
+BFCArena::ThreadCacheList& BFCArena::CurrentThreadCaches() {
+  static thread_local ThreadCacheList thread_caches;
+  return thread_caches;
+}
+
+BFCArena::ThreadCache* BFCArena::GetThreadCache(bool create) {
+  auto& caches = CurrentThreadCaches().caches;
+  for (auto& cache : caches) {
+    if (cache->arena == this) {
+      return cache.get();
+    }
+  }
+
+  if (!create) {
+    return nullptr;
+  }
+
+  // drop the caches of arenas that have been destroyed
+  caches.erase(std::remove_if(caches.begin(), caches.end(),
+                              [](const std::shared_ptr<ThreadCache>& cache) { return cache->arena == nullptr; }),
+               caches.end());
+
+  auto cache = std::make_shared<ThreadCache>(this);
+  {
+    auto lock = Lock();
+    thread_caches_.push_back(cache);
+  }
+
+  caches.push_back(cache);
+  return cache.get();
+}
+
+void* BFCArena::AllocateCached(ThreadCache& cache, int size_class) {
+  auto& free_chunks = cache.free_chunks[size_class];
+  if (!free_chunks.empty()) {
+    IncrementCounter(cache.num_hits);
+  } else {
+    IncrementCounter(cache.num_misses);
+
+    // refill a quarter of the capacity at a time so the next few allocations are hits
+    const size_t chunk_size = kMinAllocationSize << size_class;
+    const size_t refill_count = std::max<size_t>(1, MaxCachedChunks(size_class) / 4);
+
+    auto lock = Lock();
+    TakeRemoteFrees(cache);
+    while (free_chunks.size() < refill_count) {
+      void* p = AllocateLocked(chunk_size, chunk_size);
+      if (p == nullptr) {
+        break;
+      }
+
+      ChunkFromHandle(region_manager_.get_handle(p))->cache = &cache;
+      cache.owned_chunks[p] = size_class;
+      free_chunks.push_back(p);
+    }
+
+    if (free_chunks.empty()) {
+      return nullptr;
+    }
+  }
+
+  void* p = free_chunks.back();
+  free_chunks.pop_back();
+  return p;
+}
+
+void BFCArena::FreeCached(ThreadCache& cache, void* p, int size_class) {
+  auto& free_chunks = cache.free_chunks[size_class];
+  free_chunks.push_back(p);
+
+  // return the least recently used half to the arena once the cache is full
+  const size_t max_cached_chunks = MaxCachedChunks(size_class);
+  if (free_chunks.size() > max_cached_chunks) {
+    auto lock = Lock();
+    ReturnCachedChunks(cache, size_class, free_chunks.size() - max_cached_chunks / 2);
+  }
+}
+
+void BFCArena::TakeRemoteFrees(ThreadCache& cache) {
+  for (void* p : cache.remote_free_chunks) {
+    const int size_class = cache.owned_chunks.at(p);
+    cache.free_chunks[size_class].push_back(p);
+    if (cache.free_chunks[size_class].size() > MaxCachedChunks(size_class)) {
+      ReturnCachedChunks(cache, size_class, 1);
+    }
+  }
+
+  cache.remote_free_chunks.clear();
+}
+
+void BFCArena::ReturnCachedChunks(ThreadCache& cache, int size_class, size_t count) {
+  auto& free_chunks = cache.free_chunks[size_class];
+  count = std::min(count, free_chunks.size());
+  for (size_t i = 0; i < count; ++i) {
+    void* p = free_chunks[i];
+    cache.owned_chunks.erase(p);
+    BFCArena::ChunkHandle h = region_manager_.get_handle(p);
+    ORT_ENFORCE(h != kInvalidChunkHandle);
+    ChunkFromHandle(h)->cache = nullptr;
+    FreeAndMaybeCoalesce(h);
+  }
+
+  free_chunks.erase(free_chunks.begin(), free_chunks.begin() + count);
+}
+
+void BFCArena::ReleaseThreadCache(ThreadCache& cache) {
+  std::lock_guard<OrtMutex> cache_lock(ThreadCacheMutex());
+  BFCArena* arena = cache.arena;
+  if (arena == nullptr) {
+    return;
+  }
+
+  auto lock = arena->Lock();
+  arena->TakeRemoteFrees(cache);
+  for (int size_class = 0; size_class < kNumCacheSizeClasses; ++size_class) {
+    arena->ReturnCachedChunks(cache, size_class, cache.free_chunks[size_class].size());
+  }
+
+  // the chunks that are still in use are returned to the arena directly when they're freed
+  for (const auto& owned_chunk : cache.owned_chunks) {
+    arena->ChunkFromHandle(arena->region_manager_.get_handle(owned_chunk.first))->cache = nullptr;
+  }
+  cache.owned_chunks.clear();
+
+  arena->released_cache_hits_ += cache.num_hits;
+  arena->released_cache_misses_ += cache.num_misses;
+  auto& thread_caches = arena->thread_caches_;
+  thread_caches.erase(std::remove_if(thread_caches.begin(), thread_caches.end(),
+                                     [&cache](const std::shared_ptr<ThreadCache>& c) { return c.get() == &cache; }),
+                      thread_caches.end());
+  cache.arena = nullptr;
+}
+
 void* BFCArena::Reserve(size_t size) {
   if (size == 0)
     return nullptr;
 
-  std::lock_guard<OrtMutex> lock(lock_);
+  auto lock = Lock();
   void* ptr = device_allocator_->Alloc(size);
   ORT_ENFORCE(reserved_chunks_.find(ptr) == reserved_chunks_.end());
   reserved_chunks_.insert(std::pair<void*, size_t>(ptr, size));
@@ -206,23 +434,12 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
   // so all memory addresses are nicely byte aligned.
   size_t rounded_bytes = RoundedBytes(num_bytes);
 
-  // The BFC allocator tries to find the best fit first.
-  BinNum bin_num = BinNumForSize(rounded_bytes);
-
-  std::lock_guard<OrtMutex> lock(lock_);
-  void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
+  auto lock = Lock();
+  void* ptr = AllocateLocked(rounded_bytes, num_bytes);
   if (ptr != nullptr) {
     return ptr;
   }
 
-  // Try to extend
-  if (Extend(rounded_bytes)) {
-    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
-    if (ptr != nullptr) {
-      return ptr;
-    }
-  }
-
   // We searched all bins for an existing free chunk to use and
   // couldn't find one.  This means we must have run out of memory,
   // Dump the memory log for analysis.
@@ -235,9 +452,33 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
   return nullptr;
 }
 
+void* BFCArena::AllocateLocked(size_t rounded_bytes, size_t num_bytes) {
+  // The BFC allocator tries to find the best fit first.
+  BinNum bin_num = BinNumForSize(rounded_bytes);
+
+  void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
+  if (ptr != nullptr) {
+    return ptr;
+  }
+
+  // Try to extend
+  if (Extend(rounded_bytes)) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
+  }
+
+  return ptr;
+}
+
 void BFCArena::GetStats(AllocatorStats* stats) {
   std::lock_guard<OrtMutex> lock(lock_);
   *stats = stats_;
+  stats->num_cache_hits = released_cache_hits_;
+  stats->num_cache_misses = released_cache_misses_;
+  for (const auto& cache : thread_caches_) {
+    stats->num_cache_hits += cache->num_hits;
+    stats->num_cache_misses += cache->num_misses;
+  }
+  stats->num_lock_contentions = num_lock_contentions_;
 }
 
 void* BFCArena::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
@@ -328,7 +569,19 @@ void BFCArena::Free(void* p) {
   if (p == nullptr) {
     return;
   }
-  std::lock_guard<OrtMutex> lock(lock_);
+
+  if (enable_thread_cache_) {
+    ThreadCache* cache = GetThreadCache(false);
+    if (cache != nullptr) {
+      auto owned_chunk = cache->owned_chunks.find(p);
+      if (owned_chunk != cache->owned_chunks.end()) {
+        FreeCached(*cache, p, owned_chunk->second);
+        return;
+      }
+    }
+  }
+
+  auto lock = Lock();
   auto it = reserved_chunks_.find(p);
   if (it != reserved_chunks_.end()) {
     device_allocator_->Free(it->first);
@@ -345,6 +598,13 @@ void BFCArena::DeallocateRawInternal(void* ptr) {
   BFCArena::ChunkHandle h = region_manager_.get_handle(ptr);
   ORT_ENFORCE(h != kInvalidChunkHandle);
 
+  // A chunk allocated from a thread cache and freed by another thread goes back to the owning cache.
+  ThreadCache* cache = ChunkFromHandle(h)->cache;
+  if (cache != nullptr) {
+    cache->remote_free_chunks.push_back(ptr);
+    return;
+  }
+
   // Consider coalescing it.
   FreeAndMaybeCoalesce(h);
 }
@@ -16,9 +16,12 @@ limitations under the License.
 
 #pragma once
 #include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
@@ -49,6 +52,9 @@ struct AllocatorStats {
                                   // is known. Certain allocator may return 0 to indicate the limit is
                                   // unknown.
   int64_t bytes_limit;
+  int64_t num_cache_hits;        // Number of allocations served by a thread cache without taking the lock.
+  int64_t num_cache_misses;      // Number of times a thread cache was empty and had to be refilled.
+  int64_t num_lock_contentions;  // Number of times the lock was held by another thread when it was needed.
 
   AllocatorStats() { Clear(); }
 
@@ -59,6 +65,9 @@ struct AllocatorStats {
     this->max_alloc_size = 0;
     this->bytes_limit = 0;
     this->total_allocated_bytes = 0;
+    this->num_cache_hits = 0;
+    this->num_cache_misses = 0;
+    this->num_lock_contentions = 0;
   }
 
   std::string DebugString() const {
@@ -68,7 +77,10 @@ struct AllocatorStats {
        << "TotalAllocated: " << this->total_allocated_bytes << "\n"
        << "MaxInUse:       " << this->max_bytes_in_use << "\n"
        << "NumAllocs:      " << this->num_allocs << "\n"
-       << "MaxAllocSize:   " << this->max_alloc_size << "\n";
+       << "MaxAllocSize:   " << this->max_alloc_size << "\n"
+       << "CacheHits:      " << this->num_cache_hits << "\n"
+       << "CacheMisses:    " << this->num_cache_misses << "\n"
+       << "LockContention: " << this->num_lock_contentions << "\n";
     return ss.str();
   }
 };
@@ -81,9 +93,16 @@ struct AllocatorStats {
 // coalescing.  One assumption we make is that the process using this
 // allocator owns pretty much all of the memory, and that nearly
 // all requests to allocate memory go through this interface.
+//
+// If the thread cache is enabled, small allocations are rounded up to a
+// power of two size class and served from a per-thread list of free chunks
+// without taking the lock. A thread cache is refilled from, and returns
+// excess chunks to, the arena in batches. Chunks held by the thread caches
+// are counted as in use in the stats.
 class BFCArena : public IArenaAllocator {
  public:
-  BFCArena(std::unique_ptr<IDeviceAllocator> resource_allocator, size_t total_memory);
+  BFCArena(std::unique_ptr<IDeviceAllocator> resource_allocator, size_t total_memory,
+           bool enable_thread_cache = false);
 
   ~BFCArena() override;
 
@@ -124,6 +143,41 @@ class BFCArena : public IArenaAllocator {
   void* AllocateRawInternal(size_t num_bytes, bool dump_log_on_failure);
   void DeallocateRawInternal(void* ptr);
 
+  // Take lock_, counting whether another thread held it.
+  std::unique_lock<OrtMutex> Lock();
+
+  // Find a free chunk, extending the arena if needed. Requires lock_.
+  void* AllocateLocked(size_t rounded_bytes, size_t num_bytes);
+
+  class ThreadCache;
+  class ThreadCacheList;
+
+  // Size classes served by the thread caches are kMinAllocationSize << [0, kNumCacheSizeClasses).
+  // The largest cached size class is 64KB.
+  static const int kNumCacheSizeClasses = 9;
+  // Max number of bytes of free chunks a thread cache keeps for each size class. This keeps the memory a thread
+  // cache holds under 1MB.
+  static const size_t kMaxCachedBytesPerSizeClass = 128 << 10;
+  static const size_t kMaxCachedChunksPerSizeClass = 32;
+
+  // Returns the size class for an allocation of num_bytes, or kNumCacheSizeClasses if it's too large to cache.
+  int SizeClassForBytes(size_t num_bytes);
+  static size_t MaxCachedChunks(int size_class);
+
+  // The thread caches of the current thread.
+  static ThreadCacheList& CurrentThreadCaches();
+  // Returns the cache of the current thread for this arena, optionally creating it.
+  ThreadCache* GetThreadCache(bool create);
+
+  void* AllocateCached(ThreadCache& cache, int size_class);
+  void FreeCached(ThreadCache& cache, void* p, int size_class);
+  // Move the chunks other threads freed into the free lists of cache. Requires lock_.
+  void TakeRemoteFrees(ThreadCache& cache);
+  // Return the count most recently freed chunks of a size class to the arena. Requires lock_.
+  void ReturnCachedChunks(ThreadCache& cache, int size_class, size_t count);
+  // Return all chunks of cache to the arena and stop tracking it. Called when the thread exits.
+  static void ReleaseThreadCache(ThreadCache& cache);
+
   // A ChunkHandle is an index into the chunks_ vector in BFCAllocator
   // kInvalidChunkHandle means an invalid chunk
   using ChunkHandle = size_t;
@@ -167,6 +221,10 @@ class BFCArena : public IArenaAllocator {
     // What bin are we in?
     BinNum bin_num = kInvalidBinNum;
 
+    // The thread cache that owns the chunk, if any. The chunk is in use from the arena's point of view while
+    // it's owned by a thread cache, whether or not the thread cache has handed it out.
+    ThreadCache* cache = nullptr;
+
     bool in_use() const { return allocation_id != -1; }
 
     std::string DebugString(BFCArena* a, bool recurse) {
@@ -465,6 +523,14 @@ class BFCArena : public IArenaAllocator {
 
   mutable OrtMutex lock_;
 
+  const bool enable_thread_cache_;
+  // all thread caches for this arena. protected by lock_.
+  std::vector<std::shared_ptr<ThreadCache>> thread_caches_;
+  // cache stats of the thread caches that have been released. protected by lock_.
+  int64_t released_cache_hits_ = 0;
+  int64_t released_cache_misses_ = 0;
+  std::atomic<int64_t> num_lock_contentions_{0};
+
   RegionManager region_manager_;
   std::vector<Chunk> chunks_;
   // Pointer to head of linked list of free Chunks
@@ -2,9 +2,12 @@
 // Licensed under the MIT License.
 
 #include "core/framework/environment.h"
+#include "core/common/threadpool.h"
 #include "core/framework/allocatormgr.h"
 #include "core/graph/constants.h"
 #include "core/graph/op.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/ort_mutex.h"
 #include "onnx/defs/operator_sets.h"
 #include "onnx/defs/operator_sets-ml.h"
 #ifndef DISABLE_CONTRIB_OPS
@@ -19,19 +22,58 @@ std::once_flag schemaRegistrationOnceFlag;
 
 std::atomic<bool> Environment::is_initialized_{false};
 
-Status Environment::Create(std::unique_ptr<Environment>& environment) {
+// MLAS has a single process-wide thread pool. It belongs to the most recently created Environment, and so does
+// the intra-op thread pool handed out to sessions.
+static OrtMutex mlas_thread_pool_mutex;
+static const MLAS_THREADPOOL* registered_mlas_thread_pool = nullptr;
+static ThreadPool* registered_intra_op_thread_pool = nullptr;
+
+static void MLASCALL MlasExecuteThreadedOnThreadPool(void* thread_pool_context,
+                                                     MLAS_THREADPOOL_WORK_ROUTINE* work_routine,
+                                                     void* context,
+                                                     int32_t iterations) {
+  auto* thread_pool = static_cast<ThreadPool*>(thread_pool_context);
+  thread_pool->ParallelFor(iterations, [work_routine, context](int32_t index) { work_routine(context, index); });
+}
+
+Environment::Environment() = default;
+
+Status Environment::Create(std::unique_ptr<Environment>& environment, int intra_op_num_threads) {
   environment = std::unique_ptr<Environment>(new Environment());
-  auto status = environment->Initialize();
+  auto status = environment->Initialize(intra_op_num_threads);
   return status;
 }
 
-Status Environment::Initialize() {
+Status Environment::Initialize(int intra_op_num_threads) {
   auto status = Status::OK();
 
+  if (intra_op_num_threads < 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "intra_op_num_threads must be >= 0. Got ",
+                           intra_op_num_threads);
+  }
+
   try {
-    // Register Microsoft domain with min/max op_set version as 1/1.
+    intra_op_thread_pool_ = std::make_unique<ThreadPool>(intra_op_num_threads);
+    if (intra_op_thread_pool_->NumThreads() == 0) {
+      intra_op_thread_pool_.reset();
+    } else {
+      mlas_thread_pool_ = std::make_unique<MLAS_THREADPOOL>();
+      mlas_thread_pool_->ExecuteRoutine = MlasExecuteThreadedOnThreadPool;
+      mlas_thread_pool_->ThreadPoolContext = intra_op_thread_pool_.get();
+      mlas_thread_pool_->MaximumThreadCount = intra_op_thread_pool_->DegreeOfParallelism();
+    }
+
+    {
+      std::lock_guard<OrtMutex> lock(mlas_thread_pool_mutex);
+      registered_intra_op_thread_pool = intra_op_thread_pool_.get();
+      registered_mlas_thread_pool = mlas_thread_pool_.get();
+      MlasSetThreadPool(registered_mlas_thread_pool);
+    }
+
+    // Register Microsoft domains with min/max op_set version as 1/1.
     std::call_once(schemaRegistrationOnceFlag, []() {
       ONNX_NAMESPACE::OpSchemaRegistry::DomainToVersionRange::Instance().AddDomainToVersion(onnxruntime::kMSDomain, 1, 1);
+      ONNX_NAMESPACE::OpSchemaRegistry::DomainToVersionRange::Instance().AddDomainToVersion(onnxruntime::kMSNchwcDomain, 1, 1);
       // Register contributed schemas.
       // The corresponding kernels are registered inside the appropriate execution provider.
 #ifndef DISABLE_CONTRIB_OPS
@@ -94,7 +136,21 @@ Internal copy node
   return status;
 }
 
+ThreadPool* Environment::GetIntraOpThreadPool() {
+  std::lock_guard<OrtMutex> lock(mlas_thread_pool_mutex);
+  return registered_intra_op_thread_pool;
+}
+
 Environment::~Environment() {
+  if (intra_op_thread_pool_ != nullptr) {
+    std::lock_guard<OrtMutex> lock(mlas_thread_pool_mutex);
+    if (registered_intra_op_thread_pool == intra_op_thread_pool_.get()) {
+      registered_intra_op_thread_pool = nullptr;
+      registered_mlas_thread_pool = nullptr;
+      MlasSetThreadPool(nullptr);
+    }
+  }
+
   ::google::protobuf::ShutdownProtobufLibrary();
 }
 
@@ -271,18 +271,21 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(MLValue& mlvalue
       // if block not found, fall back to default behavior
       if (block) {
         auto it = buffers_.find(location);
-        // if the block is not correct, log message then fall back to default behavior
-        if (it != buffers_.end() && block->size_ == size) {
+        // if the block is not correct, log message then fall back to default behavior.
+        // a block can be larger than needed if the pattern is shared by different shapes.
+        if (it != buffers_.end() && size <= block->size_) {
           void* buffer = it->second.get();
           auto status = AllocateTensorWithPreAllocateBufferHelper(
               mlvalue, static_cast<void*>(static_cast<char*>(buffer) + block->offset_),
               element_type, location, shape);
           return status;
         }
-        if (block->size_ != size) {
-          LOGS_DEFAULT(WARNING) << "For mlvalue with index: " << mlvalue_index << ", block in memory pattern size is: "
-                                << block->size_ << " but the actually size is: " << size
-                                << ", fall back to default allocation behavior";
+        if (block->size_ < size) {
+          LOGS_DEFAULT(INFO) << "For mlvalue with index: " << mlvalue_index << ", block in memory pattern size is: "
+                             << block->size_ << " but the actually size is: " << size
+                             << ", fall back to default allocation behavior";
+          std::lock_guard<OrtMutex> lock(pattern_overflows_lock_);
+          pattern_overflows_[mlvalue_index] = size;
         } else if (it == buffers_.end()) {
           LOGS_DEFAULT(WARNING) << "For mlvalue with index: " << mlvalue_index
                                 << ", block not found in target location. fall back to default allocation behavior";
@@ -318,6 +321,31 @@ Status ExecutionFrame::AllocateMLValueTensorPreAllocateBuffer(MLValue& mlvalue,
   auto* reuse_tensor = mlvalue_reuse.GetMutable<Tensor>();
   void* reuse_buffer = reuse_tensor->MutableDataRaw();
 
+  // the planner may pick the buffer from inferred or symbolic sizes, so check it can hold the actual tensor.
+  // if it can't, fall back to a buffer of our own instead of overrunning the reused one.
+  size_t size;
+  int64_t len = shape.Size();
+  if (len < 0) {
+    return Status(ONNXRUNTIME, INVALID_ARGUMENT, "Tensor shape cannot contain any negative value");
+  }
+  if (!IAllocator::CalcMemSizeForArray(static_cast<size_t>(len), element_type->Size(), &size)) {
+    return Status(ONNXRUNTIME, FAIL, "size overflow");
+  }
+  if (size > reuse_tensor->Size()) {
+    LOGS_DEFAULT(VERBOSE) << "Buffer of mlvalue with index: " << mlvalue_index_reuse << " is " << reuse_tensor->Size()
+                          << " bytes but " << size << " bytes are needed, fall back to a new allocation";
+    auto alloc = GetAllocator(location);
+    if (create_fence) {
+      ORT_ENFORCE(mlvalue.Fence() == nullptr);
+      mlvalue.SetFence(alloc->CreateFence(&session_state_));
+    }
+    std::unique_ptr<Tensor> p_tensor = std::make_unique<Tensor>(element_type, shape, alloc);
+    mlvalue.Init(p_tensor.release(),
+                 DataTypeImpl::GetType<Tensor>(),
+                 DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+    return Status::OK();
+  }
+
   // create fence on reused mlvalue if needed
   // TODO: differentiate reuse and alias, by add AllocKind::kAlias?
   if (create_fence && mlvalue_reuse.Fence() == nullptr) {
@@ -472,11 +500,21 @@ void ExecutionFrame::TraceFree(int mlvalue_idx) {
 // generate memory pattern based on the tracing of memory allocation/free in current execution
 // return error if the planner is not setup.
 Status ExecutionFrame::GeneratePatterns(MemoryPatternGroup* out) const {
-  if (!planner_) {
-    return Status(ONNXRUNTIME, FAIL, "Memory pattern planner is not enabled on this execution framework.");
+  if (planner_) {
+    return planner_->GeneratePatterns(out);
+  }
+
+  if (mem_patterns_ && HasMemoryPatternOverflow()) {
+    std::lock_guard<OrtMutex> lock(pattern_overflows_lock_);
+    for (size_t i = 0; i < mem_patterns_->locations.size(); i++) {
+      out->locations.push_back(mem_patterns_->locations[i]);
+      out->patterns.push_back(MemPatternPlanner::Replan(mem_patterns_->patterns[i], pattern_overflows_));
+    }
+
+    return Status::OK();
   }
 
-  return planner_->GeneratePatterns(out);
+  return Status(ONNXRUNTIME, FAIL, "Memory pattern planner is not enabled on this execution framework.");
 }
 
 }  // namespace onnxruntime
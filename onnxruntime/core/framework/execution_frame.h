@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "core/common/common.h"
@@ -14,6 +16,7 @@
 #include "core/framework/sequential_execution_plan.h"
 #include "core/framework/tensor.h"
 #include "core/graph/graph_viewer.h"
+#include "core/platform/ort_mutex.h"
 
 namespace onnxruntime {
 
@@ -136,6 +139,13 @@ class ExecutionFrame final : public IExecutionFrame {
     return planner_ != nullptr;
   }
 
+  // true if some tensors didn't fit in their block of the cached memory pattern.
+  // GeneratePatterns then plans a larger pattern from the cached one.
+  bool HasMemoryPatternOverflow() const {
+    std::lock_guard<OrtMutex> lock(pattern_overflows_lock_);
+    return !pattern_overflows_.empty();
+  }
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ExecutionFrame);
 
@@ -173,7 +183,11 @@ class ExecutionFrame final : public IExecutionFrame {
   // If we already have cached memory pattern on these input shapes
   // Use this mem pattern that create a big chunk for all the internal
   // kernel's input/output tensors.
-  const MemoryPatternGroup* mem_patterns_;
+  std::shared_ptr<const MemoryPatternGroup> mem_patterns_;
+
+  // size of each tensor that was larger than its block in mem_patterns_
+  std::unordered_map<int, size_t> pattern_overflows_;
+  mutable OrtMutex pattern_overflows_lock_;
 
   // If no cached memory pattern, and we enable the memory pattern optimization
   // use this planner_ to trace the memory allocation in current executor.
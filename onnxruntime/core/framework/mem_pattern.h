@@ -14,6 +14,17 @@ struct MemoryBlock {
   MemoryBlock(size_t offset, size_t size) : offset_(offset), size_(size) {}
 };
 
+// An allocation or free of an MLValue, in the order it was traced by MemPatternPlanner.
+struct MemoryTraceEntry {
+  int ml_value_idx_{-1};
+  size_t size_{0};
+  bool is_free_{false};
+
+  MemoryTraceEntry() = default;
+  MemoryTraceEntry(int ml_value_idx, size_t size, bool is_free)
+      : ml_value_idx_(ml_value_idx), size_(size), is_free_(is_free) {}
+};
+
 class MemoryPattern {
   friend class MemPatternPlanner;
 
@@ -22,10 +33,12 @@ class MemoryPattern {
 
   MemoryPattern(MemoryPattern&& rhs)
       : patterns_{std::move(rhs.patterns_)},
+        trace_{std::move(rhs.trace_)},
         peak_size_{std::move(rhs.peak_size_)} {}
 
   MemoryPattern& operator=(MemoryPattern&& rhs) {
     patterns_ = std::move(rhs.patterns_);
+    trace_ = std::move(rhs.trace_);
     peak_size_ = std::move(rhs.peak_size_);
     return *this;
   }
@@ -42,11 +55,17 @@ class MemoryPattern {
     return &it->second;
   }
 
+  // the allocations and frees the pattern was planned from
+  const std::vector<MemoryTraceEntry>& Trace() const {
+    return trace_;
+  }
+
  private:
   // allow move
   ORT_DISALLOW_COPY_AND_ASSIGNMENT(MemoryPattern);
 
   std::unordered_map<int, MemoryBlock> patterns_;
+  std::vector<MemoryTraceEntry> trace_;
   size_t peak_size_{0};
 };
 
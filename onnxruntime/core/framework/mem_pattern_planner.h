@@ -18,7 +18,10 @@ limitations under the License.
 #pragma once
 #include "core/framework/mem_pattern.h"
 #include "core/framework/allocation_planner.h"
+#include <algorithm>
+#include <limits>
 #include <list>
+#include <unordered_map>
 
 namespace onnxruntime {
 // MemPatternPlanner is used to trace allocation/free steps
@@ -29,6 +32,8 @@ class MemPatternPlanner {
   MemPatternPlanner() = default;
 
   void TraceAllocation(int ml_value_idx, size_t size) {
+    trace_.emplace_back(ml_value_idx, size, false);
+
     if (size == 0) {
       allocs_.emplace_back(ml_value_idx, MemoryBlock(0, 0));
       return;
@@ -61,6 +66,8 @@ class MemPatternPlanner {
   }
 
   void TraceFree(int ml_value_index) {
+    trace_.emplace_back(ml_value_index, 0, true);
+
     for (auto it = blocks_.begin(); it != blocks_.end(); it++) {
       if (allocs_[*it].index_ == ml_value_index) {
         blocks_.erase(it);
@@ -75,10 +82,28 @@ class MemPatternPlanner {
     for (auto& alloc : allocs_) {
       pattern.patterns_[alloc.index_] = alloc.block_;
     }
+    pattern.trace_ = trace_;
 
     return pattern;
   }
 
+  // Plan a pattern again by replaying the allocations and frees it was planned from, with each MLValue that has an
+  // entry in min_sizes given at least that size. This grows a pattern so it fits every shape seen for it.
+  static MemoryPattern Replan(const MemoryPattern& pattern, const std::unordered_map<int, size_t>& min_sizes) {
+    MemPatternPlanner planner;
+    for (const auto& entry : pattern.Trace()) {
+      if (entry.is_free_) {
+        planner.TraceFree(entry.ml_value_idx_);
+      } else {
+        auto it = min_sizes.find(entry.ml_value_idx_);
+        planner.TraceAllocation(entry.ml_value_idx_,
+                                it != min_sizes.end() ? std::max(entry.size_, it->second) : entry.size_);
+      }
+    }
+
+    return planner.GenerateMemPattern();
+  }
+
  protected:
   struct MLValueAllocationBlock {
     int index_{-1};
@@ -91,6 +116,7 @@ class MemPatternPlanner {
   std::vector<MLValueAllocationBlock> allocs_;
   // blocks_ the list of currently allocated memory blocks, sorted in order of their offset
   std::list<int> blocks_;
+  std::vector<MemoryTraceEntry> trace_;
   size_t buffer_size{0};
 };
 
@@ -23,14 +23,79 @@
 namespace onnxruntime {
 
 ParallelExecutor::ParallelExecutor(const SessionState& session_state, const bool& terminate_flag)
-    : out_standings_(0), terminate_flag_{terminate_flag} {
+    : terminate_flag_{terminate_flag} {
   auto graph_viewer = session_state.GetGraphViewer();
-  node_refs_.resize(graph_viewer->MaxNodeIndex());
+  const size_t num_nodes = graph_viewer->MaxNodeIndex();
+  node_refs_.reset(new std::atomic<size_t>[num_nodes]);
   for (auto& node : graph_viewer->Nodes()) {
-    node_refs_[node.Index()] = node.GetInputEdgesCount();
+    node_refs_[node.Index()].store(node.GetInputEdgesCount(), std::memory_order_relaxed);
+  }
+
+  auto* thread_pool = session_state.GetThreadPool();
+  if (thread_pool != nullptr) {
+    num_workers_ += static_cast<size_t>(thread_pool->NumThreads());
+  }
+
+  ready_queues_.reset(new ReadyQueue[num_workers_]);
+  worker_active_.reset(new std::atomic<bool>[num_workers_]);
+  for (size_t i = 0; i < num_workers_; ++i) {
+    ready_queues_[i].Init(num_nodes);
+    worker_active_[i].store(i == 0, std::memory_order_relaxed);
   }
 }
 
+void ParallelExecutor::ReadyQueue::Init(size_t capacity) {
+  // the buffer is deliberately left uninitialized. only the entries between top_ and bottom_ are read.
+  buffer_.reset(new std::atomic<size_t>[capacity]);
+  capacity_ = capacity;
+  top_.store(0, std::memory_order_relaxed);
+  bottom_.store(0, std::memory_order_relaxed);
+}
+
+void ParallelExecutor::ReadyQueue::Push(size_t node_index) {
+  int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  ORT_ENFORCE(static_cast<size_t>(bottom) < capacity_, "Ready queue overflow.");
+  buffer_[bottom].store(node_index, std::memory_order_relaxed);
+  // publish the entry to thieves
+  bottom_.store(bottom + 1, std::memory_order_release);
+}
+
+bool ParallelExecutor::ReadyQueue::Pop(size_t& node_index) {
+  int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  bottom_.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = top_.load(std::memory_order_relaxed);
+
+  if (top > bottom) {
+    // empty
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return false;
+  }
+
+  node_index = buffer_[bottom].load(std::memory_order_relaxed);
+  if (top == bottom) {
+    // last entry. race against thieves for it.
+    bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return won;
+  }
+
+  return true;
+}
+
+bool ParallelExecutor::ReadyQueue::Steal(size_t& node_index) {
+  int64_t top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+  if (top >= bottom) {
+    return false;
+  }
+
+  node_index = buffer_[top].load(std::memory_order_relaxed);
+  return top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
 Status ParallelExecutor::Execute(const SessionState& session_state,
                                  const std::vector<int>& feed_mlvalue_idxs,
                                  const std::vector<MLValue>& feeds,
@@ -46,20 +111,32 @@ Status ParallelExecutor::Execute(const SessionState& session_state,
 
   root_frame_ = std::make_unique<ExecutionFrame>(feed_mlvalue_idxs, feeds, fetch_mlvalue_idxs, fetches,
                                                  fetch_allocators, session_state);
-  //std::cout << "start nodes:" << std::endl;
+  bool first_root = true;
   for (auto node_index : session_state.GetGraphViewer()->GetRootNodes()) {
     auto p_op_kernel = session_state.GetKernel(node_index);
     if (!p_op_kernel)
       continue;
 
-    //std::cout << "\t" << p_op_kernel->Node().Name() << std::endl;
-    EnqueueNode(node_index, session_state, logger);
+    ready_queues_[0].Push(node_index);
+    if (!first_root) {
+      TryStartWorker(session_state, logger);
+    }
+    first_root = false;
   }
 
-  // Wait for finish.
+  // the calling thread is worker 0
+  WorkerLoop(0, session_state, logger);
+
+  // Wait for the thread pool workers to finish. A worker only exits once its own queue is empty so
+  // every ready node has been run when running_workers_ drops to zero.
   {
     std::unique_lock<OrtMutex> lock(complete_mutex_);
-    while (out_standings_ > 0) complete_cv_.wait(lock);
+    while (running_workers_ > 0) complete_cv_.wait(lock);
+  }
+
+  if (has_error_) {
+    std::lock_guard<OrtMutex> lock(error_mutex_);
+    return error_;
   }
 
   VLOGS(logger, 1) << "Fetching output.";
@@ -67,7 +144,7 @@ Status ParallelExecutor::Execute(const SessionState& session_state,
   ORT_RETURN_IF_ERROR(root_frame_->GetOutputs(fetches));
   VLOGS(logger, 1) << "Done execution.";
 
-  if (root_frame_->HasMemoryPatternPlanner()) {
+  if (root_frame_->HasMemoryPatternPlanner() || root_frame_->HasMemoryPatternOverflow()) {
     std::vector<TensorShape> input_shapes;
     bool all_tensors = true;
     for (const auto& feed : feeds) {
@@ -92,184 +169,240 @@ Status ParallelExecutor::Execute(const SessionState& session_state,
   return Status::OK();
 }
 
-void ParallelExecutor::RunNodeAsync(size_t p_node_index,
-                                    const SessionState& session_state,
-                                    const logging::Logger& logger) {
-  try {
-    RunNodeAsyncInternal(p_node_index, session_state, logger);
-  } catch (...) {
-    FinishNodeRun();
-    throw;
+void ParallelExecutor::WorkerLoop(size_t worker, const SessionState& session_state, const logging::Logger& logger) {
+  size_t node_index;
+  while (GetReadyNode(worker, node_index)) {
+    RunNodes(node_index, worker, session_state, logger);
   }
 }
 
-void ParallelExecutor::RunNodeAsyncInternal(size_t p_node_index,
-                                            const SessionState& session_state,
-                                            const logging::Logger& logger) {
-  LOGS(logger, INFO) << "Begin execution";
+bool ParallelExecutor::GetReadyNode(size_t worker, size_t& node_index) {
+  if (ready_queues_[worker].Pop(node_index)) {
+    return true;
+  }
+
+  for (size_t i = 1; i < num_workers_; ++i) {
+    if (ready_queues_[(worker + i) % num_workers_].Steal(node_index)) {
+      return true;
+    }
+  }
 
-  size_t node_index = p_node_index;
-  bool keep_running = true;
+  return false;
+}
+
+void ParallelExecutor::RunNodes(size_t node_index,
+                                size_t worker,
+                                const SessionState& session_state,
+                                const logging::Logger& logger) {
   auto graph_viewer = session_state.GetGraphViewer();
-  TimePoint sync_time_begin;
-  TimePoint kernel_begin_time;
-  bool f_profiler_enabled = session_state.Profiler().FEnabled();
+
   // Avoid context switching if possible.
-  while (keep_running) {
-    // TODO: Convert RunNodeAsync return Status.
-    // to also handle exception propagation
-    if (terminate_flag_) {
-      LOGS(logger, WARNING) << "Exiting due to terminate flag being set to true.";
-      ORT_THROW("Exiting due to terminate flag being set to true.");
+  for (;;) {
+    // once a node has failed, drain the remaining ready nodes without running them
+    if (has_error_) {
+      return;
     }
 
-    auto p_op_kernel = session_state.GetKernel(node_index);
-
-    // if a kernel has been added in the session state, it better be NON-null.
-    if (p_op_kernel == nullptr) {
-      ORT_THROW("Got nullptr from GetKernel for node: ",
-                graph_viewer->GetNode(node_index)->Name());
+    Status status;
+    try {
+      status = RunNode(node_index, session_state, logger);
+    } catch (const std::exception& ex) {
+      status = Status(common::ONNXRUNTIME, common::FAIL, ex.what());
+    } catch (...) {
+      status = Status(common::ONNXRUNTIME, common::RUNTIME_EXCEPTION, "Encountered unknown exception in node.");
     }
 
-    OpKernelContextInternal op_kernel_context(session_state, *root_frame_, *p_op_kernel, logger,
-                                              p_op_kernel->Node().ImplicitInputDefs(),
-                                              terminate_flag_);
-
-    if (f_profiler_enabled) {
-      sync_time_begin = session_state.Profiler().StartTime();
-    }
-    // sync before compute
-    int queue_id = p_op_kernel->KernelDef().ExecQueueId();
-
-    for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.InputFence(input_index);
-      if (fence) {
-        auto execution_provider_type = p_op_kernel->Node().GetExecutionProviderType();
-        if (OrtMemTypeCPUInput == p_op_kernel->KernelDef().InputMemoryType(input_index)) {
-          execution_provider_type = kCpuExecutionProvider;
-        }
-        fence->BeforeUsingAsInput(execution_provider_type, queue_id);
-      }
+    if (!status.IsOK()) {
+      SetError(status);
+      return;
     }
 
-    for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
-      if (fence) {
-        auto execution_provider_type = p_op_kernel->Node().GetExecutionProviderType();
-        if (OrtMemTypeCPUInput == p_op_kernel->KernelDef().InputMemoryType(input_index)) {
-          execution_provider_type = kCpuExecutionProvider;
+    // Release the consumers of the outputs. The first one that becomes ready is run on this thread,
+    // the rest are made available to the other workers.
+    bool keep_running = false;
+    size_t next_node_index = 0;
+    const Node& node = *graph_viewer->GetNode(node_index);
+    for (auto it = node.OutputEdgesBegin(), end = node.OutputEdgesEnd(); it != end; ++it) {
+      auto idx = (*it).GetNode().Index();
+      if (node_refs_[idx].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (!keep_running) {
+          next_node_index = idx;
+          keep_running = true;
+        } else {
+          ready_queues_[worker].Push(idx);
+          TryStartWorker(session_state, logger);
         }
-        fence->BeforeUsingAsInput(execution_provider_type, queue_id);
       }
     }
 
-    for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
-      Fence_t fence = op_kernel_context.OutputFence(output_index);
-      if (fence) {
-        fence->BeforeUsingAsOutput(p_op_kernel->Node().GetExecutionProviderType(), queue_id);
-      }
+    if (!keep_running) {
+      return;
     }
 
-    if (f_profiler_enabled) {
-      session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
-                                                     p_op_kernel->Node().Name() + "_fence_before",
-                                                     sync_time_begin,
-                                                     {{"op_name", p_op_kernel->KernelDef().OpName()}});
+    node_index = next_node_index;
+  }
+}
 
-      kernel_begin_time = session_state.Profiler().StartTime();
-    }
+Status ParallelExecutor::RunNode(size_t node_index, const SessionState& session_state, const logging::Logger& logger) {
+  if (terminate_flag_) {
+    LOGS(logger, WARNING) << "Exiting due to terminate flag being set to true.";
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
+  }
 
-    // call compute on the kernel
-    VLOGS(logger, 1) << "Computing kernel: " << p_op_kernel->Node().Name();
+  TimePoint sync_time_begin;
+  TimePoint kernel_begin_time;
+  bool f_profiler_enabled = session_state.Profiler().FEnabled();
 
-    // Execute the kernel.
-    auto status = p_op_kernel->Compute(&op_kernel_context);
-    if (!status.IsOK()) {
-      ORT_THROW("Compute failed for node: ", graph_viewer->GetNode(node_index)->Name());
-    }
-    if (f_profiler_enabled) {
-      session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
-                                                     p_op_kernel->Node().Name() + "_kernel_time",
-                                                     kernel_begin_time,
-                                                     {{"op_name", p_op_kernel->KernelDef().OpName()}});
+  auto p_op_kernel = session_state.GetKernel(node_index);
 
-      sync_time_begin = session_state.Profiler().StartTime();
-    }
-    // sync after compute for outputs
-    for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.InputFence(input_index);
-      if (fence) {
-        fence->AfterUsedAsInput(queue_id);
+  // if a kernel has been added in the session state, it better be NON-null.
+  if (p_op_kernel == nullptr) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Got nullptr from GetKernel for node: ",
+                           session_state.GetGraphViewer()->GetNode(node_index)->Name());
+  }
+
+  OpKernelContextInternal op_kernel_context(session_state, *root_frame_, *p_op_kernel, logger,
+                                            p_op_kernel->Node().ImplicitInputDefs(),
+                                            terminate_flag_);
+
+  if (f_profiler_enabled) {
+    sync_time_begin = session_state.Profiler().StartTime();
+  }
+  // sync before compute
+  int queue_id = p_op_kernel->KernelDef().ExecQueueId();
+
+  for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.InputFence(input_index);
+    if (fence) {
+      auto execution_provider_type = p_op_kernel->Node().GetExecutionProviderType();
+      if (OrtMemTypeCPUInput == p_op_kernel->KernelDef().InputMemoryType(input_index)) {
+        execution_provider_type = kCpuExecutionProvider;
       }
+      fence->BeforeUsingAsInput(execution_provider_type, queue_id);
     }
+  }
 
-    for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
-      if (fence) {
-        fence->AfterUsedAsInput(queue_id);
+  for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
+    if (fence) {
+      auto execution_provider_type = p_op_kernel->Node().GetExecutionProviderType();
+      if (OrtMemTypeCPUInput == p_op_kernel->KernelDef().InputMemoryType(input_index)) {
+        execution_provider_type = kCpuExecutionProvider;
       }
+      fence->BeforeUsingAsInput(execution_provider_type, queue_id);
     }
+  }
 
-    for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
-      Fence_t fence = op_kernel_context.OutputFence(output_index);
-      if (fence) {
-        fence->AfterUsedAsOutput(queue_id);
-      }
+  for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
+    Fence_t fence = op_kernel_context.OutputFence(output_index);
+    if (fence) {
+      fence->BeforeUsingAsOutput(p_op_kernel->Node().GetExecutionProviderType(), queue_id);
     }
-    if (f_profiler_enabled) {
-      session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
-                                                     p_op_kernel->Node().Name() + "_fence_after",
-                                                     sync_time_begin,
-                                                     {{"op_name", p_op_kernel->KernelDef().OpName()}});
+  }
+
+  if (f_profiler_enabled) {
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                                   p_op_kernel->Node().Name() + "_fence_before",
+                                                   sync_time_begin,
+                                                   {{"op_name", p_op_kernel->KernelDef().OpName()}});
+
+    kernel_begin_time = session_state.Profiler().StartTime();
+  }
+
+  // call compute on the kernel
+  VLOGS(logger, 1) << "Computing kernel: " << p_op_kernel->Node().Name();
+
+  // Execute the kernel.
+  auto status = p_op_kernel->Compute(&op_kernel_context);
+  if (!status.IsOK()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Compute failed for node: ", p_op_kernel->Node().Name(),
+                           ". ", status.ErrorMessage());
+  }
+  if (f_profiler_enabled) {
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                                   p_op_kernel->Node().Name() + "_kernel_time",
+                                                   kernel_begin_time,
+                                                   {{"op_name", p_op_kernel->KernelDef().OpName()}});
+
+    sync_time_begin = session_state.Profiler().StartTime();
+  }
+  // sync after compute for outputs
+  for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.InputFence(input_index);
+    if (fence) {
+      fence->AfterUsedAsInput(queue_id);
     }
-    //std::cout << "Run async node finish: " << p_node_index << std::endl;
-
-    keep_running = false;
-
-    // Checking which output nodes ready for running.
-    {
-      auto begin = p_op_kernel->Node().OutputEdgesBegin();
-      auto end = p_op_kernel->Node().OutputEdgesEnd();
-
-      std::lock_guard<OrtMutex> lock(ref_mutex_);
-      for (auto it = begin; it != end; it++) {
-        auto idx = (*it).GetNode().Index();
-        if ((--node_refs_[idx]) == 0) {
-          if (!keep_running) {
-            node_index = idx;
-            keep_running = true;
-          } else {
-            EnqueueNode(idx, session_state, logger);
-          }
-        }
+  }
 
-        // std::cout << "handle output, current name: " << p_op_kernel->Node().Name() << ", current index: "
-        // << p_node_index << ", output name: " << (*it)->GetNode().Name() << ", output index: "
-        // << (*it)->GetNode().Index() << ", after -- output ref: " << node_refs_[idx] << std::endl;
-      }
+  for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
+    if (fence) {
+      fence->AfterUsedAsInput(queue_id);
+    }
+  }
+
+  for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
+    Fence_t fence = op_kernel_context.OutputFence(output_index);
+    if (fence) {
+      fence->AfterUsedAsOutput(queue_id);
     }
   }
+  if (f_profiler_enabled) {
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                                   p_op_kernel->Node().Name() + "_fence_after",
+                                                   sync_time_begin,
+                                                   {{"op_name", p_op_kernel->KernelDef().OpName()}});
+  }
 
-  FinishNodeRun();
+  return Status::OK();
 }
 
-void ParallelExecutor::EnqueueNode(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger) {
-  {
-    std::unique_lock<OrtMutex> lock(complete_mutex_);
-    out_standings_++;
+void ParallelExecutor::TryStartWorker(const SessionState& session_state, const logging::Logger& logger) {
+  if (running_workers_.load(std::memory_order_relaxed) >= static_cast<int>(num_workers_) - 1) {
+    return;
   }
 
-#ifdef USE_EIGEN_THREADPOOL
-  session_state.GetThreadPool()->Schedule([this, p_node_index, &session_state, &logger]() {
-    try {
-      ParallelExecutor::RunNodeAsync(p_node_index, std::cref(session_state), std::cref(logger));
-    } catch (...) {
-      // catch node processing failure exceptions here to prevent app crash.
+  for (size_t worker = 1; worker < num_workers_; ++worker) {
+    bool expected = false;
+    if (worker_active_[worker].load(std::memory_order_relaxed) ||
+        !worker_active_[worker].compare_exchange_strong(expected, true)) {
+      continue;
     }
-  });
+
+    ++running_workers_;
+
+#ifdef USE_EIGEN_THREADPOOL
+    session_state.GetThreadPool()->Schedule([this, worker, &session_state, &logger]() {
+      WorkerLoop(worker, session_state, logger);
+      FinishWorker(worker);
+    });
 #else
-  std::packaged_task<void()> task{std::bind(&ParallelExecutor::RunNodeAsync, this, p_node_index, std::cref(session_state), std::cref(logger))};
-  session_state.GetThreadPool()->RunTask(std::move(task));
+    std::packaged_task<void()> task{[this, worker, &session_state, &logger]() {
+      WorkerLoop(worker, session_state, logger);
+      FinishWorker(worker);
+    }};
+    session_state.GetThreadPool()->RunTask(std::move(task));
 #endif
+    return;
+  }
+}
+
+void ParallelExecutor::FinishWorker(size_t worker) {
+  worker_active_[worker].store(false);
+
+  // notify while holding the lock. Execute may return and destroy this instance as soon as it can
+  // observe running_workers_ == 0.
+  std::lock_guard<OrtMutex> lock(complete_mutex_);
+  if (--running_workers_ == 0) {
+    complete_cv_.notify_all();
+  }
+}
+
+void ParallelExecutor::SetError(const Status& status) {
+  std::lock_guard<OrtMutex> lock(error_mutex_);
+  if (!has_error_) {
+    error_ = status;
+    has_error_ = true;
+  }
 }
 }  // namespace onnxruntime
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <condition_variable>
 #include "core/common/common.h"
@@ -19,6 +21,15 @@ namespace onnxruntime {
 
 class ExecutionFrame;
 
+/**
+  * Executes the graph using the session thread pool.
+  *
+  * A node becomes ready when the atomic count of its unfinished producers drops to zero. The thread that
+  * completes the last producer runs the first ready successor inline, and pushes any other ready successors
+  * onto its own ready queue. Every worker (the calling thread plus up to one per session thread pool thread)
+  * owns a ready queue. A worker pops from the bottom of its own queue and, once that is empty, steals from the
+  * top of the others. Additional workers are only scheduled on the thread pool when extra nodes become ready.
+  */
 class ParallelExecutor : public IExecutor {
  public:
   ParallelExecutor(const bool& terminate_flag = false) : terminate_flag_{terminate_flag} {}
@@ -35,31 +46,60 @@ class ParallelExecutor : public IExecutor {
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ParallelExecutor);
 
-  void RunNodeAsync(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger);
-  void RunNodeAsyncInternal(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger);
+  // Lock-free work-stealing queue of ready node indices (Chase-Lev).
+  // Push/Pop may only be called by the owning worker; Steal may be called by any worker.
+  // Each node becomes ready exactly once per execution, so the queue never holds more than capacity entries
+  // and the buffer never needs to grow.
+  class ReadyQueue {
+   public:
+    void Init(size_t capacity);
+    void Push(size_t node_index);
+    bool Pop(size_t& node_index);
+    bool Steal(size_t& node_index);
 
-  void EnqueueNode(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger);
+   private:
+    std::unique_ptr<std::atomic<size_t>[]> buffer_;
+    size_t capacity_ = 0;
+    std::atomic<int64_t> top_{0};
+    std::atomic<int64_t> bottom_{0};
+  };
 
-  void FinishNodeRun() {
-    bool finished = false;
-    {
-      //Because we have a mutex here, it's not possible another thread is doing the test("while (out_standings_ > 0)"
-      std::lock_guard<OrtMutex> lock(complete_mutex_);
-      finished = --out_standings_ == 0;
-    }
-    if (finished) {
-      //std::cout << "all out standing nodes are completed." << std::endl;
-      complete_cv_.notify_all();
-    }
-  }
+  void WorkerLoop(size_t worker, const SessionState& session_state, const logging::Logger& logger);
+
+  bool GetReadyNode(size_t worker, size_t& node_index);
+
+  // Run node_index and then, inline, the first successor each completed node makes ready.
+  void RunNodes(size_t node_index, size_t worker, const SessionState& session_state, const logging::Logger& logger);
+
+  Status RunNode(size_t node_index, const SessionState& session_state, const logging::Logger& logger);
+
+  void TryStartWorker(const SessionState& session_state, const logging::Logger& logger);
+
+  void FinishWorker(size_t worker);
+
+  void SetError(const Status& status);
 
   std::unique_ptr<ExecutionFrame> root_frame_;
-  std::vector<size_t> node_refs_;
-  OrtMutex ref_mutex_;
-  int out_standings_;  //protected by complete_mutex_
+
+  // number of producers of each node that haven't completed yet
+  std::unique_ptr<std::atomic<size_t>[]> node_refs_;
+
+  // worker 0 is the thread calling Execute, workers 1..N run on the session thread pool
+  size_t num_workers_ = 1;
+  std::unique_ptr<ReadyQueue[]> ready_queues_;
+  std::unique_ptr<std::atomic<bool>[]> worker_active_;
+
+  // number of thread pool workers that have been scheduled and haven't exited yet.
+  // decremented under complete_mutex_ so Execute can't miss the final notification.
+  std::atomic<int> running_workers_{0};
   OrtMutex complete_mutex_;
   OrtCondVar complete_cv_;
 
+  // set once any node fails. remaining ready nodes are drained without being run.
+  std::atomic<bool> has_error_{false};
+  Status error_;  // protected by error_mutex_
+  OrtMutex error_mutex_;
+
   const bool& terminate_flag_;
 };
 }  // namespace onnxruntime
@@ -162,7 +162,7 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
   ORT_RETURN_IF_ERROR(frame.GetOutputs(fetches));
   VLOGS(logger, 1) << "Done with execution.";
 
-  if (frame.HasMemoryPatternPlanner()) {
+  if (frame.HasMemoryPatternPlanner() || frame.HasMemoryPatternOverflow()) {
     std::vector<TensorShape> input_shapes;
     bool all_tensors = true;
     for (const auto& feed : feeds) {
@@ -3,11 +3,13 @@
 
 #include "core/framework/session_state.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include "core/common/logging/logging.h"
 #include "core/framework/node_index_info.h"
 #include "core/framework/op_kernel.h"
+#include "core/framework/shared_initializers.h"
 #include "core/framework/utils.h"
 
 using namespace ::onnxruntime::common;
@@ -49,6 +51,13 @@ Status SessionState::AddInitializedTensor(int mlvalue_index, const MLValue& mlva
   return Status::OK();
 }
 
+Status SessionState::AddSharedInitializedTensor(int mlvalue_index,
+                                                std::shared_ptr<const SharedInitializer> initializer) {
+  ORT_RETURN_IF_ERROR(AddInitializedTensor(mlvalue_index, initializer->Value(), nullptr));
+  shared_initializers_.push_back(std::move(initializer));
+  return Status::OK();
+}
+
 const std::unordered_map<int, MLValue>& SessionState::GetInitializedTensors() const { return initialized_tensors_; }
 
 SessionState& SessionState::SetLogger(const logging::Logger& logger) {
@@ -66,36 +75,72 @@ void SessionState::SetProfiler(profiling::Profiler& profiler) { profiler_ = &pro
 
 ::onnxruntime::profiling::Profiler& SessionState::Profiler() const { return *profiler_; }
 
-static int64_t CalculateMemoryPatternsKey(const std::vector<TensorShape>& shapes) {
-  int64_t key = 0;
+void SessionState::SetMemoryPatternCacheOptions(size_t capacity, const std::vector<int64_t>& shape_buckets) {
+  std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
+  mem_patterns_capacity_ = capacity;
+  mem_pattern_shape_buckets_ = shape_buckets;
+  std::sort(mem_pattern_shape_buckets_.begin(), mem_pattern_shape_buckets_.end());
+}
+
+SessionState::MemoryPatternKey SessionState::CalculateMemoryPatternsKey(const std::vector<TensorShape>& shapes) const {
+  MemoryPatternKey key;
   for (auto& shape : shapes) {
-    for (auto dim : shape.GetDims()) key ^= dim;
+    const auto& dims = shape.GetDims();
+    key.push_back(static_cast<int64_t>(dims.size()));
+    for (auto dim : dims) {
+      auto bucket = std::lower_bound(mem_pattern_shape_buckets_.cbegin(), mem_pattern_shape_buckets_.cend(), dim);
+      key.push_back(bucket != mem_pattern_shape_buckets_.cend() ? *bucket : dim);
+    }
   }
   return key;
 }
 
-const MemoryPatternGroup* SessionState::GetMemoryPatternGroup(const std::vector<TensorShape>& input_shapes) const {
+std::shared_ptr<const MemoryPatternGroup> SessionState::GetMemoryPatternGroup(
+    const std::vector<TensorShape>& input_shapes) const {
   std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
-  int64_t key = CalculateMemoryPatternsKey(input_shapes);
+  auto key = CalculateMemoryPatternsKey(input_shapes);
   auto it = mem_patterns_.find(key);
-  if (it == mem_patterns_.end()) return nullptr;
+  if (it == mem_patterns_.end()) {
+    ++mem_patterns_stats_.misses;
+    return nullptr;
+  }
 
-  return it->second.get();
+  ++mem_patterns_stats_.hits;
+  mem_patterns_lru_.splice(mem_patterns_lru_.begin(), mem_patterns_lru_, it->second);
+  return it->second->second;
 }
 
 Status SessionState::UpdateMemoryPatternGroupCache(const std::vector<TensorShape>& input_shape,
                                                    std::unique_ptr<MemoryPatternGroup> mem_patterns) const {
-  int64_t key = CalculateMemoryPatternsKey(input_shape);
-
   std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
+  auto key = CalculateMemoryPatternsKey(input_shape);
   auto it = mem_patterns_.find(key);
-  if (it == mem_patterns_.end()) {
-    mem_patterns_[key] = std::move(mem_patterns);
+  if (it != mem_patterns_.end()) {
+    // frames that are still using the previous pattern keep it alive until they complete
+    it->second->second = std::move(mem_patterns);
+    mem_patterns_lru_.splice(mem_patterns_lru_.begin(), mem_patterns_lru_, it->second);
+    return Status::OK();
+  }
+
+  if (mem_patterns_capacity_ > 0 && mem_patterns_.size() >= mem_patterns_capacity_) {
+    mem_patterns_.erase(mem_patterns_lru_.back().first);
+    mem_patterns_lru_.pop_back();
+    ++mem_patterns_stats_.evictions;
   }
 
+  mem_patterns_lru_.emplace_front(key, std::move(mem_patterns));
+  mem_patterns_[std::move(key)] = mem_patterns_lru_.begin();
+
   return Status::OK();
 }
 
+MemoryPatternCacheStats SessionState::GetMemoryPatternCacheStats() const {
+  std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
+  MemoryPatternCacheStats stats = mem_patterns_stats_;
+  stats.size = mem_patterns_.size();
+  return stats;
+}
+
 
 common::Status SessionState::AddInputNameToNodeInfoMapping(const std::string& input_name, const NodeInfo& node_info) {
   // in the future we could support multiple nodes on difference devices using an input, however right now
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <list>
 #include <memory>
 #include <map>
 #include <unordered_map>
@@ -37,11 +38,23 @@ class OpKernel;
 class NodeIndexInfo;
 struct SequentialExecutionPlan;
 struct MemoryPatternGroup;
+class SharedInitializer;
+class ThreadPool;
 
 #ifndef USE_EIGEN_THREADPOOL
 class TaskThreadPool;
 #endif
 
+/**
+ * Counters for the memory pattern cache of a SessionState.
+ */
+struct MemoryPatternCacheStats {
+  size_t hits = 0;       ///< lookups that found a pattern
+  size_t misses = 0;     ///< lookups that didn't find a pattern, so the run traced its allocations to create one
+  size_t evictions = 0;  ///< patterns dropped to stay within the capacity of the cache
+  size_t size = 0;       ///< number of patterns currently in the cache
+};
+
 /**
  * SessionState should be modified by the inference session class only.
  * It is supposed to be passed by const-ref only to all the executors.
@@ -83,6 +96,12 @@ class SessionState {
   */
   Status AddInitializedTensor(int mlvalue_index, const MLValue& mlvalue, const OrtCallback* d);
 
+  /**
+  * Adds an initialized tensor that is shared with other sessions.
+  * The SessionState keeps the shared initializer alive until it is destroyed.
+  */
+  Status AddSharedInitializedTensor(int mlvalue_index, std::shared_ptr<const SharedInitializer> initializer);
+
   /**
   * Gets the list of all initialized tensors (weights) so that it can be used by the
   * execution frame to setup the appropriate MLValue vectors.
@@ -116,18 +135,29 @@ class SessionState {
   */
   profiling::Profiler& Profiler() const;
 
+  /**
+  Configure the memory pattern cache.
+  @param capacity Maximum number of cached patterns. The least recently used pattern is evicted when a new one is
+  added to a full cache. 0 means no limit.
+  @param shape_buckets Sorted upper bounds that input dims are rounded up to when looking up a pattern, so that
+  shapes which only differ slightly share one. Dims larger than the last bucket are used as is.
+  */
+  void SetMemoryPatternCacheOptions(size_t capacity, const std::vector<int64_t>& shape_buckets);
+
   /**
   Get cached memory pattern based on input shapes
   */
-  const MemoryPatternGroup* GetMemoryPatternGroup(const std::vector<TensorShape>& input_shapes) const;
+  std::shared_ptr<const MemoryPatternGroup> GetMemoryPatternGroup(const std::vector<TensorShape>& input_shapes) const;
 
   /**
-  Set generated memory pattern with a given input shapes. 
+  Set generated memory pattern with a given input shapes. Replaces any existing pattern for the shapes.
   Const as it's an internal cache update only.
   */
   Status UpdateMemoryPatternGroupCache(const std::vector<TensorShape>& input_shape,
                                        std::unique_ptr<MemoryPatternGroup> mem_patterns) const;
 
+  MemoryPatternCacheStats GetMemoryPatternCacheStats() const;
+
   struct NodeInfo {
     /**
      *
@@ -176,6 +206,10 @@ class SessionState {
   void SetThreadPool(TaskThreadPool* p_pool) { thread_pool_ = p_pool; }
 #endif
 
+  /// Thread pool for kernels to parallelize their work with. Nullable, and not owned by the SessionState.
+  ThreadPool* GetIntraOpThreadPool() const { return intra_op_thread_pool_; }
+  void SetIntraOpThreadPool(ThreadPool* p_pool) { intra_op_thread_pool_ = p_pool; }
+
   bool ExportDll() const { return export_fused_dll_; }
   void SetExportDllFlag(bool flag) { export_fused_dll_ = flag; }
 
@@ -204,15 +238,26 @@ class SessionState {
   // munmap memory region and close file descriptor
   std::unordered_map<int, OrtCallback> deleter_for_initialized_tensors_;
   std::map<OrtAllocatorInfo, BufferUniquePtr> weights_buffers_;
+  std::vector<std::shared_ptr<const SharedInitializer>> shared_initializers_;
   std::unique_ptr<SequentialExecutionPlan> p_seq_exec_plan_ = nullptr;
 
   const logging::Logger* logger_ = nullptr;
   profiling::Profiler* profiler_;
 
+  // cache for the generated mem_patterns. key is the rank and (bucketed) dims of each input shape.
+  // mem_patterns_lru_ is ordered from the most to the least recently used pattern.
+  using MemoryPatternKey = std::vector<int64_t>;
+  using MemoryPatternLruList = std::list<std::pair<MemoryPatternKey, std::shared_ptr<const MemoryPatternGroup>>>;
+
+  MemoryPatternKey CalculateMemoryPatternsKey(const std::vector<TensorShape>& shapes) const;
+
   // lock for the mem_patterns_
   mutable OrtMutex mem_patterns_lock_;
-  // cache for the generated mem_patterns. key is calculated based on input shapes.
-  mutable std::map<int64_t, std::unique_ptr<MemoryPatternGroup>> mem_patterns_;
+  mutable MemoryPatternLruList mem_patterns_lru_;
+  mutable std::map<MemoryPatternKey, MemoryPatternLruList::iterator> mem_patterns_;
+  mutable MemoryPatternCacheStats mem_patterns_stats_;
+  size_t mem_patterns_capacity_ = 0;
+  std::vector<int64_t> mem_pattern_shape_buckets_;
 
   NameNodeInfoMapType input_names_to_nodeinfo_mapping_;
   NameNodeInfoMapType output_names_to_nodeinfo_mapping_;
@@ -229,6 +274,8 @@ class SessionState {
   TaskThreadPool* thread_pool_ = nullptr;
 #endif
 
+  ThreadPool* intra_op_thread_pool_ = nullptr;
+
   bool export_fused_dll_ = false;
   FuncManager fused_funcs_mgr_;
 
@@ -4,8 +4,11 @@
 #include "core/graph/onnx_protobuf.h"
 #include "core/framework/session_state_initializer.h"
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
 #include <limits>
+#include <unordered_set>
 #include <core/common/status.h>
 
 #include "core/common/common.h"
@@ -18,6 +21,7 @@
 #include "core/framework/mlvalue_name_idx_map.h"
 #include "core/framework/sequential_execution_plan.h"
 #include "core/framework/session_state.h"
+#include "core/framework/shared_initializers.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/utils.h"
 #include "core/framework/mem_buffer.h"
@@ -29,14 +33,17 @@ static common::Status SaveMLValueNameIndexMapping(const GraphViewer& graph_viewe
                                                   const logging::Logger& logger);
 
 // T should have signature of '(int idx, const onnxruntime::MLValue& value, const OrtCallback& d) -> Status'
-template <typename T>
+// U should have signature of '(int idx, std::shared_ptr<const SharedInitializer> initializer) -> Status'
+template <typename T, typename U>
 static common::Status SaveInitializedTensors(const Env& env, const std::basic_string<PATH_CHAR_TYPE>& graph_loc,
                                              const onnxruntime::Graph& graph,
                                              const SequentialExecutionPlan& execution_plan,
                                              const ExecutionProviders& exec_providers,
                                              const MLValueNameIdxMap& mlvalue_name_idx_map,
                                              std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
-                                             const T& save_tensor_func, const logging::Logger& logger);
+                                             const T& save_tensor_func, const U& save_shared_tensor_func,
+                                             bool use_data_in_place, const std::string& shared_initializers_key,
+                                             const logging::Logger& logger);
 
 static common::Status SaveKernels(const ExecutionProviders& execution_providers,
                                   SessionState& session_state,
@@ -98,12 +105,21 @@ common::Status SessionStateInitializer::CreatePlan(const Node* parent_node,
     session_state_.SetExecutionPlan(std::move(exec_plan));
   }
 
+  AllocationPlanMemoryStats memory_stats;
+  ORT_RETURN_IF_ERROR(SequentialPlanner::ComputeMemoryStats(*session_state_.GetExecutionPlan(), *graph_viewer,
+                                                            mlvalue_name_idx_map, {}, memory_stats));
+  LOGS(logger_, INFO) << "Allocation plan memory: naive peak " << memory_stats.naive_peak_bytes
+                      << " bytes, planned peak " << memory_stats.planned_peak_bytes << " bytes, "
+                      << memory_stats.num_unknown_size_values << " values of unknown size";
+
   session_state_.SetGraphViewer(std::move(graph_viewer));
 
   return Status::OK();
 }
 
-common::Status SessionStateInitializer::InitializeAndSave(const std::vector<NodeArg*>* implicit_inputs) {
+common::Status SessionStateInitializer::InitializeAndSave(const std::vector<NodeArg*>* implicit_inputs,
+                                                          bool enable_zero_copy_initializers,
+                                                          const std::string& shared_initializers_key) {
   const auto* exec_plan_ptr = session_state_.GetExecutionPlan();
   ORT_ENFORCE(exec_plan_ptr, "Execution plan was not found in SessionState. CreatePlan must be called first.");
 
@@ -119,11 +135,17 @@ common::Status SessionStateInitializer::InitializeAndSave(const std::vector<Node
           [this](int idx, const onnxruntime::MLValue& value, const OrtCallback& d) -> Status {
             return session_state_.AddInitializedTensor(idx, value, &d);
           },
-          logger_));
+          [this](int idx, std::shared_ptr<const SharedInitializer> initializer) -> Status {
+            return session_state_.AddSharedInitializedTensor(idx, std::move(initializer));
+          },
+          enable_zero_copy_initializers, shared_initializers_key, logger_));
   // remove weights from the graph now to save memory but in many cases it won't save memory, if the tensor was
   // preallocated with the some other tensors in a single 'allocate' call, which is very common.
   // TODO: make it better
-  graph_.CleanAllInitializedTensors();
+  // with zero copy the initialized tensors may point into the raw_data of the graph's initializers, so keep them.
+  if (!enable_zero_copy_initializers) {
+    graph_.CleanAllInitializedTensors();
+  }
 
   ORT_RETURN_IF_ERROR(SaveKernels(execution_providers_, session_state_, kernel_registry_manager_, logger_));
   ORT_RETURN_IF_ERROR(SaveInputOutputNamesToNodeMapping(graph_, kernel_registry_manager_, session_state_,
@@ -186,13 +208,19 @@ common::Status SaveMLValueNameIndexMapping(const GraphViewer& graph_viewer,
   return Status::OK();
 }
 
+static bool IsCpuLocation(const OrtAllocatorInfo& alloc_info) {
+  return strcmp(alloc_info.name, CPU) == 0 || alloc_info.mem_type == OrtMemTypeCPUOutput;
+}
+
 static common::Status DeserializeTensorProto(const Env& env, const std::basic_string<PATH_CHAR_TYPE>& proto_path,
                                              const ONNX_NAMESPACE::TensorProto& tensor_proto, const MemBuffer& m,
-                                             const ExecutionProviders& exec_providers, MLValue& mlvalue, OrtCallback& deleter) {
+                                             const ExecutionProviders& exec_providers, bool use_data_in_place,
+                                             MLValue& mlvalue, OrtCallback& deleter) {
   const OrtAllocatorInfo& alloc_info = m.GetAllocInfo();
-  if (strcmp(alloc_info.name, CPU) == 0 || alloc_info.mem_type == OrtMemTypeCPUOutput) {
+  if (IsCpuLocation(alloc_info)) {
     // deserialize directly to CPU tensor
-    return utils::TensorProtoToMLValue(env, proto_path.c_str(), tensor_proto, m, mlvalue, deleter);
+    return utils::TensorProtoToMLValue(env, proto_path.c_str(), tensor_proto, m, mlvalue, deleter,
+                                       use_data_in_place);
   }
   //alloc_info.name is not 'CPU'
   const IExecutionProvider* provider = exec_providers.Get(alloc_info);
@@ -305,28 +333,119 @@ static common::Status GetPreallocatedBuffer(const MemoryPatternGroup& mem_patter
   return Status::OK();
 }
 
-template <typename T>
+// Initializers are shared between sessions on CPU only. Other devices may not outlive the session that allocated
+// the buffer, and the CPU memory of another provider may be allocated in a special way, e.g. pinned.
+static bool IsSharableLocation(const OrtAllocatorInfo& alloc_info) {
+  return strcmp(alloc_info.name, CPU) == 0 && alloc_info.mem_type == OrtMemTypeDefault;
+}
+
+// check that a shared initializer found by name really is the same as this one. The data is compared as well, as
+// the model file may have been replaced since the shared initializer was loaded from it.
+static common::Status IsSameTensor(const Env& env, const std::basic_string<PATH_CHAR_TYPE>& proto_path,
+                                   const Tensor& tensor, const ONNX_NAMESPACE::TensorProto& tensor_proto,
+                                   bool& is_same) {
+  is_same = false;
+  if (tensor.DataType() != DataTypeImpl::TensorTypeFromONNXEnum(tensor_proto.data_type())->GetElementType()) {
+    return Status::OK();
+  }
+  const auto& dims = tensor_proto.dims();
+  const TensorShape& shape = tensor.Shape();
+  if (shape.NumDimensions() != static_cast<size_t>(dims.size())) {
+    return Status::OK();
+  }
+  for (int i = 0; i < dims.size(); ++i) {
+    if (shape[i] != dims[i]) {
+      return Status::OK();
+    }
+  }
+
+  // read the data where it is if possible, otherwise unpack it into a temporary buffer
+  const bool in_place = utils::CanUseTensorProtoDataInPlace(tensor_proto);
+  size_t len = 0;
+  std::unique_ptr<char[]> data;
+  if (!in_place) {
+    ORT_RETURN_IF_ERROR(utils::GetSizeInBytesFromTensorProto<0>(tensor_proto, &len));
+    if (len > 0) {
+      data.reset(new char[len]);
+    }
+  }
+  OrtAllocatorInfo info(CPU, OrtDeviceAllocator, 0, OrtMemTypeDefault);
+  MLValue mlvalue;
+  OrtCallback deleter;
+  ORT_RETURN_IF_ERROR(utils::TensorProtoToMLValue(env, proto_path.c_str(), tensor_proto,
+                                                  MemBuffer(data.get(), len, info), mlvalue, deleter, in_place));
+  const Tensor& proto_tensor = mlvalue.Get<Tensor>();
+  if (tensor.DataType() == DataTypeImpl::GetType<std::string>()) {
+    const std::string* existing_data = tensor.Data<std::string>();
+    is_same = std::equal(existing_data, existing_data + shape.Size(), proto_tensor.Data<std::string>());
+  } else {
+    is_same = tensor.Size() == 0 || memcmp(tensor.DataRaw(), proto_tensor.DataRaw(), tensor.Size()) == 0;
+  }
+  if (deleter.f != nullptr) {
+    deleter.f(deleter.param);
+  }
+  return Status::OK();
+}
+
+template <typename T, typename U>
 common::Status SaveInitializedTensors(const Env& env, const std::basic_string<PATH_CHAR_TYPE>& graph_loc,
                                       const Graph& graph, const SequentialExecutionPlan& execution_plan,
                                       const ExecutionProviders& exec_providers,
                                       const MLValueNameIdxMap& mlvalue_name_idx_map,
                                       std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
-                                      const T& save_tensor_func, const logging::Logger& logger) {
+                                      const T& save_tensor_func, const U& save_shared_tensor_func,
+                                      bool use_data_in_place, const std::string& shared_initializers_key,
+                                      const logging::Logger& logger) {
   LOGS(logger, INFO) << "Saving initialized tensors.";
   static constexpr int alignment = 256;
   ORT_ENFORCE(mlvalue_name_idx_map.MaxIdx() > 0, "MLValue indexes should have been populated.");
 
   MLValuePatternPlanner planner(execution_plan);
+  SharedInitializerStore& shared_initializer_store = SharedInitializerStore::Instance();
 
   //1. first plan the memory
   const onnxruntime::InitializedTensorSet& initialized_tensor_set = graph.GetAllInitializedTensors();
   std::unordered_map<int, const ONNX_NAMESPACE::TensorProto*> id_to_initialized_tensor;
+  // initializers on CPU whose data is used where it is, so they don't need a weights buffer
+  std::unordered_set<int> in_place_initializers;
+  // initializers shared with other sessions. they get their own buffer if they're not in the store yet.
+  std::unordered_set<int> shared_initializers;
+  std::unordered_map<int, std::shared_ptr<const SharedInitializer>> existing_shared_initializers;
   for (const auto& entry : initialized_tensor_set) {
     int mlvalue_index;
     ORT_RETURN_IF_ERROR(mlvalue_name_idx_map.GetIdx(entry.first, mlvalue_index));
     id_to_initialized_tensor[mlvalue_index] = entry.second;
+
+    const auto& location = execution_plan.allocation_plan[mlvalue_index].location;
+    const bool in_place = use_data_in_place && IsCpuLocation(location) &&
+                          utils::CanUseTensorProtoDataInPlace(*entry.second);
+    if (in_place) {
+      in_place_initializers.insert(mlvalue_index);
+    }
+
+    // raw_data used in place belongs to the graph of this session, so it can't be shared
+    const bool is_external = entry.second->data_location() == ONNX_NAMESPACE::TensorProto_DataLocation_EXTERNAL;
+    if (!shared_initializers_key.empty() && IsSharableLocation(location) && (!in_place || is_external)) {
+      auto existing = shared_initializer_store.Find(shared_initializers_key, entry.first);
+      if (existing == nullptr) {
+        shared_initializers.insert(mlvalue_index);
+      } else {
+        bool is_same = false;
+        ORT_RETURN_IF_ERROR(IsSameTensor(env, graph_loc, existing->Value().Get<Tensor>(), *entry.second, is_same));
+        if (is_same) {
+          existing_shared_initializers[mlvalue_index] = std::move(existing);
+        } else {
+          LOGS(logger, WARNING) << "Shared initializer " << entry.first
+                                << " doesn't match the initializer of this session, so it won't be shared.";
+        }
+      }
+    }
   }
   for (const auto& entry : id_to_initialized_tensor) {
+    if (in_place_initializers.count(entry.first) > 0 || shared_initializers.count(entry.first) > 0 ||
+        existing_shared_initializers.count(entry.first) > 0) {
+      continue;
+    }
     size_t len = 0;
     ORT_RETURN_IF_ERROR(utils::GetSizeInBytesFromTensorProto<alignment>(*entry.second, &len));
     ORT_RETURN_IF_ERROR(planner.TraceAllocation(entry.first, len));
@@ -343,26 +462,56 @@ common::Status SaveInitializedTensors(const Env& env, const std::basic_string<PA
     const char* name = entry.second->has_name() ? entry.second->name().c_str() : "";
     const ONNX_NAMESPACE::TensorProto& tensor_proto = *(entry.second);
 
+    auto existing_shared = existing_shared_initializers.find(mlvalue_index);
+    if (existing_shared != existing_shared_initializers.end()) {
+      ORT_RETURN_IF_ERROR(save_shared_tensor_func(mlvalue_index, std::move(existing_shared->second)));
+      VLOGS(logger, 1) << "Added shared weight with name : " << name << " with index: " << mlvalue_index;
+      continue;
+    }
+
     auto& location = execution_plan.allocation_plan[mlvalue_index].location;
     void* buffer = nullptr;
     size_t len = 0;
-    // TODO: if the tensor need be copied, does it have enough room?
-    ORT_RETURN_IF_ERROR(
-        GetPreallocatedBuffer(mem_patterns, location, mlvalue_index, weights_buffers, name, buffer, len));
+    BufferUniquePtr shared_buffer;
+    const bool in_place = in_place_initializers.count(mlvalue_index) > 0;
+    const bool shared = shared_initializers.count(mlvalue_index) > 0;
+    if (shared && !in_place) {
+      // the buffer of a shared initializer must outlive this session, so it can't be part of the weights buffers
+      ORT_RETURN_IF_ERROR(utils::GetSizeInBytesFromTensorProto<0>(tensor_proto, &len));
+      if (len > 0) {
+        auto alloc = utils::GetAllocator(exec_providers, location);
+        if (!alloc)
+          return Status(common::ONNXRUNTIME, common::FAIL,
+                        "Failed to get allocator for location: " + location.ToString());
+        buffer = alloc->Alloc(len);
+        shared_buffer = BufferUniquePtr(buffer, alloc);
+      }
+    } else if (!in_place) {
+      // TODO: if the tensor need be copied, does it have enough room?
+      ORT_RETURN_IF_ERROR(
+          GetPreallocatedBuffer(mem_patterns, location, mlvalue_index, weights_buffers, name, buffer, len));
+    }
 #ifndef NDEBUG
     ORT_ENFORCE(buffer != nullptr || len == 0);
 #endif
 
     MemBuffer m(buffer, len, location);
     MLValue mlvalue;
-    Status st = DeserializeTensorProto(env, graph_loc, tensor_proto, m, exec_providers, mlvalue, deleter);
+    Status st = DeserializeTensorProto(env, graph_loc, tensor_proto, m, exec_providers, in_place, mlvalue, deleter);
     if (!st.IsOK()) {
       std::ostringstream oss;
       oss << "Deserialize tensor " << name << " failed." << st.ErrorMessage();
       return Status(st.Category(), st.Code(), oss.str());
     }
 
-    ORT_RETURN_IF_ERROR(save_tensor_func(mlvalue_index, mlvalue, deleter));
+    if (shared) {
+      auto initializer = std::make_unique<SharedInitializer>(mlvalue, std::move(shared_buffer), deleter);
+      ORT_RETURN_IF_ERROR(save_shared_tensor_func(
+          mlvalue_index, shared_initializer_store.Add(shared_initializers_key, tensor_proto.name(),
+                                                      std::move(initializer))));
+    } else {
+      ORT_RETURN_IF_ERROR(save_tensor_func(mlvalue_index, mlvalue, deleter));
+    }
 
     VLOGS(logger, 1) << "Added weight with name : " << name << " with index: " << mlvalue_index;
   }
@@ -40,7 +40,14 @@ class SessionStateInitializer {
 
   // initialize tensors, and save. save kernels and input/output node mappings
   // \param implicit_inputs could be NULL
-  common::Status InitializeAndSave(const std::vector<NodeArg*>* implicit_inputs);
+  // \param enable_zero_copy_initializers use the data of CPU initializers in place where possible. the initializers
+  //        are then kept in the graph, which must outlive the SessionState.
+  // \param shared_initializers_key if not empty, CPU initializers are shared through the SharedInitializerStore with
+  //        other sessions that use the same key. the key must identify the model and everything that affects the
+  //        initializers of the graph once it is transformed.
+  common::Status InitializeAndSave(const std::vector<NodeArg*>* implicit_inputs,
+                                   bool enable_zero_copy_initializers,
+                                   const std::string& shared_initializers_key);
 
  private:
   const std::basic_string<PATH_CHAR_TYPE>& graph_loc_;
@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/shared_initializers.h"
+
+namespace onnxruntime {
+
+SharedInitializerStore& SharedInitializerStore::Instance() {
+  // never destroyed, as SessionStates that are destroyed during shutdown still remove their initializers from it
+  static SharedInitializerStore* store = new SharedInitializerStore();
+  return *store;
+}
+
+std::shared_ptr<const SharedInitializer> SharedInitializerStore::Find(const std::string& model_key,
+                                                                      const std::string& name) {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  auto it = initializers_.find(Key(model_key, name));
+  if (it == initializers_.end()) {
+    return nullptr;
+  }
+  return it->second.lock();
+}
+
+std::shared_ptr<const SharedInitializer> SharedInitializerStore::Add(const std::string& model_key,
+                                                                     const std::string& name,
+                                                                     std::unique_ptr<SharedInitializer> initializer) {
+  Key key(model_key, name);
+  std::shared_ptr<const SharedInitializer> existing;
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    auto& entry = initializers_[key];
+    existing = entry.lock();
+    if (existing == nullptr) {
+      // the entry is removed when the last SessionState using the initializer releases it
+      std::shared_ptr<const SharedInitializer> added(initializer.release(),
+                                                     [this, key](const SharedInitializer* p) {
+                                                       Remove(key, p);
+                                                     });
+      entry = added;
+      return added;
+    }
+  }
+
+  // release the duplicate outside of the lock
+  initializer.reset();
+  return existing;
+}
+
+void SharedInitializerStore::Remove(const Key& key, const SharedInitializer* initializer) {
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    auto it = initializers_.find(key);
+    // the entry may have been replaced already by a session that added the initializer again
+    if (it != initializers_.end() && it->second.expired()) {
+      initializers_.erase(it);
+    }
+  }
+
+  delete initializer;
+}
+
+size_t SharedInitializerStore::Size() {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  return initializers_.size();
+}
+
+}  // namespace onnxruntime
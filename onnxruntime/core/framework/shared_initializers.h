@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "core/common/common.h"
+#include "core/common/callback.h"
+#include "core/framework/ml_value.h"
+#include "core/framework/tensor.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+/**
+ * An initialized tensor that is shared by the SessionStates of several sessions of the same model.
+ * It owns the memory of the tensor, which is released when the last SessionState using it is destroyed.
+ */
+class SharedInitializer {
+ public:
+  /**
+   * \param value the tensor
+   * \param buffer the buffer the tensor was deserialized into. May be empty if the tensor uses its data in place.
+   * \param deleter called before the buffer is freed. May be empty.
+   */
+  SharedInitializer(const MLValue& value, BufferUniquePtr buffer, const OrtCallback& deleter)
+      : value_{value}, buffer_{std::move(buffer)}, deleter_(deleter) {}
+
+  ~SharedInitializer() {
+    if (deleter_.f != nullptr) {
+      deleter_.f(deleter_.param);
+    }
+  }
+
+  const MLValue& Value() const noexcept { return value_; }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SharedInitializer);
+
+  MLValue value_;
+  BufferUniquePtr buffer_;
+  OrtCallback deleter_;
+};
+
+/**
+ * Process-wide store of the initializers shared between sessions.
+ * Entries are keyed by a model key, which identifies the model and everything that may change its initializers
+ * during session initialization, and the name of the initializer.
+ * The store doesn't keep the initializers alive. An entry is removed once no SessionState uses it.
+ */
+class SharedInitializerStore {
+ public:
+  static SharedInitializerStore& Instance();
+
+  /** Get the initializer if a live session has added it, or null. */
+  std::shared_ptr<const SharedInitializer> Find(const std::string& model_key, const std::string& name);
+
+  /**
+   * Add an initializer. If another session added the same initializer in the meantime the existing one is returned
+   * and 'initializer' is released.
+   */
+  std::shared_ptr<const SharedInitializer> Add(const std::string& model_key, const std::string& name,
+                                               std::unique_ptr<SharedInitializer> initializer);
+
+  /** Number of initializers in the store. */
+  size_t Size();
+
+ private:
+  SharedInitializerStore() = default;
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SharedInitializerStore);
+
+  using Key = std::pair<std::string, std::string>;
+
+  void Remove(const Key& key, const SharedInitializer* initializer);
+
+  OrtMutex mutex_;
+  std::map<Key, std::weak_ptr<const SharedInitializer>> initializers_;
+};
+
+}  // namespace onnxruntime
@@ -362,9 +362,38 @@ static void MoveOrtCallback(OrtCallback& from, OrtCallback& to) {
   from.param = nullptr;
 }
 
+bool CanUseTensorProtoDataInPlace(const ONNX_NAMESPACE::TensorProto& tensor_proto) {
+  if (!IsLittleEndianOrder() || tensor_proto.data_type() == TensorProto_DataType_STRING) {
+    return false;
+  }
+  size_t size_in_bytes;
+  if (!GetSizeInBytesFromTensorProto<0>(tensor_proto, &size_in_bytes).IsOK() || size_in_bytes == 0) {
+    return false;
+  }
+  const size_t element_size =
+      DataTypeImpl::TensorTypeFromONNXEnum(tensor_proto.data_type())->GetElementType()->Size();
+
+  if (tensor_proto.data_location() == TensorProto_DataLocation_EXTERNAL) {
+    std::unique_ptr<ExternalDataInfo> external_data_info;
+    if (!ExternalDataInfo::Create(tensor_proto.external_data(), external_data_info).IsOK()) {
+      return false;
+    }
+    // the file is mapped from a page boundary, so the data is aligned as well as its offset is
+    const size_t length = external_data_info->GetLength();
+    return external_data_info->GetOffset() % element_size == 0 && (length == 0 || length >= size_in_bytes);
+  }
+
+  if (tensor_proto.has_raw_data()) {
+    const std::string& raw_data = tensor_proto.raw_data();
+    return raw_data.size() == size_in_bytes && reinterpret_cast<uintptr_t>(raw_data.data()) % element_size == 0;
+  }
+
+  return false;
+}
+
 Status TensorProtoToMLValue(const Env& env, const ORTCHAR_T* tensor_proto_path,
                             const ONNX_NAMESPACE::TensorProto& tensor_proto, const MemBuffer& m, MLValue& value,
-                            OrtCallback& deleter) {
+                            OrtCallback& deleter, bool use_raw_data_in_place) {
   const OrtAllocatorInfo& allocator = m.GetAllocInfo();
   ONNXTensorElementDataType ele_type = utils::GetTensorElementType(tensor_proto);
   deleter.f = nullptr;
@@ -402,29 +431,39 @@ Status TensorProtoToMLValue(const Env& env, const ORTCHAR_T* tensor_proto_path,
       raw_data = tensor_proto.raw_data().data();
       raw_data_len = tensor_proto.raw_data().size();
     }
-    if (IsLittleEndianOrder() && raw_data != nullptr && deleter_for_file_data.d.f != nullptr) {
+    int64_t tensor_size = 1;
+    {
+      for (auto i : tensor_proto.dims()) {
+        if (i < 0) return Status(common::ONNXRUNTIME, common::FAIL, "tensor can't contain negative dims");
+        tensor_size *= i;
+      }
+    }
+    // tensor_size could be zero. see test_slice_start_out_of_bounds\test_data_set_0\output_0.pb
+    if (static_cast<uint64_t>(tensor_size) > SIZE_MAX) {
+      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "size overflow");
+    }
+    size_t size_to_allocate;
+    if (!IAllocator::CalcMemSizeForArrayWithAlignment<0>(static_cast<size_t>(tensor_size), type->Size(),
+                                                         &size_to_allocate)) {
+      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "size overflow");
+    }
+
+    // external data is owned by deleter_for_file_data, which may cover more than this tensor.
+    // raw_data is owned by tensor_proto. keep these conditions in sync with CanUseTensorProtoDataInPlace.
+    const bool is_file_data = deleter_for_file_data.d.f != nullptr;
+    const bool data_in_place = IsLittleEndianOrder() && raw_data != nullptr &&
+                               (is_file_data || use_raw_data_in_place) &&
+                               (is_file_data ? raw_data_len >= size_to_allocate : raw_data_len == size_to_allocate) &&
+                               reinterpret_cast<uintptr_t>(raw_data) % type->Size() == 0;
+    if (data_in_place) {
       tensor_data = const_cast<void*>(raw_data);
       MoveOrtCallback(deleter_for_file_data.d, deleter);
     } else {
       void* preallocated = m.GetBuffer();
       size_t preallocated_size = m.GetLen();
-      int64_t tensor_size = 1;
-      {
-        for (auto i : tensor_proto.dims()) {
-          if (i < 0) return Status(common::ONNXRUNTIME, common::FAIL, "tensor can't contain negative dims");
-          tensor_size *= i;
-        }
-      }
-      // tensor_size could be zero. see test_slice_start_out_of_bounds\test_data_set_0\output_0.pb
-      if (static_cast<uint64_t>(tensor_size) > SIZE_MAX) {
-        return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "size overflow");
-      }
-      size_t size_to_allocate;
-      if (!IAllocator::CalcMemSizeForArrayWithAlignment<0>(static_cast<size_t>(tensor_size), type->Size(),
-                                                           &size_to_allocate)) {
-        return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "size overflow");
-      }
-
+      if (preallocated == nullptr && size_to_allocate > 0)
+        return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "No preallocated buffer for the tensor of ", size_to_allocate,
+                               " bytes and its data can't be used in place");
       if (preallocated && preallocated_size < size_to_allocate)
         return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL,
                                "The buffer planner is not consistent with tensor buffer size, expected ",
@@ -30,10 +30,19 @@ std::vector<int64_t> GetTensorShapeFromTensorShapeProto(const ONNX_NAMESPACE::Te
  * \param tensor_proto_path A local file path of where the 'input' was loaded from. Can be NULL if the tensor proto doesn't
  *                        have any external data or it was loaded from current working dir. This path could be either a
  *                        relative path or an absolute path.
+ * \param use_raw_data_in_place If true, the tensor points directly to the raw_data of 'input' when the data is usable
+ *                        as is, so 'input' must outlive the tensor. External data that is usable as is always stays in
+ *                        the memory-mapped file. In both cases 'm' is not used and may be empty.
  */
 common::Status TensorProtoToMLValue(const Env& env, const ORTCHAR_T* tensor_proto_path,
                                     const ONNX_NAMESPACE::TensorProto& input, const MemBuffer& m, MLValue& value,
-                                    OrtCallback& deleter);
+                                    OrtCallback& deleter, bool use_raw_data_in_place = false);
+
+/**
+ * Whether TensorProtoToMLValue with use_raw_data_in_place set can create the tensor without a preallocated buffer,
+ * i.e. the external data or raw_data is little-endian, has the expected size and is aligned for the element type.
+ */
+bool CanUseTensorProtoDataInPlace(const ONNX_NAMESPACE::TensorProto& tensor_proto);
 // This function doesn't support string tensors
 ONNX_NAMESPACE::TensorProto::DataType GetTensorProtoType(const Tensor& tensor);
 
@@ -221,6 +221,177 @@ void convPoolShapeInference(
   }
 }
 
+void NchwcPoolOpSchemaGenerator(OpSchema& schema) {
+  schema.SetDomain(kMSNchwcDomain);
+  schema.SinceVersion(1);
+  schema.SetDoc(R"DOC(For internal use.)DOC");
+  schema.Attr("auto_pad", "", AttributeProto::STRING, std::string("NOTSET"));
+  schema.Attr("kernel_shape", "", AttributeProto::INTS);
+  schema.Attr("strides", "", AttributeProto::INTS, OPTIONAL);
+  schema.Attr("pads", "", AttributeProto::INTS, OPTIONAL);
+  schema.Input(0, "X", "", "T");
+  schema.Output(0, "Y", "", "T");
+  schema.TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors");
+  schema.TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+    ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
+  });
+}
+
+void NchwcGlobalPoolOpSchemaGenerator(OpSchema& schema) {
+  schema.SetDomain(kMSNchwcDomain);
+  schema.SinceVersion(1);
+  schema.SetDoc(R"DOC(For internal use.)DOC");
+  schema.Input(0, "X", "", "T");
+  schema.Output(0, "Y", "", "T");
+  schema.TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors");
+  schema.TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+    ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 0, 0);
+    if (!hasNInputShapes(ctx, 1)) {
+      return;
+    }
+    auto& input_shape = getInputShape(ctx, 0);
+    if (input_shape.dim_size() < 2) {
+      fail_shape_inference("Input tensor must have at least 2 dimensions");
+    }
+    // The spatial dimensions are reduced to one.
+    auto output_shape = ctx.getOutputType(0)->mutable_tensor_type()->mutable_shape();
+    *output_shape->add_dim() = input_shape.dim(0);
+    *output_shape->add_dim() = input_shape.dim(1);
+    for (int i = 2; i < input_shape.dim_size(); ++i) {
+      output_shape->add_dim()->set_dim_value(1);
+    }
+  });
+}
+
+void RegisterNchwcSchemas() {
+  // The NCHWc operators consume and produce tensors where the channel
+  // dimension is split into blocks of MlasNchwcGetBlockSize() channels. These
+  // operators are inserted by the NchwcTransformer and are not expected to
+  // appear in a model.
+  ONNX_CONTRIB_OPERATOR_SCHEMA(ReorderInput)
+      .SetDomain(kMSNchwcDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use.)DOC")
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 0, 0);
+        if (!hasNInputShapes(ctx, 1)) {
+          return;
+        }
+        // The channel count is padded to the platform specific block size.
+        auto& input_shape = getInputShape(ctx, 0);
+        auto output_shape = ctx.getOutputType(0)->mutable_tensor_type()->mutable_shape();
+        for (int i = 0; i < input_shape.dim_size(); ++i) {
+          auto* dim = output_shape->add_dim();
+          if (i != 1) {
+            *dim = input_shape.dim(i);
+          }
+        }
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(ReorderOutput)
+      .SetDomain(kMSNchwcDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use.)DOC")
+      .Attr(
+          "channels",
+          "",
+          AttributeProto::INT,
+          static_cast<int64_t>(0))
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 0, 0);
+        if (!hasNInputShapes(ctx, 1)) {
+          return;
+        }
+        auto& input_shape = getInputShape(ctx, 0);
+        auto output_shape = ctx.getOutputType(0)->mutable_tensor_type()->mutable_shape();
+        for (int i = 0; i < input_shape.dim_size(); ++i) {
+          auto* dim = output_shape->add_dim();
+          if (i != 1) {
+            *dim = input_shape.dim(i);
+          } else {
+            dim->set_dim_value(getAttribute(ctx, "channels", 0));
+          }
+        }
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(Conv)
+      .SetDomain(kMSNchwcDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use.)DOC")
+      .Attr(
+          "auto_pad",
+          "",
+          AttributeProto::STRING,
+          std::string("NOTSET"))
+      .Attr(
+          "kernel_shape",
+          "",
+          AttributeProto::INTS,
+          OPTIONAL)
+      .Attr(
+          "dilations",
+          "",
+          AttributeProto::INTS,
+          OPTIONAL)
+      .Attr(
+          "strides", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("pads",
+            "",
+            AttributeProto::INTS, OPTIONAL)
+      .Attr(
+          "group",
+          "",
+          AttributeProto::INT,
+          static_cast<int64_t>(1))
+      .Attr(
+          "activation",
+          "",
+          AttributeProto::STRING,
+          OPTIONAL)
+      .Attr(
+          "alpha",
+          "",
+          AttributeProto::FLOAT,
+          OPTIONAL)
+      .Input(0, "X", "", "T")
+      .Input(1, "W", "", "T")
+      .Input(2, "B", "", "T", OpSchema::Optional)
+      .Input(3, "Sum", "", "T", OpSchema::Optional)
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, true, false);
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(MaxPool)
+      .FillUsing(NchwcPoolOpSchemaGenerator)
+      .Attr(
+          "storage_order",
+          "",
+          AttributeProto::INT,
+          static_cast<int64_t>(0));
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(AveragePool)
+      .FillUsing(NchwcPoolOpSchemaGenerator)
+      .Attr(
+          "count_include_pad",
+          "",
+          AttributeProto::INT,
+          static_cast<int64_t>(0));
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(GlobalMaxPool)
+      .FillUsing(NchwcGlobalPoolOpSchemaGenerator);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(GlobalAveragePool)
+      .FillUsing(NchwcGlobalPoolOpSchemaGenerator);
+}
+
 void RegisterContribSchemas() {
   // ONNX exp ops(Affine, Crop, ParametricSoftplus, ImageScaler) old version history maintainance
   static const char* Affine_ver1_doc = R"DOC(
@@ -1263,6 +1434,62 @@ Note: The boxes doesn't has class dimension which means it alwasy has scores cal
         updateOutputShape(ctx, 0, input_shape);
       });
 
+  static const char* ZipMapColumns_ver1_doc = R"DOC(
+Columnar counterpart of ai.onnx.ml.ZipMap. Instead of building one map per row, the class
+probabilities are returned as a dense [N, C] tensor and the class labels as a separate [C]
+tensor, so that Y[n][j] is the score of class Z[j] for row n.
+A 1D input of shape [C] is treated as a single row and produces Y of shape [1, C].
+Must provide keys in either classlabels_strings or classlabels_int64s (but not both).
+)DOC";
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(ZipMapColumns)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(ZipMapColumns_ver1_doc)
+      .Input(0, "X", "The input values, of shape [N, C] or [C].", "tensor(float)")
+      .Output(0, "Y", "The input values as a dense [N, C] tensor.", "tensor(float)")
+      .Output(1, "Z", "The class labels, of shape [C].", "T")
+      .TypeConstraint(
+          "T",
+          {"tensor(string)", "tensor(int64)"},
+          "The labels are strings when classlabels_strings is set and int64 otherwise.")
+      .Attr("classlabels_strings", "keys if using string keys", AttributeProto::STRINGS, OPTIONAL)
+      .Attr("classlabels_int64s", "keys if using int keys", AttributeProto::INTS, OPTIONAL)
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        // Type inference
+        propagateElemTypeFromInputToOutput(ctx, 0, 0);
+        auto strings_attr = ctx.getAttribute("classlabels_strings");
+        auto int64s_attr = ctx.getAttribute("classlabels_int64s");
+        const bool using_strings = strings_attr != nullptr && strings_attr->strings_size() > 0;
+        auto labels_type = ctx.getOutputType(1)->mutable_tensor_type();
+        labels_type->set_elem_type(using_strings ? ONNX_NAMESPACE::TensorProto::STRING
+                                                 : ONNX_NAMESPACE::TensorProto::INT64);
+
+        // Shape inference
+        const int64_t class_count = using_strings ? strings_attr->strings_size()
+                                                  : (int64s_attr != nullptr ? int64s_attr->ints_size() : 0);
+        ONNX_NAMESPACE::TensorShapeProto labels_shape;
+        labels_shape.add_dim()->set_dim_value(class_count);
+        updateOutputShape(ctx, 1, labels_shape);
+
+        if (!hasInputShape(ctx, 0))
+          return;
+
+        auto& input_shape = getInputShape(ctx, 0);
+        const int rank = input_shape.dim_size();
+        if (rank != 1 && rank != 2) {
+          fail_shape_inference("Input X must be 1D or 2D.");
+        }
+        ONNX_NAMESPACE::TensorShapeProto output_shape;
+        if (rank == 1) {
+          output_shape.add_dim()->set_dim_value(1);
+        } else {
+          *output_shape.add_dim() = input_shape.dim(0);
+        }
+        output_shape.add_dim()->set_dim_value(class_count);
+        updateOutputShape(ctx, 0, output_shape);
+      });
+
   ONNX_CONTRIB_OPERATOR_SCHEMA(GatherND)
       .SetDomain(kMSDomain)
       .SinceVersion(1)
@@ -1419,6 +1646,8 @@ Example 4:
   the value of the sampled locations are computed directly
   through bilinear interpolation.)DOC");
 
+  RegisterNchwcSchemas();
+
 #ifdef MICROSOFT_INTERNAL
   // register internal ops
   RegisterInternalSchemas();
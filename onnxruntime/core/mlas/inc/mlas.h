@@ -94,6 +94,169 @@ MlasSgemm(
     size_t ldc
     );
 
+//
+// Batched single precision matrix/matrix multiply routine. The operations
+// share the same dimensions and are run concurrently on the thread pool.
+//
+
+void
+MLASCALL
+MlasSgemmBatch(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* const* A,
+    size_t lda,
+    const float* const* B,
+    size_t ldb,
+    float beta,
+    float* const* C,
+    size_t ldc,
+    size_t BatchCount
+    );
+
+//
+// Single precision matrix/matrix multiply routines for a matrix B that is
+// packed once, typically because it is a constant, and then used by many
+// calls. The packed buffer must not be moved or copied after packing as it is
+// aligned internally.
+//
+
+size_t
+MLASCALL
+MlasSgemmPackBSize(
+    size_t N,
+    size_t K
+    );
+
+void
+MLASCALL
+MlasSgemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb,
+    void* PackedB
+    );
+
+void
+MLASCALL
+MlasSgemmPacked(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc
+    );
+
+void
+MLASCALL
+MlasSgemmPackedBatch(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* const* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* const* C,
+    size_t ldc,
+    size_t BatchCount
+    );
+
+//
+// Quantized integer matrix/matrix multiply routines.
+//
+// These compute C = (A - offa) * (B - offb) with 32-bit accumulation, where A
+// is an unsigned 8-bit matrix and B is an unsigned or signed 8-bit matrix. If
+// BIsSigned is true, the bytes of B and offb are interpreted as int8_t.
+//
+// If requantization parameters are supplied, each block of C is also
+// converted to unsigned 8-bit values once it is complete:
+//
+//     Output = Saturate(Round((C + Bias) * Scale) + ZeroPoint)
+//
+// Bias is optional and supplies one value per row of C.
+//
+
+struct MLAS_QGEMM_REQUANTIZE_PARAMETERS {
+    uint8_t* Output;
+    size_t ldo;
+    const int32_t* Bias;
+    float Scale;
+    uint8_t ZeroPoint;
+};
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    bool BIsSigned,
+    int32_t* C,
+    size_t ldc,
+    const MLAS_QGEMM_REQUANTIZE_PARAMETERS* Requantize
+    );
+
+//
+// Quantized integer matrix/matrix multiply routines for a matrix B that is
+// packed once, typically because it is a constant, and then used by many
+// calls. The zero point of B is applied while packing.
+//
+
+size_t
+MLASCALL
+MlasQgemmPackBSize(
+    size_t N,
+    size_t K
+    );
+
+void
+MLASCALL
+MlasQgemmPackB(
+    size_t N,
+    size_t K,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    bool BIsSigned,
+    void* PackedB
+    );
+
+void
+MLASCALL
+MlasQgemmPacked(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const void* PackedB,
+    int32_t* C,
+    size_t ldc,
+    const MLAS_QGEMM_REQUANTIZE_PARAMETERS* Requantize
+    );
+
 //
 // Convolution routines.
 //
@@ -102,6 +265,7 @@ enum MLAS_CONV_ALGORITHM {
     MlasConvAlgorithmGemmDirect,
     MlasConvAlgorithmExpandThenGemm,
     MlasConvAlgorithmExpandThenGemmSegmented,
+    MlasConvAlgorithmDepthwise,
 };
 
 struct MLAS_CONV_PARAMETERS {
@@ -170,6 +334,7 @@ enum MLAS_POOLING_KIND {
     MlasMaximumPooling,
     MlasAveragePoolingExcludePad,
     MlasAveragePoolingIncludePad,
+    MlasPoolingKindCount,
 };
 
 void
@@ -186,6 +351,49 @@ MlasPool(
     float* Output
     );
 
+void
+MLASCALL
+MlasLpPool(
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    float P,
+    const float* Input,
+    float* Output
+    );
+
+void
+MLASCALL
+MlasMaximumPoolWithIndex(
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    float* Output,
+    int64_t* Index
+    );
+
+void
+MLASCALL
+MlasMaximumPoolWithMask(
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    const int32_t* Mask,
+    size_t MaskSize,
+    float* Output
+    );
+
 //
 // Miscellaneous compute routines.
 //
@@ -206,6 +414,136 @@ MlasComputeTanh(
     size_t N
     );
 
+//
+// Computes the softmax or log softmax function over each of the N rows of D
+// elements. The output buffer may be the same as the input buffer.
+//
+
+void
+MLASCALL
+MlasComputeSoftmax(
+    const float* Input,
+    float* Output,
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    );
+
+//
+// Transposes the M x N source matrix into the N x M destination matrix.
+//
+
+void
+MLASCALL
+MlasTranspose(
+    size_t M,
+    size_t N,
+    const uint32_t* Input,
+    size_t lda,
+    uint32_t* Output,
+    size_t ldb
+    );
+
+void
+MLASCALL
+MlasTranspose(
+    size_t M,
+    size_t N,
+    const uint8_t* Input,
+    size_t lda,
+    uint8_t* Output,
+    size_t ldb
+    );
+
+//
+// Convolution and pooling routines for the NCHWc blocked layout.
+//
+// The channel dimension of an NCHWc tensor is split into blocks of
+// MlasNchwcGetBlockSize() channels that are stored as the innermost dimension.
+// The channel count is rounded up to a multiple of the block size and the
+// padding channels are filled with zeroes when reordering the input. A block
+// size of 1 indicates that the platform does not support these routines.
+//
+// The filter of a convolution with NCHWc input is reordered as OIHWBiBo. The
+// filter of a depthwise convolution or a convolution with NCHW input, which
+// is used when the input has fewer channels than the block size, is
+// reordered as OIHWBo. The bias is padded with zeroes to a multiple of the
+// block size.
+//
+// Only two dimensional convolution and pooling is supported.
+//
+
+size_t
+MLASCALL
+MlasNchwcGetBlockSize(
+    void
+    );
+
+void
+MLASCALL
+MlasReorderInput(
+    const int64_t* InputShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasReorderOutput(
+    const int64_t* OutputShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasReorderFilterOIHWBiBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasReorderFilterOIHWBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasNchwcConv(
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    size_t GroupCount,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    const MLAS_ACTIVATION* Activation,
+    bool ZeroMode
+    );
+
+void
+MLASCALL
+MlasNchwcPool(
+    MLAS_POOLING_KIND PoolingKind,
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    float* Output
+    );
+
 //
 // Half-precision floating-point routines.
 //
@@ -218,3 +556,47 @@ MlasConvertHalfToFloatBuffer(
     float* Destination,
     size_t Count
     );
+
+//
+// Threading support.
+//
+// Threaded work is executed using OpenMP when the library is built with
+// OpenMP support. Otherwise, the caller may supply a thread pool that is used
+// to execute threaded work. If no thread pool is supplied, threaded work is
+// executed using the Win32 thread pool on Windows and serially elsewhere.
+//
+
+typedef
+void
+(MLAS_THREADPOOL_WORK_ROUTINE)(
+    void* Context,
+    int32_t Index
+    );
+
+typedef
+void
+(MLASCALL MLAS_THREADPOOL_EXECUTE_ROUTINE)(
+    void* ThreadPoolContext,
+    MLAS_THREADPOOL_WORK_ROUTINE* WorkRoutine,
+    void* Context,
+    int32_t Iterations
+    );
+
+//
+// The execute routine must invoke the work routine once for each index in
+// the range [0, Iterations) and return after all invocations have completed.
+// MaximumThreadCount is the number of threads, including the calling thread,
+// that can run the work routine concurrently.
+//
+
+struct MLAS_THREADPOOL {
+    MLAS_THREADPOOL_EXECUTE_ROUTINE* ExecuteRoutine;
+    void* ThreadPoolContext;
+    int32_t MaximumThreadCount;
+};
+
+void
+MLASCALL
+MlasSetThreadPool(
+    const MLAS_THREADPOOL* ThreadPool
+    );
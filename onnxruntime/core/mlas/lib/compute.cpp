@@ -0,0 +1,598 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    compute.cpp
+
+Abstract:
+
+    This module implements miscellaneous computation routines.
+
+    Our usage requires building platform specific versions of the algorithm to
+    target different instruction sets. The implementation below targets the
+    base instruction set (typically SSE2) while other implementations target
+    newer instruction sets (such as FMA3).
+
+--*/
+
+#include "mlasi.h"
+#include <cmath>
+
+//
+// Bundles the floating point constants for use by the exponential kernels.
+//
+
+extern "C" const MLAS_EXP_CONSTANTS MlasExpConstants = {
+    -88.3762626647949f,
+    12583039.0f,
+    1.44269504088896341f,
+    -6.93359375e-1f,
+    2.12194440e-4f,
+    1.9875691500e-4f,
+    1.3981999507e-3f,
+    8.3334519073e-3f,
+    4.1665795894e-2f,
+    1.6666665459e-1f,
+    5.0000001201e-1f,
+    1.0f,
+};
+
+//
+// Define the number of elements to process per thread before using another
+// thread to compute a softmax.
+//
+
+#define MLAS_SOFTMAX_THREAD_COMPLEXITY              (16 * 1024)
+
+//
+// Structure to contain the parameters of a softmax operation.
+//
+
+struct MLAS_SOFTMAX_WORK_BLOCK {
+    int32_t ThreadCountN;
+    bool LogSoftmax;
+    const float* Input;
+    float* Output;
+    size_t N;
+    size_t D;
+};
+
+inline
+float
+MlasExpScalar(
+    float Value
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential function for a single value that is
+    less than or equal to zero.
+
+Arguments:
+
+    Value - Supplies the input value.
+
+Return Value:
+
+    Returns the exponential of the input value.
+
+--*/
+{
+    Value = (std::max)(Value, MlasExpConstants.LowerRange);
+
+    float biased = Value * MlasExpConstants.Log2Reciprocal + MlasExpConstants.RoundingBias;
+    float m = biased - MlasExpConstants.RoundingBias;
+
+    Value = m * MlasExpConstants.Log2High + Value;
+    Value = m * MlasExpConstants.Log2Low + Value;
+
+    uint32_t BiasedBits;
+    memcpy(&BiasedBits, &biased, sizeof(float));
+
+    uint32_t NormalBits = BiasedBits << 23;
+    float normal;
+    memcpy(&normal, &NormalBits, sizeof(float));
+
+    float p = MlasExpConstants.poly_0;
+    p = p * Value + MlasExpConstants.poly_1;
+    p = p * Value + MlasExpConstants.poly_2;
+    p = p * Value + MlasExpConstants.poly_3;
+    p = p * Value + MlasExpConstants.poly_4;
+    p = p * Value + MlasExpConstants.poly_5;
+    p = p * Value + MlasExpConstants.poly_56;
+    p = p * Value + MlasExpConstants.poly_56;
+
+    return p * normal;
+}
+
+float
+MLASCALL
+MlasReduceMaximumF32Kernel(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the generic kernel to find the maximum value of
+    the supplied buffer.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    Returns the maximum value of the supplied buffer.
+
+--*/
+{
+    float Maximum = std::numeric_limits<float>::lowest();
+
+    if (N >= 4) {
+
+        MLAS_FLOAT32X4 MaximumVector0 = MlasBroadcastFloat32x4(Maximum);
+
+        if (N >= 16) {
+
+            MLAS_FLOAT32X4 MaximumVector1 = MaximumVector0;
+            MLAS_FLOAT32X4 MaximumVector2 = MaximumVector0;
+            MLAS_FLOAT32X4 MaximumVector3 = MaximumVector0;
+
+            while (N >= 16) {
+
+                MaximumVector0 = MlasMaximumFloat32x4(MaximumVector0, MlasLoadFloat32x4(Input));
+                MaximumVector1 = MlasMaximumFloat32x4(MaximumVector1, MlasLoadFloat32x4(Input + 4));
+                MaximumVector2 = MlasMaximumFloat32x4(MaximumVector2, MlasLoadFloat32x4(Input + 8));
+                MaximumVector3 = MlasMaximumFloat32x4(MaximumVector3, MlasLoadFloat32x4(Input + 12));
+
+                Input += 16;
+                N -= 16;
+            }
+
+            MaximumVector0 = MlasMaximumFloat32x4(MaximumVector0, MaximumVector1);
+            MaximumVector2 = MlasMaximumFloat32x4(MaximumVector2, MaximumVector3);
+            MaximumVector0 = MlasMaximumFloat32x4(MaximumVector0, MaximumVector2);
+        }
+
+        while (N >= 4) {
+
+            MaximumVector0 = MlasMaximumFloat32x4(MaximumVector0, MlasLoadFloat32x4(Input));
+
+            Input += 4;
+            N -= 4;
+        }
+
+        MLAS_DECLSPEC_ALIGN(float Reduction[4], 16);
+        MlasStoreAlignedFloat32x4(Reduction, MaximumVector0);
+
+        Maximum = (std::max)((std::max)(Reduction[0], Reduction[1]), (std::max)(Reduction[2], Reduction[3]));
+    }
+
+    while (N > 0) {
+
+        Maximum = (std::max)(Maximum, *Input);
+
+        Input += 1;
+        N -= 1;
+    }
+
+    return Maximum;
+}
+
+float
+MLASCALL
+MlasComputeSumExpF32Kernel(
+    const float* Input,
+    float* Output,
+    size_t N,
+    float NegativeMaximum
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the generic kernel to compute the exponential of
+    each element offset by the negated maximum of the buffer and to sum the
+    results.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Optionally supplies the output buffer. When used for Softmax,
+        the output buffer is used to store the intermediate exponential
+        results. When used for LogSoftmax, the intermediate exponential
+        results are not required.
+
+    N - Supplies the number of elements to process.
+
+    NegativeMaximum - Supplies the negated maximum value of the input buffer.
+
+Return Value:
+
+    Returns the sum of the exponential values.
+
+--*/
+{
+    float Accumulation = 0.0f;
+
+    if (N >= 4) {
+
+        MLAS_FLOAT32X4 NegativeMaximumVector = MlasBroadcastFloat32x4(NegativeMaximum);
+        MLAS_FLOAT32X4 LowerRange = MlasBroadcastFloat32x4(MlasExpConstants.LowerRange);
+        MLAS_FLOAT32X4 RoundingBias = MlasBroadcastFloat32x4(MlasExpConstants.RoundingBias);
+        MLAS_FLOAT32X4 Log2Reciprocal = MlasBroadcastFloat32x4(MlasExpConstants.Log2Reciprocal);
+        MLAS_FLOAT32X4 Log2High = MlasBroadcastFloat32x4(MlasExpConstants.Log2High);
+        MLAS_FLOAT32X4 Log2Low = MlasBroadcastFloat32x4(MlasExpConstants.Log2Low);
+        MLAS_FLOAT32X4 poly_0 = MlasBroadcastFloat32x4(MlasExpConstants.poly_0);
+        MLAS_FLOAT32X4 poly_1 = MlasBroadcastFloat32x4(MlasExpConstants.poly_1);
+        MLAS_FLOAT32X4 poly_2 = MlasBroadcastFloat32x4(MlasExpConstants.poly_2);
+        MLAS_FLOAT32X4 poly_3 = MlasBroadcastFloat32x4(MlasExpConstants.poly_3);
+        MLAS_FLOAT32X4 poly_4 = MlasBroadcastFloat32x4(MlasExpConstants.poly_4);
+        MLAS_FLOAT32X4 poly_5 = MlasBroadcastFloat32x4(MlasExpConstants.poly_5);
+        MLAS_FLOAT32X4 poly_56 = MlasBroadcastFloat32x4(MlasExpConstants.poly_56);
+
+        MLAS_FLOAT32X4 AccumulationVector = MlasZeroFloat32x4();
+
+        while (N >= 4) {
+
+            MLAS_FLOAT32X4 Value = MlasAddFloat32x4(MlasLoadFloat32x4(Input), NegativeMaximumVector);
+
+            Value = MlasMaximumFloat32x4(LowerRange, Value);
+
+            MLAS_FLOAT32X4 biased = MlasMultiplyAddFloat32x4(Value, Log2Reciprocal, RoundingBias);
+            MLAS_FLOAT32X4 m = MlasSubtractFloat32x4(biased, RoundingBias);
+
+            Value = MlasMultiplyAddFloat32x4(m, Log2High, Value);
+            Value = MlasMultiplyAddFloat32x4(m, Log2Low, Value);
+
+            MLAS_FLOAT32X4 normal = MlasReinterpretAsFloat32x4(
+                MlasShiftLeftInt32x4<23>(MlasReinterpretAsInt32x4(biased)));
+
+            MLAS_FLOAT32X4 p = poly_0;
+            p = MlasMultiplyAddFloat32x4(p, Value, poly_1);
+            p = MlasMultiplyAddFloat32x4(p, Value, poly_2);
+            p = MlasMultiplyAddFloat32x4(p, Value, poly_3);
+            p = MlasMultiplyAddFloat32x4(p, Value, poly_4);
+            p = MlasMultiplyAddFloat32x4(p, Value, poly_5);
+            p = MlasMultiplyAddFloat32x4(p, Value, poly_56);
+            p = MlasMultiplyAddFloat32x4(p, Value, poly_56);
+            p = MlasMultiplyFloat32x4(p, normal);
+
+            if (Output != nullptr) {
+                MlasStoreFloat32x4(Output, p);
+                Output += 4;
+            }
+
+            AccumulationVector = MlasAddFloat32x4(AccumulationVector, p);
+
+            Input += 4;
+            N -= 4;
+        }
+
+        MLAS_DECLSPEC_ALIGN(float Reduction[4], 16);
+        MlasStoreAlignedFloat32x4(Reduction, AccumulationVector);
+
+        Accumulation = (Reduction[0] + Reduction[1]) + (Reduction[2] + Reduction[3]);
+    }
+
+    while (N > 0) {
+
+        float Value = MlasExpScalar(*Input + NegativeMaximum);
+
+        if (Output != nullptr) {
+            *Output++ = Value;
+        }
+
+        Accumulation += Value;
+
+        Input += 1;
+        N -= 1;
+    }
+
+    return Accumulation;
+}
+
+void
+MlasComputeSoftmaxOutputF32Kernel(
+    float* Output,
+    size_t N,
+    float Scale
+    )
+/*++
+
+Routine Description:
+
+    This routine scales the intermediate exponential results of a softmax row
+    by the reciprocal of their sum.
+
+Arguments:
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+    Scale - Supplies the reciprocal of the sum of the exponential values.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_FLOAT32X4 ScaleVector = MlasBroadcastFloat32x4(Scale);
+
+    while (N >= 16) {
+
+        MLAS_FLOAT32X4 Vector0 = MlasMultiplyFloat32x4(ScaleVector, MlasLoadFloat32x4(Output));
+        MLAS_FLOAT32X4 Vector1 = MlasMultiplyFloat32x4(ScaleVector, MlasLoadFloat32x4(Output + 4));
+        MLAS_FLOAT32X4 Vector2 = MlasMultiplyFloat32x4(ScaleVector, MlasLoadFloat32x4(Output + 8));
+        MLAS_FLOAT32X4 Vector3 = MlasMultiplyFloat32x4(ScaleVector, MlasLoadFloat32x4(Output + 12));
+
+        MlasStoreFloat32x4(Output, Vector0);
+        MlasStoreFloat32x4(Output + 4, Vector1);
+        MlasStoreFloat32x4(Output + 8, Vector2);
+        MlasStoreFloat32x4(Output + 12, Vector3);
+
+        Output += 16;
+        N -= 16;
+    }
+
+    while (N >= 4) {
+
+        MlasStoreFloat32x4(Output, MlasMultiplyFloat32x4(ScaleVector, MlasLoadFloat32x4(Output)));
+
+        Output += 4;
+        N -= 4;
+    }
+
+    while (N > 0) {
+
+        *Output *= Scale;
+
+        Output += 1;
+        N -= 1;
+    }
+}
+
+void
+MlasComputeLogSoftmaxOutputF32Kernel(
+    const float* Input,
+    float* Output,
+    size_t N,
+    float Bias
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the output of a log softmax row by offsetting each
+    input value by the negated maximum and the negated logarithm of the sum of
+    the exponential values.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+    Bias - Supplies the value to add to each element.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_FLOAT32X4 BiasVector = MlasBroadcastFloat32x4(Bias);
+
+    while (N >= 16) {
+
+        MLAS_FLOAT32X4 Vector0 = MlasAddFloat32x4(BiasVector, MlasLoadFloat32x4(Input));
+        MLAS_FLOAT32X4 Vector1 = MlasAddFloat32x4(BiasVector, MlasLoadFloat32x4(Input + 4));
+        MLAS_FLOAT32X4 Vector2 = MlasAddFloat32x4(BiasVector, MlasLoadFloat32x4(Input + 8));
+        MLAS_FLOAT32X4 Vector3 = MlasAddFloat32x4(BiasVector, MlasLoadFloat32x4(Input + 12));
+
+        MlasStoreFloat32x4(Output, Vector0);
+        MlasStoreFloat32x4(Output + 4, Vector1);
+        MlasStoreFloat32x4(Output + 8, Vector2);
+        MlasStoreFloat32x4(Output + 12, Vector3);
+
+        Input += 16;
+        Output += 16;
+        N -= 16;
+    }
+
+    while (N >= 4) {
+
+        MlasStoreFloat32x4(Output, MlasAddFloat32x4(BiasVector, MlasLoadFloat32x4(Input)));
+
+        Input += 4;
+        Output += 4;
+        N -= 4;
+    }
+
+    while (N > 0) {
+
+        *Output = *Input + Bias;
+
+        Input += 1;
+        Output += 1;
+        N -= 1;
+    }
+}
+
+void
+MlasComputeSoftmaxThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    softmax or log softmax operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const auto* WorkBlock = (MLAS_SOFTMAX_WORK_BLOCK*)Context;
+
+    //
+    // Partition the operation along the N dimension.
+    //
+
+    const size_t N = WorkBlock->N;
+    const size_t D = WorkBlock->D;
+
+    const size_t WorkPerThread = N / WorkBlock->ThreadCountN;
+    const size_t WorkPerThreadExtra = N % WorkBlock->ThreadCountN;
+
+    size_t CountN;
+    size_t StartN;
+
+    if (size_t(Index) < WorkPerThreadExtra) {
+        CountN = WorkPerThread + 1;
+        StartN = CountN * Index;
+    } else {
+        CountN = WorkPerThread;
+        StartN = WorkPerThread * Index + WorkPerThreadExtra;
+    }
+
+    const float* Input = WorkBlock->Input + StartN * D;
+    float* Output = WorkBlock->Output + StartN * D;
+
+    //
+    // Compute the softmax or log softmax for each row.
+    //
+
+    while (CountN > 0) {
+
+#if defined(MLAS_TARGET_AMD64)
+        float Maximum = MlasPlatform.ReduceMaximumF32KernelRoutine(Input, D);
+#else
+        float Maximum = MlasReduceMaximumF32Kernel(Input, D);
+#endif
+        float NegativeMaximum = -Maximum;
+
+        if (WorkBlock->LogSoftmax) {
+
+#if defined(MLAS_TARGET_AMD64)
+            float Accumulation = MlasPlatform.ComputeSumExpF32KernelRoutine(Input, nullptr, D, NegativeMaximum);
+#else
+            float Accumulation = MlasComputeSumExpF32Kernel(Input, nullptr, D, NegativeMaximum);
+#endif
+
+            MlasComputeLogSoftmaxOutputF32Kernel(Input, Output, D, NegativeMaximum - std::log(Accumulation));
+
+        } else {
+
+#if defined(MLAS_TARGET_AMD64)
+            float Accumulation = MlasPlatform.ComputeSumExpF32KernelRoutine(Input, Output, D, NegativeMaximum);
+#else
+            float Accumulation = MlasComputeSumExpF32Kernel(Input, Output, D, NegativeMaximum);
+#endif
+
+            MlasComputeSoftmaxOutputF32Kernel(Output, D, 1.0f / Accumulation);
+        }
+
+        Input += D;
+        Output += D;
+        CountN--;
+    }
+}
+
+void
+MLASCALL
+MlasComputeSoftmax(
+    const float* Input,
+    float* Output,
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the softmax or log softmax function.
+
+    N.B. This implementation supports in place updates of the output buffer.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of rows to process.
+
+    D - Supplies the number of columns per row to process.
+
+    LogSoftmax - Supplies true if this is a log softmax operation, else false
+        if this is a softmax operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_SOFTMAX_WORK_BLOCK WorkBlock;
+
+    WorkBlock.LogSoftmax = LogSoftmax;
+    WorkBlock.Input = Input;
+    WorkBlock.Output = Output;
+    WorkBlock.N = N;
+    WorkBlock.D = D;
+
+    //
+    // Compute the number of target threads given the complexity of the softmax
+    // operation. Small requests should run using the single threaded path.
+    //
+
+    double Complexity = double(N) * double(D);
+
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SOFTMAX_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SOFTMAX_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) >= N) {
+        TargetThreadCount = int32_t(std::max(N, size_t(1)));
+    }
+
+    WorkBlock.ThreadCountN = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasComputeSoftmaxThreaded, &WorkBlock, TargetThreadCount);
+}
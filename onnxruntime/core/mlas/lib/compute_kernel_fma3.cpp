@@ -0,0 +1,249 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    compute_kernel_fma3.cpp
+
+Abstract:
+
+    This module implements the kernels for the softmax routines using AVX and
+    FMA3 instructions.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Masks to load and store the partial vector at the end of a buffer. The mask
+// for N remaining elements starts at index 8 - N.
+//
+
+MLAS_DECLSPEC_ALIGN(static const int32_t MlasMaskMoveTableAvx[16], 32) = {
+    -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+float
+MLASCALL
+MlasReduceMaximumF32KernelFma3(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine finds the maximum value of the supplied buffer.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    Returns the maximum value of the supplied buffer.
+
+--*/
+{
+    __m256 MaximumVector0 = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+
+    if (N >= 32) {
+
+        __m256 MaximumVector1 = MaximumVector0;
+        __m256 MaximumVector2 = MaximumVector0;
+        __m256 MaximumVector3 = MaximumVector0;
+
+        while (N >= 32) {
+
+            MaximumVector0 = _mm256_max_ps(MaximumVector0, _mm256_loadu_ps(Input));
+            MaximumVector1 = _mm256_max_ps(MaximumVector1, _mm256_loadu_ps(Input + 8));
+            MaximumVector2 = _mm256_max_ps(MaximumVector2, _mm256_loadu_ps(Input + 16));
+            MaximumVector3 = _mm256_max_ps(MaximumVector3, _mm256_loadu_ps(Input + 24));
+
+            Input += 32;
+            N -= 32;
+        }
+
+        MaximumVector0 = _mm256_max_ps(MaximumVector0, MaximumVector1);
+        MaximumVector2 = _mm256_max_ps(MaximumVector2, MaximumVector3);
+        MaximumVector0 = _mm256_max_ps(MaximumVector0, MaximumVector2);
+    }
+
+    while (N >= 8) {
+
+        MaximumVector0 = _mm256_max_ps(MaximumVector0, _mm256_loadu_ps(Input));
+
+        Input += 8;
+        N -= 8;
+    }
+
+    if (N > 0) {
+
+        __m256i Mask = _mm256_loadu_si256((const __m256i*)&MlasMaskMoveTableAvx[8 - N]);
+        __m256 Value = _mm256_maskload_ps(Input, Mask);
+
+        //
+        // Replace the unloaded elements with the initial value so that they
+        // do not contribute to the maximum.
+        //
+
+        Value = _mm256_blendv_ps(MaximumVector0, Value, _mm256_castsi256_ps(Mask));
+        MaximumVector0 = _mm256_max_ps(MaximumVector0, Value);
+    }
+
+    __m128 Reduction = _mm_max_ps(_mm256_castps256_ps128(MaximumVector0), _mm256_extractf128_ps(MaximumVector0, 1));
+    Reduction = _mm_max_ps(Reduction, _mm_movehl_ps(Reduction, Reduction));
+    Reduction = _mm_max_ss(Reduction, _mm_shuffle_ps(Reduction, Reduction, 1));
+
+    return _mm_cvtss_f32(Reduction);
+}
+
+inline
+__m256
+MlasComputeExpVectorFma3(
+    __m256 Value
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential function for a vector of values
+    that are less than or equal to zero.
+
+Arguments:
+
+    Value - Supplies the input values.
+
+Return Value:
+
+    Returns the exponential of the input values.
+
+--*/
+{
+    Value = _mm256_max_ps(_mm256_set1_ps(MlasExpConstants.LowerRange), Value);
+
+    const __m256 RoundingBias = _mm256_set1_ps(MlasExpConstants.RoundingBias);
+
+    __m256 biased = _mm256_fmadd_ps(Value, _mm256_set1_ps(MlasExpConstants.Log2Reciprocal), RoundingBias);
+    __m256 m = _mm256_sub_ps(biased, RoundingBias);
+
+    Value = _mm256_fmadd_ps(m, _mm256_set1_ps(MlasExpConstants.Log2High), Value);
+    Value = _mm256_fmadd_ps(m, _mm256_set1_ps(MlasExpConstants.Log2Low), Value);
+
+    __m256 normal = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_castps_si256(biased), 23));
+
+    const __m256 poly_56 = _mm256_set1_ps(MlasExpConstants.poly_56);
+
+    __m256 p = _mm256_set1_ps(MlasExpConstants.poly_0);
+    p = _mm256_fmadd_ps(p, Value, _mm256_set1_ps(MlasExpConstants.poly_1));
+    p = _mm256_fmadd_ps(p, Value, _mm256_set1_ps(MlasExpConstants.poly_2));
+    p = _mm256_fmadd_ps(p, Value, _mm256_set1_ps(MlasExpConstants.poly_3));
+    p = _mm256_fmadd_ps(p, Value, _mm256_set1_ps(MlasExpConstants.poly_4));
+    p = _mm256_fmadd_ps(p, Value, _mm256_set1_ps(MlasExpConstants.poly_5));
+    p = _mm256_fmadd_ps(p, Value, poly_56);
+    p = _mm256_fmadd_ps(p, Value, poly_56);
+
+    return _mm256_mul_ps(p, normal);
+}
+
+float
+MLASCALL
+MlasComputeSumExpF32KernelFma3(
+    const float* Input,
+    float* Output,
+    size_t N,
+    float NegativeMaximum
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential of each element offset by the
+    negated maximum of the buffer and sums the results.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Optionally supplies the output buffer to receive the exponential
+        values.
+
+    N - Supplies the number of elements to process.
+
+    NegativeMaximum - Supplies the negated maximum value of the input buffer.
+
+Return Value:
+
+    Returns the sum of the exponential values.
+
+--*/
+{
+    const __m256 NegativeMaximumVector = _mm256_set1_ps(NegativeMaximum);
+
+    __m256 AccumulationVector0 = _mm256_setzero_ps();
+    __m256 AccumulationVector1 = _mm256_setzero_ps();
+
+    while (N >= 16) {
+
+        __m256 Value0 = MlasComputeExpVectorFma3(_mm256_add_ps(_mm256_loadu_ps(Input), NegativeMaximumVector));
+        __m256 Value1 = MlasComputeExpVectorFma3(_mm256_add_ps(_mm256_loadu_ps(Input + 8), NegativeMaximumVector));
+
+        if (Output != nullptr) {
+            _mm256_storeu_ps(Output, Value0);
+            _mm256_storeu_ps(Output + 8, Value1);
+            Output += 16;
+        }
+
+        AccumulationVector0 = _mm256_add_ps(AccumulationVector0, Value0);
+        AccumulationVector1 = _mm256_add_ps(AccumulationVector1, Value1);
+
+        Input += 16;
+        N -= 16;
+    }
+
+    while (N > 0) {
+
+        __m256 Value;
+
+        if (N >= 8) {
+
+            Value = MlasComputeExpVectorFma3(_mm256_add_ps(_mm256_loadu_ps(Input), NegativeMaximumVector));
+
+            if (Output != nullptr) {
+                _mm256_storeu_ps(Output, Value);
+                Output += 8;
+            }
+
+            Input += 8;
+            N -= 8;
+
+        } else {
+
+            __m256i Mask = _mm256_loadu_si256((const __m256i*)&MlasMaskMoveTableAvx[8 - N]);
+
+            Value = MlasComputeExpVectorFma3(_mm256_add_ps(_mm256_maskload_ps(Input, Mask), NegativeMaximumVector));
+            Value = _mm256_and_ps(Value, _mm256_castsi256_ps(Mask));
+
+            if (Output != nullptr) {
+                _mm256_maskstore_ps(Output, Mask, Value);
+            }
+
+            N = 0;
+        }
+
+        AccumulationVector0 = _mm256_add_ps(AccumulationVector0, Value);
+    }
+
+    AccumulationVector0 = _mm256_add_ps(AccumulationVector0, AccumulationVector1);
+
+    __m128 Reduction = _mm_add_ps(_mm256_castps256_ps128(AccumulationVector0), _mm256_extractf128_ps(AccumulationVector0, 1));
+    Reduction = _mm_add_ps(Reduction, _mm_movehl_ps(Reduction, Reduction));
+    Reduction = _mm_add_ss(Reduction, _mm_shuffle_ps(Reduction, Reduction, 1));
+
+    return _mm_cvtss_f32(Reduction);
+}
@@ -0,0 +1,355 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    convdepthwise_kernel.h
+
+Abstract:
+
+    This module implements the kernel for the NCHW depthwise convolution
+    operation, where each filter is applied to a single input channel. The
+    kernel is a template over a vector type, so that each instruction set
+    extension supplies only its vector operations. The instruction set
+    specific modules include this header and export the kernel.
+
+    The kernel computes a single output channel. The kernel rows that read
+    the padding rows of the input are skipped. The outputs of each row that
+    read the padding columns of the input are computed one at a time with
+    bounds checks. The remaining outputs are computed several vectors at a
+    time.
+
+    The products are accumulated in the same order as the GEMM based
+    convolution, so that both produce identical results.
+
+    The vector type supplies:
+
+        VectorType - The type of a vector of VectorWidth floats.
+
+        VectorWidth - The number of floats in a vector.
+
+        VectorCount - The number of vectors of adjacent outputs computed
+            together.
+
+        Zero, Broadcast, Load, Store, MultiplyAdd - The vector operations.
+
+        LoadEven - Loads the even numbered elements of 2 * VectorWidth floats.
+
+        MultiplyAdd(float) - The scalar operation matching the rounding of
+            the vector operation.
+
+--*/
+
+#pragma once
+
+#include "mlasi.h"
+
+template<typename KernelType, size_t KernelWidth>
+inline
+float
+MlasConvDepthwiseNchwOutput(
+    const float* Input,
+    const float* Filter,
+    size_t InputColumn,
+    size_t InputWidth,
+    size_t KernelRows
+    )
+/*++
+
+Routine Description:
+
+    This routine computes a single output of the convolution with bounds
+    checks on the input columns.
+
+Arguments:
+
+    Input - Supplies the first valid input row for the output.
+
+    Filter - Supplies the filter row matching the first valid input row.
+
+    InputColumn - Supplies the input column of the first kernel column, which
+        has wrapped around if the column lies in the left padding.
+
+    InputWidth - Supplies the width of the input tensor.
+
+    KernelRows - Supplies the number of valid kernel rows.
+
+Return Value:
+
+    Returns the output value.
+
+--*/
+{
+    float Accumulator = 0.0f;
+
+    for (size_t kh = 0; kh < KernelRows; kh++) {
+
+        for (size_t kw = 0; kw < KernelWidth; kw++) {
+
+            const size_t ic = InputColumn + kw;
+
+            if (ic < InputWidth) {
+                Accumulator = KernelType::MultiplyAdd(Input[ic], Filter[kw], Accumulator);
+            }
+        }
+
+        Input += InputWidth;
+        Filter += KernelWidth;
+    }
+
+    return Accumulator;
+}
+
+template<typename KernelType, size_t KernelWidth, size_t StrideWidth, size_t VectorCount>
+inline
+void
+MlasConvDepthwiseNchwVectors(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t InputWidth,
+    size_t KernelRows
+    )
+/*++
+
+Routine Description:
+
+    This routine computes VectorCount vectors of adjacent outputs that read
+    entirely from inside the input row. Each vector has its own accumulator,
+    so that the multiply adds of the vectors are independent.
+
+Arguments:
+
+    Input - Supplies the first valid input row at the first kernel column of
+        the first output.
+
+    Filter - Supplies the filter row matching the first valid input row.
+
+    Output - Supplies the first output.
+
+    InputWidth - Supplies the width of the input tensor.
+
+    KernelRows - Supplies the number of valid kernel rows.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    typedef typename KernelType::VectorType VectorType;
+
+    constexpr size_t VectorWidth = KernelType::VectorWidth;
+
+    VectorType Accumulators[VectorCount];
+
+    for (size_t v = 0; v < VectorCount; v++) {
+        Accumulators[v] = KernelType::Zero();
+    }
+
+    for (size_t kh = 0; kh < KernelRows; kh++) {
+
+        for (size_t kw = 0; kw < KernelWidth; kw++) {
+
+            VectorType FilterVector = KernelType::Broadcast(Filter + kw);
+
+            for (size_t v = 0; v < VectorCount; v++) {
+
+                const float* in = Input + v * VectorWidth * StrideWidth + kw;
+
+                VectorType InputVector = (StrideWidth == 1) ?
+                    KernelType::Load(in) : KernelType::LoadEven(in);
+
+                Accumulators[v] = KernelType::MultiplyAdd(InputVector, FilterVector, Accumulators[v]);
+            }
+        }
+
+        Input += InputWidth;
+        Filter += KernelWidth;
+    }
+
+    for (size_t v = 0; v < VectorCount; v++) {
+        KernelType::Store(Output + v * VectorWidth, Accumulators[v]);
+    }
+}
+
+template<typename KernelType, size_t KernelWidth, size_t StrideWidth>
+void
+MlasConvDepthwiseNchwChannel(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine computes one output channel of a depthwise convolution.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input channel.
+
+    Filter - Supplies the filter for the output channel.
+
+    Output - Supplies the output channel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t VectorWidth = KernelType::VectorWidth;
+
+    const size_t InputHeight = Parameters->InputShape[0];
+    const size_t InputWidth = Parameters->InputShape[1];
+    const size_t OutputHeight = Parameters->OutputShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+    const size_t KernelHeight = Parameters->KernelShape[0];
+    const size_t StrideHeight = Parameters->StrideShape[0];
+    const size_t PaddingLeftHeight = Parameters->Padding[0];
+    const size_t PaddingLeftWidth = Parameters->Padding[1];
+
+    for (size_t oh = 0; oh < OutputHeight; oh++) {
+
+        //
+        // Compute the range of kernel rows that read from inside the input
+        // tensor. Rows outside this range read the padding and are skipped.
+        //
+
+        const size_t PaddedRow = oh * StrideHeight;
+
+        size_t KernelHeightStart = 0;
+        size_t KernelHeightEnd = KernelHeight;
+
+        if (PaddedRow < PaddingLeftHeight) {
+            KernelHeightStart = PaddingLeftHeight - PaddedRow;
+        }
+
+        if (PaddedRow + KernelHeightEnd > InputHeight + PaddingLeftHeight) {
+            KernelHeightEnd = InputHeight + PaddingLeftHeight - std::min(PaddedRow, InputHeight + PaddingLeftHeight);
+        }
+
+        size_t KernelRows = 0;
+        const float* input = Input;
+        const float* filter = Filter;
+
+        if (KernelHeightEnd > KernelHeightStart) {
+            KernelRows = KernelHeightEnd - KernelHeightStart;
+            input += (PaddedRow + KernelHeightStart - PaddingLeftHeight) * InputWidth;
+            filter += KernelHeightStart * KernelWidth;
+        }
+
+        size_t ow = 0;
+
+        //
+        // Compute the outputs that read the left padding columns.
+        //
+
+        while (ow < OutputWidth && ow * StrideWidth < PaddingLeftWidth) {
+
+            Output[ow] = MlasConvDepthwiseNchwOutput<KernelType, KernelWidth>(input,
+                filter, ow * StrideWidth - PaddingLeftWidth, InputWidth, KernelRows);
+
+            ow++;
+        }
+
+        //
+        // Compute the outputs that read entirely from inside the input row
+        // several vectors at a time, then a vector at a time.
+        //
+
+        constexpr size_t BlockWidth = VectorWidth * KernelType::VectorCount;
+
+        while (ow + BlockWidth <= OutputWidth &&
+            ow * StrideWidth - PaddingLeftWidth + KernelWidth - 1 + BlockWidth * StrideWidth <= InputWidth) {
+
+            MlasConvDepthwiseNchwVectors<KernelType, KernelWidth, StrideWidth, KernelType::VectorCount>(
+                input + ow * StrideWidth - PaddingLeftWidth, filter, Output + ow, InputWidth, KernelRows);
+
+            ow += BlockWidth;
+        }
+
+        while (ow + VectorWidth <= OutputWidth &&
+            ow * StrideWidth - PaddingLeftWidth + KernelWidth - 1 + VectorWidth * StrideWidth <= InputWidth) {
+
+            MlasConvDepthwiseNchwVectors<KernelType, KernelWidth, StrideWidth, 1>(
+                input + ow * StrideWidth - PaddingLeftWidth, filter, Output + ow, InputWidth, KernelRows);
+
+            ow += VectorWidth;
+        }
+
+        //
+        // Compute the remaining outputs, which may read the right padding
+        // columns.
+        //
+
+        while (ow < OutputWidth) {
+
+            Output[ow] = MlasConvDepthwiseNchwOutput<KernelType, KernelWidth>(input,
+                filter, ow * StrideWidth - PaddingLeftWidth, InputWidth, KernelRows);
+
+            ow++;
+        }
+
+        Output += OutputWidth;
+    }
+}
+
+template<typename KernelType>
+void
+MlasConvDepthwiseNchwKernel(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine dispatches to the kernel specialized for the kernel width
+    and stride width of the convolution.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input channel.
+
+    Filter - Supplies the filter for the output channel.
+
+    Output - Supplies the output channel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t KernelWidth = Parameters->KernelShape[1];
+    const size_t StrideWidth = Parameters->StrideShape[1];
+
+    if (KernelWidth == 3) {
+        if (StrideWidth == 1) {
+            MlasConvDepthwiseNchwChannel<KernelType, 3, 1>(Parameters, Input, Filter, Output);
+        } else {
+            MlasConvDepthwiseNchwChannel<KernelType, 3, 2>(Parameters, Input, Filter, Output);
+        }
+    } else {
+        if (StrideWidth == 1) {
+            MlasConvDepthwiseNchwChannel<KernelType, 5, 1>(Parameters, Input, Filter, Output);
+        } else {
+            MlasConvDepthwiseNchwChannel<KernelType, 5, 2>(Parameters, Input, Filter, Output);
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    convdepthwise_kernel_fma3.cpp
+
+Abstract:
+
+    This module implements the kernel for the NCHW depthwise convolution
+    operation using AVX2 and FMA3 instructions.
+
+--*/
+
+#include "convdepthwise_kernel.h"
+
+//
+// Vector operations for the depthwise convolution kernel. The scalar multiply
+// add is fused to match the rounding of the FMA3 and AVX512F SGEMM kernels.
+//
+
+struct MLAS_CONV_DEPTHWISE_KERNEL_FMA3
+{
+    typedef __m256 VectorType;
+
+    static constexpr size_t VectorWidth = 8;
+    static constexpr size_t VectorCount = 4;
+
+    static VectorType Zero(void) { return _mm256_setzero_ps(); }
+    static VectorType Broadcast(const float* Value) { return _mm256_broadcast_ss(Value); }
+    static VectorType Load(const float* Buffer) { return _mm256_loadu_ps(Buffer); }
+    static void Store(float* Buffer, VectorType Vector) { _mm256_storeu_ps(Buffer, Vector); }
+    static VectorType MultiplyAdd(VectorType A, VectorType B, VectorType C) { return _mm256_fmadd_ps(A, B, C); }
+
+    static
+    float
+    MultiplyAdd(float A, float B, float C)
+    {
+        return _mm_cvtss_f32(_mm_fmadd_ss(_mm_set_ss(A), _mm_set_ss(B), _mm_set_ss(C)));
+    }
+
+    static
+    VectorType
+    LoadEven(const float* Buffer)
+    {
+        __m256 Even = _mm256_shuffle_ps(_mm256_loadu_ps(Buffer), _mm256_loadu_ps(Buffer + 8), _MM_SHUFFLE(2, 0, 2, 0));
+        return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(Even), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+};
+
+void
+MLASCALL
+MlasConvDepthwiseKernelFma3(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine computes one output channel of a depthwise convolution.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input channel.
+
+    Filter - Supplies the filter for the output channel.
+
+    Output - Supplies the output channel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasConvDepthwiseNchwKernel<MLAS_CONV_DEPTHWISE_KERNEL_FMA3>(Parameters, Input, Filter, Output);
+}
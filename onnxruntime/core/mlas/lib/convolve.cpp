@@ -15,6 +15,7 @@ Abstract:
 --*/
 
 #include "mlasi.h"
+#include "convdepthwise_kernel.h"
 
 //
 // Define the number of working buffer elements required per thread.
@@ -736,6 +737,162 @@ Return Value:
     }
 }
 
+//
+// Vector operations for the portable depthwise convolution kernel.
+//
+
+struct MLAS_CONV_DEPTHWISE_KERNEL_FLOAT32X4
+{
+    typedef MLAS_FLOAT32X4 VectorType;
+
+    static constexpr size_t VectorWidth = 4;
+    static constexpr size_t VectorCount = 4;
+
+    static VectorType Zero(void) { return MlasZeroFloat32x4(); }
+    static VectorType Broadcast(const float* Value) { return MlasBroadcastFloat32x4(Value); }
+    static VectorType Load(const float* Buffer) { return MlasLoadFloat32x4(Buffer); }
+    static void Store(float* Buffer, VectorType Vector) { MlasStoreFloat32x4(Buffer, Vector); }
+    static VectorType MultiplyAdd(VectorType A, VectorType B, VectorType C) { return MlasMultiplyAddFloat32x4(A, B, C); }
+    static float MultiplyAdd(float A, float B, float C) { return A * B + C; }
+
+    static
+    VectorType
+    LoadEven(const float* Buffer)
+    {
+#if defined(MLAS_NEON_INTRINSICS)
+        return vld2q_f32(Buffer).val[0];
+#elif defined(MLAS_SSE2_INTRINSICS)
+        return _mm_shuffle_ps(_mm_loadu_ps(Buffer), _mm_loadu_ps(Buffer + 4), _MM_SHUFFLE(2, 0, 2, 0));
+#endif
+    }
+};
+
+void
+MLASCALL
+MlasConvDepthwiseKernel(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine computes one output channel of a depthwise convolution.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input channel.
+
+    Filter - Supplies the filter for the output channel.
+
+    Output - Supplies the output channel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasConvDepthwiseNchwKernel<MLAS_CONV_DEPTHWISE_KERNEL_FLOAT32X4>(Parameters, Input, Filter, Output);
+}
+
+void
+MlasConvDepthwiseThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    depthwise convolution operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_CONV_WORK_BLOCK* WorkBlock = (MLAS_CONV_WORK_BLOCK*)Context;
+
+    const MLAS_CONV_PARAMETERS* Parameters = WorkBlock->Parameters;
+
+    //
+    // Compute the range of output channels to use for this thread. Each group
+    // has a single input channel and produces FilterCount output channels.
+    //
+
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t TotalChannelCount = Parameters->BatchCount * Parameters->GroupCount * FilterCount;
+
+    const size_t TargetThreadCount = WorkBlock->TargetThreadCount;
+
+    const size_t ChannelCountPerThread = TotalChannelCount / TargetThreadCount;
+    const size_t ChannelCountExtra = TotalChannelCount % TargetThreadCount;
+
+    size_t ChannelStart;
+    size_t ChannelEnd;
+
+    if (uint32_t(Index) < ChannelCountExtra) {
+        ChannelStart = (ChannelCountPerThread + 1) * Index;
+        ChannelEnd = ChannelStart + ChannelCountPerThread + 1;
+    } else {
+        ChannelStart = ChannelCountPerThread * Index + ChannelCountExtra;
+        ChannelEnd = ChannelStart + ChannelCountPerThread;
+    }
+
+    //
+    // Iterate over the output channels allocated to this thread.
+    //
+
+    const size_t GroupCount = Parameters->GroupCount;
+    const size_t InputSize = Parameters->InputSize;
+    const size_t OutputSize = Parameters->OutputSize;
+    const size_t K = Parameters->K;
+
+    for (size_t channel = ChannelStart; channel < ChannelEnd; channel++) {
+
+        const size_t bg = channel / FilterCount;
+        const size_t filter_channel = (bg % GroupCount) * FilterCount + (channel % FilterCount);
+
+        float* output = WorkBlock->Output + channel * OutputSize;
+
+#if defined(MLAS_TARGET_AMD64)
+        MlasPlatform.ConvDepthwiseKernelRoutine(Parameters, WorkBlock->Input + bg * InputSize,
+            WorkBlock->Filter + filter_channel * K, output);
+#else
+        MlasConvDepthwiseKernel(Parameters, WorkBlock->Input + bg * InputSize,
+            WorkBlock->Filter + filter_channel * K, output);
+#endif
+
+        //
+        // Apply the activation with optional bias while the output channel is
+        // still in the cache.
+        //
+
+        const float* bias = WorkBlock->Bias;
+
+        if (bias != nullptr) {
+            bias += filter_channel;
+        }
+
+        MlasActivation(Parameters->Activation, output, bias, 1, output, OutputSize,
+            OutputSize);
+    }
+}
+
 inline
 bool
 MlasConvTryMultithread(
@@ -894,6 +1051,55 @@ Return Value:
 
     const MLAS_CONV_ALGORITHM Algorithm = Parameters->Algorithm;
 
+    //
+    // Schedule the output channels of a depthwise convolution across
+    // multiple threads.
+    //
+
+    if (Algorithm == MlasConvAlgorithmDepthwise) {
+
+        //
+        // Compute the number of target threads given the complexity of the
+        // convolution operation. Small requests should run using the single
+        // threaded path.
+        //
+
+        const size_t TotalChannelCount = BatchCount * GroupCount * FilterCount;
+
+        int32_t TargetThreadCount;
+        double Complexity = double(TotalChannelCount) * double(OutputSize) * double(K);
+
+        if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+            TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+        } else {
+            TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+        }
+
+        int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+        if (TargetThreadCount >= MaximumThreadCount) {
+            TargetThreadCount = MaximumThreadCount;
+        }
+
+        if (size_t(TargetThreadCount) >= TotalChannelCount) {
+            TargetThreadCount = int32_t(TotalChannelCount);
+        }
+
+        MLAS_CONV_WORK_BLOCK WorkBlock;
+
+        WorkBlock.Parameters = Parameters;
+        WorkBlock.Input = Input;
+        WorkBlock.Filter = Filter;
+        WorkBlock.Bias = Bias;
+        WorkBlock.WorkingBuffer = nullptr;
+        WorkBlock.Output = Output;
+        WorkBlock.TargetThreadCount = TargetThreadCount;
+
+        MlasExecuteThreaded(MlasConvDepthwiseThreaded, &WorkBlock, TargetThreadCount);
+
+        return;
+    }
+
 #if defined(MLAS_HAS_THREADING_SUPPORT)
 
     //
@@ -1005,6 +1211,16 @@ Return Value:
 
                     break;
                 }
+
+                case MlasConvAlgorithmDepthwise:
+                {
+                    //
+                    // Depthwise convolutions are scheduled across all batches
+                    // and groups above.
+                    //
+
+                    break;
+                }
             }
 
             //
@@ -1179,6 +1395,25 @@ Return Value:
         }
     }
 
+    if (Dimensions == 2 && AllDilationsAreOne && InputChannels == 1) {
+
+        //
+        // Detect a depthwise convolution with a kernel width and stride width
+        // supported by the depthwise kernel. The kernel height and stride
+        // height are not restricted.
+        //
+
+        const size_t KernelWidth = Parameters->KernelShape[1];
+        const size_t StrideWidth = Parameters->StrideShape[1];
+
+        if ((KernelWidth == 3 || KernelWidth == 5) && (StrideWidth == 1 || StrideWidth == 2)) {
+
+            Parameters->Algorithm = MlasConvAlgorithmDepthwise;
+
+            return;
+        }
+    }
+
     if (FilterCount > OutputSize) {
 
         //
@@ -21,6 +21,7 @@ Abstract:
 #include <mlas.h>
 #include <memory.h>
 #include <algorithm>
+#include <atomic>
 #include <limits>
 
 #if defined(_WIN32)
@@ -83,6 +84,9 @@ Abstract:
 #elif defined(_WIN32)
 #define MLAS_USE_WIN32_THREADPOOL
 #define MLAS_HAS_THREADING_SUPPORT
+#else
+// threaded work runs on the caller supplied thread pool if one has been set
+#define MLAS_HAS_THREADING_SUPPORT
 #endif
 
 //
@@ -109,6 +113,35 @@ Abstract:
 
 #define MLAS_SGEMM_STRIDEN_THREAD_ALIGN             16
 
+//
+// Define the default strides to step through slices of the input matrices
+// for the quantized GEMM.
+//
+// The quantized kernels operate on panels of 16 columns of matrix B with
+// pairs of rows widened to 16-bit values, so MLAS_QGEMM_STRIDEK must be even
+// and MLAS_QGEMM_STRIDEN must be a multiple of 16.
+//
+
+#define MLAS_QGEMM_STRIDEM                          16
+#define MLAS_QGEMM_STRIDEN                          128
+#define MLAS_QGEMM_STRIDEK                          256
+
+//
+// Define the maximum number of output channel blocks that the NCHWc
+// convolution kernels compute for each input row. This bounds the number of
+// accumulators that must be kept in registers.
+//
+
+#define MLAS_NCHWC_MAXIMUM_FILTER_COUNT             4
+
+//
+// Define the flags that control the NCHWc convolution kernels.
+//
+
+#define MLAS_CONV_KERNEL_FLAG_ACCUMULATE_OUTPUT     0x00000001
+#define MLAS_CONV_KERNEL_FLAG_BIAS_ADDITION         0x00000002
+#define MLAS_CONV_KERNEL_FLAG_RELU_ACTIVATION       0x00000004
+
 //
 // Define the prototypes of the platform optimized routines.
 //
@@ -153,6 +186,22 @@ void
 
 typedef MLAS_SGEMM_TRANSPOSE_PACKB_BLOCK_ROUTINE* PMLAS_SGEMM_TRANSPOSE_PACKB_BLOCK_ROUTINE;
 
+typedef
+size_t
+(MLASCALL MLAS_QGEMM_KERNEL_ROUTINE)(
+    const int32_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    bool ZeroMode
+    );
+
+typedef MLAS_QGEMM_KERNEL_ROUTINE* PMLAS_QGEMM_KERNEL_ROUTINE;
+
 typedef
 void
 (MLASCALL MLAS_LOGISTIC_KERNEL_ROUTINE)(
@@ -173,6 +222,77 @@ void
 
 typedef MLAS_TANH_KERNEL_ROUTINE* PMLAS_TANH_KERNEL_ROUTINE;
 
+typedef
+float
+(MLASCALL MLAS_REDUCE_MAXIMUM_FLOAT_KERNEL)(
+    const float* Input,
+    size_t N
+    );
+
+typedef MLAS_REDUCE_MAXIMUM_FLOAT_KERNEL* PMLAS_REDUCE_MAXIMUM_FLOAT_KERNEL;
+
+typedef
+float
+(MLASCALL MLAS_COMPUTE_SUMEXP_FLOAT_KERNEL)(
+    const float* Input,
+    float* Output,
+    size_t N,
+    float NegativeMaximum
+    );
+
+typedef MLAS_COMPUTE_SUMEXP_FLOAT_KERNEL* PMLAS_COMPUTE_SUMEXP_FLOAT_KERNEL;
+
+typedef
+void
+(MLASCALL MLAS_CONV_FLOAT_KERNEL)(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t InputStride,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    const float* Bias,
+    unsigned Flags
+    );
+
+typedef MLAS_CONV_FLOAT_KERNEL* PMLAS_CONV_FLOAT_KERNEL;
+
+typedef
+void
+(MLASCALL MLAS_POOL_FLOAT_KERNEL)(
+    const float* Input,
+    float* Output,
+    size_t StrideWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputStride,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    size_t ActualKernelSize
+    );
+
+typedef MLAS_POOL_FLOAT_KERNEL* PMLAS_POOL_FLOAT_KERNEL;
+
+typedef
+void
+(MLASCALL MLAS_CONV_DEPTHWISE_KERNEL_ROUTINE)(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    float* Output
+    );
+
+typedef MLAS_CONV_DEPTHWISE_KERNEL_ROUTINE* PMLAS_CONV_DEPTHWISE_KERNEL_ROUTINE;
+
 extern "C" {
 
     MLAS_SGEMM_KERNEL_ROUTINE MlasSgemmKernelZero;
@@ -200,6 +320,13 @@ extern "C" {
     MLAS_SGEMM_TRANSPOSE_PACKB_BLOCK_ROUTINE MlasSgemmTransposePackB16x4Avx;
 #endif
 
+    MLAS_QGEMM_KERNEL_ROUTINE MlasQgemmKernel;
+#if defined(MLAS_TARGET_AMD64)
+    MLAS_QGEMM_KERNEL_ROUTINE MlasQgemmKernelAvx2;
+    MLAS_QGEMM_KERNEL_ROUTINE MlasQgemmKernelAvx512BW;
+    MLAS_QGEMM_KERNEL_ROUTINE MlasQgemmKernelAvx512Vnni;
+#endif
+
     MLAS_TANH_KERNEL_ROUTINE MlasLogisticKernel;
     MLAS_TANH_KERNEL_ROUTINE MlasTanhKernel;
 #if defined(MLAS_TARGET_AMD64)
@@ -207,8 +334,62 @@ extern "C" {
     MLAS_TANH_KERNEL_ROUTINE MlasTanhKernelFma3;
 #endif
 
+    MLAS_REDUCE_MAXIMUM_FLOAT_KERNEL MlasReduceMaximumF32Kernel;
+    MLAS_COMPUTE_SUMEXP_FLOAT_KERNEL MlasComputeSumExpF32Kernel;
+#if defined(MLAS_TARGET_AMD64)
+    MLAS_REDUCE_MAXIMUM_FLOAT_KERNEL MlasReduceMaximumF32KernelFma3;
+    MLAS_COMPUTE_SUMEXP_FLOAT_KERNEL MlasComputeSumExpF32KernelFma3;
+#endif
+
+#if defined(MLAS_TARGET_AMD64)
+    MLAS_CONV_FLOAT_KERNEL MlasConvNchwcFloatKernelFma3;
+    MLAS_CONV_FLOAT_KERNEL MlasConvNchwFloatKernelFma3;
+    MLAS_CONV_FLOAT_KERNEL MlasConvDepthwiseFloatKernelFma3;
+    MLAS_POOL_FLOAT_KERNEL MlasPoolMaximumFloatKernelFma3;
+    MLAS_POOL_FLOAT_KERNEL MlasPoolAverageExcludePadFloatKernelFma3;
+    MLAS_POOL_FLOAT_KERNEL MlasPoolAverageIncludePadFloatKernelFma3;
+    MLAS_CONV_FLOAT_KERNEL MlasConvNchwcFloatKernelAvx512F;
+    MLAS_CONV_FLOAT_KERNEL MlasConvNchwFloatKernelAvx512F;
+    MLAS_CONV_FLOAT_KERNEL MlasConvDepthwiseFloatKernelAvx512F;
+    MLAS_POOL_FLOAT_KERNEL MlasPoolMaximumFloatKernelAvx512F;
+    MLAS_POOL_FLOAT_KERNEL MlasPoolAverageExcludePadFloatKernelAvx512F;
+    MLAS_POOL_FLOAT_KERNEL MlasPoolAverageIncludePadFloatKernelAvx512F;
+#endif
+
+    MLAS_CONV_DEPTHWISE_KERNEL_ROUTINE MlasConvDepthwiseKernel;
+#if defined(MLAS_TARGET_AMD64)
+    MLAS_CONV_DEPTHWISE_KERNEL_ROUTINE MlasConvDepthwiseKernelFma3;
+#endif
+
 }
 
+//
+// Bundles the floating point constants for the exponential function used by
+// the softmax kernels.
+//
+// The input is reduced to r = x - m * ln(2) where m = round(x / ln(2)), then
+// exp(r) is approximated with a polynomial and scaled by 2^m. The natural
+// logarithm of 2 is split into a high and low part so that the reduction is
+// exact for the supported range. The same polynomial is used by Cephes.
+//
+
+struct MLAS_EXP_CONSTANTS {
+    float LowerRange;
+    float RoundingBias;
+    float Log2Reciprocal;
+    float Log2High;
+    float Log2Low;
+    float poly_0;
+    float poly_1;
+    float poly_2;
+    float poly_3;
+    float poly_4;
+    float poly_5;
+    float poly_56;
+};
+
+extern "C" const MLAS_EXP_CONSTANTS MlasExpConstants;
+
 //
 // Define the target number of per-thread multiplies before using another
 // thread to perform additional work.
@@ -228,6 +409,13 @@ extern "C" {
 #endif
 #endif
 
+//
+// The quantized kernels complete a multiply/add in about the time of the
+// single precision kernels, so use the same target for the quantized GEMM.
+//
+
+#define MLAS_QGEMM_THREAD_COMPLEXITY                MLAS_SGEMM_THREAD_COMPLEXITY
+
 //
 // Single-threaded single precision matrix/matrix multiply operation.
 //
@@ -268,8 +456,23 @@ struct MLAS_PLATFORM {
     PMLAS_SGEMM_TRANSPOSE_PACKB_BLOCK_ROUTINE TransposePackB16x4Routine;
     PMLAS_LOGISTIC_KERNEL_ROUTINE LogisticKernelRoutine;
     PMLAS_TANH_KERNEL_ROUTINE TanhKernelRoutine;
+    PMLAS_QGEMM_KERNEL_ROUTINE QgemmKernelRoutine;
+    PMLAS_REDUCE_MAXIMUM_FLOAT_KERNEL ReduceMaximumF32KernelRoutine;
+    PMLAS_COMPUTE_SUMEXP_FLOAT_KERNEL ComputeSumExpF32KernelRoutine;
+    PMLAS_CONV_DEPTHWISE_KERNEL_ROUTINE ConvDepthwiseKernelRoutine;
 #endif
 
+    //
+    // The NCHWc routines are supported if the block size is larger than one,
+    // in which case the kernels below are also available.
+    //
+
+    size_t NchwcBlockSize;
+    PMLAS_CONV_FLOAT_KERNEL ConvNchwcFloatKernel;
+    PMLAS_CONV_FLOAT_KERNEL ConvNchwFloatKernel;
+    PMLAS_CONV_FLOAT_KERNEL ConvDepthwiseFloatKernel;
+    PMLAS_POOL_FLOAT_KERNEL PoolFloatKernel[MlasPoolingKindCount];
+
 #if defined(MLAS_USE_WIN32_THREADPOOL)
     int32_t MaximumThreadCount;
 #endif
@@ -277,16 +480,7 @@ struct MLAS_PLATFORM {
     int32_t
     GetMaximumThreadCount(
         void
-        )
-    {
-#if defined(MLAS_USE_OPENMP)
-        return (omp_get_num_threads() == 1) ? omp_get_max_threads() : 1;
-#elif defined(MLAS_USE_WIN32_THREADPOOL)
-        return MaximumThreadCount;
-#else
-        return 1;
-#endif
-    }
+        );
 };
 
 extern MLAS_PLATFORM MlasPlatform;
@@ -295,15 +489,40 @@ extern MLAS_PLATFORM MlasPlatform;
 // Threading support.
 //
 
-typedef
-void
-(MLAS_THREADED_ROUTINE)(
-    void* Context,
-    int32_t Index
-    );
+typedef MLAS_THREADPOOL_WORK_ROUTINE MLAS_THREADED_ROUTINE;
 
 typedef MLAS_THREADED_ROUTINE* PMLAS_THREADED_ROUTINE;
 
+//
+// Caller supplied thread pool, or nullptr if none has been set. This is kept
+// outside of MLAS_PLATFORM so that it is constant initialized.
+//
+
+extern std::atomic<const MLAS_THREADPOOL*> MlasThreadPool;
+
+inline
+int32_t
+MLAS_PLATFORM::GetMaximumThreadCount(
+    void
+    )
+{
+#if defined(MLAS_USE_OPENMP)
+    return (omp_get_num_threads() == 1) ? omp_get_max_threads() : 1;
+#else
+    const MLAS_THREADPOOL* ThreadPool = MlasThreadPool.load(std::memory_order_acquire);
+
+    if (ThreadPool != nullptr) {
+        return std::min(std::max(ThreadPool->MaximumThreadCount, 1), MLAS_MAXIMUM_THREAD_COUNT);
+    }
+
+#if defined(MLAS_USE_WIN32_THREADPOOL)
+    return MaximumThreadCount;
+#else
+    return 1;
+#endif
+#endif
+}
+
 void
 MlasExecuteThreaded(
     PMLAS_THREADED_ROUTINE ThreadedRoutine,
@@ -351,9 +570,45 @@ MlasExecuteThreaded(
 
 #if defined(MLAS_NEON_INTRINSICS)
 typedef float32x4_t MLAS_FLOAT32X4;
+typedef int32x4_t MLAS_INT32X4;
 #elif defined(MLAS_SSE2_INTRINSICS)
 typedef __m128 MLAS_FLOAT32X4;
+typedef __m128i MLAS_INT32X4;
+#endif
+
+inline
+MLAS_INT32X4
+MlasReinterpretAsInt32x4(MLAS_FLOAT32X4 Vector)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vreinterpretq_s32_f32(Vector);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_castps_si128(Vector);
 #endif
+}
+
+inline
+MLAS_FLOAT32X4
+MlasReinterpretAsFloat32x4(MLAS_INT32X4 Vector)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vreinterpretq_f32_s32(Vector);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_castsi128_ps(Vector);
+#endif
+}
+
+template<unsigned ShiftCount>
+inline
+MLAS_INT32X4
+MlasShiftLeftInt32x4(MLAS_INT32X4 Vector)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vshlq_n_s32(Vector, ShiftCount);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_slli_epi32(Vector, ShiftCount);
+#endif
+}
 
 inline
 MLAS_FLOAT32X4
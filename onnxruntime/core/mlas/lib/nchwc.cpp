@@ -0,0 +1,1038 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    nchwc.cpp
+
+Abstract:
+
+    This module implements the convolution and pooling routines for the NCHWc
+    blocked layout and the routines to reorder tensors to and from the
+    layout.
+
+    The channels of an NCHWc tensor are split into blocks that are stored as
+    the innermost dimension, so the kernels load all of the channels of a
+    block for a pixel with one vector load. Each operation is split into rows
+    of output for a set of output channel blocks. Each row is computed by the
+    platform kernel, which steps through the input channel blocks and kernel
+    rows.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Stores the parameters common to the NCHWc convolution and pooling
+// operations.
+//
+
+struct MLAS_NCHWC_WORK_BLOCK
+{
+    int32_t TargetThreadCount;
+    size_t BatchCount;
+    size_t InputChannels;
+    size_t InputShape[2];
+    size_t InputSize;
+    size_t OutputChannels;
+    size_t OutputShape[2];
+    size_t OutputSize;
+    size_t KernelShape[2];
+    size_t DilationShape[2];
+    size_t Padding[4];
+    size_t StrideShape[2];
+};
+
+//
+// Stores the parameters for an NCHWc convolution operation.
+//
+
+struct MLAS_NCHWC_CONV_WORK_BLOCK : MLAS_NCHWC_WORK_BLOCK
+{
+    const float* Input;
+    const float* Filter;
+    const float* Bias;
+    const MLAS_ACTIVATION* Activation;
+    float* Output;
+    size_t GroupCount;
+    bool ZeroMode;
+};
+
+//
+// Stores the parameters for an NCHWc pooling operation.
+//
+
+struct MLAS_NCHWC_POOL_WORK_BLOCK : MLAS_NCHWC_WORK_BLOCK
+{
+    MLAS_POOLING_KIND PoolingKind;
+    const float* Input;
+    float* Output;
+};
+
+size_t
+MLASCALL
+MlasNchwcGetBlockSize(
+    void
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the NCHWc block size for the platform.
+
+Arguments:
+
+    None.
+
+Return Value:
+
+    Returns the number of channels in a block, or 1 if the platform does not
+    support the NCHWc routines.
+
+--*/
+{
+    return MlasPlatform.NchwcBlockSize;
+}
+
+void
+MlasNchwcPrepareWorkBlock(
+    MLAS_NCHWC_WORK_BLOCK* WorkBlock,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape
+    )
+/*++
+
+Routine Description:
+
+    This routine prepares for an NCHWc convolution or pooling operation by
+    computing the parameters common to both.
+
+Arguments:
+
+    WorkBlock - Supplies the structure that receives the parameters.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    KernelShape - Supplies the shape of the kernel. If nullptr, the kernel
+        covers the input image for global pooling.
+
+    DilationShape - Supplies the dilation of the kernel. If nullptr, the
+        kernel is not dilated.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        image. If nullptr, the input image is not padded.
+
+    StrideShape - Supplies the stride of the kernel. If nullptr, the stride
+        is 1.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    WorkBlock->BatchCount = size_t(InputShape[0]);
+    WorkBlock->InputChannels = size_t(InputShape[1]);
+    WorkBlock->OutputChannels = size_t(OutputShape[1]);
+
+    WorkBlock->InputSize = 1;
+    WorkBlock->OutputSize = 1;
+
+    for (size_t dim = 0; dim < 2; dim++) {
+
+        const size_t InputValue = size_t(InputShape[dim + 2]);
+        const size_t OutputValue = size_t(OutputShape[dim + 2]);
+
+        WorkBlock->InputShape[dim] = InputValue;
+        WorkBlock->OutputShape[dim] = OutputValue;
+        WorkBlock->InputSize *= InputValue;
+        WorkBlock->OutputSize *= OutputValue;
+
+        if (KernelShape != nullptr) {
+            WorkBlock->KernelShape[dim] = size_t(KernelShape[dim]);
+        } else {
+            WorkBlock->KernelShape[dim] = InputValue;
+        }
+
+        if (DilationShape != nullptr) {
+            WorkBlock->DilationShape[dim] = size_t(DilationShape[dim]);
+        } else {
+            WorkBlock->DilationShape[dim] = 1;
+        }
+
+        if (Padding != nullptr) {
+            WorkBlock->Padding[dim] = size_t(Padding[dim]);
+            WorkBlock->Padding[dim + 2] = size_t(Padding[dim + 2]);
+        } else {
+            WorkBlock->Padding[dim] = 0;
+            WorkBlock->Padding[dim + 2] = 0;
+        }
+
+        if (StrideShape != nullptr) {
+            WorkBlock->StrideShape[dim] = size_t(StrideShape[dim]);
+        } else {
+            WorkBlock->StrideShape[dim] = 1;
+        }
+    }
+}
+
+int32_t
+MlasNchwcGetTargetThreadCount(
+    double Complexity,
+    size_t TotalWork
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the number of threads to use for an operation
+    given its complexity. Small operations run on the calling thread.
+
+Arguments:
+
+    Complexity - Supplies the number of multiply/adds or comparable operations
+        to perform.
+
+    TotalWork - Supplies the number of independent rows of work.
+
+Return Value:
+
+    Returns the number of threads to use.
+
+--*/
+{
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) >= TotalWork) {
+        TargetThreadCount = int32_t(TotalWork);
+    }
+
+    return TargetThreadCount;
+}
+
+void
+MlasNchwcPartitionWork(
+    int32_t Index,
+    int32_t TargetThreadCount,
+    size_t TotalWork,
+    size_t* WorkIndex,
+    size_t* WorkRemaining
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the range of rows of work for a thread.
+
+Arguments:
+
+    Index - Supplies the index of the thread.
+
+    TargetThreadCount - Supplies the number of threads.
+
+    TotalWork - Supplies the number of rows of work.
+
+    WorkIndex - Receives the first row of work for the thread.
+
+    WorkRemaining - Receives the number of rows of work for the thread.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t WorkPerThread = TotalWork / size_t(TargetThreadCount);
+    const size_t WorkPerThreadExtra = TotalWork % size_t(TargetThreadCount);
+
+    if (size_t(Index) < WorkPerThreadExtra) {
+        *WorkIndex = (WorkPerThread + 1) * size_t(Index);
+        *WorkRemaining = WorkPerThread + 1;
+    } else {
+        *WorkIndex = WorkPerThread * size_t(Index) + WorkPerThreadExtra;
+        *WorkRemaining = WorkPerThread;
+    }
+}
+
+inline
+void
+MlasNchwcGetKernelHeightRange(
+    const MLAS_NCHWC_WORK_BLOCK* WorkBlock,
+    size_t oh,
+    size_t* InputRow,
+    size_t* KernelHeightStart,
+    size_t* KernelHeightCount
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the range of kernel rows that read from inside the
+    input image for an output row.
+
+Arguments:
+
+    WorkBlock - Supplies the parameters of the operation.
+
+    oh - Supplies the output row.
+
+    InputRow - Receives the input row of the first valid kernel row.
+
+    KernelHeightStart - Receives the first valid kernel row.
+
+    KernelHeightCount - Receives the number of valid kernel rows.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t InputHeight = WorkBlock->InputShape[0];
+    const size_t KernelHeight = WorkBlock->KernelShape[0];
+    const size_t DilationHeight = WorkBlock->DilationShape[0];
+
+    const ptrdiff_t ih = ptrdiff_t(oh * WorkBlock->StrideShape[0]) - ptrdiff_t(WorkBlock->Padding[0]);
+
+    size_t khStart = 0;
+
+    if (ih < 0) {
+        khStart = (size_t(-ih) + DilationHeight - 1) / DilationHeight;
+    }
+
+    size_t khEnd = 0;
+
+    if (ih < ptrdiff_t(InputHeight)) {
+        khEnd = (size_t(ptrdiff_t(InputHeight) - ih) + DilationHeight - 1) / DilationHeight;
+    }
+
+    khEnd = std::min(khEnd, KernelHeight);
+
+    if (khEnd > khStart) {
+        *InputRow = size_t(ih + ptrdiff_t(khStart * DilationHeight));
+        *KernelHeightStart = khStart;
+        *KernelHeightCount = khEnd - khStart;
+    } else {
+        *InputRow = 0;
+        *KernelHeightStart = 0;
+        *KernelHeightCount = 0;
+    }
+}
+
+void
+MlasNchwcConvThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of an
+    NCHWc convolution operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_NCHWC_CONV_WORK_BLOCK* WorkBlock = (const MLAS_NCHWC_CONV_WORK_BLOCK*)Context;
+
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t InputChannels = WorkBlock->InputChannels;
+    const size_t InputWidth = WorkBlock->InputShape[1];
+    const size_t InputSize = WorkBlock->InputSize;
+    const size_t OutputChannels = WorkBlock->OutputChannels;
+    const size_t OutputHeight = WorkBlock->OutputShape[0];
+    const size_t OutputWidth = WorkBlock->OutputShape[1];
+    const size_t OutputSize = WorkBlock->OutputSize;
+    const size_t KernelSize = WorkBlock->KernelShape[0] * WorkBlock->KernelShape[1];
+    const size_t KernelWidth = WorkBlock->KernelShape[1];
+    const size_t DilationHeight = WorkBlock->DilationShape[0];
+
+    const MLAS_ACTIVATION_KIND ActivationKind = WorkBlock->Activation->ActivationKind;
+
+    //
+    // Select the kernel and the layout of the input and filter. Depthwise
+    // convolutions compute each channel block independently. Inputs with
+    // fewer channels than the block size are read directly from NCHW order,
+    // one input channel at a time. FilterBlockChannels is the number of input
+    // channels stored for each kernel element of a filter block.
+    //
+
+    PMLAS_CONV_FLOAT_KERNEL Kernel;
+    size_t FilterSetSize;
+    size_t InputBlockCount;
+    size_t InputBlockChannels;
+    size_t FilterBlockChannels;
+
+    if (WorkBlock->GroupCount > 1) {
+        Kernel = MlasPlatform.ConvDepthwiseFloatKernel;
+        FilterSetSize = 1;
+        InputBlockCount = 1;
+        InputBlockChannels = BlockSize;
+        FilterBlockChannels = 1;
+    } else if (InputChannels < BlockSize) {
+        Kernel = MlasPlatform.ConvNchwFloatKernel;
+        FilterSetSize = MLAS_NCHWC_MAXIMUM_FILTER_COUNT;
+        InputBlockCount = InputChannels;
+        InputBlockChannels = 1;
+        FilterBlockChannels = 1;
+    } else {
+        Kernel = MlasPlatform.ConvNchwcFloatKernel;
+        FilterSetSize = MLAS_NCHWC_MAXIMUM_FILTER_COUNT;
+        InputBlockCount = InputChannels / BlockSize;
+        InputBlockChannels = BlockSize;
+        FilterBlockChannels = BlockSize;
+    }
+
+    const size_t OutputChannelBlocks = OutputChannels / BlockSize;
+    const size_t FilterSetCount = (OutputChannelBlocks + FilterSetSize - 1) / FilterSetSize;
+
+    const size_t InputBlockStride = InputSize * InputBlockChannels;
+    const size_t InputRowStride = InputWidth * InputBlockChannels;
+    const size_t InputStride = DilationHeight * InputRowStride;
+    const size_t FilterInputBlockStride = KernelSize * FilterBlockChannels * BlockSize;
+    const size_t FilterBlockStride = InputBlockCount * FilterInputBlockStride;
+    const size_t FilterRowStride = KernelWidth * FilterBlockChannels * BlockSize;
+    const size_t OutputStride = OutputSize * BlockSize;
+
+    //
+    // A pointwise convolution reads a single input row for each input channel
+    // block and the filters of the input channel blocks are contiguous, so
+    // the kernel rows of a single call can step through the input channel
+    // blocks instead. This keeps the accumulators in registers for the whole
+    // output row.
+    //
+
+    const bool BatchInputBlocks = (KernelSize == 1);
+    const size_t KernelCallCount = BatchInputBlocks ? 1 : InputBlockCount;
+
+    //
+    // Compute the range of output rows for this thread.
+    //
+
+    const size_t TotalWork = WorkBlock->BatchCount * FilterSetCount * OutputHeight;
+
+    size_t WorkIndex;
+    size_t WorkRemaining;
+
+    MlasNchwcPartitionWork(Index, WorkBlock->TargetThreadCount, TotalWork, &WorkIndex, &WorkRemaining);
+
+    size_t oh = WorkIndex % OutputHeight;
+    size_t FilterSet = (WorkIndex / OutputHeight) % FilterSetCount;
+    size_t BatchIndex = WorkIndex / OutputHeight / FilterSetCount;
+
+    while (WorkRemaining > 0) {
+
+        const size_t FilterBlock = FilterSet * FilterSetSize;
+        const size_t FilterCount = std::min(FilterSetSize, OutputChannelBlocks - FilterBlock);
+
+        const float* input = WorkBlock->Input + BatchIndex * InputChannels * InputSize;
+
+        if (WorkBlock->GroupCount > 1) {
+            input += FilterBlock * InputBlockStride;
+        }
+
+        const float* filter = WorkBlock->Filter + FilterBlock * FilterBlockStride;
+        const float* bias = (WorkBlock->Bias != nullptr) ? WorkBlock->Bias + FilterBlock * BlockSize : nullptr;
+        float* output = WorkBlock->Output + BatchIndex * OutputChannels * OutputSize +
+            FilterBlock * OutputStride + oh * OutputWidth * BlockSize;
+
+        size_t ih;
+        size_t khStart;
+        size_t khCount;
+
+        MlasNchwcGetKernelHeightRange(WorkBlock, oh, &ih, &khStart, &khCount);
+
+        input += ih * InputRowStride;
+        filter += khStart * FilterRowStride;
+
+        //
+        // Accumulate the output row over each input channel block. The bias
+        // and activation are applied with the last input channel block.
+        //
+
+        size_t KernelRows = khCount;
+        size_t KernelInputStride = InputStride;
+
+        if (BatchInputBlocks) {
+            KernelRows = khCount * InputBlockCount;
+            KernelInputStride = InputBlockStride;
+        }
+
+        for (size_t icb = 0; icb < KernelCallCount; icb++) {
+
+            unsigned Flags = 0;
+
+            if (icb > 0 || !WorkBlock->ZeroMode) {
+                Flags |= MLAS_CONV_KERNEL_FLAG_ACCUMULATE_OUTPUT;
+            }
+
+            if (icb + 1 == KernelCallCount) {
+
+                if (bias != nullptr) {
+                    Flags |= MLAS_CONV_KERNEL_FLAG_BIAS_ADDITION;
+                }
+
+                if (ActivationKind == MlasReluActivation) {
+                    Flags |= MLAS_CONV_KERNEL_FLAG_RELU_ACTIVATION;
+                }
+            }
+
+            Kernel(input + icb * InputBlockStride, filter + icb * FilterInputBlockStride,
+                output, WorkBlock->StrideShape[1], WorkBlock->DilationShape[1],
+                FilterCount, KernelInputStride, FilterBlockStride, OutputStride, KernelRows,
+                KernelWidth, InputWidth, WorkBlock->Padding[1], OutputWidth, bias, Flags);
+        }
+
+        if (ActivationKind != MlasIdentityActivation && ActivationKind != MlasReluActivation) {
+            for (size_t f = 0; f < FilterCount; f++) {
+                float* ActivationOutput = output + f * OutputStride;
+                MlasActivation(WorkBlock->Activation, ActivationOutput, nullptr, 1,
+                    ActivationOutput, OutputWidth * BlockSize, OutputWidth * BlockSize);
+            }
+        }
+
+        //
+        // Advance to the next output row.
+        //
+
+        if (++oh == OutputHeight) {
+
+            oh = 0;
+
+            if (++FilterSet == FilterSetCount) {
+                FilterSet = 0;
+                BatchIndex++;
+            }
+        }
+
+        WorkRemaining--;
+    }
+}
+
+void
+MLASCALL
+MlasNchwcConv(
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    size_t GroupCount,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    const MLAS_ACTIVATION* Activation,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the NCHWc convolution operation.
+
+Arguments:
+
+    Dimensions - Supplies the number of dimensions, which must be 2.
+
+    InputShape - Supplies the shape of the input tensor. The input is in NCHW
+        order if it has fewer channels than the block size, otherwise the
+        input is in NCHWc order.
+
+    KernelShape - Supplies the shape of the kernel.
+
+    DilationShape - Supplies the dilation of the kernel.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        image.
+
+    StrideShape - Supplies the stride of the kernel.
+
+    OutputShape - Supplies the shape of the output tensor. The number of
+        output channels must be a multiple of the block size.
+
+    GroupCount - Supplies the number of channel groups. The only supported
+        grouped convolution is a depthwise convolution, where each group has
+        one input and one output channel.
+
+    Input - Supplies the input tensor.
+
+    Filter - Supplies the reordered filter tensor.
+
+    Bias - Optionally supplies the bias vector, padded to the number of
+        output channels.
+
+    Output - Supplies the output tensor in NCHWc order.
+
+    Activation - Supplies the parameters for the activation to apply to the
+        output.
+
+    ZeroMode - Supplies true if the output tensor should be overwritten, else
+        false if the convolution is accumulated into the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_UNREFERENCED_PARAMETER(Dimensions);
+
+    MLAS_NCHWC_CONV_WORK_BLOCK WorkBlock;
+
+    MlasNchwcPrepareWorkBlock(&WorkBlock, InputShape, KernelShape,
+        DilationShape, Padding, StrideShape, OutputShape);
+
+    WorkBlock.Input = Input;
+    WorkBlock.Filter = Filter;
+    WorkBlock.Bias = Bias;
+    WorkBlock.Activation = Activation;
+    WorkBlock.Output = Output;
+    WorkBlock.GroupCount = GroupCount;
+    WorkBlock.ZeroMode = ZeroMode;
+
+    //
+    // Compute the number of threads to use for the operation.
+    //
+
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    size_t FilterSetCount;
+    size_t InputChannelsPerOutput;
+
+    if (GroupCount > 1) {
+        FilterSetCount = WorkBlock.OutputChannels / BlockSize;
+        InputChannelsPerOutput = 1;
+    } else {
+        const size_t OutputChannelBlocks = WorkBlock.OutputChannels / BlockSize;
+        FilterSetCount = (OutputChannelBlocks + MLAS_NCHWC_MAXIMUM_FILTER_COUNT - 1) /
+            MLAS_NCHWC_MAXIMUM_FILTER_COUNT;
+        InputChannelsPerOutput = WorkBlock.InputChannels;
+    }
+
+    const size_t TotalWork = WorkBlock.BatchCount * FilterSetCount * WorkBlock.OutputShape[0];
+
+    const double Complexity = double(WorkBlock.BatchCount) * double(WorkBlock.OutputChannels) *
+        double(WorkBlock.OutputSize) * double(InputChannelsPerOutput) *
+        double(WorkBlock.KernelShape[0] * WorkBlock.KernelShape[1]);
+
+    WorkBlock.TargetThreadCount = MlasNchwcGetTargetThreadCount(Complexity, TotalWork);
+
+    if (WorkBlock.TargetThreadCount == 0) {
+        return;
+    }
+
+    MlasExecuteThreaded(MlasNchwcConvThreaded, &WorkBlock, WorkBlock.TargetThreadCount);
+}
+
+void
+MlasNchwcPoolThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of an
+    NCHWc pooling operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_NCHWC_POOL_WORK_BLOCK* WorkBlock = (const MLAS_NCHWC_POOL_WORK_BLOCK*)Context;
+
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t InputWidth = WorkBlock->InputShape[1];
+    const size_t InputSize = WorkBlock->InputSize;
+    const size_t OutputHeight = WorkBlock->OutputShape[0];
+    const size_t OutputWidth = WorkBlock->OutputShape[1];
+    const size_t OutputSize = WorkBlock->OutputSize;
+    const size_t KernelWidth = WorkBlock->KernelShape[1];
+    const size_t KernelSize = WorkBlock->KernelShape[0] * KernelWidth;
+
+    const size_t InputRowStride = InputWidth * BlockSize;
+
+    PMLAS_POOL_FLOAT_KERNEL Kernel = MlasPlatform.PoolFloatKernel[WorkBlock->PoolingKind];
+
+    //
+    // Compute the range of output rows for this thread. The channel blocks
+    // of each batch are contiguous, so the rows are numbered across both.
+    //
+
+    const size_t TotalWork = WorkBlock->BatchCount * (WorkBlock->InputChannels / BlockSize) * OutputHeight;
+
+    size_t WorkIndex;
+    size_t WorkRemaining;
+
+    MlasNchwcPartitionWork(Index, WorkBlock->TargetThreadCount, TotalWork, &WorkIndex, &WorkRemaining);
+
+    size_t oh = WorkIndex % OutputHeight;
+    size_t ChannelBlockIndex = WorkIndex / OutputHeight;
+
+    while (WorkRemaining > 0) {
+
+        size_t ih;
+        size_t khStart;
+        size_t khCount;
+
+        MlasNchwcGetKernelHeightRange(WorkBlock, oh, &ih, &khStart, &khCount);
+
+        const float* input = WorkBlock->Input + ChannelBlockIndex * InputSize * BlockSize + ih * InputRowStride;
+        float* output = WorkBlock->Output + ChannelBlockIndex * OutputSize * BlockSize + oh * OutputWidth * BlockSize;
+
+        Kernel(input, output, WorkBlock->StrideShape[1], khCount, KernelWidth,
+            InputRowStride, InputWidth, WorkBlock->Padding[1], OutputWidth, KernelSize);
+
+        if (++oh == OutputHeight) {
+            oh = 0;
+            ChannelBlockIndex++;
+        }
+
+        WorkRemaining--;
+    }
+}
+
+void
+MLASCALL
+MlasNchwcPool(
+    MLAS_POOLING_KIND PoolingKind,
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the NCHWc pooling operation.
+
+Arguments:
+
+    PoolingKind - Supplies the kind of pooling operation to perform.
+
+    Dimensions - Supplies the number of dimensions, which must be 2.
+
+    InputShape - Supplies the shape of the input tensor in NCHWc order. The
+        number of channels must be a multiple of the block size.
+
+    KernelShape - Supplies the shape of the kernel. If nullptr, then a global
+        pooling operation is performed.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        image.
+
+    StrideShape - Supplies the stride of the kernel.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    Input - Supplies the input tensor.
+
+    Output - Supplies the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_UNREFERENCED_PARAMETER(Dimensions);
+
+    MLAS_NCHWC_POOL_WORK_BLOCK WorkBlock;
+
+    MlasNchwcPrepareWorkBlock(&WorkBlock, InputShape, KernelShape, nullptr,
+        Padding, StrideShape, OutputShape);
+
+    WorkBlock.PoolingKind = PoolingKind;
+    WorkBlock.Input = Input;
+    WorkBlock.Output = Output;
+
+    const size_t TotalWork = WorkBlock.BatchCount * (WorkBlock.InputChannels / MlasPlatform.NchwcBlockSize) *
+        WorkBlock.OutputShape[0];
+
+    const double Complexity = double(WorkBlock.BatchCount) * double(WorkBlock.InputChannels) *
+        double(WorkBlock.OutputSize) * double(WorkBlock.KernelShape[0] * WorkBlock.KernelShape[1]);
+
+    WorkBlock.TargetThreadCount = MlasNchwcGetTargetThreadCount(Complexity, TotalWork);
+
+    if (WorkBlock.TargetThreadCount == 0) {
+        return;
+    }
+
+    MlasExecuteThreaded(MlasNchwcPoolThreaded, &WorkBlock, WorkBlock.TargetThreadCount);
+}
+
+void
+MLASCALL
+MlasReorderInput(
+    const int64_t* InputShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders an input tensor from NCHW to NCHWc order. The
+    channels past the end of the source tensor are filled with zeroes.
+
+Arguments:
+
+    InputShape - Supplies the NCHW shape of the source tensor.
+
+    S - Supplies the source tensor.
+
+    D - Supplies the destination tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t BatchCount = size_t(InputShape[0]);
+    const size_t InputChannels = size_t(InputShape[1]);
+    const size_t InputSize = size_t(InputShape[2]) * size_t(InputShape[3]);
+
+    for (size_t n = 0; n < BatchCount; n++) {
+
+        for (size_t c = 0; c < InputChannels; c += BlockSize) {
+
+            const size_t CountC = std::min(InputChannels - c, BlockSize);
+
+            //
+            // A channel block is a transpose of the channel planes.
+            //
+
+            MlasTranspose(CountC, InputSize, reinterpret_cast<const uint32_t*>(S),
+                InputSize, reinterpret_cast<uint32_t*>(D), BlockSize);
+
+            if (CountC < BlockSize) {
+                for (size_t i = 0; i < InputSize; i++) {
+                    std::fill_n(D + i * BlockSize + CountC, BlockSize - CountC, 0.0f);
+                }
+            }
+
+            S += CountC * InputSize;
+            D += BlockSize * InputSize;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasReorderOutput(
+    const int64_t* OutputShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders an output tensor from NCHWc to NCHW order. The
+    channels of the source tensor past the number of destination channels are
+    ignored.
+
+Arguments:
+
+    OutputShape - Supplies the NCHW shape of the destination tensor.
+
+    S - Supplies the source tensor.
+
+    D - Supplies the destination tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t BatchCount = size_t(OutputShape[0]);
+    const size_t OutputChannels = size_t(OutputShape[1]);
+    const size_t OutputSize = size_t(OutputShape[2]) * size_t(OutputShape[3]);
+
+    for (size_t n = 0; n < BatchCount; n++) {
+
+        for (size_t c = 0; c < OutputChannels; c += BlockSize) {
+
+            const size_t CountC = std::min(OutputChannels - c, BlockSize);
+
+            MlasTranspose(OutputSize, CountC, reinterpret_cast<const uint32_t*>(S),
+                BlockSize, reinterpret_cast<uint32_t*>(D), OutputSize);
+
+            S += BlockSize * OutputSize;
+            D += CountC * OutputSize;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasReorderFilterOIHWBiBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders a filter from OIHW to OIHWBiBo order, where the
+    input and output channels are split into blocks and the innermost
+    dimensions are the input channel and then the output channel of a block.
+    The channels are padded with zeroes to a multiple of the block size.
+
+Arguments:
+
+    FilterShape - Supplies the OIHW shape of the source filter.
+
+    S - Supplies the source filter.
+
+    D - Supplies the destination filter.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t OutputChannels = size_t(FilterShape[0]);
+    const size_t InputChannels = size_t(FilterShape[1]);
+    const size_t KernelSize = size_t(FilterShape[2]) * size_t(FilterShape[3]);
+
+    for (size_t o = 0; o < OutputChannels; o += BlockSize) {
+
+        const size_t CountO = std::min(OutputChannels - o, BlockSize);
+
+        for (size_t i = 0; i < InputChannels; i += BlockSize) {
+
+            const size_t CountI = std::min(InputChannels - i, BlockSize);
+
+            for (size_t k = 0; k < KernelSize; k++) {
+
+                for (size_t bi = 0; bi < BlockSize; bi++) {
+
+                    for (size_t bo = 0; bo < BlockSize; bo++) {
+
+                        if (bi < CountI && bo < CountO) {
+                            *D++ = S[((o + bo) * InputChannels + (i + bi)) * KernelSize + k];
+                        } else {
+                            *D++ = 0.0f;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+MLASCALL
+MlasReorderFilterOIHWBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders a filter from OIHW to OIHWBo order, where the output
+    channels are split into blocks and the innermost dimension is the output
+    channel of a block. The output channels are padded with zeroes to a
+    multiple of the block size.
+
+Arguments:
+
+    FilterShape - Supplies the OIHW shape of the source filter.
+
+    S - Supplies the source filter.
+
+    D - Supplies the destination filter.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t OutputChannels = size_t(FilterShape[0]);
+    const size_t InputChannels = size_t(FilterShape[1]);
+    const size_t KernelSize = size_t(FilterShape[2]) * size_t(FilterShape[3]);
+    const size_t InputSize = InputChannels * KernelSize;
+
+    for (size_t o = 0; o < OutputChannels; o += BlockSize) {
+
+        const size_t CountO = std::min(OutputChannels - o, BlockSize);
+
+        for (size_t i = 0; i < InputSize; i++) {
+
+            for (size_t bo = 0; bo < BlockSize; bo++) {
+
+                if (bo < CountO) {
+                    *D++ = S[(o + bo) * InputSize + i];
+                } else {
+                    *D++ = 0.0f;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,752 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    nchwc_kernel.h
+
+Abstract:
+
+    This module implements the kernels for the NCHWc convolution and pooling
+    routines. The kernels are templates over a vector type that holds one
+    block of channels for a single pixel, so that each instruction set
+    extension supplies only its vector operations. The instruction set
+    specific modules include this header and export the kernels.
+
+    Each kernel computes a single output row. The outputs of the row that read
+    the padding columns of the input are computed one at a time over the range
+    of valid kernel columns. The remaining outputs are computed several at a
+    time without bounds checks.
+
+    The vector type supplies:
+
+        VectorType - The type of a vector of BlockSize floats.
+
+        BlockSize - The NCHWc block size.
+
+        ConvOutputCount - The number of adjacent outputs computed together by
+            the convolution kernel, up to 6.
+
+        Zero, Broadcast, Load, Store, MultiplyAdd, Add, Maximum, Divide - The
+            vector operations.
+
+--*/
+
+#pragma once
+
+#include "mlasi.h"
+
+static
+inline
+void
+MlasNchwcGetKernelWidthRange(
+    ptrdiff_t InputColumn,
+    size_t DilationWidth,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t* KernelWidthStart,
+    size_t* KernelWidthCount
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the range of kernel columns that read from inside
+    the input row for an output whose first kernel column may fall in the
+    padding.
+
+Arguments:
+
+    InputColumn - Supplies the input column of the first kernel column, which
+        is negative if the output reads the left padding.
+
+    DilationWidth - Supplies the dilation of the kernel columns.
+
+    KernelWidth - Supplies the number of kernel columns.
+
+    InputWidth - Supplies the number of input columns.
+
+    KernelWidthStart - Receives the first valid kernel column.
+
+    KernelWidthCount - Receives the number of valid kernel columns.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    size_t kwStart = 0;
+
+    if (InputColumn < 0) {
+        kwStart = (size_t(-InputColumn) + DilationWidth - 1) / DilationWidth;
+    }
+
+    size_t kwEnd = 0;
+
+    if (InputColumn < ptrdiff_t(InputWidth)) {
+        kwEnd = (size_t(ptrdiff_t(InputWidth) - InputColumn) + DilationWidth - 1) / DilationWidth;
+    }
+
+    kwEnd = std::min(kwEnd, KernelWidth);
+
+    *KernelWidthStart = kwStart;
+    *KernelWidthCount = (kwEnd > kwStart) ? (kwEnd - kwStart) : 0;
+}
+
+//
+// Macros to emit an operation for each accumulator of a convolution compute
+// block. The accumulators are declared as individual variables so that the
+// compiler keeps them in registers across the kernel loops; the compile time
+// checks of the block dimensions discard the unused accumulators.
+//
+
+#define MlasConvForEachAccumulator(Operation) \
+    Operation(0, 0) Operation(0, 1) Operation(0, 2) Operation(0, 3) Operation(0, 4) Operation(0, 5) \
+    Operation(1, 0) Operation(1, 1) Operation(1, 2) Operation(1, 3) Operation(1, 4) Operation(1, 5) \
+    Operation(2, 0) Operation(2, 1) Operation(2, 2) Operation(2, 3) Operation(2, 4) Operation(2, 5) \
+    Operation(3, 0) Operation(3, 1) Operation(3, 2) Operation(3, 3) Operation(3, 4) Operation(3, 5)
+
+#define MlasConvForEachOutput(Operation) \
+    Operation(0) Operation(1) Operation(2) Operation(3) Operation(4) Operation(5)
+
+#define MlasConvForEachFilter(Operation) \
+    Operation(0) Operation(1) Operation(2) Operation(3)
+
+#define MlasConvDeclareAccumulator(f, o) \
+    typename KernelType::VectorType Accumulator##f##o = KernelType::Zero();
+
+#define MlasConvLoadAccumulator(f, o) \
+    if (FilterCount > f && OutputCount > o && Accumulate) { \
+        Accumulator##f##o = KernelType::Load(Output + f * OutputStride + o * BlockSize); \
+    }
+
+#define MlasConvBroadcastInput(o) \
+    typename KernelType::VectorType InputValue##o = KernelType::Zero(); \
+    if (OutputCount > o) { \
+        InputValue##o = KernelType::Broadcast(input + o * StrideWidth + ic); \
+    }
+
+#define MlasConvLoadFilter(f) \
+    typename KernelType::VectorType FilterValue##f = KernelType::Zero(); \
+    if (FilterCount > f) { \
+        FilterValue##f = KernelType::Load(filter + f * FilterStride + ic * BlockSize); \
+    }
+
+#define MlasConvMultiplyAddAccumulator(f, o) \
+    if (FilterCount > f && OutputCount > o) { \
+        Accumulator##f##o = KernelType::MultiplyAdd(InputValue##o, FilterValue##f, Accumulator##f##o); \
+    }
+
+#define MlasConvLoadBias(f) \
+    typename KernelType::VectorType BiasValue##f = KernelType::Zero(); \
+    if (FilterCount > f && (Flags & MLAS_CONV_KERNEL_FLAG_BIAS_ADDITION) != 0) { \
+        BiasValue##f = KernelType::Load(Bias + f * BlockSize); \
+    }
+
+#define MlasConvStoreAccumulator(f, o) \
+    if (FilterCount > f && OutputCount > o) { \
+        typename KernelType::VectorType Value = KernelType::Add(Accumulator##f##o, BiasValue##f); \
+        if ((Flags & MLAS_CONV_KERNEL_FLAG_RELU_ACTIVATION) != 0) { \
+            Value = KernelType::Maximum(Value, KernelType::Zero()); \
+        } \
+        KernelType::Store(Output + f * OutputStride + o * BlockSize, Value); \
+    }
+
+template<typename KernelType, size_t FilterCount, size_t OutputCount, size_t InputBlockChannels>
+inline
+void
+MlasConvFloatComputeBlock(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t InputStride,
+    size_t FilterStride,
+    size_t FilterRowStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    const float* Bias,
+    unsigned Flags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes a set of adjacent outputs for one or more output
+    channel blocks. Each input channel of a kernel tap is broadcast and
+    multiplied by the filter vector of each output channel block.
+
+Arguments:
+
+    Input - Supplies the address of the first kernel tap of the first output.
+
+    Filter - Supplies the address of the filter for the first kernel tap.
+
+    Output - Supplies the address of the first output.
+
+    StrideWidth - Supplies the number of elements between adjacent outputs in
+        the input row.
+
+    DilationWidth - Supplies the number of elements between adjacent kernel
+        columns in the input row.
+
+    InputStride - Supplies the number of elements between kernel rows in the
+        input.
+
+    FilterStride - Supplies the number of elements between the filters of
+        adjacent output channel blocks.
+
+    FilterRowStride - Supplies the number of elements between kernel rows in
+        the filter.
+
+    OutputStride - Supplies the number of elements between adjacent output
+        channel blocks.
+
+    KernelHeight - Supplies the number of kernel rows to process.
+
+    KernelWidth - Supplies the number of kernel columns to process.
+
+    Bias - Supplies the bias for the output channel blocks.
+
+    Flags - Supplies the MLAS_CONV_KERNEL_FLAG bits.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    static_assert(FilterCount <= MLAS_NCHWC_MAXIMUM_FILTER_COUNT, "unsupported filter count");
+    static_assert(OutputCount <= 6, "unsupported output count");
+
+    constexpr size_t BlockSize = KernelType::BlockSize;
+
+    const bool Accumulate = (Flags & MLAS_CONV_KERNEL_FLAG_ACCUMULATE_OUTPUT) != 0;
+
+    MlasConvForEachAccumulator(MlasConvDeclareAccumulator);
+    MlasConvForEachAccumulator(MlasConvLoadAccumulator);
+
+    for (size_t kh = 0; kh < KernelHeight; kh++) {
+
+        const float* input = Input + kh * InputStride;
+        const float* filter = Filter + kh * FilterRowStride;
+
+        for (size_t kw = 0; kw < KernelWidth; kw++) {
+
+            for (size_t ic = 0; ic < InputBlockChannels; ic++) {
+
+                MlasConvForEachOutput(MlasConvBroadcastInput);
+                MlasConvForEachFilter(MlasConvLoadFilter);
+                MlasConvForEachAccumulator(MlasConvMultiplyAddAccumulator);
+            }
+
+            input += DilationWidth;
+            filter += InputBlockChannels * BlockSize;
+        }
+    }
+
+    MlasConvForEachFilter(MlasConvLoadBias);
+    MlasConvForEachAccumulator(MlasConvStoreAccumulator);
+}
+
+template<typename KernelType, size_t FilterCount, size_t InputBlockChannels>
+void
+MlasConvFloatRow(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t InputStride,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    const float* Bias,
+    unsigned Flags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row for one or more output channel blocks
+    of a direct convolution.
+
+Arguments:
+
+    See MlasConvFloatKernel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t BlockSize = KernelType::BlockSize;
+    constexpr size_t InputBlockOutputCount = KernelType::ConvOutputCount;
+
+    const size_t FilterTapStride = InputBlockChannels * BlockSize;
+    const size_t FilterRowStride = KernelWidth * FilterTapStride;
+    const size_t SpanWidth = (KernelWidth - 1) * DilationWidth + 1;
+
+    size_t ow = 0;
+
+    while (ow < OutputCount) {
+
+        const ptrdiff_t iw = ptrdiff_t(ow * StrideWidth) - ptrdiff_t(PaddingLeftWidth);
+        float* output = Output + ow * BlockSize;
+
+        if (iw >= 0 && size_t(iw) + SpanWidth <= InputWidth) {
+
+            const float* input = Input + size_t(iw) * InputBlockChannels;
+
+            if (ow + InputBlockOutputCount <= OutputCount &&
+                size_t(iw) + (InputBlockOutputCount - 1) * StrideWidth + SpanWidth <= InputWidth) {
+
+                MlasConvFloatComputeBlock<KernelType, FilterCount, InputBlockOutputCount, InputBlockChannels>(
+                    input, Filter, output, StrideWidth * InputBlockChannels,
+                    DilationWidth * InputBlockChannels, InputStride, FilterStride,
+                    FilterRowStride, OutputStride, KernelHeight, KernelWidth, Bias, Flags);
+
+                ow += InputBlockOutputCount;
+
+            } else {
+
+                MlasConvFloatComputeBlock<KernelType, FilterCount, 1, InputBlockChannels>(
+                    input, Filter, output, StrideWidth * InputBlockChannels,
+                    DilationWidth * InputBlockChannels, InputStride, FilterStride,
+                    FilterRowStride, OutputStride, KernelHeight, KernelWidth, Bias, Flags);
+
+                ow += 1;
+            }
+
+        } else {
+
+            size_t kwStart;
+            size_t kwCount;
+
+            MlasNchwcGetKernelWidthRange(iw, DilationWidth, KernelWidth, InputWidth, &kwStart, &kwCount);
+
+            const float* input = Input;
+
+            if (kwCount > 0) {
+                input += size_t(iw + ptrdiff_t(kwStart * DilationWidth)) * InputBlockChannels;
+            }
+
+            MlasConvFloatComputeBlock<KernelType, FilterCount, 1, InputBlockChannels>(
+                input, Filter + kwStart * FilterTapStride, output, StrideWidth * InputBlockChannels,
+                DilationWidth * InputBlockChannels, InputStride, FilterStride,
+                FilterRowStride, OutputStride, KernelHeight, kwCount, Bias, Flags);
+
+            ow += 1;
+        }
+    }
+}
+
+template<typename KernelType, size_t InputBlockChannels>
+void
+MlasConvFloatKernel(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t InputStride,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    const float* Bias,
+    unsigned Flags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row of a convolution for one input
+    channel block. For an NCHWc input tensor, InputBlockChannels is the block
+    size and the filter is in OIHWBiBo order. For an NCHW input tensor,
+    InputBlockChannels is 1 and the filter is in OIHWBo order.
+
+Arguments:
+
+    Input - Supplies the address of the first column of the first kernel row
+        of the input channel block.
+
+    Filter - Supplies the address of the filter for the first kernel row.
+
+    Output - Supplies the address of the output row.
+
+    StrideWidth - Supplies the stride of the kernel columns in pixels.
+
+    DilationWidth - Supplies the dilation of the kernel columns in pixels.
+
+    FilterCount - Supplies the number of output channel blocks to compute, up
+        to MLAS_NCHWC_MAXIMUM_FILTER_COUNT.
+
+    InputStride - Supplies the number of elements between kernel rows in the
+        input.
+
+    FilterStride - Supplies the number of elements between the filters of
+        adjacent output channel blocks.
+
+    OutputStride - Supplies the number of elements between adjacent output
+        channel blocks.
+
+    KernelHeight - Supplies the number of kernel rows that read from inside
+        the input.
+
+    KernelWidth - Supplies the number of kernel columns.
+
+    InputWidth - Supplies the number of input columns.
+
+    PaddingLeftWidth - Supplies the number of padding columns on the left of
+        the input row.
+
+    OutputCount - Supplies the number of output columns.
+
+    Bias - Supplies the bias for the output channel blocks.
+
+    Flags - Supplies the MLAS_CONV_KERNEL_FLAG bits.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    switch (FilterCount) {
+
+        case 1:
+            MlasConvFloatRow<KernelType, 1, InputBlockChannels>(Input, Filter, Output,
+                StrideWidth, DilationWidth, InputStride, FilterStride, OutputStride,
+                KernelHeight, KernelWidth, InputWidth, PaddingLeftWidth, OutputCount,
+                Bias, Flags);
+            break;
+
+        case 2:
+            MlasConvFloatRow<KernelType, 2, InputBlockChannels>(Input, Filter, Output,
+                StrideWidth, DilationWidth, InputStride, FilterStride, OutputStride,
+                KernelHeight, KernelWidth, InputWidth, PaddingLeftWidth, OutputCount,
+                Bias, Flags);
+            break;
+
+        case 3:
+            MlasConvFloatRow<KernelType, 3, InputBlockChannels>(Input, Filter, Output,
+                StrideWidth, DilationWidth, InputStride, FilterStride, OutputStride,
+                KernelHeight, KernelWidth, InputWidth, PaddingLeftWidth, OutputCount,
+                Bias, Flags);
+            break;
+
+        case 4:
+            MlasConvFloatRow<KernelType, 4, InputBlockChannels>(Input, Filter, Output,
+                StrideWidth, DilationWidth, InputStride, FilterStride, OutputStride,
+                KernelHeight, KernelWidth, InputWidth, PaddingLeftWidth, OutputCount,
+                Bias, Flags);
+            break;
+    }
+}
+
+template<typename KernelType, size_t OutputCount>
+inline
+void
+MlasConvDepthwiseFloatComputeBlock(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t InputStride,
+    size_t FilterRowStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    const float* Bias,
+    unsigned Flags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes a set of adjacent outputs for a channel block of a
+    depthwise convolution. Each channel of the block is independent, so each
+    kernel tap is a vector multiply of the input pixel and the filter.
+
+Arguments:
+
+    See MlasConvFloatComputeBlock.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    typedef typename KernelType::VectorType VectorType;
+
+    constexpr size_t BlockSize = KernelType::BlockSize;
+
+    VectorType Accumulators[OutputCount];
+
+    for (size_t o = 0; o < OutputCount; o++) {
+        if ((Flags & MLAS_CONV_KERNEL_FLAG_ACCUMULATE_OUTPUT) != 0) {
+            Accumulators[o] = KernelType::Load(Output + o * BlockSize);
+        } else {
+            Accumulators[o] = KernelType::Zero();
+        }
+    }
+
+    for (size_t kh = 0; kh < KernelHeight; kh++) {
+
+        const float* input = Input + kh * InputStride;
+        const float* filter = Filter + kh * FilterRowStride;
+
+        for (size_t kw = 0; kw < KernelWidth; kw++) {
+
+            VectorType FilterValue = KernelType::Load(filter);
+
+            for (size_t o = 0; o < OutputCount; o++) {
+                Accumulators[o] = KernelType::MultiplyAdd(KernelType::Load(input + o * StrideWidth), FilterValue, Accumulators[o]);
+            }
+
+            input += DilationWidth;
+            filter += BlockSize;
+        }
+    }
+
+    VectorType BiasValue = KernelType::Zero();
+
+    if ((Flags & MLAS_CONV_KERNEL_FLAG_BIAS_ADDITION) != 0) {
+        BiasValue = KernelType::Load(Bias);
+    }
+
+    for (size_t o = 0; o < OutputCount; o++) {
+
+        VectorType Value = KernelType::Add(Accumulators[o], BiasValue);
+
+        if ((Flags & MLAS_CONV_KERNEL_FLAG_RELU_ACTIVATION) != 0) {
+            Value = KernelType::Maximum(Value, KernelType::Zero());
+        }
+
+        KernelType::Store(Output + o * BlockSize, Value);
+    }
+}
+
+template<typename KernelType>
+void
+MlasConvDepthwiseFloatKernel(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t InputStride,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    const float* Bias,
+    unsigned Flags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row of a depthwise convolution for one
+    channel block of an NCHWc input tensor. The filter is in OIHWBo order.
+
+Arguments:
+
+    See MlasConvFloatKernel. FilterCount must be 1 and FilterStride and
+    OutputStride are not used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_UNREFERENCED_PARAMETER(FilterCount);
+    MLAS_UNREFERENCED_PARAMETER(FilterStride);
+    MLAS_UNREFERENCED_PARAMETER(OutputStride);
+
+    constexpr size_t BlockSize = KernelType::BlockSize;
+    constexpr size_t InputBlockOutputCount = 4;
+
+    const size_t FilterRowStride = KernelWidth * BlockSize;
+    const size_t SpanWidth = (KernelWidth - 1) * DilationWidth + 1;
+
+    size_t ow = 0;
+
+    while (ow < OutputCount) {
+
+        const ptrdiff_t iw = ptrdiff_t(ow * StrideWidth) - ptrdiff_t(PaddingLeftWidth);
+        float* output = Output + ow * BlockSize;
+
+        if (iw >= 0 && size_t(iw) + SpanWidth <= InputWidth) {
+
+            const float* input = Input + size_t(iw) * BlockSize;
+
+            if (ow + InputBlockOutputCount <= OutputCount &&
+                size_t(iw) + (InputBlockOutputCount - 1) * StrideWidth + SpanWidth <= InputWidth) {
+
+                MlasConvDepthwiseFloatComputeBlock<KernelType, InputBlockOutputCount>(input,
+                    Filter, output, StrideWidth * BlockSize, DilationWidth * BlockSize,
+                    InputStride, FilterRowStride, KernelHeight, KernelWidth, Bias, Flags);
+
+                ow += InputBlockOutputCount;
+
+            } else {
+
+                MlasConvDepthwiseFloatComputeBlock<KernelType, 1>(input, Filter, output,
+                    StrideWidth * BlockSize, DilationWidth * BlockSize, InputStride,
+                    FilterRowStride, KernelHeight, KernelWidth, Bias, Flags);
+
+                ow += 1;
+            }
+
+        } else {
+
+            size_t kwStart;
+            size_t kwCount;
+
+            MlasNchwcGetKernelWidthRange(iw, DilationWidth, KernelWidth, InputWidth, &kwStart, &kwCount);
+
+            const float* input = Input;
+
+            if (kwCount > 0) {
+                input += size_t(iw + ptrdiff_t(kwStart * DilationWidth)) * BlockSize;
+            }
+
+            MlasConvDepthwiseFloatComputeBlock<KernelType, 1>(input,
+                Filter + kwStart * BlockSize, output, StrideWidth * BlockSize,
+                DilationWidth * BlockSize, InputStride, FilterRowStride,
+                KernelHeight, kwCount, Bias, Flags);
+
+            ow += 1;
+        }
+    }
+}
+
+template<typename KernelType, MLAS_POOLING_KIND PoolingKind>
+void
+MlasPoolFloatKernel(
+    const float* Input,
+    float* Output,
+    size_t StrideWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputStride,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    size_t ActualKernelSize
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row of a pooling operation for one
+    channel block of an NCHWc input tensor.
+
+Arguments:
+
+    Input - Supplies the address of the first column of the first kernel row
+        of the input channel block.
+
+    Output - Supplies the address of the output row.
+
+    StrideWidth - Supplies the stride of the kernel columns in pixels.
+
+    KernelHeight - Supplies the number of kernel rows that read from inside
+        the input.
+
+    KernelWidth - Supplies the number of kernel columns.
+
+    InputStride - Supplies the number of elements between input rows.
+
+    InputWidth - Supplies the number of input columns.
+
+    PaddingLeftWidth - Supplies the number of padding columns on the left of
+        the input row.
+
+    OutputCount - Supplies the number of output columns.
+
+    ActualKernelSize - Supplies the number of kernel elements including the
+        padding, which is the divisor for MlasAveragePoolingIncludePad.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    typedef typename KernelType::VectorType VectorType;
+
+    constexpr size_t BlockSize = KernelType::BlockSize;
+
+    const VectorType ActualKernelSizeBroadcast = KernelType::Broadcast(float(unsigned(ActualKernelSize)));
+
+    for (size_t ow = 0; ow < OutputCount; ow++) {
+
+        const ptrdiff_t iw = ptrdiff_t(ow * StrideWidth) - ptrdiff_t(PaddingLeftWidth);
+
+        size_t kwStart;
+        size_t kwCount;
+
+        MlasNchwcGetKernelWidthRange(iw, 1, KernelWidth, InputWidth, &kwStart, &kwCount);
+
+        VectorType Reduction;
+
+        if (PoolingKind == MlasMaximumPooling) {
+            Reduction = KernelType::Broadcast(std::numeric_limits<float>::lowest());
+        } else {
+            Reduction = KernelType::Zero();
+        }
+
+        if (kwCount > 0) {
+
+            const float* input = Input + size_t(iw + ptrdiff_t(kwStart)) * BlockSize;
+
+            for (size_t kh = 0; kh < KernelHeight; kh++) {
+
+                for (size_t kw = 0; kw < kwCount; kw++) {
+
+                    VectorType InputValue = KernelType::Load(input + kw * BlockSize);
+
+                    if (PoolingKind == MlasMaximumPooling) {
+                        Reduction = KernelType::Maximum(Reduction, InputValue);
+                    } else {
+                        Reduction = KernelType::Add(Reduction, InputValue);
+                    }
+                }
+
+                input += InputStride;
+            }
+        }
+
+        if (PoolingKind == MlasAveragePoolingExcludePad) {
+            Reduction = KernelType::Divide(Reduction, KernelType::Broadcast(float(unsigned(KernelHeight * kwCount))));
+        } else if (PoolingKind == MlasAveragePoolingIncludePad) {
+            Reduction = KernelType::Divide(Reduction, ActualKernelSizeBroadcast);
+        }
+
+        KernelType::Store(Output + ow * BlockSize, Reduction);
+    }
+}
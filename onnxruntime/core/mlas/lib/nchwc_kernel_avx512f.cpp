@@ -0,0 +1,240 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    nchwc_kernel_avx512f.cpp
+
+Abstract:
+
+    This module implements the kernels for the NCHWc convolution and pooling
+    routines using AVX512F instructions. The NCHWc block size is 16, so a
+    block of channels for a single pixel fills one 512-bit vector.
+
+--*/
+
+#include "nchwc_kernel.h"
+
+//
+// Vector operations for the NCHWc kernels. The convolution kernel computes 4
+// filter blocks for 6 outputs, which uses 24 of the 32 vector registers for
+// the accumulators.
+//
+
+struct MLAS_NCHWC_KERNEL_AVX512F
+{
+    typedef __m512 VectorType;
+
+    static constexpr size_t BlockSize = 16;
+    static constexpr size_t ConvOutputCount = 6;
+
+    static VectorType Zero(void) { return _mm512_setzero_ps(); }
+    static VectorType Broadcast(const float* Value) { return _mm512_set1_ps(*Value); }
+    static VectorType Broadcast(float Value) { return _mm512_set1_ps(Value); }
+    static VectorType Load(const float* Buffer) { return _mm512_loadu_ps(Buffer); }
+    static void Store(float* Buffer, VectorType Vector) { _mm512_storeu_ps(Buffer, Vector); }
+    static VectorType MultiplyAdd(VectorType A, VectorType B, VectorType C) { return _mm512_fmadd_ps(A, B, C); }
+    static VectorType Add(VectorType A, VectorType B) { return _mm512_add_ps(A, B); }
+
+    //
+    // The zero masked form avoids a spurious uninitialized variable warning
+    // from the undefined source operand of the unmasked form in some versions
+    // of the GCC intrinsic headers.
+    //
+
+    static VectorType Maximum(VectorType A, VectorType B) { return _mm512_maskz_max_ps(__mmask16(0xFFFF), A, B); }
+
+    static VectorType Divide(VectorType A, VectorType B) { return _mm512_div_ps(A, B); }
+};
+
+void
+MLASCALL
+MlasConvNchwcFloatKernelAvx512F(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t InputStride,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    const float* Bias,
+    unsigned Flags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row of a convolution for one input
+    channel block of an NCHWc input tensor. The filter is in OIHWBiBo order.
+
+Arguments:
+
+    See MlasConvFloatKernel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasConvFloatKernel<MLAS_NCHWC_KERNEL_AVX512F, MLAS_NCHWC_KERNEL_AVX512F::BlockSize>(
+        Input, Filter, Output, StrideWidth, DilationWidth, FilterCount,
+        InputStride, FilterStride, OutputStride, KernelHeight, KernelWidth,
+        InputWidth, PaddingLeftWidth, OutputCount, Bias, Flags);
+}
+
+void
+MLASCALL
+MlasConvNchwFloatKernelAvx512F(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t InputStride,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    const float* Bias,
+    unsigned Flags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row of a convolution for one input
+    channel of an NCHW input tensor. The filter is in OIHWBo order.
+
+Arguments:
+
+    See MlasConvFloatKernel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasConvFloatKernel<MLAS_NCHWC_KERNEL_AVX512F, 1>(Input, Filter, Output,
+        StrideWidth, DilationWidth, FilterCount, InputStride, FilterStride,
+        OutputStride, KernelHeight, KernelWidth, InputWidth, PaddingLeftWidth,
+        OutputCount, Bias, Flags);
+}
+
+void
+MLASCALL
+MlasConvDepthwiseFloatKernelAvx512F(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t InputStride,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    const float* Bias,
+    unsigned Flags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row of a depthwise convolution for one
+    channel block of an NCHWc input tensor. The filter is in OIHWBo order.
+
+Arguments:
+
+    See MlasConvDepthwiseFloatKernel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasConvDepthwiseFloatKernel<MLAS_NCHWC_KERNEL_AVX512F>(Input, Filter, Output,
+        StrideWidth, DilationWidth, FilterCount, InputStride, FilterStride,
+        OutputStride, KernelHeight, KernelWidth, InputWidth, PaddingLeftWidth,
+        OutputCount, Bias, Flags);
+}
+
+void
+MLASCALL
+MlasPoolMaximumFloatKernelAvx512F(
+    const float* Input,
+    float* Output,
+    size_t StrideWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputStride,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    size_t ActualKernelSize
+    )
+{
+    MlasPoolFloatKernel<MLAS_NCHWC_KERNEL_AVX512F, MlasMaximumPooling>(Input,
+        Output, StrideWidth, KernelHeight, KernelWidth, InputStride, InputWidth,
+        PaddingLeftWidth, OutputCount, ActualKernelSize);
+}
+
+void
+MLASCALL
+MlasPoolAverageExcludePadFloatKernelAvx512F(
+    const float* Input,
+    float* Output,
+    size_t StrideWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputStride,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    size_t ActualKernelSize
+    )
+{
+    MlasPoolFloatKernel<MLAS_NCHWC_KERNEL_AVX512F, MlasAveragePoolingExcludePad>(Input,
+        Output, StrideWidth, KernelHeight, KernelWidth, InputStride, InputWidth,
+        PaddingLeftWidth, OutputCount, ActualKernelSize);
+}
+
+void
+MLASCALL
+MlasPoolAverageIncludePadFloatKernelAvx512F(
+    const float* Input,
+    float* Output,
+    size_t StrideWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputStride,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    size_t ActualKernelSize
+    )
+{
+    MlasPoolFloatKernel<MLAS_NCHWC_KERNEL_AVX512F, MlasAveragePoolingIncludePad>(Input,
+        Output, StrideWidth, KernelHeight, KernelWidth, InputStride, InputWidth,
+        PaddingLeftWidth, OutputCount, ActualKernelSize);
+}
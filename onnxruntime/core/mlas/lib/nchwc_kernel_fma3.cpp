@@ -0,0 +1,232 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    nchwc_kernel_fma3.cpp
+
+Abstract:
+
+    This module implements the kernels for the NCHWc convolution and pooling
+    routines using AVX and FMA3 instructions. The NCHWc block size is 8, so a
+    block of channels for a single pixel fills one 256-bit vector.
+
+--*/
+
+#include "nchwc_kernel.h"
+
+//
+// Vector operations for the NCHWc kernels. The convolution kernel computes 4
+// filter blocks for 3 outputs, which uses 12 of the 16 vector registers for
+// the accumulators.
+//
+
+struct MLAS_NCHWC_KERNEL_FMA3
+{
+    typedef __m256 VectorType;
+
+    static constexpr size_t BlockSize = 8;
+    static constexpr size_t ConvOutputCount = 3;
+
+    static VectorType Zero(void) { return _mm256_setzero_ps(); }
+    static VectorType Broadcast(const float* Value) { return _mm256_broadcast_ss(Value); }
+    static VectorType Broadcast(float Value) { return _mm256_set1_ps(Value); }
+    static VectorType Load(const float* Buffer) { return _mm256_loadu_ps(Buffer); }
+    static void Store(float* Buffer, VectorType Vector) { _mm256_storeu_ps(Buffer, Vector); }
+    static VectorType MultiplyAdd(VectorType A, VectorType B, VectorType C) { return _mm256_fmadd_ps(A, B, C); }
+    static VectorType Add(VectorType A, VectorType B) { return _mm256_add_ps(A, B); }
+    static VectorType Maximum(VectorType A, VectorType B) { return _mm256_max_ps(A, B); }
+    static VectorType Divide(VectorType A, VectorType B) { return _mm256_div_ps(A, B); }
+};
+
+void
+MLASCALL
+MlasConvNchwcFloatKernelFma3(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t InputStride,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    const float* Bias,
+    unsigned Flags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row of a convolution for one input
+    channel block of an NCHWc input tensor. The filter is in OIHWBiBo order.
+
+Arguments:
+
+    See MlasConvFloatKernel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasConvFloatKernel<MLAS_NCHWC_KERNEL_FMA3, MLAS_NCHWC_KERNEL_FMA3::BlockSize>(
+        Input, Filter, Output, StrideWidth, DilationWidth, FilterCount,
+        InputStride, FilterStride, OutputStride, KernelHeight, KernelWidth,
+        InputWidth, PaddingLeftWidth, OutputCount, Bias, Flags);
+}
+
+void
+MLASCALL
+MlasConvNchwFloatKernelFma3(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t InputStride,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    const float* Bias,
+    unsigned Flags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row of a convolution for one input
+    channel of an NCHW input tensor. The filter is in OIHWBo order.
+
+Arguments:
+
+    See MlasConvFloatKernel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasConvFloatKernel<MLAS_NCHWC_KERNEL_FMA3, 1>(Input, Filter, Output,
+        StrideWidth, DilationWidth, FilterCount, InputStride, FilterStride,
+        OutputStride, KernelHeight, KernelWidth, InputWidth, PaddingLeftWidth,
+        OutputCount, Bias, Flags);
+}
+
+void
+MLASCALL
+MlasConvDepthwiseFloatKernelFma3(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t InputStride,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    const float* Bias,
+    unsigned Flags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row of a depthwise convolution for one
+    channel block of an NCHWc input tensor. The filter is in OIHWBo order.
+
+Arguments:
+
+    See MlasConvDepthwiseFloatKernel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasConvDepthwiseFloatKernel<MLAS_NCHWC_KERNEL_FMA3>(Input, Filter, Output,
+        StrideWidth, DilationWidth, FilterCount, InputStride, FilterStride,
+        OutputStride, KernelHeight, KernelWidth, InputWidth, PaddingLeftWidth,
+        OutputCount, Bias, Flags);
+}
+
+void
+MLASCALL
+MlasPoolMaximumFloatKernelFma3(
+    const float* Input,
+    float* Output,
+    size_t StrideWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputStride,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    size_t ActualKernelSize
+    )
+{
+    MlasPoolFloatKernel<MLAS_NCHWC_KERNEL_FMA3, MlasMaximumPooling>(Input,
+        Output, StrideWidth, KernelHeight, KernelWidth, InputStride, InputWidth,
+        PaddingLeftWidth, OutputCount, ActualKernelSize);
+}
+
+void
+MLASCALL
+MlasPoolAverageExcludePadFloatKernelFma3(
+    const float* Input,
+    float* Output,
+    size_t StrideWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputStride,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    size_t ActualKernelSize
+    )
+{
+    MlasPoolFloatKernel<MLAS_NCHWC_KERNEL_FMA3, MlasAveragePoolingExcludePad>(Input,
+        Output, StrideWidth, KernelHeight, KernelWidth, InputStride, InputWidth,
+        PaddingLeftWidth, OutputCount, ActualKernelSize);
+}
+
+void
+MLASCALL
+MlasPoolAverageIncludePadFloatKernelFma3(
+    const float* Input,
+    float* Output,
+    size_t StrideWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputStride,
+    size_t InputWidth,
+    size_t PaddingLeftWidth,
+    size_t OutputCount,
+    size_t ActualKernelSize
+    )
+{
+    MlasPoolFloatKernel<MLAS_NCHWC_KERNEL_FMA3, MlasAveragePoolingIncludePad>(Input,
+        Output, StrideWidth, KernelHeight, KernelWidth, InputStride, InputWidth,
+        PaddingLeftWidth, OutputCount, ActualKernelSize);
+}
@@ -78,6 +78,20 @@ Return Value:
 --*/
 {
 
+    //
+    // The NCHWc routines are only supported with the AVX2/FMA3 or AVX512F
+    // kernels.
+    //
+
+    this->NchwcBlockSize = 1;
+    this->ConvNchwcFloatKernel = nullptr;
+    this->ConvNchwFloatKernel = nullptr;
+    this->ConvDepthwiseFloatKernel = nullptr;
+
+    for (size_t i = 0; i < MlasPoolingKindCount; i++) {
+        this->PoolFloatKernel[i] = nullptr;
+    }
+
 #if defined(MLAS_TARGET_AMD64_IX86)
 
     //
@@ -90,6 +104,10 @@ Return Value:
     this->TransposePackB16x4Routine = MlasSgemmTransposePackB16x4Sse;
     this->LogisticKernelRoutine = MlasLogisticKernel;
     this->TanhKernelRoutine = MlasTanhKernel;
+    this->QgemmKernelRoutine = MlasQgemmKernel;
+    this->ReduceMaximumF32KernelRoutine = MlasReduceMaximumF32Kernel;
+    this->ComputeSumExpF32KernelRoutine = MlasComputeSumExpF32Kernel;
+    this->ConvDepthwiseKernelRoutine = MlasConvDepthwiseKernel;
 #endif
 
     //
@@ -134,9 +152,42 @@ Return Value:
 
             if (((Cpuid1[2] & 0x1000) != 0) && ((Cpuid7[1] & 0x20) != 0)) {
 
+                this->QgemmKernelRoutine = MlasQgemmKernelAvx2;
+
+                this->NchwcBlockSize = 8;
+                this->ConvNchwcFloatKernel = MlasConvNchwcFloatKernelFma3;
+                this->ConvNchwFloatKernel = MlasConvNchwFloatKernelFma3;
+                this->ConvDepthwiseFloatKernel = MlasConvDepthwiseFloatKernelFma3;
+                this->PoolFloatKernel[MlasMaximumPooling] = MlasPoolMaximumFloatKernelFma3;
+                this->PoolFloatKernel[MlasAveragePoolingExcludePad] = MlasPoolAverageExcludePadFloatKernelFma3;
+                this->PoolFloatKernel[MlasAveragePoolingIncludePad] = MlasPoolAverageIncludePadFloatKernelFma3;
+
                 if (((Cpuid7[1] & 0x10000) != 0) && ((xcr0 & 0xE0) == 0xE0)) {
                     this->KernelZeroRoutine = MlasSgemmKernelZeroAvx512F;
                     this->KernelAddRoutine = MlasSgemmKernelAddAvx512F;
+
+                    this->NchwcBlockSize = 16;
+                    this->ConvNchwcFloatKernel = MlasConvNchwcFloatKernelAvx512F;
+                    this->ConvNchwFloatKernel = MlasConvNchwFloatKernelAvx512F;
+                    this->ConvDepthwiseFloatKernel = MlasConvDepthwiseFloatKernelAvx512F;
+                    this->PoolFloatKernel[MlasMaximumPooling] = MlasPoolMaximumFloatKernelAvx512F;
+                    this->PoolFloatKernel[MlasAveragePoolingExcludePad] = MlasPoolAverageExcludePadFloatKernelAvx512F;
+                    this->PoolFloatKernel[MlasAveragePoolingIncludePad] = MlasPoolAverageIncludePadFloatKernelAvx512F;
+
+                    //
+                    // Check if the processor supports AVX512BW and the
+                    // AVX512_VNNI dot product instructions.
+                    //
+
+                    if ((Cpuid7[1] & 0x40000000) != 0) {
+
+                        if ((Cpuid7[2] & 0x800) != 0) {
+                            this->QgemmKernelRoutine = MlasQgemmKernelAvx512Vnni;
+                        } else {
+                            this->QgemmKernelRoutine = MlasQgemmKernelAvx512BW;
+                        }
+                    }
+
                 } else {
                     this->KernelZeroRoutine = MlasSgemmKernelZeroFma3;
                     this->KernelAddRoutine = MlasSgemmKernelAddFma3;
@@ -144,6 +195,9 @@ Return Value:
 
                 this->LogisticKernelRoutine = MlasLogisticKernelFma3;
                 this->TanhKernelRoutine = MlasTanhKernelFma3;
+                this->ReduceMaximumF32KernelRoutine = MlasReduceMaximumF32KernelFma3;
+                this->ComputeSumExpF32KernelRoutine = MlasComputeSumExpF32KernelFma3;
+                this->ConvDepthwiseKernelRoutine = MlasConvDepthwiseKernelFma3;
 
             } else {
 
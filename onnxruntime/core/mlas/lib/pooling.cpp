@@ -16,6 +16,25 @@ Abstract:
 
 #include "mlasi.h"
 
+#include <cmath>
+
+//
+// Define the prototype of the pooling kernel routine.
+//
+
+struct MLAS_WORK_BLOCK;
+
+typedef
+void
+(MLAS_POOL_KERNEL_ROUTINE)(
+    const MLAS_WORK_BLOCK* WorkBlock,
+    size_t ChannelCount,
+    const float* Input,
+    float* Output
+    );
+
+typedef MLAS_POOL_KERNEL_ROUTINE* PMLAS_POOL_KERNEL_ROUTINE;
+
 //
 // Define the parameters to execute segments of a pooling operation on worker
 // threads.
@@ -26,25 +45,42 @@ struct MLAS_WORK_BLOCK {
     size_t InputShape[3];
     size_t InputSize;
     size_t OutputShape[3];
+    size_t OutputSize;
     int64_t KernelShape[3];
     int64_t Padding[6];
     int64_t StrideShape[3];
+    PMLAS_POOL_KERNEL_ROUTINE PoolKernelRoutine;
+    const float* Input;
+    float* Output;
+    size_t TotalChannelCount;
+    int32_t ThreadCount;
+    float P;
+    const int32_t* Mask;
+    size_t MaskSize;
+    int64_t* Index;
 };
 
 //
-// Define the prototype of the pooling kernel routine.
+// Define the shapes of a pooling operation expanded to three dimensions by
+// adding leading dimensions of one. The leading dimensions do not change the
+// layout of the tensors, so the kernels that support any number of dimensions
+// only need to handle three.
 //
 
-typedef
-void
-(MLAS_POOL_KERNEL_ROUTINE)(
-    const MLAS_WORK_BLOCK* WorkBlock,
-    size_t ChannelCount,
-    const float* Input,
-    float* Output
-    );
+struct MLAS_POOL_SHAPE_3D {
+    int64_t InputShape[5];
+    int64_t KernelShape[3];
+    int64_t Padding[6];
+    int64_t StrideShape[3];
+    int64_t OutputShape[5];
+};
 
-typedef MLAS_POOL_KERNEL_ROUTINE* PMLAS_POOL_KERNEL_ROUTINE;
+//
+// Define the number of output elements times kernel elements to process per
+// thread before using another thread to compute a pooling operation.
+//
+
+#define MLAS_POOL_THREAD_COMPLEXITY         (64 * 1024)
 
 //
 // Define the number of elements to allocate on the stack for the reduction
@@ -269,6 +305,59 @@ struct MLAS_AVERAGE_POOLING
     };
 };
 
+//
+// Abstractions for Lp pooling, which sums the P-th power of the absolute value
+// of each input and takes the P-th root of the sum. The common cases of P=1 and
+// P=2 avoid the power functions.
+//
+
+struct MLAS_L1_POOLING
+{
+    static float Reduce(float Reduction, float Value, float P)
+    {
+        MLAS_UNREFERENCED_PARAMETER(P);
+
+        return Reduction + std::fabs(Value);
+    }
+
+    static float Root(float Reduction, float P)
+    {
+        MLAS_UNREFERENCED_PARAMETER(P);
+
+        return Reduction;
+    }
+};
+
+struct MLAS_L2_POOLING
+{
+    static float Reduce(float Reduction, float Value, float P)
+    {
+        MLAS_UNREFERENCED_PARAMETER(P);
+
+        return Reduction + Value * Value;
+    }
+
+    static float Root(float Reduction, float P)
+    {
+        MLAS_UNREFERENCED_PARAMETER(P);
+
+        return std::sqrt(Reduction);
+    }
+};
+
+struct MLAS_LP_POOLING
+{
+    static float Reduce(float Reduction, float Value, float P)
+    {
+        return Reduction + std::pow(std::fabs(Value), P);
+    }
+
+    static float Root(float Reduction, float P)
+    {
+        return std::pow(Reduction, 1.0f / P);
+    }
+};
+
 template<typename PoolingType>
 void
 MlasPool1DKernel(
@@ -1066,11 +1155,39 @@ Return Value:
         size_t InputSizeRemaining = InputSize;
 
         //
-        // Iterate over the input buffer a vector at a time.
+        // Iterate over the input buffer four vectors at a time. Each vector
+        // has its own reduction, so that the reductions are independent.
         //
 
         MLAS_FLOAT32X4 Reduction = PoolingType::InitialVector();
 
+        if (InputSizeRemaining >= 16) {
+
+            MLAS_FLOAT32X4 Reduction1 = PoolingType::InitialVector();
+            MLAS_FLOAT32X4 Reduction2 = PoolingType::InitialVector();
+            MLAS_FLOAT32X4 Reduction3 = PoolingType::InitialVector();
+
+            do {
+
+                Reduction = PoolingType::Reduce(Reduction, MlasLoadFloat32x4(Input));
+                Reduction1 = PoolingType::Reduce(Reduction1, MlasLoadFloat32x4(Input + 4));
+                Reduction2 = PoolingType::Reduce(Reduction2, MlasLoadFloat32x4(Input + 8));
+                Reduction3 = PoolingType::Reduce(Reduction3, MlasLoadFloat32x4(Input + 12));
+
+                Input += 16;
+                InputSizeRemaining -= 16;
+
+            } while (InputSizeRemaining >= 16);
+
+            Reduction = PoolingType::Reduce(Reduction, Reduction1);
+            Reduction2 = PoolingType::Reduce(Reduction2, Reduction3);
+            Reduction = PoolingType::Reduce(Reduction, Reduction2);
+        }
+
+        //
+        // Iterate over the remaining input buffer a vector at a time.
+        //
+
         while (InputSizeRemaining >= 4) {
             Reduction = PoolingType::Reduce(Reduction, MlasLoadFloat32x4(Input));
             Input += 4;
@@ -1125,62 +1242,11 @@ Return Value:
     }
 }
 
-//
-// Stores pointers to the pooling kernel routines.
-//
-
-static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolGenericKernels[][3] =
-{
-    {
-        MlasPool1DKernel<MLAS_MAXIMUM_POOLING>,
-        MlasPool2DKernel<MLAS_MAXIMUM_POOLING>,
-        MlasPool3DKernel<MLAS_MAXIMUM_POOLING>,
-    },
-    {
-        MlasPool1DKernel<MLAS_AVERAGE_POOLING>,
-        MlasPool2DKernel<MLAS_AVERAGE_POOLING>,
-        MlasPool3DKernel<MLAS_AVERAGE_POOLING>,
-    },
-    {
-        MlasPool1DKernel<MLAS_AVERAGE_POOLING>,
-        MlasPool2DKernel<MLAS_AVERAGE_POOLING>,
-        MlasPool3DKernel<MLAS_AVERAGE_POOLING>,
-    },
-};
-
-static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolGlobalKernels[] =
-{
-    MlasPoolGlobalKernel<MLAS_MAXIMUM_POOLING>,
-    MlasPoolGlobalKernel<MLAS_AVERAGE_POOLING>,
-    MlasPoolGlobalKernel<MLAS_AVERAGE_POOLING>,
-};
-
-static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolVectorKernels[][2] =
-{
-    {
-        MlasPool2DVectorKernel<MLAS_MAXIMUM_POOLING>,
-        MlasPool3DVectorKernel<MLAS_MAXIMUM_POOLING>,
-    },
-    {
-        MlasPool2DVectorKernel<MLAS_AVERAGE_POOLING>,
-        MlasPool3DVectorKernel<MLAS_AVERAGE_POOLING>,
-    },
-    {
-        MlasPool2DVectorKernel<MLAS_AVERAGE_POOLING>,
-        MlasPool3DVectorKernel<MLAS_AVERAGE_POOLING>,
-    },
-};
-
+template<typename LpPoolingType>
 void
-MLASCALL
-MlasPool(
-    MLAS_POOLING_KIND PoolingKind,
-    size_t Dimensions,
-    const int64_t* InputShape,
-    const int64_t* KernelShape,
-    const int64_t* Padding,
-    const int64_t* StrideShape,
-    const int64_t* OutputShape,
+MlasLpPool3DKernel(
+    const MLAS_WORK_BLOCK* WorkBlock,
+    size_t ChannelCount,
     const float* Input,
     float* Output
     )
@@ -1188,24 +1254,14 @@ MlasPool(
 
 Routine Description:
 
-    This routine implements the pooling operation.
+    This routine implements the 3D Lp pooling operation. Padding elements do
+    not contribute to the sum.
 
 Arguments:
 
-    PoolingKind - Supplies the kind of pooling operation to perform.
-
-    Dimensions - Supplies the number of dimensions.
-
-    InputShape - Supplies the shape of the input tensor.
-
-    KernelShape - Supplies the shape of the kernel transform.
-
-    Padding - Supplies the number of padding elements at the edge of the input
-        tensor.
-
-    StrideShape - Supplies the shape of the stride.
+    WorkBlock - Supplies the structure that contains the pooling parameters.
 
-    OutputShape - Supplies the shape of the output tensor.
+    ChannelCount - Supplies the number of channels to process.
 
     Input - Supplies the input tensor.
 
@@ -1217,92 +1273,646 @@ Return Value:
 
 --*/
 {
-    MLAS_WORK_BLOCK WorkBlock;
+    constexpr size_t DepthShapeIndex = 0;
+    constexpr size_t HeightShapeIndex = 1;
+    constexpr size_t WidthShapeIndex = 2;
 
-    WorkBlock.PoolingKind = PoolingKind;
+    const float P = WorkBlock->P;
 
-    //
-    // Compute the total number of channels to process and advance the input
-    // and output shapes over the batch and channel counts.
-    //
+    const size_t InputDepth = WorkBlock->InputShape[DepthShapeIndex];
+    const size_t InputHeight = WorkBlock->InputShape[HeightShapeIndex];
+    const size_t InputWidth = WorkBlock->InputShape[WidthShapeIndex];
+    const size_t InputSize = WorkBlock->InputSize;
+    const size_t OutputDepth = WorkBlock->OutputShape[DepthShapeIndex];
+    const size_t OutputHeight = WorkBlock->OutputShape[HeightShapeIndex];
+    const size_t OutputWidth = WorkBlock->OutputShape[WidthShapeIndex];
 
-    size_t TotalChannelCount = size_t(InputShape[0]) * size_t(InputShape[1]);
+    const int64_t KernelDepth = WorkBlock->KernelShape[DepthShapeIndex];
+    const int64_t KernelHeight = WorkBlock->KernelShape[HeightShapeIndex];
+    const int64_t KernelWidth = WorkBlock->KernelShape[WidthShapeIndex];
+    const int64_t PaddingLeftDepth = WorkBlock->Padding[DepthShapeIndex];
+    const int64_t PaddingLeftHeight = WorkBlock->Padding[HeightShapeIndex];
+    const int64_t PaddingLeftWidth = WorkBlock->Padding[WidthShapeIndex];
+    const int64_t StrideDepth = WorkBlock->StrideShape[DepthShapeIndex];
+    const int64_t StrideHeight = WorkBlock->StrideShape[HeightShapeIndex];
+    const int64_t StrideWidth = WorkBlock->StrideShape[WidthShapeIndex];
 
-    InputShape += 2;
-    OutputShape += 2;
+    for (size_t c = 0; c < ChannelCount; c++) {
 
-    //
-    // Save the pooling parameters.
-    //
+        for (size_t pd = 0; pd < OutputDepth; pd++) {
 
-    size_t InputSize = 1;
-    size_t OutputSize = 1;
+            const int64_t idStart64 = pd * StrideDepth - PaddingLeftDepth;
+            const int64_t idEnd64 = idStart64 + KernelDepth;
 
-    bool InputAndKernelShapeMatch = true;
-    bool AllStridesAreOne = true;
-    bool AllPaddingIsZero = true;
-    bool AllKernelsAreSmall = true;
+            const size_t idStart = size_t((std::max)(idStart64, int64_t(0)));
+            const size_t idEnd = size_t((std::min)(idEnd64, int64_t(InputDepth)));
 
-    for (size_t dim = 0; dim < Dimensions; dim++) {
+            for (size_t ph = 0; ph < OutputHeight; ph++) {
 
-        WorkBlock.InputShape[dim] = size_t(InputShape[dim]);
-        WorkBlock.OutputShape[dim] = size_t(OutputShape[dim]);
+                const int64_t ihStart64 = ph * StrideHeight - PaddingLeftHeight;
+                const int64_t ihEnd64 = ihStart64 + KernelHeight;
 
-        if (KernelShape != nullptr) {
-            WorkBlock.KernelShape[dim] = KernelShape[dim];
-        } else {
-            WorkBlock.KernelShape[dim] = InputShape[dim];
-        }
+                const size_t ihStart = size_t((std::max)(ihStart64, int64_t(0)));
+                const size_t ihEnd = size_t((std::min)(ihEnd64, int64_t(InputHeight)));
 
-        if (Padding != nullptr) {
-            WorkBlock.Padding[dim] = Padding[dim];
-            WorkBlock.Padding[dim + Dimensions] = Padding[dim + Dimensions];
-        } else {
-            WorkBlock.Padding[dim] = 0;
-            WorkBlock.Padding[dim + Dimensions] = 0;
-        }
+                for (size_t pw = 0; pw < OutputWidth; pw++) {
 
-        if (StrideShape != nullptr) {
-            WorkBlock.StrideShape[dim] = StrideShape[dim];
-        } else {
-            WorkBlock.StrideShape[dim] = 1;
-        }
+                    const int64_t iwStart64 = pw * StrideWidth - PaddingLeftWidth;
+                    const int64_t iwEnd64 = iwStart64 + KernelWidth;
 
-        InputSize *= WorkBlock.InputShape[dim];
-        OutputSize *= WorkBlock.OutputShape[dim];
+                    const size_t iwStart = size_t((std::max)(iwStart64, int64_t(0)));
+                    const size_t iwEnd = size_t((std::min)(iwEnd64, int64_t(InputWidth)));
 
-        InputAndKernelShapeMatch &= (WorkBlock.KernelShape[dim] == int64_t(WorkBlock.InputShape[dim]));
-        AllStridesAreOne &= (WorkBlock.StrideShape[dim] == 1);
-        AllPaddingIsZero &= (WorkBlock.Padding[dim] == 0 && WorkBlock.Padding[dim + Dimensions] == 0);
-        AllKernelsAreSmall &= (WorkBlock.KernelShape[dim] <= 32);
-    }
+                    float m = 0.0f;
 
-    WorkBlock.InputSize = InputSize;
+                    for (size_t id = idStart; id < idEnd; id++) {
+                        for (size_t ih = ihStart; ih < ihEnd; ih++) {
+                            const float* InputRow = &Input[(id * InputHeight + ih) * InputWidth];
+                            for (size_t iw = iwStart; iw < iwEnd; iw++) {
+                                m = LpPoolingType::Reduce(m, InputRow[iw], P);
+                            }
+                        }
+                    }
 
-    //
-    // Determine which pooling kernel routine to use.
-    //
-    // The vectorized kernels only support strides of 1 or 2. The kernel size
-    // should be kept low in order to keep the divisors for average pooling to
-    // be exactly representable as float. The input width plus padding must fit
-    // in the reduction buffer.
-    //
+                    *Output++ = LpPoolingType::Root(m, P);
+                }
+            }
+        }
 
-    PMLAS_POOL_KERNEL_ROUTINE PoolKernelRoutine = MlasPoolGenericKernels[PoolingKind][Dimensions - 1];
+        Input += InputSize;
+    }
+}
 
-    if (InputAndKernelShapeMatch && AllStridesAreOne && AllPaddingIsZero) {
+template<bool UseMask>
+void
+MlasMaximumPoolWithIndex3DKernel(
+    const MLAS_WORK_BLOCK* WorkBlock,
+    size_t ChannelCount,
+    const float* Input,
+    float* Output
+    )
+/*++
 
-        PoolKernelRoutine = MlasPoolGlobalKernels[PoolingKind];
+Routine Description:
 
-    } else if (Dimensions >= 2 && WorkBlock.StrideShape[Dimensions - 1] <= 2 && AllKernelsAreSmall) {
+    This routine implements the 3D maximum pooling operation and optionally
+    stores the index of the maximum input element of each output element.
 
-        int64_t ReductionBufferRemaining = MLAS_POOL_REDUCTION_BUFFER_STACK - MLAS_POOL_REDUCTION_BUFFER_PADDING;
+    The index is the offset of the element in the input tensor, including the
+    batch and channel dimensions. If no input element is larger than the
+    lowest float value, the index is that of the first element of the kernel.
 
-        if (ReductionBufferRemaining >= WorkBlock.Padding[Dimensions - 1]) {
-            ReductionBufferRemaining -= WorkBlock.Padding[Dimensions - 1];
-        } else {
-            ReductionBufferRemaining = 0;
-        }
+    If UseMask is true, the scan of each row of the kernel stops at the first
+    element whose mask is zero. The mask of a channel starts at the offset of
+    the channel in the input tensor modulo the mask size.
+
+Arguments:
+
+    WorkBlock - Supplies the structure that contains the pooling parameters.
+
+    ChannelCount - Supplies the number of channels to process.
+
+    Input - Supplies the input tensor.
+
+    Output - Supplies the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t DepthShapeIndex = 0;
+    constexpr size_t HeightShapeIndex = 1;
+    constexpr size_t WidthShapeIndex = 2;
+
+    const size_t InputDepth = WorkBlock->InputShape[DepthShapeIndex];
+    const size_t InputHeight = WorkBlock->InputShape[HeightShapeIndex];
+    const size_t InputWidth = WorkBlock->InputShape[WidthShapeIndex];
+    const size_t InputSize = WorkBlock->InputSize;
+    const size_t OutputDepth = WorkBlock->OutputShape[DepthShapeIndex];
+    const size_t OutputHeight = WorkBlock->OutputShape[HeightShapeIndex];
+    const size_t OutputWidth = WorkBlock->OutputShape[WidthShapeIndex];
+
+    const int64_t KernelDepth = WorkBlock->KernelShape[DepthShapeIndex];
+    const int64_t KernelHeight = WorkBlock->KernelShape[HeightShapeIndex];
+    const int64_t KernelWidth = WorkBlock->KernelShape[WidthShapeIndex];
+    const int64_t PaddingLeftDepth = WorkBlock->Padding[DepthShapeIndex];
+    const int64_t PaddingLeftHeight = WorkBlock->Padding[HeightShapeIndex];
+    const int64_t PaddingLeftWidth = WorkBlock->Padding[WidthShapeIndex];
+    const int64_t StrideDepth = WorkBlock->StrideShape[DepthShapeIndex];
+    const int64_t StrideHeight = WorkBlock->StrideShape[HeightShapeIndex];
+    const int64_t StrideWidth = WorkBlock->StrideShape[WidthShapeIndex];
+
+    //
+    // Compute the offset of the first channel from the start of the input and
+    // output tensors.
+    //
+
+    size_t InputOffset = size_t(Input - WorkBlock->Input);
+    int64_t* Index = WorkBlock->Index;
+
+    if (Index != nullptr) {
+        Index += Output - WorkBlock->Output;
+    }
+
+    for (size_t c = 0; c < ChannelCount; c++) {
+
+        const int32_t* Mask = nullptr;
+
+        if (UseMask) {
+            Mask = WorkBlock->Mask + InputOffset % WorkBlock->MaskSize;
+        }
+
+        for (size_t pd = 0; pd < OutputDepth; pd++) {
+
+            const int64_t idStart64 = pd * StrideDepth - PaddingLeftDepth;
+            const int64_t idEnd64 = idStart64 + KernelDepth;
+
+            const size_t idStart = size_t((std::max)(idStart64, int64_t(0)));
+            const size_t idEnd = size_t((std::min)(idEnd64, int64_t(InputDepth)));
+
+            for (size_t ph = 0; ph < OutputHeight; ph++) {
+
+                const int64_t ihStart64 = ph * StrideHeight - PaddingLeftHeight;
+                const int64_t ihEnd64 = ihStart64 + KernelHeight;
+
+                const size_t ihStart = size_t((std::max)(ihStart64, int64_t(0)));
+                const size_t ihEnd = size_t((std::min)(ihEnd64, int64_t(InputHeight)));
+
+                for (size_t pw = 0; pw < OutputWidth; pw++) {
+
+                    const int64_t iwStart64 = pw * StrideWidth - PaddingLeftWidth;
+                    const int64_t iwEnd64 = iwStart64 + KernelWidth;
+
+                    const size_t iwStart = size_t((std::max)(iwStart64, int64_t(0)));
+                    const size_t iwEnd = size_t((std::min)(iwEnd64, int64_t(InputWidth)));
+
+                    float m = std::numeric_limits<float>::lowest();
+                    size_t MaximumIndex = (idStart * InputHeight + ihStart) * InputWidth + iwStart;
+
+                    for (size_t id = idStart; id < idEnd; id++) {
+                        for (size_t ih = ihStart; ih < ihEnd; ih++) {
+                            const size_t RowIndex = (id * InputHeight + ih) * InputWidth;
+                            for (size_t iw = iwStart; iw < iwEnd; iw++) {
+                                if (UseMask && Mask[RowIndex + iw] == 0) {
+                                    break;
+                                }
+                                if (Input[RowIndex + iw] > m) {
+                                    m = Input[RowIndex + iw];
+                                    MaximumIndex = RowIndex + iw;
+                                }
+                            }
+                        }
+                    }
+
+                    *Output++ = m;
+
+                    if (Index != nullptr) {
+                        *Index++ = int64_t(InputOffset + MaximumIndex);
+                    }
+                }
+            }
+        }
+
+        Input += InputSize;
+        InputOffset += InputSize;
+    }
+}
+
+//
+// Stores pointers to the pooling kernel routines.
+//
+
+static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolGenericKernels[][3] =
+{
+    {
+        MlasPool1DKernel<MLAS_MAXIMUM_POOLING>,
+        MlasPool2DKernel<MLAS_MAXIMUM_POOLING>,
+        MlasPool3DKernel<MLAS_MAXIMUM_POOLING>,
+    },
+    {
+        MlasPool1DKernel<MLAS_AVERAGE_POOLING>,
+        MlasPool2DKernel<MLAS_AVERAGE_POOLING>,
+        MlasPool3DKernel<MLAS_AVERAGE_POOLING>,
+    },
+    {
+        MlasPool1DKernel<MLAS_AVERAGE_POOLING>,
+        MlasPool2DKernel<MLAS_AVERAGE_POOLING>,
+        MlasPool3DKernel<MLAS_AVERAGE_POOLING>,
+    },
+};
+
+static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolGlobalKernels[] =
+{
+    MlasPoolGlobalKernel<MLAS_MAXIMUM_POOLING>,
+    MlasPoolGlobalKernel<MLAS_AVERAGE_POOLING>,
+    MlasPoolGlobalKernel<MLAS_AVERAGE_POOLING>,
+};
+
+static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolVectorKernels[][2] =
+{
+    {
+        MlasPool2DVectorKernel<MLAS_MAXIMUM_POOLING>,
+        MlasPool3DVectorKernel<MLAS_MAXIMUM_POOLING>,
+    },
+    {
+        MlasPool2DVectorKernel<MLAS_AVERAGE_POOLING>,
+        MlasPool3DVectorKernel<MLAS_AVERAGE_POOLING>,
+    },
+    {
+        MlasPool2DVectorKernel<MLAS_AVERAGE_POOLING>,
+        MlasPool3DVectorKernel<MLAS_AVERAGE_POOLING>,
+    },
+};
+
+void
+MlasPoolThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    pooling operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const auto* WorkBlock = (MLAS_WORK_BLOCK*)Context;
+
+    //
+    // Partition the operation along the batch and channel dimensions.
+    //
+
+    const size_t TotalChannelCount = WorkBlock->TotalChannelCount;
+
+    const size_t WorkPerThread = TotalChannelCount / WorkBlock->ThreadCount;
+    const size_t WorkPerThreadExtra = TotalChannelCount % WorkBlock->ThreadCount;
+
+    size_t ChannelCount;
+    size_t ChannelStart;
+
+    if (size_t(Index) < WorkPerThreadExtra) {
+        ChannelCount = WorkPerThread + 1;
+        ChannelStart = ChannelCount * Index;
+    } else {
+        ChannelCount = WorkPerThread;
+        ChannelStart = WorkPerThread * Index + WorkPerThreadExtra;
+    }
+
+    const float* Input = WorkBlock->Input + ChannelStart * WorkBlock->InputSize;
+    float* Output = WorkBlock->Output + ChannelStart * WorkBlock->OutputSize;
+
+    WorkBlock->PoolKernelRoutine(WorkBlock, ChannelCount, Input, Output);
+}
+
+void
+MlasPoolPrepareWorkBlock(
+    MLAS_WORK_BLOCK* WorkBlock,
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape
+    )
+/*++
+
+Routine Description:
+
+    This routine saves the parameters of a pooling operation to the work
+    block.
+
+Arguments:
+
+    WorkBlock - Supplies the structure that receives the pooling parameters.
+
+    Dimensions - Supplies the number of dimensions.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    KernelShape - Supplies the shape of the kernel transform. If nullptr, the
+        kernel has the shape of the input.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor. If nullptr, there is no padding.
+
+    StrideShape - Supplies the shape of the stride. If nullptr, the strides
+        are one.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    //
+    // Compute the total number of channels to process and advance the input
+    // and output shapes over the batch and channel counts.
+    //
+
+    WorkBlock->TotalChannelCount = size_t(InputShape[0]) * size_t(InputShape[1]);
+
+    InputShape += 2;
+    OutputShape += 2;
+
+    //
+    // Save the pooling parameters.
+    //
+
+    size_t InputSize = 1;
+    size_t OutputSize = 1;
+
+    for (size_t dim = 0; dim < Dimensions; dim++) {
+
+        WorkBlock->InputShape[dim] = size_t(InputShape[dim]);
+        WorkBlock->OutputShape[dim] = size_t(OutputShape[dim]);
+
+        if (KernelShape != nullptr) {
+            WorkBlock->KernelShape[dim] = KernelShape[dim];
+        } else {
+            WorkBlock->KernelShape[dim] = InputShape[dim];
+        }
+
+        if (Padding != nullptr) {
+            WorkBlock->Padding[dim] = Padding[dim];
+            WorkBlock->Padding[dim + Dimensions] = Padding[dim + Dimensions];
+        } else {
+            WorkBlock->Padding[dim] = 0;
+            WorkBlock->Padding[dim + Dimensions] = 0;
+        }
+
+        if (StrideShape != nullptr) {
+            WorkBlock->StrideShape[dim] = StrideShape[dim];
+        } else {
+            WorkBlock->StrideShape[dim] = 1;
+        }
+
+        InputSize *= WorkBlock->InputShape[dim];
+        OutputSize *= WorkBlock->OutputShape[dim];
+    }
+
+    WorkBlock->InputSize = InputSize;
+    WorkBlock->OutputSize = OutputSize;
+
+    WorkBlock->P = 0.0f;
+    WorkBlock->Mask = nullptr;
+    WorkBlock->MaskSize = 0;
+    WorkBlock->Index = nullptr;
+}
+
+void
+MlasPoolExpandShapeTo3D(
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    MLAS_POOL_SHAPE_3D* Shape3D
+    )
+/*++
+
+Routine Description:
+
+    This routine expands the shapes of a pooling operation with one to three
+    dimensions to three dimensions by adding leading dimensions of one.
+
+Arguments:
+
+    Dimensions - Supplies the number of dimensions.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    KernelShape - Supplies the shape of the kernel transform. If nullptr, the
+        kernel has the shape of the input.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor. If nullptr, there is no padding.
+
+    StrideShape - Supplies the shape of the stride. If nullptr, the strides
+        are one.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    Shape3D - Receives the expanded shapes.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t LeadingDimensions = 3 - Dimensions;
+
+    Shape3D->InputShape[0] = InputShape[0];
+    Shape3D->InputShape[1] = InputShape[1];
+    Shape3D->OutputShape[0] = OutputShape[0];
+    Shape3D->OutputShape[1] = OutputShape[1];
+
+    for (size_t dim = 0; dim < 3; dim++) {
+
+        if (dim < LeadingDimensions) {
+            Shape3D->InputShape[dim + 2] = 1;
+            Shape3D->OutputShape[dim + 2] = 1;
+            Shape3D->KernelShape[dim] = 1;
+            Shape3D->Padding[dim] = 0;
+            Shape3D->Padding[dim + 3] = 0;
+            Shape3D->StrideShape[dim] = 1;
+            continue;
+        }
+
+        const size_t SourceDim = dim - LeadingDimensions;
+
+        Shape3D->InputShape[dim + 2] = InputShape[SourceDim + 2];
+        Shape3D->OutputShape[dim + 2] = OutputShape[SourceDim + 2];
+        Shape3D->KernelShape[dim] = (KernelShape != nullptr) ? KernelShape[SourceDim] : InputShape[SourceDim + 2];
+        Shape3D->Padding[dim] = (Padding != nullptr) ? Padding[SourceDim] : 0;
+        Shape3D->Padding[dim + 3] = (Padding != nullptr) ? Padding[SourceDim + Dimensions] : 0;
+        Shape3D->StrideShape[dim] = (StrideShape != nullptr) ? StrideShape[SourceDim] : 1;
+    }
+}
+
+void
+MlasPoolExecute(
+    MLAS_WORK_BLOCK* WorkBlock,
+    size_t Dimensions,
+    PMLAS_POOL_KERNEL_ROUTINE PoolKernelRoutine,
+    const float* Input,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine executes a pooling kernel routine over the channels of the
+    input tensor, splitting the channels across threads.
+
+Arguments:
+
+    WorkBlock - Supplies the structure that contains the pooling parameters.
+
+    Dimensions - Supplies the number of dimensions.
+
+    PoolKernelRoutine - Supplies the pooling kernel routine.
+
+    Input - Supplies the input tensor.
+
+    Output - Supplies the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t TotalChannelCount = WorkBlock->TotalChannelCount;
+
+    //
+    // Compute the number of target threads given the complexity of the pooling
+    // operation. Small requests should run using the single threaded path.
+    //
+
+    size_t KernelSize = 1;
+
+    for (size_t dim = 0; dim < Dimensions; dim++) {
+        KernelSize *= size_t(WorkBlock->KernelShape[dim]);
+    }
+
+    double Complexity = double(TotalChannelCount) * double(WorkBlock->OutputSize) * double(KernelSize);
+
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_POOL_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_POOL_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) >= TotalChannelCount) {
+        TargetThreadCount = int32_t(std::max(TotalChannelCount, size_t(1)));
+    }
+
+    //
+    // Execute the pooling kernel routine.
+    //
+
+    WorkBlock->PoolKernelRoutine = PoolKernelRoutine;
+    WorkBlock->Input = Input;
+    WorkBlock->Output = Output;
+    WorkBlock->ThreadCount = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasPoolThreaded, WorkBlock, TargetThreadCount);
+}
+
+void
+MLASCALL
+MlasPool(
+    MLAS_POOLING_KIND PoolingKind,
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the pooling operation.
+
+Arguments:
+
+    PoolingKind - Supplies the kind of pooling operation to perform.
+
+    Dimensions - Supplies the number of dimensions.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    KernelShape - Supplies the shape of the kernel transform.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor.
+
+    StrideShape - Supplies the shape of the stride.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    Input - Supplies the input tensor.
+
+    Output - Supplies the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_WORK_BLOCK WorkBlock;
+
+    WorkBlock.PoolingKind = PoolingKind;
+
+    MlasPoolPrepareWorkBlock(&WorkBlock, Dimensions, InputShape, KernelShape, Padding, StrideShape, OutputShape);
+
+    bool InputAndKernelShapeMatch = true;
+    bool AllStridesAreOne = true;
+    bool AllPaddingIsZero = true;
+    bool AllKernelsAreSmall = true;
+
+    for (size_t dim = 0; dim < Dimensions; dim++) {
+        InputAndKernelShapeMatch &= (WorkBlock.KernelShape[dim] == int64_t(WorkBlock.InputShape[dim]));
+        AllStridesAreOne &= (WorkBlock.StrideShape[dim] == 1);
+        AllPaddingIsZero &= (WorkBlock.Padding[dim] == 0 && WorkBlock.Padding[dim + Dimensions] == 0);
+        AllKernelsAreSmall &= (WorkBlock.KernelShape[dim] <= 32);
+    }
+
+    //
+    // Determine which pooling kernel routine to use.
+    //
+    // The vectorized kernels only support strides of 1 or 2. The kernel size
+    // should be kept low in order to keep the divisors for average pooling to
+    // be exactly representable as float. The input width plus padding must fit
+    // in the reduction buffer.
+    //
+
+    PMLAS_POOL_KERNEL_ROUTINE PoolKernelRoutine = MlasPoolGenericKernels[PoolingKind][Dimensions - 1];
+
+    if (InputAndKernelShapeMatch && AllStridesAreOne && AllPaddingIsZero) {
+
+        PoolKernelRoutine = MlasPoolGlobalKernels[PoolingKind];
+
+    } else if (Dimensions >= 2 && WorkBlock.StrideShape[Dimensions - 1] <= 2 && AllKernelsAreSmall) {
+
+        int64_t ReductionBufferRemaining = MLAS_POOL_REDUCTION_BUFFER_STACK - MLAS_POOL_REDUCTION_BUFFER_PADDING;
+
+        if (ReductionBufferRemaining >= WorkBlock.Padding[Dimensions - 1]) {
+            ReductionBufferRemaining -= WorkBlock.Padding[Dimensions - 1];
+        } else {
+            ReductionBufferRemaining = 0;
+        }
 
         if (ReductionBufferRemaining >= WorkBlock.Padding[Dimensions * 2 - 1]) {
             ReductionBufferRemaining -= WorkBlock.Padding[Dimensions * 2 - 1];
@@ -1315,21 +1925,218 @@ Return Value:
         }
     }
 
-    //
-    // Execute the pooling kernel routine.
-    //
+    MlasPoolExecute(&WorkBlock, Dimensions, PoolKernelRoutine, Input, Output);
+}
+
+void
+MLASCALL
+MlasLpPool(
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    float P,
+    const float* Input,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the Lp pooling operation, which computes the P-th
+    root of the sum of the P-th power of the absolute value of the elements of
+    each kernel.
 
-#if defined(MLAS_USE_OPENMP)
+Arguments:
+
+    Dimensions - Supplies the number of dimensions.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    KernelShape - Supplies the shape of the kernel transform. If nullptr, the
+        kernel has the shape of the input.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor. If nullptr, there is no padding.
+
+    StrideShape - Supplies the shape of the stride. If nullptr, the strides
+        are one.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    P - Supplies the order of the norm.
+
+    Input - Supplies the input tensor.
+
+    Output - Supplies the output tensor.
 
-    #pragma omp parallel for
-    for (int64_t c = 0; c < int64_t(TotalChannelCount); c++) {
-        PoolKernelRoutine(&WorkBlock, 1, Input + c * InputSize, Output + c * OutputSize);
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_POOL_SHAPE_3D Shape3D;
+
+    MlasPoolExpandShapeTo3D(Dimensions, InputShape, KernelShape, Padding, StrideShape, OutputShape, &Shape3D);
+
+    MLAS_WORK_BLOCK WorkBlock;
+
+    WorkBlock.PoolingKind = MlasPoolingKindCount;
+
+    MlasPoolPrepareWorkBlock(&WorkBlock, 3, Shape3D.InputShape, Shape3D.KernelShape, Shape3D.Padding,
+        Shape3D.StrideShape, Shape3D.OutputShape);
+
+    WorkBlock.P = P;
+
+    PMLAS_POOL_KERNEL_ROUTINE PoolKernelRoutine;
+
+    if (P == 1.0f) {
+        PoolKernelRoutine = MlasLpPool3DKernel<MLAS_L1_POOLING>;
+    } else if (P == 2.0f) {
+        PoolKernelRoutine = MlasLpPool3DKernel<MLAS_L2_POOLING>;
+    } else {
+        PoolKernelRoutine = MlasLpPool3DKernel<MLAS_LP_POOLING>;
     }
 
-#else
+    MlasPoolExecute(&WorkBlock, 3, PoolKernelRoutine, Input, Output);
+}
 
-    PoolKernelRoutine(&WorkBlock, TotalChannelCount, Input, Output);
+void
+MLASCALL
+MlasMaximumPoolWithIndex(
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    float* Output,
+    int64_t* Index
+    )
+/*++
 
-#endif
+Routine Description:
+
+    This routine implements the maximum pooling operation and stores the index
+    of the maximum input element of each output element.
+
+Arguments:
+
+    Dimensions - Supplies the number of dimensions.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    KernelShape - Supplies the shape of the kernel transform. If nullptr, the
+        kernel has the shape of the input.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor. If nullptr, there is no padding.
+
+    StrideShape - Supplies the shape of the stride. If nullptr, the strides
+        are one.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    Input - Supplies the input tensor.
+
+    Output - Supplies the output tensor.
+
+    Index - Supplies the tensor that receives the offset of the maximum element
+        of each output element in the input tensor, counting the elements of
+        the input tensor in row major order.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_POOL_SHAPE_3D Shape3D;
+
+    MlasPoolExpandShapeTo3D(Dimensions, InputShape, KernelShape, Padding, StrideShape, OutputShape, &Shape3D);
+
+    MLAS_WORK_BLOCK WorkBlock;
+
+    WorkBlock.PoolingKind = MlasMaximumPooling;
+
+    MlasPoolPrepareWorkBlock(&WorkBlock, 3, Shape3D.InputShape, Shape3D.KernelShape, Shape3D.Padding,
+        Shape3D.StrideShape, Shape3D.OutputShape);
+
+    WorkBlock.Index = Index;
+
+    MlasPoolExecute(&WorkBlock, 3, MlasMaximumPoolWithIndex3DKernel<false>, Input, Output);
+}
+
+void
+MLASCALL
+MlasMaximumPoolWithMask(
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    const int32_t* Mask,
+    size_t MaskSize,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the maximum pooling operation over the elements of
+    each kernel that precede a zero in the mask. The scan of each row of the
+    kernel stops at the first element whose mask is zero.
+
+Arguments:
+
+    Dimensions - Supplies the number of dimensions.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    KernelShape - Supplies the shape of the kernel transform.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor.
+
+    StrideShape - Supplies the shape of the stride.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    Input - Supplies the input tensor.
+
+    Mask - Supplies the mask tensor. The mask of a channel starts at the offset
+        of the channel in the input tensor modulo MaskSize.
+
+    MaskSize - Supplies the number of elements that the mask of a channel may
+        start at.
+
+    Output - Supplies the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_POOL_SHAPE_3D Shape3D;
+
+    MlasPoolExpandShapeTo3D(Dimensions, InputShape, KernelShape, Padding, StrideShape, OutputShape, &Shape3D);
+
+    MLAS_WORK_BLOCK WorkBlock;
+
+    WorkBlock.PoolingKind = MlasMaximumPooling;
+
+    MlasPoolPrepareWorkBlock(&WorkBlock, 3, Shape3D.InputShape, Shape3D.KernelShape, Shape3D.Padding,
+        Shape3D.StrideShape, Shape3D.OutputShape);
+
+    WorkBlock.Mask = Mask;
+    WorkBlock.MaskSize = MaskSize;
 
+    MlasPoolExecute(&WorkBlock, 3, MlasMaximumPoolWithIndex3DKernel<true>, Input, Output);
 }
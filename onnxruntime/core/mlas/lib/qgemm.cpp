@@ -0,0 +1,1196 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    qgemm.cpp
+
+Abstract:
+
+    This module implements the quantized integer matrix/matrix multiply
+    operation (QGEMM).
+
+    The bytes of matrix A and matrix B are widened to 16-bit values and the
+    zero points are subtracted while copying the matrices to the packed
+    buffers used by the kernels. Pairs of rows of matrix B are interleaved so
+    that the kernels can multiply two elements of the K dimension and add
+    the products to a 32-bit accumulator with a single instruction (PMADDWD
+    or VPDPWSSD). The products of 9-bit values cannot overflow this
+    instruction, so the result is exact for any zero point.
+
+--*/
+
+#include "mlasi.h"
+#include <cmath>
+
+//
+// Define the parameters to execute segments of a QGEMM operation on worker
+// threads.
+//
+
+struct MLAS_QGEMM_WORK_BLOCK {
+    size_t M;
+    size_t N;
+    size_t K;
+    const uint8_t* A;
+    size_t lda;
+    uint8_t offa;
+    const uint8_t* B;
+    size_t ldb;
+    uint8_t offb;
+    bool BIsSigned;
+    const int16_t* PackedB;
+    int32_t* C;
+    size_t ldc;
+    const MLAS_QGEMM_REQUANTIZE_PARAMETERS* Requantize;
+    int32_t ThreadCountM;
+    int32_t ThreadCountN;
+};
+
+void
+MlasQgemmCopyPackA(
+    int32_t* D,
+    const uint8_t* A,
+    size_t lda,
+    size_t CountM,
+    size_t CountK,
+    uint8_t offa
+    )
+/*++
+
+Routine Description:
+
+    This routine copies elements from the source matrix to the destination
+    packed buffer. Each element is widened to a 16-bit value after
+    subtracting the zero point and pairs of elements along the K dimension
+    are stored as a 32-bit value, with the first element in the low half.
+
+Arguments:
+
+    D - Supplies the address of the destination packed buffer.
+
+    A - Supplies the address of the source matrix.
+
+    lda - Supplies the number of elements per row of the source matrix.
+
+    CountM - Supplies the number of rows of the source matrix to copy.
+
+    CountK - Supplies the number of columns of the source matrix to copy.
+
+    offa - Supplies the zero point of the source matrix.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t PairCountK = (CountK + 1) / 2;
+
+#if defined(MLAS_SSE2_INTRINSICS)
+    const __m128i ZeroVector = _mm_setzero_si128();
+    const __m128i OffsetVector = _mm_set1_epi16(int16_t(offa));
+#endif
+
+    while (CountM-- > 0) {
+
+        const uint8_t* a = A;
+        int32_t* d = D;
+        size_t k = CountK;
+
+#if defined(MLAS_SSE2_INTRINSICS)
+
+        //
+        // The packed pairs have the same layout in memory as the 16-bit
+        // values in order, so convert 16 columns at a time.
+        //
+
+        while (k >= 16) {
+
+            __m128i Bytes = _mm_loadu_si128((const __m128i*)a);
+
+            __m128i Words0 = _mm_sub_epi16(_mm_unpacklo_epi8(Bytes, ZeroVector), OffsetVector);
+            __m128i Words1 = _mm_sub_epi16(_mm_unpackhi_epi8(Bytes, ZeroVector), OffsetVector);
+
+            _mm_storeu_si128((__m128i*)&d[0], Words0);
+            _mm_storeu_si128((__m128i*)&d[4], Words1);
+
+            a += 16;
+            d += 8;
+            k -= 16;
+        }
+
+#endif
+
+        while (k >= 2) {
+
+            uint16_t Element0 = uint16_t(int16_t(a[0]) - int16_t(offa));
+            uint16_t Element1 = uint16_t(int16_t(a[1]) - int16_t(offa));
+
+            *d++ = int32_t(uint32_t(Element0) | (uint32_t(Element1) << 16));
+
+            a += 2;
+            k -= 2;
+        }
+
+        if (k > 0) {
+            *d = int32_t(uint16_t(int16_t(a[0]) - int16_t(offa)));
+        }
+
+        A += lda;
+        D += PairCountK;
+    }
+}
+
+void
+MlasQgemmCopyPackB(
+    int16_t* D,
+    const uint8_t* B,
+    size_t ldb,
+    size_t CountN,
+    size_t CountK,
+    uint8_t offb,
+    bool BIsSigned
+    )
+/*++
+
+Routine Description:
+
+    This routine copies elements from the source matrix to the destination
+    packed buffer.
+
+    Columns of 16 elements from the source matrix are unrolled to be
+    physically contiguous for better locality inside the QGEMM kernels. Each
+    pair of rows is interleaved, so that every column stores the 16-bit
+    values of two consecutive rows next to each other. Any partial pair of
+    rows or block of 16 columns is padded with zeroes.
+
+Arguments:
+
+    D - Supplies the address of the destination packed buffer.
+
+    B - Supplies the address of the source matrix.
+
+    ldb - Supplies the number of elements per row of the source matrix.
+
+    CountN - Supplies the number of columns of the source matrix to copy.
+
+    CountK - Supplies the number of rows of the source matrix to copy.
+
+    offb - Supplies the zero point of the source matrix.
+
+    BIsSigned - Supplies true if the source matrix and zero point are signed.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    //
+    // Signed values are biased to unsigned values by flipping the sign bit,
+    // which preserves the difference between an element and the zero point.
+    //
+
+    const uint8_t BitFlip = BIsSigned ? 0x80 : 0x00;
+    const int16_t Offset = int16_t(uint8_t(offb ^ BitFlip));
+
+#if defined(MLAS_SSE2_INTRINSICS)
+    const __m128i ZeroVector = _mm_setzero_si128();
+    const __m128i BitFlipVector = _mm_set1_epi8(char(BitFlip));
+    const __m128i OffsetVector = _mm_set1_epi16(Offset);
+#endif
+
+    while (CountN > 0) {
+
+        const uint8_t* b = B;
+        size_t k = CountK;
+
+#if defined(MLAS_SSE2_INTRINSICS)
+
+        if (CountN >= 16) {
+
+            while (k >= 2) {
+
+                __m128i Row0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)&b[0]), BitFlipVector);
+                __m128i Row1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)&b[ldb]), BitFlipVector);
+
+                __m128i Interleaved0 = _mm_unpacklo_epi8(Row0, Row1);
+                __m128i Interleaved1 = _mm_unpackhi_epi8(Row0, Row1);
+
+                _mm_storeu_si128((__m128i*)&D[0], _mm_sub_epi16(_mm_unpacklo_epi8(Interleaved0, ZeroVector), OffsetVector));
+                _mm_storeu_si128((__m128i*)&D[8], _mm_sub_epi16(_mm_unpackhi_epi8(Interleaved0, ZeroVector), OffsetVector));
+                _mm_storeu_si128((__m128i*)&D[16], _mm_sub_epi16(_mm_unpacklo_epi8(Interleaved1, ZeroVector), OffsetVector));
+                _mm_storeu_si128((__m128i*)&D[24], _mm_sub_epi16(_mm_unpackhi_epi8(Interleaved1, ZeroVector), OffsetVector));
+
+                D += 32;
+                b += ldb * 2;
+                k -= 2;
+            }
+        }
+
+#endif
+
+        size_t CountX = std::min(CountN, size_t(16));
+
+        while (k > 0) {
+
+            size_t CountY = std::min(k, size_t(2));
+
+            for (size_t x = 0; x < 16; x++) {
+
+                for (size_t y = 0; y < 2; y++) {
+
+                    int16_t Element = 0;
+
+                    if (x < CountX && y < CountY) {
+                        Element = int16_t(uint8_t(b[y * ldb + x] ^ BitFlip)) - Offset;
+                    }
+
+                    D[x * 2 + y] = Element;
+                }
+            }
+
+            D += 32;
+            b += ldb * CountY;
+            k -= CountY;
+        }
+
+        B += 16;
+        CountN -= CountX;
+    }
+}
+
+#if !defined(MLAS_SSE2_INTRINSICS)
+
+size_t
+MLASCALL
+MlasQgemmKernel(
+    const int32_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine is an inner kernel to compute matrix multiplication for a
+    set of rows.
+
+Arguments:
+
+    A - Supplies the address of matrix A. The matrix data has been packed
+        using MlasQgemmCopyPackA.
+
+    B - Supplies the address of matrix B. The matrix data has been packed
+        using MlasQgemmCopyPackB.
+
+    C - Supplies the address of matrix C.
+
+    PairCountK - Supplies the number of pairs of columns from matrix A and
+        the number of pairs of rows from matrix B to iterate over.
+
+    CountM - Supplies the maximum number of rows that can be processed for
+        matrix A and matrix C. The actual number of rows handled for this
+        invocation depends on the kernel implementation.
+
+    CountN - Supplies the number of columns from matrix B and matrix C to
+        iterate over.
+
+    lda - Supplies the number of packed pairs per row of matrix A.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ZeroMode - Supplies true if the output matrix must be zero initialized,
+        else false if the output matrix is accumulated into.
+
+Return Value:
+
+    Returns the number of rows handled.
+
+--*/
+{
+    MLAS_UNREFERENCED_PARAMETER(CountM);
+    MLAS_UNREFERENCED_PARAMETER(lda);
+    MLAS_UNREFERENCED_PARAMETER(ldc);
+
+    while (CountN > 0) {
+
+        int32_t Accumulators[16] = { 0 };
+
+        const int16_t* b = B;
+
+        for (size_t k = 0; k < PairCountK; k++) {
+
+            int32_t PairA = A[k];
+            int32_t Element0 = int16_t(uint16_t(uint32_t(PairA)));
+            int32_t Element1 = int16_t(uint16_t(uint32_t(PairA) >> 16));
+
+            for (size_t n = 0; n < 16; n++) {
+                Accumulators[n] += Element0 * b[n * 2] + Element1 * b[n * 2 + 1];
+            }
+
+            b += 32;
+        }
+
+        size_t CountX = std::min(CountN, size_t(16));
+
+        for (size_t n = 0; n < CountX; n++) {
+            C[n] = ZeroMode ? Accumulators[n] : C[n] + Accumulators[n];
+        }
+
+        B += PairCountK * 32;
+        C += CountX;
+        CountN -= CountX;
+    }
+
+    return 1;
+}
+
+#else
+
+template<size_t RowCount>
+inline
+void
+MlasQgemmKernelSse2Block(
+    const int32_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine computes a block of up to 16 columns for RowCount rows of
+    matrix C.
+
+Arguments:
+
+    See MlasQgemmKernel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    __m128i Accumulators[RowCount][4];
+
+    for (size_t r = 0; r < RowCount; r++) {
+        for (size_t i = 0; i < 4; i++) {
+            Accumulators[r][i] = _mm_setzero_si128();
+        }
+    }
+
+    for (size_t k = 0; k < PairCountK; k++) {
+
+        __m128i BElements0 = _mm_loadu_si128((const __m128i*)&B[0]);
+        __m128i BElements1 = _mm_loadu_si128((const __m128i*)&B[8]);
+        __m128i BElements2 = _mm_loadu_si128((const __m128i*)&B[16]);
+        __m128i BElements3 = _mm_loadu_si128((const __m128i*)&B[24]);
+
+        for (size_t r = 0; r < RowCount; r++) {
+
+            __m128i ABroadcast = _mm_set1_epi32(A[r * lda + k]);
+
+            Accumulators[r][0] = _mm_add_epi32(Accumulators[r][0], _mm_madd_epi16(ABroadcast, BElements0));
+            Accumulators[r][1] = _mm_add_epi32(Accumulators[r][1], _mm_madd_epi16(ABroadcast, BElements1));
+            Accumulators[r][2] = _mm_add_epi32(Accumulators[r][2], _mm_madd_epi16(ABroadcast, BElements2));
+            Accumulators[r][3] = _mm_add_epi32(Accumulators[r][3], _mm_madd_epi16(ABroadcast, BElements3));
+        }
+
+        B += 32;
+    }
+
+    for (size_t r = 0; r < RowCount; r++) {
+
+        int32_t* c = C + r * ldc;
+
+        if (CountN >= 16) {
+
+            for (size_t i = 0; i < 4; i++) {
+
+                __m128i Value = Accumulators[r][i];
+
+                if (!ZeroMode) {
+                    Value = _mm_add_epi32(Value, _mm_loadu_si128((const __m128i*)&c[i * 4]));
+                }
+
+                _mm_storeu_si128((__m128i*)&c[i * 4], Value);
+            }
+
+        } else {
+
+            MLAS_DECLSPEC_ALIGN(int32_t Buffer[16], 16);
+
+            for (size_t i = 0; i < 4; i++) {
+                _mm_store_si128((__m128i*)&Buffer[i * 4], Accumulators[r][i]);
+            }
+
+            for (size_t n = 0; n < CountN; n++) {
+                c[n] = ZeroMode ? Buffer[n] : c[n] + Buffer[n];
+            }
+        }
+    }
+}
+
+size_t
+MLASCALL
+MlasQgemmKernel(
+    const int32_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine is an inner kernel to compute matrix multiplication for a
+    set of rows.
+
+Arguments:
+
+    A - Supplies the address of matrix A. The matrix data has been packed
+        using MlasQgemmCopyPackA.
+
+    B - Supplies the address of matrix B. The matrix data has been packed
+        using MlasQgemmCopyPackB.
+
+    C - Supplies the address of matrix C.
+
+    PairCountK - Supplies the number of pairs of columns from matrix A and
+        the number of pairs of rows from matrix B to iterate over.
+
+    CountM - Supplies the maximum number of rows that can be processed for
+        matrix A and matrix C. The actual number of rows handled for this
+        invocation depends on the kernel implementation.
+
+    CountN - Supplies the number of columns from matrix B and matrix C to
+        iterate over.
+
+    lda - Supplies the number of packed pairs per row of matrix A.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ZeroMode - Supplies true if the output matrix must be zero initialized,
+        else false if the output matrix is accumulated into.
+
+Return Value:
+
+    Returns the number of rows handled.
+
+--*/
+{
+    size_t RowsHandled = (CountM >= 2) ? 2 : 1;
+
+    while (CountN > 0) {
+
+        size_t CountX = std::min(CountN, size_t(16));
+
+        if (RowsHandled == 2) {
+            MlasQgemmKernelSse2Block<2>(A, B, C, PairCountK, CountX, lda, ldc, ZeroMode);
+        } else {
+            MlasQgemmKernelSse2Block<1>(A, B, C, PairCountK, CountX, lda, ldc, ZeroMode);
+        }
+
+        B += PairCountK * 32;
+        C += CountX;
+        CountN -= CountX;
+    }
+
+    return RowsHandled;
+}
+
+#endif
+
+void
+MlasQgemmRequantizeOutput(
+    const int32_t* C,
+    size_t ldc,
+    uint8_t* Output,
+    size_t ldo,
+    const int32_t* Bias,
+    size_t CountM,
+    size_t CountN,
+    float Scale,
+    uint8_t ZeroPoint
+    )
+/*++
+
+Routine Description:
+
+    This routine converts a block of the 32-bit output matrix to unsigned
+    8-bit values by adding the optional bias, scaling, rounding to the
+    nearest even value, adding the zero point and saturating.
+
+Arguments:
+
+    C - Supplies the address of the 32-bit output matrix.
+
+    ldc - Supplies the first dimension of the 32-bit output matrix.
+
+    Output - Supplies the address of the 8-bit output matrix.
+
+    ldo - Supplies the first dimension of the 8-bit output matrix.
+
+    Bias - Optionally supplies the address of one bias value per row.
+
+    CountM - Supplies the number of rows to convert.
+
+    CountN - Supplies the number of columns to convert.
+
+    Scale - Supplies the scale to apply.
+
+    ZeroPoint - Supplies the zero point of the 8-bit output matrix.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    //
+    // Clamp before the conversion to integer so that the values cannot
+    // overflow.
+    //
+
+    const float MinimumValue = float(0 - int32_t(ZeroPoint));
+    const float MaximumValue = float(255 - int32_t(ZeroPoint));
+
+#if defined(MLAS_SSE2_INTRINSICS)
+    const __m128 ScaleVector = _mm_set1_ps(Scale);
+    const __m128 MinimumVector = _mm_set1_ps(MinimumValue);
+    const __m128 MaximumVector = _mm_set1_ps(MaximumValue);
+    const __m128i ZeroPointVector = _mm_set1_epi32(ZeroPoint);
+#endif
+
+    for (size_t m = 0; m < CountM; m++) {
+
+        const int32_t BiasValue = (Bias != nullptr) ? Bias[m] : 0;
+
+        const int32_t* c = C;
+        uint8_t* o = Output;
+        size_t n = CountN;
+
+#if defined(MLAS_SSE2_INTRINSICS)
+
+        const __m128i BiasVector = _mm_set1_epi32(BiasValue);
+
+        while (n >= 16) {
+
+            __m128i Values[4];
+
+            for (size_t i = 0; i < 4; i++) {
+
+                __m128 FloatValue = _mm_cvtepi32_ps(_mm_add_epi32(_mm_loadu_si128((const __m128i*)&c[i * 4]), BiasVector));
+
+                FloatValue = _mm_mul_ps(FloatValue, ScaleVector);
+                FloatValue = _mm_min_ps(_mm_max_ps(FloatValue, MinimumVector), MaximumVector);
+
+                Values[i] = _mm_add_epi32(_mm_cvtps_epi32(FloatValue), ZeroPointVector);
+            }
+
+            __m128i Packed0 = _mm_packs_epi32(Values[0], Values[1]);
+            __m128i Packed1 = _mm_packs_epi32(Values[2], Values[3]);
+
+            _mm_storeu_si128((__m128i*)o, _mm_packus_epi16(Packed0, Packed1));
+
+            c += 16;
+            o += 16;
+            n -= 16;
+        }
+
+#endif
+
+        while (n > 0) {
+
+            float FloatValue = float(*c++ + BiasValue) * Scale;
+
+            FloatValue = std::min(std::max(FloatValue, MinimumValue), MaximumValue);
+
+            *o++ = uint8_t(int32_t(std::nearbyint(FloatValue)) + int32_t(ZeroPoint));
+
+            n -= 1;
+        }
+
+        C += ldc;
+        Output += ldo;
+    }
+}
+
+void
+MlasQgemmOperation(
+    const MLAS_QGEMM_WORK_BLOCK* WorkBlock,
+    size_t RangeStartM,
+    size_t RangeCountM,
+    size_t RangeStartN,
+    size_t RangeCountN
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation (QGEMM) for a range of rows and columns of matrix C.
+
+Arguments:
+
+    WorkBlock - Supplies the structure containing the QGEMM parameters.
+
+    RangeStartM - Supplies the starting row of the range.
+
+    RangeCountM - Supplies the number of rows of the range.
+
+    RangeStartN - Supplies the starting column of the range. If matrix B is
+        packed, this must be a multiple of 16.
+
+    RangeCountN - Supplies the number of columns of the range.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_DECLSPEC_ALIGN(int32_t PanelA[MLAS_QGEMM_STRIDEM * MLAS_QGEMM_STRIDEK / 2], 64);
+    MLAS_DECLSPEC_ALIGN(int16_t PanelB[MLAS_QGEMM_STRIDEN * MLAS_QGEMM_STRIDEK], 64);
+
+#if defined(MLAS_TARGET_AMD64)
+    PMLAS_QGEMM_KERNEL_ROUTINE KernelRoutine = MlasPlatform.QgemmKernelRoutine;
+#else
+    PMLAS_QGEMM_KERNEL_ROUTINE KernelRoutine = MlasQgemmKernel;
+#endif
+
+    const size_t K = WorkBlock->K;
+    const size_t lda = WorkBlock->lda;
+    const size_t ldb = WorkBlock->ldb;
+    const size_t ldc = WorkBlock->ldc;
+    const size_t AlignedN = (WorkBlock->N + 15) & ~size_t(15);
+
+    const uint8_t* A = WorkBlock->A + RangeStartM * lda;
+    int32_t* C = WorkBlock->C + RangeStartM * ldc + RangeStartN;
+
+    //
+    // Step through each slice of matrix B along the N dimension.
+    //
+
+    size_t CountN;
+
+    for (size_t n = 0; n < RangeCountN; n += CountN) {
+
+        CountN = std::min(RangeCountN - n, size_t(MLAS_QGEMM_STRIDEN));
+
+        if (K == 0) {
+
+            for (size_t m = 0; m < RangeCountM; m++) {
+                std::fill_n(C + m * ldc + n, CountN, 0);
+            }
+        }
+
+        //
+        // Step through each slice of matrix B along the K dimension.
+        //
+
+        size_t CountK;
+
+        for (size_t k = 0; k < K; k += CountK) {
+
+            CountK = std::min(K - k, size_t(MLAS_QGEMM_STRIDEK));
+
+            const size_t PairCountK = (CountK + 1) / 2;
+
+            //
+            // Every slice except the last one holds MLAS_QGEMM_STRIDEK rows,
+            // so the packed slice for row k starts at k * AlignedN.
+            //
+
+            const int16_t* b;
+
+            if (WorkBlock->PackedB != nullptr) {
+                b = WorkBlock->PackedB + k * AlignedN + (RangeStartN + n) * PairCountK * 2;
+            } else {
+                MlasQgemmCopyPackB(PanelB, WorkBlock->B + k * ldb + RangeStartN + n, ldb,
+                    CountN, CountK, WorkBlock->offb, WorkBlock->BIsSigned);
+                b = PanelB;
+            }
+
+            //
+            // Step through each slice of matrix A along the M dimension.
+            //
+
+            size_t CountM;
+
+            for (size_t m = 0; m < RangeCountM; m += CountM) {
+
+                CountM = std::min(RangeCountM - m, size_t(MLAS_QGEMM_STRIDEM));
+
+                MlasQgemmCopyPackA(PanelA, A + m * lda + k, lda, CountM, CountK, WorkBlock->offa);
+
+                const int32_t* a = PanelA;
+                int32_t* c = C + m * ldc + n;
+                size_t RowsRemaining = CountM;
+
+                while (RowsRemaining > 0) {
+
+                    size_t RowsHandled = KernelRoutine(a, b, c, PairCountK,
+                        RowsRemaining, CountN, PairCountK, ldc, k == 0);
+
+                    a += RowsHandled * PairCountK;
+                    c += RowsHandled * ldc;
+                    RowsRemaining -= RowsHandled;
+                }
+            }
+        }
+
+        //
+        // Requantize the slice of matrix C while it is still in the cache.
+        //
+
+        const MLAS_QGEMM_REQUANTIZE_PARAMETERS* Requantize = WorkBlock->Requantize;
+
+        if (Requantize != nullptr) {
+
+            const int32_t* Bias = Requantize->Bias;
+
+            if (Bias != nullptr) {
+                Bias += RangeStartM;
+            }
+
+            MlasQgemmRequantizeOutput(C + n, ldc,
+                Requantize->Output + RangeStartM * Requantize->ldo + RangeStartN + n,
+                Requantize->ldo, Bias, RangeCountM, CountN, Requantize->Scale,
+                Requantize->ZeroPoint);
+        }
+    }
+}
+
+inline
+void
+MlasQgemmPartitionWork(
+    int32_t Index,
+    int32_t Count,
+    size_t TotalWork,
+    size_t* WorkIndex,
+    size_t* WorkRemaining
+    )
+/*++
+
+Routine Description:
+
+    This routine divides the total work evenly between Count partitions and
+    returns the range of work for the partition with the specified index.
+
+Arguments:
+
+    Index - Supplies the index of the partition.
+
+    Count - Supplies the number of partitions.
+
+    TotalWork - Supplies the total amount of work.
+
+    WorkIndex - Receives the index of the first unit of work of the
+        partition.
+
+    WorkRemaining - Receives the number of units of work of the partition.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t WorkPerPartition = TotalWork / size_t(Count);
+    const size_t WorkPerPartitionExtra = TotalWork % size_t(Count);
+
+    if (size_t(Index) < WorkPerPartitionExtra) {
+        *WorkIndex = (WorkPerPartition + 1) * size_t(Index);
+        *WorkRemaining = WorkPerPartition + 1;
+    } else {
+        *WorkIndex = WorkPerPartition * size_t(Index) + WorkPerPartitionExtra;
+        *WorkRemaining = WorkPerPartition;
+    }
+}
+
+void
+MlasQgemmOperationThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    QGEMM operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_QGEMM_WORK_BLOCK* WorkBlock = (const MLAS_QGEMM_WORK_BLOCK*)Context;
+
+    const int32_t IndexM = Index / WorkBlock->ThreadCountN;
+    const int32_t IndexN = Index % WorkBlock->ThreadCountN;
+
+    size_t RangeStartM;
+    size_t RangeCountM;
+
+    MlasQgemmPartitionWork(IndexM, WorkBlock->ThreadCountM, WorkBlock->M,
+        &RangeStartM, &RangeCountM);
+
+    //
+    // Partition the columns in blocks of 16 so that each segment starts at a
+    // column panel of a packed matrix B.
+    //
+
+    const size_t BlockedN = (WorkBlock->N + 15) / 16;
+
+    size_t RangeStartN;
+    size_t RangeCountN;
+
+    MlasQgemmPartitionWork(IndexN, WorkBlock->ThreadCountN, BlockedN,
+        &RangeStartN, &RangeCountN);
+
+    RangeStartN *= 16;
+    RangeCountN = std::min(WorkBlock->N - RangeStartN, RangeCountN * 16);
+
+    MlasQgemmOperation(WorkBlock, RangeStartM, RangeCountM, RangeStartN, RangeCountN);
+}
+
+void
+MlasQgemmSchedule(
+    MLAS_QGEMM_WORK_BLOCK* WorkBlock
+    )
+/*++
+
+Routine Description:
+
+    This routine segments a QGEMM operation across the threads allowed by
+    its complexity and executes it.
+
+Arguments:
+
+    WorkBlock - Supplies the structure containing the QGEMM parameters. The
+        thread counts are filled in by this routine.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t M = WorkBlock->M;
+    const size_t N = WorkBlock->N;
+
+    if (M == 0 || N == 0) {
+        return;
+    }
+
+    //
+    // Compute the number of target threads given the complexity of the QGEMM
+    // operation. Small requests should run using the single threaded path.
+    //
+
+    double Complexity = double(M) * double(N) * double(WorkBlock->K);
+
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_QGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_QGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    //
+    // Segment the operation along the larger dimension of matrix C.
+    //
+
+    const size_t BlockedN = (N + 15) / 16;
+
+    if (N > M) {
+        WorkBlock->ThreadCountM = 1;
+        WorkBlock->ThreadCountN = int32_t(std::min(size_t(TargetThreadCount), BlockedN));
+    } else {
+        WorkBlock->ThreadCountM = int32_t(std::min(size_t(TargetThreadCount), M));
+        WorkBlock->ThreadCountN = 1;
+    }
+
+    MlasExecuteThreaded(MlasQgemmOperationThreaded, WorkBlock,
+        WorkBlock->ThreadCountM * WorkBlock->ThreadCountN);
+}
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    bool BIsSigned,
+    int32_t* C,
+    size_t ldc,
+    const MLAS_QGEMM_REQUANTIZE_PARAMETERS* Requantize
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation (QGEMM).
+
+Arguments:
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    offa - Supplies the zero point of matrix A.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    offb - Supplies the zero point of matrix B.
+
+    BIsSigned - Supplies true if matrix B and its zero point are signed.
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    Requantize - Optionally supplies the parameters to convert matrix C to
+        unsigned 8-bit values.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_QGEMM_WORK_BLOCK WorkBlock;
+
+    WorkBlock.M = M;
+    WorkBlock.N = N;
+    WorkBlock.K = K;
+    WorkBlock.A = A;
+    WorkBlock.lda = lda;
+    WorkBlock.offa = offa;
+    WorkBlock.B = B;
+    WorkBlock.ldb = ldb;
+    WorkBlock.offb = offb;
+    WorkBlock.BIsSigned = BIsSigned;
+    WorkBlock.PackedB = nullptr;
+    WorkBlock.C = C;
+    WorkBlock.ldc = ldc;
+    WorkBlock.Requantize = Requantize;
+
+    MlasQgemmSchedule(&WorkBlock);
+}
+
+size_t
+MLASCALL
+MlasQgemmPackBSize(
+    size_t N,
+    size_t K
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the number of bytes of the buffer required to pack
+    matrix B with MlasQgemmPackB.
+
+Arguments:
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+Return Value:
+
+    Returns the size of the buffer in bytes.
+
+--*/
+{
+    const size_t AlignedN = (N + 15) & ~size_t(15);
+    const size_t AlignedK = (K + 1) & ~size_t(1);
+
+    return AlignedN * AlignedK * sizeof(int16_t);
+}
+
+void
+MLASCALL
+MlasQgemmPackB(
+    size_t N,
+    size_t K,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    bool BIsSigned,
+    void* PackedB
+    )
+/*++
+
+Routine Description:
+
+    This routine packs matrix B for use by MlasQgemmPacked.
+
+    The matrix is packed in slices of MLAS_QGEMM_STRIDEK rows. Each slice
+    holds all of the columns in the layout produced by MlasQgemmCopyPackB, so
+    that an operation can be split at any column that is a multiple of 16.
+
+Arguments:
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    offb - Supplies the zero point of matrix B.
+
+    BIsSigned - Supplies true if matrix B and its zero point are signed.
+
+    PackedB - Supplies the address of the buffer to receive the packed
+        matrix. The buffer must be at least MlasQgemmPackBSize bytes.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedN = (N + 15) & ~size_t(15);
+
+    int16_t* D = (int16_t*)PackedB;
+
+    size_t CountK;
+
+    for (size_t k = 0; k < K; k += CountK) {
+
+        CountK = std::min(K - k, size_t(MLAS_QGEMM_STRIDEK));
+
+        MlasQgemmCopyPackB(D, B + k * ldb, ldb, N, CountK, offb, BIsSigned);
+
+        D += AlignedN * ((CountK + 1) & ~size_t(1));
+    }
+}
+
+void
+MLASCALL
+MlasQgemmPacked(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const void* PackedB,
+    int32_t* C,
+    size_t ldc,
+    const MLAS_QGEMM_REQUANTIZE_PARAMETERS* Requantize
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation (QGEMM) with a matrix B packed by MlasQgemmPackB.
+
+Arguments:
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    offa - Supplies the zero point of matrix A.
+
+    PackedB - Supplies the address of the packed matrix B.
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    Requantize - Optionally supplies the parameters to convert matrix C to
+        unsigned 8-bit values.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_QGEMM_WORK_BLOCK WorkBlock;
+
+    WorkBlock.M = M;
+    WorkBlock.N = N;
+    WorkBlock.K = K;
+    WorkBlock.A = A;
+    WorkBlock.lda = lda;
+    WorkBlock.offa = offa;
+    WorkBlock.B = nullptr;
+    WorkBlock.ldb = 0;
+    WorkBlock.offb = 0;
+    WorkBlock.BIsSigned = false;
+    WorkBlock.PackedB = (const int16_t*)PackedB;
+    WorkBlock.C = C;
+    WorkBlock.ldc = ldc;
+    WorkBlock.Requantize = Requantize;
+
+    MlasQgemmSchedule(&WorkBlock);
+}
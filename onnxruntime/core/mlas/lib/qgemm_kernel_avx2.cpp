@@ -0,0 +1,185 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    qgemm_kernel_avx2.cpp
+
+Abstract:
+
+    This module implements the kernel for the quantized integer matrix/matrix
+    multiply operation (QGEMM) using AVX2 instructions.
+
+--*/
+
+#include "mlasi.h"
+
+template<size_t RowCount>
+inline
+void
+MlasQgemmKernelAvx2Block(
+    const int32_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine computes a block of up to 16 columns for RowCount rows of
+    matrix C.
+
+Arguments:
+
+    See MlasQgemmKernelAvx2.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    __m256i Accumulators[RowCount][2];
+
+    for (size_t r = 0; r < RowCount; r++) {
+        Accumulators[r][0] = _mm256_setzero_si256();
+        Accumulators[r][1] = _mm256_setzero_si256();
+    }
+
+    for (size_t k = 0; k < PairCountK; k++) {
+
+        __m256i BElements0 = _mm256_loadu_si256((const __m256i*)&B[0]);
+        __m256i BElements1 = _mm256_loadu_si256((const __m256i*)&B[16]);
+
+        for (size_t r = 0; r < RowCount; r++) {
+
+            __m256i ABroadcast = _mm256_set1_epi32(A[r * lda + k]);
+
+            Accumulators[r][0] = _mm256_add_epi32(Accumulators[r][0], _mm256_madd_epi16(ABroadcast, BElements0));
+            Accumulators[r][1] = _mm256_add_epi32(Accumulators[r][1], _mm256_madd_epi16(ABroadcast, BElements1));
+        }
+
+        B += 32;
+    }
+
+    for (size_t r = 0; r < RowCount; r++) {
+
+        int32_t* c = C + r * ldc;
+
+        if (CountN >= 16) {
+
+            __m256i Value0 = Accumulators[r][0];
+            __m256i Value1 = Accumulators[r][1];
+
+            if (!ZeroMode) {
+                Value0 = _mm256_add_epi32(Value0, _mm256_loadu_si256((const __m256i*)&c[0]));
+                Value1 = _mm256_add_epi32(Value1, _mm256_loadu_si256((const __m256i*)&c[8]));
+            }
+
+            _mm256_storeu_si256((__m256i*)&c[0], Value0);
+            _mm256_storeu_si256((__m256i*)&c[8], Value1);
+
+        } else {
+
+            MLAS_DECLSPEC_ALIGN(int32_t Buffer[16], 32);
+
+            _mm256_store_si256((__m256i*)&Buffer[0], Accumulators[r][0]);
+            _mm256_store_si256((__m256i*)&Buffer[8], Accumulators[r][1]);
+
+            for (size_t n = 0; n < CountN; n++) {
+                c[n] = ZeroMode ? Buffer[n] : c[n] + Buffer[n];
+            }
+        }
+    }
+}
+
+size_t
+MLASCALL
+MlasQgemmKernelAvx2(
+    const int32_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine is an inner kernel to compute matrix multiplication for a
+    set of rows.
+
+Arguments:
+
+    A - Supplies the address of matrix A. The matrix data has been packed
+        using MlasQgemmCopyPackA.
+
+    B - Supplies the address of matrix B. The matrix data has been packed
+        using MlasQgemmCopyPackB.
+
+    C - Supplies the address of matrix C.
+
+    PairCountK - Supplies the number of pairs of columns from matrix A and
+        the number of pairs of rows from matrix B to iterate over.
+
+    CountM - Supplies the maximum number of rows that can be processed for
+        matrix A and matrix C. The actual number of rows handled for this
+        invocation depends on the kernel implementation.
+
+    CountN - Supplies the number of columns from matrix B and matrix C to
+        iterate over.
+
+    lda - Supplies the number of packed pairs per row of matrix A.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ZeroMode - Supplies true if the output matrix must be zero initialized,
+        else false if the output matrix is accumulated into.
+
+Return Value:
+
+    Returns the number of rows handled.
+
+--*/
+{
+    size_t RowsHandled;
+
+    if (CountM >= 4) {
+        RowsHandled = 4;
+    } else if (CountM >= 2) {
+        RowsHandled = 2;
+    } else {
+        RowsHandled = 1;
+    }
+
+    while (CountN > 0) {
+
+        size_t CountX = std::min(CountN, size_t(16));
+
+        if (RowsHandled == 4) {
+            MlasQgemmKernelAvx2Block<4>(A, B, C, PairCountK, CountX, lda, ldc, ZeroMode);
+        } else if (RowsHandled == 2) {
+            MlasQgemmKernelAvx2Block<2>(A, B, C, PairCountK, CountX, lda, ldc, ZeroMode);
+        } else {
+            MlasQgemmKernelAvx2Block<1>(A, B, C, PairCountK, CountX, lda, ldc, ZeroMode);
+        }
+
+        B += PairCountK * 32;
+        C += CountX;
+        CountN -= CountX;
+    }
+
+    return RowsHandled;
+}
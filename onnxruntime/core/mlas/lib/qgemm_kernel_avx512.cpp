@@ -0,0 +1,316 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    qgemm_kernel_avx512.cpp
+
+Abstract:
+
+    This module implements the kernels for the quantized integer matrix/matrix
+    multiply operation (QGEMM) using AVX512BW and AVX512_VNNI instructions.
+
+    The AVX512_VNNI kernel uses VPDPWSSD to fuse the multiply of the 16-bit
+    pairs with the accumulation. If the compiler does not support the
+    AVX512_VNNI intrinsics, the AVX512BW kernel is used in its place.
+
+--*/
+
+#include "mlasi.h"
+
+#if defined(__AVX512VNNI__) || (defined(_MSC_VER) && (_MSC_VER >= 1920))
+#define MLAS_AVX512VNNI_INTRINSICS
+#endif
+
+template<bool UseVnni>
+inline
+__m512i
+MlasQgemmMultiplyAddAvx512(
+    __m512i Accumulator,
+    __m512i ABroadcast,
+    __m512i BElements
+    );
+
+template<>
+inline
+__m512i
+MlasQgemmMultiplyAddAvx512<false>(
+    __m512i Accumulator,
+    __m512i ABroadcast,
+    __m512i BElements
+    )
+{
+    return _mm512_add_epi32(Accumulator, _mm512_madd_epi16(ABroadcast, BElements));
+}
+
+#if defined(MLAS_AVX512VNNI_INTRINSICS)
+
+template<>
+inline
+__m512i
+MlasQgemmMultiplyAddAvx512<true>(
+    __m512i Accumulator,
+    __m512i ABroadcast,
+    __m512i BElements
+    )
+{
+    return _mm512_dpwssd_epi32(Accumulator, ABroadcast, BElements);
+}
+
+#endif
+
+template<size_t RowCount, size_t PanelCount, bool UseVnni>
+inline
+void
+MlasQgemmKernelAvx512Block(
+    const int32_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine computes a block of PanelCount panels of 16 columns for
+    RowCount rows of matrix C.
+
+Arguments:
+
+    See MlasQgemmKernelAvx512BW. CountN supplies the number of valid columns
+    of the block.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    __m512i Accumulators[RowCount][PanelCount];
+
+    for (size_t r = 0; r < RowCount; r++) {
+        for (size_t p = 0; p < PanelCount; p++) {
+            Accumulators[r][p] = _mm512_setzero_si512();
+        }
+    }
+
+    const size_t PanelStride = PairCountK * 32;
+
+    for (size_t k = 0; k < PairCountK; k++) {
+
+        __m512i BElements[PanelCount];
+
+        for (size_t p = 0; p < PanelCount; p++) {
+            BElements[p] = _mm512_loadu_si512(&B[p * PanelStride]);
+        }
+
+        for (size_t r = 0; r < RowCount; r++) {
+
+            __m512i ABroadcast = _mm512_set1_epi32(A[r * lda + k]);
+
+            for (size_t p = 0; p < PanelCount; p++) {
+                Accumulators[r][p] = MlasQgemmMultiplyAddAvx512<UseVnni>(Accumulators[r][p], ABroadcast, BElements[p]);
+            }
+        }
+
+        B += 32;
+    }
+
+    for (size_t p = 0; p < PanelCount; p++) {
+
+        size_t CountX = std::min(CountN - p * 16, size_t(16));
+        __mmask16 StoreMask = __mmask16((uint32_t(1) << CountX) - 1);
+
+        for (size_t r = 0; r < RowCount; r++) {
+
+            int32_t* c = C + r * ldc + p * 16;
+            __m512i Value = Accumulators[r][p];
+
+            if (!ZeroMode) {
+                Value = _mm512_add_epi32(Value, _mm512_maskz_loadu_epi32(StoreMask, c));
+            }
+
+            _mm512_mask_storeu_epi32(c, StoreMask, Value);
+        }
+    }
+}
+
+template<size_t RowCount, bool UseVnni>
+inline
+void
+MlasQgemmKernelAvx512Rows(
+    const int32_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine computes all of the columns for RowCount rows of matrix C,
+    two panels at a time while more than one panel remains.
+
+Arguments:
+
+    See MlasQgemmKernelAvx512BW.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    while (CountN > 16) {
+
+        size_t CountX = std::min(CountN, size_t(32));
+
+        MlasQgemmKernelAvx512Block<RowCount, 2, UseVnni>(A, B, C, PairCountK, CountX, lda, ldc, ZeroMode);
+
+        B += PairCountK * 64;
+        C += CountX;
+        CountN -= CountX;
+    }
+
+    if (CountN > 0) {
+        MlasQgemmKernelAvx512Block<RowCount, 1, UseVnni>(A, B, C, PairCountK, CountN, lda, ldc, ZeroMode);
+    }
+}
+
+template<bool UseVnni>
+inline
+size_t
+MlasQgemmKernelAvx512(
+    const int32_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    bool ZeroMode
+    )
+{
+    size_t RowsHandled;
+
+    if (CountM >= 8) {
+        RowsHandled = 8;
+        MlasQgemmKernelAvx512Rows<8, UseVnni>(A, B, C, PairCountK, CountN, lda, ldc, ZeroMode);
+    } else if (CountM >= 4) {
+        RowsHandled = 4;
+        MlasQgemmKernelAvx512Rows<4, UseVnni>(A, B, C, PairCountK, CountN, lda, ldc, ZeroMode);
+    } else if (CountM >= 2) {
+        RowsHandled = 2;
+        MlasQgemmKernelAvx512Rows<2, UseVnni>(A, B, C, PairCountK, CountN, lda, ldc, ZeroMode);
+    } else {
+        RowsHandled = 1;
+        MlasQgemmKernelAvx512Rows<1, UseVnni>(A, B, C, PairCountK, CountN, lda, ldc, ZeroMode);
+    }
+
+    return RowsHandled;
+}
+
+size_t
+MLASCALL
+MlasQgemmKernelAvx512BW(
+    const int32_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine is an inner kernel to compute matrix multiplication for a
+    set of rows.
+
+Arguments:
+
+    A - Supplies the address of matrix A. The matrix data has been packed
+        using MlasQgemmCopyPackA.
+
+    B - Supplies the address of matrix B. The matrix data has been packed
+        using MlasQgemmCopyPackB.
+
+    C - Supplies the address of matrix C.
+
+    PairCountK - Supplies the number of pairs of columns from matrix A and
+        the number of pairs of rows from matrix B to iterate over.
+
+    CountM - Supplies the maximum number of rows that can be processed for
+        matrix A and matrix C. The actual number of rows handled for this
+        invocation depends on the kernel implementation.
+
+    CountN - Supplies the number of columns from matrix B and matrix C to
+        iterate over.
+
+    lda - Supplies the number of packed pairs per row of matrix A.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ZeroMode - Supplies true if the output matrix must be zero initialized,
+        else false if the output matrix is accumulated into.
+
+Return Value:
+
+    Returns the number of rows handled.
+
+--*/
+{
+    return MlasQgemmKernelAvx512<false>(A, B, C, PairCountK, CountM, CountN, lda, ldc, ZeroMode);
+}
+
+size_t
+MLASCALL
+MlasQgemmKernelAvx512Vnni(
+    const int32_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine is an inner kernel to compute matrix multiplication for a
+    set of rows.
+
+Arguments:
+
+    See MlasQgemmKernelAvx512BW.
+
+Return Value:
+
+    Returns the number of rows handled.
+
+--*/
+{
+#if defined(MLAS_AVX512VNNI_INTRINSICS)
+    return MlasQgemmKernelAvx512<true>(A, B, C, PairCountK, CountM, CountN, lda, ldc, ZeroMode);
+#else
+    return MlasQgemmKernelAvx512<false>(A, B, C, PairCountK, CountM, CountN, lda, ldc, ZeroMode);
+#endif
+}
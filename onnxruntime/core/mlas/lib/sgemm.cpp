@@ -26,6 +26,13 @@ Abstract:
 
 #define MLAS_SGEMM_TRANSA_ROWS              12
 
+//
+// Define the alignment of a buffer packed by MlasSgemmPackB. The SGEMM kernels
+// use aligned loads to read the packed panels of matrix B.
+//
+
+#define MLAS_SGEMM_PACKB_ALIGNMENT          (16 * sizeof(float))
+
 //
 // Define the parameters to execute segments of a SGEMM operation on worker
 // threads.
@@ -40,15 +47,46 @@ struct MLAS_SGEMM_WORK_BLOCK {
     size_t ldc;
     float alpha;
     float beta;
+    bool BIsPacked;
     struct SEGMENT {
         size_t M;
         size_t N;
+        size_t StartN;
         const float* A;
         const float* B;
         float* C;
     } Segments[MLAS_MAXIMUM_THREAD_COUNT];
 };
 
+//
+// Define the parameters to execute a batch of SGEMM operations on worker
+// threads. Each operation is split into TileCountM x TileCountN tiles and the
+// tiles of all the operations are distributed evenly across the threads.
+//
+
+struct MLAS_SGEMM_BATCH_WORK_BLOCK {
+    CBLAS_TRANSPOSE TransA;
+    CBLAS_TRANSPOSE TransB;
+    size_t M;
+    size_t N;
+    size_t K;
+    const float* const* A;
+    size_t lda;
+    const float* const* B;
+    size_t ldb;
+    const float* PackedB;
+    float* const* C;
+    size_t ldc;
+    float alpha;
+    float beta;
+    size_t StrideM;
+    size_t StrideN;
+    size_t TileCountM;
+    size_t TileCountN;
+    size_t TileCount;
+    int32_t ThreadCount;
+};
+
 #if defined(MLAS_TARGET_AMD64_IX86)
 
 //
@@ -772,6 +810,153 @@ Return Value:
     }
 }
 
+void
+MlasSgemmKernelLoop(
+    CBLAS_TRANSPOSE TransA,
+    const float* A,
+    size_t lda,
+    const float* PanelB,
+    float* C,
+    size_t ldc,
+    size_t M,
+    size_t CountN,
+    size_t CountK,
+    float alpha,
+    bool UseKernelZeroRoutine
+    )
+/*++
+
+Routine Description:
+
+    This routine steps through the rows of matrix A and invokes the SGEMM
+    kernel to multiply them with a packed panel of matrix B.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    A - Supplies the address of matrix A at the first column of the panel.
+
+    lda - Supplies the first dimension of matrix A.
+
+    PanelB - Supplies the address of the packed panel of matrix B.
+
+    C - Supplies the address of matrix C at the first column of the panel.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    CountN - Supplies the number of columns of the panel.
+
+    CountK - Supplies the number of rows of the panel, which is at most
+        MLAS_SGEMM_STRIDEK if matrix A is transposed.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    UseKernelZeroRoutine - Supplies true if matrix C should be overwritten,
+        else false if the product should be accumulated into matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    float PanelA[MLAS_SGEMM_TRANSA_ROWS * MLAS_SGEMM_STRIDEK];
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+    PMLAS_SGEMM_KERNEL_ROUTINE SgemmKernelRoutine =
+        UseKernelZeroRoutine ? MlasPlatform.KernelZeroRoutine : MlasPlatform.KernelAddRoutine;
+#endif
+
+    //
+    // Step through each slice of matrix A along the M dimension.
+    //
+
+    float* c = C;
+
+    size_t RowsRemaining = M;
+    size_t RowsHandled;
+
+    if (TransA == CblasNoTrans) {
+
+        const float* a = A;
+
+        //
+        // Step through the rows of matrix A.
+        //
+
+        do {
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+            RowsHandled = SgemmKernelRoutine(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+#else
+            if (UseKernelZeroRoutine) {
+                RowsHandled = MlasSgemmKernelZero(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+            } else {
+                RowsHandled = MlasSgemmKernelAdd(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+            }
+#endif
+
+            c += ldc * RowsHandled;
+            a += lda * RowsHandled;
+
+            RowsRemaining -= RowsHandled;
+
+        } while (RowsRemaining > 0);
+
+    } else {
+
+        const float* a = A;
+
+        do {
+
+            //
+            // Transpose elements from matrix A into a local buffer.
+            //
+
+            size_t RowsTransposed = RowsRemaining;
+
+            if (RowsTransposed > MLAS_SGEMM_TRANSA_ROWS) {
+                RowsTransposed = MLAS_SGEMM_TRANSA_ROWS;
+            }
+
+            RowsRemaining -= RowsTransposed;
+
+            MlasSgemmTransposeA(PanelA, a, lda, RowsTransposed, CountK);
+
+            a += RowsTransposed;
+
+            //
+            // Step through the rows of the local buffer.
+            //
+
+            const float* pa = PanelA;
+
+            do {
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+                RowsHandled = SgemmKernelRoutine(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+#else
+                if (UseKernelZeroRoutine) {
+                    RowsHandled = MlasSgemmKernelZero(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+                } else {
+                    RowsHandled = MlasSgemmKernelAdd(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+                }
+#endif
+
+                c += ldc * RowsHandled;
+                pa += CountK * RowsHandled;
+
+                RowsTransposed -= RowsHandled;
+
+            } while (RowsTransposed > 0);
+
+        } while (RowsRemaining > 0);
+    }
+}
+
 void
 MlasSgemmOperation(
     CBLAS_TRANSPOSE TransA,
@@ -830,7 +1015,6 @@ Return Value:
 
 --*/
 {
-    float PanelA[MLAS_SGEMM_TRANSA_ROWS * MLAS_SGEMM_STRIDEK];
     MLAS_DECLSPEC_ALIGN(float PanelB[MLAS_SGEMM_STRIDEN * MLAS_SGEMM_STRIDEK], 16 * sizeof(float));
 
     //
@@ -931,102 +1115,125 @@ Return Value:
                 MlasSgemmTransposePackB(PanelB, B + k + n * ldb, ldb, CountN, CountK);
             }
 
-            //
-            // Select the kernel routine to use for this panel.
-            //
+            MlasSgemmKernelLoop(TransA, (TransA == CblasNoTrans) ? A + k : A + k * lda,
+                lda, PanelB, C + n, ldc, M, CountN, CountK, alpha, (k == 0 && beta == 0.0f));
+        }
+    }
+}
+
+void
+MlasSgemmPackedOperation(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const float* PackedB,
+    size_t AlignedN,
+    size_t StartN,
+    float beta,
+    float* C,
+    size_t ldc
+    )
+/*++
 
-            bool UseKernelZeroRoutine = (k == 0 && beta == 0.0f);
+Routine Description:
 
-#if defined(MLAS_TARGET_AMD64_IX86)
-            PMLAS_SGEMM_KERNEL_ROUTINE SgemmKernelRoutine =
-                UseKernelZeroRoutine ? MlasPlatform.KernelZeroRoutine : MlasPlatform.KernelAddRoutine;
-#endif
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) for a range of columns of a matrix B that has been packed
+    by MlasSgemmPackB.
 
-            //
-            // Step through each slice of matrix A along the M dimension.
-            //
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    M - Supplies the number of rows of matrix A and matrix C.
 
-            float* c = C + n;
+    N - Supplies the number of columns of the range of matrix B and matrix C.
 
-            size_t RowsRemaining = M;
-            size_t RowsHandled;
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
 
-            if (TransA == CblasNoTrans) {
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
 
-                const float* a = A + k;
+    A - Supplies the address of matrix A.
 
-                //
-                // Step through the rows of matrix A.
-                //
+    lda - Supplies the first dimension of matrix A.
 
-                do {
+    PackedB - Supplies the address of the aligned packed matrix B.
 
-#if defined(MLAS_TARGET_AMD64_IX86)
-                    RowsHandled = SgemmKernelRoutine(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-#else
-                    if (UseKernelZeroRoutine) {
-                        RowsHandled = MlasSgemmKernelZero(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-                    } else {
-                        RowsHandled = MlasSgemmKernelAdd(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-                    }
-#endif
+    AlignedN - Supplies the number of columns of the packed matrix B.
 
-                    c += ldc * RowsHandled;
-                    a += lda * RowsHandled;
+    StartN - Supplies the first column of the range of matrix B, which must be
+        a multiple of MLAS_SGEMM_STRIDEN_THREAD_ALIGN.
 
-                    RowsRemaining -= RowsHandled;
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
 
-                } while (RowsRemaining > 0);
+    C - Supplies the address of matrix C at the first column of the range.
 
-            } else {
+    ldc - Supplies the first dimension of matrix C.
 
-                const float* a = A + k * lda;
+Return Value:
 
-                do {
+    None.
 
-                    //
-                    // Transpose elements from matrix A into a local buffer.
-                    //
+--*/
+{
+    //
+    // The K stride is fixed by the packed layout. There is no local panel
+    // buffer to fit, so only expand the N stride if K is small to keep the
+    // same cache footprint as the unpacked operation.
+    //
 
-                    size_t RowsTransposed = RowsRemaining;
+    size_t StrideN = MLAS_SGEMM_STRIDEN;
 
-                    if (RowsTransposed > MLAS_SGEMM_TRANSA_ROWS) {
-                        RowsTransposed = MLAS_SGEMM_TRANSA_ROWS;
-                    }
+    for (size_t StrideK = MLAS_SGEMM_STRIDEK; StrideK / 2 >= K; StrideK /= 2) {
+        StrideN *= 2;
+    }
 
-                    RowsRemaining -= RowsTransposed;
+    //
+    // Step through each slice of matrix B along the N dimension.
+    //
 
-                    MlasSgemmTransposeA(PanelA, a, lda, RowsTransposed, CountK);
+    size_t CountN;
+    size_t CountK;
 
-                    a += RowsTransposed;
+    for (size_t n = 0; n < N; n += CountN) {
 
-                    //
-                    // Step through the rows of the local buffer.
-                    //
+        CountN = StrideN;
 
-                    const float* pa = PanelA;
+        if (CountN > (N - n)) {
+            CountN = N - n;
+        }
 
-                    do {
+        //
+        // Multiply the output matrix by beta as needed.
+        //
 
-#if defined(MLAS_TARGET_AMD64_IX86)
-                        RowsHandled = SgemmKernelRoutine(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-#else
-                        if (UseKernelZeroRoutine) {
-                            RowsHandled = MlasSgemmKernelZero(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-                        } else {
-                            RowsHandled = MlasSgemmKernelAdd(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-                        }
-#endif
+        if (beta != 0.0f && beta != 1.0f) {
+            MlasSgemmMultiplyBeta(C + n, M, CountN, ldc, beta);
+        }
 
-                        c += ldc * RowsHandled;
-                        pa += CountK * RowsHandled;
+        //
+        // Step through each slice of matrix B along the K dimension. Each
+        // slice is packed as AlignedN columns, so the panel for this range of
+        // columns is already contiguous.
+        //
 
-                        RowsTransposed -= RowsHandled;
+        for (size_t k = 0; k < K; k += CountK) {
 
-                    } while (RowsTransposed > 0);
+            CountK = MLAS_SGEMM_STRIDEK;
 
-                } while (RowsRemaining > 0);
+            if (CountK > (K - k)) {
+                CountK = K - k;
             }
+
+            const float* PanelB = PackedB + k * AlignedN + (StartN + n) * CountK;
+
+            MlasSgemmKernelLoop(TransA, (TransA == CblasNoTrans) ? A + k : A + k * lda,
+                lda, PanelB, C + n, ldc, M, CountN, CountK, alpha, (k == 0 && beta == 0.0f));
         }
     }
 }
@@ -1059,10 +1266,17 @@ Return Value:
 
     MLAS_SGEMM_WORK_BLOCK::SEGMENT* Segment = &WorkBlock->Segments[Index];
 
-    MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, Segment->M,
-        Segment->N, WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
-        Segment->B, WorkBlock->ldb, WorkBlock->beta, Segment->C,
-        WorkBlock->ldc);
+    if (WorkBlock->BIsPacked) {
+        MlasSgemmPackedOperation(WorkBlock->TransA, Segment->M, Segment->N,
+            WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
+            Segment->B, WorkBlock->ldb, Segment->StartN, WorkBlock->beta,
+            Segment->C, WorkBlock->ldc);
+    } else {
+        MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, Segment->M,
+            Segment->N, WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
+            Segment->B, WorkBlock->ldb, WorkBlock->beta, Segment->C,
+            WorkBlock->ldc);
+    }
 }
 
 inline
@@ -1080,7 +1294,8 @@ MlasSgemmTryMultithread(
     size_t ldb,
     float beta,
     float* C,
-    size_t ldc
+    size_t ldc,
+    bool BIsPacked
     )
 /*++
 
@@ -1118,6 +1333,10 @@ Arguments:
 
     ldc - Supplies the first dimension of matrix C.
 
+    BIsPacked - Supplies true if B is the aligned buffer of a matrix packed by
+        MlasSgemmPackB, in which case ldb supplies its number of columns and
+        TransB is ignored.
+
 Return Value:
 
     Returns true if the operation was completed across multiple threads, else
@@ -1166,6 +1385,7 @@ Return Value:
     WorkBlock.ldc = ldc;
     WorkBlock.alpha = alpha;
     WorkBlock.beta = beta;
+    WorkBlock.BIsPacked = BIsPacked;
 
     //
     // Segment the operation across multiple threads.
@@ -1196,8 +1416,9 @@ Return Value:
 
             WorkBlock.Segments[Index].M = M;
             WorkBlock.Segments[Index].N = CountN;
+            WorkBlock.Segments[Index].StartN = n;
             WorkBlock.Segments[Index].A = A;
-            WorkBlock.Segments[Index].B = B + n * pldb;
+            WorkBlock.Segments[Index].B = BIsPacked ? B : B + n * pldb;
             WorkBlock.Segments[Index].C = C + n;
 
             Index++;
@@ -1223,6 +1444,7 @@ Return Value:
 
             WorkBlock.Segments[Index].M = CountM;
             WorkBlock.Segments[Index].N = N;
+            WorkBlock.Segments[Index].StartN = 0;
             WorkBlock.Segments[Index].A = A + m * plda;
             WorkBlock.Segments[Index].B = B;
             WorkBlock.Segments[Index].C = C + m * ldc;
@@ -1254,6 +1476,7 @@ Return Value:
     MLAS_UNREFERENCED_PARAMETER(beta);
     MLAS_UNREFERENCED_PARAMETER(C);
     MLAS_UNREFERENCED_PARAMETER(ldc);
+    MLAS_UNREFERENCED_PARAMETER(BIsPacked);
 
     return false;
 
@@ -1325,7 +1548,575 @@ Return Value:
     // single thread based on the GEMM parameters and system configuration.
     //
 
-    if (!MlasSgemmTryMultithread(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc)) {
+    if (!MlasSgemmTryMultithread(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, false)) {
         MlasSgemmOperation(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
     }
 }
+
+inline
+float*
+MlasSgemmAlignPackedB(
+    void* PackedB
+    )
+/*++
+
+Routine Description:
+
+    This routine aligns the address of a buffer allocated for MlasSgemmPackB
+    to the alignment required by the SGEMM kernels.
+
+Arguments:
+
+    PackedB - Supplies the address of the buffer.
+
+Return Value:
+
+    Returns the aligned address inside the buffer.
+
+--*/
+{
+    uintptr_t Address = uintptr_t(PackedB);
+
+    Address = (Address + MLAS_SGEMM_PACKB_ALIGNMENT - 1) & ~uintptr_t(MLAS_SGEMM_PACKB_ALIGNMENT - 1);
+
+    return (float*)Address;
+}
+
+size_t
+MLASCALL
+MlasSgemmPackBSize(
+    size_t N,
+    size_t K
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the number of bytes of the buffer required to pack
+    matrix B with MlasSgemmPackB.
+
+Arguments:
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+Return Value:
+
+    Returns the size of the buffer in bytes.
+
+--*/
+{
+    //
+    // Every row of matrix B is padded to a multiple of 16 columns. Reserve
+    // space to align the start of the buffer for the SGEMM kernels.
+    //
+
+    const size_t AlignedN =
+        (N + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+    return AlignedN * K * sizeof(float) + MLAS_SGEMM_PACKB_ALIGNMENT - 1;
+}
+
+void
+MLASCALL
+MlasSgemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb,
+    void* PackedB
+    )
+/*++
+
+Routine Description:
+
+    This routine packs matrix B into the panel layout used by the SGEMM
+    kernels, so that MlasSgemmPacked doesn't need to copy or transpose it on
+    every call.
+
+    Matrix B is packed in slices of MLAS_SGEMM_STRIDEK rows. Each slice holds
+    all the columns of matrix B, unrolled 16 columns at a time, so any range
+    of columns that starts at a multiple of 16 is a contiguous panel.
+
+Arguments:
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    PackedB - Supplies the address of the buffer, which must be at least
+        MlasSgemmPackBSize(N, K) bytes.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedN =
+        (N + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+    float* D = MlasSgemmAlignPackedB(PackedB);
+
+    size_t CountK;
+
+    for (size_t k = 0; k < K; k += CountK) {
+
+        CountK = MLAS_SGEMM_STRIDEK;
+
+        if (CountK > (K - k)) {
+            CountK = K - k;
+        }
+
+        if (TransB == CblasNoTrans) {
+            MlasSgemmCopyPackB(D, B + k * ldb, ldb, N, CountK);
+        } else {
+            MlasSgemmTransposePackB(D, B + k, ldb, N, CountK);
+        }
+
+        D += AlignedN * CountK;
+    }
+}
+
+void
+MLASCALL
+MlasSgemmPacked(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) with a matrix B that has been packed by MlasSgemmPackB.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    PackedB - Supplies the address of the buffer passed to MlasSgemmPackB.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedN =
+        (N + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+    const float* B = MlasSgemmAlignPackedB(const_cast<void*>(PackedB));
+
+    //
+    // Try to run the operation across multiple threads or fall back to a
+    // single thread based on the GEMM parameters and system configuration.
+    //
+
+    if (!MlasSgemmTryMultithread(TransA, CblasNoTrans, M, N, K, alpha, A, lda, B, AlignedN, beta, C, ldc, true)) {
+        MlasSgemmPackedOperation(TransA, M, N, K, alpha, A, lda, B, AlignedN, 0, beta, C, ldc);
+    }
+}
+
+void
+MlasSgemmBatchOperationThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a range of tiles
+    of a batched SGEMM operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_SGEMM_BATCH_WORK_BLOCK* WorkBlock = (MLAS_SGEMM_BATCH_WORK_BLOCK*)Context;
+
+    const size_t TileCount = WorkBlock->TileCount;
+    const size_t ThreadCount = size_t(WorkBlock->ThreadCount);
+
+    //
+    // Partition the tiles evenly across the threads.
+    //
+
+    size_t TilesPerThread = TileCount / ThreadCount;
+    size_t TilesExtra = TileCount % ThreadCount;
+    size_t TileStart;
+    size_t TileEnd;
+
+    if (size_t(Index) < TilesExtra) {
+        TileStart = (TilesPerThread + 1) * Index;
+        TileEnd = TileStart + TilesPerThread + 1;
+    } else {
+        TileStart = TilesPerThread * Index + TilesExtra;
+        TileEnd = TileStart + TilesPerThread;
+    }
+
+    const size_t TilesPerOperation = WorkBlock->TileCountM * WorkBlock->TileCountN;
+
+    const size_t plda = (WorkBlock->TransA == CblasNoTrans) ? WorkBlock->lda : 1;
+    const size_t pldb = (WorkBlock->TransB == CblasNoTrans) ? 1 : WorkBlock->ldb;
+
+    for (size_t Tile = TileStart; Tile < TileEnd; Tile++) {
+
+        const size_t Batch = Tile / TilesPerOperation;
+        const size_t TileM = (Tile % TilesPerOperation) / WorkBlock->TileCountN;
+        const size_t TileN = (Tile % TilesPerOperation) % WorkBlock->TileCountN;
+
+        const size_t m = TileM * WorkBlock->StrideM;
+        const size_t n = TileN * WorkBlock->StrideN;
+
+        size_t CountM = WorkBlock->StrideM;
+
+        if (CountM > (WorkBlock->M - m)) {
+            CountM = WorkBlock->M - m;
+        }
+
+        size_t CountN = WorkBlock->StrideN;
+
+        if (CountN > (WorkBlock->N - n)) {
+            CountN = WorkBlock->N - n;
+        }
+
+        if (WorkBlock->PackedB != nullptr) {
+            MlasSgemmPackedOperation(WorkBlock->TransA, CountM, CountN,
+                WorkBlock->K, WorkBlock->alpha, WorkBlock->A[Batch] + m * plda,
+                WorkBlock->lda, WorkBlock->PackedB, WorkBlock->ldb, n,
+                WorkBlock->beta, WorkBlock->C[Batch] + m * WorkBlock->ldc + n,
+                WorkBlock->ldc);
+        } else {
+            MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, CountM, CountN,
+                WorkBlock->K, WorkBlock->alpha, WorkBlock->A[Batch] + m * plda,
+                WorkBlock->lda, WorkBlock->B[Batch] + n * pldb, WorkBlock->ldb,
+                WorkBlock->beta, WorkBlock->C[Batch] + m * WorkBlock->ldc + n,
+                WorkBlock->ldc);
+        }
+    }
+}
+
+void
+MlasSgemmBatchOperation(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* const* A,
+    size_t lda,
+    const float* const* B,
+    size_t ldb,
+    const float* PackedB,
+    float beta,
+    float* const* C,
+    size_t ldc,
+    size_t BatchCount
+    )
+/*++
+
+Routine Description:
+
+    This routine implements a batch of single precision matrix/matrix multiply
+    operations (SGEMM) that share the same dimensions, either with a matrix B
+    per operation or with one packed matrix B shared by all the operations.
+
+Arguments:
+
+    See MlasSgemmBatch. If PackedB is not null, it supplies the aligned packed
+    matrix B used by every operation, B is ignored, and ldb supplies the
+    number of columns of the packed matrix B.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (BatchCount == 0 || M == 0 || N == 0) {
+        return;
+    }
+
+    //
+    // Compute the number of target threads given the complexity of the whole
+    // batch. Small requests run using the single threaded path.
+    //
+
+    double Complexity = double(M) * double(N) * double(K) * double(BatchCount);
+
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (TargetThreadCount == 1) {
+
+        for (size_t Batch = 0; Batch < BatchCount; Batch++) {
+            if (PackedB != nullptr) {
+                MlasSgemmPackedOperation(TransA, M, N, K, alpha, A[Batch], lda,
+                    PackedB, ldb, 0, beta, C[Batch], ldc);
+            } else {
+                MlasSgemmOperation(TransA, TransB, M, N, K, alpha, A[Batch], lda,
+                    B[Batch], ldb, beta, C[Batch], ldc);
+            }
+        }
+
+        return;
+    }
+
+    MLAS_SGEMM_BATCH_WORK_BLOCK WorkBlock;
+
+    WorkBlock.TransA = TransA;
+    WorkBlock.TransB = TransB;
+    WorkBlock.M = M;
+    WorkBlock.N = N;
+    WorkBlock.K = K;
+    WorkBlock.A = A;
+    WorkBlock.lda = lda;
+    WorkBlock.B = B;
+    WorkBlock.ldb = ldb;
+    WorkBlock.PackedB = PackedB;
+    WorkBlock.C = C;
+    WorkBlock.ldc = ldc;
+    WorkBlock.alpha = alpha;
+    WorkBlock.beta = beta;
+    WorkBlock.StrideM = M;
+    WorkBlock.StrideN = N;
+    WorkBlock.TileCountM = 1;
+    WorkBlock.TileCountN = 1;
+
+    //
+    // Split each operation into tiles if there are not enough operations to
+    // keep the threads busy.
+    //
+
+    if (BatchCount < size_t(TargetThreadCount)) {
+
+        size_t TilesPerOperation = (size_t(TargetThreadCount) + BatchCount - 1) / BatchCount;
+
+        if (N > M) {
+
+            size_t StrideN = (N + TilesPerOperation - 1) / TilesPerOperation;
+
+            StrideN =
+                (StrideN + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+            WorkBlock.StrideN = StrideN;
+            WorkBlock.TileCountN = (N + StrideN - 1) / StrideN;
+
+        } else {
+
+            size_t StrideM = (M + TilesPerOperation - 1) / TilesPerOperation;
+
+            WorkBlock.StrideM = StrideM;
+            WorkBlock.TileCountM = (M + StrideM - 1) / StrideM;
+        }
+    }
+
+    WorkBlock.TileCount = BatchCount * WorkBlock.TileCountM * WorkBlock.TileCountN;
+
+    if (size_t(TargetThreadCount) > WorkBlock.TileCount) {
+        TargetThreadCount = int32_t(WorkBlock.TileCount);
+    }
+
+    WorkBlock.ThreadCount = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasSgemmBatchOperationThreaded, &WorkBlock, TargetThreadCount);
+}
+
+void
+MLASCALL
+MlasSgemmBatch(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* const* A,
+    size_t lda,
+    const float* const* B,
+    size_t ldb,
+    float beta,
+    float* const* C,
+    size_t ldc,
+    size_t BatchCount
+    )
+/*++
+
+Routine Description:
+
+    This routine implements a batch of single precision matrix/matrix multiply
+    operations (SGEMM) that share the same dimensions.
+
+    Operations that are too small to be split across threads on their own,
+    such as the per-head products of an attention layer, are run concurrently
+    instead. Large operations are also split into tiles along the M or N
+    dimension when there are fewer operations than threads.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for the A matrices.
+
+    TransB - Supplies the transpose operation for the B matrices.
+
+    M - Supplies the number of rows of each matrix A and matrix C.
+
+    N - Supplies the number of columns of each matrix B and matrix C.
+
+    K - Supplies the number of columns of each matrix A and the number of rows
+        of each matrix B.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the addresses of the A matrices.
+
+    lda - Supplies the first dimension of the A matrices.
+
+    B - Supplies the addresses of the B matrices. The same address may be
+        supplied for several operations.
+
+    ldb - Supplies the first dimension of the B matrices.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    C - Supplies the addresses of the C matrices, which must not overlap.
+
+    ldc - Supplies the first dimension of the C matrices.
+
+    BatchCount - Supplies the number of operations.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasSgemmBatchOperation(TransA, TransB, M, N, K, alpha, A, lda, B, ldb,
+        nullptr, beta, C, ldc, BatchCount);
+}
+
+void
+MLASCALL
+MlasSgemmPackedBatch(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* const* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* const* C,
+    size_t ldc,
+    size_t BatchCount
+    )
+/*++
+
+Routine Description:
+
+    This routine implements a batch of single precision matrix/matrix multiply
+    operations (SGEMM) that share the same dimensions and the same matrix B,
+    which has been packed by MlasSgemmPackB.
+
+    The operations are run concurrently and split into tiles as done by
+    MlasSgemmBatch.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for the A matrices.
+
+    M - Supplies the number of rows of each matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and each matrix C.
+
+    K - Supplies the number of columns of each matrix A and the number of rows
+        of matrix B.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the addresses of the A matrices.
+
+    lda - Supplies the first dimension of the A matrices.
+
+    PackedB - Supplies the address of the buffer passed to MlasSgemmPackB.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    C - Supplies the addresses of the C matrices, which must not overlap.
+
+    ldc - Supplies the first dimension of the C matrices.
+
+    BatchCount - Supplies the number of operations.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedN =
+        (N + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+    const float* B = MlasSgemmAlignPackedB(const_cast<void*>(PackedB));
+
+    MlasSgemmBatchOperation(TransA, CblasNoTrans, M, N, K, alpha, A, lda,
+        nullptr, AlignedN, B, beta, C, ldc, BatchCount);
+}
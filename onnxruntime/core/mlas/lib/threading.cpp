@@ -16,6 +16,34 @@ Abstract:
 
 #include "mlasi.h"
 
+std::atomic<const MLAS_THREADPOOL*> MlasThreadPool{nullptr};
+
+void
+MLASCALL
+MlasSetThreadPool(
+    const MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine sets the thread pool used to execute threaded work.
+
+Arguments:
+
+    ThreadPool - Supplies the thread pool to use or nullptr to restore the
+        default threading behavior. The structure must remain valid until the
+        thread pool is replaced and any operations using it have completed.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasThreadPool.store(ThreadPool, std::memory_order_release);
+}
+
 #if defined(MLAS_USE_WIN32_THREADPOOL)
 
 //
@@ -85,6 +113,21 @@ MlasExecuteThreaded(
         return;
     }
 
+#if !defined(MLAS_USE_OPENMP)
+
+    //
+    // Schedule the threaded iterations using the caller supplied thread pool.
+    //
+
+    const MLAS_THREADPOOL* ThreadPool = MlasThreadPool.load(std::memory_order_acquire);
+
+    if (ThreadPool != nullptr) {
+        ThreadPool->ExecuteRoutine(ThreadPool->ThreadPoolContext, ThreadedRoutine, Context, Iterations);
+        return;
+    }
+
+#endif
+
 #if defined(MLAS_USE_WIN32_THREADPOOL)
 
     //
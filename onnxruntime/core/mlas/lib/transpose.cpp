@@ -0,0 +1,351 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    transpose.cpp
+
+Abstract:
+
+    This module implements the matrix transpose routines.
+
+    The matrix is processed in small square blocks, stepping down the rows of
+    the source for each band of columns so that the destination is written
+    sequentially. The blocks are kept small so that the source and destination
+    rows stay resident in the L1 cache even when the leading dimensions are a
+    large power of two. Each block is transposed using square vector tiles:
+    4x4 tiles for 32-bit elements and 16x16 tiles for 8-bit elements. A tile
+    of N rows is transposed by log2(N) rounds of interleaving row i with row
+    i + N/2, which rotates the bits of the row and column index by one
+    position per round.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the number of rows and columns in a cache block.
+//
+
+#define MLAS_TRANSPOSE_BLOCK_SIZE_32BIT     16
+#define MLAS_TRANSPOSE_BLOCK_SIZE_8BIT      64
+
+inline
+void
+MlasTransposeTile(
+    const uint32_t* Input,
+    size_t lda,
+    uint32_t* Output,
+    size_t ldb
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a 4x4 tile of 32-bit elements.
+
+Arguments:
+
+    Input - Supplies the address of the source tile.
+
+    lda - Supplies the first dimension of the source matrix.
+
+    Output - Supplies the address of the destination tile.
+
+    ldb - Supplies the first dimension of the destination matrix.
+
+Return Value:
+
+    None.
+
+--*/
+{
+#if defined(MLAS_SSE2_INTRINSICS)
+
+    __m128i a0 = _mm_loadu_si128((const __m128i*)&Input[lda * 0]);
+    __m128i a1 = _mm_loadu_si128((const __m128i*)&Input[lda * 1]);
+    __m128i a2 = _mm_loadu_si128((const __m128i*)&Input[lda * 2]);
+    __m128i a3 = _mm_loadu_si128((const __m128i*)&Input[lda * 3]);
+
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+
+    _mm_storeu_si128((__m128i*)&Output[ldb * 0], _mm_unpacklo_epi32(b0, b2));
+    _mm_storeu_si128((__m128i*)&Output[ldb * 1], _mm_unpackhi_epi32(b0, b2));
+    _mm_storeu_si128((__m128i*)&Output[ldb * 2], _mm_unpacklo_epi32(b1, b3));
+    _mm_storeu_si128((__m128i*)&Output[ldb * 3], _mm_unpackhi_epi32(b1, b3));
+
+#elif defined(MLAS_NEON_INTRINSICS)
+
+    uint32x4x2_t b01 = vzipq_u32(vld1q_u32(&Input[lda * 0]), vld1q_u32(&Input[lda * 2]));
+    uint32x4x2_t b23 = vzipq_u32(vld1q_u32(&Input[lda * 1]), vld1q_u32(&Input[lda * 3]));
+
+    uint32x4x2_t c01 = vzipq_u32(b01.val[0], b23.val[0]);
+    uint32x4x2_t c23 = vzipq_u32(b01.val[1], b23.val[1]);
+
+    vst1q_u32(&Output[ldb * 0], c01.val[0]);
+    vst1q_u32(&Output[ldb * 1], c01.val[1]);
+    vst1q_u32(&Output[ldb * 2], c23.val[0]);
+    vst1q_u32(&Output[ldb * 3], c23.val[1]);
+
+#else
+
+    for (size_t n = 0; n < 4; n++) {
+        for (size_t m = 0; m < 4; m++) {
+            Output[ldb * n + m] = Input[lda * m + n];
+        }
+    }
+
+#endif
+}
+
+inline
+void
+MlasTransposeTile(
+    const uint8_t* Input,
+    size_t lda,
+    uint8_t* Output,
+    size_t ldb
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a 16x16 tile of 8-bit elements.
+
+Arguments:
+
+    Input - Supplies the address of the source tile.
+
+    lda - Supplies the first dimension of the source matrix.
+
+    Output - Supplies the address of the destination tile.
+
+    ldb - Supplies the first dimension of the destination matrix.
+
+Return Value:
+
+    None.
+
+--*/
+{
+#if defined(MLAS_SSE2_INTRINSICS)
+
+    __m128i Rows[16];
+    __m128i Interleaved[16];
+
+    for (size_t i = 0; i < 16; i++) {
+        Rows[i] = _mm_loadu_si128((const __m128i*)&Input[lda * i]);
+    }
+
+    for (size_t round = 0; round < 4; round++) {
+
+        for (size_t i = 0; i < 8; i++) {
+            Interleaved[i * 2 + 0] = _mm_unpacklo_epi8(Rows[i], Rows[i + 8]);
+            Interleaved[i * 2 + 1] = _mm_unpackhi_epi8(Rows[i], Rows[i + 8]);
+        }
+
+        for (size_t i = 0; i < 16; i++) {
+            Rows[i] = Interleaved[i];
+        }
+    }
+
+    for (size_t i = 0; i < 16; i++) {
+        _mm_storeu_si128((__m128i*)&Output[ldb * i], Rows[i]);
+    }
+
+#elif defined(MLAS_NEON_INTRINSICS)
+
+    uint8x16_t Rows[16];
+    uint8x16_t Interleaved[16];
+
+    for (size_t i = 0; i < 16; i++) {
+        Rows[i] = vld1q_u8(&Input[lda * i]);
+    }
+
+    for (size_t round = 0; round < 4; round++) {
+
+        for (size_t i = 0; i < 8; i++) {
+            uint8x16x2_t Zipped = vzipq_u8(Rows[i], Rows[i + 8]);
+            Interleaved[i * 2 + 0] = Zipped.val[0];
+            Interleaved[i * 2 + 1] = Zipped.val[1];
+        }
+
+        for (size_t i = 0; i < 16; i++) {
+            Rows[i] = Interleaved[i];
+        }
+    }
+
+    for (size_t i = 0; i < 16; i++) {
+        vst1q_u8(&Output[ldb * i], Rows[i]);
+    }
+
+#else
+
+    for (size_t n = 0; n < 16; n++) {
+        for (size_t m = 0; m < 16; m++) {
+            Output[ldb * n + m] = Input[lda * m + n];
+        }
+    }
+
+#endif
+}
+
+template<typename ElementType, size_t TileSize, size_t BlockSize>
+void
+MlasTransposeBlocked(
+    size_t M,
+    size_t N,
+    const ElementType* Input,
+    size_t lda,
+    ElementType* Output,
+    size_t ldb
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a matrix one cache block at a time. Each block is
+    transposed using vector tiles and the rows and columns left over at the
+    edges of the block are transposed one element at a time.
+
+Arguments:
+
+    M - Supplies the number of rows of the source matrix.
+
+    N - Supplies the number of columns of the source matrix.
+
+    Input - Supplies the address of the source matrix.
+
+    lda - Supplies the first dimension of the source matrix.
+
+    Output - Supplies the address of the destination matrix.
+
+    ldb - Supplies the first dimension of the destination matrix.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    for (size_t n0 = 0; n0 < N; n0 += BlockSize) {
+
+        const size_t CountN = std::min(N - n0, size_t(BlockSize));
+
+        for (size_t m0 = 0; m0 < M; m0 += BlockSize) {
+
+            const size_t CountM = std::min(M - m0, size_t(BlockSize));
+            const ElementType* a = Input + m0 * lda + n0;
+            ElementType* b = Output + n0 * ldb + m0;
+
+            size_t n = 0;
+
+            for (; n + TileSize <= CountN; n += TileSize) {
+
+                size_t m = 0;
+
+                for (; m + TileSize <= CountM; m += TileSize) {
+                    MlasTransposeTile(&a[m * lda + n], lda, &b[n * ldb + m], ldb);
+                }
+
+                for (; m < CountM; m++) {
+                    for (size_t nn = n; nn < n + TileSize; nn++) {
+                        b[nn * ldb + m] = a[m * lda + nn];
+                    }
+                }
+            }
+
+            for (; n < CountN; n++) {
+                for (size_t m = 0; m < CountM; m++) {
+                    b[n * ldb + m] = a[m * lda + n];
+                }
+            }
+        }
+    }
+}
+
+void
+MLASCALL
+MlasTranspose(
+    size_t M,
+    size_t N,
+    const uint32_t* Input,
+    size_t lda,
+    uint32_t* Output,
+    size_t ldb
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a matrix of 32-bit elements.
+
+Arguments:
+
+    M - Supplies the number of rows of the source matrix.
+
+    N - Supplies the number of columns of the source matrix.
+
+    Input - Supplies the address of the source matrix.
+
+    lda - Supplies the first dimension of the source matrix.
+
+    Output - Supplies the address of the destination matrix of N rows and M
+        columns.
+
+    ldb - Supplies the first dimension of the destination matrix.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasTransposeBlocked<uint32_t, 4, MLAS_TRANSPOSE_BLOCK_SIZE_32BIT>(M, N, Input, lda, Output, ldb);
+}
+
+void
+MLASCALL
+MlasTranspose(
+    size_t M,
+    size_t N,
+    const uint8_t* Input,
+    size_t lda,
+    uint8_t* Output,
+    size_t ldb
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a matrix of 8-bit elements.
+
+Arguments:
+
+    M - Supplies the number of rows of the source matrix.
+
+    N - Supplies the number of columns of the source matrix.
+
+    Input - Supplies the address of the source matrix.
+
+    lda - Supplies the first dimension of the source matrix.
+
+    Output - Supplies the address of the destination matrix of N rows and M
+        columns.
+
+    ldb - Supplies the first dimension of the destination matrix.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasTransposeBlocked<uint8_t, 16, MLAS_TRANSPOSE_BLOCK_SIZE_8BIT>(M, N, Input, lda, Output, ldb);
+}
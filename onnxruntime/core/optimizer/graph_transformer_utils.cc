@@ -11,6 +11,8 @@
 #include "core/optimizer/conv_activation_fusion.h"
 #include "core/optimizer/gemm_activation_fusion.h"
 #include "core/optimizer/matmul_add_fusion.h"
+#include "core/optimizer/nchwc_transformer.h"
+#include "core/mlas/inc/mlas.h"
 
 namespace onnxruntime {
 
@@ -101,6 +103,14 @@ std::vector<std::unique_ptr<GraphTransformer>> GenerateTransformers(TransformerL
       transformers.emplace_back(std::make_unique<ConvAddFusion>());
       transformers.emplace_back(std::make_unique<ConvMulFusion>());
       transformers.emplace_back(std::make_unique<ConvBNFusion>());
+#ifndef DISABLE_CONTRIB_OPS
+      // The layout transformer runs after the fusions above so that it sees
+      // the fused Conv nodes. It is only enabled if the platform supports the
+      // NCHWc kernels.
+      if (MlasNchwcGetBlockSize() > 1) {
+        transformers.emplace_back(std::make_unique<NchwcTransformer>(l2_execution_providers));
+      }
+#endif
     } break;
 
     default:
@@ -0,0 +1,497 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <deque>
+#include "core/graph/graph_utils.h"
+#include "core/optimizer/initializer.h"
+#include "core/optimizer/nchwc_transformer.h"
+#include "core/mlas/inc/mlas.h"
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+// Tracks a tensor that has been converted to the NCHWc layout.
+struct NchwcArgument {
+  NchwcArgument(Node& output_node, NodeArg* nchwc_arg, size_t original_uses, int64_t channels)
+      : output_node_(output_node),
+        nchwc_arg_(nchwc_arg),
+        remaining_original_uses_(original_uses),
+        channels_(channels) {
+  }
+
+  // Node that produces the NCHWc tensor.
+  Node& output_node_;
+
+  // NCHWc version of the original tensor.
+  NodeArg* nchwc_arg_;
+
+  // Number of consumers of the original tensor that have not been converted.
+  // If non-zero once the graph has been walked, then the original tensor is
+  // rebuilt from the NCHWc tensor with a ReorderOutput node.
+  size_t remaining_original_uses_;
+
+  // Number of channels in the original tensor.
+  int64_t channels_;
+};
+
+class NchwcTransformerImpl {
+ public:
+  NchwcTransformerImpl(Graph& graph) noexcept : graph_(graph) {
+    nchwc_block_size_ = static_cast<int64_t>(MlasNchwcGetBlockSize());
+  }
+
+  void Transform(Node& node);
+  void Finalize(bool& modified);
+
+ private:
+  int64_t RoundUpToBlock(int64_t channels) const {
+    return (channels + nchwc_block_size_ - 1) / nchwc_block_size_ * nchwc_block_size_;
+  }
+
+  NchwcArgument* LookupNchwcArgument(NodeArg* arg);
+  NodeArg* AddNchwcArgument(const NodeArg* original_arg);
+  NodeArg* AddInitializer(const std::string& base_name, const std::vector<int64_t>& dims, const std::vector<float>& data);
+  void CreateNchwcArgument(Node& node, Node& nchwc_node, NodeArg* nchwc_arg, int64_t channels);
+  size_t CountOriginalUses(const Node& node) const;
+  bool HaveSameShape(const NodeArg* arg1, const NodeArg* arg2) const;
+
+  void TransformConv(Node& node);
+  void TransformPool(Node& node);
+  void TransformRelu(Node& node);
+  void TransformAdd(Node& node);
+
+  Graph& graph_;
+  int64_t nchwc_block_size_;
+
+  // Nodes that have been replaced by an NCHWc node and must be removed.
+  std::deque<NodeIndex> removed_nodes_;
+
+  // Maps the original NCHW tensors to the NCHWc version of the tensor.
+  std::unordered_map<const NodeArg*, std::unique_ptr<NchwcArgument>> nchwc_args_;
+
+  // Maps the original NCHW tensors to an NCHWc version of the tensor that was
+  // produced by a ReorderInput node. The original tensor is left in place.
+  std::unordered_map<const NodeArg*, NodeArg*> reorder_inputs_;
+
+  // Initializers that were replaced by a reordered copy and that can be
+  // removed if no other node uses them.
+  std::unordered_set<std::string> replaced_initializers_;
+};
+
+NchwcArgument* NchwcTransformerImpl::LookupNchwcArgument(NodeArg* arg) {
+  auto it = nchwc_args_.find(arg);
+  if (it == nchwc_args_.end()) {
+    return nullptr;
+  }
+  return it->second.get();
+}
+
+NodeArg* NchwcTransformerImpl::AddNchwcArgument(const NodeArg* original_arg) {
+  TypeProto type_proto;
+  type_proto.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  std::string output_name = graph_.GenerateNodeArgName("nchwc_" + original_arg->Name());
+  return &graph_.GetOrCreateNodeArg(output_name, &type_proto);
+}
+
+NodeArg* NchwcTransformerImpl::AddInitializer(const std::string& base_name,
+                                              const std::vector<int64_t>& dims,
+                                              const std::vector<float>& data) {
+  TensorProto tensor_proto;
+  tensor_proto.set_name(graph_.GenerateNodeArgName("nchwc_" + base_name));
+  tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+  for (auto dim : dims) {
+    tensor_proto.add_dims(dim);
+  }
+  tensor_proto.set_raw_data(data.data(), data.size() * sizeof(float));
+  graph_.AddInitializedTensor(tensor_proto);
+
+  TypeProto type_proto;
+  type_proto.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  return &graph_.GetOrCreateNodeArg(tensor_proto.name(), &type_proto);
+}
+
+size_t NchwcTransformerImpl::CountOriginalUses(const Node& node) const {
+  size_t original_uses = node.GetOutputEdgesCount();
+  if (graph_.IsNodeOutputsInGraphOutputs(node)) {
+    original_uses++;
+  }
+  return original_uses;
+}
+
+void NchwcTransformerImpl::CreateNchwcArgument(Node& node, Node& nchwc_node, NodeArg* nchwc_arg, int64_t channels) {
+  const NodeArg* output_original_arg = node.OutputDefs()[0];
+  size_t original_uses = CountOriginalUses(node);
+  nchwc_args_[output_original_arg] = std::make_unique<NchwcArgument>(nchwc_node, nchwc_arg, original_uses, channels);
+}
+
+bool NchwcTransformerImpl::HaveSameShape(const NodeArg* arg1, const NodeArg* arg2) const {
+  const auto* shape1 = arg1->Shape();
+  const auto* shape2 = arg2->Shape();
+  if (shape1 == nullptr || shape2 == nullptr || shape1->dim_size() != shape2->dim_size()) {
+    return false;
+  }
+  for (int i = 0; i < shape1->dim_size(); i++) {
+    const auto& dim1 = shape1->dim(i);
+    const auto& dim2 = shape2->dim(i);
+    if (dim1.has_dim_value() && dim2.has_dim_value()) {
+      if (dim1.dim_value() != dim2.dim_value()) {
+        return false;
+      }
+    } else if (!dim1.has_dim_param() || !dim2.has_dim_param() || dim1.dim_param() != dim2.dim_param()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void NchwcTransformerImpl::TransformConv(Node& node) {
+  auto& input_defs = node.MutableInputDefs();
+  auto& output_defs = node.MutableOutputDefs();
+
+  // Require that the weights and any bias be constant.
+  const TensorProto* conv_W_tensor_proto = nullptr;
+  if (!graph_.GetInitializedTensor(input_defs[1]->Name(), conv_W_tensor_proto) ||
+      conv_W_tensor_proto->data_type() != TensorProto_DataType_FLOAT ||
+      conv_W_tensor_proto->dims_size() != 4) {
+    return;
+  }
+
+  const TensorProto* conv_B_tensor_proto = nullptr;
+  if (input_defs.size() >= 3 && input_defs[2]->Exists()) {
+    if (!graph_.GetInitializedTensor(input_defs[2]->Name(), conv_B_tensor_proto) ||
+        conv_B_tensor_proto->data_type() != TensorProto_DataType_FLOAT ||
+        conv_B_tensor_proto->dims_size() != 1 ||
+        conv_B_tensor_proto->dims(0) != conv_W_tensor_proto->dims(0)) {
+      return;
+    }
+  }
+
+  const int64_t output_channels = conv_W_tensor_proto->dims(0);
+  const int64_t input_channels_per_group = conv_W_tensor_proto->dims(1);
+
+  const auto* group_attr = graph_utils::GetNodeAttribute(node, "group");
+  const int64_t group_count = (group_attr != nullptr) ? group_attr->i() : 1;
+
+  // The only supported grouped convolution is a depthwise convolution.
+  const bool depthwise = (group_count > 1);
+  if (depthwise && (input_channels_per_group != 1 || group_count != output_channels)) {
+    return;
+  }
+
+  // A pointwise convolution is slower with the NCHWc kernels than with the
+  // default SGEMM path, so it is only converted when its input is already
+  // NCHWc. Leaving the convolution in the chain then saves reordering its
+  // input and output.
+  auto* nchwc_input_arg = LookupNchwcArgument(input_defs[0]);
+  const bool pointwise = conv_W_tensor_proto->dims(2) == 1 && conv_W_tensor_proto->dims(3) == 1;
+  if (pointwise && !depthwise && nchwc_input_arg == nullptr) {
+    return;
+  }
+
+  const int64_t input_channels = input_channels_per_group * group_count;
+  const int64_t nchwc_input_channels = RoundUpToBlock(input_channels);
+  const int64_t nchwc_output_channels = RoundUpToBlock(output_channels);
+
+  // Use the NCHWc version of the input if available. A convolution with too
+  // few input channels to fill a block reads the NCHW input directly,
+  // otherwise the input is reordered to NCHWc.
+  NodeArg* nchwc_input = nullptr;
+  bool reorder_filter_OIHWBo = depthwise;
+  if (nchwc_input_arg != nullptr) {
+    nchwc_input = nchwc_input_arg->nchwc_arg_;
+    nchwc_input_arg->remaining_original_uses_--;
+  } else if (!depthwise && input_channels < nchwc_block_size_) {
+    nchwc_input = input_defs[0];
+    reorder_filter_OIHWBo = true;
+  } else {
+    auto it = reorder_inputs_.find(input_defs[0]);
+    if (it != reorder_inputs_.end()) {
+      nchwc_input = it->second;
+    } else {
+      nchwc_input = AddNchwcArgument(input_defs[0]);
+      Node& reorder_input_node = graph_.AddNode(graph_.GenerateNodeName("ReorderInput"),
+                                                "ReorderInput",
+                                                "ReorderInput",
+                                                std::vector<NodeArg*>{input_defs[0]},
+                                                std::vector<NodeArg*>{nchwc_input},
+                                                nullptr,
+                                                kMSNchwcDomain);
+      reorder_input_node.SetExecutionProviderType(kCpuExecutionProvider);
+      reorder_inputs_[input_defs[0]] = nchwc_input;
+    }
+  }
+
+  // Reorder the filter to the blocked format expected by the NCHWc kernels.
+  std::vector<int64_t> conv_W_dims(conv_W_tensor_proto->dims().begin(), conv_W_tensor_proto->dims().end());
+  std::vector<int64_t> nchwc_conv_W_dims(conv_W_dims);
+  nchwc_conv_W_dims[0] = nchwc_output_channels;
+
+  auto conv_W = std::make_unique<Initializer>(conv_W_tensor_proto);
+  std::vector<float> reordered_filter;
+
+  if (reorder_filter_OIHWBo) {
+    if (depthwise) {
+      nchwc_conv_W_dims[0] = nchwc_input_channels;
+    }
+    reordered_filter.resize(static_cast<size_t>(nchwc_conv_W_dims[0] * conv_W_dims[1] * conv_W_dims[2] * conv_W_dims[3]));
+    MlasReorderFilterOIHWBo(conv_W_dims.data(), conv_W->data<float>(), reordered_filter.data());
+  } else {
+    nchwc_conv_W_dims[1] = nchwc_input_channels;
+    reordered_filter.resize(static_cast<size_t>(nchwc_conv_W_dims[0] * nchwc_conv_W_dims[1] * conv_W_dims[2] * conv_W_dims[3]));
+    MlasReorderFilterOIHWBiBo(conv_W_dims.data(), conv_W->data<float>(), reordered_filter.data());
+  }
+
+  NodeArg* nchwc_conv_W_arg = AddInitializer(input_defs[1]->Name(), nchwc_conv_W_dims, reordered_filter);
+  replaced_initializers_.insert(input_defs[1]->Name());
+
+  // Pad the bias to the number of NCHWc output channels. A bias is always
+  // supplied so that a Sum input can later be appended to the node.
+  std::vector<float> aligned_bias(static_cast<size_t>(nchwc_conv_W_dims[0]), 0.0f);
+  if (conv_B_tensor_proto != nullptr) {
+    auto conv_B = std::make_unique<Initializer>(conv_B_tensor_proto);
+    std::copy_n(conv_B->data<float>(), output_channels, aligned_bias.data());
+    replaced_initializers_.insert(input_defs[2]->Name());
+  }
+
+  NodeArg* nchwc_conv_B_arg = AddInitializer(conv_B_tensor_proto != nullptr ? input_defs[2]->Name() : node.Name() + "_bias",
+                                             {nchwc_conv_W_dims[0]},
+                                             aligned_bias);
+
+  NodeArg* nchwc_output = AddNchwcArgument(output_defs[0]);
+
+  Node& nchwc_node = graph_.AddNode(graph_.GenerateNodeName(node.Name() + "_nchwc"),
+                                    "Conv",
+                                    node.Description(),
+                                    std::vector<NodeArg*>{nchwc_input, nchwc_conv_W_arg, nchwc_conv_B_arg},
+                                    std::vector<NodeArg*>{nchwc_output},
+                                    &node.GetAttributes(),
+                                    kMSNchwcDomain);
+  nchwc_node.SetExecutionProviderType(kCpuExecutionProvider);
+
+  if (depthwise) {
+    nchwc_node.AddAttribute("group", nchwc_input_channels);
+  }
+
+  CreateNchwcArgument(node, nchwc_node, nchwc_output, output_channels);
+  removed_nodes_.push_front(node.Index());
+}
+
+void NchwcTransformerImpl::TransformPool(Node& node) {
+  auto& input_defs = node.MutableInputDefs();
+  auto& output_defs = node.MutableOutputDefs();
+
+  // Pooling is only converted when the input is already in NCHWc layout.
+  auto* nchwc_input_arg = LookupNchwcArgument(input_defs[0]);
+  if (nchwc_input_arg == nullptr) {
+    return;
+  }
+
+  // The index output of MaxPool is not supported.
+  if (output_defs.size() > 1 && output_defs[1]->Exists()) {
+    return;
+  }
+
+  std::vector<int64_t> kernel_shape;
+  if (graph_utils::GetRepeatedNodeAttributeValues(node, "kernel_shape", kernel_shape) && kernel_shape.size() != 2) {
+    return;
+  }
+
+  NodeArg* nchwc_output = AddNchwcArgument(output_defs[0]);
+
+  Node& nchwc_node = graph_.AddNode(graph_.GenerateNodeName(node.Name() + "_nchwc"),
+                                    node.OpType(),
+                                    node.Description(),
+                                    std::vector<NodeArg*>{nchwc_input_arg->nchwc_arg_},
+                                    std::vector<NodeArg*>{nchwc_output},
+                                    &node.GetAttributes(),
+                                    kMSNchwcDomain);
+  nchwc_node.SetExecutionProviderType(kCpuExecutionProvider);
+
+  nchwc_input_arg->remaining_original_uses_--;
+
+  CreateNchwcArgument(node, nchwc_node, nchwc_output, nchwc_input_arg->channels_);
+  removed_nodes_.push_front(node.Index());
+}
+
+void NchwcTransformerImpl::TransformRelu(Node& node) {
+  auto& input_defs = node.MutableInputDefs();
+  auto& output_defs = node.MutableOutputDefs();
+
+  auto* nchwc_input_arg = LookupNchwcArgument(input_defs[0]);
+  if (nchwc_input_arg == nullptr) {
+    return;
+  }
+
+  // Fuse the activation into the producing NCHWc convolution if this is its
+  // only consumer and no activation has been applied yet.
+  Node& nchwc_node = nchwc_input_arg->output_node_;
+  if (nchwc_node.OpType() == "Conv" &&
+      nchwc_node.Domain() == kMSNchwcDomain &&
+      nchwc_input_arg->remaining_original_uses_ == 1 &&
+      graph_utils::GetNodeAttribute(nchwc_node, "activation") == nullptr) {
+    nchwc_node.AddAttribute("activation", std::string("Relu"));
+    nchwc_input_arg->remaining_original_uses_--;
+    CreateNchwcArgument(node, nchwc_node, nchwc_input_arg->nchwc_arg_, nchwc_input_arg->channels_);
+    removed_nodes_.push_front(node.Index());
+    return;
+  }
+
+  // Otherwise, the element-wise operation is applied to the NCHWc tensor.
+  NodeArg* nchwc_output = AddNchwcArgument(output_defs[0]);
+
+  Node& relu_node = graph_.AddNode(graph_.GenerateNodeName(node.Name() + "_nchwc"),
+                                   "Relu",
+                                   node.Description(),
+                                   std::vector<NodeArg*>{nchwc_input_arg->nchwc_arg_},
+                                   std::vector<NodeArg*>{nchwc_output},
+                                   nullptr,
+                                   kOnnxDomain);
+  relu_node.SetExecutionProviderType(kCpuExecutionProvider);
+
+  nchwc_input_arg->remaining_original_uses_--;
+
+  CreateNchwcArgument(node, relu_node, nchwc_output, nchwc_input_arg->channels_);
+  removed_nodes_.push_front(node.Index());
+}
+
+void NchwcTransformerImpl::TransformAdd(Node& node) {
+  auto& input_defs = node.MutableInputDefs();
+  auto& output_defs = node.MutableOutputDefs();
+
+  // Both inputs must be NCHWc tensors of the same shape, so that the padded
+  // channels line up and no broadcasting is required.
+  auto* nchwc_input_arg_0 = LookupNchwcArgument(input_defs[0]);
+  auto* nchwc_input_arg_1 = LookupNchwcArgument(input_defs[1]);
+  if (nchwc_input_arg_0 == nullptr || nchwc_input_arg_1 == nullptr ||
+      nchwc_input_arg_0->channels_ != nchwc_input_arg_1->channels_ ||
+      !HaveSameShape(input_defs[0], input_defs[1])) {
+    return;
+  }
+
+  // Fuse the addition into a producing NCHWc convolution as a Sum input if
+  // this is the only consumer of the convolution and no activation has been
+  // applied yet. The convolution then accumulates into the other input, which
+  // must not also be the input of the convolution.
+  NchwcArgument* nchwc_inputs[2] = {nchwc_input_arg_0, nchwc_input_arg_1};
+  for (int i = 0; i < 2; i++) {
+    auto* nchwc_conv_arg = nchwc_inputs[i];
+    auto* nchwc_sum_arg = nchwc_inputs[i ^ 1];
+    Node& nchwc_node = nchwc_conv_arg->output_node_;
+    if (nchwc_node.OpType() == "Conv" &&
+        nchwc_node.Domain() == kMSNchwcDomain &&
+        nchwc_node.InputDefs().size() == 3 &&
+        nchwc_node.InputDefs()[0] != nchwc_sum_arg->nchwc_arg_ &&
+        nchwc_conv_arg->remaining_original_uses_ == 1 &&
+        graph_utils::GetNodeAttribute(nchwc_node, "activation") == nullptr) {
+      nchwc_node.MutableInputDefs().push_back(nchwc_sum_arg->nchwc_arg_);
+      nchwc_node.MutableInputArgsCount().push_back(1);
+      nchwc_conv_arg->remaining_original_uses_--;
+      nchwc_sum_arg->remaining_original_uses_--;
+      CreateNchwcArgument(node, nchwc_node, nchwc_conv_arg->nchwc_arg_, nchwc_conv_arg->channels_);
+      removed_nodes_.push_front(node.Index());
+      return;
+    }
+  }
+
+  // Otherwise, the element-wise operation is applied to the NCHWc tensors.
+  NodeArg* nchwc_output = AddNchwcArgument(output_defs[0]);
+
+  Node& add_node = graph_.AddNode(graph_.GenerateNodeName(node.Name() + "_nchwc"),
+                                  "Add",
+                                  node.Description(),
+                                  std::vector<NodeArg*>{nchwc_input_arg_0->nchwc_arg_, nchwc_input_arg_1->nchwc_arg_},
+                                  std::vector<NodeArg*>{nchwc_output},
+                                  nullptr,
+                                  kOnnxDomain);
+  add_node.SetExecutionProviderType(kCpuExecutionProvider);
+
+  nchwc_input_arg_0->remaining_original_uses_--;
+  nchwc_input_arg_1->remaining_original_uses_--;
+
+  CreateNchwcArgument(node, add_node, nchwc_output, nchwc_input_arg_0->channels_);
+  removed_nodes_.push_front(node.Index());
+}
+
+void NchwcTransformerImpl::Transform(Node& node) {
+  if (graph_utils::IsSupportedOptypeVersionAndDomain(node, "Conv", 1) ||
+      graph_utils::IsSupportedOptypeVersionAndDomain(node, "FusedConv", 1, kMSDomain)) {
+    TransformConv(node);
+  } else if (graph_utils::IsSupportedOptypeVersionAndDomain(node, "MaxPool", 1) ||
+             graph_utils::IsSupportedOptypeVersionAndDomain(node, "MaxPool", 8) ||
+             graph_utils::IsSupportedOptypeVersionAndDomain(node, "AveragePool", 7) ||
+             graph_utils::IsSupportedOptypeVersionAndDomain(node, "GlobalMaxPool", 1) ||
+             graph_utils::IsSupportedOptypeVersionAndDomain(node, "GlobalAveragePool", 1)) {
+    TransformPool(node);
+  } else if (graph_utils::IsSupportedOptypeVersionAndDomain(node, "Relu", 6)) {
+    TransformRelu(node);
+  } else if (graph_utils::IsSupportedOptypeVersionAndDomain(node, "Add", 7)) {
+    TransformAdd(node);
+  }
+}
+
+void NchwcTransformerImpl::Finalize(bool& modified) {
+  // Rebuild the original tensors that are still used by nodes that were not
+  // converted or that are graph outputs.
+  for (auto& nchwc_output : nchwc_args_) {
+    if (nchwc_output.second->remaining_original_uses_ > 0) {
+      auto* output_original_arg = const_cast<NodeArg*>(nchwc_output.first);
+      Node& reorder_output_node = graph_.AddNode(graph_.GenerateNodeName("ReorderOutput"),
+                                                 "ReorderOutput",
+                                                 "ReorderOutput",
+                                                 std::vector<NodeArg*>{nchwc_output.second->nchwc_arg_},
+                                                 std::vector<NodeArg*>{output_original_arg},
+                                                 nullptr,
+                                                 kMSNchwcDomain);
+      reorder_output_node.AddAttribute("channels", nchwc_output.second->channels_);
+      reorder_output_node.SetExecutionProviderType(kCpuExecutionProvider);
+    }
+  }
+
+  for (auto index : removed_nodes_) {
+    Node* node = graph_.GetNode(index);
+    graph_utils::RemoveNodeOutputEdges(graph_, *node);
+    graph_.RemoveNode(index);
+  }
+
+  if (!replaced_initializers_.empty()) {
+    for (auto& node : graph_.Nodes()) {
+      for (const auto* input_def : node.InputDefs()) {
+        replaced_initializers_.erase(input_def->Name());
+      }
+      for (const auto* input_def : node.ImplicitInputDefs()) {
+        replaced_initializers_.erase(input_def->Name());
+      }
+    }
+    for (const auto& name : replaced_initializers_) {
+      graph_.RemoveInitializedTensor(name);
+    }
+  }
+
+  if (!removed_nodes_.empty()) {
+    modified = true;
+  }
+}
+
+}  // namespace
+
+Status NchwcTransformer::ApplyImpl(Graph& graph, bool& modified, int graph_level) const {
+  NchwcTransformerImpl impl(graph);
+  GraphViewer graph_viewer(graph);
+
+  for (auto index : graph_viewer.GetNodesInTopologicalOrder()) {
+    auto& node = *graph.GetNode(index);
+    ORT_RETURN_IF_ERROR(Recurse(node, modified, graph_level));
+    if (graph_utils::IsSupportedProvider(node, GetCompatibleExecutionProviders()) &&
+        node.GetExecutionProviderType() == kCpuExecutionProvider) {
+      impl.Transform(node);
+    }
+  }
+
+  impl.Finalize(modified);
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
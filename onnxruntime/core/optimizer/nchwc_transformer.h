@@ -0,0 +1,27 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@class NchwcTransformer
+
+Transformer that converts chains of Conv, pooling, Relu and Add nodes to use
+the NCHWc blocked layout. Reorder nodes are inserted only where a tensor
+enters or leaves the chain. A pointwise (1x1) convolution does not start a
+chain, as it is faster with the default NCHW kernels.
+*/
+class NchwcTransformer : public GraphTransformer {
+ public:
+  NchwcTransformer(const std::unordered_set<std::string>& compatible_execution_providers = {}) noexcept
+      : GraphTransformer("NchwcTransformer", "Transform to the NCHWc blocked layout", compatible_execution_providers) {}
+
+ private:
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level) const override;
+};
+
+}  // namespace onnxruntime
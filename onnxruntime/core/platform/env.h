@@ -186,6 +186,8 @@ struct ThreadOptions {
   size_t stack_size = 0;  // 0: use system default value
   /// Guard area size to use near thread stacks to use (in bytes)
   size_t guard_size = 0;  // 0: use system default value
+  /// Logical processors the thread may run on. Empty means no affinity is set.
+  std::vector<size_t> affinity;
 };
 
 }  // namespace onnxruntime
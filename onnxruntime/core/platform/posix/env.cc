@@ -27,6 +27,10 @@ limitations under the License.
 #include <thread>
 #include <vector>
 #include <assert.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 #include "core/platform/env.h"
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
@@ -51,6 +55,26 @@ class StdThread : public Thread {
   std::thread thread_;
 };
 
+// Restrict the calling thread to the given logical processors. This is a hint so failures are only logged.
+static void SetCurrentThreadAffinity(const std::vector<size_t>& affinity) {
+#ifdef __linux__
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (size_t processor : affinity) {
+    if (processor < CPU_SETSIZE) {
+      CPU_SET(processor, &cpuset);
+    }
+  }
+
+  int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+  if (ret != 0) {
+    LOGS_DEFAULT(WARNING) << "pthread_setaffinity_np failed. error code:" << ret;
+  }
+#else
+  ORT_UNUSED_PARAMETER(affinity);
+#endif
+}
+
 static void ORT_API_CALL DeleteBuffer(void* param) noexcept { ::free(param); }
 
 class UnmapFileParam {
@@ -112,9 +136,16 @@ class PosixEnv : public Env {
     }
   }
 
-  Thread* StartThread(const ThreadOptions& /*thread_options*/, const std::string& /*name*/,
+  Thread* StartThread(const ThreadOptions& thread_options, const std::string& /*name*/,
                       std::function<void()> fn) const override {
-    return new StdThread(fn);
+    if (thread_options.affinity.empty()) {
+      return new StdThread(fn);
+    }
+
+    return new StdThread([affinity = thread_options.affinity, fn = std::move(fn)]() {
+      SetCurrentThreadAffinity(affinity);
+      fn();
+    });
   }
 
   PIDType GetSelfPid() const override {
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <string>
 #include <thread>
+#include <vector>
 #include <fcntl.h>
 #include <fstream>
 #include <io.h>
@@ -40,15 +41,72 @@ class StdThread : public Thread {
  private:
   std::thread thread_;
 };
+// Restrict the calling thread to the given logical processors of its processor group.
+// This is a hint so failures are only logged.
+static void SetCurrentThreadAffinity(const std::vector<size_t>& affinity) {
+  DWORD_PTR mask = 0;
+  for (size_t processor : affinity) {
+    if (processor < sizeof(DWORD_PTR) * 8) {
+      mask |= static_cast<DWORD_PTR>(1) << processor;
+    }
+  }
+
+  if (mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) == 0) {
+    LOGS_DEFAULT(WARNING) << "SetThreadAffinityMask failed. error code:" << GetLastError();
+  }
+}
+
 static void ORT_API_CALL DeleteBuffer(void* param) noexcept { ::free(param); }
 
+// param is the base address of a view created by MapViewOfFile
+static void ORT_API_CALL UnmapFile(void* param) noexcept {
+  if (UnmapViewOfFile(param) != TRUE) {
+    LOGS_DEFAULT(INFO) << "UnmapViewOfFile failed. error code:" << GetLastError();
+  }
+}
+
+// Map [offset, offset + len) of the file read-only so the pages are shared with any other mapping of the file.
+// Returns false if the file can't be mapped, in which case the caller should read it instead.
+static bool MapFileRegion(HANDLE hFile, int64_t offset, size_t len, void*& p, OrtCallback& deleter) {
+  HANDLE hMapping = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (hMapping == NULL) {
+    return false;
+  }
+  std::unique_ptr<void, decltype(&CloseHandle)> mapping_holder(hMapping, CloseHandle);
+
+  // the view must start at a multiple of the allocation granularity
+  SYSTEM_INFO sysInfo;
+  GetSystemInfo(&sysInfo);
+  const int64_t offset_to_granularity = offset % static_cast<int64_t>(sysInfo.dwAllocationGranularity);
+  const ULONGLONG mapped_offset = static_cast<ULONGLONG>(offset - offset_to_granularity);
+  void* base = MapViewOfFile(hMapping, FILE_MAP_READ, static_cast<DWORD>(mapped_offset >> 32),
+                             static_cast<DWORD>(mapped_offset & 0xFFFFFFFF),
+                             len + static_cast<size_t>(offset_to_granularity));
+  if (base == NULL) {
+    return false;
+  }
+
+  // the view keeps the mapping object alive so its handle can be closed now
+  p = reinterpret_cast<char*>(base) + offset_to_granularity;
+  deleter.f = UnmapFile;
+  deleter.param = base;
+  return true;
+}
+
 class WindowsEnv : public Env {
  public:
   void SleepForMicroseconds(int64_t micros) const override { Sleep(static_cast<DWORD>(micros) / 1000); }
 
-  Thread* StartThread(const ThreadOptions&, const std::string&,
+  Thread* StartThread(const ThreadOptions& thread_options, const std::string&,
                       std::function<void()> fn) const override {
-    return new StdThread(fn);
+    if (thread_options.affinity.empty()) {
+      return new StdThread(fn);
+    }
+
+    return new StdThread([affinity = thread_options.affinity, fn = std::move(fn)]() {
+      SetCurrentThreadAffinity(affinity);
+      fn();
+    });
   }
 
   int GetNumCpuCores() const override {
@@ -133,6 +191,9 @@ class WindowsEnv : public Env {
       len = 0;
       return Status::OK();
     }
+    if (MapFileRegion(hFile, offset, len, p, deleter)) {
+      return Status::OK();
+    }
     std::unique_ptr<char[]> buffer(reinterpret_cast<char*>(malloc(len)));
     char* wptr = reinterpret_cast<char*>(buffer.get());
     size_t length_remain = len;
@@ -12,9 +12,11 @@ namespace onnxruntime {
 // Information needed to construct CPU execution providers.
 struct CPUExecutionProviderInfo {
   bool create_arena{true};
+  // serve small allocations from per-thread caches in front of the arena. see BFCArena.
+  bool enable_arena_thread_cache{false};
 
-  explicit CPUExecutionProviderInfo(bool use_arena)
-      : create_arena(use_arena) {}
+  explicit CPUExecutionProviderInfo(bool use_arena, bool use_arena_thread_cache = false)
+      : create_arena(use_arena), enable_arena_thread_cache(use_arena_thread_cache) {}
 
   CPUExecutionProviderInfo() = default;
 };
@@ -30,6 +32,7 @@ class CPUExecutionProvider : public IExecutionProvider {
     DeviceAllocatorRegistrationInfo device_info{OrtMemTypeDefault,
                                                 [](int) { return std::make_unique<CPUAllocator>(); },
                                                 std::numeric_limits<size_t>::max()};
+    device_info.enable_arena_thread_cache = info.enable_arena_thread_cache;
 #ifdef USE_JEMALLOC
     ORT_UNUSED_PARAMETER(info);
     //JEMalloc already has memory pool, so just use device allocator.
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "core/common/common.h"
+#include "core/common/threadpool.h"
 #include "core/framework/op_kernel.h"
 #include "core/util/math_cpuonly.h"
 
@@ -349,6 +350,20 @@ struct BroadcastIterator {
     return index;
   }
 
+  // Position the iterator as if AdvanceBy had been called for the first 'offset' entries of the output.
+  // The following calls to AdvanceBy must stop at each multiple of the span size.
+  void Seek(size_t offset) {
+    ptrdiff_t index = deltas_[0] * static_cast<ptrdiff_t>(offset);
+    size_t count = offset / counts_[0];
+    counters_[0] = offset % counts_[0];
+    for (size_t counterIndex = 1; counterIndex < counters_.size(); counterIndex++) {
+      index += deltas_[counterIndex] * static_cast<ptrdiff_t>(count);
+      counters_[counterIndex] = count % counts_[counterIndex];
+      count /= counts_[counterIndex];
+    }
+    index_ = static_cast<size_t>(index);
+  }
+
   void Init(int64_t axis, int64_t largest) {
     ORT_ENFORCE(axis == 1 || axis == largest, "Attempting to broadcast an axis by a dimension other than 1. ", axis, " by ", largest);
 
@@ -495,18 +510,32 @@ struct TBroadcaster {
   bool IsInput0Scalar() const { return broadcaster_.iterator1_.deltas_.front() == 0; }
   bool IsInput1Scalar() const { return broadcaster_.iterator2_.deltas_.front() == 0; }
 
-  const T0& NextScalar0() { return *Next0(); }
-  const T1& NextScalar1() { return *Next1(); }
+  const T0& NextScalar0() { return *Next0(span_size_); }
+  const T1& NextScalar1() { return *Next1(span_size_); }
+
+  gsl::span<const T0> NextSpan0() { return gsl::span<const T0>(Next0(span_size_), span_size_); }
+  gsl::span<const T1> NextSpan1() { return gsl::span<const T1>(Next1(span_size_), span_size_); }
+
+  ConstEigenVectorMap<T0> NextEigen0() { return ConstEigenVectorMap<T0>(Next0(span_size_), span_size_); }
+  ConstEigenVectorMap<T1> NextEigen1() { return ConstEigenVectorMap<T1>(Next1(span_size_), span_size_); }
 
-  gsl::span<const T0> NextSpan0() { return gsl::span<const T0>(Next0(), span_size_); }
-  gsl::span<const T1> NextSpan1() { return gsl::span<const T1>(Next1(), span_size_); }
+  // Versions of the above for a partial span of 'count' entries, used when the output is split between threads.
+  // A partial span must not cross the end of a span.
+  const T0& NextScalar0(size_t count) { return *Next0(count); }
+  const T1& NextScalar1(size_t count) { return *Next1(count); }
 
-  ConstEigenVectorMap<T0> NextEigen0() { return ConstEigenVectorMap<T0>(Next0(), span_size_); }
-  ConstEigenVectorMap<T1> NextEigen1() { return ConstEigenVectorMap<T1>(Next1(), span_size_); }
+  ConstEigenVectorMap<T0> NextEigen0(size_t count) { return ConstEigenVectorMap<T0>(Next0(count), count); }
+  ConstEigenVectorMap<T1> NextEigen1(size_t count) { return ConstEigenVectorMap<T1>(Next1(count), count); }
+
+  // Position both inputs at entry 'offset' of the output.
+  void Seek(size_t offset) {
+    broadcaster_.iterator1_.Seek(offset);
+    broadcaster_.iterator2_.Seek(offset);
+  }
 
  private:
-  const T0* Next0() { return input0_ + broadcaster_.iterator1_.AdvanceBy(span_size_); }
-  const T1* Next1() { return input1_ + broadcaster_.iterator2_.AdvanceBy(span_size_); }
+  const T0* Next0(size_t count) { return input0_ + broadcaster_.iterator1_.AdvanceBy(count); }
+  const T1* Next1(size_t count) { return input1_ + broadcaster_.iterator2_.AdvanceBy(count); }
 
   const Tensor& input_tensor0_;
   const Tensor& input_tensor1_;
@@ -604,11 +633,56 @@ void BroadcastLoopSpan(TBroadcaster& bc, Output& output, Input0Scalar input0scal
   }
 }
 
+// Version of BroadcastLoop that splits the output into contiguous ranges and runs them on the thread pool.
+// Each range makes its own copy of the broadcaster and seeks it to the start of the range, so ranges don't need to
+// begin or end on a span and a single span, such as the whole output when one input is a scalar, is still split.
+// Small outputs, or no thread pool, use BroadcastLoop directly.
+template <typename TBroadcaster, typename TOutput, typename Input0Scalar, typename Input1Scalar, typename General>
+void ParallelBroadcastLoop(ThreadPool* thread_pool, TBroadcaster& bc, Tensor& output_tensor,
+                           Input0Scalar input0scalar, Input1Scalar input1scalar, General general) {
+  const int64_t output_size = output_tensor.Shape().Size();
+  const size_t span_size = bc.GetSpanSize();
+
+  TOutput* output_data = output_tensor.template MutableData<TOutput>();
+  const bool input0_scalar = bc.IsInput0Scalar();
+  const bool input1_scalar = bc.IsInput1Scalar();
+
+  ThreadPool::TryParallelFor(thread_pool, output_size, output_size, [&](int64_t first, int64_t last) {
+    if (first == 0 && last == output_size) {
+      TBroadcastOutput<TOutput> output(span_size, output_tensor);
+      BroadcastLoop(bc, output, input0scalar, input1scalar, general);
+      return;
+    }
+
+    const size_t begin = static_cast<size_t>(first);
+    const size_t end = static_cast<size_t>(last);
+
+    TBroadcaster task_bc(bc);
+    task_bc.Seek(begin);
+
+    for (size_t offset = begin; offset < end;) {
+      const size_t count = std::min(span_size - offset % span_size, end - offset);
+      EigenVectorMap<TOutput> output(output_data + offset, count);
+
+      if (input0_scalar) {
+        input0scalar(output, task_bc.NextScalar0(count), task_bc.NextEigen1(count));
+      } else if (input1_scalar) {
+        input1scalar(output, task_bc.NextEigen0(count), task_bc.NextScalar1(count));
+      } else {
+        general(output, task_bc.NextEigen0(count), task_bc.NextEigen1(count));
+      }
+
+      offset += count;
+    }
+  });
+}
+
 template <typename TInput, typename TOutput, typename Input0Scalar, typename Input1Scalar, typename General>
 Status BroadcastTwo(OpKernelContext& context, Input0Scalar input0scalar, Input1Scalar input1scalar, General general) {
   TBroadcaster<TInput, TInput> bc(*context.Input<Tensor>(0), *context.Input<Tensor>(1));
-  TBroadcastOutput<TOutput> output(bc.GetSpanSize(), *context.Output(0, bc.GetOutputShape()));
-  BroadcastLoop(bc, output, input0scalar, input1scalar, general);
+  Tensor& output = *context.Output(0, bc.GetOutputShape());
+  ParallelBroadcastLoop<TBroadcaster<TInput, TInput>, TOutput>(context.GetOperatorThreadPool(), bc, output,
+                                                               input0scalar, input1scalar, general);
 
   return Status::OK();
 }
@@ -645,9 +719,8 @@ Status BroadcastVariadic(const Node& node, OpKernelContext& context, Input0Scala
       p_output = tempOutput.get();
     }
 
-    TBroadcastOutput<TOutput> output(bc.GetSpanSize(), *p_output);
-
-    BroadcastLoop(bc, output, input0scalar, input1scalar, general);
+    ParallelBroadcastLoop<TBroadcaster<TInput, TInput>, TOutput>(context.GetOperatorThreadPool(), bc, *p_output,
+                                                                 input0scalar, input1scalar, general);
 
     tempInput = std::move(tempOutput);
   }
@@ -7,6 +7,8 @@
 #include "core/framework/op_kernel.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/providers/cpu/math/prepacked_gemm_b.h"
 #include "gemm_helper.h"
 
 namespace onnxruntime {
@@ -27,6 +29,9 @@ class Gemm : public OpKernel {
 
     ORT_ENFORCE(info.GetAttr<float>("alpha", &alpha_).IsOK());
     ORT_ENFORCE(info.GetAttr<float>("beta", &beta_).IsOK());
+
+    // only float weights are packed
+    packed_w_.Pack(info, 1, trans_B_ != CblasNoTrans);
   }
 
   Status Compute(OpKernelContext* context) const override {
@@ -95,18 +100,34 @@ class Gemm : public OpKernel {
     }
 
     // W * x
-    math::Gemm<T_X, CPUMathUtil>(
-        trans_A_,
-        trans_B_,
-        M,
-        N,
-        K,
-        alpha_,
-        X->template Data<T_X>(),
-        W->template Data<T_W>(),
-        beta_,
-        y_data,
-        &CPUMathUtil::Instance());
+    const void* packed_w = packed_w_.GetPackedData(*W);
+    if (packed_w != nullptr && K > 0) {
+      MlasSgemmPacked(
+          trans_A_,
+          static_cast<size_t>(M),
+          static_cast<size_t>(N),
+          static_cast<size_t>(K),
+          alpha_,
+          X->template Data<float>(),
+          static_cast<size_t>(trans_A_ == CblasNoTrans ? K : M),
+          packed_w,
+          beta_,
+          Y->template MutableData<float>(),
+          static_cast<size_t>(N));
+    } else {
+      math::Gemm<T_X, CPUMathUtil>(
+          trans_A_,
+          trans_B_,
+          M,
+          N,
+          K,
+          alpha_,
+          X->template Data<T_X>(),
+          W->template Data<T_W>(),
+          beta_,
+          y_data,
+          &CPUMathUtil::Instance());
+    }
 
     FuseActivation<T_Y>(activation_, y_data, M * N, leaky_relu_alpha_);
 
@@ -118,6 +139,7 @@ class Gemm : public OpKernel {
   CBLAS_TRANSPOSE trans_B_;
   float alpha_;
   float beta_;
+  PrePackedGemmB packed_w_;
 
 protected:
   // For fused gemm + activation
@@ -3,6 +3,10 @@
 
 #include "core/providers/cpu/math/matmul.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "core/mlas/inc/mlas.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 #include "matmul_helper.h"
@@ -81,4 +85,58 @@ Status MatMul<T>::Compute(OpKernelContext* ctx) const {
   return Status::OK();
 }
 
+Status MatMul<float>::Compute(OpKernelContext* ctx) const {
+  const Tensor* left_X = ctx->Input<Tensor>(0);
+  const Tensor* right_X = ctx->Input<Tensor>(1);
+
+  MatMulComputeHelper helper;
+  ORT_RETURN_IF_ERROR(helper.Compute(left_X->Shape(), right_X->Shape()));
+
+  Tensor* Y = ctx->Output(0, helper.OutputShape());
+  if (Y->Shape().Size() == 0) {
+    return Status::OK();
+  }
+
+  const size_t M = static_cast<size_t>(helper.M());
+  const size_t N = static_cast<size_t>(helper.N());
+  const size_t K = static_cast<size_t>(helper.K());
+  const float* a_data = left_X->template Data<float>();
+  float* y_data = Y->template MutableData<float>();
+
+  if (K == 0) {
+    std::fill_n(y_data, Y->Shape().Size(), 0.0f);
+    return Status::OK();
+  }
+
+  const size_t batch_count = helper.OutputOffsets().size();
+
+  // multiply all the matrices in one call so that MLAS can run them concurrently, which matters for the many small
+  // products of attention layers that are too small to be split across threads individually
+  std::vector<const float*> a_batch(batch_count);
+  std::vector<float*> y_batch(batch_count);
+  for (size_t i = 0; i < batch_count; i++) {
+    a_batch[i] = a_data + helper.LeftOffsets()[i];
+    y_batch[i] = y_data + helper.OutputOffsets()[i];
+  }
+
+  const void* packed_b = packed_b_.GetPackedData(*right_X);
+  if (packed_b != nullptr) {
+    // the packed B is a single matrix, so it is broadcast to every matrix of the left input
+    MlasSgemmPackedBatch(CblasNoTrans, M, N, K, /* alpha */ 1.0f, a_batch.data(), K, packed_b, /* beta */ 0.0f,
+                         y_batch.data(), N, batch_count);
+    return Status::OK();
+  }
+
+  const float* b_data = right_X->template Data<float>();
+  std::vector<const float*> b_batch(batch_count);
+  for (size_t i = 0; i < batch_count; i++) {
+    b_batch[i] = b_data + helper.RightOffsets()[i];
+  }
+
+  MlasSgemmBatch(CblasNoTrans, CblasNoTrans, M, N, K, /* alpha */ 1.0f, a_batch.data(), K, b_batch.data(), N,
+                 /* beta */ 0.0f, y_batch.data(), N, batch_count);
+
+  return Status::OK();
+}
+
 }  // namespace onnxruntime
@@ -5,6 +5,7 @@
 
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/providers/cpu/math/prepacked_gemm_b.h"
 
 namespace onnxruntime {
 
@@ -18,4 +19,18 @@ class MatMul final : public OpKernel {
   Status Compute(OpKernelContext* context) const override;
 };
 
+template <>
+class MatMul<float> final : public OpKernel {
+ public:
+  MatMul(const OpKernelInfo& info)
+      : OpKernel(info) {
+    packed_b_.Pack(info, 1, false);
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  PrePackedGemmB packed_b_;
+};
+
 }  // namespace onnxruntime
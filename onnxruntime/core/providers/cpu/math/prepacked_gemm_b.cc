@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/cpu/math/prepacked_gemm_b.h"
+
+#include "core/mlas/inc/mlas.h"
+
+namespace onnxruntime {
+
+void PrePackedGemmB::Pack(const OpKernelInfo& info, int input_index, bool trans_b) {
+  const Tensor* b;
+  if (!info.TryGetConstantInput(input_index, &b) || b->DataType() != DataTypeImpl::GetType<float>()) {
+    return;
+  }
+
+  // leading dimensions of 1 are broadcast like a 2-D B
+  const auto& shape = b->Shape();
+  const size_t num_dims = shape.NumDimensions();
+  if (num_dims < 2 || shape.SizeToDimension(num_dims - 2) != 1) {
+    return;
+  }
+
+  const size_t K = static_cast<size_t>(trans_b ? shape[num_dims - 1] : shape[num_dims - 2]);
+  const size_t N = static_cast<size_t>(trans_b ? shape[num_dims - 2] : shape[num_dims - 1]);
+  if (K == 0 || N == 0) {
+    return;
+  }
+
+  auto alloc = info.GetAllocator(0, OrtMemTypeDefault);
+  const size_t packed_size = MlasSgemmPackBSize(N, K);
+  buffer_ = BufferUniquePtr(alloc->Alloc(packed_size), BufferDeleter(alloc));
+  MlasSgemmPackB(trans_b ? CblasTrans : CblasNoTrans, N, K, b->Data<float>(), trans_b ? K : N, buffer_.get());
+  source_ = b->DataRaw();
+}
+
+void PrePackedQgemmB::Pack(const OpKernelInfo& info, int input_index, int zero_point_index) {
+  const Tensor* b;
+  if (!info.TryGetConstantInput(input_index, &b) || b->Shape().NumDimensions() != 2) {
+    return;
+  }
+
+  const bool b_is_signed = b->DataType() == DataTypeImpl::GetType<int8_t>();
+  if (!b_is_signed && b->DataType() != DataTypeImpl::GetType<uint8_t>()) {
+    return;
+  }
+
+  uint8_t b_offset = 0;
+  const Tensor* b_zero_point = nullptr;
+  if (zero_point_index >= 0) {
+    if (!info.TryGetConstantInput(zero_point_index, &b_zero_point) || b_zero_point->Shape().Size() != 1) {
+      return;
+    }
+    b_offset = *static_cast<const uint8_t*>(b_zero_point->DataRaw());
+  }
+
+  const size_t K = static_cast<size_t>(b->Shape()[0]);
+  const size_t N = static_cast<size_t>(b->Shape()[1]);
+  if (K == 0 || N == 0) {
+    return;
+  }
+
+  auto alloc = info.GetAllocator(0, OrtMemTypeDefault);
+  const size_t packed_size = MlasQgemmPackBSize(N, K);
+  buffer_ = BufferUniquePtr(alloc->Alloc(packed_size), BufferDeleter(alloc));
+  MlasQgemmPackB(N, K, static_cast<const uint8_t*>(b->DataRaw()), N, b_offset, b_is_signed, buffer_.get());
+  source_ = b->DataRaw();
+  zero_point_source_ = b_zero_point != nullptr ? b_zero_point->DataRaw() : nullptr;
+}
+
+}  // namespace onnxruntime
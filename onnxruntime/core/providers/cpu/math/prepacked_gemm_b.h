@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+#include "core/framework/tensor.h"
+
+namespace onnxruntime {
+
+/**
+The B input of a float MatMul or Gemm, packed once by MlasSgemmPackB when the kernel is created so that
+MlasSgemmPacked doesn't need to repack it on every call.
+Only constant float initializers that are 2-D, or have only leading dimensions of 1, are packed.
+*/
+class PrePackedGemmB {
+ public:
+  PrePackedGemmB() = default;
+
+  /**
+  Pack input 'input_index' of the node if it is a constant initializer.
+  @param trans_b Whether B is transposed, i.e. is N x K instead of K x N.
+  */
+  void Pack(const OpKernelInfo& info, int input_index, bool trans_b);
+
+  /**
+  Get the packed data for 'b', or null if 'b' isn't the tensor that was packed.
+  An initializer that is also a graph input can be overridden by a feed, in which case 'b' is the feed.
+  */
+  const void* GetPackedData(const Tensor& b) const {
+    return buffer_ != nullptr && b.DataRaw() == source_ ? buffer_.get() : nullptr;
+  }
+
+ private:
+  BufferUniquePtr buffer_;
+  const void* source_ = nullptr;
+};
+
+/**
+The B input of an 8-bit integer MatMul, packed once by MlasQgemmPackB when the kernel is created so that
+MlasQgemmPacked doesn't need to repack it on every call.
+Only constant 2-D uint8 or int8 initializers with a constant scalar zero point, or no zero point input, are packed.
+*/
+class PrePackedQgemmB {
+ public:
+  PrePackedQgemmB() = default;
+
+  /**
+  Pack input 'input_index' of the node if it and the zero point input 'zero_point_index' are constant initializers.
+  @param zero_point_index The index of the zero point of B, or -1 if the node has no zero point for B.
+  */
+  void Pack(const OpKernelInfo& info, int input_index, int zero_point_index);
+
+  /**
+  Get the packed data for 'b' with 'b_zero_point', or null if they aren't the tensors that were packed.
+  */
+  const void* GetPackedData(const Tensor& b, const Tensor* b_zero_point) const {
+    return buffer_ != nullptr && b.DataRaw() == source_ &&
+                   (b_zero_point == nullptr ? zero_point_source_ == nullptr
+                                            : b_zero_point->DataRaw() == zero_point_source_)
+               ? buffer_.get()
+               : nullptr;
+  }
+
+ private:
+  BufferUniquePtr buffer_;
+  const void* source_ = nullptr;
+  const void* zero_point_source_ = nullptr;
+};
+
+}  // namespace onnxruntime
@@ -73,26 +73,33 @@ Status LinearClassifier<T>::Compute(OpKernelContext* ctx) const {
   }
   Tensor* Z = ctx->Output(1, TensorShape({N, output_classes}));
 
-  int64_t zindex = 0;
+  size_t class_count = static_cast<size_t>(class_count_);
+  if (coefficients_.size() < class_count * stride) {
+    return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "X has more features than the coefficients.");
+  }
+
   const auto* x_data = X->template Data<T>();
+  std::vector<float> features_buffer;
+  const float* features = GetFloatFeatures(x_data, N, stride, stride, features_buffer);
 
-  size_t class_count = static_cast<size_t>(class_count_);
+  //scores of every point and class
+  std::vector<float> all_scores(N * class_count);
+  if (N > 0 && class_count > 0 && stride > 0) {
+    math::Gemm<float, CPUMathUtil>(CblasNoTrans, CblasTrans, N, class_count_, stride, 1.f, features,
+                                   coefficients_.data(), 0.f, all_scores.data(), &CPUMathUtil::Instance());
+  }
+
+  int64_t zindex = 0;
   std::vector<float> scores;
   scores.reserve(class_count);
   for (int64_t i = 0; i < N; i++)  //for each point
   {
     scores.clear();
-    size_t current_weight_0 = i * stride;
     int maxclass = -1;
     float maxweight = 0.f;
     for (int j = 0; j < class_count; j++)  //for each class
     {
-      size_t current_coeff_0 = j * stride;
-      float weight = 0.f;
-      for (int64_t k = 0; k < stride; k++)  //for each weight
-      {
-        weight += static_cast<float>(x_data[current_weight_0 + k] * coefficients_[current_coeff_0 + k]);
-      }
+      float weight = all_scores[i * class_count + j];
       if (intercepts_.size() == class_count) {
         weight += intercepts_[j];
       }
@@ -31,26 +31,29 @@ Status LinearRegressor<float>::Compute(OpKernelContext* ctx) const {
   int64_t stride = X->Shape().NumDimensions() == 1 ? X->Shape()[0] : X->Shape()[1];
   int64_t N = X->Shape().NumDimensions() == 1 ? 1 : X->Shape()[0];
   Tensor* Y = ctx->Output(0, TensorShape({N, targets_}));
+  if (coefficients_.size() < static_cast<size_t>(targets_ * stride)) {
+    return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "X has more features than the coefficients.");
+  }
   const auto* Xdata = X->template Data<float>();
   int64_t yindex = 0;
 
+  //scores of every point and target
+  std::vector<float> all_scores(N * targets_);
+  if (N > 0 && targets_ > 0 && stride > 0) {
+    math::Gemm<float, CPUMathUtil>(CblasNoTrans, CblasTrans, N, targets_, stride, 1.f, Xdata, coefficients_.data(),
+                                   0.f, all_scores.data(), &CPUMathUtil::Instance());
+  }
+
   bool useIntercepts = intercepts_.size() == static_cast<size_t>(targets_) ? true : false;
+  std::vector<float> scores;
   for (int64_t i = 0; i < N; i++)  //for each point
   {
-    std::vector<float> scores;
-    int64_t current_weight_0 = i * stride;
-    for (int j = 0; j < targets_; j++)  //for each target
-    {
-      int64_t current_coeff_0 = j * stride;
-      float weight = 0.f;
-      for (int64_t k = 0; k < stride; k++)  //for each weight
+    scores.assign(all_scores.begin() + i * targets_, all_scores.begin() + (i + 1) * targets_);
+    if (useIntercepts) {
+      for (int j = 0; j < targets_; j++)  //for each target
       {
-        weight = weight + Xdata[current_weight_0 + k] * coefficients_[current_coeff_0 + k];
-      }
-      if (useIntercepts) {
-        weight = weight + intercepts_[j];
+        scores[j] = scores[j] + intercepts_[j];
       }
-      scores.push_back(weight);
     }
     ::onnxruntime::ml::write_scores(scores, post_transform_, yindex, Y, -1);
     yindex += scores.size();
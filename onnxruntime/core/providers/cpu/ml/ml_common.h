@@ -2,7 +2,9 @@
 // Licensed under the MIT License.
 
 #pragma once
+#include <algorithm>
 #include "core/common/common.h"
+#include "core/common/threadpool.h"
 #include "core/framework/op_kernel.h"
 #include "core/util/math_cpuonly.h"
 
@@ -15,7 +17,7 @@ enum class OUTPUT_MODE {
   ALL_SCORES
 };
 
-enum class NODE_MODE {
+enum class NODE_MODE : uint8_t {
   BRANCH_LEQ,
   BRANCH_LT,
   BRANCH_GTE,
@@ -328,5 +330,47 @@ static inline void write_scores(std::vector<float>& scores, POST_EVAL_TRANSFORM
   }
 }
 
+// Returns the first feature_count features of each of the N rows of x_data, which start stride elements apart, as
+// a contiguous N x feature_count float matrix, converted into buffer.
+template <typename T>
+static inline const float* GetFloatFeatures(const T* x_data, int64_t N, int64_t stride, int64_t feature_count,
+                                            std::vector<float>& buffer) {
+  buffer.resize(N * feature_count);
+  for (int64_t n = 0; n < N; n++) {
+    for (int64_t k = 0; k < feature_count; k++) {
+      buffer[n * feature_count + k] = static_cast<float>(x_data[n * stride + k]);
+    }
+  }
+  return buffer.data();
+}
+
+// Float input that is already a contiguous matrix is used in place.
+static inline const float* GetFloatFeatures(const float* x_data, int64_t N, int64_t stride, int64_t feature_count,
+                                            std::vector<float>& buffer) {
+  if (stride == feature_count) {
+    return x_data;
+  }
+  buffer.resize(N * feature_count);
+  for (int64_t n = 0; n < N; n++) {
+    std::copy_n(x_data + n * stride, feature_count, buffer.data() + n * feature_count);
+  }
+  return buffer.data();
+}
+
+// ParallelRowBlockLoop: call fn(row_begin, row_count) for each block of at most block_size consecutive rows in
+// [0, N), splitting the blocks across the thread pool if there is enough work. row_cost estimates the work of each
+// row, such as the number of values it reads.
+template <typename TFunc>
+static inline void ParallelRowBlockLoop(ThreadPool* thread_pool, int64_t N, int64_t block_size, int64_t row_cost,
+                                        TFunc fn) {
+  const int64_t block_count = (N + block_size - 1) / block_size;
+  ThreadPool::TryParallelFor(thread_pool, block_count, N * row_cost, [&](int64_t begin, int64_t end) {
+    for (int64_t block = begin; block < end; block++) {
+      const int64_t row_begin = block * block_size;
+      fn(row_begin, std::min(block_size, N - row_begin));
+    }
+  });
+}
+
 }  // namespace ml
 }  // namespace onnxruntime
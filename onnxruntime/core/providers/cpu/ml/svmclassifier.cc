@@ -92,103 +92,121 @@ Status SVMClassifier<T>::Compute(OpKernelContext* ctx) const {
     dims = {static_cast<int64_t>(N), static_cast<int64_t>(class_count_)};
   Z = ctx->Output(1, TensorShape(dims));
 
+  if (stride < feature_count_) {
+    return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "X has fewer features than the model.");
+  }
+
   const auto* x_data = X->template Data<T>();
-  int64_t zindex = 0;
 
-  for (int64_t n = 0; n < N; n++)  //for each example
-  {
-    int64_t current_weight_0 = n * stride;
-    int64_t maxclass = -1;
-    double maxweight = 0.f;
-    std::vector<float> decisions;
-    std::vector<float> scores;
-    std::vector<float> kernels;
-    std::vector<int64_t> votes;
+  // the scores of every row, and for SVC the class with the most votes
+  int64_t score_count;
+  std::vector<float> all_scores;
+  std::vector<int64_t> vote_classes;
+  if (mode_ == SVM_TYPE::SVM_SVC) {
+    score_count = proba_.size() > 0 ? class_count_ : class_count_ * (class_count_ - 1) / 2;
+    all_scores.resize(N * score_count);
+    vote_classes.resize(N);
+    // the kernels read every feature once per support vector, the pairwise decisions read every kernel of the row
+    // once per class, and the probabilities take up to 100 iterations over the class pairs
+    const int64_t row_cost = vector_count_ * (feature_count_ + class_count_) +
+                             (proba_.size() > 0 ? 100 * class_count_ * class_count_ : 0);
+    ParallelRowBlockLoop(ctx->GetOperatorThreadPool(), N, kSvmRowBlockSize, row_cost,
+                         [&](int64_t row_begin, int64_t row_count) {
+      std::vector<float> features_buffer;
+      const float* features = GetFloatFeatures(x_data + row_begin * stride, row_count, stride, feature_count_,
+                                               features_buffer);
+      std::vector<float> kernels(row_count * vector_count_);
+      batched_kernel_dot(features, row_count, support_vectors_.data(), vector_count_, feature_count_,
+                         get_kernel_type(), kernels.data());
 
-    if (mode_ == SVM_TYPE::SVM_SVC) {
-      for (int64_t j = 0; j < vector_count_; j++) {
-        float val = kernel_dot(x_data, current_weight_0, support_vectors_, feature_count_ * j, feature_count_, get_kernel_type());
-        kernels.push_back(val);
-      }
-      for (int64_t j = 0; j < class_count_; j++) {
-        votes.push_back(0);
-      }
-      int evals = 0;
-      for (int64_t i = 0; i < class_count_; i++) {        //for each class
-        for (int64_t j = i + 1; j < class_count_; j++) {  //for each class
-          float sum = 0;
-          int64_t start_index_i = starting_vector_[i];  // *feature_count_;
-          int64_t start_index_j = starting_vector_[j];  // *feature_count_;
+      for (int64_t n = row_begin; n < row_begin + row_count; n++) {
+        const float* kernels_row = kernels.data() + (n - row_begin) * vector_count_;
+        std::vector<float> scores;
+        std::vector<int64_t> votes(class_count_, 0);
+        int evals = 0;
+        for (int64_t i = 0; i < class_count_; i++) {        //for each class
+          for (int64_t j = i + 1; j < class_count_; j++) {  //for each class
+            float sum = 0;
+            int64_t start_index_i = starting_vector_[i];  // *feature_count_;
+            int64_t start_index_j = starting_vector_[j];  // *feature_count_;
 
-          int64_t class_i_support_count = vectors_per_class_[i];
-          int64_t class_j_support_count = vectors_per_class_[j];
+            int64_t class_i_support_count = vectors_per_class_[i];
+            int64_t class_j_support_count = vectors_per_class_[j];
 
-          int64_t pos1 = (vector_count_) * (j - 1);
-          int64_t pos2 = (vector_count_) * (i);
-          for (int64_t m = 0; m < class_i_support_count; m++) {
-            float val1 = coefficients_[pos1 + start_index_i + m];
-            float val2 = kernels[start_index_i + m];
-            sum += val1 * val2;
-          }
-          for (int64_t m = 0; m < class_j_support_count; m++) {
-            float val1 = coefficients_[pos2 + start_index_j + m];
-            float val2 = kernels[start_index_j + m];
-            sum += val1 * val2;
-          }
+            int64_t pos1 = (vector_count_) * (j - 1);
+            int64_t pos2 = (vector_count_) * (i);
+            for (int64_t m = 0; m < class_i_support_count; m++) {
+              float val1 = coefficients_[pos1 + start_index_i + m];
+              float val2 = kernels_row[start_index_i + m];
+              sum += val1 * val2;
+            }
+            for (int64_t m = 0; m < class_j_support_count; m++) {
+              float val1 = coefficients_[pos2 + start_index_j + m];
+              float val2 = kernels_row[start_index_j + m];
+              sum += val1 * val2;
+            }
 
-          sum += rho_[evals];
-          scores.push_back(sum);
-          if (sum > 0) {
-            votes[i]++;
-          } else {
-            votes[j]++;
+            sum += rho_[evals];
+            scores.push_back(sum);
+            if (sum > 0) {
+              votes[i]++;
+            } else {
+              votes[j]++;
+            }
+            evals++;  //index into rho
           }
-          evals++;  //index into rho
         }
-      }
-    } else if (mode_ == SVM_TYPE::SVM_LINEAR) {     //liblinear
-      for (int64_t j = 0; j < class_count_; j++) {  //for each class
-        float val = kernel_dot(x_data, current_weight_0, coefficients_, feature_count_ * j, feature_count_, get_kernel_type());
-        val += rho_[0];
-        scores.push_back(val);
-      }
-    }
-    if (proba_.size() > 0 && mode_ == SVM_TYPE::SVM_SVC) {
-      //compute probabilities from the scores
-      std::vector<float> estimates;
-      std::vector<float> probsp2;
-      int64_t num = class_count_ * class_count_;
-      for (int64_t m = 0; m < num; m++) {
-        probsp2.push_back(0.f);  //min prob
-      }
-      for (int64_t m = 0; m < class_count_; m++) {
-        estimates.push_back(0.f);  //min prob
-      }
-      int64_t index = 0;
-      for (int64_t i = 0; i < class_count_; i++) {
-        for (int64_t j = i + 1; j < class_count_; j++) {
-          float val1 = sigmoid_probability(scores[index], proba_[index], probb_[index]);
-          float val2 = std::max(val1, 1.0e-7f);
-          probsp2[i * class_count_ + j] = std::min(val2, 1 - 1.0e-7f);
-          probsp2[j * class_count_ + i] = 1 - probsp2[i * class_count_ + j];
-          index++;
+        if (proba_.size() > 0) {
+          //compute probabilities from the scores
+          std::vector<float> estimates(class_count_, 0.f);  //min prob
+          std::vector<float> probsp2(class_count_ * class_count_, 0.f);
+          int64_t index = 0;
+          for (int64_t i = 0; i < class_count_; i++) {
+            for (int64_t j = i + 1; j < class_count_; j++) {
+              float val1 = sigmoid_probability(scores[index], proba_[index], probb_[index]);
+              float val2 = std::max(val1, 1.0e-7f);
+              probsp2[i * class_count_ + j] = std::min(val2, 1 - 1.0e-7f);
+              probsp2[j * class_count_ + i] = 1 - probsp2[i * class_count_ + j];
+              index++;
+            }
+          }
+          multiclass_probability(class_count_, probsp2, estimates);
+          //copy probabilities back into scores
+          scores = estimates;
         }
-      }
-      multiclass_probability(class_count_, probsp2, estimates);
-      //copy probabilities back into scores
-      scores.resize(estimates.size());
-      for (int64_t k = 0; k < static_cast<int64_t>(estimates.size()); k++) {
-        scores[k] = estimates[k];
-      }
-    }
-    int64_t maxvotes = 0;
-    if (votes.size() > 0) {
-      for (int64_t k = 0; k < static_cast<int64_t>(votes.size()); k++) {
-        if (votes[k] > maxvotes) {
-          maxvotes = votes[k];
-          maxclass = k;
+        int64_t maxclass = -1;
+        int64_t maxvotes = 0;
+        for (int64_t k = 0; k < class_count_; k++) {
+          if (votes[k] > maxvotes) {
+            maxvotes = votes[k];
+            maxclass = k;
+          }
         }
+        vote_classes[n] = maxclass;
+        std::copy(scores.begin(), scores.end(), all_scores.begin() + n * score_count);
       }
+    });
+  } else {  //liblinear
+    std::vector<float> features_buffer;
+    const float* features = GetFloatFeatures(x_data, N, stride, feature_count_, features_buffer);
+    score_count = class_count_;
+    all_scores.resize(N * score_count);
+    batched_kernel_dot(features, N, coefficients_.data(), class_count_, feature_count_, KERNEL::LINEAR,
+                       all_scores.data());
+    for (float& score : all_scores) {
+      score += rho_[0];
+    }
+  }
+
+  int64_t zindex = 0;
+  std::vector<float> scores;
+  for (int64_t n = 0; n < N; n++)  //for each example
+  {
+    scores.assign(all_scores.begin() + n * score_count, all_scores.begin() + (n + 1) * score_count);
+    int64_t maxclass = -1;
+    double maxweight = 0.f;
+    if (mode_ == SVM_TYPE::SVM_SVC) {
+      maxclass = vote_classes[n];
     } else {
       for (int64_t k = 0; k < static_cast<int64_t>(scores.size()); k++) {
         if (scores[k] > maxweight) {
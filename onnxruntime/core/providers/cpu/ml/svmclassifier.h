@@ -5,12 +5,17 @@
 
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 #include "ml_common.h"
 
 namespace onnxruntime {
 namespace ml {
 
+// The SVC kernels are computed for blocks of this many rows, so their buffer does not grow with the batch.
+constexpr int64_t kSvmRowBlockSize = 64;
+
 // stuffs shared by SVMClassifier and SVMRegressor
 template <typename T>
 class SVMCommon {
@@ -29,32 +34,46 @@ class SVMCommon {
   void set_kernel_type(KERNEL new_kernel_type) { kernel_type_ = new_kernel_type; }
   KERNEL get_kernel_type() const { return kernel_type_; }
 
-  float kernel_dot(const T* A, int64_t a, const std::vector<float>& B, int64_t b, int64_t len, KERNEL k) const {
-    float sum = 0.f;
+  // Computes the kernel of each of the N rows of the N x feature_count matrix x_data with each of the vector_count
+  // vectors of feature_count elements in vectors, into the N x vector_count matrix kernels. The dot products are a
+  // single matrix multiplication. The RBF distances are summed from the differences instead, as expanding them into
+  // |x|^2 + |v|^2 - 2 x.v cancels away the distance of nearby points with large coordinates.
+  void batched_kernel_dot(const float* x_data, int64_t N, const float* vectors, int64_t vector_count,
+                          int64_t feature_count, KERNEL k, float* kernels) const {
+    const int64_t kernel_count = N * vector_count;
+    if (kernel_count == 0) {
+      return;
+    }
+
+    EigenVectorArrayMap<float> kernel_values(kernels, kernel_count);
+    if (k == KERNEL::RBF) {
+      for (int64_t n = 0; n < N; n++) {
+        ConstEigenVectorArrayMap<float> x(x_data + n * feature_count, feature_count);
+        float* row = kernels + n * vector_count;
+        for (int64_t j = 0; j < vector_count; j++) {
+          row[j] = (x - ConstEigenVectorArrayMap<float>(vectors + j * feature_count, feature_count)).square().sum();
+        }
+      }
+      kernel_values = (kernel_values * -gamma_).exp();
+      return;
+    }
+
+    if (feature_count == 0) {
+      std::fill_n(kernels, kernel_count, 0.f);
+    } else {
+      const float alpha = (k == KERNEL::POLY || k == KERNEL::SIGMOID) ? gamma_ : 1.f;
+      math::Gemm<float, CPUMathUtil>(CblasNoTrans, CblasTrans, N, vector_count, feature_count, alpha, x_data, vectors,
+                                     0.f, kernels, &CPUMathUtil::Instance());
+    }
+
     if (k == KERNEL::POLY) {
-      for (int64_t i = 0; i < len; i++) {
-        sum += B[b + i] * static_cast<float>(A[a + i]);
+      for (int64_t i = 0; i < kernel_count; i++) {
+        kernels[i] = std::pow(kernels[i] + coef0_, degree_);
       }
-      sum = gamma_ * sum + coef0_;
-      sum = std::pow(sum, degree_);
     } else if (k == KERNEL::SIGMOID) {
-      for (int64_t i = 0; i < len; i++) {
-        sum += B[b + i] * static_cast<float>(A[a + i]);
-      }
-      sum = gamma_ * sum + coef0_;
-      sum = std::tanh(sum);
-    } else if (k == KERNEL::RBF) {
-      for (int64_t i = 0; i < len; i++) {
-        float val = static_cast<float>(A[a + i]) - B[b + i];
-        sum += (val * val);
-      }
-      sum = std::exp(-gamma_ * sum);
-    } else if (k == KERNEL::LINEAR) {
-      for (int64_t i = 0; i < len; i++) {
-        sum += B[b + i] * static_cast<float>(A[a + i]);
-      }
+      kernel_values += coef0_;
+      MlasComputeTanh(kernels, kernels, static_cast<size_t>(kernel_count));
     }
-    return sum;
   }
 
  private:
@@ -66,7 +85,7 @@ class SVMCommon {
 
 template <typename T>
 class SVMClassifier final : public OpKernel, private SVMCommon<T> {
-  using SVMCommon<T>::kernel_dot;
+  using SVMCommon<T>::batched_kernel_dot;
   using SVMCommon<T>::set_kernel_type;
   using SVMCommon<T>::get_kernel_type;
 
@@ -44,31 +44,49 @@ Status SVMRegressor<T>::Compute(OpKernelContext* ctx) const {
   int64_t N = X->Shape().NumDimensions() == 1 ? 1 : X->Shape()[0];
 
   Tensor* Y = ctx->Output(0, TensorShape({N, 1}));  // this op outputs for one target only
-  const auto* x_data = X->template Data<T>();
-
-  for (int64_t n = 0; n < N; n++) {  //for each example
-    int64_t current_weight_0 = n * stride;
-    std::vector<float> scores;
+  if (stride < feature_count_) {
+    return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "X has fewer features than the model.");
+  }
 
-    float sum = 0.f;
-    if (mode_ == SVM_TYPE::SVM_SVC) {
-      for (int64_t j = 0; j < vector_count_; j++) {
-        float val1 = kernel_dot(x_data, current_weight_0, support_vectors_, feature_count_ * j, feature_count_, get_kernel_type());
-        float val2 = coefficients_[j];
-        float val3 = val1 * val2;
-        sum += val3;
+  const auto* x_data = X->template Data<T>();
+  std::vector<float> sums(N, 0.f);
+  if (mode_ == SVM_TYPE::SVM_SVC) {
+    // the kernels read every feature once per support vector, and the sum reads every kernel once
+    const int64_t row_cost = vector_count_ * (feature_count_ + 1);
+    ParallelRowBlockLoop(ctx->GetOperatorThreadPool(), N, kSvmRowBlockSize, row_cost,
+                         [&](int64_t row_begin, int64_t row_count) {
+      std::vector<float> features_buffer;
+      const float* features = GetFloatFeatures(x_data + row_begin * stride, row_count, stride, feature_count_,
+                                               features_buffer);
+      std::vector<float> kernels(row_count * vector_count_);
+      batched_kernel_dot(features, row_count, support_vectors_.data(), vector_count_, feature_count_,
+                         get_kernel_type(), kernels.data());
+      for (int64_t n = row_begin; n < row_begin + row_count; n++) {  //for each example
+        const float* kernels_row = kernels.data() + (n - row_begin) * vector_count_;
+        float sum = 0.f;
+        for (int64_t j = 0; j < vector_count_; j++) {
+          sum += kernels_row[j] * coefficients_[j];
+        }
+        sums[n] = sum + rho_[0];
       }
-      sum += rho_[0];
-    } else if (mode_ == SVM_TYPE::SVM_LINEAR) {  //liblinear
-      sum = kernel_dot(x_data, current_weight_0, coefficients_, 0, feature_count_, get_kernel_type());
+    });
+  } else if (mode_ == SVM_TYPE::SVM_LINEAR) {  //liblinear
+    std::vector<float> features_buffer;
+    const float* features = GetFloatFeatures(x_data, N, stride, feature_count_, features_buffer);
+    batched_kernel_dot(features, N, coefficients_.data(), 1, feature_count_, get_kernel_type(), sums.data());
+    for (float& sum : sums) {
       sum += rho_[0];
     }
-    if (one_class_ && sum > 0) {
-      Y->template MutableData<float>()[n] = 1.f;
+  }
+
+  float* y_data = Y->template MutableData<float>();
+  for (int64_t n = 0; n < N; n++) {
+    if (one_class_ && sums[n] > 0) {
+      y_data[n] = 1.f;
     } else if (one_class_) {
-      Y->template MutableData<float>()[n] = -1.f;
+      y_data[n] = -1.f;
     } else {
-      Y->template MutableData<float>()[n] = sum;
+      y_data[n] = sums[n];
     }
   }
 
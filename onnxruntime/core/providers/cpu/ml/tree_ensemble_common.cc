@@ -0,0 +1,252 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/cpu/ml/tree_ensemble_common.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <numeric>
+
+namespace onnxruntime {
+namespace ml {
+
+namespace {
+
+const int64_t kMaxTreeDepth = 1000;
+
+// The attributes of the tree nodes, indexed by the position of the node in the attributes.
+struct TreeNodeAttributes {
+  std::vector<int64_t> treeids;
+  std::vector<int64_t> featureids;
+  std::vector<float> values;
+  std::vector<NODE_MODE> modes;
+  std::vector<int64_t> missing_tracks_true;
+  std::vector<size_t> true_children;
+  std::vector<size_t> false_children;
+  std::vector<int32_t> leaf_weights_begin;
+  std::vector<int32_t> leaf_weights_count;
+};
+
+// Appends the node at index and its subtrees to nodes, true branch first, and returns its position.
+int32_t AddTreeNode(const TreeNodeAttributes& attributes, size_t index, int64_t depth,
+                    const std::vector<TreeLeafWeight>& weights, bool sum_leaf_weights,
+                    std::vector<TreeNodeElement>& nodes, std::vector<bool>& visited) {
+  ORT_ENFORCE(depth <= kMaxTreeDepth, "Tree ", attributes.treeids[index], " is deeper than ", kMaxTreeDepth, ".");
+  ORT_ENFORCE(!visited[index], "Node ", index, " of tree ", attributes.treeids[index], " has more than one parent.");
+  ORT_ENFORCE(nodes.size() < static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+  visited[index] = true;
+
+  const int32_t position = static_cast<int32_t>(nodes.size());
+  nodes.emplace_back();
+
+  TreeNodeElement node{};
+  node.mode = attributes.modes[index];
+
+  if (node.mode == NODE_MODE::LEAF) {
+    node.feature_id = attributes.leaf_weights_count[index];
+    node.false_child = attributes.leaf_weights_begin[index];
+    if (sum_leaf_weights) {
+      for (int32_t i = 0; i < node.feature_id; i++) {
+        node.value += weights[node.false_child + i].value;
+      }
+    }
+  } else {
+    node.feature_id = static_cast<int32_t>(attributes.featureids[index]);
+    node.value = attributes.values[index];
+    node.missing_tracks_true = attributes.missing_tracks_true.size() == attributes.modes.size() &&
+                               attributes.missing_tracks_true[index] != 0;
+    AddTreeNode(attributes, attributes.true_children[index], depth + 1, weights, sum_leaf_weights, nodes, visited);
+    node.false_child =
+        AddTreeNode(attributes, attributes.false_children[index], depth + 1, weights, sum_leaf_weights, nodes, visited);
+  }
+
+  nodes[position] = node;
+  return position;
+}
+
+}  // namespace
+
+TreeEnsembleCommon::TreeEnsembleCommon(const OpKernelInfo& info, const std::string& weights_prefix) {
+  TreeNodeAttributes attributes;
+  attributes.treeids = info.GetAttrsOrDefault<int64_t>("nodes_treeids");
+  attributes.featureids = info.GetAttrsOrDefault<int64_t>("nodes_featureids");
+  attributes.values = info.GetAttrsOrDefault<float>("nodes_values");
+  attributes.missing_tracks_true = info.GetAttrsOrDefault<int64_t>("nodes_missing_value_tracks_true");
+
+  std::vector<int64_t> nodes_nodeids = info.GetAttrsOrDefault<int64_t>("nodes_nodeids");
+  std::vector<float> nodes_hitrates = info.GetAttrsOrDefault<float>("nodes_hitrates");
+  std::vector<std::string> nodes_modes = info.GetAttrsOrDefault<std::string>("nodes_modes");
+  std::vector<int64_t> nodes_truenodeids = info.GetAttrsOrDefault<int64_t>("nodes_truenodeids");
+  std::vector<int64_t> nodes_falsenodeids = info.GetAttrsOrDefault<int64_t>("nodes_falsenodeids");
+
+  std::vector<int64_t> weights_treeids = info.GetAttrsOrDefault<int64_t>(weights_prefix + "_treeids");
+  std::vector<int64_t> weights_nodeids = info.GetAttrsOrDefault<int64_t>(weights_prefix + "_nodeids");
+  std::vector<int64_t> weights_ids = info.GetAttrsOrDefault<int64_t>(weights_prefix + "_ids");
+  std::vector<float> weights_values = info.GetAttrsOrDefault<float>(weights_prefix + "_weights");
+
+  const size_t node_count = nodes_nodeids.size();
+  ORT_ENFORCE(!attributes.treeids.empty());
+  ORT_ENFORCE(node_count == attributes.treeids.size());
+  ORT_ENFORCE(node_count == attributes.featureids.size());
+  ORT_ENFORCE(node_count == attributes.values.size());
+  ORT_ENFORCE(node_count == nodes_modes.size());
+  ORT_ENFORCE(node_count == nodes_truenodeids.size());
+  ORT_ENFORCE(node_count == nodes_falsenodeids.size());
+  ORT_ENFORCE((node_count == nodes_hitrates.size()) || (nodes_hitrates.empty()));
+  ORT_ENFORCE(weights_nodeids.size() == weights_treeids.size());
+  ORT_ENFORCE(weights_nodeids.size() == weights_ids.size());
+  ORT_ENFORCE(weights_nodeids.size() == weights_values.size());
+
+  // in the absence of bool type supported by GetAttrs this ensure that we don't have any negative
+  // values so that we can check for the truth condition without worrying about negative values.
+  ORT_ENFORCE(std::all_of(std::begin(attributes.missing_tracks_true), std::end(attributes.missing_tracks_true),
+                          [](int64_t elem) { return elem >= 0; }));
+
+  attributes.modes.reserve(node_count);
+  for (const auto& mode : nodes_modes) {
+    attributes.modes.push_back(MakeTreeNodeMode(mode));
+  }
+
+  // Index the nodes by tree id and node id. Node ids are only unique within a tree.
+  std::map<std::pair<int64_t, int64_t>, size_t> node_indices;
+  for (size_t i = 0; i < node_count; i++) {
+    node_indices.emplace(std::make_pair(attributes.treeids[i], nodes_nodeids[i]), i);
+  }
+
+  // Resolve the children of the branch nodes. The nodes that are nobody's child are the roots.
+  attributes.true_children.resize(node_count);
+  attributes.false_children.resize(node_count);
+  std::vector<bool> is_child(node_count, false);
+  for (size_t i = 0; i < node_count; i++) {
+    if (attributes.modes[i] == NODE_MODE::LEAF) continue;
+    ORT_ENFORCE(attributes.featureids[i] >= 0 && attributes.featureids[i] < std::numeric_limits<int32_t>::max(),
+                "Invalid feature id ", attributes.featureids[i], " for node ", i, ".");
+    feature_count_ = std::max(feature_count_, attributes.featureids[i] + 1);
+    // they must be in the same tree
+    auto true_child = node_indices.find(std::make_pair(attributes.treeids[i], nodes_truenodeids[i]));
+    auto false_child = node_indices.find(std::make_pair(attributes.treeids[i], nodes_falsenodeids[i]));
+    ORT_ENFORCE(true_child != node_indices.end() && false_child != node_indices.end(),
+                "Node ", i, " of tree ", attributes.treeids[i], " has a child that is not in the tree.");
+    attributes.true_children[i] = true_child->second;
+    attributes.false_children[i] = false_child->second;
+    is_child[true_child->second] = true;
+    is_child[false_child->second] = true;
+  }
+
+  // Gather the weights of each leaf into a contiguous range.
+  std::vector<size_t> weight_order(weights_nodeids.size());
+  std::iota(weight_order.begin(), weight_order.end(), size_t{0});
+  std::stable_sort(weight_order.begin(), weight_order.end(), [&](size_t w1, size_t w2) {
+    return std::make_pair(weights_treeids[w1], weights_nodeids[w1]) <
+           std::make_pair(weights_treeids[w2], weights_nodeids[w2]);
+  });
+
+  attributes.leaf_weights_begin.resize(node_count, 0);
+  attributes.leaf_weights_count.resize(node_count, 0);
+  for (size_t w : weight_order) {
+    auto node = node_indices.find(std::make_pair(weights_treeids[w], weights_nodeids[w]));
+    if (node == node_indices.end()) continue;
+    ORT_ENFORCE(weights_ids[w] >= 0 && weights_ids[w] < std::numeric_limits<int32_t>::max(),
+                "Invalid id ", weights_ids[w], " for weight ", w, ".");
+    if (attributes.leaf_weights_count[node->second] == 0) {
+      attributes.leaf_weights_begin[node->second] = static_cast<int32_t>(weights_.size());
+    }
+    attributes.leaf_weights_count[node->second]++;
+    weights_.push_back({static_cast<int32_t>(weights_ids[w]), weights_values[w]});
+    score_count_ = std::max(score_count_, weights_ids[w] + 1);
+  }
+
+  // If every weight has the same id, the weights of each leaf are summed into the leaf.
+  const bool sum_leaf_weights =
+      !weights_.empty() && std::all_of(weights_.begin(), weights_.end(),
+                                       [this](const TreeLeafWeight& weight) { return weight.id == weights_[0].id; });
+  if (sum_leaf_weights) {
+    single_id_ = weights_[0].id;
+  }
+
+  // Lay out each tree from its root.
+  nodes_.reserve(node_count);
+  std::vector<bool> visited(node_count, false);
+  for (size_t i = 0; i < node_count; i++) {
+    if (!is_child[i]) {
+      roots_.push_back(AddTreeNode(attributes, i, 0, weights_, sum_leaf_weights, nodes_, visited));
+    }
+  }
+
+  // Every node is a child, so a node that no root reaches is in a cycle.
+  const size_t unreachable = static_cast<size_t>(std::find(visited.begin(), visited.end(), false) - visited.begin());
+  ORT_ENFORCE(unreachable == node_count,
+              "Node ", unreachable, " of tree ", attributes.treeids[unreachable], " is not reachable from a root.");
+
+  InitializeQuickScorer();
+}
+
+void TreeEnsembleCommon::InitializeQuickScorer() {
+  for (const TreeNodeElement& node : nodes_) {
+    if (node.mode != NODE_MODE::LEAF &&
+        ((node.mode != NODE_MODE::BRANCH_LEQ && node.mode != NODE_MODE::BRANCH_LT) || node.missing_tracks_true ||
+         std::isnan(node.value))) {
+      return;
+    }
+  }
+
+  struct SortableNode {
+    int32_t feature_id;
+    float threshold;
+    bool strict;
+    QuickScorerNode node;
+  };
+  std::vector<SortableNode> branches;
+  std::vector<int32_t> leaves(roots_.size() * 64, 0);
+
+  // The nodes of each tree are laid out depth first with the true branch first, so the leaves of a tree are in
+  // left to right order and the true branch of the node at position p is in [p + 1, false_child).
+  std::vector<int32_t> leaves_before;
+  for (size_t tree = 0; tree < roots_.size(); tree++) {
+    const int32_t begin = roots_[tree];
+    const int32_t end = tree + 1 < roots_.size() ? roots_[tree + 1] : static_cast<int32_t>(nodes_.size());
+    leaves_before.assign(1, 0);
+    for (int32_t p = begin; p < end; p++) {
+      const bool is_leaf = nodes_[p].mode == NODE_MODE::LEAF;
+      if (is_leaf) {
+        if (leaves_before.back() == 64) {
+          return;
+        }
+        leaves[tree * 64 + leaves_before.back()] = p;
+      }
+      leaves_before.push_back(leaves_before.back() + (is_leaf ? 1 : 0));
+    }
+    for (int32_t p = begin; p < end; p++) {
+      const TreeNodeElement& node = nodes_[p];
+      if (node.mode == NODE_MODE::LEAF) continue;
+      const int32_t first_true_leaf = leaves_before[p + 1 - begin];
+      const int32_t true_leaf_count = leaves_before[node.false_child - begin] - first_true_leaf;
+      const uint64_t true_leaves = ((uint64_t{1} << true_leaf_count) - 1) << first_true_leaf;
+      branches.push_back({node.feature_id, node.value, node.mode == NODE_MODE::BRANCH_LT,
+                          {node.value, static_cast<int32_t>(tree), ~true_leaves}});
+    }
+  }
+
+  std::stable_sort(branches.begin(), branches.end(), [](const SortableNode& n1, const SortableNode& n2) {
+    if (n1.feature_id != n2.feature_id) return n1.feature_id < n2.feature_id;
+    if (n1.threshold != n2.threshold) return n1.threshold < n2.threshold;
+    return n1.strict && !n2.strict;
+  });
+
+  quick_scorer_feature_offsets_.assign(static_cast<size_t>(feature_count_) + 1, 0);
+  quick_scorer_nodes_.reserve(branches.size());
+  quick_scorer_strict_.reserve(branches.size());
+  for (const SortableNode& branch : branches) {
+    quick_scorer_feature_offsets_[branch.feature_id + 1]++;
+    quick_scorer_nodes_.push_back(branch.node);
+    quick_scorer_strict_.push_back(branch.strict ? 1 : 0);
+  }
+  std::partial_sum(quick_scorer_feature_offsets_.begin(), quick_scorer_feature_offsets_.end(),
+                   quick_scorer_feature_offsets_.begin());
+  quick_scorer_leaves_ = std::move(leaves);
+  use_quick_scorer_ = true;
+}
+
+}  // namespace ml
+}  // namespace onnxruntime
@@ -0,0 +1,424 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "core/common/common.h"
+#include "core/common/threadpool.h"
+#include "core/framework/op_kernel.h"
+#include "ml_common.h"
+
+namespace onnxruntime {
+namespace ml {
+
+// A node of a compiled tree ensemble. The nodes of each tree are laid out depth first with the true branch first,
+// so the true child of a branch node is always the next node and only the false child is stored. A node takes 16
+// bytes, so four nodes share a cache line.
+struct TreeNodeElement {
+  // The threshold of a branch node. For a leaf of an ensemble whose weights all have the same id, the sum of the
+  // weights of the leaf.
+  float value;
+  // The feature of a branch node, or the number of weights of a leaf.
+  int32_t feature_id;
+  // The index of the false child of a branch node, or the index of the first weight of a leaf.
+  int32_t false_child;
+  NODE_MODE mode;
+  bool missing_tracks_true;
+};
+
+struct TreeLeafWeight {
+  int32_t id;
+  float value;
+};
+
+// A branch node of an ensemble evaluated with QuickScorer. The leaves of each tree are numbered from left to right,
+// with the true branch on the left, and the bits of false_leaves are cleared for the leaves of the true branch,
+// which cannot be reached if the node is false.
+struct QuickScorerNode {
+  float threshold;
+  int32_t tree;
+  uint64_t false_leaves;
+};
+
+// The trees of a TreeEnsembleClassifier or TreeEnsembleRegressor, compiled from the nodes_* attributes and the
+// weight attributes when the kernel is constructed. The weights of each leaf are stored contiguously.
+class TreeEnsembleCommon {
+ public:
+  // weights_prefix names the weight attributes: <weights_prefix>_treeids, _nodeids, _ids and _weights.
+  TreeEnsembleCommon(const OpKernelInfo& info, const std::string& weights_prefix);
+
+  // Size of the score arrays passed to ComputeScores, which is one more than the largest weight id.
+  int64_t ScoreCount() const { return score_count_; }
+
+  // One more than the largest feature id read by a branch node.
+  int64_t FeatureCount() const { return feature_count_; }
+
+  size_t TreeCount() const { return roots_.size(); }
+
+  // Walks every tree for row_count rows of x_data, which start x_stride elements apart, and adds the weights of the
+  // leaves reached to the scores of each row, which start scores_stride elements apart. has_scores is set for every
+  // id that received a weight. Large batches are split by rows across the thread pool, and small batches of large
+  // ensembles are split by blocks of trees. The scores of each block of trees are summed on their own and added in
+  // block order however the batch is split, so the scores are the same for any number of threads.
+  template <typename T>
+  void ComputeScores(const T* x_data, int64_t row_count, int64_t x_stride,
+                     float* scores, unsigned char* has_scores, int64_t scores_stride,
+                     ThreadPool* thread_pool) const;
+
+ private:
+  template <typename T>
+  const TreeNodeElement* ProcessTree(const TreeNodeElement* node, const T* x_data) const;
+
+  template <typename T>
+  void ComputeTreeScores(const T* x_data, int64_t row_count, int64_t x_stride, size_t tree_begin, size_t tree_end,
+                         float* scores, unsigned char* has_scores, int64_t scores_stride) const;
+
+  template <typename T>
+  void ComputeQuickScorerScores(const T* x_data, int64_t row_count, int64_t x_stride,
+                                float* scores, unsigned char* has_scores, int64_t scores_stride) const;
+
+  void InitializeQuickScorer();
+
+  std::vector<TreeNodeElement> nodes_;
+  std::vector<int32_t> roots_;
+  std::vector<TreeLeafWeight> weights_;
+  int64_t score_count_{0};
+  int64_t feature_count_{0};
+  // The id of every weight if they all have the same id, such as for a binary classifier or a single target
+  // regressor, else -1.
+  int64_t single_id_{-1};
+
+  // QuickScorer evaluates the trees feature by feature instead of walking them, which avoids the mispredicted
+  // branches of deep trees. It is used if every branch is BRANCH_LEQ or BRANCH_LT without missing value tracking
+  // and every tree has at most 64 leaves. The branch nodes are sorted by feature, then by threshold with the
+  // BRANCH_LT nodes first, so the nodes of a feature that are false for a value come before those that are true.
+  bool use_quick_scorer_{false};
+  std::vector<QuickScorerNode> quick_scorer_nodes_;
+  // Whether each of quick_scorer_nodes_ is BRANCH_LT.
+  std::vector<unsigned char> quick_scorer_strict_;
+  // The range of quick_scorer_nodes_ of each feature.
+  std::vector<int32_t> quick_scorer_feature_offsets_;
+  // The node of each leaf of each tree, 64 per tree.
+  std::vector<int32_t> quick_scorer_leaves_;
+};
+
+inline int32_t LowestSetBit(uint64_t value) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return static_cast<int32_t>(index);
+#else
+  return __builtin_ctzll(value);
+#endif
+}
+
+template <typename T>
+inline const TreeNodeElement* TreeEnsembleCommon::ProcessTree(const TreeNodeElement* node, const T* x_data) const {
+  while (node->mode != NODE_MODE::LEAF) {
+    const T val = x_data[node->feature_id];
+    const float threshold = node->value;
+    bool is_true;
+    switch (node->mode) {
+      case NODE_MODE::BRANCH_LEQ:
+        is_true = val <= threshold;
+        break;
+      case NODE_MODE::BRANCH_LT:
+        is_true = val < threshold;
+        break;
+      case NODE_MODE::BRANCH_GTE:
+        is_true = val >= threshold;
+        break;
+      case NODE_MODE::BRANCH_GT:
+        is_true = val > threshold;
+        break;
+      case NODE_MODE::BRANCH_EQ:
+        is_true = val == threshold;
+        break;
+      default:
+        is_true = val != threshold;
+        break;
+    }
+    if (!is_true && node->missing_tracks_true) {
+      is_true = std::isnan(static_cast<float>(val));
+    }
+    node = is_true ? node + 1 : nodes_.data() + node->false_child;
+  }
+  return node;
+}
+
+// Number of rows that are walked through each tree together, so that the nodes of the tree are loaded once for all
+// the rows of the block.
+constexpr int64_t kTreeRowBlockSize = 16;
+
+// Number of rows that are evaluated together by QuickScorer.
+constexpr int64_t kQuickScorerRowBlockSize = 8;
+
+// Estimated work of walking one row through one tree, in the units of ThreadPool::kMinWorkPerTask.
+constexpr int64_t kTreeWalkWork = 8;
+
+// Number of trees whose scores are summed on their own before they are added to the scores of a row, in block order.
+// A batch that is split by trees is split by these blocks.
+constexpr int64_t kTreeBlockSize = 16;
+
+template <typename T>
+void TreeEnsembleCommon::ComputeTreeScores(const T* x_data, int64_t row_count, int64_t x_stride,
+                                           size_t tree_begin, size_t tree_end,
+                                           float* scores, unsigned char* has_scores, int64_t scores_stride) const {
+  if (use_quick_scorer_ && tree_begin == 0 && tree_end == roots_.size()) {
+    ComputeQuickScorerScores(x_data, row_count, x_stride, scores, has_scores, scores_stride);
+    return;
+  }
+
+  const TreeNodeElement* nodes = nodes_.data();
+
+  // The trees of the first block of kTreeBlockSize trees add to the scores, and those of each later block are summed
+  // on their own and then added to the scores.
+  const size_t tree_block_size = static_cast<size_t>(kTreeBlockSize);
+  std::vector<float> tree_block_scores;
+  if (single_id_ < 0 && tree_end > (tree_begin / tree_block_size + 1) * tree_block_size) {
+    tree_block_scores.resize(static_cast<size_t>(kTreeRowBlockSize * score_count_));
+  }
+
+  for (int64_t block_begin = 0; block_begin < row_count; block_begin += kTreeRowBlockSize) {
+    const int64_t block_size = std::min(kTreeRowBlockSize, row_count - block_begin);
+    const T* x_block = x_data + block_begin * x_stride;
+    float* scores_block = scores + block_begin * scores_stride;
+    unsigned char* has_scores_block = has_scores + block_begin * scores_stride;
+
+    if (single_id_ >= 0) {
+      float block_scores[kTreeRowBlockSize];
+      float block_tree_block_scores[kTreeRowBlockSize];
+      bool block_has_scores[kTreeRowBlockSize];
+      for (int64_t r = 0; r < block_size; r++) {
+        block_scores[r] = scores_block[r * scores_stride + single_id_];
+        block_has_scores[r] = false;
+      }
+      for (size_t tree_block_begin = tree_begin, tree_block_end; tree_block_begin < tree_end;
+           tree_block_begin = tree_block_end) {
+        tree_block_end = std::min(tree_end, (tree_block_begin / tree_block_size + 1) * tree_block_size);
+        float* sums = block_scores;
+        if (tree_block_begin != tree_begin) {
+          sums = block_tree_block_scores;
+          std::fill_n(sums, block_size, 0.f);
+        }
+        for (size_t tree = tree_block_begin; tree < tree_block_end; tree++) {
+          const TreeNodeElement* root = nodes + roots_[tree];
+          for (int64_t r = 0; r < block_size; r++) {
+            const TreeNodeElement* leaf = ProcessTree(root, x_block + r * x_stride);
+            sums[r] += leaf->value;
+            block_has_scores[r] |= leaf->feature_id > 0;
+          }
+        }
+        if (sums != block_scores) {
+          for (int64_t r = 0; r < block_size; r++) {
+            block_scores[r] += sums[r];
+          }
+        }
+      }
+      for (int64_t r = 0; r < block_size; r++) {
+        scores_block[r * scores_stride + single_id_] = block_scores[r];
+        if (block_has_scores[r]) {
+          has_scores_block[r * scores_stride + single_id_] = 1;
+        }
+      }
+      continue;
+    }
+
+    for (size_t tree_block_begin = tree_begin, tree_block_end; tree_block_begin < tree_end;
+         tree_block_begin = tree_block_end) {
+      tree_block_end = std::min(tree_end, (tree_block_begin / tree_block_size + 1) * tree_block_size);
+      float* sums = scores_block;
+      int64_t sums_stride = scores_stride;
+      if (tree_block_begin != tree_begin) {
+        sums = tree_block_scores.data();
+        sums_stride = score_count_;
+        std::fill_n(sums, block_size * score_count_, 0.f);
+      }
+      for (size_t tree = tree_block_begin; tree < tree_block_end; tree++) {
+        const TreeNodeElement* root = nodes + roots_[tree];
+        for (int64_t r = 0; r < block_size; r++) {
+          const TreeNodeElement* leaf = ProcessTree(root, x_block + r * x_stride);
+          float* row_sums = sums + r * sums_stride;
+          unsigned char* row_has_scores = has_scores_block + r * scores_stride;
+          const TreeLeafWeight* weight = weights_.data() + leaf->false_child;
+          for (const TreeLeafWeight* end = weight + leaf->feature_id; weight < end; ++weight) {
+            row_sums[weight->id] += weight->value;
+            row_has_scores[weight->id] = 1;
+          }
+        }
+      }
+      if (sums != scores_block) {
+        for (int64_t r = 0; r < block_size; r++) {
+          for (int64_t id = 0; id < score_count_; id++) {
+            scores_block[r * scores_stride + id] += sums[r * sums_stride + id];
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void TreeEnsembleCommon::ComputeQuickScorerScores(const T* x_data, int64_t row_count, int64_t x_stride,
+                                                  float* scores, unsigned char* has_scores,
+                                                  int64_t scores_stride) const {
+  const size_t tree_count = roots_.size();
+  const QuickScorerNode* qs_nodes = quick_scorer_nodes_.data();
+  const unsigned char* qs_strict = quick_scorer_strict_.data();
+  const int64_t feature_count = static_cast<int64_t>(quick_scorer_feature_offsets_.size()) - 1;
+
+  // The leaves of each tree that are still reachable for each row of the block, stored tree by tree so that the
+  // loop over the rows of the block can be vectorized.
+  std::vector<uint64_t> reachable_leaves(tree_count * kQuickScorerRowBlockSize);
+  T x_feature[kQuickScorerRowBlockSize];
+
+  const size_t tree_block_size = static_cast<size_t>(kTreeBlockSize);
+  std::vector<float> tree_block_scores;
+  if (single_id_ < 0 && tree_count > tree_block_size) {
+    tree_block_scores.resize(static_cast<size_t>(score_count_));
+  }
+
+  for (int64_t block_begin = 0; block_begin < row_count; block_begin += kQuickScorerRowBlockSize) {
+    const int64_t block_size = std::min(kQuickScorerRowBlockSize, row_count - block_begin);
+    const T* x_block = x_data + block_begin * x_stride;
+    std::fill(reachable_leaves.begin(), reachable_leaves.end(), ~uint64_t{0});
+
+    for (int64_t f = 0; f < feature_count; f++) {
+      // Rows past the end of the block repeat the last row, so they never extend the scan of a feature.
+      for (int64_t r = 0; r < kQuickScorerRowBlockSize; r++) {
+        x_feature[r] = x_block[std::min(r, block_size - 1) * x_stride + f];
+      }
+      for (int32_t i = quick_scorer_feature_offsets_[f], end = quick_scorer_feature_offsets_[f + 1]; i < end; i++) {
+        const float threshold = qs_nodes[i].threshold;
+        const uint64_t false_leaves = qs_nodes[i].false_leaves;
+        uint64_t* tree_leaves = reachable_leaves.data() + qs_nodes[i].tree * kQuickScorerRowBlockSize;
+        bool any_false = false;
+        if (qs_strict[i]) {
+          for (int64_t r = 0; r < kQuickScorerRowBlockSize; r++) {
+            const bool is_false = !(x_feature[r] < threshold);
+            tree_leaves[r] &= is_false ? false_leaves : ~uint64_t{0};
+            any_false |= is_false;
+          }
+        } else {
+          for (int64_t r = 0; r < kQuickScorerRowBlockSize; r++) {
+            const bool is_false = !(x_feature[r] <= threshold);
+            tree_leaves[r] &= is_false ? false_leaves : ~uint64_t{0};
+            any_false |= is_false;
+          }
+        }
+        // The remaining nodes of the feature are true for every row.
+        if (!any_false) break;
+      }
+    }
+
+    // The leaf reached in each tree is the leftmost reachable leaf. The scores are added in blocks of kTreeBlockSize
+    // trees in the same order as ComputeTreeScores.
+    for (int64_t r = 0; r < block_size; r++) {
+      float* row_scores = scores + (block_begin + r) * scores_stride;
+      unsigned char* row_has_scores = has_scores + (block_begin + r) * scores_stride;
+      float row_score = single_id_ >= 0 ? row_scores[single_id_] : 0.f;
+      bool row_has_score = false;
+      for (size_t tree_block_begin = 0, tree_block_end; tree_block_begin < tree_count;
+           tree_block_begin = tree_block_end) {
+        tree_block_end = std::min(tree_count, tree_block_begin + tree_block_size);
+        float sum = tree_block_begin == 0 ? row_score : 0.f;
+        float* row_sums = row_scores;
+        if (tree_block_begin != 0 && single_id_ < 0) {
+          row_sums = tree_block_scores.data();
+          std::fill(tree_block_scores.begin(), tree_block_scores.end(), 0.f);
+        }
+        for (size_t tree = tree_block_begin; tree < tree_block_end; tree++) {
+          const int32_t leaf_index = LowestSetBit(reachable_leaves[tree * kQuickScorerRowBlockSize + r]);
+          const TreeNodeElement* leaf = nodes_.data() + quick_scorer_leaves_[tree * 64 + leaf_index];
+          if (single_id_ >= 0) {
+            sum += leaf->value;
+            row_has_score |= leaf->feature_id > 0;
+          } else {
+            const TreeLeafWeight* weight = weights_.data() + leaf->false_child;
+            for (const TreeLeafWeight* end = weight + leaf->feature_id; weight < end; ++weight) {
+              row_sums[weight->id] += weight->value;
+              row_has_scores[weight->id] = 1;
+            }
+          }
+        }
+        if (single_id_ >= 0) {
+          row_score = tree_block_begin == 0 ? sum : row_score + sum;
+        } else if (row_sums != row_scores) {
+          for (int64_t id = 0; id < score_count_; id++) {
+            row_scores[id] += row_sums[id];
+          }
+        }
+      }
+      if (single_id_ >= 0) {
+        row_scores[single_id_] = row_score;
+        if (row_has_score) {
+          row_has_scores[single_id_] = 1;
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void TreeEnsembleCommon::ComputeScores(const T* x_data, int64_t row_count, int64_t x_stride,
+                                       float* scores, unsigned char* has_scores, int64_t scores_stride,
+                                       ThreadPool* thread_pool) const {
+  const int64_t tree_count = static_cast<int64_t>(roots_.size());
+
+  const int64_t total_work = row_count * tree_count * kTreeWalkWork;
+  const int64_t task_count = ThreadPool::TaskCount(thread_pool, row_count * tree_count, total_work);
+  if (task_count <= 1) {
+    ComputeTreeScores(x_data, row_count, x_stride, 0, roots_.size(), scores, has_scores, scores_stride);
+    return;
+  }
+
+  // Split the rows if every thread gets at least a block of rows.
+  const int64_t block_count = (row_count + kTreeRowBlockSize - 1) / kTreeRowBlockSize;
+  const int64_t tree_block_count = (tree_count + kTreeBlockSize - 1) / kTreeBlockSize;
+  if (block_count >= task_count || tree_block_count == 1) {
+    ThreadPool::TryParallelFor(thread_pool, block_count, total_work, [&](int64_t block_begin, int64_t block_end) {
+      const int64_t row_begin = block_begin * kTreeRowBlockSize;
+      const int64_t row_end = std::min(block_end * kTreeRowBlockSize, row_count);
+      ComputeTreeScores(x_data + row_begin * x_stride, row_end - row_begin, x_stride, 0, roots_.size(),
+                        scores + row_begin * scores_stride, has_scores + row_begin * scores_stride, scores_stride);
+    });
+    return;
+  }
+
+  // Otherwise split the trees into blocks of kTreeBlockSize trees. The first block adds to the scores, and the other
+  // blocks add to their own partial scores, which are then added to the scores in block order. This is the order in
+  // which ComputeTreeScores adds the blocks when the trees are not split.
+  const int64_t scores_size = row_count * scores_stride;
+  std::vector<float> partial_scores((tree_block_count - 1) * scores_size, 0.f);
+  std::vector<unsigned char> partial_has_scores((tree_block_count - 1) * scores_size, 0);
+
+  ThreadPool::TryParallelFor(thread_pool, tree_block_count, total_work, [&](int64_t begin, int64_t end) {
+    for (int64_t tree_block = begin; tree_block < end; tree_block++) {
+      const size_t tree_begin = static_cast<size_t>(tree_block * kTreeBlockSize);
+      const size_t tree_end = static_cast<size_t>(std::min(tree_count, (tree_block + 1) * kTreeBlockSize));
+      if (tree_block == 0) {
+        ComputeTreeScores(x_data, row_count, x_stride, tree_begin, tree_end, scores, has_scores, scores_stride);
+      } else {
+        ComputeTreeScores(x_data, row_count, x_stride, tree_begin, tree_end,
+                          partial_scores.data() + (tree_block - 1) * scores_size,
+                          partial_has_scores.data() + (tree_block - 1) * scores_size, scores_stride);
+      }
+    }
+  });
+
+  for (int64_t tree_block = 1; tree_block < tree_block_count; tree_block++) {
+    const float* block_scores = partial_scores.data() + (tree_block - 1) * scores_size;
+    const unsigned char* block_has_scores = partial_has_scores.data() + (tree_block - 1) * scores_size;
+    for (int64_t row = 0; row < row_count; row++) {
+      for (int64_t i = row * scores_stride, end = i + score_count_; i < end; i++) {
+        scores[i] += block_scores[i];
+        has_scores[i] |= block_has_scores[i];
+      }
+    }
+  }
+}
+
+}  // namespace ml
+}  // namespace onnxruntime
@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include "core/common/common.h"
+#include "core/common/threadpool.h"
 #include "core/framework/op_kernel.h"
 #include "core/providers/cpu/nn/autopad_type.h"
 #include "core/mlas/inc/mlas.h"
@@ -29,6 +31,7 @@ class PoolProcessContext {
   void init(const OpKernelInfo& info) {
     ORT_ENFORCE(info.GetAttr<int64_t>("p", &p_).IsOK());
   }
+  int64_t p() const { return p_; }
 };
 
 class AveragePool {
@@ -97,6 +100,18 @@ class LpPool {
   static const PoolType type = PoolType::kLpPool;
 };
 
+// ParallelPoolLoop: call fn(c) for every channel c in [0, total_channels), splitting the channels across the thread
+// pool if enough input elements are read. channel_elements is the number of input elements read for each channel.
+template <typename TFunc>
+void ParallelPoolLoop(ThreadPool* thread_pool, int64_t total_channels, int64_t channel_elements, TFunc fn) {
+  ThreadPool::TryParallelFor(thread_pool, total_channels, total_channels * channel_elements,
+                             [&](int64_t begin, int64_t end) {
+                               for (int64_t c = begin; c < end; ++c) {
+                                 fn(c);
+                               }
+                             });
+}
+
 class PoolBase {
  protected:
   PoolBase(const OpKernelInfo& info) {
@@ -217,6 +232,10 @@ class PoolBase {
     }
   }
 
+  // Checks that X can be pooled by MLAS, and sets the pads and the output dims of the pooling.
+  Status PrepareMlasPool(const TensorShape& x_shape, std::vector<int64_t>* pads,
+                         std::vector<int64_t>* output_dims) const;
+
   Status Compute(OpKernelContext* context, MLAS_POOLING_KIND kind) const;
 
  protected:
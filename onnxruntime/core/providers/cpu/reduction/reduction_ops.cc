@@ -3,7 +3,14 @@
 
 #include "core/providers/cpu/reduction/reduction_ops.h"
 #include "core/providers/common.h"
+#include "core/providers/cpu/tensor/transpose.h"
+#include "core/common/threadpool.h"
 #include "core/util/math_cpuonly.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
 using namespace std;
 namespace onnxruntime {
 
@@ -35,20 +42,25 @@ REGISTER_UNARY_ELEMENTWISE_KERNEL(ReduceSumSquare, 1);
 REGISTER_UNARY_ELEMENTWISE_KERNEL(ArgMax, 1);
 REGISTER_UNARY_ELEMENTWISE_KERNEL(ArgMin, 1);
 
-// When all reduce axises located at the tail of the dims, quite general cases, transpose and extra
-// copy could be skiped to improve performance, if required by check_no_transpose = true;
-// return value: true means transposedInputData is not created/copied, input tensor data could
-//               be direct use as row major matrix [block_size, blocks], where blocks is the
-//               size of each reduce.
+// Number of kept inner elements that are reduced together when the reduced axes are not the innermost axes. The
+// partial results stay in the L1 cache while each row of the input is accumulated into them.
+constexpr int64_t kReduceInnerBlockSize = 1024;
+
+// PrepareForReduce: create the output tensor and describe the input as a [outer_size, reduce_size, inner_size] array
+// whose middle axis is reduced, so that the output is laid out as [outer_size, inner_size].
+// If the reduced axes form a single run of the input shape, ignoring axes of extent 1, the input is read in place.
+// This covers reducing the trailing axes (inner_size is 1), the leading axes (outer_size is 1) and a block of middle
+// axes. Other sets of axes are transposed into transposedInputData so that all reduced axes come first.
+// Returns the data to reduce.
 template <typename T>
-bool PrepareForReduce(OpKernelContext* ctx,
-                      std::vector<T>& transposedInputData,
-                      Tensor** reducedTensor,
-                      int64_t& block_size,
-                      int64_t& blocks,
-                      const std::vector<int64_t>& axes_,
-                      bool keepdims_,
-                      bool check_no_transpose = false) {
+const T* PrepareForReduce(OpKernelContext* ctx,
+                          std::vector<T>& transposedInputData,
+                          Tensor** reducedTensor,
+                          int64_t& outer_size,
+                          int64_t& reduce_size,
+                          int64_t& inner_size,
+                          const std::vector<int64_t>& axes_,
+                          bool keepdims_) {
   const Tensor* input_tensor_ptr = ctx->Input<Tensor>(0);
   ORT_ENFORCE(input_tensor_ptr != nullptr);
   const Tensor& input = *input_tensor_ptr;
@@ -67,359 +79,402 @@ bool PrepareForReduce(OpKernelContext* ctx,
 
   std::sort(axes.begin(), axes.end());
 
-  // If all reduced axes are located at the tail of the input shape, then copy could be skipped is required
-  bool need_copy = true;
-  if (axes.size() <= ndim && axes.front() == static_cast<int64_t>(ndim - axes.size()) 
-      && axes.back() == static_cast<int64_t>(ndim) - 1) {
-    need_copy = false;
-  }
-
   vector<bool> keep_axis(ndim, true);
   for (auto i : axes) {
     keep_axis[i] = false;
   }
 
-  //transpose the input so that all to-be-reduced axes are at the head
-  vector<int64_t> transposed_axes(axes.begin(), axes.end());
-  for (int i = 0; i < ndim; ++i) {
+  const auto& in_dims = input.Shape().GetDims();
+
+  //set to-be-reduced axes to one. squeeze is keepdims_ is false
+  std::vector<int64_t> reduced_dims;
+  for (size_t i = 0; i < in_dims.size(); i++) {
     if (keep_axis[i]) {
-      transposed_axes.push_back(i);
+      reduced_dims.push_back(in_dims[i]);
+    } else if (keepdims_) {
+      reduced_dims.push_back(1);
     }
   }
 
-  vector<int64_t> new_dims_(transposed_axes.size());
-  for (int i = 0; i < transposed_axes.size(); ++i) {
-    new_dims_[i] = input.Shape().GetDims().at(transposed_axes[i]);
-  }
-
-  int num_axes = static_cast<int>(transposed_axes.size());
-  auto in_dims = input.Shape().GetDims();
+  *reducedTensor = ctx->Output(0, reduced_dims);
 
-  // Measure amount of contiguous data we can copy at once
-  int64_t blocksize = 1;
-  int n_shared_idxs = 0;
-  for (int i = num_axes - 1; i >= 0; --i) {
-    if (transposed_axes[i] == i) {
-      blocksize *= new_dims_[i];
-      ++n_shared_idxs;
+  // Look for a single run of reduced axes.
+  outer_size = 1;
+  reduce_size = 1;
+  inner_size = 1;
+  bool seen_reduced = false;
+  bool in_place = true;
+  for (size_t i = 0; i < ndim; i++) {
+    if (in_dims[i] == 1)
+      continue;
+    if (!keep_axis[i]) {
+      if (seen_reduced && inner_size != 1) {
+        in_place = false;
+        break;
+      }
+      seen_reduced = true;
+      reduce_size *= in_dims[i];
+    } else if (seen_reduced) {
+      inner_size *= in_dims[i];
     } else {
-      break;
+      outer_size *= in_dims[i];
     }
   }
 
-  const T* from_data = input.template Data<T>();
-  size_t count = input.Shape().Size();
+  if (in_place) {
+    return input.template Data<T>();
+  }
 
-  //set to-be-reduced axes to one. squeeze is keepdims_ is false
-  int64_t first_dim = 1;
-  std::vector<int64_t> reduced_dims;
-  for (int i = 0; i < in_dims.size(); i++) {
+  //transpose the input so that all to-be-reduced axes are at the head
+  vector<int64_t> transposed_axes(axes.begin(), axes.end());
+  for (size_t i = 0; i < ndim; ++i) {
     if (keep_axis[i]) {
-      reduced_dims.push_back(in_dims[i]);
-    } else {
-      first_dim *= in_dims[i];
-      if (keepdims_) {
-        reduced_dims.push_back(1);
-      }
+      transposed_axes.push_back(i);
     }
   }
 
-  *reducedTensor = ctx->Output(0, reduced_dims);
-  block_size = input.Shape().Size() / first_dim;
-  blocks = first_dim;
-
-  if (!need_copy && check_no_transpose) {
-    return true;
+  vector<int64_t> new_dims_(transposed_axes.size());
+  for (size_t i = 0; i < transposed_axes.size(); ++i) {
+    new_dims_[i] = in_dims.at(transposed_axes[i]);
   }
 
   transposedInputData.resize(input.Shape().Size(), 0);
-  T* to_data = &transposedInputData[0];
-  if (num_axes < 2 || n_shared_idxs == num_axes) {
-    memcpy(to_data, from_data, count * sizeof(T));
-    return false;
-  }
+  Tensor transposed(input.DataType(), TensorShape(new_dims_), transposedInputData.data(), input.Location());
+  ORT_ENFORCE(TransposeBase::DoTranspose(transposed_axes, input, transposed, ctx->GetOperatorThreadPool()).IsOK());
 
-  int itr_axes = num_axes - n_shared_idxs;
+  inner_size = (*reducedTensor)->Shape().Size();
+  reduce_size = inner_size == 0 ? 0 : input.Shape().Size() / inner_size;
+  outer_size = 1;
 
-  // Calculate strides
-  std::vector<int64_t> stride_x(itr_axes, 0);
-  for (size_t i = 0; i < itr_axes; i++) {
-    stride_x[i] = 1;
-    for (size_t j = transposed_axes[i] + 1; j < itr_axes; j++) {
-      stride_x[i] *= in_dims[j];
-    }
-  }
+  return transposedInputData.data();
+}
 
-  std::vector<int64_t> itr_idxs(itr_axes, 0);
+// ParallelReduce: call fn(outer, inner_begin, inner_end) for every outer index and every block of up to
+// kReduceInnerBlockSize inner indices, splitting the calls across the thread pool if the input is large enough.
+template <typename TFunc>
+void ParallelReduce(ThreadPool* thread_pool, int64_t outer_size, int64_t reduce_size, int64_t inner_size,
+                    TFunc fn) {
+  const int64_t inner_blocks = (inner_size + kReduceInnerBlockSize - 1) / kReduceInnerBlockSize;
+  const int64_t num_pieces = outer_size * inner_blocks;
+
+  ThreadPool::TryParallelFor(thread_pool, num_pieces, outer_size * reduce_size * inner_size,
+                             [&](int64_t begin, int64_t end) {
+                               for (int64_t piece = begin; piece < end; ++piece) {
+                                 const int64_t inner_begin = (piece % inner_blocks) * kReduceInnerBlockSize;
+                                 fn(piece / inner_blocks, inner_begin,
+                                    std::min(inner_size, inner_begin + kReduceInnerBlockSize));
+                               }
+                             });
+}
 
-  // Branch here to avoid branching within the loop
-  if (blocksize > 1) {
-    for (size_t index = 0; index < (count / blocksize); index++) {
-      int64_t from_index = 0;
-      for (int i = 0; i < itr_axes; ++i) {
-        from_index += stride_x[i] * itr_idxs[i];
-      }
+// Aggregators for the reductions computed by ComputeReduction. Each one provides:
+//   ReduceRow(data, reduce_size): reduce reduce_size contiguous values to one output value.
+//   ReduceColumns(data, reduce_size, stride, size, output): reduce reduce_size rows of size contiguous values,
+//     stride elements apart, to size output values.
+// The Eigen array expressions are vectorized.
+template <typename T>
+struct ReduceAggregatorSum {
+  static T ReduceRow(const T* data, int64_t reduce_size) {
+    return ConstEigenVectorArrayMap<T>(data, reduce_size).sum();
+  }
 
-      memcpy(
-          to_data + blocksize * index,
-          from_data + blocksize * from_index,
-          blocksize * sizeof(T));
-
-      ++itr_idxs[itr_axes - 1];
-      for (int i = itr_axes - 1; i >= 1; --i) {
-        auto expected_dim = new_dims_[i];
-        if (itr_idxs[i] < expected_dim) {
-          break;
-        }
-        itr_idxs[i] %= expected_dim;
-        ++itr_idxs[i - 1];
-      }
+  static void ReduceColumns(const T* data, int64_t reduce_size, int64_t stride, int64_t size, T* output) {
+    EigenVectorArrayMap<T> out(output, size);
+    out = ConstEigenVectorArrayMap<T>(data, size);
+    for (int64_t r = 1; r < reduce_size; ++r) {
+      out += ConstEigenVectorArrayMap<T>(data + r * stride, size);
     }
-  } else {
-    for (size_t index = 0; index < count; index++) {
-      int64_t from_index = 0;
-      for (int i = 0; i < itr_axes; ++i) {
-        from_index += stride_x[i] * itr_idxs[i];
-      }
+  }
+};
 
-      *(to_data + index) = *(from_data + from_index);
+template <typename T>
+struct ReduceAggregatorMean {
+  static T ReduceRow(const T* data, int64_t reduce_size) {
+    return ConstEigenVectorArrayMap<T>(data, reduce_size).mean();
+  }
 
-      ++itr_idxs[itr_axes - 1];
-      for (int i = itr_axes - 1; i >= 1; --i) {
-        auto expected_dim = new_dims_[i];
-        if (itr_idxs[i] < expected_dim) {
-          break;
-        }
-        itr_idxs[i] %= expected_dim;
-        ++itr_idxs[i - 1];
-      }
-    }
+  static void ReduceColumns(const T* data, int64_t reduce_size, int64_t stride, int64_t size, T* output) {
+    ReduceAggregatorSum<T>::ReduceColumns(data, reduce_size, stride, size, output);
+    EigenVectorArrayMap<T>(output, size) /= static_cast<T>(reduce_size);
   }
-  return false;
-}
+};
 
 template <typename T>
-Status ReduceL1<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+struct ReduceAggregatorL1 {
+  static T ReduceRow(const T* data, int64_t reduce_size) {
+    return ConstEigenVectorArrayMap<T>(data, reduce_size).abs().sum();
+  }
 
-  T* output_data = reduced->template MutableData<T>();
+  static void ReduceColumns(const T* data, int64_t reduce_size, int64_t stride, int64_t size, T* output) {
+    EigenVectorArrayMap<T> out(output, size);
+    out = ConstEigenVectorArrayMap<T>(data, size).abs();
+    for (int64_t r = 1; r < reduce_size; ++r) {
+      out += ConstEigenVectorArrayMap<T>(data + r * stride, size).abs();
+    }
+  }
+};
 
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).cwiseAbs().rowwise().sum();
+template <typename T>
+struct ReduceAggregatorSumSquare {
+  static T ReduceRow(const T* data, int64_t reduce_size) {
+    return ConstEigenVectorArrayMap<T>(data, reduce_size).square().sum();
+  }
 
-  return Status::OK();
-}
+  static void ReduceColumns(const T* data, int64_t reduce_size, int64_t stride, int64_t size, T* output) {
+    EigenVectorArrayMap<T> out(output, size);
+    out = ConstEigenVectorArrayMap<T>(data, size).square();
+    for (int64_t r = 1; r < reduce_size; ++r) {
+      out += ConstEigenVectorArrayMap<T>(data + r * stride, size).square();
+    }
+  }
+};
 
 template <typename T>
-Status ReduceL2<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+struct ReduceAggregatorL2 {
+  static T ReduceRow(const T* data, int64_t reduce_size) {
+    return static_cast<T>(std::sqrt(ReduceAggregatorSumSquare<T>::ReduceRow(data, reduce_size)));
+  }
 
-  T* output_data = reduced->template MutableData<T>();
+  static void ReduceColumns(const T* data, int64_t reduce_size, int64_t stride, int64_t size, T* output) {
+    ReduceAggregatorSumSquare<T>::ReduceColumns(data, reduce_size, stride, size, output);
+    for (int64_t i = 0; i < size; ++i) {
+      output[i] = static_cast<T>(std::sqrt(output[i]));
+    }
+  }
+};
 
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().norm();
+template <typename T>
+struct ReduceAggregatorLogSum {
+  static T ReduceRow(const T* data, int64_t reduce_size) {
+    return static_cast<T>(std::log(ReduceAggregatorSum<T>::ReduceRow(data, reduce_size)));
+  }
 
-  return Status::OK();
-}
+  static void ReduceColumns(const T* data, int64_t reduce_size, int64_t stride, int64_t size, T* output) {
+    ReduceAggregatorSum<T>::ReduceColumns(data, reduce_size, stride, size, output);
+    for (int64_t i = 0; i < size; ++i) {
+      output[i] = static_cast<T>(std::log(output[i]));
+    }
+  }
+};
 
+// The maximum of an empty row is -infinity, or the lowest value of T if it has no infinity, and the minimum is
+// +infinity or the highest value. Eigen's maxCoeff and minCoeff require at least one value.
 template <typename T>
-Status ReduceLogSum<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+struct ReduceAggregatorMax {
+  static T ReduceRow(const T* data, int64_t reduce_size) {
+    if (reduce_size == 0) {
+      return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                  : std::numeric_limits<T>::lowest();
+    }
+    return ConstEigenVectorArrayMap<T>(data, reduce_size).maxCoeff();
+  }
 
-  T* output_data = reduced->template MutableData<T>();
+  static void ReduceColumns(const T* data, int64_t reduce_size, int64_t stride, int64_t size, T* output) {
+    EigenVectorArrayMap<T> out(output, size);
+    out = ConstEigenVectorArrayMap<T>(data, size);
+    for (int64_t r = 1; r < reduce_size; ++r) {
+      out = out.max(ConstEigenVectorArrayMap<T>(data + r * stride, size));
+    }
+  }
+};
 
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().sum();
-  for (int j = 0; j < block_size; ++j) {
-    *(output_data) = static_cast<T>(std::log(*(output_data)));
-    ++output_data;
+template <typename T>
+struct ReduceAggregatorMin {
+  static T ReduceRow(const T* data, int64_t reduce_size) {
+    if (reduce_size == 0) {
+      return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                  : std::numeric_limits<T>::max();
+    }
+    return ConstEigenVectorArrayMap<T>(data, reduce_size).minCoeff();
   }
 
-  return Status::OK();
-}
+  static void ReduceColumns(const T* data, int64_t reduce_size, int64_t stride, int64_t size, T* output) {
+    EigenVectorArrayMap<T> out(output, size);
+    out = ConstEigenVectorArrayMap<T>(data, size);
+    for (int64_t r = 1; r < reduce_size; ++r) {
+      out = out.min(ConstEigenVectorArrayMap<T>(data + r * stride, size));
+    }
+  }
+};
 
 template <typename T>
-Status ReduceLogSumExp<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
-
-  T* output_data = reduced->template MutableData<T>();
+struct ReduceAggregatorProd {
+  static T ReduceRow(const T* data, int64_t reduce_size) {
+    return ConstEigenVectorArrayMap<T>(data, reduce_size).prod();
+  }
 
-  for (int j = 0; j < block_size; ++j) {
-    T max_value = std::numeric_limits<T>::lowest();
-    for (int i = 0; i < blocks; ++i) {
-      max_value = std::max(max_value, transposedInputData[i * block_size + j]);
+  static void ReduceColumns(const T* data, int64_t reduce_size, int64_t stride, int64_t size, T* output) {
+    EigenVectorArrayMap<T> out(output, size);
+    out = ConstEigenVectorArrayMap<T>(data, size);
+    for (int64_t r = 1; r < reduce_size; ++r) {
+      out *= ConstEigenVectorArrayMap<T>(data + r * stride, size);
     }
+  }
+};
+
+// LogSumExp subtracts the maximum before exponentiating so that the sum can't overflow.
+template <typename T>
+struct ReduceAggregatorLogSumExp {
+  static T ReduceRow(const T* data, int64_t reduce_size) {
+    const T max_value = ReduceAggregatorMax<T>::ReduceRow(data, reduce_size);
     T scaled_exp_sum = 0;
-    for (int i = 0; i < blocks; ++i) {
-      scaled_exp_sum += static_cast<T>(std::exp(transposedInputData[i * block_size + j] - max_value));
+    for (int64_t r = 0; r < reduce_size; ++r) {
+      scaled_exp_sum += static_cast<T>(std::exp(data[r] - max_value));
     }
-    *(output_data++) = static_cast<T>(std::log(scaled_exp_sum) + max_value);
+    return static_cast<T>(std::log(scaled_exp_sum) + max_value);
   }
-  return Status::OK();
-}
 
-template <typename T>
-Status ReduceMax<T>::Compute(OpKernelContext* ctx) const {
+  static void ReduceColumns(const T* data, int64_t reduce_size, int64_t stride, int64_t size, T* output) {
+    std::vector<T> max_values(size);
+    ReduceAggregatorMax<T>::ReduceColumns(data, reduce_size, stride, size, max_values.data());
+    std::fill_n(output, size, static_cast<T>(0));
+    for (int64_t r = 0; r < reduce_size; ++r) {
+      const T* row = data + r * stride;
+      for (int64_t i = 0; i < size; ++i) {
+        output[i] += static_cast<T>(std::exp(row[i] - max_values[i]));
+      }
+    }
+    for (int64_t i = 0; i < size; ++i) {
+      output[i] = static_cast<T>(std::log(output[i]) + max_values[i]);
+    }
+  }
+};
+
+template <typename T, typename TAggregator>
+Status ComputeReduction(OpKernelContext* ctx, const std::vector<int64_t>& axes, bool keepdims) {
   std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
+  int64_t outer_size, reduce_size, inner_size;
   Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+  const T* input_data = PrepareForReduce<T>(ctx, transposedInputData, &reduced, outer_size, reduce_size, inner_size,
+                                            axes, keepdims);
 
   T* output_data = reduced->template MutableData<T>();
 
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().maxCoeff();
+  if (reduce_size == 0) {
+    // An axis of extent 0 is reduced, so each output value is the reduction of an empty row.
+    outer_size *= inner_size;
+    inner_size = 1;
+  }
+
+  ParallelReduce(ctx->GetOperatorThreadPool(), outer_size, reduce_size, inner_size,
+                 [=](int64_t outer, int64_t inner_begin, int64_t inner_end) {
+                   const T* data = input_data + outer * reduce_size * inner_size + inner_begin;
+                   T* output = output_data + outer * inner_size + inner_begin;
+                   if (inner_size == 1) {
+                     *output = TAggregator::ReduceRow(data, reduce_size);
+                   } else {
+                     TAggregator::ReduceColumns(data, reduce_size, inner_size, inner_end - inner_begin, output);
+                   }
+                 });
 
   return Status::OK();
 }
 
-template <typename T>
-Status ReduceMean<T>::Compute(OpKernelContext* ctx) const {
+// ArgMax and ArgMin return the index of the first occurrence of the selected value.
+template <typename T, typename TCompare>
+Status ComputeArgReduction(OpKernelContext* ctx, const std::vector<int64_t>& axes, bool keepdims) {
   std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
+  int64_t outer_size, reduce_size, inner_size;
   Tensor* reduced;
-  bool no_transpose = PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_, true);
-
-  T* output_data = reduced->template MutableData<T>();
+  const T* input_data = PrepareForReduce<T>(ctx, transposedInputData, &reduced, outer_size, reduce_size, inner_size,
+                                            axes, keepdims);
 
-  if (no_transpose) {
-    const T* input_data = ctx->Input<Tensor>(0)->template Data<T>();
+  int64_t* output_data = reduced->template MutableData<int64_t>();
 
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-    for (int64_t i = 0; i < block_size; ++i) {
-      output_data[i] = ConstEigenVectorMap<T>(input_data + (i * blocks), blocks).mean();
-    }
-  }
-  else {
-    EigenVectorMap<T> out_vec(output_data, block_size);
-    out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().mean();
-  }
+  if (reduced->Shape().Size() == 0)
+    return Status::OK();
+  if (reduce_size == 0)
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Can't select an element from an empty axis.");
+
+  ParallelReduce(ctx->GetOperatorThreadPool(), outer_size, reduce_size, inner_size,
+                 [=](int64_t outer, int64_t inner_begin, int64_t inner_end) {
+                   const T* data = input_data + outer * reduce_size * inner_size + inner_begin;
+                   int64_t* output = output_data + outer * inner_size + inner_begin;
+                   TCompare compare;
+                   if (inner_size == 1) {
+                     int64_t selected = 0;
+                     for (int64_t r = 1; r < reduce_size; ++r) {
+                       if (compare(data[r], data[selected]))
+                         selected = r;
+                     }
+                     *output = selected;
+                     return;
+                   }
+                   const int64_t size = inner_end - inner_begin;
+                   std::vector<T> selected_values(data, data + size);
+                   std::fill_n(output, size, int64_t{0});
+                   for (int64_t r = 1; r < reduce_size; ++r) {
+                     const T* row = data + r * inner_size;
+                     for (int64_t i = 0; i < size; ++i) {
+                       if (compare(row[i], selected_values[i])) {
+                         selected_values[i] = row[i];
+                         output[i] = r;
+                       }
+                     }
+                   }
+                 });
 
   return Status::OK();
 }
 
 template <typename T>
-Status ReduceMin<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+Status ReduceL1<T>::Compute(OpKernelContext* ctx) const {
+  return ComputeReduction<T, ReduceAggregatorL1<T>>(ctx, axes_, keepdims_);
+}
 
-  T* output_data = reduced->template MutableData<T>();
+template <typename T>
+Status ReduceL2<T>::Compute(OpKernelContext* ctx) const {
+  return ComputeReduction<T, ReduceAggregatorL2<T>>(ctx, axes_, keepdims_);
+}
 
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().minCoeff();
+template <typename T>
+Status ReduceLogSum<T>::Compute(OpKernelContext* ctx) const {
+  return ComputeReduction<T, ReduceAggregatorLogSum<T>>(ctx, axes_, keepdims_);
+}
 
-  return Status::OK();
+template <typename T>
+Status ReduceLogSumExp<T>::Compute(OpKernelContext* ctx) const {
+  return ComputeReduction<T, ReduceAggregatorLogSumExp<T>>(ctx, axes_, keepdims_);
 }
 
 template <typename T>
-Status ReduceProd<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+Status ReduceMax<T>::Compute(OpKernelContext* ctx) const {
+  return ComputeReduction<T, ReduceAggregatorMax<T>>(ctx, axes_, keepdims_);
+}
 
-  T* output_data = reduced->template MutableData<T>();
+template <typename T>
+Status ReduceMean<T>::Compute(OpKernelContext* ctx) const {
+  return ComputeReduction<T, ReduceAggregatorMean<T>>(ctx, axes_, keepdims_);
+}
 
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().prod();
+template <typename T>
+Status ReduceMin<T>::Compute(OpKernelContext* ctx) const {
+  return ComputeReduction<T, ReduceAggregatorMin<T>>(ctx, axes_, keepdims_);
+}
 
-  return Status::OK();
+template <typename T>
+Status ReduceProd<T>::Compute(OpKernelContext* ctx) const {
+  return ComputeReduction<T, ReduceAggregatorProd<T>>(ctx, axes_, keepdims_);
 }
 
 template <typename T>
 Status ReduceSum<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  bool no_transpose = PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_, true);
-
-  T* output_data = reduced->template MutableData<T>();
-
-  if (no_transpose) {
-    const T* input_data = ctx->Input<Tensor>(0)->template Data<T>();
-
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-    for (int64_t i = 0; i < block_size; ++i) {
-      output_data[i] = ConstEigenVectorMap<T>(input_data + (i * blocks), blocks).sum();
-    }
-  }
-  else {
-    EigenVectorMap<T> out_vec(output_data, block_size);
-    out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().sum();
-  }
-
-  return Status::OK();
+  return ComputeReduction<T, ReduceAggregatorSum<T>>(ctx, axes_, keepdims_);
 }
 
 template <typename T>
 Status ReduceSumSquare<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
-
-  T* output_data = reduced->template MutableData<T>();
-
-  EigenVectorMap<T> out_vec(output_data, block_size);
-  out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().squaredNorm();
-
-  return Status::OK();
+  return ComputeReduction<T, ReduceAggregatorSumSquare<T>>(ctx, axes_, keepdims_);
 }
 
 template <typename T>
 Status ArgMax<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
-
-  int64_t* output_data = reduced->template MutableData<int64_t>();
-
-  Eigen::MatrixXf::Index maxIndex;
-  auto matrixData = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks);
-  for (int i = 0; i < block_size; ++i) {
-    matrixData.row(i).maxCoeff(&maxIndex);
-    *(output_data++) = maxIndex;
-  }
-
-  return Status::OK();
+  return ComputeArgReduction<T, std::greater<T>>(ctx, axes_, keepdims_);
 }
 
 template <typename T>
 Status ArgMin<T>::Compute(OpKernelContext* ctx) const {
-  std::vector<T> transposedInputData;
-  int64_t block_size, blocks;
-  Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
-
-  int64_t* output_data = reduced->template MutableData<int64_t>();
-
-  Eigen::MatrixXf::Index minIndex;
-  auto matrixData = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks);
-  for (int i = 0; i < block_size; ++i) {
-    matrixData.row(i).minCoeff(&minIndex);
-    *(output_data++) = minIndex;
-  }
-
-  return Status::OK();
+  return ComputeArgReduction<T, std::less<T>>(ctx, axes_, keepdims_);
 }
 
 }  // namespace onnxruntime
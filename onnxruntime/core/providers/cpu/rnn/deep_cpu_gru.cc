@@ -177,11 +177,7 @@ class UniDirectionalGru {
                     const ActivationFuncs::Entry& activation_func_f,
                     const ActivationFuncs::Entry& activation_func_g,
                     const float clip,
-#ifdef USE_EIGEN_THREADPOOL
-                    Eigen::NonBlockingThreadPool& ttp_);
-#else
-                    TaskThreadPool& ttp_);
-#endif
+                    ThreadPool* ttp_);
 
   void Compute(const gsl::span<const T>& inputs,
                const gsl::span<const int>& sequence_lengths,
@@ -197,11 +193,7 @@ class UniDirectionalGru {
   AllocatorPtr allocator_;
   const logging::Logger& logger_;
 
-#ifdef USE_EIGEN_THREADPOOL
-  Eigen::NonBlockingThreadPool& ttp_;
-#else
-  TaskThreadPool& ttp_;
-#endif
+  ThreadPool* ttp_;
 
   int seq_length_;
   int batch_size_;
@@ -292,6 +284,8 @@ Status DeepCpuGruOp::Compute(OpKernelContext* context) const {
 template <typename T>
 Status DeepCpuGruOp::ComputeImpl(OpKernelContext& context) const {
   auto& logger = context.Logger();
+  // null if the session has no intra-op thread pool, in which case the work is done on the calling thread
+  ThreadPool* thread_pool = context.GetOperatorThreadPool();
 
   const Tensor& X = *context.Input<Tensor>(0);  // inputs. [seq_length, batch_size, input_size]
   const Tensor& W = *context.Input<Tensor>(1);  // weights. [num_directions, 3*hidden_size, input_size]
@@ -399,7 +393,7 @@ Status DeepCpuGruOp::ComputeImpl(OpKernelContext& context) const {
         bias_1, initial_hidden_1,
         activation_funcs_.Entries()[0],
         activation_funcs_.Entries()[1],
-        clip_, ttp_);
+        clip_, thread_pool);
     fw->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1, output_1, hidden_output_1);
 
     std::unique_ptr<detail::UniDirectionalGru<T>> bw = std::make_unique<detail::UniDirectionalGru<T>>(
@@ -408,7 +402,7 @@ Status DeepCpuGruOp::ComputeImpl(OpKernelContext& context) const {
         bias_2, initial_hidden_2,
         activation_funcs_.Entries()[2],
         activation_funcs_.Entries()[3],
-        clip_, ttp_);
+        clip_, thread_pool);
     bw->Compute(input, sequence_lens_span, num_directions_, input_weights_2, recurrent_weights_2, output_2, hidden_output_2);
 
   } else {
@@ -418,7 +412,7 @@ Status DeepCpuGruOp::ComputeImpl(OpKernelContext& context) const {
         bias_1, initial_hidden_1,
         activation_funcs_.Entries()[0],
         activation_funcs_.Entries()[1],
-        clip_, ttp_);
+        clip_, thread_pool);
 
     gru_p->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1, output_1, hidden_output_1);
   }
@@ -449,11 +443,7 @@ UniDirectionalGru<T>::UniDirectionalGru(AllocatorPtr allocator,
                                         const ActivationFuncs::Entry& activation_func_f,
                                         const ActivationFuncs::Entry& activation_func_g,
                                         const float clip,
-#ifdef USE_EIGEN_THREADPOOL
-                                        Eigen::NonBlockingThreadPool& ttp)
-#else
-                                        TaskThreadPool& ttp)
-#endif
+                                        ThreadPool* ttp)
     : allocator_(allocator),
       logger_(logger),
       ttp_(ttp),
@@ -614,7 +604,7 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
     if (batch_size_ % hidden_num_threads_ != 0)
       fused_hidden_rows++;
 
-    // lambda executed by Eigen::NonBlockingThreadPool
+    // lambda executed by ThreadPool
     auto hidden_gemm_and_activations = [&](const int row) {
       //handling boundaries
       int local_fused_hidden_rows = fused_hidden_rows;
@@ -8,6 +8,7 @@
 #endif
 
 #include <algorithm>
+#include <exception>
 #include <functional>
 #include <future>
 #include <string>
@@ -18,16 +19,12 @@
 
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
+#include "core/common/threadpool.h"
 #include "core/framework/allocator.h"
+#include "core/platform/ort_mutex.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 
-#ifdef USE_EIGEN_THREADPOOL
-#include <unsupported/Eigen/CXX11/ThreadPool>
-#else
-#include "core/common/task_thread_pool.h"
-#endif
-
 namespace onnxruntime {
 class Tensor;
 class OpKernelContext;
@@ -214,13 +211,12 @@ T* SafeRawPointer(typename gsl::span<T> span, size_t offset, size_t size) {
   return span.data() + offset;
 }
 
+// Run lambda(i) for i in [0, max) with the given step. The calls are spread across ttp if provided, otherwise they
+// are run in order on the calling thread. Any exception thrown by lambda is logged and the first one is rethrown
+// once all the calls have completed.
 template <typename TLambda>
 void ExecuteLambdaInParallel(const std::string& name, TLambda lambda, int max, int step,
-#ifdef USE_EIGEN_THREADPOOL
-                             Eigen::NonBlockingThreadPool& ttp,
-#else
-                             TaskThreadPool& ttp,
-#endif
+                             ThreadPool* ttp,
                              const ::onnxruntime::logging::Logger& logger) {
   // #define NOTHREADS to execute the lambdas directly and in order if you need to do that to debug
 
@@ -233,40 +229,37 @@ void ExecuteLambdaInParallel(const std::string& name, TLambda lambda, int max, i
     std::bind(lambda, i)();
   }
 #else
-
-#ifdef USE_EIGEN_THREADPOOL
-  ORT_UNUSED_PARAMETER(name);
-  ORT_UNUSED_PARAMETER(logger);
-
-  std::atomic<int> done(0);
-  for (int i = 0; i < max; i += step) {
-    ttp.Schedule([lambda, i, &done]() {
+  if (ttp == nullptr) {
+    for (int i = 0; i < max; i += step) {
       lambda(i);
-      ++done;
-    });
-  }
-
-  int totalTasks = (int)max / (step > 0 ? step : 1) + (max % step > 0 ? 1 : 0);
-  while (done != totalTasks) {
+    }
+    return;
   }
-#else
-  std::vector<std::future<void> > task_results{};
-  task_results.reserve(static_cast<size_t>(std::ceil(max / step)));
 
-  for (int i = 0; i < max; i += step) {
-    std::packaged_task<void()> task{std::bind(lambda, i)};
-    task_results.emplace_back(task.get_future());
-    ttp.RunTask(std::move(task));
-  }
-  try {
-    // wait for all and propagate any exceptions
-    for (auto& future : task_results)
-      future.get();
-  } catch (const std::exception& ex) {
-    LOGS(logger, ERROR) << name << " - exception running tasks: " << ex.what();
-    throw;
+  const int total_tasks = max / (step > 0 ? step : 1) + (max % step > 0 ? 1 : 0);
+
+  // ThreadPool::ParallelFor requires that the function doesn't throw
+  std::exception_ptr first_exception;
+  OrtMutex exception_mutex;
+  ttp->ParallelFor(total_tasks, [&](int32_t task) {
+    try {
+      lambda(task * step);
+    } catch (...) {
+      std::lock_guard<OrtMutex> lock(exception_mutex);
+      if (!first_exception) {
+        first_exception = std::current_exception();
+      }
+    }
+  });
+
+  if (first_exception) {
+    try {
+      std::rethrow_exception(first_exception);
+    } catch (const std::exception& ex) {
+      LOGS(logger, ERROR) << name << " - exception running tasks: " << ex.what();
+      throw;
+    }
   }
-#endif  // else part of #ifdef USE_EIGEN_THREADPOOLs
 #endif  // else part of #ifdef NOTHREADS
 }
 
@@ -3,6 +3,10 @@
 
 #include "core/providers/cpu/tensor/transpose.h"
 #include "core/framework/utils.h"
+#include "core/mlas/inc/mlas.h"
+
+#include <algorithm>
+#include <numeric>
 
 namespace onnxruntime {
 
@@ -13,233 +17,237 @@ namespace onnxruntime {
    etc.
    */
 
-// ComputeOffset: compute offset into a tensor. This is essentially the dot-product of
-// index and stride, restricted to the specified number of axes.
-static inline size_t ComputeOffset(const std::vector<int64_t>& index, const std::vector<size_t>& stride, int64_t num_axes) {
-  size_t offset = 0;
-  for (int64_t j = 0; j < num_axes; ++j) {
-    offset += index[j] * stride[j];
+// Number of rows or columns of a matrix handled by each piece of work in TransposeTyped. This is a multiple of the
+// cache blocks used by MlasTranspose.
+constexpr size_t kTransposeMatrixPieceSize = 128;
+
+// CoalesceDimensions: remove the axes of extent 1 and merge each run of input axes that stays adjacent and in the
+// same order in the output into a single axis. The result is the smallest rank that describes the transpose, e.g.
+// NCHW -> NHWC becomes [N, C, H*W] with permutation [0, 2, 1] and a permutation that only moves axes of extent 1
+// becomes a single axis. perm and dims describe the coalesced transpose in the same way as permutations and
+// input_dims.
+static void CoalesceDimensions(const std::vector<int64_t>& permutations, const std::vector<int64_t>& input_dims,
+                               std::vector<size_t>& perm, std::vector<int64_t>& dims) {
+  const int64_t rank = static_cast<int64_t>(input_dims.size());
+
+  // next_axis[i] is the first input axis after i that has an extent other than 1.
+  std::vector<int64_t> next_axis(rank);
+  int64_t next = rank;
+  for (int64_t i = rank - 1; i >= 0; --i) {
+    next_axis[i] = next;
+    if (input_dims[i] != 1)
+      next = i;
   }
-  return offset;
-}
 
-// IncrementIndex: Increment an index into a tensor (in lexicographic ordering), wrapping
-// around the specified upper_bound.
-static inline void IncrementIndex(std::vector<int64_t>& index, const std::vector<int64_t>& upper_bound, int64_t num_axes) {
-  for (int64_t k = num_axes - 1; k >= 0; --k) {
-    index[k]++;
-    if (index[k] < upper_bound[k]) break;
-    index[k] = 0;
+  // Group the output axes. Each group starts at group_axis in the input and is group_dim elements long.
+  std::vector<int64_t> group_axis;
+  std::vector<int64_t> group_dim;
+  int64_t previous_axis = -1;
+  for (int64_t axis : permutations) {
+    if (input_dims[axis] == 1)
+      continue;
+    if (previous_axis >= 0 && next_axis[previous_axis] == axis) {
+      group_dim.back() *= input_dims[axis];
+    } else {
+      group_axis.push_back(axis);
+      group_dim.push_back(input_dims[axis]);
+    }
+    previous_axis = axis;
   }
-}
 
-// DoTransposeSingleBlock: specialization of DoTranspose for the num_blocks=1 case.
-// copies source tensor to target, transposing elements.
-static inline void DoTransposeSingleBlock(size_t num_elts_in_block, const void* source, void* target,
-                                          size_t element_size) {
-  size_t blocksize = num_elts_in_block * element_size;
-  // copy
-  memcpy(target, source, blocksize);
+  // Number the groups in input order.
+  const size_t num_groups = group_axis.size();
+  std::vector<size_t> input_order(num_groups);
+  std::iota(input_order.begin(), input_order.end(), size_t{0});
+  std::sort(input_order.begin(), input_order.end(),
+            [&group_axis](size_t a, size_t b) { return group_axis[a] < group_axis[b]; });
+
+  perm.resize(num_groups);
+  dims.resize(num_groups);
+  for (size_t i = 0; i < num_groups; ++i) {
+    perm[input_order[i]] = i;
+    dims[i] = group_dim[input_order[i]];
+  }
 }
 
-static inline void DoTransposeSingleBlock(size_t num_elts_in_block, const std::string* source, std::string* target) {
-  const std::string* end = source + num_elts_in_block;
-  std::copy(source, end, target);
+// TransposeMatrix: transpose the M x N matrix A into the N x M matrix B. 1 and 4 byte elements use the vectorized
+// MLAS kernels, other types are copied one element at a time in small blocks so both matrices stay in cache.
+static void TransposeMatrix(size_t M, size_t N, const uint8_t* A, size_t lda, uint8_t* B, size_t ldb) {
+  MlasTranspose(M, N, A, lda, B, ldb);
 }
 
-// DoTranspose: copies source tensor to target, transposing elements.
-// The stride vector indicates the transposition.
-static void DoTransposeImpl(int64_t num_axes, const std::vector<int64_t>& target_dims,
-                            size_t num_blocks, size_t num_elts_in_block, const std::vector<size_t>& stride,
-                            const uint8_t* source, uint8_t* target, size_t element_size) {
-  size_t blocksize = num_elts_in_block * element_size;
-  // index used to iterate over target iteration-space
-  std::vector<int64_t> target_index(num_axes, 0);
-  for (size_t i = 0; i < num_blocks; ++i) {
-    // convert target_index into an offset in source data
-    size_t source_offset = ComputeOffset(target_index, stride, num_axes);
-
-    // copy
-    memcpy(target, source + source_offset * element_size, blocksize);
-
-    // increment target_index:
-    IncrementIndex(target_index, target_dims, num_axes);
-    target += blocksize;
-  }
+static void TransposeMatrix(size_t M, size_t N, const uint32_t* A, size_t lda, uint32_t* B, size_t ldb) {
+  MlasTranspose(M, N, A, lda, B, ldb);
 }
 
-static void DoTransposeImpl(int64_t num_axes, const std::vector<int64_t>& target_dims,
-                            size_t num_blocks, size_t num_elts_in_block, const std::vector<size_t>& stride,
-                            const std::string* source, std::string* target) {
-  // index used to iterate over target iteration-space
-  std::vector<int64_t> target_index(num_axes, 0);
-  for (size_t i = 0; i < num_blocks; ++i) {
-    // convert target_index into an offset in source data
-    size_t source_offset = ComputeOffset(target_index, stride, num_axes);
-
-    // copy
-    DoTransposeSingleBlock(num_elts_in_block, source + source_offset, target);
-
-    // increment target_index:
-    IncrementIndex(target_index, target_dims, num_axes);
-    target += num_elts_in_block;
+template <typename T>
+static void TransposeMatrix(size_t M, size_t N, const T* A, size_t lda, T* B, size_t ldb) {
+  constexpr size_t kBlockSize = 16;
+  for (size_t n0 = 0; n0 < N; n0 += kBlockSize) {
+    const size_t n_end = std::min(N, n0 + kBlockSize);
+    for (size_t m0 = 0; m0 < M; m0 += kBlockSize) {
+      const size_t m_end = std::min(M, m0 + kBlockSize);
+      for (size_t n = n0; n < n_end; ++n) {
+        for (size_t m = m0; m < m_end; ++m) {
+          B[n * ldb + m] = A[m * lda + n];
+        }
+      }
+    }
   }
 }
 
-template <class T>
-inline void CopyPrim(uint8_t* target, const uint8_t* source) {
-  *reinterpret_cast<T*>(target) = *reinterpret_cast<const T*>(source);
-}
-
-// DoTransposeEltWise: specialization of DoTranspose for the num_elts_in_block=1 case.
-// copies source tensor to target, transposing elements.
-// The stride vector indicates the transposition.
-static void DoTransposeEltWise(int64_t num_axes, const std::vector<int64_t>& target_dims, size_t num_blocks,
-                               const std::vector<size_t>& stride, const uint8_t* source, uint8_t* target,
-                               size_t element_size) {
-  // index used to iterate over target iteration-space
-  std::vector<int64_t> target_index(num_axes, 0);
-
-  switch (element_size) {
-    case sizeof(uint64_t):
-      for (size_t i = 0; i < num_blocks; ++i) {
-        // convert target_index into an offset in source data
-        size_t source_offset = ComputeOffset(target_index, stride, num_axes);
-
-        // copy
-        CopyPrim<uint64_t>(target, source + (source_offset * element_size));
+// TransposeTyped: copies source to target, transposing elements. perm and dims describe a coalesced transpose.
+// If the innermost input axis stays innermost, each row of the output is a contiguous block copied from the input.
+// Otherwise the innermost input axis and the axis that becomes innermost in the output form a matrix for every
+// index of the remaining (outer) axes, which is transposed by TransposeMatrix. The work is divided into pieces
+// (one block copy, or a band of rows or columns of one matrix) that are split across the thread pool.
+template <typename T>
+static void TransposeTyped(const std::vector<size_t>& perm, const std::vector<int64_t>& dims,
+                           const T* source, T* target, ThreadPool* thread_pool) {
+  const size_t rank = dims.size();
+  size_t num_elements = 1;
+  for (auto dim : dims)
+    num_elements *= static_cast<size_t>(dim);
+
+  if (rank <= 1) {
+    std::copy(source, source + num_elements, target);
+    return;
+  }
 
-        // increment target_index:
-        IncrementIndex(target_index, target_dims, num_axes);
-        target += element_size;
-      }
-      break;
-    case sizeof(uint32_t):
-      for (size_t i = 0; i < num_blocks; ++i) {
-        // convert target_index into an offset in source data
-        size_t source_offset = ComputeOffset(target_index, stride, num_axes);
+  std::vector<size_t> input_stride(rank);
+  std::vector<size_t> output_stride(rank);
+  input_stride[rank - 1] = 1;
+  output_stride[rank - 1] = 1;
+  for (size_t i = rank - 1; i > 0; --i) {
+    input_stride[i - 1] = input_stride[i] * dims[i];
+    output_stride[i - 1] = output_stride[i] * dims[perm[i]];
+  }
 
-        // copy
-        CopyPrim<uint32_t>(target, source + (source_offset * element_size));
+  // Output position of the innermost input axis.
+  const size_t inner_position = std::find(perm.begin(), perm.end(), rank - 1) - perm.begin();
+  const bool is_block_copy = inner_position == rank - 1;
+
+  std::vector<size_t> outer_dims;
+  std::vector<size_t> outer_input_stride;
+  std::vector<size_t> outer_output_stride;
+  for (size_t i = 0; i < rank - 1; ++i) {
+    if (i != inner_position) {
+      outer_dims.push_back(dims[perm[i]]);
+      outer_input_stride.push_back(input_stride[perm[i]]);
+      outer_output_stride.push_back(output_stride[i]);
+    }
+  }
+  const size_t outer_rank = outer_dims.size();
+
+  // The matrix of each outer index has M rows along the input axis that becomes innermost in the output and N
+  // columns along the innermost input axis.
+  const size_t M = dims[perm[rank - 1]];
+  const size_t N = dims[rank - 1];
+  const size_t lda = input_stride[perm[rank - 1]];
+  const size_t ldb = output_stride[inner_position];
+  const bool split_columns = N > M;
+
+  size_t pieces_per_index = 1;
+  if (!is_block_copy)
+    pieces_per_index = ((split_columns ? N : M) + kTransposeMatrixPieceSize - 1) / kTransposeMatrixPieceSize;
+  const size_t num_pieces = (num_elements / (is_block_copy ? N : M * N)) * pieces_per_index;
+
+  auto transpose_pieces = [&](size_t begin, size_t end) {
+    // Find the outer index and the offsets into source and target of the first piece.
+    std::vector<size_t> index(outer_rank);
+    size_t piece_in_index = begin % pieces_per_index;
+    size_t outer = begin / pieces_per_index;
+    size_t source_offset = 0;
+    size_t target_offset = 0;
+    for (size_t k = outer_rank; k-- > 0;) {
+      index[k] = outer % outer_dims[k];
+      outer /= outer_dims[k];
+      source_offset += index[k] * outer_input_stride[k];
+      target_offset += index[k] * outer_output_stride[k];
+    }
 
-        // increment target_index:
-        IncrementIndex(target_index, target_dims, num_axes);
-        target += element_size;
+    for (size_t piece = begin; piece < end; ++piece) {
+      if (is_block_copy) {
+        std::copy(source + source_offset, source + source_offset + N, target + target_offset);
+      } else {
+        const size_t start = piece_in_index * kTransposeMatrixPieceSize;
+        if (split_columns) {
+          TransposeMatrix(M, std::min(kTransposeMatrixPieceSize, N - start), source + source_offset + start, lda,
+                          target + target_offset + start * ldb, ldb);
+        } else {
+          TransposeMatrix(std::min(kTransposeMatrixPieceSize, M - start), N, source + source_offset + start * lda,
+                          lda, target + target_offset + start, ldb);
+        }
       }
-      break;
-    case sizeof(uint16_t):
-      for (size_t i = 0; i < num_blocks; ++i) {
-        // convert target_index into an offset in source data
-        size_t source_offset = ComputeOffset(target_index, stride, num_axes);
-
-        // copy
-        CopyPrim<uint16_t>(target, source + (source_offset * element_size));
 
-        // increment target_index:
-        IncrementIndex(target_index, target_dims, num_axes);
-        target += element_size;
+      // Advance to the next piece, moving on to the next outer index when all pieces of this one are done.
+      if (++piece_in_index < pieces_per_index)
+        continue;
+      piece_in_index = 0;
+      for (size_t k = outer_rank; k-- > 0;) {
+        source_offset += outer_input_stride[k];
+        target_offset += outer_output_stride[k];
+        if (++index[k] < outer_dims[k])
+          break;
+        source_offset -= outer_dims[k] * outer_input_stride[k];
+        target_offset -= outer_dims[k] * outer_output_stride[k];
+        index[k] = 0;
       }
-      break;
-    case sizeof(uint8_t):
-      for (size_t i = 0; i < num_blocks; ++i) {
-        // convert target_index into an offset in source data
-        size_t source_offset = ComputeOffset(target_index, stride, num_axes);
-
-        // copy
-        *target = *(source + (source_offset * element_size));
+    }
+  };
 
-        // increment target_index:
-        IncrementIndex(target_index, target_dims, num_axes);
-        target += element_size;
-      }
-      break;
-    default:
-      assert(false);
-  }
+  ThreadPool::TryParallelFor(thread_pool, static_cast<int64_t>(num_pieces), static_cast<int64_t>(num_elements),
+                             [&](int64_t begin, int64_t end) {
+                               transpose_pieces(static_cast<size_t>(begin), static_cast<size_t>(end));
+                             });
 }
 
-static void DoTransposeEltWise(int64_t num_axes, const std::vector<int64_t>& target_dims, size_t num_blocks,
-                               const std::vector<size_t>& stride, const std::string* source, std::string* target) {
-  // index used to iterate over target iteration-space
-  std::vector<int64_t> target_index(num_axes, 0);
-  for (size_t i = 0; i < num_blocks; ++i) {
-    // convert target_index into an offset in source data
-    size_t source_offset = ComputeOffset(target_index, stride, num_axes);
-
-    // copy
-    *target = *(source + source_offset);
+static Status DoUntypedTranspose(const std::vector<int64_t>& permutations, const Tensor& input, Tensor& output,
+                                 ThreadPool* thread_pool) {
+  const auto& input_dims = input.Shape().GetDims();
+  if (input.Shape().Size() == 0)
+    return Status::OK();
 
-    // increment target_index:
-    IncrementIndex(target_index, target_dims, num_axes);
-    target++;
-  }
-}
+  std::vector<size_t> perm;
+  std::vector<int64_t> dims;
+  CoalesceDimensions(permutations, input_dims, perm, dims);
 
-static Status DoUntypedTranspose(const std::vector<int64_t>& permutations, const Tensor& input, Tensor& output) {
-  const auto& input_shape = input.Shape();
-  const auto& input_dims = input_shape.GetDims();
-  auto rank = input_shape.NumDimensions();
-
-  const auto element_size = input.DataType()->Size();
-  const bool is_string_type = input.DataType() == DataTypeImpl::GetType<std::string>();
-
-  std::vector<size_t> stride(rank);
-  for (int i = 0; i < rank; i++) {
-    size_t inpdim = permutations[i];
-    if (inpdim + 1 < rank)
-      stride[i] = input_shape.SizeFromDimension(inpdim + 1);
-    else
-      stride[i] = 1;
+  if (input.DataType() == DataTypeImpl::GetType<std::string>()) {
+    TransposeTyped(perm, dims, input.template Data<std::string>(), output.template MutableData<std::string>(),
+                   thread_pool);
+    return Status::OK();
   }
 
-  // Partition the permutation into a prefix and the largest suffix such that
-  // every axis i in the suffix is mapped to i.
-  int64_t num_axes_in_prefix = 0;  // number of axes in prefix
-  size_t suffix_blocksize = 1;     // product of dimensions in the suffix
-  size_t prefix_blocksize = 1;     // product of dimensions in the prefix
-  bool is_suffix = true;
+  const void* input_data = input.DataRaw();
+  void* output_data = output.MutableDataRaw();
 
-  for (int64_t i = rank - 1; i >= 0; --i) {
-    int64_t input_axis = permutations[i];
-    if (is_suffix && (input_axis == i)) {
-      suffix_blocksize *= input_dims[input_axis];
-    } else {
-      is_suffix = false;
-      prefix_blocksize *= input_dims[input_axis];
-      ++num_axes_in_prefix;
-    }
-  }
-
-  if (is_string_type) {
-    const std::string* input_data = input.template Data<std::string>();
-    std::string* output_data = output.template MutableData<std::string>();
-    if (1 == prefix_blocksize) {
-      DoTransposeSingleBlock(suffix_blocksize, input_data, output_data);
-    } else if (1 == suffix_blocksize) {
-      DoTransposeEltWise(num_axes_in_prefix, output.Shape().GetDims(), prefix_blocksize, stride,
-                         input_data, output_data);
-    } else {
-      DoTransposeImpl(num_axes_in_prefix, output.Shape().GetDims(), prefix_blocksize, suffix_blocksize, stride,
-                      input_data, output_data);
-    }
-  } else {
-    const uint8_t* input_data = reinterpret_cast<const uint8_t*>(input.DataRaw());
-    uint8_t* output_data = reinterpret_cast<uint8_t*>(output.MutableDataRaw());
-    if (1 == prefix_blocksize) {
-      DoTransposeSingleBlock(suffix_blocksize, input_data, output_data, element_size);
-    } else if (1 == suffix_blocksize) {
-      DoTransposeEltWise(num_axes_in_prefix, output.Shape().GetDims(), prefix_blocksize, stride,
-                         input_data, output_data, element_size);
-    } else {
-      DoTransposeImpl(num_axes_in_prefix, output.Shape().GetDims(), prefix_blocksize, suffix_blocksize, stride,
-                      input_data, output_data, element_size);
-    }
+  switch (input.DataType()->Size()) {
+    case sizeof(uint8_t):
+      TransposeTyped(perm, dims, static_cast<const uint8_t*>(input_data), static_cast<uint8_t*>(output_data),
+                     thread_pool);
+      break;
+    case sizeof(uint16_t):
+      TransposeTyped(perm, dims, static_cast<const uint16_t*>(input_data), static_cast<uint16_t*>(output_data),
+                     thread_pool);
+      break;
+    case sizeof(uint32_t):
+      TransposeTyped(perm, dims, static_cast<const uint32_t*>(input_data), static_cast<uint32_t*>(output_data),
+                     thread_pool);
+      break;
+    case sizeof(uint64_t):
+      TransposeTyped(perm, dims, static_cast<const uint64_t*>(input_data), static_cast<uint64_t*>(output_data),
+                     thread_pool);
+      break;
+    default:
+      return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED, "Transpose of element size ", input.DataType()->Size(),
+                             " is not supported");
   }
 
   return Status::OK();
 }
 
-Status TransposeBase::DoTranspose(const std::vector<int64_t>& permutations, const Tensor& input, Tensor& output) {
+Status TransposeBase::DoTranspose(const std::vector<int64_t>& permutations, const Tensor& input, Tensor& output,
+                                  ThreadPool* thread_pool) {
   Status status = Status::OK();
 
   auto input_type = input.DataType();
@@ -249,7 +257,7 @@ Status TransposeBase::DoTranspose(const std::vector<int64_t>& permutations, cons
     status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Mismatched data types between input and output Tensors. ",
                              input_type, " != ", output_type);
   } else {
-    status = DoUntypedTranspose(permutations, input, output);
+    status = DoUntypedTranspose(permutations, input, output, thread_pool);
   }
 
   return status;
@@ -274,9 +282,7 @@ Status Transpose::Compute(OpKernelContext* ctx) const {
   TensorShape output_shape{output_dims};
   Tensor& Y = *ctx->Output(0, output_shape);
 
-  DoUntypedTranspose(*p_perm, X, Y);
-
-  return Status::OK();
+  return DoUntypedTranspose(*p_perm, X, Y, ctx->GetOperatorThreadPool());
 }
 
 ONNX_CPU_OPERATOR_KERNEL(
@@ -5,6 +5,7 @@
 
 #include "gsl/gsl_util"
 #include "core/common/common.h"
+#include "core/common/threadpool.h"
 #include "core/framework/op_kernel.h"
 #include <sstream>
 
@@ -14,9 +15,11 @@ class TransposeBase {
  public:
   /**
   Transpose the input Tensor into the output Tensor using the provided permutations.
-  Both Tensors must have the same data type. 
+  Both Tensors must have the same data type.
+  Large transposes are split across the thread pool if one is provided.
   */
-  static Status DoTranspose(const std::vector<int64_t>& permutations, const Tensor& input, Tensor& output);
+  static Status DoTranspose(const std::vector<int64_t>& permutations, const Tensor& input, Tensor& output,
+                            ThreadPool* thread_pool = nullptr);
 
  protected:
   TransposeBase(const OpKernelInfo& info) {
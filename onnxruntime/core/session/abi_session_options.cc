@@ -65,6 +65,14 @@ ORT_API(void, OrtDisableCpuMemArena, _In_ OrtSessionOptions* options) {
   options->value.enable_cpu_mem_arena = false;
 }
 
+ORT_API(void, OrtEnableCpuMemArenaThreadCache, _In_ OrtSessionOptions* options) {
+  options->value.enable_cpu_mem_arena_thread_cache = true;
+}
+
+ORT_API(void, OrtDisableCpuMemArenaThreadCache, _In_ OrtSessionOptions* options) {
+  options->value.enable_cpu_mem_arena_thread_cache = false;
+}
+
 ///< logger id to use for session output
 ORT_API(void, OrtSetSessionLogId, _In_ OrtSessionOptions* options, const char* logid) {
   options->value.session_logid = logid;
@@ -92,3 +100,43 @@ ORT_API(int, OrtSetSessionThreadPoolSize, _In_ OrtSessionOptions* options, int s
   options->value.session_thread_pool_size = session_thread_pool_size;
   return 0;
 }
+
+///How many threads run the requests queued by OrtRunAsync.
+ORT_API(int, OrtSetSessionInterOpNumThreads, _In_ OrtSessionOptions* options, int inter_op_num_threads) {
+  if (inter_op_num_threads < 0) return -1;
+  options->value.inter_op_num_threads = inter_op_num_threads;
+  return 0;
+}
+
+///How many threads, including the calling thread, kernels can use to parallelize their work.
+ORT_API(int, OrtSetSessionIntraOpNumThreads, _In_ OrtSessionOptions* options, int intra_op_num_threads) {
+  if (intra_op_num_threads < 0) return -1;
+  options->value.intra_op_num_threads = intra_op_num_threads;
+  return 0;
+}
+
+///Pin the threads of the session's intra-op thread pool to logical processors.
+ORT_API(int, OrtSetSessionIntraOpThreadAffinity, _In_ OrtSessionOptions* options,
+        _In_opt_ const size_t* processors, size_t processor_count) {
+  if (processors == nullptr && processor_count > 0) return -1;
+  options->value.intra_op_thread_affinity.assign(processors, processors + processor_count);
+  return 0;
+}
+
+///Use the data of CPU initializers in place instead of copying it.
+ORT_API(void, OrtEnableZeroCopyInitializers, _In_ OrtSessionOptions* options) {
+  options->value.enable_zero_copy_initializers = true;
+}
+
+ORT_API(void, OrtDisableZeroCopyInitializers, _In_ OrtSessionOptions* options) {
+  options->value.enable_zero_copy_initializers = false;
+}
+
+///Share the CPU initializers with other sessions of the same model.
+ORT_API(void, OrtEnableSharedInitializers, _In_ OrtSessionOptions* options) {
+  options->value.enable_shared_initializers = true;
+}
+
+ORT_API(void, OrtDisableSharedInitializers, _In_ OrtSessionOptions* options) {
+  options->value.enable_shared_initializers = false;
+}
@@ -7,13 +7,17 @@
 
 #include "core/session/inference_session.h"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <sstream>
+#include <thread>
 #include <unordered_set>
 #include <list>
 
 #include "core/common/logging/logging.h"
 #include "core/common/task_thread_pool.h"
+#include "core/common/threadpool.h"
 #include "core/platform/notification.h"
 #include "core/platform/ort_mutex.h"
 #include "core/graph/graph_viewer.h"
@@ -45,6 +49,7 @@
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/framework/custom_ops_author.h"
 #include "core/session/IOBinding.h"
+#include "core/session/prepared_run.h"
 #include "core/util/protobuf_parsing_utils.h"
 #include "core/optimizer/rule_based_graph_transformer.h"
 #include "core/optimizer/graph_transformer_utils.h"
@@ -184,6 +189,22 @@ InferenceSession::InferenceSession(const SessionOptions& session_options, loggin
   }
 
   session_state_.SetThreadPool(thread_pool_.get());
+
+  const auto& intra_op_thread_affinity = session_options_.intra_op_thread_affinity;
+  if (session_options_.intra_op_num_threads > 0 || !intra_op_thread_affinity.empty()) {
+    int intra_op_num_threads = session_options_.intra_op_num_threads;
+    if (intra_op_num_threads == 0) {
+      intra_op_num_threads = static_cast<int>(intra_op_thread_affinity.size()) + 1;
+    }
+    intra_op_thread_pool_ = std::make_unique<ThreadPool>(intra_op_num_threads, intra_op_thread_affinity);
+    session_state_.SetIntraOpThreadPool(intra_op_thread_pool_.get());
+  } else {
+    session_state_.SetIntraOpThreadPool(Environment::GetIntraOpThreadPool());
+  }
+
+  session_state_.SetMemoryPatternCacheOptions(session_options_.mem_pattern_cache_capacity,
+                                              session_options_.mem_pattern_shape_buckets);
+
   session_profiler_.Initialize(session_logger_);
   session_state_.SetProfiler(session_profiler_);
   if (session_options.enable_profiling) {
@@ -191,7 +212,18 @@ InferenceSession::InferenceSession(const SessionOptions& session_options, loggin
   }
 }
 
-InferenceSession::~InferenceSession() = default;
+InferenceSession::~InferenceSession() {
+  // queued RunAsync requests use the session, so they have to complete before any of it is destroyed
+  std::unique_ptr<ThreadPool> inter_op_thread_pool;
+  {
+    std::unique_lock<OrtMutex> lock(async_runs_mutex_);
+    while (num_pending_async_runs_ > 0) {
+      async_runs_done_.wait(lock);
+    }
+    inter_op_thread_pool = std::move(inter_op_thread_pool_);
+  }
+  // inter_op_thread_pool joins its threads when it goes out of scope
+}
 
 common::Status InferenceSession::RegisterExecutionProvider(std::unique_ptr<IExecutionProvider> p_exec_provider) {
   if (p_exec_provider == nullptr) {
@@ -439,6 +471,25 @@ common::Status InferenceSession::TransformGraph(onnxruntime::Graph& graph,
   return common::Status::OK();
 }
 
+std::string InferenceSession::GetSharedInitializersKey() const {
+  if (!session_options_.enable_shared_initializers || model_location_.empty()) {
+    return "";
+  }
+
+  // everything that decides how the initializers of the loaded model are transformed
+  std::ostringstream key;
+  key << ToMBString(model_location_) << "|level=" << static_cast<int>(session_options_.graph_optimization_level)
+      << "|transformers=";
+  for (const auto& transformer : transformers_to_enable_) {
+    key << transformer << ",";
+  }
+  key << "|providers=";
+  for (const auto& provider : execution_providers_) {
+    key << provider->Type() << ",";
+  }
+  return key.str();
+}
+
 /// Create SessionState instance for each subgraph as we need that for the GraphPartitioner
 /// This will be initialized by InitializeSubgraphSessions.
 common::Status InferenceSession::CreateSubgraphSessionState(Graph& graph, SessionState& session_state) {
@@ -451,6 +502,9 @@ common::Status InferenceSession::CreateSubgraphSessionState(Graph& graph, Sessio
       auto subgraph_session_state = std::make_unique<SessionState>(execution_providers_);
       subgraph_session_state->SetProfiler(session_profiler_);
       subgraph_session_state->SetLogger(*session_logger_);
+      subgraph_session_state->SetIntraOpThreadPool(session_state.GetIntraOpThreadPool());
+      subgraph_session_state->SetMemoryPatternCacheOptions(session_options_.mem_pattern_cache_capacity,
+                                                           session_options_.mem_pattern_shape_buckets);
 
       // recurse
       ORT_RETURN_IF_ERROR(CreateSubgraphSessionState(*subgraph, *subgraph_session_state));
@@ -484,7 +538,9 @@ common::Status InferenceSession::InitializeSubgraphSessions(Graph& graph, Sessio
       ORT_RETURN_IF_ERROR(initializer.CreatePlan(&node, node.ImplicitInputDefs(),
                                                  session_options_.enable_sequential_execution));
 
-      ORT_RETURN_IF_ERROR(initializer.InitializeAndSave(&node.ImplicitInputDefs()));
+      // initializers of subgraphs aren't shared as their names are only unique within the subgraph
+      ORT_RETURN_IF_ERROR(initializer.InitializeAndSave(&node.ImplicitInputDefs(),
+                                                        session_options_.enable_zero_copy_initializers, ""));
 
       // LOGS(*session_logger_, VERBOSE) << std::make_pair(subgraph_info.session_state->GetExecutionPlan(),
       //                                                   &*subgraph_info.session_state);
@@ -517,7 +573,8 @@ common::Status InferenceSession::Initialize() {
     // Register default CPUExecutionProvider if user didn't provide it through the Register() calls
     if (!execution_providers_.Get(onnxruntime::kCpuExecutionProvider)) {
       LOGS(*session_logger_, INFO) << "Adding default CPU execution provider.";
-      CPUExecutionProviderInfo epi{session_options_.enable_cpu_mem_arena};
+      CPUExecutionProviderInfo epi{session_options_.enable_cpu_mem_arena,
+                                   session_options_.enable_cpu_mem_arena_thread_cache};
       ORT_RETURN_IF_ERROR(execution_providers_.Add(onnxruntime::kCpuExecutionProvider,
                                                    std::make_unique<CPUExecutionProvider>(epi)));
     }
@@ -553,7 +610,8 @@ common::Status InferenceSession::Initialize() {
     ORT_RETURN_IF_ERROR(graph.Resolve());
 
     ORT_RETURN_IF_ERROR(session_initializer.CreatePlan(nullptr, {}, session_options_.enable_sequential_execution));
-    ORT_RETURN_IF_ERROR(session_initializer.InitializeAndSave(nullptr));
+    ORT_RETURN_IF_ERROR(session_initializer.InitializeAndSave(
+        nullptr, session_options_.enable_zero_copy_initializers, GetSharedInitializersKey()));
 
     // handle any subgraphs
     ORT_RETURN_IF_ERROR(InitializeSubgraphSessions(graph, session_state_));
@@ -584,6 +642,10 @@ int InferenceSession::GetCurrentNumRuns() const {
   return current_num_runs_.load();
 }
 
+MemoryPatternCacheStats InferenceSession::GetMemoryPatternCacheStats() const {
+  return session_state_.GetMemoryPatternCacheStats();
+}
+
 common::Status InferenceSession::CheckTypes(MLDataType actual, MLDataType expected) {
   if (actual == expected) {
     return Status::OK();
@@ -706,6 +768,110 @@ common::Status InferenceSession::ValidateOutputs(const std::vector<std::string>&
   return common::Status::OK();
 }
 
+common::Status InferenceSession::ValidatePreparedFeeds(const PreparedRun& prepared_run,
+                                                       const std::vector<MLValue>& feeds) {
+  const auto& feed_types = prepared_run.feed_types_;
+  if (feeds.size() != feed_types.size()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Expected ", feed_types.size(),
+                           " feeds for the prepared run but got ", feeds.size());
+  }
+
+  // names and required inputs were validated by PrepareRun so only the types need to be checked here
+  for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+    const auto& feed = feeds[i];
+    const auto& expected = feed_types[i];
+
+    if (!feed.IsAllocated()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Feed for input ", prepared_run.GetInputNames()[i],
+                             " is not allocated");
+    }
+
+    if (expected.is_tensor) {
+      if (!feed.IsTensor()) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Feed for input ", prepared_run.GetInputNames()[i],
+                               " is not a tensor");
+      }
+
+      ORT_RETURN_IF_ERROR(CheckTypes(feed.Get<Tensor>().DataType(), expected.type));
+    } else {
+      ORT_RETURN_IF_ERROR(CheckTypes(feed.Type(), expected.type));
+    }
+  }
+
+  return Status::OK();
+}
+
+common::Status InferenceSession::ExecuteRun(const RunOptions& run_options,
+                                            FeedsFetchesManager& feeds_fetches_manager,
+                                            PreparedRun* prepared_run,
+                                            const std::vector<MLValue>& feeds,
+                                            std::vector<MLValue>& fetches) {
+  Status retval = Status::OK();
+
+  if (!run_options.run_tag.empty()) {
+    LOGS(*session_logger_, INFO) << "Running with tag: " << run_options.run_tag;
+  }
+
+  ++current_num_runs_;
+
+  try {
+    // TODO should we add this exec to the list of executors? i guess its not needed now?
+
+    // scope of owned_run_logger is just the call to Execute.
+    // If Execute ever becomes async we need a different approach
+    std::unique_ptr<logging::Logger> owned_run_logger;
+    auto& run_logger = CreateLoggerForRun(run_options, owned_run_logger);
+
+    // info all execution providers InferenceSession:Run started
+    // TODO: only call OnRunStart for all providers in-use
+    for (auto& xp : execution_providers_) {
+      ORT_CHECK_AND_SET_RETVAL(xp->OnRunStart());
+    }
+
+    const bool sequential_execution = session_options_.enable_sequential_execution;
+
+    // execute the graph
+    if (prepared_run == nullptr) {
+      ORT_CHECK_AND_SET_RETVAL(
+          utils::ExecuteGraph(session_state_, feeds_fetches_manager, feeds, fetches, {},
+                              sequential_execution, run_options.terminate, run_logger, false));
+    } else if (prepared_run->copy_info_cached_.load(std::memory_order_acquire)) {
+      ORT_CHECK_AND_SET_RETVAL(
+          utils::ExecuteGraphWithCachedInfo(session_state_, feeds_fetches_manager, feeds, fetches, {},
+                                            sequential_execution, run_options.terminate, run_logger));
+    } else {
+      // the first successful execution populates the device copy info in the FeedsFetchesManager, so calls are
+      // serialized until that has happened.
+      std::lock_guard<onnxruntime::OrtMutex> l(prepared_run->cache_mutex_);
+      if (prepared_run->copy_info_cached_.load(std::memory_order_acquire)) {
+        ORT_CHECK_AND_SET_RETVAL(
+            utils::ExecuteGraphWithCachedInfo(session_state_, feeds_fetches_manager, feeds, fetches, {},
+                                              sequential_execution, run_options.terminate, run_logger));
+      } else {
+        ORT_CHECK_AND_SET_RETVAL(
+            utils::ExecuteGraph(session_state_, feeds_fetches_manager, feeds, fetches, {},
+                                sequential_execution, run_options.terminate, run_logger, true));
+        if (retval.IsOK()) {
+          prepared_run->copy_info_cached_.store(true, std::memory_order_release);
+        }
+      }
+    }
+  } catch (const std::exception& e) {
+    retval = Status(common::ONNXRUNTIME, common::FAIL, e.what());
+  } catch (...) {
+    retval = Status(common::ONNXRUNTIME, common::RUNTIME_EXCEPTION, "Encountered unknown exception in Run()");
+  }
+
+  // info all execution providers InferenceSession:Run ended
+  for (auto& xp : execution_providers_) {
+    ORT_CHECK_AND_SET_RETVAL(xp->OnRunEnd());
+  }
+
+  --current_num_runs_;
+
+  return retval;
+}
+
 Status InferenceSession::Run(const RunOptions& run_options,
                              const std::vector<std::string>& feed_names,
                              const std::vector<MLValue>& feeds,
@@ -732,43 +898,207 @@ Status InferenceSession::Run(const RunOptions& run_options,
     ORT_RETURN_IF_ERROR(info.SetMLValueIdxs(session_state_.GetMLValueNameIdxMap()));
     FeedsFetchesManager feeds_fetches_manager{std::move(info)};
 
-    if (!run_options.run_tag.empty()) {
-      LOGS(*session_logger_, INFO) << "Running with tag: " << run_options.run_tag;
+    ORT_CHECK_AND_SET_RETVAL(ExecuteRun(run_options, feeds_fetches_manager, nullptr, feeds, *p_fetches));
+  } catch (const std::exception& e) {
+    retval = Status(common::ONNXRUNTIME, common::FAIL, e.what());
+  } catch (...) {
+    retval = Status(common::ONNXRUNTIME, common::RUNTIME_EXCEPTION, "Encountered unknown exception in Run()");
+  }
+
+  if (session_profiler_.FEnabled()) {
+    session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "model_run", tp);
+  }
+
+  return retval;
+}
+
+common::Status InferenceSession::RunAsync(const RunOptions& run_options,
+                                          const std::vector<std::string>& feed_names,
+                                          const std::vector<MLValue>& feeds,
+                                          const std::vector<std::string>& output_names,
+                                          RunAsyncCallback callback) {
+  if (!callback) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "RunAsync callback is empty");
+  }
+
+  {
+    std::lock_guard<onnxruntime::OrtMutex> l(session_mutex_);
+    if (!is_inited_) {
+      LOGS(*session_logger_, ERROR) << "Session was not initialized";
+      return common::Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
     }
+  }
 
-    ++current_num_runs_;
+  ThreadPool* inter_op_thread_pool;
+  {
+    std::lock_guard<onnxruntime::OrtMutex> l(async_runs_mutex_);
+    if (inter_op_thread_pool_ == nullptr) {
+      int num_threads = session_options_.inter_op_num_threads;
+      if (num_threads <= 0) {
+        num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+      }
+      // the degree of parallelism of a ThreadPool includes the calling thread, but requests only run on pool threads
+      inter_op_thread_pool_ = std::make_unique<ThreadPool>(num_threads + 1);
+    }
+    inter_op_thread_pool = inter_op_thread_pool_.get();
+    ++num_pending_async_runs_;
+  }
 
-    // TODO should we add this exec to the list of executors? i guess its not needed now?
+  struct AsyncRun {
+    std::vector<std::string> feed_names;
+    std::vector<MLValue> feeds;
+    std::vector<std::string> output_names;
+    RunAsyncCallback callback;
+    TimePoint queued_time;
+  };
 
-    // scope of owned_run_logger is just the call to Execute.
-    // If Execute ever becomes async we need a different approach
-    std::unique_ptr<logging::Logger> owned_run_logger;
-    auto run_logger = CreateLoggerForRun(run_options, owned_run_logger);
+  auto async_run = std::make_shared<AsyncRun>();
+  async_run->feed_names = feed_names;
+  async_run->feeds = feeds;
+  async_run->output_names = output_names;
+  async_run->callback = std::move(callback);
+  async_run->queued_time = std::chrono::high_resolution_clock::now();
+
+  inter_op_thread_pool->Schedule([this, &run_options, async_run]() mutable {
+    RunAsyncInfo info;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    info.queue_time_in_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(start_time - async_run->queued_time).count();
+    if (session_profiler_.FEnabled()) {
+      session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "model_run_async_queue",
+                                              async_run->queued_time);
+    }
 
-    // info all execution providers InferenceSession:Run started
-    // TODO: only call OnRunStart for all providers in-use
-    for (auto& xp : execution_providers_) {
-      ORT_CHECK_AND_SET_RETVAL(xp->OnRunStart());
+    std::vector<MLValue> fetches;
+    Status status;
+    if (run_options.terminate) {
+      // cancelled while it was queued
+      status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
+    } else {
+      status = Run(run_options, async_run->feed_names, async_run->feeds, async_run->output_names, &fetches);
+    }
+    info.run_time_in_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::high_resolution_clock::now() - start_time)
+                              .count();
+
+    try {
+      async_run->callback(status, fetches, info);
+    } catch (const std::exception& ex) {
+      LOGS(*session_logger_, ERROR) << "RunAsync callback threw an exception: " << ex.what();
+    } catch (...) {
+      LOGS(*session_logger_, ERROR) << "RunAsync callback threw an exception";
     }
 
-    // execute the graph
-    ORT_CHECK_AND_SET_RETVAL(
-        utils::ExecuteGraph(session_state_, feeds_fetches_manager, feeds, *p_fetches, {},
-                            session_options_.enable_sequential_execution, run_options.terminate, run_logger,
-                            false));
+    // release the feeds and fetches while the session is guaranteed to be alive
+    fetches.clear();
+    async_run.reset();
+
+    std::lock_guard<onnxruntime::OrtMutex> l(async_runs_mutex_);
+    if (--num_pending_async_runs_ == 0) {
+      async_runs_done_.notify_all();
+    }
+  });
+
+  return Status::OK();
+}
+
+int InferenceSession::GetNumPendingAsyncRuns() const {
+  std::lock_guard<onnxruntime::OrtMutex> l(async_runs_mutex_);
+  return num_pending_async_runs_;
+}
+
+common::Status InferenceSession::PrepareRun(const std::vector<std::string>& feed_names,
+                                            const std::vector<std::string>& output_names,
+                                            std::unique_ptr<PreparedRun>* prepared_run) {
+  if (!prepared_run) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "PreparedRun pointer is NULL");
+  }
 
+  {
+    std::lock_guard<onnxruntime::OrtMutex> l(session_mutex_);
+    if (!is_inited_) {
+      LOGS(*session_logger_, ERROR) << "Session was not initialized";
+      return common::Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+    }
+  }
+
+  // resolve the expected type of each feed. this is the check ValidateInputs does on every Run() call.
+  std::vector<PreparedRun::FeedType> feed_types;
+  feed_types.reserve(feed_names.size());
+  for (const auto& name : feed_names) {
+    auto iter = input_def_map_.find(name);
+    if (input_def_map_.end() == iter) {
+      std::ostringstream ostr;
+      std::for_each(std::begin(model_input_names_),
+                    std::end(model_input_names_),
+                    [&ostr](const std::string& elem) {
+                      ostr << elem << " ";
+                    });
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Invalid Feed Input Names:", name,
+                             ". Valid input names are: ", ostr.str());
+    }
+
+    auto expected_type = utils::GetMLDataType(*iter->second);
+    if (expected_type->IsTensorType()) {
+      feed_types.push_back({true, expected_type->AsTensorType()->GetElementType()});
+    } else {
+      feed_types.push_back({false, expected_type});
+    }
+  }
+
+  for (const auto& name : required_model_input_names_) {
+    if (!name.empty() && std::find(feed_names.cbegin(), feed_names.cend(), name) == feed_names.cend()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Missing required input: ", name);
+    }
+  }
+
+  std::vector<MLValue> no_fetches;
+  ORT_RETURN_IF_ERROR(ValidateOutputs(output_names, &no_fetches));
+
+  std::unique_ptr<FeedsFetchesManager> feeds_fetches_manager;
+  ORT_RETURN_IF_ERROR(FeedsFetchesManager::Create(feed_names, output_names, session_state_.GetMLValueNameIdxMap(),
+                                                  feeds_fetches_manager));
+
+  // private constructor, can't use make_unique
+  *prepared_run = std::unique_ptr<PreparedRun>(new PreparedRun(*this, std::move(feeds_fetches_manager),
+                                                               std::move(feed_types)));
+  return Status::OK();
+}
+
+common::Status InferenceSession::Run(const RunOptions& run_options,
+                                     PreparedRun& prepared_run,
+                                     const std::vector<MLValue>& feeds,
+                                     std::vector<MLValue>* p_fetches) {
+  auto tp = session_profiler_.StartTime();
+  Status retval = Status::OK();
+
+  try {
+    if (prepared_run.session_ != this) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "PreparedRun was created by a different session");
+    }
+
+    ORT_RETURN_IF_ERROR(ValidatePreparedFeeds(prepared_run, feeds));
+
+    if (!p_fetches) {
+      return common::Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
+                            "Output vector pointer is NULL");
+    }
+
+    const auto& output_names = prepared_run.GetOutputNames();
+    if (!p_fetches->empty() && (output_names.size() != p_fetches->size())) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Output vector incorrectly sized: output_names.size(): ", output_names.size(),
+                             "p_fetches->size(): ", p_fetches->size());
+    }
+
+    retval = ExecuteRun(run_options, *prepared_run.feeds_fetches_manager_, &prepared_run, feeds, *p_fetches);
   } catch (const std::exception& e) {
     retval = Status(common::ONNXRUNTIME, common::FAIL, e.what());
   } catch (...) {
     retval = Status(common::ONNXRUNTIME, common::RUNTIME_EXCEPTION, "Encountered unknown exception in Run()");
   }
 
-  // info all execution providers InferenceSession:Run ended
-  for (auto& xp : execution_providers_) {
-    ORT_CHECK_AND_SET_RETVAL(xp->OnRunEnd());
-  }
-
-  --current_num_runs_;
   if (session_profiler_.FEnabled()) {
     session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "model_run", tp);
   }
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include <unordered_map>
 
@@ -36,13 +37,32 @@ struct OrtCustomOpDomain {
 namespace onnxruntime {
 class IExecutionProvider;  // forward decl
 class IOBinding;
+class PreparedRun;
 class CustomRegistry;
+class FeedsFetchesManager;
 class Notification;
+class ThreadPool;
 
 namespace logging {
 class LoggingManager;
 }
 
+/**
+  * Timing information of a request queued by InferenceSession::RunAsync.
+  */
+struct RunAsyncInfo {
+  int64_t queue_time_in_us = 0;  ///< time the request waited for an inter-op thread
+  int64_t run_time_in_us = 0;    ///< time spent running the request, not including the callback
+};
+
+/**
+  * Called on an inter-op thread once a RunAsync request has completed, failed or was cancelled.
+  * fetches contains the output values in the order of the output names if status is OK.
+  * The callback must not throw.
+  */
+using RunAsyncCallback =
+    std::function<void(const common::Status& status, std::vector<MLValue>& fetches, const RunAsyncInfo& info)>;
+
 /**
   * Configuration information for a session.
   */
@@ -58,6 +78,10 @@ struct SessionOptions {
   // set this option to false if you don't want it.
   bool enable_cpu_mem_arena = true;
 
+  // serve small CPU allocations from per-thread caches in front of the arena, so concurrent Run calls don't
+  // contend on the arena lock. Each thread that allocates keeps up to 1MB of free chunks cached.
+  bool enable_cpu_mem_arena_thread_cache = false;
+
   // the prefix of the profile file. The current time will be appended to the file name.
   std::basic_string<ORTCHAR_T> profile_file_prefix = ORT_TSTR("onnxruntime_profile_");
 
@@ -71,6 +95,41 @@ struct SessionOptions {
 
   // How many threads in the session thread pool.
   int session_thread_pool_size = 0;
+
+  // Number of threads of the inter-op thread pool that runs the requests queued by RunAsync. The pool is created by
+  // the first RunAsync call. If 0, the number of hardware threads is used.
+  int inter_op_num_threads = 0;
+
+  // Degree of parallelism of the intra-op thread pool used by kernels to parallelize their work, including the
+  // thread calling Run. If 0, the session uses the process-wide pool created by the Environment.
+  int intra_op_num_threads = 0;
+
+  // Logical processors the threads of the session's intra-op thread pool are pinned to. Pool thread i runs on
+  // intra_op_thread_affinity[i % size]; the thread calling Run is not pinned. Empty (the default) pins nothing.
+  // If set, the session creates its own intra-op thread pool, with one pool thread per listed processor plus the
+  // calling thread unless intra_op_num_threads says otherwise.
+  std::vector<size_t> intra_op_thread_affinity;
+
+  // Maximum number of memory patterns the session caches, one per distinct set of (bucketed) input shapes.
+  // The least recently used pattern is evicted once the limit is reached. 0 means no limit.
+  size_t mem_pattern_cache_capacity = 16;
+
+  // Upper bounds that input dims are rounded up to when looking up the memory pattern cache, e.g. {32, 64, 128}
+  // lets sequence lengths 33 to 64 share a pattern, which grows to fit the largest shape seen.
+  // Dims larger than the last bucket are used as is. Empty means patterns are cached per exact shape.
+  std::vector<int64_t> mem_pattern_shape_buckets;
+
+  // Let CPU initializers use their data where it already is instead of copying it into the weights buffers.
+  // External data files are memory-mapped read-only, so the pages are shared by all sessions and processes that
+  // load the same file. raw_data embedded in the model is used directly from the loaded model, which is then kept
+  // for the lifetime of the session. Initializers that are not suitably aligned are copied as usual.
+  bool enable_zero_copy_initializers = false;
+
+  // Share the CPU initializers with the other sessions in the process that have this set and load the same model
+  // file with the same graph optimization level, transformers and execution providers, so the weights are only
+  // held once. Sessions of models that are not loaded from a file don't share their initializers.
+  // Graph transformers registered with RegisterGraphTransformer must be the same for all of these sessions.
+  bool enable_shared_initializers = false;
 };
 
 /**
@@ -217,6 +276,28 @@ class InferenceSession {
                      const std::vector<std::string>& output_names,
                      std::vector<MLValue>* p_fetches);
 
+  /**
+    * Queue a Run onto the inter-op thread pool of the session and return without waiting for it.
+    * Thousands of requests can be in flight with only SessionOptions::inter_op_num_threads threads.
+    * @param run_options must stay alive until the callback is called. Setting run_options.terminate cancels the
+    *        request if it hasn't started yet, or terminates it like Run() otherwise.
+    * @param feed_names, feeds, output_names see Run(). they are copied, so the caller can release them once this
+    *        returns.
+    * @param callback called once with the result. The InferenceSession must not be destroyed by the callback.
+    *        Destroying the session waits for all the queued requests to complete.
+    * @return OK if the request was queued. If not, the callback is not called.
+    */
+  common::Status RunAsync(const RunOptions& run_options,
+                          const std::vector<std::string>& feed_names,
+                          const std::vector<MLValue>& feeds,
+                          const std::vector<std::string>& output_names,
+                          RunAsyncCallback callback);
+
+  /**
+    * Get the number of RunAsync requests whose callback hasn't completed yet.
+    */
+  int GetNumPendingAsyncRuns() const;
+
   /**
   * Creates a new binding object for binding inputs and outputs.
   * @param provider_type specifies the location where the inputs need to be potentially copied. 
@@ -227,6 +308,28 @@ class InferenceSession {
   common::Status Run(const RunOptions& run_options, IOBinding& io_binding);
   common::Status Run(IOBinding& io_binding);
 
+  /**
+    * Creates a run handle for a fixed set of feed and output names. The names are validated and resolved
+    * once here instead of on every Run() call. See PreparedRun class for more info.
+    * @param feed_names names of the inputs that will be provided to each Run(), in the order of the feeds.
+    * @param output_names names of the outputs to fetch, in the order of the fetches.
+    */
+  common::Status PrepareRun(const std::vector<std::string>& feed_names,
+                            const std::vector<std::string>& output_names,
+                            std::unique_ptr<PreparedRun>* prepared_run);
+
+  /**
+    * Run a pre-loaded and pre-intialized model using a run handle created by PrepareRun().
+    * Multiple threads are allowed to run this function with the same prepared_run.
+    * @param feeds inputs in the order of the feed names provided to PrepareRun().
+    * @param p_fetches output values in the order of the output names provided to PrepareRun().
+    * @return OK if success.
+    */
+  common::Status Run(const RunOptions& run_options,
+                     PreparedRun& prepared_run,
+                     const std::vector<MLValue>& feeds,
+                     std::vector<MLValue>* p_fetches);
+
   /**
     * @return pair.first = OK; FAIL otherwise. pair.second is non-NULL when pair.first = OK.
     * @note lifetime of the returned pointer is valid as long as the Session object is live.
@@ -253,6 +356,11 @@ class InferenceSession {
     */
   int GetCurrentNumRuns() const;
 
+  /**
+    * Get the hit/miss/eviction counters of the memory pattern cache of the main graph.
+    */
+  MemoryPatternCacheStats GetMemoryPatternCacheStats() const;
+
   /**
     * Start profiling on this inference session. This simply turns on profiling events to be 
     * recorded. A corresponding EndProfiling has to follow to write profiling data to a file.
@@ -341,6 +449,9 @@ class InferenceSession {
 
   common::Status CreateSubgraphSessionState(Graph& graph, SessionState& session_state);
 
+  // Key of the initializers of the main graph in the SharedInitializerStore, or empty if they are not shared.
+  std::string GetSharedInitializersKey() const;
+
   common::Status InitializeSubgraphSessions(Graph& graph, SessionState& session_state);
 
   void AddPredefinedTransformers(GraphTransformerManager& transformer_manager,
@@ -357,6 +468,16 @@ class InferenceSession {
   common::Status ValidateOutputs(const std::vector<std::string>& output_names,
                                  const std::vector<MLValue>* p_fetches);
 
+  common::Status ValidatePreparedFeeds(const PreparedRun& prepared_run, const std::vector<MLValue>& feeds);
+
+  // Executes the graph using feeds_fetches_manager. If prepared_run is provided the device copy info cached in it
+  // is used, or populated by this call if not available yet.
+  common::Status ExecuteRun(const RunOptions& run_options,
+                            FeedsFetchesManager& feeds_fetches_manager,
+                            PreparedRun* prepared_run,
+                            const std::vector<MLValue>& feeds,
+                            std::vector<MLValue>& fetches);
+
   common::Status WaitForNotification(Notification* p_executor_done, int64_t timeout_in_ms);
 
   template <typename T>
@@ -409,6 +530,15 @@ class InferenceSession {
   std::unique_ptr<TaskThreadPool> thread_pool_;
 #endif
 
+  // Intra-op thread pool owned by this session. null if the process-wide pool from the Environment is used.
+  std::unique_ptr<ThreadPool> intra_op_thread_pool_;
+
+  // Inter-op thread pool that runs the RunAsync requests. Created by the first RunAsync call.
+  std::unique_ptr<ThreadPool> inter_op_thread_pool_;  // GUARDED_BY(async_runs_mutex_)
+  int num_pending_async_runs_ = 0;                     // GUARDED_BY(async_runs_mutex_)
+  mutable onnxruntime::OrtMutex async_runs_mutex_;
+  onnxruntime::OrtCondVar async_runs_done_;
+
   // Number of concurrently running executors
   std::atomic<int> current_num_runs_;
 
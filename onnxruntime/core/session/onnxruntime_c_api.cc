@@ -21,6 +21,7 @@
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/onnxruntime_typeinfo.h"
 #include "core/session/inference_session.h"
+#include "core/session/prepared_run.h"
 #include "core/framework/data_types.h"
 #include "abi_session_options_impl.h"
 
@@ -118,6 +119,11 @@ ORT_API_STATUS_IMPL(OrtCreateEnvWithCustomLogger, OrtLoggingFunction logging_fun
 
 ORT_API_STATUS_IMPL(OrtCreateEnv, OrtLoggingLevel default_warning_level,
                     _In_ const char* logid, _Out_ OrtEnv** out) {
+  return OrtCreateEnvWithIntraOpThreads(default_warning_level, logid, 0, out);
+}
+
+ORT_API_STATUS_IMPL(OrtCreateEnvWithIntraOpThreads, OrtLoggingLevel default_warning_level,
+                    _In_ const char* logid, int intra_op_num_threads, _Out_ OrtEnv** out) {
   API_IMPL_BEGIN
   std::string name = logid;
   auto default_logging_manager = std::make_unique<LoggingManager>(std::unique_ptr<ISink>{new CLogSink{}},
@@ -125,7 +131,7 @@ ORT_API_STATUS_IMPL(OrtCreateEnv, OrtLoggingLevel default_warning_level,
                                                                   LoggingManager::InstanceType::Default,
                                                                   &name);
   std::unique_ptr<Environment> env;
-  Status status = Environment::Create(env);
+  Status status = Environment::Create(env, intra_op_num_threads);
   if (status.IsOK()) {
     *out = new OrtEnv(env.release(), default_logging_manager.release());
     return nullptr;
@@ -458,6 +464,167 @@ ORT_API_STATUS_IMPL(OrtRun, _In_ OrtSession* sess,
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtRunAsync, _Inout_ OrtSession* sess,
+                    _In_opt_ OrtRunOptions* run_options,
+                    _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
+                    _In_ const char* const* output_names1, size_t output_names_len,
+                    _In_ OrtRunAsyncCallback callback, _In_opt_ void* user_data) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  const int queue_id = 0;
+
+  if (callback == nullptr) {
+    return OrtCreateStatus(ORT_INVALID_ARGUMENT, "callback cannot be null");
+  }
+
+  std::vector<std::string> feed_names(input_len);
+  std::vector<MLValue> feeds(input_len);
+
+  for (size_t i = 0; i != input_len; ++i) {
+    if (input_names[i] == nullptr || input_names[i][0] == '\0') {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "input name cannot be empty");
+    }
+
+    feed_names[i] = input_names[i];
+    auto& mlvalue = feeds[i] = *reinterpret_cast<const ::onnxruntime::MLValue*>(input[i]);
+
+    if (mlvalue.Fence())
+      mlvalue.Fence()->BeforeUsingAsInput(onnxruntime::kCpuExecutionProvider, queue_id);
+  }
+
+  std::vector<std::string> output_names(output_names_len);
+  for (size_t i = 0; i != output_names_len; ++i) {
+    if (output_names1[i] == nullptr || output_names1[i][0] == '\0') {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "output name cannot be empty");
+    }
+    output_names[i] = output_names1[i];
+  }
+
+  // the queued request may outlive the caller's stack, so a null run_options maps to a default that is never freed
+  static OrtRunOptions* default_run_options = new OrtRunOptions();
+  const OrtRunOptions& options = run_options != nullptr ? *run_options : *default_run_options;
+
+  auto on_completed = [callback, user_data, queue_id](const Status& status, std::vector<MLValue>& fetches,
+                                                      const ::onnxruntime::RunAsyncInfo& info) {
+    if (!status.IsOK()) {
+      OrtStatus* ort_status = ToOrtStatus(status);
+      callback(user_data, nullptr, 0, ort_status, info.queue_time_in_us);
+      OrtReleaseStatus(ort_status);
+      return;
+    }
+
+    // this runs on a pool thread, so a failure here is reported through the callback rather than thrown, and the
+    // values created so far stay owned here until they are handed over
+    std::vector<std::unique_ptr<MLValue>> values;
+    std::vector<OrtValue*> outputs;
+    try {
+      values.reserve(fetches.size());
+      outputs.resize(fetches.size());
+      for (::onnxruntime::MLValue& value : fetches) {
+        if (value.Fence())
+          value.Fence()->BeforeUsingAsInput(onnxruntime::kCpuExecutionProvider, queue_id);
+        values.push_back(std::make_unique<MLValue>(value));
+      }
+    } catch (const std::exception& ex) {
+      OrtStatus* ort_status = OrtCreateStatus(ORT_FAIL, ex.what());
+      callback(user_data, nullptr, 0, ort_status, info.queue_time_in_us);
+      OrtReleaseStatus(ort_status);
+      return;
+    }
+
+    for (size_t i = 0; i != values.size(); ++i) {
+      outputs[i] = reinterpret_cast<OrtValue*>(values[i].release());
+    }
+    callback(user_data, outputs.data(), outputs.size(), nullptr, info.queue_time_in_us);
+  };
+
+  auto status = session->RunAsync(options, feed_names, feeds, output_names, on_completed);
+  if (!status.IsOK())
+    return ToOrtStatus(status);
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtCreatePreparedRun, _Inout_ OrtSession* sess,
+                    _In_ const char* const* input_names, size_t input_len,
+                    _In_ const char* const* output_names1, size_t output_names_len, _Out_ OrtPreparedRun** out) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+
+  std::vector<std::string> feed_names(input_len);
+  for (size_t i = 0; i != input_len; ++i) {
+    if (input_names[i] == nullptr || input_names[i][0] == '\0') {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "input name cannot be empty");
+    }
+    feed_names[i] = input_names[i];
+  }
+
+  std::vector<std::string> output_names(output_names_len);
+  for (size_t i = 0; i != output_names_len; ++i) {
+    if (output_names1[i] == nullptr || output_names1[i][0] == '\0') {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "output name cannot be empty");
+    }
+    output_names[i] = output_names1[i];
+  }
+
+  std::unique_ptr<PreparedRun> prepared_run;
+  auto status = session->PrepareRun(feed_names, output_names, &prepared_run);
+  if (!status.IsOK())
+    return ToOrtStatus(status);
+  *out = reinterpret_cast<OrtPreparedRun*>(prepared_run.release());
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtRunPrepared, _Inout_ OrtSession* sess,
+                    _In_ OrtRunOptions* run_options, _Inout_ OrtPreparedRun* prepared_run,
+                    _In_ const OrtValue* const* input, size_t input_len,
+                    size_t output_len, _Out_ OrtValue** output) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  auto& prepared = *reinterpret_cast<PreparedRun*>(prepared_run);
+  const int queue_id = 0;
+
+  std::vector<MLValue> feeds(input_len);
+  for (size_t i = 0; i != input_len; ++i) {
+    auto& mlvalue = feeds[i] = *reinterpret_cast<const ::onnxruntime::MLValue*>(input[i]);
+
+    if (mlvalue.Fence())
+      mlvalue.Fence()->BeforeUsingAsInput(onnxruntime::kCpuExecutionProvider, queue_id);
+  }
+
+  std::vector<MLValue> fetches(output_len);
+  for (size_t i = 0; i != output_len; ++i) {
+    if (output[i] != nullptr) {
+      ::onnxruntime::MLValue& value = *reinterpret_cast<::onnxruntime::MLValue*>(output[i]);
+      if (value.Fence())
+        value.Fence()->BeforeUsingAsOutput(onnxruntime::kCpuExecutionProvider, queue_id);
+      fetches[i] = value;
+    }
+  }
+
+  Status status;
+  if (run_options == nullptr) {
+    OrtRunOptions op;
+    status = session->Run(op, prepared, feeds, &fetches);
+  } else {
+    status = session->Run(*run_options, prepared, feeds, &fetches);
+  }
+
+  if (!status.IsOK())
+    return ToOrtStatus(status);
+  for (size_t i = 0; i != output_len; ++i) {
+    ::onnxruntime::MLValue& value = fetches[i];
+    if (value.Fence())
+      value.Fence()->BeforeUsingAsInput(onnxruntime::kCpuExecutionProvider, queue_id);
+    if (output[i] == nullptr) {
+      output[i] = reinterpret_cast<OrtValue*>(new MLValue(value));
+    }
+  }
+  return nullptr;
+  API_IMPL_END
+}
+
 ORT_API_STATUS_IMPL(OrtGetTensorMutableData, _In_ OrtValue* value, _Out_ void** output) {
   TENSOR_READWRITE_API_BEGIN
   //TODO: test if it's a string tensor
@@ -1096,3 +1263,4 @@ DEFINE_RELEASE_ORT_OBJECT_FUNCTION(Env, OrtEnv)
 DEFINE_RELEASE_ORT_OBJECT_FUNCTION(Value, MLValue)
 DEFINE_RELEASE_ORT_OBJECT_FUNCTION(RunOptions, OrtRunOptions)
 DEFINE_RELEASE_ORT_OBJECT_FUNCTION(Session, ::onnxruntime::InferenceSession)
+DEFINE_RELEASE_ORT_OBJECT_FUNCTION(PreparedRun, ::onnxruntime::PreparedRun)
@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/framework/data_types.h"
+#include "core/framework/feeds_fetches_manager.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+class InferenceSession;
+
+/**
+  * A run handle that has the feed and fetch names of a Run() call resolved up front.
+  * Usage is as follows:
+  *
+  * InferenceSession session;
+  * session.Load();
+  * session.Initialize();
+  * ...
+  * std::unique_ptr<PreparedRun> prepared_run;
+  * session.PrepareRun(feed_names, output_names, &prepared_run);
+  *
+  * for (;;) {
+  *   std::vector<MLValue> fetches;
+  *   session.Run(run_options, *prepared_run, feeds, &fetches);
+  * }
+  *
+  * The names are validated and mapped to MLValue indices once when the handle is created, and the expected types
+  * of the feeds are recorded so each Run() only needs to compare types. The device copy information is
+  * computed by the first Run() and re-used by all subsequent calls, so the feeds and pre-allocated fetches
+  * must come from the same location (device) in every call.
+  *
+  * A PreparedRun may be used by multiple threads concurrently. It must not outlive the InferenceSession that
+  * created it, and can only be run by that session, as the MLValue indices it holds are specific to it.
+  */
+class PreparedRun {
+ public:
+  const std::vector<std::string>& GetInputNames() const {
+    return feeds_fetches_manager_->GetFeedsFetchesInfo().feed_names;
+  }
+
+  const std::vector<std::string>& GetOutputNames() const {
+    return feeds_fetches_manager_->GetFeedsFetchesInfo().output_names;
+  }
+
+ private:
+  friend InferenceSession;
+
+  // Expected type of a feed. For tensors this is the element type, otherwise it's the MLValue type.
+  struct FeedType {
+    bool is_tensor;
+    MLDataType type;
+  };
+
+  PreparedRun(const InferenceSession& session, std::unique_ptr<FeedsFetchesManager> feeds_fetches_manager,
+              std::vector<FeedType>&& feed_types)
+      : session_{&session},
+        feeds_fetches_manager_{std::move(feeds_fetches_manager)},
+        feed_types_{std::move(feed_types)} {}
+
+  // the session that created this handle
+  const InferenceSession* session_;
+  std::unique_ptr<FeedsFetchesManager> feeds_fetches_manager_;
+  std::vector<FeedType> feed_types_;
+
+  // set once the device copy info in feeds_fetches_manager_ has been populated by a successful Run()
+  std::atomic<bool> copy_info_cached_{false};
+
+  // serializes Run() calls until copy_info_cached_ is set
+  OrtMutex cache_mutex_;
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(PreparedRun);
+};
+}  // namespace onnxruntime
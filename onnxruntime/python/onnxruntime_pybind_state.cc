@@ -100,6 +100,38 @@ template <typename T>
 void AddNonTensor(onnxruntime::MLValue& val, vector<py::object>& pyobjs) {
   pyobjs.push_back(py::cast(val.Get<T>()));
 }
+
+// ZipMap produces the same keys for every row, so the Python key objects are
+// created once from the first row and reused instead of being converted per row.
+template <typename K>
+void AddVectorMapToFloat(onnxruntime::MLValue& val, vector<py::object>& pyobjs) {
+  const auto& rows = val.Get<std::vector<std::map<K, float>>>();
+  std::vector<std::pair<K, py::object>> keys;
+  if (!rows.empty()) {
+    keys.reserve(rows.front().size());
+    for (const auto& item : rows.front()) {
+      keys.emplace_back(item.first, py::cast(item.first));
+    }
+  }
+
+  py::list result(rows.size());
+  for (size_t n = 0; n < rows.size(); ++n) {
+    py::dict row;
+    size_t i = 0;
+    for (const auto& item : rows[n]) {
+      py::object value = py::float_(item.second);
+      if (i < keys.size() && keys[i].first == item.first) {
+        row[keys[i].second] = value;
+      } else {
+        row[py::cast(item.first)] = value;
+      }
+      ++i;
+    }
+    result[n] = std::move(row);
+  }
+  pyobjs.push_back(std::move(result));
+}
+
 void AddNonTensorAsPyObj(onnxruntime::MLValue& val, vector<py::object>& pyobjs) {
   // Should be in sync with core/framework/datatypes.h
   if (val.Type() == DataTypeImpl::GetType<MapStringToString>()) {
@@ -127,9 +159,9 @@ void AddNonTensorAsPyObj(onnxruntime::MLValue& val, vector<py::object>& pyobjs)
   } else if (val.Type() == DataTypeImpl::GetType<VectorDouble>()) {
     AddNonTensor<VectorDouble>(val, pyobjs);
   } else if (val.Type() == DataTypeImpl::GetType<VectorMapStringToFloat>()) {
-    AddNonTensor<VectorMapStringToFloat>(val, pyobjs);
+    AddVectorMapToFloat<std::string>(val, pyobjs);
   } else if (val.Type() == DataTypeImpl::GetType<VectorMapInt64ToFloat>()) {
-    AddNonTensor<VectorMapInt64ToFloat>(val, pyobjs);
+    AddVectorMapToFloat<int64_t>(val, pyobjs);
   } else {
     throw std::runtime_error("Output is a non-tensor type which is not supported.");
   }
@@ -342,6 +374,9 @@ void addObjectMethods(py::module& m) {
       .def_readwrite("enable_cpu_mem_arena", &SessionOptions::enable_cpu_mem_arena,
                      R"pbdoc(Enables the memory arena on CPU. Arena may pre-allocate memory for future usage.
 Set this option to false if you don't want it. Default is True.)pbdoc")
+      .def_readwrite("enable_cpu_mem_arena_thread_cache", &SessionOptions::enable_cpu_mem_arena_thread_cache,
+                     R"pbdoc(Serves small allocations of the CPU memory arena from per-thread caches, so concurrent
+runs don't contend on the arena lock. Each thread keeps up to 1MB of free memory cached. Default is False.)pbdoc")
       .def_readwrite("enable_profiling", &SessionOptions::enable_profiling,
                      R"pbdoc(Enable profiling for this session. Default is false.)pbdoc")
       .def_readwrite("enable_sequential_execution", &SessionOptions::enable_sequential_execution,
@@ -354,7 +389,28 @@ Set this option to false if you don't want it. Default is True.)pbdoc")
                      R"pbdoc(Applies to session load, initialization, etc. Default is 0.)pbdoc")
       .def_readwrite("session_thread_pool_size", &SessionOptions::session_thread_pool_size,
                      R"pbdoc(How many threads in the session thread pool. Default is 0 to let onnxruntime choose.
-This parameter is unused unless *enable_sequential_execution* is false.)pbdoc");
+This parameter is unused unless *enable_sequential_execution* is false.)pbdoc")
+      .def_readwrite("inter_op_num_threads", &SessionOptions::inter_op_num_threads,
+                     R"pbdoc(How many threads run the requests queued with the asynchronous run API. Default is 0 to use
+the number of hardware threads.)pbdoc")
+      .def_readwrite("intra_op_num_threads", &SessionOptions::intra_op_num_threads,
+                     R"pbdoc(How many threads, including the calling thread, operators can use to parallelize their
+work. Default is 0 to share the process-wide thread pool.)pbdoc")
+      .def_readwrite("intra_op_thread_affinity", &SessionOptions::intra_op_thread_affinity,
+                     R"pbdoc(Logical processors the intra-op threads are pinned to, one per thread in turn. The thread
+calling run is not pinned. Default is empty to pin nothing.)pbdoc")
+      .def_readwrite("mem_pattern_cache_capacity", &SessionOptions::mem_pattern_cache_capacity,
+                     R"pbdoc(Maximum number of memory patterns cached for different input shapes. Default is 16.
+0 means no limit.)pbdoc")
+      .def_readwrite("mem_pattern_shape_buckets", &SessionOptions::mem_pattern_shape_buckets,
+                     R"pbdoc(Upper bounds that input dimensions are rounded up to so that similar input shapes share
+a memory pattern. Default is empty to cache a pattern per exact input shape.)pbdoc")
+      .def_readwrite("enable_zero_copy_initializers", &SessionOptions::enable_zero_copy_initializers,
+                     R"pbdoc(Lets CPU initializers use memory-mapped external data and the loaded model in place
+instead of copying them. Default is false.)pbdoc")
+      .def_readwrite("enable_shared_initializers", &SessionOptions::enable_shared_initializers,
+                     R"pbdoc(Shares the CPU initializers with other sessions in the process that load the same model
+file with the same optimization level and execution providers. Default is false.)pbdoc");
 
   py::class_<RunOptions>(m, "RunOptions", R"pbdoc(Configuration information for a single Run.)pbdoc")
       .def(py::init())
@@ -503,6 +559,15 @@ including arg name, arg type (contains both type and shape).)pbdoc")
       .def("end_profiling", [](InferenceSession* sess) -> std::string {
         return sess->EndProfiling();
       })
+      .def_property_readonly("memory_pattern_cache_stats", [](const InferenceSession* sess) -> py::dict {
+        auto stats = sess->GetMemoryPatternCacheStats();
+        py::dict res;
+        res["hits"] = stats.hits;
+        res["misses"] = stats.misses;
+        res["evictions"] = stats.evictions;
+        res["size"] = stats.size;
+        return res;
+      })
       .def_property_readonly("inputs_meta", [](const InferenceSession* sess) -> const std::vector<const onnxruntime::NodeArg*>& {
         auto res = sess->GetModelInputs();
         if (!res.first.IsOK()) {
@@ -0,0 +1,140 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+static void TestParallelFor(int degree_of_parallelism, int32_t total, std::vector<size_t> thread_affinity = {}) {
+  ThreadPool thread_pool(degree_of_parallelism, std::move(thread_affinity));
+  ASSERT_EQ(degree_of_parallelism, thread_pool.DegreeOfParallelism());
+
+  std::vector<std::atomic<int>> counts(total);
+  for (auto& count : counts) {
+    count = 0;
+  }
+
+  thread_pool.ParallelFor(total, [&counts](int32_t i) { ++counts[i]; });
+
+  for (int32_t i = 0; i < total; ++i) {
+    ASSERT_EQ(1, counts[i]) << "iteration " << i;
+  }
+}
+
+TEST(ThreadPoolTest, ParallelFor) {
+  TestParallelFor(1, 10);
+  TestParallelFor(2, 1);
+  TestParallelFor(4, 3);
+  TestParallelFor(4, 1000);
+}
+
+// pinning is a hint, so this only checks the pool still works when the threads are created with affinity set
+TEST(ThreadPoolTest, ParallelForPinnedThreads) {
+  TestParallelFor(4, 1000, {0});
+  TestParallelFor(4, 1000, {0, 1});
+}
+
+#ifdef __linux__
+// the pool threads take the listed processors in turn instead of a fixed processor per thread index
+TEST(ThreadPoolTest, ThreadAffinityFromList) {
+  cpu_set_t process_cpuset;
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(process_cpuset), &process_cpuset));
+  if (!CPU_ISSET(0, &process_cpuset)) {
+    return;  // processor 0 is not available to this process, so the pinning request is ignored
+  }
+
+  ThreadPool thread_pool(2, {0});
+
+  std::atomic<bool> done{false};
+  cpu_set_t thread_cpuset;
+  thread_pool.Schedule([&done, &thread_cpuset]() {
+    pthread_getaffinity_np(pthread_self(), sizeof(thread_cpuset), &thread_cpuset);
+    done = true;
+  });
+  while (!done) {
+    std::this_thread::yield();
+  }
+
+  ASSERT_EQ(1, CPU_COUNT(&thread_cpuset));
+  ASSERT_TRUE(CPU_ISSET(0, &thread_cpuset));
+}
+#endif
+
+TEST(ThreadPoolTest, TryParallelFor) {
+  ThreadPool thread_pool(4);
+
+  // not enough work to split, or no pool
+  EXPECT_EQ(1, ThreadPool::TaskCount(nullptr, 1000, int64_t{1} << 30));
+  EXPECT_LE(ThreadPool::TaskCount(&thread_pool, 1000, ThreadPool::kMinWorkPerTask), 1);
+  // limited by the degree of parallelism, the number of iterations and the work
+  EXPECT_EQ(4, ThreadPool::TaskCount(&thread_pool, 1000, int64_t{1} << 30));
+  EXPECT_EQ(3, ThreadPool::TaskCount(&thread_pool, 3, int64_t{1} << 30));
+  EXPECT_EQ(2, ThreadPool::TaskCount(&thread_pool, 1000, 2 * ThreadPool::kMinWorkPerTask));
+
+  for (ThreadPool* tp : {static_cast<ThreadPool*>(nullptr), &thread_pool}) {
+    for (int64_t total : {0, 1, 3, 1000}) {
+      for (int64_t total_work : {int64_t{0}, int64_t{1} << 30}) {
+        std::vector<std::atomic<int>> counts(static_cast<size_t>(total));
+        for (auto& count : counts) {
+          count = 0;
+        }
+        std::atomic<int> calls{0};
+
+        ThreadPool::TryParallelFor(tp, total, total_work, [&counts, &calls](int64_t begin, int64_t end) {
+          ++calls;
+          for (int64_t i = begin; i < end; ++i) {
+            ++counts[i];
+          }
+        });
+
+        EXPECT_EQ(std::max<int64_t>(1, ThreadPool::TaskCount(tp, total, total_work)), calls.load());
+        for (int64_t i = 0; i < total; ++i) {
+          ASSERT_EQ(1, counts[i]) << "iteration " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(ThreadPoolTest, DefaultDegreeOfParallelism) {
+  ThreadPool thread_pool;
+  ASSERT_GE(thread_pool.DegreeOfParallelism(), 1);
+}
+
+// ParallelFor must make progress when called from a pool thread while the other pool threads are busy
+TEST(ThreadPoolTest, NestedParallelFor) {
+  ThreadPool thread_pool(4);
+
+  std::atomic<int> count{0};
+  thread_pool.ParallelFor(8, [&thread_pool, &count](int32_t) {
+    thread_pool.ParallelFor(8, [&count](int32_t) { ++count; });
+  });
+
+  ASSERT_EQ(64, count);
+}
+
+TEST(ThreadPoolTest, Schedule) {
+  ThreadPool thread_pool(2);
+
+  std::atomic<bool> done{false};
+  thread_pool.Schedule([&done]() { done = true; });
+  while (!done) {
+    std::this_thread::yield();
+  }
+}
+
+}  // namespace test
+}  // namespace onnxruntime
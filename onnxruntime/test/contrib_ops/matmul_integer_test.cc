@@ -8,6 +8,8 @@
 #include "core/framework/op_kernel.h"
 #include "core/util/math_cpuonly.h"
 
+#include <vector>
+
 namespace onnxruntime {
 namespace test {
 
@@ -30,5 +32,66 @@ TEST(MatmulIntegerOpTest, MatMulInteger) {
   test.AddOutput<int32_t>("T3", {1, 1}, {-1});
   test.Run();
 }
+
+TEST(MatmulIntegerOpTest, MatMulIntegerInt8B) {
+  OpTester test("MatMulInteger", 1, onnxruntime::kMSDomain);
+  test.AddInput<uint8_t>("T1", {4, 3}, {11, 7, 3, 10, 6, 2, 9, 5, 1, 8, 4, 0});
+  test.AddInput<int8_t>("T2", {3, 2}, {-1, 4, 2, -5, 3, 6});
+  test.AddInput<uint8_t>("a_zero_point", {}, {12});
+  test.AddInput<int8_t>("b_zero_point", {}, {0});
+  test.AddOutput<int32_t>("T3", {4, 2}, {-36, -33, -40, -38, -44, -43, -48, -48});
+  test.Run();
+}
+
+// B and its zero point are initializers, so the kernel packs B once when it is created.
+TEST(MatmulIntegerOpTest, MatMulIntegerPrePackedB) {
+  OpTester test("MatMulInteger", 1, onnxruntime::kMSDomain);
+  test.AddInput<uint8_t>("T1", {4, 3}, {11, 7, 3, 10, 6, 2, 9, 5, 1, 8, 4, 0});
+  test.AddInput<uint8_t>("T2", {3, 2}, {1, 4, 2, 5, 3, 6}, true);
+  test.AddInput<uint8_t>("a_zero_point", {}, {12});
+  test.AddInput<uint8_t>("b_zero_point", {}, {0}, true);
+  test.AddOutput<int32_t>("T3", {4, 2}, {-38, -83, -44, -98, -50, -113, -56, -128});
+  test.Run();
+}
+
+// Spans several column panels and an odd K so that the padded edges of the packed buffers are used.
+TEST(MatmulIntegerOpTest, MatMulIntegerLarge) {
+  const int64_t M = 5;
+  const int64_t N = 37;
+  const int64_t K = 19;
+  const uint8_t a_zero_point = 3;
+  const int8_t b_zero_point = -2;
+
+  std::vector<uint8_t> a_data(M * K);
+  std::vector<int8_t> b_data(K * N);
+  std::vector<int32_t> y_data(M * N);
+
+  for (size_t i = 0; i < a_data.size(); i++) {
+    a_data[i] = static_cast<uint8_t>(i * 7 + 1);
+  }
+  for (size_t i = 0; i < b_data.size(); i++) {
+    b_data[i] = static_cast<int8_t>(i * 13 + 5);
+  }
+  for (int64_t m = 0; m < M; m++) {
+    for (int64_t n = 0; n < N; n++) {
+      int32_t sum = 0;
+      for (int64_t k = 0; k < K; k++) {
+        sum += (static_cast<int32_t>(a_data[m * K + k]) - a_zero_point) *
+               (static_cast<int32_t>(b_data[k * N + n]) - b_zero_point);
+      }
+      y_data[m * N + n] = sum;
+    }
+  }
+
+  for (bool is_initializer : {false, true}) {
+    OpTester test("MatMulInteger", 1, onnxruntime::kMSDomain);
+    test.AddInput<uint8_t>("T1", {M, K}, a_data);
+    test.AddInput<int8_t>("T2", {K, N}, b_data, is_initializer);
+    test.AddInput<uint8_t>("a_zero_point", {}, {a_zero_point});
+    test.AddInput<int8_t>("b_zero_point", {}, {b_zero_point}, is_initializer);
+    test.AddOutput<int32_t>("T3", {M, N}, y_data);
+    test.Run();
+  }
+}
 }  // namespace test
 }  // namespace onnxruntime
\ No newline at end of file
@@ -0,0 +1,217 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+#include "core/mlas/inc/mlas.h"
+
+namespace onnxruntime {
+namespace test {
+
+TEST(NchwcOpsTest, ReorderInput) {
+  // The NCHWc layout is not supported on this platform.
+  if (MlasNchwcGetBlockSize() <= 1) {
+    return;
+  }
+
+  const int64_t block_size = static_cast<int64_t>(MlasNchwcGetBlockSize());
+  const int64_t channels = 3;
+  const int64_t spatial_size = 4;
+
+  std::vector<float> input(channels * spatial_size);
+  for (size_t i = 0; i < input.size(); i++) {
+    input[i] = static_cast<float>(i + 1);
+  }
+
+  // The channels are padded with zeroes to the block size.
+  std::vector<float> expected_output(block_size * spatial_size, 0.0f);
+  for (int64_t c = 0; c < channels; c++) {
+    for (int64_t s = 0; s < spatial_size; s++) {
+      expected_output[s * block_size + c] = input[c * spatial_size + s];
+    }
+  }
+
+  OpTester test("ReorderInput", 1, onnxruntime::kMSNchwcDomain);
+  test.AddInput<float>("X", {1, channels, 2, 2}, input);
+  test.AddOutput<float>("Y", {1, block_size, 2, 2}, expected_output);
+  test.Run();
+}
+
+TEST(NchwcOpsTest, ReorderOutput) {
+  // The NCHWc layout is not supported on this platform.
+  if (MlasNchwcGetBlockSize() <= 1) {
+    return;
+  }
+
+  const int64_t block_size = static_cast<int64_t>(MlasNchwcGetBlockSize());
+  const int64_t channels = block_size + 5;
+  const int64_t padded_channels = block_size * 2;
+  const int64_t spatial_size = 3;
+
+  std::vector<float> input(padded_channels * spatial_size);
+  for (size_t i = 0; i < input.size(); i++) {
+    input[i] = static_cast<float>(i);
+  }
+
+  std::vector<float> expected_output(channels * spatial_size);
+  for (int64_t c = 0; c < channels; c++) {
+    for (int64_t s = 0; s < spatial_size; s++) {
+      const int64_t block = c / block_size;
+      expected_output[c * spatial_size + s] =
+          input[(block * spatial_size + s) * block_size + (c % block_size)];
+    }
+  }
+
+  OpTester test("ReorderOutput", 1, onnxruntime::kMSNchwcDomain);
+  test.AddAttribute("channels", channels);
+  test.AddInput<float>("X", {1, padded_channels, 1, spatial_size}, input);
+  test.AddOutput<float>("Y", {1, channels, 1, spatial_size}, expected_output);
+  test.Run();
+}
+
+TEST(NchwcOpsTest, GlobalAveragePool) {
+  // The NCHWc layout is not supported on this platform.
+  if (MlasNchwcGetBlockSize() <= 1) {
+    return;
+  }
+
+  const int64_t block_size = static_cast<int64_t>(MlasNchwcGetBlockSize());
+  const int64_t spatial_size = 2;
+
+  std::vector<float> input(block_size * spatial_size);
+  std::vector<float> expected_output(block_size);
+  for (int64_t c = 0; c < block_size; c++) {
+    input[c] = static_cast<float>(c);
+    input[block_size + c] = static_cast<float>(3 * c + 2);
+    expected_output[c] = static_cast<float>(2 * c + 1);
+  }
+
+  OpTester test("GlobalAveragePool", 1, onnxruntime::kMSNchwcDomain);
+  test.AddInput<float>("X", {1, block_size, 1, spatial_size}, input);
+  test.AddOutput<float>("Y", {1, block_size, 1, 1}, expected_output);
+  test.Run();
+}
+
+// Converts a NCHW tensor with a multiple of the block size channels to NCHWc.
+static std::vector<float> ReorderToNchwc(const std::vector<float>& input, int64_t channels, int64_t spatial_size) {
+  const int64_t block_size = static_cast<int64_t>(MlasNchwcGetBlockSize());
+  std::vector<float> output(input.size());
+  for (int64_t c = 0; c < channels; c++) {
+    for (int64_t s = 0; s < spatial_size; s++) {
+      output[((c / block_size) * spatial_size + s) * block_size + (c % block_size)] = input[c * spatial_size + s];
+    }
+  }
+  return output;
+}
+
+// Runs a 3x3 convolution with the optional fused Sum input and activation
+// against a direct NCHW computation. The values are small integers, so the
+// results are exact.
+static void TestNchwcConv(bool use_sum, const std::string& activation) {
+  const int64_t block_size = static_cast<int64_t>(MlasNchwcGetBlockSize());
+  const int64_t input_channels = block_size * 2;
+  const int64_t output_channels = block_size * 2;
+  const int64_t height = 5;
+  const int64_t width = 5;
+  const int64_t spatial_size = height * width;
+  const int64_t kernel_size = 3;
+
+  std::vector<float> input(input_channels * spatial_size);
+  for (size_t i = 0; i < input.size(); i++) {
+    input[i] = static_cast<float>(static_cast<int>(i % 7) - 3);
+  }
+  std::vector<int64_t> filter_shape{output_channels, input_channels, kernel_size, kernel_size};
+  std::vector<float> filter(output_channels * input_channels * kernel_size * kernel_size);
+  for (size_t i = 0; i < filter.size(); i++) {
+    filter[i] = static_cast<float>(static_cast<int>(i % 5) - 2);
+  }
+  std::vector<float> bias(output_channels);
+  for (size_t i = 0; i < bias.size(); i++) {
+    bias[i] = static_cast<float>(static_cast<int>(i % 3) - 1);
+  }
+  std::vector<float> sum(output_channels * spatial_size);
+  for (size_t i = 0; i < sum.size(); i++) {
+    sum[i] = static_cast<float>(static_cast<int>(i % 11) - 5);
+  }
+
+  // The output has the same spatial size as the input with a padding of 1.
+  std::vector<float> expected_output(output_channels * spatial_size);
+  for (int64_t oc = 0; oc < output_channels; oc++) {
+    for (int64_t oh = 0; oh < height; oh++) {
+      for (int64_t ow = 0; ow < width; ow++) {
+        float value = bias[oc];
+        for (int64_t ic = 0; ic < input_channels; ic++) {
+          for (int64_t kh = 0; kh < kernel_size; kh++) {
+            for (int64_t kw = 0; kw < kernel_size; kw++) {
+              const int64_t ih = oh + kh - 1;
+              const int64_t iw = ow + kw - 1;
+              if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
+                value += input[(ic * height + ih) * width + iw] *
+                         filter[((oc * input_channels + ic) * kernel_size + kh) * kernel_size + kw];
+              }
+            }
+          }
+        }
+        const int64_t index = (oc * height + oh) * width + ow;
+        if (use_sum) {
+          value += sum[index];
+        }
+        if (activation == "Relu") {
+          value = std::max(value, 0.0f);
+        }
+        expected_output[index] = value;
+      }
+    }
+  }
+
+  std::vector<float> nchwc_filter(filter.size());
+  MlasReorderFilterOIHWBiBo(filter_shape.data(), filter.data(), nchwc_filter.data());
+
+  OpTester test("Conv", 1, onnxruntime::kMSNchwcDomain);
+  test.AddAttribute("kernel_shape", std::vector<int64_t>{kernel_size, kernel_size});
+  test.AddAttribute("pads", std::vector<int64_t>{1, 1, 1, 1});
+  if (!activation.empty()) {
+    test.AddAttribute("activation", activation);
+  }
+  test.AddInput<float>("X", {1, input_channels, height, width}, ReorderToNchwc(input, input_channels, spatial_size));
+  test.AddInput<float>("W", filter_shape, nchwc_filter);
+  test.AddInput<float>("B", {output_channels}, bias);
+  if (use_sum) {
+    test.AddInput<float>("Sum", {1, output_channels, height, width}, ReorderToNchwc(sum, output_channels, spatial_size));
+  }
+  test.AddOutput<float>("Y", {1, output_channels, height, width},
+                        ReorderToNchwc(expected_output, output_channels, spatial_size));
+  test.Run();
+}
+
+TEST(NchwcOpsTest, ConvSum) {
+  // The NCHWc layout is not supported on this platform.
+  if (MlasNchwcGetBlockSize() <= 1) {
+    return;
+  }
+
+  TestNchwcConv(true, "");
+}
+
+TEST(NchwcOpsTest, ConvRelu) {
+  // The NCHWc layout is not supported on this platform.
+  if (MlasNchwcGetBlockSize() <= 1) {
+    return;
+  }
+
+  TestNchwcConv(false, "Relu");
+}
+
+TEST(NchwcOpsTest, ConvSumRelu) {
+  // The NCHWc layout is not supported on this platform.
+  if (MlasNchwcGetBlockSize() <= 1) {
+    return;
+  }
+
+  TestNchwcConv(true, "Relu");
+}
+
+}  // namespace test
+}  // namespace onnxruntime
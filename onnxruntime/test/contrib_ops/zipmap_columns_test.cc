@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+
+namespace onnxruntime {
+namespace test {
+
+TEST(ContribOpTest, ZipMapColumns_Strings) {
+  OpTester test("ZipMapColumns", 1, onnxruntime::kMSDomain);
+  std::vector<std::string> classes{"class1", "class2", "class3"};
+  std::vector<float> input{1.f, 0.f, 3.f, 44.f, 23.f, 11.3f};
+  test.AddAttribute("classlabels_strings", classes);
+  test.AddInput<float>("X", {2, 3}, input);
+  test.AddOutput<float>("Y", {2, 3}, input);
+  test.AddOutput<std::string>("Z", {3}, classes);
+  test.Run();
+}
+
+TEST(ContribOpTest, ZipMapColumns_Int64s1D) {
+  OpTester test("ZipMapColumns", 1, onnxruntime::kMSDomain);
+  std::vector<int64_t> classes{10, 20, 30};
+  std::vector<float> input{0.25f, 0.5f, 0.25f};
+  test.AddAttribute("classlabels_int64s", classes);
+  test.AddInput<float>("X", {3}, input);
+  test.AddOutput<float>("Y", {1, 3}, input);
+  test.AddOutput<int64_t>("Z", {3}, classes);
+  test.Run();
+}
+
+TEST(ContribOpTest, ZipMapColumns_ClassCountMismatch) {
+  OpTester test("ZipMapColumns", 1, onnxruntime::kMSDomain);
+  std::vector<int64_t> classes{10, 20, 30};
+  std::vector<float> input{0.5f, 0.5f, 0.25f, 0.75f};
+  test.AddAttribute("classlabels_int64s", classes);
+  test.AddInput<float>("X", {2, 2}, input);
+  test.AddOutput<float>("Y", {2, 2}, input);
+  test.AddOutput<int64_t>("Z", {3}, classes);
+  test.Run(OpTester::ExpectResult::kExpectFailure);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -266,6 +266,22 @@ class PlannerTest : public ::testing::Test {
     EXPECT_EQ(plan_result, expected) << "Freed items incorrect for step " << step_number;
   }
 
+  void CheckReusedBuffer(const std::string& name, const std::string& reused_name) {
+    int id, reused_id;
+    index(name, id);
+    index(reused_name, reused_id);
+    EXPECT_EQ(plan_->allocation_plan[id].reused_buffer, reused_id) << "Error in reused buffer for " << name;
+  }
+
+  AllocationPlanMemoryStats ComputeMemoryStats(const std::unordered_map<std::string, int64_t>& symbolic_dims) {
+    AllocationPlanMemoryStats stats;
+    SequentialPlannerTestContext test_context(&shape_map_);
+    auto status = SequentialPlanner::ComputeMemoryStats(*plan_, GraphViewer(graph_), state_.GetMLValueNameIdxMap(),
+                                                        test_context, symbolic_dims, stats);
+    EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+    return stats;
+  }
+
  protected:
   Graph& GetGraph() { return graph_; }
   const SequentialExecutionPlan& GetPlan() const { return *plan_; }
@@ -413,6 +429,96 @@ TEST_F(PlannerTest, InPlaceSizeMismatchTest) {
   CheckFreed(3, {X2});
 }
 
+// BestFitReuseTest: Check that a freed buffer larger than needed is reused, picking the one that wastes the least.
+TEST_F(PlannerTest, BestFitReuseTest) {
+  // tensor variables:
+  std::string X1("X1"), X2("X2"), X3("X3"), X4("X4"), X5("X5"), X6("X6");
+
+  // graph structure:
+  AddNormalNode(X1, X2);  // X1: input; X2: temporary
+  AddNormalNode(X2, X3);  // X3: temporary, larger than X2
+  AddNormalNode(X3, X4);  // X4: temporary, larger than both X2 and X3
+  AddNormalNode(X4, X5);  // X5: temporary, smaller than both X2 and X3
+  AddNormalNode(X5, X6);  // X6: output
+
+  // simulate shape-inference results:
+  Shape shape4{4}, shape8{8}, shape16{16}, shape32{32};
+  SetShape({{X1, &shape4.value}, {X2, &shape8.value}, {X3, &shape16.value}, {X4, &shape32.value},
+            {X5, &shape4.value}, {X6, &shape4.value}});
+
+  CreatePlan();
+
+  CheckAllocKind(X2, AllocKind::kAllocate);
+  CheckAllocKind(X3, AllocKind::kAllocate);
+  CheckAllocKind(X4, AllocKind::kAllocate);
+  CheckAllocKind(X5, AllocKind::kReuse);
+  CheckReusedBuffer(X5, X2);
+  CheckAllocKind(X6, AllocKind::kAllocateOutput);
+
+  CheckFreed(0, {});
+  CheckFreed(1, {});
+  CheckFreed(2, {X3});
+  CheckFreed(3, {X4});
+  CheckFreed(4, {X2});
+}
+
+static TensorShapeProto MakeShape(std::initializer_list<std::string> symbolic_dims, int64_t known_dim) {
+  TensorShapeProto shape;
+  for (auto& dim : symbolic_dims) {
+    shape.add_dim()->set_dim_param(dim);
+  }
+  shape.add_dim()->set_dim_value(known_dim);
+  return shape;
+}
+
+// SymbolicReuseTest: Check that buffers with statically unknown sizes are reused if the dim_params match.
+TEST_F(PlannerTest, SymbolicReuseTest) {
+  // tensor variables:
+  std::string X1("X1"), X2("X2"), X3("X3"), X4("X4"), X5("X5"), X6("X6");
+
+  // graph structure:
+  AddNormalNode(X1, X2);  // X1: input; X2: temporary
+  AddNormalNode(X2, X3);  // X3: temporary
+  AddNormalNode(X3, X4);  // X4: temporary, can reuse X2 as it has the same dim_params and is smaller
+  AddNormalNode(X4, X5);  // X5: temporary, can't reuse X3 as it has a different dim_param
+  AddNormalNode(X5, X6);  // X6: output
+
+  // simulate shape-inference results:
+  auto shape1 = MakeShape({"batch"}, 512);
+  auto shape2 = MakeShape({"batch"}, 1024);
+  auto shape3 = MakeShape({"batch"}, 256);
+  auto shape4 = MakeShape({"seq"}, 128);
+  SetShape({{X1, &shape1}, {X2, &shape1}, {X3, &shape2}, {X4, &shape3}, {X5, &shape4}, {X6, &shape4}});
+
+  CreatePlan();
+
+  CheckAllocKind(X2, AllocKind::kAllocate);
+  CheckAllocKind(X3, AllocKind::kAllocate);
+  CheckAllocKind(X4, AllocKind::kReuse);
+  CheckReusedBuffer(X4, X2);
+  CheckAllocKind(X5, AllocKind::kAllocate);
+  CheckAllocKind(X6, AllocKind::kAllocateOutput);
+
+  CheckFreed(0, {});
+  CheckFreed(1, {});
+  CheckFreed(2, {X3});
+  CheckFreed(3, {X2});
+  CheckFreed(4, {X5});
+
+  // X2 4096 bytes, X3 8192, X4 2048 (reuses X2), X5 1536, X6 1536.
+  // the peak is after X3 is allocated in step 1, while X2 is alive for X4 to reuse it.
+  auto stats = ComputeMemoryStats({{"batch", 2}, {"seq", 3}});
+  EXPECT_EQ(stats.naive_peak_bytes, 17408u);
+  EXPECT_EQ(stats.planned_peak_bytes, 12288u);
+  EXPECT_EQ(stats.num_unknown_size_values, 0u);
+
+  // values with an unknown dim_param are left out
+  stats = ComputeMemoryStats({{"batch", 2}});
+  EXPECT_EQ(stats.naive_peak_bytes, 14336u);
+  EXPECT_EQ(stats.planned_peak_bytes, 12288u);
+  EXPECT_EQ(stats.num_unknown_size_values, 2u);
+}
+
 // Test operator<< to output details of an allocation & execution plan.
 TEST_F(PlannerTest, PlanOutputTest) {
   // tensor variables:
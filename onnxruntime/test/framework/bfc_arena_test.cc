@@ -4,6 +4,9 @@
 #include "core/framework/bfc_arena.h"
 #include "gtest/gtest.h"
 #include <cstdlib>
+#include <cstring>
+#include <future>
+#include <thread>
 
 namespace onnxruntime {
 namespace test {
@@ -234,5 +237,104 @@ TEST(BFCArenaTest, TestReserve) {
   a.GetStats(&stats);
   EXPECT_EQ(stats.total_allocated_bytes, 1048576);
 }
+
+TEST(BFCArenaTest, ThreadCacheReusesChunks) {
+  BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30, true);
+
+  // the first allocation refills the cache from the arena, the rest are served by the cache
+  void* first_ptr = a.Alloc(1000);
+  a.Free(first_ptr);
+  void* second_ptr = a.Alloc(1000);
+  EXPECT_EQ(first_ptr, second_ptr);
+  // 1000 bytes is rounded up to the 1024 byte size class
+  EXPECT_EQ(1024, a.AllocatedSize(second_ptr));
+  a.Free(second_ptr);
+
+  // too large for the thread cache
+  void* large_ptr = a.Alloc(1 << 20);
+  a.Free(large_ptr);
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_cache_hits, 1);
+  EXPECT_EQ(stats.num_cache_misses, 1);
+}
+
+TEST(BFCArenaTest, ThreadCacheMultipleThreads) {
+  BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30, true);
+
+  const int num_threads = 8;
+  const int num_iterations = 1000;
+  std::vector<std::vector<void*>> leftovers(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&a, &leftovers, t]() {
+      std::vector<void*> ptrs;
+      for (int i = 0; i < num_iterations; ++i) {
+        size_t size = 64 + (i * 97 + t * 31) % 8000;
+        auto* p = static_cast<unsigned char*>(a.Alloc(size));
+        ASSERT_NE(p, nullptr);
+        // the chunk must not be shared with another live allocation
+        std::memset(p, t, size);
+        ptrs.push_back(p);
+        if (ptrs.size() > 16) {
+          auto* oldest = static_cast<unsigned char*>(ptrs.front());
+          ASSERT_EQ(oldest[0], t);
+          a.Free(oldest);
+          ptrs.erase(ptrs.begin());
+        }
+      }
+
+      // leave some allocations to be freed by another thread after this one exits
+      leftovers[t] = std::move(ptrs);
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (auto& ptrs : leftovers) {
+    for (void* p : ptrs) {
+      a.Free(p);
+    }
+  }
+
+  // the caches of the exited threads were returned to the arena
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_GT(stats.num_cache_hits, 0);
+}
+
+// a chunk freed by another thread while the owning thread is alive goes back to the owning thread's cache
+TEST(BFCArenaTest, ThreadCacheRemoteFree) {
+  BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30, true);
+
+  std::promise<void*> allocated;
+  std::promise<void> freed;
+  auto freed_future = freed.get_future();
+  std::thread owner([&a, &allocated, &freed_future]() {
+    allocated.set_value(a.Alloc(1000));
+    freed_future.wait();
+
+    // take all the chunks of the size class from the cache, including the one freed by the other thread
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 64; ++i) {
+      ptrs.push_back(a.Alloc(1000));
+    }
+    for (void* p : ptrs) {
+      a.Free(p);
+    }
+  });
+
+  a.Free(allocated.get_future().get());
+  freed.set_value();
+  owner.join();
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -104,6 +104,20 @@ TEST(ExecutionFrameTest, TensorAllocationTest) {
   EXPECT_TRUE(tensor2);
   EXPECT_EQ(tensor2->Shape(), shape2);
   EXPECT_EQ(tensor2->template Data<float>(), p_tensor->template Data<float>());
+
+  // a reused buffer that is too small for the actual shape is not used
+  TensorShape shape3(std::vector<int64_t>{4, 3});
+  MLValue& mlvalue2 = *frame.GetMutableNodeInputOrOutputMLValue(start_index + 1);
+  status = frame.AllocateMLValueTensorPreAllocateBuffer(mlvalue2,
+                                                        start_index,
+                                                        DataTypeImpl::GetType<float>(),
+                                                        p_tensor->Location(),
+                                                        shape3);
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  auto tensor3 = &(frame.GetNodeInputOrOutputMLValue(1)->Get<Tensor>());
+  EXPECT_EQ(tensor3->Shape(), shape3);
+  EXPECT_NE(tensor3->template Data<float>(), p_tensor->template Data<float>());
 }
 
 TEST(ExecutionFrameTest, FeedInDataTest) {
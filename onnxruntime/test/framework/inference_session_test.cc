@@ -4,13 +4,16 @@
 #include "core/session/inference_session.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cfloat>
+#include <cstdio>
 #include <functional>
 #include <iterator>
 #include <thread>
 #include <fstream>
 
 #include <google/protobuf/io/zero_copy_stream_impl.h>
+#include "gsl/gsl_util"
 #include "core/common/logging/logging.h"
 #include "core/common/profiler.h"
 #include "core/framework/compute_capability.h"
@@ -18,14 +21,17 @@
 #include "core/framework/kernel_registry.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/session_state.h"
+#include "core/framework/shared_initializers.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/model.h"
 #include "core/graph/op.h"
 #include "core/platform/env.h"
+#include "core/platform/ort_mutex.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/providers/cpu/math/element_wise_ops.h"
 #include "core/session/IOBinding.h"
+#include "core/session/prepared_run.h"
 #include "dummy_provider.h"
 #include "test_utils.h"
 #include "test/capturing_sink.h"
@@ -322,6 +328,138 @@ TEST(InferenceSessionTests, NoTimeout) {
   RunModel(session_object, run_options);
 }
 
+TEST(InferenceSessionTests, SessionIntraOpThreadPool) {
+  for (const std::vector<size_t>& affinity : {std::vector<size_t>{}, std::vector<size_t>{0}}) {
+    SessionOptions so;
+
+    so.session_logid = "InferenceSessionTests.SessionIntraOpThreadPool";
+    so.intra_op_num_threads = affinity.empty() ? 2 : 0;
+    so.intra_op_thread_affinity = affinity;
+
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    RunOptions run_options;
+    run_options.run_tag = so.session_logid;
+    RunModel(session_object, run_options);
+  }
+}
+
+TEST(InferenceSessionTests, MemoryPatternCacheStats) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.MemoryPatternCacheStats";
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  run_options.run_tag = so.session_logid;
+  for (int i = 0; i < 3; ++i) {
+    RunModel(session_object, run_options);
+  }
+
+  // the first run creates the pattern and the others reuse it
+  auto stats = session_object.GetMemoryPatternCacheStats();
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.evictions, 0u);
+  EXPECT_EQ(stats.size, 1u);
+}
+
+// exposes the SessionState so the initialized tensors of different sessions can be compared
+class InferenceSessionWithSessionState : public InferenceSession {
+ public:
+  using InferenceSession::InferenceSession;
+  const SessionState& GetSessionState() const { return session_state_; }
+};
+
+static const void* GetInitializerData(const InferenceSessionWithSessionState& session, int mlvalue_index) {
+  const auto& initialized_tensors = session.GetSessionState().GetInitializedTensors();
+  auto it = initialized_tensors.find(mlvalue_index);
+  return it != initialized_tensors.end() ? it->second.Get<Tensor>().DataRaw() : nullptr;
+}
+
+TEST(InferenceSessionTests, SharedInitializers) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.SharedInitializers";
+  so.enable_shared_initializers = true;
+
+  SharedInitializerStore& store = SharedInitializerStore::Instance();
+  const size_t initial_store_size = store.Size();
+
+  auto session_1 = std::make_unique<InferenceSessionWithSessionState>(so, &DefaultLoggingManager());
+  ASSERT_TRUE(session_1->Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_1->Initialize().IsOK());
+  auto session_2 = std::make_unique<InferenceSessionWithSessionState>(so, &DefaultLoggingManager());
+  ASSERT_TRUE(session_2->Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_2->Initialize().IsOK());
+
+  SessionOptions not_shared_so;
+  not_shared_so.session_logid = "InferenceSessionTests.SharedInitializers.NotShared";
+  InferenceSessionWithSessionState not_shared_session{not_shared_so, &DefaultLoggingManager()};
+  ASSERT_TRUE(not_shared_session.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(not_shared_session.Initialize().IsOK());
+
+  const auto& initialized_tensors = session_1->GetSessionState().GetInitializedTensors();
+  ASSERT_FALSE(initialized_tensors.empty());
+  EXPECT_EQ(initial_store_size + initialized_tensors.size(), store.Size());
+  for (const auto& entry : initialized_tensors) {
+    const void* data = entry.second.Get<Tensor>().DataRaw();
+    EXPECT_EQ(data, GetInitializerData(*session_2, entry.first));
+    EXPECT_NE(data, GetInitializerData(not_shared_session, entry.first));
+  }
+
+  // the initializers stay alive as long as a session uses them
+  RunOptions run_options;
+  run_options.run_tag = so.session_logid;
+  session_1.reset();
+  RunModel(*session_2, run_options);
+
+  session_2.reset();
+  EXPECT_EQ(initial_store_size, store.Size());
+}
+
+// a session doesn't get the shared initializers of a model file that has been replaced since they were loaded
+TEST(InferenceSessionTests, SharedInitializersModelFileChanged) {
+  const std::string model_path = "shared_initializers_model_file_changed.onnx";
+  std::shared_ptr<Model> model;
+  ASSERT_TRUE(Model::Load(MODEL_URI, model).IsOK());
+  Graph& graph = model->MainGraph();
+  const ONNX_NAMESPACE::TensorProto* weights = nullptr;
+  ASSERT_TRUE(graph.GetInitializedTensor("W", weights));
+  ONNX_NAMESPACE::TensorProto changed_weights(*weights);
+  ASSERT_TRUE(Model::Save(*model, model_path).IsOK());
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.SharedInitializersModelFileChanged";
+  so.enable_shared_initializers = true;
+
+  InferenceSessionWithSessionState session_1{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_1.Load(model_path).IsOK());
+  ASSERT_TRUE(session_1.Initialize().IsOK());
+
+  // same type and shape, different data
+  changed_weights.set_float_data(0, 42.f);
+  graph.RemoveInitializedTensor("W");
+  graph.AddInitializedTensor(changed_weights);
+  ASSERT_TRUE(Model::Save(*model, model_path).IsOK());
+
+  InferenceSessionWithSessionState session_2{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_2.Load(model_path).IsOK());
+  ASSERT_TRUE(session_2.Initialize().IsOK());
+  std::remove(model_path.c_str());
+
+  const auto& initialized_tensors = session_1.GetSessionState().GetInitializedTensors();
+  ASSERT_EQ(initialized_tensors.size(), 1u);
+  const int mlvalue_index = initialized_tensors.begin()->first;
+  EXPECT_NE(initialized_tensors.begin()->second.Get<Tensor>().DataRaw(),
+            GetInitializerData(session_2, mlvalue_index));
+  EXPECT_EQ(static_cast<const float*>(GetInitializerData(session_2, mlvalue_index))[0], 42.f);
+}
+
 TEST(InferenceSessionTests, DisableCPUArena) {
   SessionOptions so;
 
@@ -337,6 +475,21 @@ TEST(InferenceSessionTests, DisableCPUArena) {
   RunModel(session_object, run_options);
 }
 
+TEST(InferenceSessionTests, EnableCPUArenaThreadCache) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.EnableCPUArenaThreadCache";
+  so.enable_cpu_mem_arena_thread_cache = true;
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  run_options.run_tag = "one session/one tag";
+  RunModel(session_object, run_options);
+}
+
 #ifdef ORT_RUN_EXTERNAL_ONNX_TESTS
 static bool Compare(const InputDefList& f_arg, const InputDefList& s_arg) {
   if (f_arg.size() != s_arg.size()) {
@@ -564,6 +717,99 @@ TEST(InferenceSessionTests, MultipleSessionsNoTimeout) {
   thread2.join();
 }
 
+TEST(InferenceSessionTests, RunAsync) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.RunAsync";
+  so.inter_op_num_threads = 2;
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  std::vector<int64_t> dims_mul_x = {3, 2};
+  std::vector<float> values_mul_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  MLValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_mul_x, values_mul_x,
+                       &ml_value);
+
+  const std::vector<int64_t> expected_dims_mul_y = {3, 2};
+  const std::vector<float> expected_values_mul_y = {1.0f, 4.0f, 9.0f, 16.0f, 25.0f, 36.0f};
+
+  // more requests than threads, so some of them are queued
+  constexpr int num_requests = 8;
+  RunOptions run_options;
+  OrtMutex mutex;
+  OrtCondVar cv;
+  int num_completed = 0;
+  std::vector<Status> statuses(num_requests);
+  std::vector<std::vector<MLValue>> results(num_requests);
+  std::vector<RunAsyncInfo> infos(num_requests);
+
+  for (int i = 0; i < num_requests; ++i) {
+    auto callback = [&, i](const Status& status, std::vector<MLValue>& fetches, const RunAsyncInfo& info) {
+      std::lock_guard<OrtMutex> l(mutex);
+      statuses[i] = status;
+      results[i] = fetches;
+      infos[i] = info;
+      ++num_completed;
+      cv.notify_all();
+    };
+    ASSERT_TRUE(session_object.RunAsync(run_options, {"X"}, {ml_value}, {"Y"}, callback).IsOK());
+  }
+
+  {
+    std::unique_lock<OrtMutex> l(mutex);
+    while (num_completed < num_requests) {
+      cv.wait(l);
+    }
+  }
+
+  for (int i = 0; i < num_requests; ++i) {
+    ASSERT_TRUE(statuses[i].IsOK()) << statuses[i].ErrorMessage();
+    VerifyOutputs(results[i], expected_dims_mul_y, expected_values_mul_y);
+    ASSERT_GE(infos[i].queue_time_in_us, 0);
+    ASSERT_GE(infos[i].run_time_in_us, 0);
+  }
+
+  // the count is decremented after the callback returns
+  while (session_object.GetNumPendingAsyncRuns() > 0) {
+    std::this_thread::yield();
+  }
+}
+
+TEST(InferenceSessionTests, RunAsyncCancelled) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.RunAsyncCancelled";
+  so.inter_op_num_threads = 1;
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  MLValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {3, 2},
+                       {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f}, &ml_value);
+
+  RunOptions run_options;
+  run_options.terminate = true;
+  std::atomic<bool> done{false};
+  Status result;
+  auto callback = [&](const Status& status, std::vector<MLValue>& fetches, const RunAsyncInfo&) {
+    // set done on every path out of the callback so a failed check can't leave the wait below spinning
+    auto set_done = gsl::finally([&done]() { done = true; });
+    result = status;
+    EXPECT_TRUE(fetches.empty());
+  };
+  ASSERT_TRUE(session_object.RunAsync(run_options, {"X"}, {ml_value}, {"Y"}, callback).IsOK());
+  while (!done) {
+    std::this_thread::yield();
+  }
+  ASSERT_FALSE(result.IsOK());
+
+  // an empty callback is rejected
+  ASSERT_FALSE(session_object.RunAsync(run_options, {"X"}, {ml_value}, {"Y"}, nullptr).IsOK());
+
+  // the destructor waits for the request to be completely finished
+}
+
 TEST(InferenceSessionTests, PreAllocateOutputVector) {
   SessionOptions so;
 
@@ -579,6 +825,175 @@ TEST(InferenceSessionTests, PreAllocateOutputVector) {
   RunModel(session_object, run_options, is_preallocate_output_vec);
 }
 
+// X -> num_branches chains of (Add(X, X) -> Relu -> Relu) -> Sum -> Y, so Y = 2 * num_branches * X
+static void CreateWideModel(const std::string& model_file_name, int num_branches) {
+  onnxruntime::Model model("wide_graph");
+  auto& graph = model.MainGraph();
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  auto& input_arg = graph.GetOrCreateNodeArg("X", &float_tensor);
+  std::vector<onnxruntime::NodeArg*> sum_inputs;
+  for (int i = 0; i < num_branches; ++i) {
+    const std::string prefix = "branch_" + std::to_string(i);
+    auto& add_out = graph.GetOrCreateNodeArg(prefix + "_add", &float_tensor);
+    auto& relu_out_1 = graph.GetOrCreateNodeArg(prefix + "_relu_1", &float_tensor);
+    auto& relu_out_2 = graph.GetOrCreateNodeArg(prefix + "_relu_2", &float_tensor);
+    graph.AddNode(prefix + "_add", "Add", "", {&input_arg, &input_arg}, {&add_out});
+    graph.AddNode(prefix + "_relu_1", "Relu", "", {&add_out}, {&relu_out_1});
+    graph.AddNode(prefix + "_relu_2", "Relu", "", {&relu_out_1}, {&relu_out_2});
+    sum_inputs.push_back(&relu_out_2);
+  }
+
+  auto& output_arg = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  graph.AddNode("sum", "Sum", "", sum_inputs, {&output_arg});
+
+  auto status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  status = onnxruntime::Model::Save(model, model_file_name);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+}
+
+TEST(InferenceSessionTests, TestParallelExecutionWideGraph) {
+  const int num_branches = 16;
+  const std::string model_file_name = "inference_session_test_wide_graph.onnx";
+  CreateWideModel(model_file_name, num_branches);
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.TestParallelExecutionWideGraph";
+  so.enable_sequential_execution = false;
+  so.session_thread_pool_size = 4;
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(model_file_name).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  std::vector<int64_t> dims_x = {3, 2};
+  std::vector<float> values_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  MLValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_x, values_x, &ml_value);
+  NameMLValMap feeds;
+  feeds.insert(std::make_pair("X", ml_value));
+
+  std::vector<float> expected_values_y;
+  for (auto value : values_x) {
+    expected_values_y.push_back(2.0f * num_branches * value);
+  }
+
+  // run from multiple threads so the executors of concurrent Run calls share the session thread pool
+  auto run = [&]() {
+    for (int i = 0; i < 10; ++i) {
+      RunOptions run_options;
+      run_options.run_tag = so.session_logid;
+      std::vector<MLValue> fetches;
+      auto st = session_object.Run(run_options, feeds, {"Y"}, &fetches);
+      ASSERT_TRUE(st.IsOK()) << st.ErrorMessage();
+      VerifyOutputs(fetches, dims_x, expected_values_y);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back(run);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+TEST(InferenceSessionTests, TestPreparedRun) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.TestPreparedRun";
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  std::unique_ptr<PreparedRun> prepared_run;
+  Status st = session_object.PrepareRun({"X"}, {"Y"}, &prepared_run);
+  ASSERT_TRUE(st.IsOK()) << st.ErrorMessage();
+
+  std::vector<int64_t> dims_mul_x = {3, 2};
+  std::vector<float> values_mul_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  MLValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_mul_x, values_mul_x,
+                       &ml_value);
+
+  std::vector<int64_t> expected_dims_mul_y = {3, 2};
+  std::vector<float> expected_values_mul_y = {1.0f, 4.0f, 9.0f, 16.0f, 25.0f, 36.0f};
+
+  // the first run caches the device copy info and the second uses it
+  RunOptions run_options;
+  for (int i = 0; i < 2; ++i) {
+    std::vector<MLValue> fetches;
+    st = session_object.Run(run_options, *prepared_run, {ml_value}, &fetches);
+    ASSERT_TRUE(st.IsOK()) << st.ErrorMessage();
+    VerifyOutputs(fetches, expected_dims_mul_y, expected_values_mul_y);
+  }
+
+  // concurrent runs with the same handle
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+      RunOptions thread_run_options;
+      std::vector<MLValue> fetches;
+      Status thread_status = session_object.Run(thread_run_options, *prepared_run, {ml_value}, &fetches);
+      ASSERT_TRUE(thread_status.IsOK()) << thread_status.ErrorMessage();
+      VerifyOutputs(fetches, expected_dims_mul_y, expected_values_mul_y);
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(InferenceSessionTests, TestPreparedRunInvalidArgs) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.TestPreparedRunInvalidArgs";
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+
+  std::unique_ptr<PreparedRun> prepared_run;
+  ASSERT_FALSE(session_object.PrepareRun({"X"}, {"Y"}, &prepared_run).IsOK());  // not initialized
+
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+  ASSERT_FALSE(session_object.PrepareRun({"Z"}, {"Y"}, &prepared_run).IsOK());  // invalid input name
+  ASSERT_FALSE(session_object.PrepareRun({}, {"Y"}, &prepared_run).IsOK());     // missing required input
+  ASSERT_FALSE(session_object.PrepareRun({"X"}, {"Z"}, &prepared_run).IsOK());  // invalid output name
+  ASSERT_TRUE(session_object.PrepareRun({"X"}, {"Y"}, &prepared_run).IsOK());
+
+  // wrong element type
+  MLValue ml_value;
+  CreateMLValue<int64_t>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {3, 2}, {1, 2, 3, 4, 5, 6},
+                         &ml_value);
+  RunOptions run_options;
+  std::vector<MLValue> fetches;
+  ASSERT_FALSE(session_object.Run(run_options, *prepared_run, {ml_value}, &fetches).IsOK());
+
+  // wrong number of feeds
+  ASSERT_FALSE(session_object.Run(run_options, *prepared_run, {}, &fetches).IsOK());
+
+  // handle created by another session of the same model
+  InferenceSession other_session{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(other_session.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(other_session.Initialize().IsOK());
+  std::unique_ptr<PreparedRun> other_prepared_run;
+  ASSERT_TRUE(other_session.PrepareRun({"X"}, {"Y"}, &other_prepared_run).IsOK());
+
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {3, 2},
+                       {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f}, &ml_value);
+  Status st = session_object.Run(run_options, *other_prepared_run, {ml_value}, &fetches);
+  ASSERT_EQ(common::INVALID_ARGUMENT, st.Code()) << st.ErrorMessage();
+  ASSERT_TRUE(other_session.Run(run_options, *other_prepared_run, {ml_value}, &fetches).IsOK());
+}
+
 TEST(InferenceSessionTests, ConfigureVerbosityLevel) {
   SessionOptions so;
 
@@ -34,5 +34,29 @@ TEST(MemPatternPlannerTest, TraceAllocaitonTest) {
   EXPECT_EQ(pattern.GetBlock(5)->offset_, 1024 + 256 + 512);
   EXPECT_EQ(pattern.GetBlock(6)->offset_, 1024);
 }
+
+TEST(MemPatternPlannerTest, ReplanTest) {
+  MemPatternPlanner planner;
+  planner.TraceAllocation(0, 256);
+  planner.TraceAllocation(1, 512);
+  planner.TraceFree(0);
+  planner.TraceAllocation(2, 128);
+
+  auto pattern = planner.GenerateMemPattern();
+  EXPECT_EQ(pattern.PeakSize(), 256 + 512);
+  EXPECT_EQ(pattern.GetBlock(2)->offset_, 0);
+
+  // growing a value keeps the order of the allocations and frees but moves blocks that no longer fit
+  auto replanned = MemPatternPlanner::Replan(pattern, {{0, 1024}, {2, 2048}});
+  EXPECT_EQ(replanned.PeakSize(), 1024 + 512 + 2048);
+  EXPECT_EQ(replanned.GetBlock(0)->size_, 1024);
+  EXPECT_EQ(replanned.GetBlock(1)->offset_, 1024);
+  EXPECT_EQ(replanned.GetBlock(2)->offset_, 1024 + 512);
+
+  // sizes are never shrunk
+  replanned = MemPatternPlanner::Replan(pattern, {{1, 8}});
+  EXPECT_EQ(replanned.PeakSize(), pattern.PeakSize());
+  EXPECT_EQ(replanned.GetBlock(1)->size_, 512);
+}
 }  // namespace test
 }  // namespace onnxruntime
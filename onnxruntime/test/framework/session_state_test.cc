@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include "core/framework/execution_providers.h"
+#include "core/framework/mem_pattern.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/session_state.h"
 #include "core/graph/graph_viewer.h"
@@ -70,5 +71,59 @@ TEST(SessionStateTest, AddGetKernelTest) {
   std::cout << "orig: " << orig_num_outputs << " new: " << test_kernel->Node().OutputDefs().size() << std::endl;
   EXPECT_EQ(orig_num_outputs, test_kernel->Node().OutputDefs().size());
 }
+
+TEST(SessionStateTest, MemoryPatternCacheEviction) {
+  ExecutionProviders execution_providers;
+  SessionState s{execution_providers};
+  s.SetMemoryPatternCacheOptions(2, {});
+
+  std::vector<TensorShape> shapes_1{TensorShape({1, 8})};
+  std::vector<TensorShape> shapes_2{TensorShape({2, 8})};
+  std::vector<TensorShape> shapes_3{TensorShape({3, 8})};
+
+  EXPECT_EQ(s.GetMemoryPatternGroup(shapes_1), nullptr);
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache(shapes_1, std::make_unique<MemoryPatternGroup>()).IsOK());
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache(shapes_2, std::make_unique<MemoryPatternGroup>()).IsOK());
+
+  // use shapes_1 so shapes_2 becomes the least recently used entry and is evicted when shapes_3 is added
+  auto pattern_1 = s.GetMemoryPatternGroup(shapes_1);
+  EXPECT_NE(pattern_1, nullptr);
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache(shapes_3, std::make_unique<MemoryPatternGroup>()).IsOK());
+
+  EXPECT_EQ(s.GetMemoryPatternGroup(shapes_1), pattern_1);
+  EXPECT_EQ(s.GetMemoryPatternGroup(shapes_2), nullptr);
+  EXPECT_NE(s.GetMemoryPatternGroup(shapes_3), nullptr);
+
+  auto stats = s.GetMemoryPatternCacheStats();
+  EXPECT_EQ(stats.hits, 3u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.size, 2u);
+}
+
+TEST(SessionStateTest, MemoryPatternCacheShapeBuckets) {
+  ExecutionProviders execution_providers;
+  SessionState s{execution_providers};
+  s.SetMemoryPatternCacheOptions(0, {64, 32});
+
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache({TensorShape({1, 20})}, std::make_unique<MemoryPatternGroup>()).IsOK());
+
+  // dims are rounded up to the next bucket
+  auto pattern = s.GetMemoryPatternGroup({TensorShape({1, 32})});
+  EXPECT_NE(pattern, nullptr);
+  EXPECT_EQ(s.GetMemoryPatternGroup({TensorShape({1, 33})}), nullptr);
+
+  // dims above the last bucket and different ranks don't share a pattern
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache({TensorShape({1, 100})}, std::make_unique<MemoryPatternGroup>()).IsOK());
+  EXPECT_EQ(s.GetMemoryPatternGroup({TensorShape({1, 101})}), nullptr);
+  EXPECT_EQ(s.GetMemoryPatternGroup({TensorShape({1, 20, 1})}), nullptr);
+
+  // a new pattern for the bucket replaces the previous one
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache({TensorShape({1, 30})}, std::make_unique<MemoryPatternGroup>()).IsOK());
+  auto replaced = s.GetMemoryPatternGroup({TensorShape({1, 25})});
+  EXPECT_NE(replaced, nullptr);
+  EXPECT_NE(replaced, pattern);
+  EXPECT_EQ(s.GetMemoryPatternCacheStats().size, 2u);
+}
 }  // namespace test
 }  // namespace onnxruntime
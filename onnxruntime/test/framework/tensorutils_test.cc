@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "core/framework/tensorprotoutils.h"
+#include "core/framework/tensor.h"
 #include "core/graph/onnx_protobuf.h"
 #include "gtest/gtest.h"
 
@@ -71,5 +72,66 @@ TEST(TensorParseTest, TensorUtilsTest) {
   status = UnpackTensorWrapper(bool_tensor_proto, string_data, 2);
   EXPECT_FALSE(status.IsOK());
 }
+
+TEST(TensorParseTest, RawDataInPlace) {
+  TensorProto float_tensor_proto;
+  float_tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+  // large enough for the string not to be stored inline, where it may not be aligned for float
+  float_tensor_proto.add_dims(8);
+  const float f[8] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f};
+  float_tensor_proto.set_raw_data(f, sizeof(f));
+  ASSERT_TRUE(CanUseTensorProtoDataInPlace(float_tensor_proto));
+
+  OrtAllocatorInfo cpu_info(CPU, OrtDeviceAllocator, 0, OrtMemTypeDefault);
+  MLValue value;
+  OrtCallback deleter;
+  auto status = TensorProtoToMLValue(Env::Default(), nullptr, float_tensor_proto, MemBuffer(nullptr, 0, cpu_info),
+                                     value, deleter, true);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  EXPECT_EQ(nullptr, deleter.f);
+  const Tensor& tensor = value.Get<Tensor>();
+  EXPECT_EQ(static_cast<const void*>(float_tensor_proto.raw_data().data()), tensor.DataRaw());
+  EXPECT_EQ(3.f, tensor.Data<float>()[2]);
+
+  // without use_raw_data_in_place the data must be copied into a preallocated buffer
+  status = TensorProtoToMLValue(Env::Default(), nullptr, float_tensor_proto, MemBuffer(nullptr, 0, cpu_info),
+                                value, deleter);
+  EXPECT_FALSE(status.IsOK());
+
+  float buffer[8];
+  status = TensorProtoToMLValue(Env::Default(), nullptr, float_tensor_proto,
+                                MemBuffer(buffer, sizeof(buffer), cpu_info), value, deleter);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  EXPECT_EQ(static_cast<const void*>(buffer), value.Get<Tensor>().DataRaw());
+  EXPECT_EQ(3.f, buffer[2]);
+
+  // raw_data of the wrong size can't be used in place
+  float_tensor_proto.add_dims(2);
+  EXPECT_FALSE(CanUseTensorProtoDataInPlace(float_tensor_proto));
+
+  TensorProto string_tensor_proto;
+  string_tensor_proto.set_data_type(TensorProto_DataType_STRING);
+  string_tensor_proto.add_dims(1);
+  string_tensor_proto.add_string_data("a");
+  EXPECT_FALSE(CanUseTensorProtoDataInPlace(string_tensor_proto));
+}
+
+TEST(TensorParseTest, ExternalDataInPlace) {
+  TensorProto float_tensor_proto;
+  float_tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+  float_tensor_proto.add_dims(4);
+  float_tensor_proto.set_data_location(TensorProto_DataLocation_EXTERNAL);
+  auto* location = float_tensor_proto.add_external_data();
+  location->set_key("location");
+  location->set_value("weights.bin");
+  auto* offset = float_tensor_proto.add_external_data();
+  offset->set_key("offset");
+
+  // the data is mapped at its offset in the file, so only offsets that are a multiple of sizeof(float) are aligned
+  offset->set_value("4096");
+  EXPECT_TRUE(CanUseTensorProtoDataInPlace(float_tensor_proto));
+  offset->set_value("4098");
+  EXPECT_FALSE(CanUseTensorProtoDataInPlace(float_tensor_proto));
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -17,7 +17,12 @@ Abstract:
 #include <stdio.h>
 #include <memory.h>
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
 #include <mlas.h>
 
 #if defined(_WIN32)
@@ -249,6 +254,25 @@ TrialSgemm(
             printf("mismatch TransA=%d, TransB=%d, M=%zd, N=%zd, K=%zd, alpha=%f, beta=%f!\n", TransA, TransB, M, N, K, alpha, beta);
         }
     }
+
+    //
+    // Repeat the operation with matrix B packed up front.
+    //
+
+    for (size_t f = 0; f < M * N; f++) {
+        C[f] = -0.5f;
+    }
+
+    std::unique_ptr<unsigned char[]> PackedB(new unsigned char[MlasSgemmPackBSize(N, K)]);
+
+    MlasSgemmPackB(TransB, N, K, B, ldb, PackedB.get());
+    MlasSgemmPacked(TransA, M, N, K, alpha, A, lda, PackedB.get(), beta, C, ldc);
+
+    for (size_t f = 0; f < M * N; f++) {
+        if (C[f] != CReference[f]) {
+            printf("mismatch packed TransA=%d, TransB=%d, M=%zd, N=%zd, K=%zd, alpha=%f, beta=%f!\n", TransA, TransB, M, N, K, alpha, beta);
+        }
+    }
 }
 
 void
@@ -275,6 +299,106 @@ TrialSgemm(
     TrialSgemm(CblasTrans, CblasTrans, M, N, K, alpha, A, M, B, K, beta, C, CReference, N);
 }
 
+void
+TrialSgemmBatch(
+    size_t BatchCount,
+    size_t M,
+    size_t N,
+    size_t K,
+    MatrixGuardBuffer& BufferA,
+    MatrixGuardBuffer& BufferB,
+    MatrixGuardBuffer& BufferC,
+    MatrixGuardBuffer& BufferCReference
+    )
+{
+    const float* A = BufferA.GetBuffer(K * M * BatchCount);
+    const float* B = BufferB.GetBuffer(N * K * BatchCount);
+    float* C = BufferC.GetBuffer(N * M * BatchCount);
+    float* CReference = BufferCReference.GetBuffer(N * M * BatchCount);
+
+    std::vector<const float*> ABatch(BatchCount);
+    std::vector<const float*> BBatch(BatchCount);
+    std::vector<float*> CBatch(BatchCount);
+
+    for (size_t b = 0; b < BatchCount; b++) {
+        ABatch[b] = A + K * M * b;
+        BBatch[b] = B + N * K * b;
+        CBatch[b] = C + N * M * b;
+    }
+
+    for (size_t f = 0; f < M * N * BatchCount; f++) {
+        C[f] = -0.5f;
+        CReference[f] = -0.5f;
+    }
+
+    MlasSgemmBatch(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, ABatch.data(), K, BBatch.data(), N, 0.0f, CBatch.data(), N, BatchCount);
+
+    for (size_t b = 0; b < BatchCount; b++) {
+        ReferenceSgemm(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, ABatch[b], K, BBatch[b], N, 0.0f, CReference + N * M * b, N);
+    }
+
+    for (size_t f = 0; f < M * N * BatchCount; f++) {
+        if (C[f] != CReference[f]) {
+            printf("mismatch batch BatchCount=%zd, M=%zd, N=%zd, K=%zd!\n", BatchCount, M, N, K);
+        }
+    }
+
+    //
+    // Repeat the operations with the first matrix B packed up front and
+    // shared by every operation.
+    //
+
+    for (size_t f = 0; f < M * N * BatchCount; f++) {
+        C[f] = -0.5f;
+        CReference[f] = -0.5f;
+    }
+
+    std::unique_ptr<unsigned char[]> PackedB(new unsigned char[MlasSgemmPackBSize(N, K)]);
+
+    MlasSgemmPackB(CblasNoTrans, N, K, B, N, PackedB.get());
+    MlasSgemmPackedBatch(CblasNoTrans, M, N, K, 1.0f, ABatch.data(), K, PackedB.get(), 0.0f, CBatch.data(), N, BatchCount);
+
+    for (size_t b = 0; b < BatchCount; b++) {
+        ReferenceSgemm(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, ABatch[b], K, B, N, 0.0f, CReference + N * M * b, N);
+    }
+
+    for (size_t f = 0; f < M * N * BatchCount; f++) {
+        if (C[f] != CReference[f]) {
+            printf("mismatch packed batch BatchCount=%zd, M=%zd, N=%zd, K=%zd!\n", BatchCount, M, N, K);
+        }
+    }
+}
+
+void
+ExecuteSgemmBatchTests(
+    void
+    )
+{
+    constexpr size_t MaximumDimension = 320;
+
+    MatrixGuardBuffer BufferA(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer BufferB(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer BufferC(MaximumDimension * MaximumDimension, false);
+    MatrixGuardBuffer BufferCReference(MaximumDimension * MaximumDimension, false);
+
+    for (size_t b = 1; b <= 16; b++) {
+        TrialSgemmBatch(b, 1, 1, 1, BufferA, BufferB, BufferC, BufferCReference);
+        TrialSgemmBatch(b, 17, 33, 15, BufferA, BufferB, BufferC, BufferCReference);
+        TrialSgemmBatch(b, 64, 64, 64, BufferA, BufferB, BufferC, BufferCReference);
+    }
+
+    //
+    // Use batches large enough to be threaded when a thread pool is
+    // installed, with fewer operations than threads so that the operations
+    // are also split into tiles along M or N.
+    //
+
+    TrialSgemmBatch(8, 64, 64, 128, BufferA, BufferB, BufferC, BufferCReference);
+    TrialSgemmBatch(2, 160, 160, 160, BufferA, BufferB, BufferC, BufferCReference);
+    TrialSgemmBatch(2, 64, 320, 160, BufferA, BufferB, BufferC, BufferCReference);
+    TrialSgemmBatch(1, 133, 97, 320, BufferA, BufferB, BufferC, BufferCReference);
+}
+
 void
 ExecuteSgemmTests(
     void
@@ -367,6 +491,300 @@ ExecuteSgemmTests(
     }
 }
 
+void
+ReferenceQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    bool BIsSigned,
+    int32_t* C,
+    size_t ldc
+    )
+{
+    for (size_t m = 0; m < M; m++) {
+
+        for (size_t n = 0; n < N; n++) {
+
+            int32_t sum = 0;
+
+            for (size_t k = 0; k < K; k++) {
+
+                int32_t a = int32_t(A[m * lda + k]) - int32_t(offa);
+                int32_t b;
+
+                if (BIsSigned) {
+                    b = int32_t(int8_t(B[k * ldb + n])) - int32_t(int8_t(offb));
+                } else {
+                    b = int32_t(B[k * ldb + n]) - int32_t(offb);
+                }
+
+                sum += a * b;
+            }
+
+            C[m * ldc + n] = sum;
+        }
+    }
+}
+
+void
+TrialQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    uint8_t offa,
+    uint8_t offb,
+    bool BIsSigned
+    )
+{
+    std::vector<uint8_t> A(M * K);
+    std::vector<uint8_t> B(K * N);
+    std::vector<int32_t> C(M * N);
+    std::vector<int32_t> CReference(M * N);
+    std::vector<int32_t> Bias(M);
+    std::vector<uint8_t> Output(M * N);
+
+    for (size_t f = 0; f < A.size(); f++) {
+        A[f] = uint8_t(f * 7 + 3);
+    }
+    for (size_t f = 0; f < B.size(); f++) {
+        B[f] = uint8_t(f * 13 + 5);
+    }
+    for (size_t f = 0; f < Bias.size(); f++) {
+        Bias[f] = int32_t(f * 37) - 300;
+    }
+
+    std::fill(C.begin(), C.end(), -1);
+
+    MlasQgemm(M, N, K, A.data(), K, offa, B.data(), N, offb, BIsSigned, C.data(), N, nullptr);
+    ReferenceQgemm(M, N, K, A.data(), K, offa, B.data(), N, offb, BIsSigned, CReference.data(), N);
+
+    for (size_t f = 0; f < M * N; f++) {
+        if (C[f] != CReference[f]) {
+            printf("mismatch qgemm M=%zd, N=%zd, K=%zd, offa=%d, offb=%d, signed=%d!\n", M, N, K, offa, offb, BIsSigned);
+            break;
+        }
+    }
+
+    //
+    // Repeat the operation with matrix B packed up front and the output
+    // requantized to 8 bits.
+    //
+
+    std::fill(C.begin(), C.end(), -1);
+
+    std::unique_ptr<unsigned char[]> PackedB(new unsigned char[MlasQgemmPackBSize(N, K)]);
+
+    MLAS_QGEMM_REQUANTIZE_PARAMETERS Requantize;
+    Requantize.Output = Output.data();
+    Requantize.ldo = N;
+    Requantize.Bias = Bias.data();
+    Requantize.Scale = 1.0f / 1024.0f;
+    Requantize.ZeroPoint = 100;
+
+    MlasQgemmPackB(N, K, B.data(), N, offb, BIsSigned, PackedB.get());
+    MlasQgemmPacked(M, N, K, A.data(), K, offa, PackedB.get(), C.data(), N, &Requantize);
+
+    for (size_t m = 0; m < M; m++) {
+        for (size_t n = 0; n < N; n++) {
+
+            size_t f = m * N + n;
+
+            if (C[f] != CReference[f]) {
+                printf("mismatch packed qgemm M=%zd, N=%zd, K=%zd, offa=%d, offb=%d, signed=%d!\n", M, N, K, offa, offb, BIsSigned);
+                return;
+            }
+
+            // The scale is a power of two, so the reference value is exact.
+            float ScaledValue = float(CReference[f] + Bias[m]) * Requantize.Scale;
+            long OutputReference = std::lrint(ScaledValue) + Requantize.ZeroPoint;
+            OutputReference = std::min(std::max(OutputReference, 0L), 255L);
+
+            if (Output[f] != uint8_t(OutputReference)) {
+                printf("mismatch requantized qgemm M=%zd, N=%zd, K=%zd, offa=%d, offb=%d, signed=%d!\n", M, N, K, offa, offb, BIsSigned);
+                return;
+            }
+        }
+    }
+}
+
+void
+ExecuteQgemmTests(
+    void
+    )
+{
+    static const uint8_t offsets[] = { 0, 1, 127, 128, 255 };
+
+    for (size_t a = 0; a < _countof(offsets); a++) {
+        for (size_t b = 0; b < _countof(offsets); b++) {
+            TrialQgemm(16, 16, 16, offsets[a], offsets[b], false);
+            TrialQgemm(16, 16, 16, offsets[a], offsets[b], true);
+        }
+    }
+
+    for (size_t M = 1; M < 20; M++) {
+        for (size_t N = 1; N < 40; N++) {
+            for (size_t K = 0; K < 40; K++) {
+                TrialQgemm(M, N, K, 3, 7, (N & 1) != 0);
+            }
+        }
+        printf("M %zd\n", M);
+    }
+
+    static const size_t ks[] = { 1, 2, 3, 15, 16, 17, 255, 256, 257, 511, 512, 513 };
+
+    for (size_t M = 1; M < 160; M += 23) {
+        for (size_t N = 1; N < 320; N += 45) {
+            for (size_t k = 0; k < _countof(ks); k++) {
+                TrialQgemm(M, N, ks[k], 128, 118, false);
+                TrialQgemm(M, N, ks[k], 128, 246, true);
+            }
+        }
+        printf("M %zd\n", M);
+    }
+}
+
+template<typename ElementType>
+void
+TrialTranspose(
+    size_t M,
+    size_t N,
+    size_t lda,
+    size_t ldb
+    )
+{
+    std::vector<ElementType> Input(M * lda);
+    std::vector<ElementType> Output(N * ldb);
+
+    for (size_t f = 0; f < Input.size(); f++) {
+        Input[f] = ElementType(f * 2654435761u);
+    }
+
+    //
+    // Fill the destination so that writes outside of the N x M matrix are
+    // detected.
+    //
+
+    std::fill(Output.begin(), Output.end(), ElementType(0x5A));
+
+    MlasTranspose(M, N, Input.data(), lda, Output.data(), ldb);
+
+    for (size_t n = 0; n < N; n++) {
+        for (size_t m = 0; m < ldb; m++) {
+            ElementType Expected = (m < M) ? Input[m * lda + n] : ElementType(0x5A);
+            if (Output[n * ldb + m] != Expected) {
+                printf("mismatch transpose%zd M=%zd, N=%zd, lda=%zd, ldb=%zd!\n", sizeof(ElementType) * 8, M, N, lda, ldb);
+                return;
+            }
+        }
+    }
+}
+
+void
+ExecuteTransposeTests(
+    void
+    )
+{
+    for (size_t M = 1; M < 40; M++) {
+        for (size_t N = 1; N < 40; N++) {
+            TrialTranspose<uint32_t>(M, N, N, M);
+            TrialTranspose<uint32_t>(M, N, N + 3, M + 5);
+            TrialTranspose<uint8_t>(M, N, N, M);
+            TrialTranspose<uint8_t>(M, N, N + 3, M + 5);
+        }
+    }
+
+    static const size_t sizes[] = { 63, 64, 65, 127, 128, 129, 200, 1000 };
+
+    for (size_t m = 0; m < _countof(sizes); m++) {
+        for (size_t n = 0; n < _countof(sizes); n++) {
+            TrialTranspose<uint32_t>(sizes[m], sizes[n], sizes[n], sizes[m]);
+            TrialTranspose<uint8_t>(sizes[m], sizes[n], sizes[n] + 1, sizes[m] + 17);
+        }
+    }
+}
+
+void
+ReferenceSoftmax(
+    const float* Input,
+    float* Output,
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    )
+{
+    for (size_t n = 0; n < N; n++) {
+
+        float Maximum = Input[0];
+
+        for (size_t d = 1; d < D; d++) {
+            Maximum = std::max(Maximum, Input[d]);
+        }
+
+        double Sum = 0.0;
+
+        for (size_t d = 0; d < D; d++) {
+            Sum += std::exp(double(Input[d]) - double(Maximum));
+        }
+
+        for (size_t d = 0; d < D; d++) {
+            double Shifted = double(Input[d]) - double(Maximum);
+            Output[d] = float(LogSoftmax ? Shifted - std::log(Sum) : std::exp(Shifted) / Sum);
+        }
+
+        Input += D;
+        Output += D;
+    }
+}
+
+void
+TrialSoftmax(
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    )
+{
+    std::vector<float> Input(N * D);
+    std::vector<float> Output(N * D);
+    std::vector<float> OutputReference(N * D);
+
+    for (size_t f = 0; f < Input.size(); f++) {
+        Input[f] = float(int(f * 2654435761u % 1021) - 510) / 64.0f;
+    }
+
+    MlasComputeSoftmax(Input.data(), Output.data(), N, D, LogSoftmax);
+    ReferenceSoftmax(Input.data(), OutputReference.data(), N, D, LogSoftmax);
+
+    for (size_t f = 0; f < Output.size(); f++) {
+        float Difference = std::fabs(Output[f] - OutputReference[f]);
+        if (!(Difference <= 1e-6f + 1e-5f * std::fabs(OutputReference[f]))) {
+            printf("mismatch %s N=%zd, D=%zd!\n", LogSoftmax ? "logsoftmax" : "softmax", N, D);
+            return;
+        }
+    }
+}
+
+void
+ExecuteSoftmaxTests(
+    void
+    )
+{
+    static const size_t ns[] = { 1, 2, 3, 17, 64, 240 };
+    static const size_t ds[] = { 1, 2, 7, 15, 16, 17, 100, 1000 };
+
+    for (size_t n = 0; n < _countof(ns); n++) {
+        for (size_t d = 0; d < _countof(ds); d++) {
+            TrialSoftmax(ns[n], ds[d], false);
+            TrialSoftmax(ns[n], ds[d], true);
+        }
+    }
+}
+
 void
 ReferenceConv2D(
     size_t BatchCount,
@@ -601,6 +1019,28 @@ ExecuteConvTests(
         TrialConv2D(b, 1, 64, 11, 11, 128, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1);
     }
 
+    //
+    // Test the depthwise convolution kernels.
+    //
+
+    static const unsigned dis[] = { 53, 28, 11, 5, 2, 1 };
+
+    for (unsigned ih = 0; ih < _countof(dis); ih++) {
+        for (unsigned iw = 0; iw < _countof(dis); iw++) {
+            for (unsigned k = 3; k <= 5; k += 2) {
+                for (unsigned p = 0; p <= 3; p++) {
+                    for (unsigned sh = 1; sh <= 2; sh++) {
+                        for (unsigned sw = 1; sw <= 2; sw++) {
+                            TrialConv2D(1, 24, 1, dis[ih], dis[iw], 1, k, k, p, p, p, p, 1, 1, sh, sw);
+                            TrialConv2D(2, 5, 1, dis[ih], dis[iw], 3, k, k, p, 0, 0, p, 1, 1, sh, sw);
+                            TrialConv2D(1, 3, 1, dis[ih], dis[iw], 1, 3, k, 1, p, p, 0, 1, 1, sh, sw);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
     for (unsigned ic = 0; ic < _countof(cs); ic++) {
         for (unsigned ih = 0; ih < _countof(is); ih++) {
             for (unsigned iw = 0; iw < _countof(is); iw++) {
@@ -940,36 +1380,168 @@ ReferenceAveragePool3D(
 }
 
 void
-TrialPool2D(
-    size_t BatchCount,
-    size_t InputChannels,
-    size_t InputHeight,
-    size_t InputWidth,
-    size_t KernelHeight,
-    size_t KernelWidth,
-    size_t PaddingLeftHeight,
-    size_t PaddingLeftWidth,
-    size_t PaddingRightHeight,
-    size_t PaddingRightWidth,
-    size_t StrideHeight,
-    size_t StrideWidth
+ReferenceLpPool3D(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    float P,
+    const float* Input,
+    float* Output
     )
 {
-    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputHeight), int64_t(InputWidth) };
-    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
-    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
-    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
-    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0 };
+    int64_t ChannelCount = InputShape[0] * InputShape[1];
 
-    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[2] - KernelShape[0]) / StrideShape[0] + 1;
-    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[3] - KernelShape[1]) / StrideShape[1] + 1;
+    int64_t InputDepth = InputShape[2];
+    int64_t InputHeight = InputShape[3];
+    int64_t InputWidth = InputShape[4];
 
-    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3]);
-    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3]);
+    int64_t OutputDepth = (InputDepth + Padding[0] + Padding[3] - KernelShape[0]) / StrideShape[0] + 1;
+    int64_t OutputHeight = (InputHeight + Padding[1] + Padding[4] - KernelShape[1]) / StrideShape[1] + 1;
+    int64_t OutputWidth = (InputWidth + Padding[2] + Padding[5] - KernelShape[2]) / StrideShape[2] + 1;
 
-    MatrixGuardBuffer BufferInput(InputBufferElements, true);
-    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
-    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+    for (int64_t c = 0; c < ChannelCount; c++) {
+
+        for (int64_t pd = 0; pd < OutputDepth; pd++) {
+
+            int64_t idStart = (std::max)(pd * StrideShape[0] - Padding[0], int64_t(0));
+            int64_t idEnd = (std::min)(pd * StrideShape[0] - Padding[0] + KernelShape[0], InputDepth);
+
+            for (int64_t ph = 0; ph < OutputHeight; ph++) {
+
+                int64_t ihStart = (std::max)(ph * StrideShape[1] - Padding[1], int64_t(0));
+                int64_t ihEnd = (std::min)(ph * StrideShape[1] - Padding[1] + KernelShape[1], InputHeight);
+
+                for (int64_t pw = 0; pw < OutputWidth; pw++) {
+
+                    int64_t iwStart = (std::max)(pw * StrideShape[2] - Padding[2], int64_t(0));
+                    int64_t iwEnd = (std::min)(pw * StrideShape[2] - Padding[2] + KernelShape[2], InputWidth);
+
+                    float m = 0.0f;
+
+                    for (int64_t id = idStart; id < idEnd; id++) {
+                        for (int64_t ih = ihStart; ih < ihEnd; ih++) {
+                            for (int64_t iw = iwStart; iw < iwEnd; iw++) {
+                                float Value = std::fabs(Input[id * InputHeight * InputWidth + ih * InputWidth + iw]);
+                                m += (P == 1.0f) ? Value : (P == 2.0f) ? Value * Value : std::pow(Value, P);
+                            }
+                        }
+                    }
+
+                    Output[pd * OutputHeight * OutputWidth + ph * OutputWidth + pw] =
+                        (P == 1.0f) ? m : (P == 2.0f) ? std::sqrt(m) : std::pow(m, 1.0f / P);
+                }
+            }
+        }
+
+        Input += InputDepth * InputHeight * InputWidth;
+        Output += OutputDepth * OutputHeight * OutputWidth;
+    }
+}
+
+void
+ReferenceMaximumPoolWithIndex3D(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const float* Input,
+    const int32_t* Mask,
+    float* Output,
+    int64_t* Index
+    )
+{
+    int64_t ChannelCount = InputShape[0] * InputShape[1];
+
+    int64_t InputDepth = InputShape[2];
+    int64_t InputHeight = InputShape[3];
+    int64_t InputWidth = InputShape[4];
+    int64_t InputSize = InputDepth * InputHeight * InputWidth;
+
+    int64_t OutputDepth = (InputDepth + Padding[0] + Padding[3] - KernelShape[0]) / StrideShape[0] + 1;
+    int64_t OutputHeight = (InputHeight + Padding[1] + Padding[4] - KernelShape[1]) / StrideShape[1] + 1;
+    int64_t OutputWidth = (InputWidth + Padding[2] + Padding[5] - KernelShape[2]) / StrideShape[2] + 1;
+
+    for (int64_t c = 0; c < ChannelCount; c++) {
+
+        for (int64_t pd = 0; pd < OutputDepth; pd++) {
+
+            int64_t idStart = (std::max)(pd * StrideShape[0] - Padding[0], int64_t(0));
+            int64_t idEnd = (std::min)(pd * StrideShape[0] - Padding[0] + KernelShape[0], InputDepth);
+
+            for (int64_t ph = 0; ph < OutputHeight; ph++) {
+
+                int64_t ihStart = (std::max)(ph * StrideShape[1] - Padding[1], int64_t(0));
+                int64_t ihEnd = (std::min)(ph * StrideShape[1] - Padding[1] + KernelShape[1], InputHeight);
+
+                for (int64_t pw = 0; pw < OutputWidth; pw++) {
+
+                    int64_t iwStart = (std::max)(pw * StrideShape[2] - Padding[2], int64_t(0));
+                    int64_t iwEnd = (std::min)(pw * StrideShape[2] - Padding[2] + KernelShape[2], InputWidth);
+
+                    float m = std::numeric_limits<float>::lowest();
+                    int64_t MaximumIndex = idStart * InputHeight * InputWidth + ihStart * InputWidth + iwStart;
+
+                    for (int64_t id = idStart; id < idEnd; id++) {
+                        for (int64_t ih = ihStart; ih < ihEnd; ih++) {
+                            for (int64_t iw = iwStart; iw < iwEnd; iw++) {
+                                int64_t i = id * InputHeight * InputWidth + ih * InputWidth + iw;
+                                if (Mask != nullptr && Mask[c * InputSize + i] == 0) {
+                                    break;
+                                }
+                                if (Input[i] > m) {
+                                    m = Input[i];
+                                    MaximumIndex = i;
+                                }
+                            }
+                        }
+                    }
+
+                    int64_t OutputIndex = pd * OutputHeight * OutputWidth + ph * OutputWidth + pw;
+
+                    Output[OutputIndex] = m;
+                    Index[OutputIndex] = c * InputSize + MaximumIndex;
+                }
+            }
+        }
+
+        Input += InputSize;
+        Output += OutputDepth * OutputHeight * OutputWidth;
+        Index += OutputDepth * OutputHeight * OutputWidth;
+    }
+}
+
+void
+TrialPool2D(
+    size_t BatchCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0 };
+
+    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[2] - KernelShape[0]) / StrideShape[0] + 1;
+    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[3] - KernelShape[1]) / StrideShape[1] + 1;
+
+    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3]);
+    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3]);
+
+    MatrixGuardBuffer BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
 
     const float* Input = BufferInput.GetBuffer(InputBufferElements);
     float* Output = BufferOutput.GetBuffer(OutputBufferElements);
@@ -1067,6 +1639,113 @@ TrialPool3D(
     }
 }
 
+void
+TrialLpAndIndexPool(
+    size_t Dimensions,
+    size_t BatchCount,
+    size_t InputChannels,
+    size_t InputDepth,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t KernelDepth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftDepth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightDepth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t StrideDepth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    //
+    // The leading dimensions of the three dimensional shapes are dropped when
+    // Dimensions is less than three, so they must be one.
+    //
+
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputDepth), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelDepth), int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftDepth), int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightDepth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideDepth), int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0, 0 };
+
+    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[3] - KernelShape[0]) / StrideShape[0] + 1;
+    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[4] - KernelShape[1]) / StrideShape[1] + 1;
+    OutputShape[4] = (InputShape[4] + Padding[2] + Padding[5] - KernelShape[2]) / StrideShape[2] + 1;
+
+    const size_t LeadingDimensions = 3 - Dimensions;
+
+    int64_t MlasInputShape[5] = { InputShape[0], InputShape[1] };
+    int64_t MlasOutputShape[5] = { OutputShape[0], OutputShape[1] };
+    int64_t MlasKernelShape[3];
+    int64_t MlasPadding[6];
+    int64_t MlasStrideShape[3];
+
+    for (size_t dim = 0; dim < Dimensions; dim++) {
+        MlasInputShape[dim + 2] = InputShape[dim + LeadingDimensions + 2];
+        MlasOutputShape[dim + 2] = OutputShape[dim + LeadingDimensions + 2];
+        MlasKernelShape[dim] = KernelShape[dim + LeadingDimensions];
+        MlasPadding[dim] = Padding[dim + LeadingDimensions];
+        MlasPadding[dim + Dimensions] = Padding[dim + LeadingDimensions + 3];
+        MlasStrideShape[dim] = StrideShape[dim + LeadingDimensions];
+    }
+
+    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3] * InputShape[4]);
+    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3] * OutputShape[4]);
+
+    MatrixGuardBuffer BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+
+    std::vector<int64_t> Index(OutputBufferElements);
+    std::vector<int64_t> IndexReference(OutputBufferElements);
+
+    for (float P : { 1.0f, 2.0f, 3.0f }) {
+
+        MlasLpPool(Dimensions, MlasInputShape, MlasKernelShape, MlasPadding, MlasStrideShape, MlasOutputShape, P, Input, Output);
+        ReferenceLpPool3D(InputShape, KernelShape, Padding, StrideShape, P, Input, OutputReference);
+
+        if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+            printf("mismatch: lp%d dims=%zd input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n", int(P), Dimensions,
+                InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+        }
+    }
+
+    MlasMaximumPoolWithIndex(Dimensions, MlasInputShape, MlasKernelShape, MlasPadding, MlasStrideShape, MlasOutputShape, Input, Output, Index.data());
+    ReferenceMaximumPoolWithIndex3D(InputShape, KernelShape, Padding, StrideShape, Input, nullptr, OutputReference, IndexReference.data());
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0 || Index != IndexReference) {
+        printf("mismatch: maximumindex dims=%zd input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n", Dimensions,
+            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+    }
+
+    //
+    // Mask out a diagonal band of each channel, so that some rows of the
+    // kernels are cut short.
+    //
+
+    std::vector<int32_t> Mask(InputBufferElements);
+
+    for (size_t i = 0; i < InputBufferElements; i++) {
+        Mask[i] = int32_t((i % InputWidth + i / InputWidth) % 5 != 3);
+    }
+
+    MlasMaximumPoolWithMask(Dimensions, MlasInputShape, MlasKernelShape, MlasPadding, MlasStrideShape, MlasOutputShape, Input, Mask.data(), InputBufferElements, Output);
+    ReferenceMaximumPoolWithIndex3D(InputShape, KernelShape, Padding, StrideShape, Input, Mask.data(), OutputReference, IndexReference.data());
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: maximummask dims=%zd input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n", Dimensions,
+            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+    }
+}
+
 void
 ExecutePool2DTests(
     void
@@ -1152,6 +1831,359 @@ ExecutePool3DTests(
     }
 }
 
+void
+ExecutePoolTests(
+    void
+    )
+{
+    //
+    // Short pooling tests with enough channels to be split across threads
+    // when a thread pool is installed. The exhaustive tests are above.
+    //
+
+    TrialPool2D(1, 64, 32, 32, 3, 3, 1, 1, 1, 1, 1, 1);
+    TrialPool2D(3, 37, 17, 23, 2, 3, 0, 1, 1, 0, 2, 1);
+    TrialPool2D(4, 256, 16, 16, 16, 16, 0, 0, 0, 0, 1, 1);
+    TrialPool2D(1, 1024, 7, 7, 7, 7, 0, 0, 0, 0, 1, 1);
+    TrialPool3D(2, 24, 9, 8, 7, 2, 3, 2, 1, 0, 1, 0, 1, 1, 1, 1, 2);
+    TrialPool3D(1, 64, 8, 8, 8, 8, 8, 8, 0, 0, 0, 0, 0, 0, 1, 1, 1);
+
+    TrialLpAndIndexPool(1, 2, 24, 1, 1, 37, 1, 1, 4, 0, 0, 1, 0, 0, 2, 1, 1, 3);
+    TrialLpAndIndexPool(2, 1, 64, 1, 32, 32, 1, 3, 3, 0, 1, 1, 0, 1, 1, 1, 1, 1);
+    TrialLpAndIndexPool(2, 3, 37, 1, 17, 23, 1, 2, 3, 0, 0, 1, 0, 1, 0, 1, 2, 1);
+    TrialLpAndIndexPool(2, 4, 32, 1, 16, 16, 1, 16, 16, 0, 0, 0, 0, 0, 0, 1, 1, 1);
+    TrialLpAndIndexPool(3, 2, 24, 9, 8, 7, 2, 3, 2, 1, 0, 1, 0, 1, 1, 1, 1, 2);
+}
+
+void
+TrialNchwcConv2D(
+    size_t BatchCount,
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t FilterCount,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t DilationHeight,
+    size_t DilationWidth,
+    size_t StrideHeight,
+    size_t StrideWidth,
+    MLAS_ACTIVATION_KIND ActivationKind
+    )
+{
+    //
+    // The only grouped convolution supported by the NCHWc routines is a
+    // depthwise convolution, where each group has one input and one output
+    // channel.
+    //
+
+    const size_t BlockSize = MlasNchwcGetBlockSize();
+
+    int64_t OutputHeight64 =
+        ((int64_t(InputHeight) + int64_t(PaddingLeftHeight) + int64_t(PaddingRightHeight)) -
+        (int64_t(DilationHeight) * (int64_t(KernelHeight) - 1) + 1)) / int64_t(StrideHeight) + 1;
+    int64_t OutputWidth64 =
+        ((int64_t(InputWidth) + int64_t(PaddingLeftWidth) + int64_t(PaddingRightWidth)) -
+        (int64_t(DilationWidth) * (int64_t(KernelWidth) - 1) + 1)) / int64_t(StrideWidth) + 1;
+
+    if (OutputHeight64 <= 0 || OutputWidth64 <= 0) {
+        return;
+    }
+
+    int64_t InputShape[] = { int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t DilationShape[] = { int64_t(DilationHeight), int64_t(DilationWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { OutputHeight64, OutputWidth64 };
+
+    MLAS_ACTIVATION Activation;
+    Activation.ActivationKind = ActivationKind;
+    Activation.alpha = 0.5f;
+
+    MLAS_CONV_PARAMETERS Parameters;
+    size_t WorkingBufferSize;
+
+    MlasConvPrepare(&Parameters,
+                    2,
+                    BatchCount,
+                    GroupCount,
+                    InputChannels,
+                    InputShape,
+                    KernelShape,
+                    DilationShape,
+                    Padding,
+                    StrideShape,
+                    OutputShape,
+                    FilterCount,
+                    &Activation,
+                    &WorkingBufferSize);
+
+    size_t OutputHeight = size_t(OutputHeight64);
+    size_t OutputWidth = size_t(OutputWidth64);
+
+    size_t TotalInputChannels = GroupCount * InputChannels;
+    size_t TotalFilterCount = GroupCount * FilterCount;
+
+    size_t InputSize = InputHeight * InputWidth;
+    size_t KernelSize = KernelHeight * KernelWidth;
+    size_t OutputSize = OutputHeight * OutputWidth;
+
+    size_t InputBufferElements = BatchCount * TotalInputChannels * InputSize;
+    size_t FilterBufferElements = TotalFilterCount * InputChannels * KernelSize;
+    size_t BiasBufferElements = TotalFilterCount;
+    size_t OutputBufferElements = BatchCount * TotalFilterCount * OutputSize;
+
+    MatrixGuardBuffer BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer BufferFilter(FilterBufferElements, true);
+    MatrixGuardBuffer BufferBias(BiasBufferElements, true);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    const float* Filter = BufferFilter.GetBuffer(FilterBufferElements);
+    const float* Bias = BufferBias.GetBuffer(BiasBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+
+    MatrixGuardBuffer BufferWorking(WorkingBufferSize, false);
+
+    MlasConv(&Parameters,
+             Input,
+             Filter,
+             Bias,
+             BufferWorking.GetBuffer(WorkingBufferSize),
+             OutputReference);
+
+    //
+    // Reorder the input, filter, and bias to the NCHWc layout. Inputs with
+    // fewer channels than the block size are left in NCHW order.
+    //
+
+    bool ReorderInput = (GroupCount > 1 || TotalInputChannels >= BlockSize);
+
+    size_t NchwcInputChannels = TotalInputChannels;
+
+    if (ReorderInput) {
+        NchwcInputChannels = (TotalInputChannels + BlockSize - 1) & ~(BlockSize - 1);
+    }
+
+    size_t NchwcOutputChannels = (TotalFilterCount + BlockSize - 1) & ~(BlockSize - 1);
+
+    std::vector<float> NchwcInput(BatchCount * NchwcInputChannels * InputSize);
+    std::vector<float> NchwcFilter(NchwcOutputChannels * ((GroupCount > 1) ? 1 : NchwcInputChannels) * KernelSize);
+    std::vector<float> NchwcBias(NchwcOutputChannels);
+    std::vector<float> NchwcOutput(BatchCount * NchwcOutputChannels * OutputSize);
+
+    int64_t InputShapeNchw[] = { int64_t(BatchCount), int64_t(TotalInputChannels), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t FilterShapeNchw[] = { int64_t(TotalFilterCount), int64_t(InputChannels), int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t OutputShapeNchw[] = { int64_t(BatchCount), int64_t(TotalFilterCount), OutputHeight64, OutputWidth64 };
+
+    if (ReorderInput) {
+        MlasReorderInput(InputShapeNchw, Input, NchwcInput.data());
+    } else {
+        std::copy_n(Input, InputBufferElements, NchwcInput.data());
+    }
+
+    if (GroupCount > 1 || TotalInputChannels < BlockSize) {
+        MlasReorderFilterOIHWBo(FilterShapeNchw, Filter, NchwcFilter.data());
+    } else {
+        MlasReorderFilterOIHWBiBo(FilterShapeNchw, Filter, NchwcFilter.data());
+    }
+
+    std::copy_n(Bias, BiasBufferElements, NchwcBias.data());
+
+    int64_t NchwcInputShape[] = { int64_t(BatchCount), int64_t(NchwcInputChannels), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t NchwcOutputShape[] = { int64_t(BatchCount), int64_t(NchwcOutputChannels), OutputHeight64, OutputWidth64 };
+
+    MlasNchwcConv(2,
+                  NchwcInputShape,
+                  KernelShape,
+                  DilationShape,
+                  Padding,
+                  StrideShape,
+                  NchwcOutputShape,
+                  GroupCount,
+                  NchwcInput.data(),
+                  NchwcFilter.data(),
+                  NchwcBias.data(),
+                  NchwcOutput.data(),
+                  &Activation,
+                  true);
+
+    MlasReorderOutput(OutputShapeNchw, NchwcOutput.data(), Output);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch nchwc: batch=%zd,group=%zd,input(%zd,%zd,%zd),filter=%zd,kernel(%zd,%zd),activation=%d!!!\n",
+            BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
+            KernelHeight, KernelWidth, int(ActivationKind));
+        return;
+    }
+
+    //
+    // Accumulate the convolution into the existing output, which doubles the
+    // output when no activation is applied.
+    //
+
+    if (ActivationKind == MlasIdentityActivation) {
+
+        MlasNchwcConv(2,
+                      NchwcInputShape,
+                      KernelShape,
+                      DilationShape,
+                      Padding,
+                      StrideShape,
+                      NchwcOutputShape,
+                      GroupCount,
+                      NchwcInput.data(),
+                      NchwcFilter.data(),
+                      NchwcBias.data(),
+                      NchwcOutput.data(),
+                      &Activation,
+                      false);
+
+        MlasReorderOutput(OutputShapeNchw, NchwcOutput.data(), Output);
+
+        for (size_t i = 0; i < OutputBufferElements; i++) {
+            if (Output[i] != OutputReference[i] * 2.0f) {
+                printf("mismatch nchwc accumulate: batch=%zd,group=%zd,input(%zd,%zd,%zd),filter=%zd,kernel(%zd,%zd)!!!\n",
+                    BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
+                    KernelHeight, KernelWidth);
+                return;
+            }
+        }
+    }
+}
+
+void
+TrialNchwcPool2D(
+    MLAS_POOLING_KIND PoolingKind,
+    size_t BatchCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    const size_t BlockSize = MlasNchwcGetBlockSize();
+
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0 };
+
+    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[2] - KernelShape[0]) / StrideShape[0] + 1;
+    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[3] - KernelShape[1]) / StrideShape[1] + 1;
+
+    size_t InputSize = size_t(InputShape[2] * InputShape[3]);
+    size_t OutputSize = size_t(OutputShape[2] * OutputShape[3]);
+
+    size_t InputBufferElements = BatchCount * InputChannels * InputSize;
+    size_t OutputBufferElements = BatchCount * InputChannels * OutputSize;
+
+    MatrixGuardBuffer BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+
+    MlasPool(PoolingKind, 2, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, OutputReference);
+
+    size_t NchwcChannels = (InputChannels + BlockSize - 1) & ~(BlockSize - 1);
+
+    std::vector<float> NchwcInput(BatchCount * NchwcChannels * InputSize);
+    std::vector<float> NchwcOutput(BatchCount * NchwcChannels * OutputSize);
+
+    int64_t NchwcInputShape[] = { int64_t(BatchCount), int64_t(NchwcChannels), InputShape[2], InputShape[3] };
+    int64_t NchwcOutputShape[] = { int64_t(BatchCount), int64_t(NchwcChannels), OutputShape[2], OutputShape[3] };
+
+    MlasReorderInput(InputShape, Input, NchwcInput.data());
+
+    MlasNchwcPool(PoolingKind, 2, NchwcInputShape, KernelShape, Padding, StrideShape, NchwcOutputShape,
+        NchwcInput.data(), NchwcOutput.data());
+
+    MlasReorderOutput(OutputShape, NchwcOutput.data(), Output);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch nchwc pool: kind=%d,input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            int(PoolingKind), InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
+}
+
+void
+ExecuteNchwcTests(
+    void
+    )
+{
+    //
+    // Skip the tests if the platform does not support the NCHWc routines.
+    //
+
+    if (MlasNchwcGetBlockSize() <= 1) {
+        return;
+    }
+
+    static const unsigned cs[] = { 3, 8, 16, 24, 40 };
+    static const unsigned is[] = { 53, 11, 5, 1 };
+
+    for (unsigned ic = 0; ic < _countof(cs); ic++) {
+        for (unsigned ih = 0; ih < _countof(is); ih++) {
+            for (unsigned iw = 0; iw < _countof(is); iw++) {
+                fprintf(stderr, "Handling nchwc %ux%ux%u\n", cs[ic], is[ih], is[iw]);
+                for (unsigned kh = 1; kh <= 5; kh += 2) {
+                    for (unsigned kw = 1; kw <= 5; kw += 2) {
+                        for (unsigned p = 0; p < 3; p++) {
+                            for (unsigned d = 1; d <= 2; d++) {
+                                for (unsigned s = 1; s <= 2; s++) {
+                                    TrialNchwcConv2D(1, 1, cs[ic], is[ih], is[iw], 40, kh, kw, p, p, p, 0, d, d, s, s, MlasIdentityActivation);
+                                    TrialNchwcConv2D(2, 1, cs[ic], is[ih], is[iw], 8, kh, kw, 0, p, p, p, d, 1, 1, s, MlasReluActivation);
+                                    TrialNchwcConv2D(1, cs[ic], 1, is[ih], is[iw], 1, kh, kw, p, p, 0, p, d, d, s, s, MlasIdentityActivation);
+                                    TrialNchwcConv2D(2, cs[ic], 1, is[ih], is[iw], 1, kh, kw, p, 0, p, p, 1, d, s, 1, MlasLeakyReluActivation);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for (unsigned ih = 0; ih < _countof(is); ih++) {
+        for (unsigned iw = 0; iw < _countof(is); iw++) {
+            for (unsigned kh = 1; kh <= 3; kh++) {
+                if (kh > is[ih]) break;
+                for (unsigned kw = 1; kw <= 3; kw++) {
+                    if (kw > is[iw]) break;
+                    for (unsigned p = 0; p < kh && p < kw; p++) {
+                        for (unsigned s = 1; s <= 2; s++) {
+                            TrialNchwcPool2D(MlasMaximumPooling, 2, 20, is[ih], is[iw], kh, kw, p, p, p, p, s, s);
+                            TrialNchwcPool2D(MlasAveragePoolingExcludePad, 2, 20, is[ih], is[iw], kh, kw, p, 0, 0, p, s, s);
+                            TrialNchwcPool2D(MlasAveragePoolingIncludePad, 2, 20, is[ih], is[iw], kh, kw, 0, p, p, 0, s, s);
+                        }
+                    }
+                }
+            }
+            TrialNchwcPool2D(MlasMaximumPooling, 1, 16, is[ih], is[iw], is[ih], is[iw], 0, 0, 0, 0, 1, 1);
+            TrialNchwcPool2D(MlasAveragePoolingExcludePad, 1, 16, is[ih], is[iw], is[ih], is[iw], 0, 0, 0, 0, 1, 1);
+        }
+    }
+}
+
 #if 0
 #if defined(_WIN32)
 
@@ -1230,6 +2262,62 @@ EvaluateThreadingPerformance(
 #endif
 #endif
 
+//
+// Simple thread pool used to exercise the threaded paths of the library. Each
+// batch of work is executed by up to MaximumThreadCount threads, including
+// the calling thread, that take iterations from a shared counter.
+//
+
+void
+MLASCALL
+TestThreadPoolExecute(
+    void* ThreadPoolContext,
+    MLAS_THREADPOOL_WORK_ROUTINE* WorkRoutine,
+    void* Context,
+    int32_t Iterations
+    )
+{
+    const int32_t MaximumThreadCount = *static_cast<const int32_t*>(ThreadPoolContext);
+    const int32_t ThreadCount = std::min(MaximumThreadCount, Iterations);
+
+    std::atomic<int32_t> NextIndex{0};
+
+    auto Worker = [&]() {
+        for (int32_t Index = NextIndex++; Index < Iterations; Index = NextIndex++) {
+            WorkRoutine(Context, Index);
+        }
+    };
+
+    std::vector<std::thread> Threads;
+
+    for (int32_t t = 1; t < ThreadCount; t++) {
+        Threads.emplace_back(Worker);
+    }
+
+    Worker();
+
+    for (auto& Thread : Threads) {
+        Thread.join();
+    }
+}
+
+void
+ExecuteTests(
+    void
+    )
+{
+//    ExecuteSgemmTests();
+    ExecuteSgemmBatchTests();
+    ExecuteQgemmTests();
+    ExecuteTransposeTests();
+    ExecuteSoftmaxTests();
+    ExecuteConvTests();
+    ExecuteNchwcTests();
+    ExecutePoolTests();
+//    ExecutePool2DTests();
+//    ExecutePool3DTests();
+}
+
 int
 #if defined(_WIN32)
 __cdecl
@@ -1238,10 +2326,22 @@ main(
     void
     )
 {
-//    ExecuteSgemmTests();
-    ExecuteConvTests();
-//    ExecutePool2DTests();
-//    ExecutePool3DTests();
+    printf("Single threaded tests.\n");
+    ExecuteTests();
+
+    //
+    // Repeat the tests with a caller supplied thread pool installed so that
+    // the threaded paths are exercised on every platform.
+    //
+
+    int32_t MaximumThreadCount = 4;
+    MLAS_THREADPOOL ThreadPool = { TestThreadPoolExecute, &MaximumThreadCount, MaximumThreadCount };
+
+    printf("Threaded tests.\n");
+    MlasSetThreadPool(&ThreadPool);
+    ExecuteTests();
+    MlasSetThreadPool(nullptr);
+
 //    EvaluateThreadingPerformance();
 
     return 0;
@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <core/framework/allocator.h>
+#include <core/framework/bfc_arena.h>
+
+#include <limits>
+#include <vector>
+
+using namespace onnxruntime;
+
+static BFCArena& GetArena(bool enable_thread_cache) {
+  static BFCArena arena(std::make_unique<CPUAllocator>(), std::numeric_limits<size_t>::max(), false);
+  static BFCArena arena_with_thread_cache(std::make_unique<CPUAllocator>(), std::numeric_limits<size_t>::max(), true);
+  return enable_thread_cache ? arena_with_thread_cache : arena;
+}
+
+// Arguments are the allocation size and whether to use the thread cache. Every thread holds a few allocations at
+// a time, similar to the intermediate values of a model being executed.
+static void BM_ArenaAllocFree(benchmark::State& state) {
+  const size_t size = static_cast<size_t>(state.range(0));
+  BFCArena& arena = GetArena(state.range(1) != 0);
+
+  AllocatorStats start_stats;
+  if (state.thread_index == 0) {
+    arena.GetStats(&start_stats);
+  }
+
+  const size_t num_live = 8;
+  std::vector<void*> ptrs(num_live, nullptr);
+  size_t next = 0;
+  for (auto _ : state) {
+    arena.Free(ptrs[next]);
+    ptrs[next] = arena.Alloc(size);
+    benchmark::DoNotOptimize(ptrs[next]);
+    next = (next + 1) % num_live;
+  }
+
+  for (void* p : ptrs) {
+    arena.Free(p);
+  }
+
+  if (state.thread_index == 0) {
+    AllocatorStats stats;
+    arena.GetStats(&stats);
+    state.counters["cache_hits"] = static_cast<double>(stats.num_cache_hits - start_stats.num_cache_hits);
+    state.counters["lock_contentions"] =
+        static_cast<double>(stats.num_lock_contentions - start_stats.num_lock_contentions);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ArenaAllocFree)
+    ->ArgNames({"size", "thread_cache"})
+    ->Args({256, 0})
+    ->Args({256, 1})
+    ->Args({4096, 0})
+    ->Args({4096, 1})
+    ->Args({65536, 0})
+    ->Args({65536, 1})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <core/mlas/inc/mlas.h>
+
+#include <vector>
+
+// Attention-style [B, H, S, S] x [B, H, S, D] products. Arguments are B, H, S, D and whether the matrices are
+// multiplied with a single MlasSgemmBatch call or with one MlasSgemm call each, like MatMul used to.
+static void BM_SgemmBatch(benchmark::State& state) {
+  const size_t batch = static_cast<size_t>(state.range(0) * state.range(1));
+  const size_t S = static_cast<size_t>(state.range(2));
+  const size_t D = static_cast<size_t>(state.range(3));
+  const bool use_batch = state.range(4) != 0;
+
+  std::vector<float> a(batch * S * S, 0.5f);
+  std::vector<float> b(batch * S * D, 0.25f);
+  std::vector<float> c(batch * S * D);
+
+  std::vector<const float*> a_batch(batch);
+  std::vector<const float*> b_batch(batch);
+  std::vector<float*> c_batch(batch);
+  for (size_t i = 0; i < batch; i++) {
+    a_batch[i] = a.data() + i * S * S;
+    b_batch[i] = b.data() + i * S * D;
+    c_batch[i] = c.data() + i * S * D;
+  }
+
+  for (auto _ : state) {
+    if (use_batch) {
+      MlasSgemmBatch(CblasNoTrans, CblasNoTrans, S, D, S, 1.0f, a_batch.data(), S, b_batch.data(), D, 0.0f,
+                     c_batch.data(), D, batch);
+    } else {
+      for (size_t i = 0; i < batch; i++) {
+        MlasSgemm(CblasNoTrans, CblasNoTrans, S, D, S, 1.0f, a_batch[i], S, b_batch[i], D, 0.0f, c_batch[i], D);
+      }
+    }
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+
+BENCHMARK(BM_SgemmBatch)
+    ->ArgNames({"B", "H", "S", "D", "batch"})
+    ->Args({1, 12, 32, 64, 0})
+    ->Args({1, 12, 32, 64, 1})
+    ->Args({1, 12, 128, 64, 0})
+    ->Args({1, 12, 128, 64, 1})
+    ->Args({8, 12, 128, 64, 0})
+    ->Args({8, 12, 128, 64, 1})
+    ->Args({1, 16, 384, 64, 0})
+    ->Args({1, 16, 384, 64, 1})
+    ->UseRealTime();
@@ -0,0 +1,107 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <core/common/logging/logging.h>
+#include <core/framework/allocator.h>
+#include <core/framework/ml_value.h>
+#include <core/framework/run_options.h>
+#include <core/graph/model.h>
+#include <core/graph/onnx_protobuf.h>
+#include <core/session/inference_session.h>
+
+using namespace onnxruntime;
+
+// X -> width branches of depth chained Relu nodes -> Sum -> Y
+static void CreateWideModel(const std::string& model_file_name, int width, int depth, int64_t tensor_size) {
+  onnxruntime::Model model("wide_graph");
+  auto& graph = model.MainGraph();
+
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(tensor_size);
+
+  auto* input_arg = &graph.GetOrCreateNodeArg("X", &float_tensor);
+  std::vector<NodeArg*> sum_inputs;
+  for (int i = 0; i < width; ++i) {
+    NodeArg* branch_arg = input_arg;
+    for (int j = 0; j < depth; ++j) {
+      const std::string name = "relu_" + std::to_string(i) + "_" + std::to_string(j);
+      auto* output_arg = &graph.GetOrCreateNodeArg(name, &float_tensor);
+      graph.AddNode(name, "Relu", "", {branch_arg}, {output_arg});
+      branch_arg = output_arg;
+    }
+    sum_inputs.push_back(branch_arg);
+  }
+
+  graph.AddNode("sum", "Sum", "", sum_inputs, {&graph.GetOrCreateNodeArg("Y", &float_tensor)});
+
+  auto st = graph.Resolve();
+  if (st.IsOK()) {
+    st = onnxruntime::Model::Save(model, model_file_name);
+  }
+
+  if (!st.IsOK()) {
+    printf("Create model failed: %s", st.ErrorMessage().c_str());
+    abort();
+  }
+}
+
+// Arguments are the number of parallel branches in the graph and whether to use the sequential executor.
+static void BM_ExecuteWideGraph(benchmark::State& state) {
+  const int width = static_cast<int>(state.range(0));
+  const bool sequential = state.range(1) != 0;
+  const int depth = 8;
+  const int64_t tensor_size = 4096;
+  const std::string model_file_name = "microbenchmark_wide_graph_" + std::to_string(width) + ".onnx";
+  CreateWideModel(model_file_name, width, depth, tensor_size);
+
+  SessionOptions so;
+  so.session_logid = "BM_ExecuteWideGraph";
+  so.enable_sequential_execution = sequential;
+  so.session_thread_pool_size = 4;
+
+  InferenceSession session_object{so};
+  auto st = session_object.Load(model_file_name);
+  if (st.IsOK()) {
+    st = session_object.Initialize();
+  }
+  if (!st.IsOK()) {
+    state.SkipWithError(st.ErrorMessage().c_str());
+    return;
+  }
+
+  auto allocator = std::make_shared<CPUAllocator>();
+  auto element_type = DataTypeImpl::GetType<float>();
+  auto p_tensor = std::make_unique<Tensor>(element_type, TensorShape({tensor_size}), allocator);
+  std::fill_n(p_tensor->MutableData<float>(), tensor_size, 1.f);
+  MLValue input;
+  input.Init(p_tensor.release(), DataTypeImpl::GetType<Tensor>(), DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+
+  NameMLValMap feeds{{"X", input}};
+  std::vector<std::string> output_names{"Y"};
+  RunOptions run_options;
+  for (auto _ : state) {
+    std::vector<MLValue> fetches;
+    st = session_object.Run(run_options, feeds, output_names, &fetches);
+    if (!st.IsOK()) {
+      state.SkipWithError(st.ErrorMessage().c_str());
+      break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * (width * depth + 1));
+}
+
+BENCHMARK(BM_ExecuteWideGraph)
+    ->ArgNames({"width", "sequential"})
+    ->Args({1, 1})
+    ->Args({1, 0})
+    ->Args({4, 1})
+    ->Args({4, 0})
+    ->Args({16, 1})
+    ->Args({16, 0})
+    ->Args({64, 1})
+    ->Args({64, 0})
+    ->UseRealTime();
@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <core/mlas/inc/mlas.h>
+#include "core/util/gemmlowp_common_wrapper.h"
+
+#include <memory>
+#include <vector>
+
+// Quantized [M, K] x [K, N] products with 32-bit output. Arguments are M, N, K and whether matrix B is packed
+// once up front, as MatMulInteger and QLinearMatMul do for constant weights.
+static void BM_QgemmMlas(benchmark::State& state) {
+  const size_t M = static_cast<size_t>(state.range(0));
+  const size_t N = static_cast<size_t>(state.range(1));
+  const size_t K = static_cast<size_t>(state.range(2));
+  const bool use_packed_b = state.range(3) != 0;
+
+  std::vector<uint8_t> a(M * K, 130);
+  std::vector<uint8_t> b(K * N, 120);
+  std::vector<int32_t> c(M * N);
+
+  std::unique_ptr<uint8_t[]> packed_b(new uint8_t[MlasQgemmPackBSize(N, K)]);
+  MlasQgemmPackB(N, K, b.data(), N, 128, false, packed_b.get());
+
+  for (auto _ : state) {
+    if (use_packed_b) {
+      MlasQgemmPacked(M, N, K, a.data(), K, 128, packed_b.get(), c.data(), N, nullptr);
+    } else {
+      MlasQgemm(M, N, K, a.data(), K, 128, b.data(), N, 128, false, c.data(), N, nullptr);
+    }
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * 2 * M * N * K);
+}
+
+// The same products computed with gemmlowp, which the quantized operators used before MLAS had a QGEMM.
+static void BM_QgemmGemmlowp(benchmark::State& state) {
+  const int M = static_cast<int>(state.range(0));
+  const int N = static_cast<int>(state.range(1));
+  const int K = static_cast<int>(state.range(2));
+
+  std::vector<uint8_t> a(M * K, 130);
+  std::vector<uint8_t> b(K * N, 120);
+  std::vector<int32_t> c(M * N);
+
+  const auto order = gemmlowp::MapOrder::RowMajor;
+  gemmlowp::MatrixMap<const std::uint8_t, order> lhs(a.data(), M, K);
+  gemmlowp::MatrixMap<const std::uint8_t, order> rhs(b.data(), K, N);
+  gemmlowp::MatrixMap<std::int32_t, order> result(c.data(), M, N);
+
+  const std::tuple<> empty_pipeline = {};
+  gemmlowp::GemmContext gemm_context;
+  gemm_context.set_max_num_threads(1);
+
+  for (auto _ : state) {
+    gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::int32_t, gemmlowp::DefaultL8R8BitDepthParams>(
+        &gemm_context, lhs, rhs, &result, -128, -128, empty_pipeline);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * 2 * M * N * K);
+}
+
+BENCHMARK(BM_QgemmMlas)
+    ->ArgNames({"M", "N", "K", "packed"})
+    ->Args({1, 512, 512, 0})
+    ->Args({1, 512, 512, 1})
+    ->Args({64, 256, 768, 0})
+    ->Args({64, 256, 768, 1})
+    ->Args({256, 256, 256, 0})
+    ->Args({256, 256, 256, 1})
+    ->Args({1024, 1024, 1024, 0})
+    ->Args({1024, 1024, 1024, 1})
+    ->UseRealTime();
+
+BENCHMARK(BM_QgemmGemmlowp)
+    ->ArgNames({"M", "N", "K"})
+    ->Args({1, 512, 512})
+    ->Args({64, 256, 768})
+    ->Args({256, 256, 256})
+    ->Args({1024, 1024, 1024})
+    ->UseRealTime();
@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <cmath>
+
 #include "core/session/inference_session.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/model.h"
@@ -15,6 +17,8 @@
 #include "core/optimizer/conv_activation_fusion.h"
 #include "core/optimizer/matmul_add_fusion.h"
 #include "core/optimizer/gemm_activation_fusion.h"
+#include "core/optimizer/nchwc_transformer.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/framework/data_types.h"
 #include "core/framework/ml_value.h"
 #include "core/util/math.h"
@@ -339,5 +343,195 @@ TEST(GraphTransformationTests, FuseConvBnAddMulFloat16) {
   ASSERT_EQ(expected_values_prod, found);
 }
 
+#ifndef DISABLE_CONTRIB_OPS
+
+// Adds a float initializer filled with small values that vary by element.
+static NodeArg& AddNchwcTestInitializer(Graph& graph, const std::string& name, const std::vector<int64_t>& dims) {
+  TensorProto tensor_proto;
+  tensor_proto.set_name(name);
+  tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+  int64_t size = 1;
+  for (auto dim : dims) {
+    tensor_proto.add_dims(dim);
+    size *= dim;
+  }
+  for (int64_t i = 0; i < size; i++) {
+    tensor_proto.add_float_data(static_cast<float>((i * 37) % 19 - 9) / 32.0f);
+  }
+  graph.AddInitializedTensor(tensor_proto);
+
+  TypeProto type_proto;
+  type_proto.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  for (auto dim : dims) {
+    type_proto.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+  return graph.GetOrCreateNodeArg(name, &type_proto);
+}
+
+// X -> Conv -> Relu -> (Conv, depthwise Conv) -> Add -> Relu -> MaxPool -> pointwise Conv -> GlobalAveragePool -> Y
+// X2 -> pointwise Conv -> Y2
+static void CreateNchwcModel(const std::string& model_file_name) {
+  onnxruntime::Model model("nchwc_graph");
+  auto& graph = model.MainGraph();
+
+  auto make_type = [](const std::vector<int64_t>& dims) {
+    TypeProto type_proto;
+    type_proto.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    for (auto dim : dims) {
+      type_proto.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+    }
+    return type_proto;
+  };
+  TypeProto x_type = make_type({1, 3, 16, 16});
+  TypeProto x2_type = make_type({1, 32, 8, 8});
+  TypeProto y_type = make_type({1, 16, 1, 1});
+  TypeProto y2_type = make_type({1, 16, 8, 8});
+  TypeProto float_type;
+  float_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+
+  auto& x = graph.GetOrCreateNodeArg("X", &x_type);
+  auto& x2 = graph.GetOrCreateNodeArg("X2", &x2_type);
+  auto& y = graph.GetOrCreateNodeArg("Y", &y_type);
+  auto& y2 = graph.GetOrCreateNodeArg("Y2", &y2_type);
+  auto& conv1_out = graph.GetOrCreateNodeArg("conv1_out", &float_type);
+  auto& relu1_out = graph.GetOrCreateNodeArg("relu1_out", &float_type);
+  auto& conv2_out = graph.GetOrCreateNodeArg("conv2_out", &float_type);
+  auto& conv3_out = graph.GetOrCreateNodeArg("conv3_out", &float_type);
+  auto& add_out = graph.GetOrCreateNodeArg("add_out", &float_type);
+  auto& relu2_out = graph.GetOrCreateNodeArg("relu2_out", &float_type);
+  auto& pool_out = graph.GetOrCreateNodeArg("pool_out", &float_type);
+  auto& conv4_out = graph.GetOrCreateNodeArg("conv4_out", &float_type);
+
+  auto& w1 = AddNchwcTestInitializer(graph, "W1", {32, 3, 3, 3});
+  auto& b1 = AddNchwcTestInitializer(graph, "B1", {32});
+  auto& w2 = AddNchwcTestInitializer(graph, "W2", {32, 32, 3, 3});
+  auto& w3 = AddNchwcTestInitializer(graph, "W3", {32, 1, 3, 3});
+  auto& w4 = AddNchwcTestInitializer(graph, "W4", {16, 32, 1, 1});
+  auto& w5 = AddNchwcTestInitializer(graph, "W5", {16, 32, 1, 1});
+
+  const std::vector<int64_t> pads{1, 1, 1, 1};
+  graph.AddNode("conv1", "Conv", "", {&x, &w1, &b1}, {&conv1_out}).AddAttribute("pads", pads);
+  graph.AddNode("relu1", "Relu", "", {&conv1_out}, {&relu1_out});
+  graph.AddNode("conv2", "Conv", "", {&relu1_out, &w2}, {&conv2_out}).AddAttribute("pads", pads);
+  auto& conv3 = graph.AddNode("conv3", "Conv", "", {&relu1_out, &w3}, {&conv3_out});
+  conv3.AddAttribute("pads", pads);
+  conv3.AddAttribute("group", int64_t{32});
+  graph.AddNode("add", "Add", "", {&conv2_out, &conv3_out}, {&add_out});
+  graph.AddNode("relu2", "Relu", "", {&add_out}, {&relu2_out});
+  auto& pool = graph.AddNode("pool", "MaxPool", "", {&relu2_out}, {&pool_out});
+  pool.AddAttribute("kernel_shape", std::vector<int64_t>{2, 2});
+  pool.AddAttribute("strides", std::vector<int64_t>{2, 2});
+  graph.AddNode("conv4", "Conv", "", {&pool_out, &w4}, {&conv4_out});
+  graph.AddNode("gap", "GlobalAveragePool", "", {&conv4_out}, {&y});
+  graph.AddNode("conv5", "Conv", "", {&x2, &w5}, {&y2});
+
+  auto status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  status = onnxruntime::Model::Save(model, model_file_name);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+}
+
+TEST(GraphTransformationTests, NchwcTransformer) {
+  // The NCHWc layout is not supported on this platform.
+  if (MlasNchwcGetBlockSize() <= 1) {
+    return;
+  }
+
+  const std::string model_file_name = "graph_transform_test_nchwc.onnx";
+  CreateNchwcModel(model_file_name);
+
+  std::shared_ptr<Model> model;
+  ASSERT_TRUE(Model::Load(model_file_name, model).IsOK());
+  Graph& graph = model->MainGraph();
+  for (auto& node : graph.Nodes()) {
+    node.SetExecutionProviderType(kCpuExecutionProvider);
+  }
+
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  graph_transformation_mgr.Register(std::make_unique<NchwcTransformer>(), TransformerLevel::Level2);
+  ASSERT_TRUE(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level2).IsOK());
+
+  std::map<std::string, int> op_to_count;
+  const Node* conv2_node = nullptr;
+  for (auto& node : graph.Nodes()) {
+    op_to_count[node.Domain() + ":" + node.OpType()]++;
+    if (node.Domain() == kMSNchwcDomain && node.OpType() == "Conv" && node.InputDefs().size() == 4) {
+      conv2_node = &node;
+    }
+  }
+  const std::string nchwc_domain = std::string(kMSNchwcDomain) + ":";
+  EXPECT_EQ(op_to_count[nchwc_domain + "Conv"], 4);
+  EXPECT_EQ(op_to_count[nchwc_domain + "MaxPool"], 1);
+  EXPECT_EQ(op_to_count[nchwc_domain + "GlobalAveragePool"], 1);
+  EXPECT_EQ(op_to_count[nchwc_domain + "ReorderInput"], 0);
+  EXPECT_EQ(op_to_count[nchwc_domain + "ReorderOutput"], 1);
+  EXPECT_EQ(op_to_count[":Relu"], 0);
+  EXPECT_EQ(op_to_count[":Add"], 0);
+  // The pointwise convolution of the graph input is left in the NCHW layout.
+  EXPECT_EQ(op_to_count[":Conv"], 1);
+
+  // The Add is fused into one convolution as the Sum input and the Relu that
+  // follows is fused as its activation.
+  ASSERT_NE(conv2_node, nullptr);
+  const auto& attributes = conv2_node->GetAttributes();
+  auto activation = attributes.find("activation");
+  ASSERT_NE(activation, attributes.end());
+  EXPECT_EQ(activation->second.s(), "Relu");
+
+  // The transformed graph must produce the same outputs as the original graph.
+  std::vector<int64_t> dims_x = {1, 3, 16, 16};
+  std::vector<float> values_x(3 * 16 * 16);
+  for (size_t i = 0; i < values_x.size(); i++) {
+    values_x[i] = static_cast<float>(static_cast<int>(i % 13) - 6) / 8.0f;
+  }
+  std::vector<int64_t> dims_x2 = {1, 32, 8, 8};
+  std::vector<float> values_x2(32 * 8 * 8);
+  for (size_t i = 0; i < values_x2.size(); i++) {
+    values_x2[i] = static_cast<float>(static_cast<int>(i % 7) - 3) / 4.0f;
+  }
+  MLValue ml_value_x;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_x, values_x, &ml_value_x);
+  MLValue ml_value_x2;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_x2, values_x2, &ml_value_x2);
+  NameMLValMap feeds;
+  feeds.insert(std::make_pair("X", ml_value_x));
+  feeds.insert(std::make_pair("X2", ml_value_x2));
+
+  auto run = [&](bool use_nchwc, std::vector<MLValue>& fetches) {
+    SessionOptions so;
+    so.session_logid = "GraphTransformationTests.NchwcTransformer";
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    if (use_nchwc) {
+      ASSERT_TRUE(session_object.RegisterGraphTransformer(std::make_unique<NchwcTransformer>()).IsOK());
+    }
+    ASSERT_TRUE(session_object.Load(model_file_name).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    RunOptions run_options;
+    run_options.run_tag = so.session_logid;
+    auto status = session_object.Run(run_options, feeds, {"Y", "Y2"}, &fetches);
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  };
+
+  std::vector<MLValue> expected_fetches;
+  run(false, expected_fetches);
+  std::vector<MLValue> fetches;
+  run(true, fetches);
+
+  ASSERT_EQ(expected_fetches.size(), fetches.size());
+  for (size_t i = 0; i < fetches.size(); i++) {
+    const auto& expected = expected_fetches[i].Get<Tensor>();
+    const auto& actual = fetches[i].Get<Tensor>();
+    ASSERT_EQ(expected.Shape(), actual.Shape());
+    const float* expected_data = expected.Data<float>();
+    const float* actual_data = actual.Data<float>();
+    for (int64_t j = 0; j < expected.Shape().Size(); j++) {
+      EXPECT_NEAR(expected_data[j], actual_data[j], 1e-4f * (1.0f + std::abs(expected_data[j]))) << "output " << i << " element " << j;
+    }
+  }
+}
+
+#endif  // DISABLE_CONTRIB_OPS
+
 }  // namespace test
 }  // namespace onnxruntime
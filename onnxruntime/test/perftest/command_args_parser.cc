@@ -35,12 +35,13 @@ namespace perftest {
       "\t-s: Show statistics result, like P75, P90.\n"
       "\t-v: Show verbose information.\n"
       "\t-x [thread_size]: Use parallel executor, default (without -x): sequential executor.\n"
+      "\t-o [optimization_level]: Specifies the graph optimization level. Value could be 0, 1 or 2. Default:1.\n"
       "\t-h: help\n");
 }
 
 /*static*/ bool CommandLineParser::ParseArguments(PerformanceTestConfig& test_config, int argc, ORTCHAR_T* argv[]) {
   int ch;
-  while ((ch = getopt(argc, argv, ORT_TSTR("m:e:r:t:p:x:vhs"))) != -1) {
+  while ((ch = getopt(argc, argv, ORT_TSTR("m:e:r:t:p:x:o:vhs"))) != -1) {
     switch (ch) {
       case 'm':
         if (!CompareCString(optarg, ORT_TSTR("duration"))) {
@@ -96,6 +97,12 @@ namespace perftest {
           return false;
         }
         break;
+      case 'o':
+        test_config.run_config.optimization_level = static_cast<int>(OrtStrtol<PATH_CHAR_TYPE>(optarg, nullptr));
+        if (test_config.run_config.optimization_level < 0 || test_config.run_config.optimization_level > 2) {
+          return false;
+        }
+        break;
       case '?':
       case 'h':
       default:
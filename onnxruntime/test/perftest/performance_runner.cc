@@ -140,6 +140,10 @@ bool PerformanceRunner::Initialize() {
     sf.DisableSequentialExecution();
   fprintf(stdout, "Setting thread pool size to %d\n", performance_test_config_.run_config.session_thread_pool_size);
   sf.SetSessionThreadPoolSize(performance_test_config_.run_config.session_thread_pool_size);
+  if (sf.SetSessionGraphOptimizationLevel(static_cast<uint32_t>(performance_test_config_.run_config.optimization_level)) != 0) {
+    fprintf(stderr, "Invalid graph optimization level");
+    return false;
+  }
   session_object_ = sf.OrtCreateSession(test_case->GetModelUrl());
 
   auto provider_type = performance_test_config_.machine_config.provider_type_name;
@@ -156,6 +156,50 @@ TEST(MathOpTest, Add_Broadcast_2x1x1_3x4) {
   test.Run();
 }
 
+// Outputs large enough to be split between threads, with ranges that start and end inside a span.
+TEST(MathOpTest, Add_Broadcast_Large) {
+  const int64_t N = 7, C = 33, W = 1001;
+
+  std::vector<float> a(N * C * W);
+  std::vector<float> column(C);
+  std::vector<float> row(W);
+  for (size_t i = 0; i < a.size(); i++) a[i] = static_cast<float>(i % 1013);
+  for (size_t i = 0; i < column.size(); i++) column[i] = static_cast<float>(i) * 0.5f;
+  for (size_t i = 0; i < row.size(); i++) row[i] = static_cast<float>(i) * 0.25f;
+
+  std::vector<float> expected(a.size());
+
+  // Column broadcast, {N, C, W} + {C, 1}
+  for (int64_t i = 0; i < N * C * W; i++) expected[i] = a[i] + column[(i / W) % C];
+  {
+    OpTester test("Add");
+    test.AddInput<float>("A", {N, C, W}, a);
+    test.AddInput<float>("B", {C, 1}, column);
+    test.AddOutput<float>("C", {N, C, W}, expected);
+    test.Run();
+  }
+
+  // Row broadcast, {W} + {N, C, W}
+  for (int64_t i = 0; i < N * C * W; i++) expected[i] = row[i % W] + a[i];
+  {
+    OpTester test("Add");
+    test.AddInput<float>("A", {W}, row);
+    test.AddInput<float>("B", {N, C, W}, a);
+    test.AddOutput<float>("C", {N, C, W}, expected);
+    test.Run();
+  }
+
+  // Scalar, where the whole output is a single span
+  for (int64_t i = 0; i < N * C * W; i++) expected[i] = a[i] + 3.0f;
+  {
+    OpTester test("Add");
+    test.AddInput<float>("A", {N, C, W}, a);
+    test.AddInput<float>("B", {}, {3.0f});
+    test.AddOutput<float>("C", {N, C, W}, expected);
+    test.Run();
+  }
+}
+
 TEST(MathOpTest, Sub_int32) {
   OpTester test("Sub");
   test.AddInput<int32_t>("A", {3}, {1, 4, 3});
@@ -501,6 +545,27 @@ TEST(MathOpTest, Sum_8_Test2) {
   test.Run(OpTester::ExpectResult::kExpectSuccess, "Sum is not correct");
 }
 
+TEST(MathOpTest, Sum_8_Large) {
+  const int64_t C = 65, W = 1031;
+
+  std::vector<float> data_0(C * W);
+  std::vector<float> data_1(W);
+  std::vector<float> data_2(C);
+  for (size_t i = 0; i < data_0.size(); i++) data_0[i] = static_cast<float>(i % 97);
+  for (size_t i = 0; i < data_1.size(); i++) data_1[i] = static_cast<float>(i % 13) * 0.5f;
+  for (size_t i = 0; i < data_2.size(); i++) data_2[i] = -static_cast<float>(i);
+
+  std::vector<float> expected(C * W);
+  for (int64_t i = 0; i < C * W; i++) expected[i] = data_0[i] + data_1[i % W] + data_2[i / W];
+
+  OpTester test("Sum", 8);
+  test.AddInput<float>("data_0", {C, W}, data_0);
+  test.AddInput<float>("data_1", {W}, data_1);
+  test.AddInput<float>("data_2", {C, 1}, data_2);
+  test.AddOutput<float>("sum", {C, W}, expected);
+  test.Run();
+}
+
 TEST(MathOpTest, Min_6) {
   OpTester test("Min", 6);
   std::vector<int64_t> dims{3, 3};
@@ -100,6 +100,54 @@ TEST(GemmOpTest, GemmTrans) {
   test.Run();
 }
 
+// a constant B is packed when the kernel is created
+TEST(GemmOpTest, GemmConstantB) {
+  OpTester test("Gemm");
+
+  test.AddAttribute("transA", (int64_t)0);
+  test.AddAttribute("transB", (int64_t)0);
+  test.AddAttribute("alpha", 0.5f);
+  test.AddAttribute("beta", 0.0f);
+
+  test.AddInput<float>("A", {2, 3},
+                       {1.0f, 2.0f, 3.0f,
+                        4.0f, 5.0f, 6.0f});
+  test.AddInput<float>("B", {3, 2},
+                       {1.0f, 2.0f,
+                        3.0f, 4.0f,
+                        5.0f, 6.0f},
+                       true);
+  test.AddInput<float>("C", {2}, std::vector<float>(2, 1.0f));
+  test.AddOutput<float>("Y", {2, 2},
+                        {11.0f, 14.0f,
+                         24.5f, 32.0f});
+  test.Run();
+}
+
+TEST(GemmOpTest, GemmTransConstantB) {
+  OpTester test("Gemm");
+
+  test.AddAttribute("transA", (int64_t)0);
+  test.AddAttribute("transB", (int64_t)1);
+  test.AddAttribute("alpha", 1.0f);
+  test.AddAttribute("beta", 1.0f);
+
+  test.AddInput<float>("A", {2, 3},
+                       {1.0f, 2.0f, 3.0f,
+                        4.0f, 5.0f, 6.0f});
+  test.AddInput<float>("B", {4, 3},
+                       {1.0f, 0.0f, 0.0f,
+                        0.0f, 1.0f, 0.0f,
+                        0.0f, 0.0f, 1.0f,
+                        1.0f, 1.0f, 1.0f},
+                       true);
+  test.AddInput<float>("C", {4}, std::vector<float>(4, 0.5f));
+  test.AddOutput<float>("Y", {2, 4},
+                        {1.5f, 2.5f, 3.5f, 6.5f,
+                         4.5f, 5.5f, 6.5f, 15.5f});
+  test.Run();
+}
+
 TEST(GemmOpTest, GemmAlphaBeta) {
   OpTester test("Gemm");
 
@@ -6,6 +6,9 @@
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace onnxruntime {
 namespace test {
 
@@ -191,5 +194,34 @@ TEST(LogSoftmaxOperator, InvalidAxis) {
           "-7 is not in valid range [-2,1]");
 }
 
+// Rows wide enough to use the unrolled vector loops plus a partial vector at the end of each row, and enough rows
+// to be split across threads.
+TEST(LogSoftmaxOperator, WideRows) {
+  const int64_t N = 67;
+  const int64_t D = 1003;
+
+  std::vector<float> x_vals(N * D);
+  std::vector<float> expected_vals(N * D);
+
+  for (int64_t i = 0; i < N * D; i++) {
+    x_vals[i] = static_cast<float>((i * 7919) % 2003) / 100.0f - 10.0f;
+  }
+
+  for (int64_t n = 0; n < N; n++) {
+    const float* x = x_vals.data() + n * D;
+    float* y = expected_vals.data() + n * D;
+    const double max = *std::max_element(x, x + D);
+    double sum = 0.0;
+    for (int64_t d = 0; d < D; d++) {
+      sum += std::exp(x[d] - max);
+    }
+    for (int64_t d = 0; d < D; d++) {
+      y[d] = static_cast<float>(x[d] - max - std::log(sum));
+    }
+  }
+
+  RunTest(x_vals, expected_vals, {N, D});
+}
+
 }  // namespace test
 }  // namespace onnxruntime
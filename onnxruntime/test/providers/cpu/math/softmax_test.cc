@@ -6,6 +6,9 @@
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace onnxruntime {
 namespace test {
 
@@ -187,46 +190,34 @@ TEST(SoftmaxOperator, InvalidAxis) {
           "-10 is not in valid range [-2,1]");
 }
 
-TEST(SoftmaxOperator, TestInputTooLarge) {
-  float* ignored = nullptr;
-
-  // N > INT32_MAX
-  int64_t N = int64_t(INT32_MAX) + 1;
-  int64_t D = 1;
-  auto status = SoftmaxCPU(N, D, ignored, ignored, ignored, ignored, true, ignored);
-  EXPECT_EQ(status.Code(), common::INVALID_ARGUMENT);
-
-  // D > INT32_MAX
-  N = 1;
-  D = int64_t(INT32_MAX) + 1;
-  status = SoftmaxCPU(N, D, ignored, ignored, ignored, ignored, true, ignored);
-  EXPECT_EQ(status.Code(), common::INVALID_ARGUMENT);
-
-  // N * D > INT32_MAX
-  N = int64_t(INT32_MAX) / 2;
-  D = 3;
-  status = SoftmaxCPU(N, D, ignored, ignored, ignored, ignored, true, ignored);
-  EXPECT_EQ(status.Code(), common::INVALID_ARGUMENT);
-
-  /*
-    common::Status SoftmaxCPU(const int64_t N,
-                              const int64_t D,
-                              const float* Xdata,
-                              float* Ydata,
-                              float* scale,
-                              const float* sum_multiplier,
-                              bool logarithmic,
-                              float* rowmax)
-    {
-        // the Math functions SoftmaxCPU uses only support int32_t as input, so enforce that
-        if (N * D > INT32_MAX || N > INT32_MAX || D > INT32_MAX)
-        {
-            std::ostringstream ss;
-            ss << "SoftmaxCPU inputs N, D and N * D must be < " << INT32_MAX << ". N=" << N << ", D=" << D;
-            std::string msg = ss.str();
-
-            return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, msg);
-        }*/
+// Rows wide enough to use the unrolled vector loops plus a partial vector at the end of each row, and enough rows
+// to be split across threads.
+TEST(SoftmaxOperator, WideRows) {
+  const int64_t N = 67;
+  const int64_t D = 1003;
+
+  std::vector<float> x_vals(N * D);
+  std::vector<float> expected_vals(N * D);
+
+  for (int64_t i = 0; i < N * D; i++) {
+    x_vals[i] = static_cast<float>((i * 7919) % 2003) / 100.0f - 10.0f;
+  }
+
+  for (int64_t n = 0; n < N; n++) {
+    const float* x = x_vals.data() + n * D;
+    float* y = expected_vals.data() + n * D;
+    const double max = *std::max_element(x, x + D);
+    double sum = 0.0;
+    for (int64_t d = 0; d < D; d++) {
+      sum += std::exp(x[d] - max);
+    }
+    for (int64_t d = 0; d < D; d++) {
+      y[d] = static_cast<float>(std::exp(x[d] - max) / sum);
+    }
+  }
+
+  RunTest(x_vals, expected_vals, {N, D});
 }
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "gtest/gtest.h"
+#include "core/session/inference_session.h"
 #include "test/providers/provider_test_utils.h"
 
 namespace onnxruntime {
@@ -77,7 +78,9 @@ TEST(MLOpTest, SVMClassifierMulticlassLinearSVC) {
   test.Run();
 }
 
-TEST(MLOpTest, SVMClassifierSVCProbabilities) {
+// Runs the test data repeat times with 4 intra-op threads. 64 repeats are enough work to split the row blocks across
+// the threads.
+static void RunSVMClassifierSVCProbabilities(int64_t repeat) {
   OpTester test("SVMClassifier", 1, onnxruntime::kMLDomain);
 
   std::vector<float> coefficients = {1.14360327f, 1.95968249f, -1.175683f, -1.92760275f, -1.32575698f, -1.32575698f, 0.66332785f, 0.66242913f, 0.53120854f, 0.53510444f, -1.06631298f, -1.06631298f, 0.66332785f, 0.66242913f, 0.53120854f, 0.53510444f, 1.f, -1.f};
@@ -97,6 +100,14 @@ TEST(MLOpTest, SVMClassifierSVCProbabilities) {
       0.58274772f, 0.10203105f, 0.15755227f, 0.15766896f,
       0.58274772f, 0.10203105f, 0.15755227f, 0.15766896f};
   std::vector<int64_t> class_predictions = {1, 1, 2, 0, 0};
+  std::vector<float> batch_X;
+  std::vector<float> batch_prob_predictions;
+  std::vector<int64_t> batch_class_predictions;
+  for (int64_t i = 0; i < repeat; i++) {
+    batch_X.insert(batch_X.end(), X.begin(), X.end());
+    batch_prob_predictions.insert(batch_prob_predictions.end(), prob_predictions.begin(), prob_predictions.end());
+    batch_class_predictions.insert(batch_class_predictions.end(), class_predictions.begin(), class_predictions.end());
+  }
 
   test.AddAttribute("kernel_type", std::string("RBF"));
   test.AddAttribute("coefficients", coefficients);
@@ -108,11 +119,21 @@ TEST(MLOpTest, SVMClassifierSVCProbabilities) {
   test.AddAttribute("prob_a", proba);
   test.AddAttribute("prob_b", probb);
 
-  test.AddInput<float>("X", {5, 3}, X);
-  test.AddOutput<int64_t>("Y", {5}, class_predictions);
-  test.AddOutput<float>("Z", {5, 4}, prob_predictions);
+  test.AddInput<float>("X", {5 * repeat, 3}, batch_X);
+  test.AddOutput<int64_t>("Y", {5 * repeat}, batch_class_predictions);
+  test.AddOutput<float>("Z", {5 * repeat, 4}, batch_prob_predictions);
 
-  test.Run();
+  SessionOptions so;
+  so.intra_op_num_threads = 4;
+  test.Run(so);
+}
+
+TEST(MLOpTest, SVMClassifierSVCProbabilities) {
+  RunSVMClassifierSVCProbabilities(1);
+}
+
+TEST(MLOpTest, SVMClassifierSVCProbabilitiesBatch) {
+  RunSVMClassifierSVCProbabilities(64);
 }
 
 }  // namespace test
@@ -32,6 +32,31 @@ TEST(MLOpTest, SVMRegressorSVC) {
   test.Run();
 }
 
+// the points are close together but far from the origin, where |x|^2 + |v|^2 - 2 x.v loses the distance in rounding
+TEST(MLOpTest, SVMRegressorSVCLargeMagnitude) {
+  OpTester test("SVMRegressor", 1, onnxruntime::kMLDomain);
+
+  std::vector<float> dual_coefficients = {1.f, -1.f, 0.5f};
+  std::vector<float> support_vectors = {1000.f, 2000.f, -1500.f, 1000.5f, 2000.f, -1500.f, 1001.f, 1999.f, -1500.f};
+  std::vector<float> rho = {0.25f};
+  std::vector<float> kernel_params = {0.5f, 0.f, 3.f};  //gamma, coef0, degree
+
+  std::vector<float> X = {1000.f, 2000.f, -1500.f, 1000.25f, 2000.f, -1500.f, 1000.5f, 1999.5f, -1500.5f, 1001.f, 1999.f, -1500.f};
+  std::vector<float> predictions = {0.55144282f, 0.47891668f, 0.50213314f, 0.58261801f};
+
+  test.AddAttribute("kernel_type", std::string("RBF"));
+  test.AddAttribute("coefficients", dual_coefficients);
+  test.AddAttribute("support_vectors", support_vectors);
+  test.AddAttribute("rho", rho);
+  test.AddAttribute("kernel_params", kernel_params);
+  test.AddAttribute("n_supports", static_cast<int64_t>(3));
+
+  test.AddInput<float>("X", {4, 3}, X);
+  test.AddOutput<float>("Y", {4, 1}, predictions);
+
+  test.Run();
+}
+
 TEST(MLOpTest, SVMRegressorNuSVC) {
   OpTester test("SVMRegressor", 1, onnxruntime::kMLDomain);
 
@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <limits>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -151,5 +153,214 @@ TEST(MLOpTest, TreeEnsembleClassifierBinary) {
   test.Run();
 }
 
+TEST(MLOpTest, TreeEnsembleClassifierInvalidClassId) {
+  OpTester test("TreeEnsembleClassifier", 1, onnxruntime::kMLDomain);
+
+  test.AddAttribute("nodes_truenodeids", std::vector<int64_t>{1, -1, -1});
+  test.AddAttribute("nodes_falsenodeids", std::vector<int64_t>{2, -1, -1});
+  test.AddAttribute("nodes_treeids", std::vector<int64_t>{0, 0, 0});
+  test.AddAttribute("nodes_nodeids", std::vector<int64_t>{0, 1, 2});
+  test.AddAttribute("nodes_featureids", std::vector<int64_t>{0, -2, -2});
+  test.AddAttribute("nodes_values", std::vector<float>{0.5f, -2.f, -2.f});
+  test.AddAttribute("nodes_modes", std::vector<std::string>{"BRANCH_LEQ", "LEAF", "LEAF"});
+  test.AddAttribute("class_treeids", std::vector<int64_t>{0, 0});
+  test.AddAttribute("class_nodeids", std::vector<int64_t>{1, 2});
+  // class 2 is past the end of the class labels
+  test.AddAttribute("class_ids", std::vector<int64_t>{0, 2});
+  test.AddAttribute("class_weights", std::vector<float>{1.f, 1.f});
+  test.AddAttribute("classlabels_int64s", std::vector<int64_t>{0, 1});
+
+  test.AddInput<float>("X", {1, 1}, {0.f});
+  test.AddOutput<int64_t>("Y", {1}, {0});
+  test.AddOutput<float>("Z", {1, 2}, {1.f, 0.f});
+  test.Run(OpTester::ExpectResult::kExpectFailure, "class_ids must be less than the number of class labels.");
+}
+
+// A forest of complete trees of BRANCH_LEQ and BRANCH_LT nodes, which is evaluated with QuickScorer if every tree has
+// at most 64 leaves. The node k of a tree has the children 2k+1 and 2k+2. The thresholds and the weights are
+// multiples of 0.5 and 0.25, so inputs that are multiples of 0.5 often equal a threshold and the scores are exact.
+struct BranchLeqForest {
+  static const int64_t kClassCount = 3;
+
+  BranchLeqForest(const std::vector<int64_t>& depths, int64_t feature_count) : feature_count(feature_count) {
+    for (int64_t t = 0; t < static_cast<int64_t>(depths.size()); t++) {
+      const int64_t branch_count = (int64_t{1} << depths[t]) - 1;
+      for (int64_t k = 0; k < 2 * branch_count + 1; k++) {
+        treeids.push_back(t);
+        nodeids.push_back(k);
+        if (k < branch_count) {
+          lefts.push_back(2 * k + 1);
+          rights.push_back(2 * k + 2);
+          featureids.push_back((t + k) % feature_count);
+          thresholds.push_back(0.5f * ((t * 7 + k * 3) % 7) - 1.5f);
+          modes.push_back((t + k) % 2 == 0 ? "BRANCH_LEQ" : "BRANCH_LT");
+        } else {
+          lefts.push_back(-1);
+          rights.push_back(-1);
+          featureids.push_back(-2);
+          thresholds.push_back(-2.f);
+          modes.push_back("LEAF");
+          for (int64_t c = 0; c < kClassCount; c++) {
+            class_treeids.push_back(t);
+            class_nodeids.push_back(k);
+            class_ids.push_back(c);
+            class_weights.push_back(0.25f * ((t + 2 * k + 3 * c) % 5) - 0.5f);
+          }
+        }
+      }
+    }
+  }
+
+  // Rewrites the branches as the equivalent BRANCH_GT and BRANCH_GTE nodes with swapped children, which are walked
+  // node by node. The rewritten branches are only equivalent for inputs that are not NaN.
+  void UseBranchGt() {
+    for (size_t i = 0; i < modes.size(); i++) {
+      if (modes[i] != "LEAF") {
+        modes[i] = modes[i] == "BRANCH_LEQ" ? "BRANCH_GT" : "BRANCH_GTE";
+        std::swap(lefts[i], rights[i]);
+      }
+    }
+  }
+
+  // Adds a tree with a BRANCH_EQ root and leaves without weights, which makes the whole forest use the node walk
+  // without changing the scores.
+  void AddBranchEqTree() {
+    const int64_t tree = treeids.back() + 1;
+    lefts.insert(lefts.end(), {1, -1, -1});
+    rights.insert(rights.end(), {2, -1, -1});
+    treeids.insert(treeids.end(), {tree, tree, tree});
+    nodeids.insert(nodeids.end(), {0, 1, 2});
+    featureids.insert(featureids.end(), {0, -2, -2});
+    thresholds.insert(thresholds.end(), {0.f, -2.f, -2.f});
+    modes.insert(modes.end(), {"BRANCH_EQ", "LEAF", "LEAF"});
+  }
+
+  // Walks the original trees, comparing in double as the kernel does for double inputs.
+  template <typename T>
+  void ComputeExpected(const std::vector<T>& X, std::vector<int64_t>& labels, std::vector<float>& scores) const {
+    const int64_t N = static_cast<int64_t>(X.size()) / feature_count;
+    labels.assign(N, 0);
+    scores.assign(N * kClassCount, 0.f);
+    for (int64_t i = 0; i < N; i++) {
+      size_t root = 0;
+      while (root < treeids.size()) {
+        const int64_t tree = treeids[root];
+        size_t k = 0;
+        while (modes[root + k] != "LEAF") {
+          const double x = static_cast<double>(X[i * feature_count + featureids[root + k]]);
+          const double threshold = thresholds[root + k];
+          const bool is_true = modes[root + k] == "BRANCH_LEQ" ? x <= threshold : x < threshold;
+          k = is_true ? 2 * k + 1 : 2 * k + 2;
+        }
+        for (size_t w = 0; w < class_treeids.size(); w++) {
+          if (class_treeids[w] == tree && class_nodeids[w] == static_cast<int64_t>(k)) {
+            scores[i * kClassCount + class_ids[w]] += class_weights[w];
+          }
+        }
+        while (root < treeids.size() && treeids[root] == tree) root++;
+      }
+      for (int64_t c = 1; c < kClassCount; c++) {
+        if (scores[i * kClassCount + c] > scores[i * kClassCount + labels[i]]) labels[i] = c;
+      }
+    }
+  }
+
+  template <typename T>
+  void Run(const std::vector<T>& X, const std::vector<int64_t>& labels, const std::vector<float>& scores) const {
+    OpTester test("TreeEnsembleClassifier", 1, onnxruntime::kMLDomain);
+    test.AddAttribute("nodes_truenodeids", lefts);
+    test.AddAttribute("nodes_falsenodeids", rights);
+    test.AddAttribute("nodes_treeids", treeids);
+    test.AddAttribute("nodes_nodeids", nodeids);
+    test.AddAttribute("nodes_featureids", featureids);
+    test.AddAttribute("nodes_values", thresholds);
+    test.AddAttribute("nodes_modes", modes);
+    test.AddAttribute("class_treeids", class_treeids);
+    test.AddAttribute("class_nodeids", class_nodeids);
+    test.AddAttribute("class_ids", class_ids);
+    test.AddAttribute("class_weights", class_weights);
+    test.AddAttribute("classlabels_int64s", std::vector<int64_t>{0, 1, 2});
+    const int64_t N = static_cast<int64_t>(X.size()) / feature_count;
+    test.AddInput<T>("X", {N, feature_count}, X);
+    test.AddOutput<int64_t>("Y", {N}, labels);
+    test.AddOutput<float>("Z", {N, kClassCount}, scores);
+    test.Run();
+  }
+
+  int64_t feature_count;
+  std::vector<int64_t> lefts, rights, treeids, nodeids, featureids;
+  std::vector<float> thresholds;
+  std::vector<std::string> modes;
+  std::vector<int64_t> class_treeids, class_nodeids, class_ids;
+  std::vector<float> class_weights;
+};
+
+// 21 rows of multiples of 0.5 between -2 and 2, which fill two blocks of 8 rows and part of a third.
+static std::vector<float> BranchLeqForestInput(int64_t feature_count) {
+  std::vector<float> X(21 * feature_count);
+  for (size_t i = 0; i < X.size(); i++) {
+    X[i] = 0.5f * static_cast<float>((i * 5) % 9) - 2.f;
+  }
+  return X;
+}
+
+TEST(MLOpTest, TreeEnsembleClassifierQuickScorerTies) {
+  BranchLeqForest forest({3, 3, 2, 4, 3, 1, 5, 3}, 4);
+  std::vector<float> X = BranchLeqForestInput(4);
+  std::vector<int64_t> labels;
+  std::vector<float> scores;
+  forest.ComputeExpected(X, labels, scores);
+
+  forest.Run(X, labels, scores);
+  forest.UseBranchGt();
+  forest.Run(X, labels, scores);
+}
+
+TEST(MLOpTest, TreeEnsembleClassifierQuickScorerNaN) {
+  BranchLeqForest forest({3, 3, 2, 4, 3, 1, 5, 3}, 4);
+  std::vector<float> X = BranchLeqForestInput(4);
+  for (size_t i = 0; i < X.size(); i += 3) {
+    X[i] = std::numeric_limits<float>::quiet_NaN();
+  }
+  std::vector<int64_t> labels;
+  std::vector<float> scores;
+  forest.ComputeExpected(X, labels, scores);
+
+  forest.Run(X, labels, scores);
+  forest.AddBranchEqTree();
+  forest.Run(X, labels, scores);
+}
+
+TEST(MLOpTest, TreeEnsembleClassifierQuickScorerInputTypes) {
+  BranchLeqForest forest({3, 3, 2, 4, 3, 1, 5, 3}, 4);
+  std::vector<float> X = BranchLeqForestInput(4);
+  std::vector<double> X_double(X.begin(), X.end());
+  std::vector<int64_t> X_int64(X.size());
+  for (size_t i = 0; i < X.size(); i++) {
+    X_int64[i] = static_cast<int64_t>(X[i] * 2);
+  }
+  std::vector<int64_t> double_labels, int64_labels;
+  std::vector<float> double_scores, int64_scores;
+  forest.ComputeExpected(X_double, double_labels, double_scores);
+  forest.ComputeExpected(X_int64, int64_labels, int64_scores);
+
+  forest.Run(X_double, double_labels, double_scores);
+  forest.Run(X_int64, int64_labels, int64_scores);
+  forest.AddBranchEqTree();
+  forest.Run(X_double, double_labels, double_scores);
+  forest.Run(X_int64, int64_labels, int64_scores);
+}
+
+TEST(MLOpTest, TreeEnsembleClassifierQuickScorerManyLeaves) {
+  // the tree of depth 7 has 128 leaves, which is too many for QuickScorer
+  BranchLeqForest forest({3, 7, 2}, 4);
+  std::vector<float> X = BranchLeqForestInput(4);
+  std::vector<int64_t> labels;
+  std::vector<float> scores;
+  forest.ComputeExpected(X, labels, scores);
+
+  forest.Run(X, labels, scores);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
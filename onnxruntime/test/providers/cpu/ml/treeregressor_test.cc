@@ -2,12 +2,15 @@
 // Licensed under the MIT License.
 
 #include "gtest/gtest.h"
+#include "core/session/inference_session.h"
 #include "test/providers/provider_test_utils.h"
 
 namespace onnxruntime {
 namespace test {
 
-TEST(MLOpTest, TreeRegressorMultiTarget) {
+// Runs the test data repeat times with 4 intra-op threads. 512 repeats are enough work to split the rows across the
+// threads. If use_branch_gt is set, the BRANCH_LEQ nodes are replaced by the equivalent BRANCH_GT nodes.
+static void RunTreeRegressorMultiTarget(int64_t repeat, bool use_branch_gt = false) {
   OpTester test("TreeEnsembleRegressor", 1, onnxruntime::kMLDomain);
 
   //tree
@@ -28,6 +31,21 @@ TEST(MLOpTest, TreeRegressorMultiTarget) {
   //test data
   std::vector<float> X = {1.f, 0.0f, 0.4f, 3.0f, 44.0f, -3.f, 12.0f, 12.9f, -312.f, 23.0f, 11.3f, -222.f, 23.0f, 11.3f, -222.f, 23.0f, 3311.3f, -222.f, 23.0f, 11.3f, -222.f, 43.0f, 413.3f, -114.f};
   std::vector<float> results = {1.33333333f, 29.f, 3.f, 14.f, 2.f, 23.f, 2.f, 23.f, 2.f, 23.f, 2.66666667f, 17.f, 2.f, 23.f, 3.f, 14.f};
+  if (use_branch_gt) {
+    for (size_t i = 0; i < modes.size(); i++) {
+      if (modes[i] == "BRANCH_LEQ") {
+        modes[i] = "BRANCH_GT";
+        std::swap(lefts[i], rights[i]);
+      }
+    }
+  }
+
+  std::vector<float> batch_X;
+  std::vector<float> batch_results;
+  for (int64_t i = 0; i < repeat; i++) {
+    batch_X.insert(batch_X.end(), X.begin(), X.end());
+    batch_results.insert(batch_results.end(), results.begin(), results.end());
+  }
 
   //add attributes
   test.AddAttribute("nodes_truenodeids", lefts);
@@ -45,9 +63,208 @@ TEST(MLOpTest, TreeRegressorMultiTarget) {
   test.AddAttribute("n_targets", (int64_t)2);
   test.AddAttribute("aggregate_function", "AVERAGE");
   //fill input data
-  test.AddInput<float>("X", {8, 3}, X);
-  test.AddOutput<float>("Y", {8, 2}, results);
-  test.Run();
+  test.AddInput<float>("X", {8 * repeat, 3}, batch_X);
+  test.AddOutput<float>("Y", {8 * repeat, 2}, batch_results);
+  SessionOptions so;
+  so.intra_op_num_threads = 4;
+  test.Run(so);
+}
+
+TEST(MLOpTest, TreeRegressorMultiTarget) {
+  RunTreeRegressorMultiTarget(1);
+}
+
+TEST(MLOpTest, TreeRegressorMultiTargetBatch) {
+  RunTreeRegressorMultiTarget(512);
+}
+
+TEST(MLOpTest, TreeRegressorMultiTargetBranchGT) {
+  RunTreeRegressorMultiTarget(1, true);
+  RunTreeRegressorMultiTarget(512, true);
+}
+
+// A few rows of a large ensemble are split by trees across the threads. The weights are not exact in binary, so the
+// sums depend on the order of the additions, which must not depend on the number of threads.
+TEST(MLOpTest, TreeRegressorManyTrees) {
+  const int64_t tree_count = 4096;
+  std::vector<int64_t> lefts, rights, treeids, nodeids, featureids;
+  std::vector<float> thresholds;
+  std::vector<std::string> modes;
+  std::vector<int64_t> target_treeids, target_nodeids, target_ids;
+  std::vector<float> target_weights;
+  for (int64_t t = 0; t < tree_count; t++) {
+    lefts.insert(lefts.end(), {1, -1, -1});
+    rights.insert(rights.end(), {2, -1, -1});
+    treeids.insert(treeids.end(), {t, t, t});
+    nodeids.insert(nodeids.end(), {0, 1, 2});
+    featureids.insert(featureids.end(), {t % 3, -2, -2});
+    thresholds.insert(thresholds.end(), {static_cast<float>(t % 5 - 2), -2.f, -2.f});
+    modes.insert(modes.end(), {"BRANCH_LEQ", "LEAF", "LEAF"});
+    target_treeids.insert(target_treeids.end(), {t, t, t});
+    target_nodeids.insert(target_nodeids.end(), {1, 2, 2});
+    target_ids.insert(target_ids.end(), {0, 0, 1});
+    target_weights.insert(target_weights.end(), {0.1f * (t % 7) + 0.03f, 1.3f, 0.7f});
+  }
+
+  const int64_t N = 4;
+  std::vector<float> X = {-3.f, 0.f, 3.f, 0.5f, -1.5f, 2.f, 2.5f, 2.5f, -2.5f, -1.f, 1.f, 0.f};
+  // The weights of each block of 16 trees are summed on their own and the sums are added in block order, which is
+  // what the kernel does for any number of threads, so the results must match exactly.
+  std::vector<float> results(N * 2, 0.f);
+  for (int64_t i = 0; i < N; i++) {
+    for (int64_t tree_block = 0; tree_block < tree_count; tree_block += 16) {
+      float sums[2] = {0.f, 0.f};
+      float* block_sums = tree_block == 0 ? &results[i * 2] : sums;
+      for (int64_t t = tree_block; t < tree_block + 16; t++) {
+        if (X[i * 3 + t % 3] <= static_cast<float>(t % 5 - 2)) {
+          block_sums[0] += 0.1f * (t % 7) + 0.03f;
+        } else {
+          block_sums[0] += 1.3f;
+          block_sums[1] += 0.7f;
+        }
+      }
+      if (tree_block != 0) {
+        results[i * 2] += sums[0];
+        results[i * 2 + 1] += sums[1];
+      }
+    }
+  }
+
+  for (int threads : {1, 3, 4}) {
+    OpTester test("TreeEnsembleRegressor", 1, onnxruntime::kMLDomain);
+    test.AddAttribute("nodes_truenodeids", lefts);
+    test.AddAttribute("nodes_falsenodeids", rights);
+    test.AddAttribute("nodes_treeids", treeids);
+    test.AddAttribute("nodes_nodeids", nodeids);
+    test.AddAttribute("nodes_featureids", featureids);
+    test.AddAttribute("nodes_values", thresholds);
+    test.AddAttribute("nodes_modes", modes);
+    test.AddAttribute("target_treeids", target_treeids);
+    test.AddAttribute("target_nodeids", target_nodeids);
+    test.AddAttribute("target_ids", target_ids);
+    test.AddAttribute("target_weights", target_weights);
+    test.AddAttribute("n_targets", (int64_t)2);
+    test.AddAttribute("aggregate_function", "SUM");
+    test.AddInput<float>("X", {N, 3}, X);
+    test.AddOutput<float>("Y", {N, 2}, results);
+    test.SetOutputAbsErr("Y", 0.f);
+    SessionOptions so;
+    so.intra_op_num_threads = threads;
+    test.Run(so);
+  }
+}
+
+// Two trees whose tree ids and node ids do not start at zero. The leaves of the first tree have weights for one or
+// both targets and the second tree has a leaf without weights, so some rows only get weights for the first target.
+struct SmallTreeRegressor {
+  std::vector<int64_t> lefts = {11, -1, -1, 8, -1, -1};
+  std::vector<int64_t> rights = {12, -1, -1, 9, -1, -1};
+  std::vector<int64_t> treeids = {3, 3, 3, 5, 5, 5};
+  std::vector<int64_t> nodeids = {10, 11, 12, 7, 8, 9};
+  std::vector<int64_t> featureids = {0, -2, -2, 1, -2, -2};
+  std::vector<float> thresholds = {0.5f, -2.f, -2.f, 0.f, -2.f, -2.f};
+  std::vector<std::string> modes = {"BRANCH_LEQ", "LEAF", "LEAF", "BRANCH_LEQ", "LEAF", "LEAF"};
+
+  std::vector<int64_t> target_treeids = {3, 3, 3, 5};
+  std::vector<int64_t> target_nodeids = {11, 12, 12, 8};
+  std::vector<int64_t> target_ids = {0, 0, 1, 0};
+  std::vector<float> target_weights = {3.f, 4.f, 5.f, 10.f};
+
+  void Run(const std::vector<float>& X, const std::vector<float>& results,
+           OpTester::ExpectResult expect_result = OpTester::ExpectResult::kExpectSuccess,
+           const std::string& expected_failure_string = "") const {
+    OpTester test("TreeEnsembleRegressor", 1, onnxruntime::kMLDomain);
+    test.AddAttribute("nodes_truenodeids", lefts);
+    test.AddAttribute("nodes_falsenodeids", rights);
+    test.AddAttribute("nodes_treeids", treeids);
+    test.AddAttribute("nodes_nodeids", nodeids);
+    test.AddAttribute("nodes_featureids", featureids);
+    test.AddAttribute("nodes_values", thresholds);
+    test.AddAttribute("nodes_modes", modes);
+    test.AddAttribute("target_treeids", target_treeids);
+    test.AddAttribute("target_nodeids", target_nodeids);
+    test.AddAttribute("target_ids", target_ids);
+    test.AddAttribute("target_weights", target_weights);
+    test.AddAttribute("base_values", std::vector<float>{1.f, 2.f});
+    test.AddAttribute("n_targets", (int64_t)2);
+    test.AddAttribute("aggregate_function", "SUM");
+    const int64_t N = static_cast<int64_t>(X.size() / 2);
+    test.AddInput<float>("X", {N, 2}, X);
+    test.AddOutput<float>("Y", {N, 2}, results);
+    test.Run(expect_result, expected_failure_string);
+  }
+};
+
+TEST(MLOpTest, TreeRegressorNodeIds) {
+  SmallTreeRegressor model;
+  // Targets without a weight keep their base value.
+  model.Run({0.f, 0.f, 1.f, 1.f, 0.f, 1.f}, {14.f, 2.f, 5.f, 7.f, 4.f, 2.f});
+}
+
+TEST(MLOpTest, TreeRegressorInvalidFeatureId) {
+  SmallTreeRegressor model;
+  model.featureids[3] = 2;
+  model.Run({0.f, 0.f}, {14.f, 2.f}, OpTester::ExpectResult::kExpectFailure,
+            "X has fewer features than the trees use.");
+  model.featureids[3] = -1;
+  model.Run({0.f, 0.f}, {14.f, 2.f}, OpTester::ExpectResult::kExpectFailure, "Invalid feature id -1");
+}
+
+TEST(MLOpTest, TreeRegressorInvalidTargetId) {
+  SmallTreeRegressor model;
+  model.target_ids[2] = -1;
+  model.Run({0.f, 0.f}, {14.f, 2.f}, OpTester::ExpectResult::kExpectFailure, "Invalid id -1");
+}
+
+TEST(MLOpTest, TreeRegressorInvalidChild) {
+  SmallTreeRegressor model;
+  // node 8 belongs to tree 5, not tree 3
+  model.rights[0] = 8;
+  model.Run({0.f, 0.f}, {14.f, 2.f}, OpTester::ExpectResult::kExpectFailure, "has a child that is not in the tree");
+}
+
+TEST(MLOpTest, TreeRegressorNodeWithTwoParents) {
+  SmallTreeRegressor model;
+  model.rights[0] = 11;
+  model.Run({0.f, 0.f}, {14.f, 2.f}, OpTester::ExpectResult::kExpectFailure, "has more than one parent");
+}
+
+TEST(MLOpTest, TreeRegressorUnreachableNodes) {
+  SmallTreeRegressor model;
+  // nodes 20 and 22 are each other's child, so the tree has no root
+  model.lefts.insert(model.lefts.end(), {21, -1, 20, -1});
+  model.rights.insert(model.rights.end(), {22, -1, 23, -1});
+  model.treeids.insert(model.treeids.end(), {6, 6, 6, 6});
+  model.nodeids.insert(model.nodeids.end(), {20, 21, 22, 23});
+  model.featureids.insert(model.featureids.end(), {0, -2, 1, -2});
+  model.thresholds.insert(model.thresholds.end(), {0.f, -2.f, 0.f, -2.f});
+  model.modes.insert(model.modes.end(), {"BRANCH_LEQ", "LEAF", "BRANCH_LEQ", "LEAF"});
+  model.Run({0.f, 0.f}, {14.f, 2.f}, OpTester::ExpectResult::kExpectFailure, "is not reachable from a root");
+}
+
+TEST(MLOpTest, TreeRegressorTooDeep) {
+  SmallTreeRegressor model;
+  // replace the leaf 12 of tree 3 by a chain of 1000 branch nodes, which puts the last leaf at a depth of 1001
+  const int64_t chain_length = 1000;
+  model.modes[2] = "BRANCH_LEQ";
+  model.featureids[2] = 0;
+  model.thresholds[2] = 0.f;
+  for (int64_t i = 0; i < chain_length; i++) {
+    const int64_t node_id = 100 + 2 * i;
+    if (i == 0) {
+      model.lefts[2] = node_id;
+      model.rights[2] = node_id + 1;
+    }
+    const bool last = i == chain_length - 1;
+    model.lefts.insert(model.lefts.end(), {-1, last ? -1 : node_id + 2});
+    model.rights.insert(model.rights.end(), {-1, last ? -1 : node_id + 3});
+    model.treeids.insert(model.treeids.end(), {3, 3});
+    model.nodeids.insert(model.nodeids.end(), {node_id, node_id + 1});
+    model.featureids.insert(model.featureids.end(), {-2, last ? -2 : 0});
+    model.thresholds.insert(model.thresholds.end(), {-2.f, last ? -2.f : 0.f});
+    model.modes.insert(model.modes.end(), {"LEAF", last ? "LEAF" : "BRANCH_LEQ"});
+  }
+  model.Run({0.f, 0.f}, {14.f, 2.f}, OpTester::ExpectResult::kExpectFailure, "is deeper than 1000");
 }
 
 }  // namespace test
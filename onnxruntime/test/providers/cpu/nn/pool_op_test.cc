@@ -540,6 +540,28 @@ TEST(PoolTest, GlobalAveragePool) {
   test.Run();
 }
 
+TEST(PoolTest, GlobalAveragePool_Large) {
+  OpTester test("GlobalAveragePool");
+
+  // Enough channels to split the pooling across threads, with a spatial size that is not a multiple of the vector
+  // width.
+  const int64_t channels = 32;
+  const int64_t spatial_size = 45 * 45;
+
+  std::vector<float> x_vals(channels * spatial_size);
+  std::vector<float> expected_vals(channels);
+  for (int64_t c = 0; c < channels; c++) {
+    for (int64_t i = 0; i < spatial_size; i++) {
+      x_vals[c * spatial_size + i] = static_cast<float>((i % 3) + c);
+    }
+    expected_vals[c] = static_cast<float>(c + 1);
+  }
+
+  test.AddInput<float>("X", {1, channels, 45, 45}, x_vals);
+  test.AddOutput<float>("Y", {1, channels, 1, 1}, expected_vals);
+  test.Run();
+}
+
 TEST(PoolTest, LpPool) {
   OpTester test("LpPool");
 
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/reduction/reduction_ops.h"
+#include <limits>
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 #include "test/providers/cpu/reduction/reduction_test_cases.h"
@@ -1103,5 +1104,135 @@ TEST(ReductionOpTest, ArgMin_int32) {
   test.Run();
 }
 
+// Reducing an axis of extent 0 gives the identity of the reduction, which is -inf for ReduceMax and +inf for
+// ReduceMin, or the limits of an integer type.
+TEST(ReductionOpTest, ReduceMaxMin_EmptyAxis) {
+  const float inf = std::numeric_limits<float>::infinity();
+  {
+    OpTester test("ReduceMax");
+    test.AddAttribute("axes", std::vector<int64_t>{1});
+    test.AddAttribute("keepdims", static_cast<int64_t>(1));
+    test.AddInput<float>("data", {2, 0, 3}, {});
+    test.AddOutput<float>("reduced", {2, 1, 3}, std::vector<float>(6, -inf));
+    test.Run();
+  }
+  {
+    OpTester test("ReduceMin");
+    test.AddAttribute("axes", std::vector<int64_t>{1});
+    test.AddAttribute("keepdims", static_cast<int64_t>(0));
+    test.AddInput<float>("data", {3, 0}, {});
+    test.AddOutput<float>("reduced", {3}, std::vector<float>(3, inf));
+    test.Run();
+  }
+  {
+    OpTester test("ReduceMax");
+    test.AddAttribute("axes", std::vector<int64_t>{0});
+    test.AddAttribute("keepdims", static_cast<int64_t>(1));
+    test.AddInput<int32_t>("data", {0, 2}, {});
+    test.AddOutput<int32_t>("reduced", {1, 2}, std::vector<int32_t>(2, std::numeric_limits<int32_t>::lowest()));
+    test.Run();
+  }
+  {
+    OpTester test("ReduceMin");
+    test.AddAttribute("axes", std::vector<int64_t>{0});
+    test.AddAttribute("keepdims", static_cast<int64_t>(1));
+    test.AddInput<int32_t>("data", {0, 2}, {});
+    test.AddOutput<int32_t>("reduced", {1, 2}, std::vector<int32_t>(2, std::numeric_limits<int32_t>::max()));
+    test.Run();
+  }
+}
+
+// Reduce a generated input over the given axes one element at a time and compare against the operator. The inputs
+// are large enough to be split across threads and cover reducing the trailing, leading and middle axes in place as
+// well as a set of axes that has to be transposed first. The values are small integers so float sums are exact.
+void TestLargeReduceOp(const std::string& op, const std::vector<int64_t>& input_dims,
+                       const std::vector<int64_t>& axes) {
+  const size_t rank = input_dims.size();
+  std::vector<bool> is_reduced(rank, false);
+  for (auto axis : axes)
+    is_reduced[axis] = true;
+
+  size_t input_size = 1;
+  std::vector<int64_t> output_dims;
+  for (size_t i = 0; i < rank; ++i) {
+    input_size *= input_dims[i];
+    output_dims.push_back(is_reduced[i] ? 1 : input_dims[i]);
+  }
+
+  std::vector<float> input_data(input_size);
+  for (size_t i = 0; i < input_size; ++i)
+    input_data[i] = static_cast<float>(static_cast<int>((i * 37) % 101) - 50);
+
+  size_t output_size = 1;
+  for (auto dim : output_dims)
+    output_size *= dim;
+  const int64_t reduce_size = static_cast<int64_t>(input_size / output_size);
+
+  const bool is_arg = op == "ArgMax";
+  std::vector<float> expected(output_size, op == "ReduceMax" || is_arg ? -1000.0f : 0.0f);
+  std::vector<int64_t> expected_index(output_size, 0);
+  std::vector<int64_t> reduced_index(output_size, 0);
+  std::vector<int64_t> index(rank, 0);
+  for (size_t i = 0; i < input_size; ++i) {
+    size_t output_offset = 0;
+    for (size_t k = 0; k < rank; ++k)
+      output_offset = output_offset * output_dims[k] + (is_reduced[k] ? 0 : index[k]);
+    const float value = input_data[i];
+    if (op == "ReduceSum" || op == "ReduceMean") {
+      expected[output_offset] += value;
+    } else if (value > expected[output_offset]) {
+      expected[output_offset] = value;
+      expected_index[output_offset] = reduced_index[output_offset];
+    }
+    reduced_index[output_offset]++;
+    for (size_t k = rank; k-- > 0;) {
+      if (++index[k] < input_dims[k])
+        break;
+      index[k] = 0;
+    }
+  }
+  if (op == "ReduceMean") {
+    for (auto& value : expected)
+      value /= static_cast<float>(reduce_size);
+  }
+
+  OpTester test(op.c_str());
+  if (is_arg)
+    test.AddAttribute("axis", axes[0]);
+  else
+    test.AddAttribute("axes", axes);
+  test.AddAttribute("keepdims", static_cast<int64_t>(1));
+  test.AddInput<float>("data", input_dims, input_data);
+  if (is_arg)
+    test.AddOutput<int64_t>("reduced", output_dims, expected_index);
+  else
+    test.AddOutput<float>("reduced", output_dims, expected);
+  test.Run();
+}
+
+TEST(ReductionOpTest, ReduceLarge_LastAxis) {
+  TestLargeReduceOp("ReduceSum", {37, 2049}, {1});
+  TestLargeReduceOp("ReduceMax", {37, 2049}, {1});
+  TestLargeReduceOp("ArgMax", {37, 2049}, {1});
+}
+
+TEST(ReductionOpTest, ReduceLarge_LeadingAxes) {
+  TestLargeReduceOp("ReduceSum", {64, 3, 1001}, {0, 1});
+  TestLargeReduceOp("ReduceMean", {64, 3, 1001}, {0, 1});
+  TestLargeReduceOp("ArgMax", {193, 1, 1001}, {0});
+}
+
+TEST(ReductionOpTest, ReduceLarge_MiddleAxes) {
+  TestLargeReduceOp("ReduceSum", {5, 40, 30, 66}, {1, 2});
+  TestLargeReduceOp("ReduceMax", {5, 40, 1, 30, 66}, {1, 3});
+  TestLargeReduceOp("ArgMax", {5, 1200, 66}, {1});
+}
+
+TEST(ReductionOpTest, ReduceLarge_SeparateAxes) {
+  TestLargeReduceOp("ReduceSum", {17, 9, 31, 13}, {0, 2});
+  TestLargeReduceOp("ReduceMean", {17, 9, 31, 13}, {1, 3});
+  TestLargeReduceOp("ReduceMax", {17, 9, 31, 13}, {0, 2});
+}
+
 }  // namespace test
 }  // namespace onnxruntime
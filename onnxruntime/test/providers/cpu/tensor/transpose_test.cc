@@ -188,5 +188,76 @@ TEST(TransposeOpTest, ThreeDimStr) {
   TransposeTest(input_shape, input_vals, &perm, expected_shape, expected_vals);
 }
 
+// Test a transpose of a generated tensor against the output computed one element at a time. The shapes are large
+// enough to exercise the tiled kernels, the edges of the tiles and splitting the work across threads.
+template <class T>
+void TransposeReferenceTest(const std::vector<int64_t>& input_shape, const std::vector<int64_t>& perm) {
+  const size_t rank = input_shape.size();
+  size_t size = 1;
+  for (auto dim : input_shape)
+    size *= static_cast<size_t>(dim);
+
+  std::vector<T> input_vals(size);
+  for (size_t i = 0; i < size; ++i)
+    input_vals[i] = static_cast<T>(i % 251);
+
+  std::vector<int64_t> expected_shape(rank);
+  std::vector<size_t> input_strides(rank, 1);
+  for (size_t i = rank - 1; i > 0; --i)
+    input_strides[i - 1] = input_strides[i] * input_shape[i];
+  for (size_t i = 0; i < rank; ++i)
+    expected_shape[i] = input_shape[perm[i]];
+
+  std::vector<T> expected_vals(size);
+  std::vector<int64_t> index(rank, 0);
+  for (size_t i = 0; i < size; ++i) {
+    size_t offset = 0;
+    for (size_t k = 0; k < rank; ++k)
+      offset += index[k] * input_strides[perm[k]];
+    expected_vals[i] = input_vals[offset];
+    for (size_t k = rank; k-- > 0;) {
+      if (++index[k] < expected_shape[k])
+        break;
+      index[k] = 0;
+    }
+  }
+
+  OpTester test("Transpose");
+  test.AddAttribute("perm", perm);
+  test.AddInput<T>("X", input_shape, input_vals);
+  test.AddOutput<T>("Y", expected_shape, expected_vals);
+  test.Run();
+}
+
+TEST(TransposeOpTest, NCHWToNHWC) {
+  TransposeReferenceTest<float>({2, 67, 33, 35}, {0, 2, 3, 1});
+  TransposeReferenceTest<uint8_t>({2, 67, 33, 35}, {0, 2, 3, 1});
+  TransposeReferenceTest<float>({1, 3, 224, 224}, {0, 2, 3, 1});
+}
+
+TEST(TransposeOpTest, NHWCToNCHW) {
+  TransposeReferenceTest<float>({2, 33, 35, 67}, {0, 3, 1, 2});
+  TransposeReferenceTest<uint8_t>({2, 33, 35, 67}, {0, 3, 1, 2});
+  TransposeReferenceTest<int16_t>({2, 33, 35, 67}, {0, 3, 1, 2});
+}
+
+// [B, S, H, D] -> [B, H, S, D] as used to split the attention heads, which moves blocks of D elements.
+TEST(TransposeOpTest, SwapMiddleAxes) {
+  TransposeReferenceTest<float>({3, 129, 12, 64}, {0, 2, 1, 3});
+  TransposeReferenceTest<double>({3, 129, 12, 65}, {0, 2, 1, 3});
+}
+
+TEST(TransposeOpTest, ReverseAxes) {
+  TransposeReferenceTest<float>({5, 17, 3, 41, 7}, {4, 3, 2, 1, 0});
+  TransposeReferenceTest<int64_t>({5, 17, 3, 41, 7}, {4, 3, 2, 1, 0});
+}
+
+// Axes of extent 1 and axes that stay adjacent are merged before transposing.
+TEST(TransposeOpTest, CoalescedAxes) {
+  TransposeReferenceTest<float>({1, 37, 1, 19, 23, 1}, {2, 3, 4, 0, 5, 1});
+  TransposeReferenceTest<float>({4, 1, 5, 1}, {3, 2, 1, 0});
+  TransposeReferenceTest<uint8_t>({1, 1, 300}, {2, 1, 0});
+}
+
 }  // namespace test
 }  // namespace onnxruntime
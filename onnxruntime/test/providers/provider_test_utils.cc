@@ -364,6 +364,18 @@ void OpTester::Run(ExpectResult expect_result,
                    const std::unordered_set<std::string>& excluded_provider_types,
                    const RunOptions* run_options,
                    std::vector<std::unique_ptr<IExecutionProvider>>* execution_providers) {
+  SessionOptions so;
+  so.session_logid = op_;
+  so.session_log_verbosity_level = 1;
+  Run(so, expect_result, expected_failure_string, excluded_provider_types, run_options, execution_providers);
+}
+
+void OpTester::Run(const SessionOptions& so,
+                   ExpectResult expect_result,
+                   const std::string& expected_failure_string,
+                   const std::unordered_set<std::string>& excluded_provider_types,
+                   const RunOptions* run_options,
+                   std::vector<std::unique_ptr<IExecutionProvider>>* execution_providers) {
   try {
 #ifndef NDEBUG
     run_called_ = true;
@@ -402,11 +414,6 @@ void OpTester::Run(ExpectResult expect_result,
     std::vector<std::string> output_names;
     FillFeedsAndOutputNames(feeds, output_names);
 
-    // Run the model
-    SessionOptions so;
-    so.session_logid = op_;
-    so.session_log_verbosity_level = 1;
-
     static const std::string all_provider_types[] = {
         kCpuExecutionProvider,
         kCudaExecutionProvider,
@@ -24,6 +24,7 @@
 
 namespace onnxruntime {
 class InferenceSession;
+struct SessionOptions;
 
 namespace test {
 // unfortunately std::optional is in C++17 so use a miniversion of it
@@ -245,6 +246,13 @@ class OpTester {
            const RunOptions* run_options = nullptr,
            std::vector<std::unique_ptr<IExecutionProvider>>* execution_providers = nullptr);
 
+  // Runs the model in sessions created with session_options, for example to set the number of intra-op threads.
+  void Run(const SessionOptions& session_options,
+           ExpectResult expect_result = ExpectResult::kExpectSuccess, const std::string& expected_failure_string = "",
+           const std::unordered_set<std::string>& excluded_provider_types = {},
+           const RunOptions* run_options = nullptr,
+           std::vector<std::unique_ptr<IExecutionProvider>>* execution_providers = nullptr);
+
   struct Data {
     onnxruntime::NodeArg def_;
     MLValue data_;
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+# Copyright (c) Microsoft Corporation. All rights reserved.
+# Licensed under the MIT License.
+
+# Runs onnxruntime_perf_test on the vision models of the test data at graph optimization levels 1 and 2, and prints
+# the average inference time of each. Level 2 is where the NCHWc transformer rewrites the convolutions and the
+# pooling, so the two columns compare the NCHW and the NCHWc paths end to end.
+#
+# The models come from the test data that build.py --download_test_data unpacks into <build_dir>/models, e.g.
+#   python3 tools/python/compare_optimization_levels.py --perf_test build/Linux/Release/onnxruntime_perf_test \
+#       --model_dir build/Linux/Release/models
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+DEFAULT_MODEL_PATTERN = 'resnet|mobilenet|squeezenet'
+OPTIMIZATION_LEVELS = [1, 2]
+
+
+def parse_arguments():
+    parser = argparse.ArgumentParser(description="Compare the CPU inference time of the vision models in the test "
+                                                 "data at graph optimization levels 1 and 2.")
+    parser.add_argument("--perf_test", required=True, help="Path to onnxruntime_perf_test.")
+    parser.add_argument("--model_dir", required=True,
+                        help="Directory searched recursively for <name>/model.onnx with its test_data_set_* inputs.")
+    parser.add_argument("--model_pattern", default=DEFAULT_MODEL_PATTERN,
+                        help="Regular expression on the model directory name. Default: '%s'." % DEFAULT_MODEL_PATTERN)
+    parser.add_argument("--repeated_times", type=int, default=100, help="Runs of each model at each level.")
+    return parser.parse_args()
+
+
+def find_models(model_dir, model_pattern):
+    pattern = re.compile(model_pattern, re.IGNORECASE)
+    models = []
+    for root, _, files in os.walk(model_dir):
+        if 'model.onnx' in files and pattern.search(os.path.basename(root)):
+            models.append(os.path.join(root, 'model.onnx'))
+    return sorted(models)
+
+
+def run_perf_test(perf_test, model_path, optimization_level, repeated_times):
+    result_file = os.devnull
+    cmd = [perf_test, '-e', 'cpu', '-m', 'times', '-r', str(repeated_times), '-o', str(optimization_level),
+           model_path, result_file]
+    output = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    match = re.search(r'Average time cost:([0-9.eE+-]+) ms', output.stdout)
+    if output.returncode != 0 or match is None:
+        print(output.stdout, file=sys.stderr)
+        return None
+    return float(match.group(1))
+
+
+def main():
+    args = parse_arguments()
+    models = find_models(args.model_dir, args.model_pattern)
+    if not models:
+        print("No model.onnx matching '%s' under %s" % (args.model_pattern, args.model_dir), file=sys.stderr)
+        return 1
+
+    print('%-60s %12s %12s %9s' % ('model', 'level 1 (ms)', 'level 2 (ms)', 'speedup'))
+    failed = False
+    for model_path in models:
+        name = os.path.relpath(os.path.dirname(model_path), args.model_dir)
+        times = [run_perf_test(args.perf_test, model_path, level, args.repeated_times)
+                 for level in OPTIMIZATION_LEVELS]
+        if None in times:
+            print('%-60s %s' % (name, 'failed'))
+            failed = True
+            continue
+        print('%-60s %12.3f %12.3f %8.2fx' % (name, times[0], times[1], times[0] / times[1]))
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())